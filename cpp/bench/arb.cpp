@@ -0,0 +1,49 @@
+#include <dqcsim>
+#include <benchmark/benchmark.h>
+
+using namespace dqcsim::wrap;
+
+static const char *JSON = "{\"name\": \"benchmark\", \"values\": [1, 2, 3, 4], \"nested\": {\"x\": 1.5}}";
+
+// Setting and getting the JSON data of an ArbData object as a JSON string.
+static void arb_json_round_trip(benchmark::State &state) {
+  ArbData data;
+  for (auto _ : state) {
+    data.set_arb_json_string(JSON);
+    benchmark::DoNotOptimize(data.get_arb_json_string());
+  }
+}
+BENCHMARK(arb_json_round_trip);
+
+// Setting and getting the JSON data of an ArbData object as CBOR.
+static void arb_cbor_round_trip(benchmark::State &state) {
+  ArbData data;
+  data.set_arb_json_string(JSON);
+  std::string cbor = data.get_arb_cbor_string();
+  for (auto _ : state) {
+    data.set_arb_cbor_string(cbor);
+    benchmark::DoNotOptimize(data.get_arb_cbor_string());
+  }
+}
+BENCHMARK(arb_cbor_round_trip);
+
+// Setting and getting the empty JSON object, which is the common case.
+static void arb_cbor_round_trip_empty(benchmark::State &state) {
+  ArbData data;
+  std::string cbor = data.get_arb_cbor_string();
+  for (auto _ : state) {
+    data.set_arb_cbor_string(cbor);
+    benchmark::DoNotOptimize(data.get_arb_cbor_string());
+  }
+}
+BENCHMARK(arb_cbor_round_trip_empty);
+
+// Pushing and popping a binary argument.
+static void arb_arg_push_pop(benchmark::State &state) {
+  ArbData data;
+  for (auto _ : state) {
+    data.push_arb_arg<double>(1.0);
+    benchmark::DoNotOptimize(data.pop_arb_arg_as<double>());
+  }
+}
+BENCHMARK(arb_arg_push_pop);
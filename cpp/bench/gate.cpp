@@ -0,0 +1,111 @@
+#include <dqcsim>
+#include <benchmark/benchmark.h>
+#include <vector>
+
+using namespace dqcsim::wrap;
+
+// Construction of a unitary gate from a matrix.
+static void gate_unitary(benchmark::State &state) {
+  Matrix matrix(PredefinedGate::H);
+  for (auto _ : state) {
+    Gate gate = Gate::unitary(QubitRef(1), matrix);
+    benchmark::DoNotOptimize(gate.get_handle());
+  }
+}
+BENCHMARK(gate_unitary);
+
+// Construction of a controlled unitary gate from a matrix.
+static void gate_unitary_controlled(benchmark::State &state) {
+  Matrix matrix(PredefinedGate::X);
+  for (auto _ : state) {
+    Gate gate = Gate::unitary(QubitRef(2), QubitRef(1), matrix);
+    benchmark::DoNotOptimize(gate.get_handle());
+  }
+}
+BENCHMARK(gate_unitary_controlled);
+
+// Construction of a predefined gate from its runtime type.
+static void gate_predefined(benchmark::State &state) {
+  for (auto _ : state) {
+    Gate gate = Gate::predefined(PredefinedGate::H, QubitRef(1));
+    benchmark::DoNotOptimize(gate.get_handle());
+  }
+}
+BENCHMARK(gate_predefined);
+
+// Construction of a predefined gate from a compile-time tag.
+static void gate_predefined_tag(benchmark::State &state) {
+  for (auto _ : state) {
+    Gate gate = Gate::predefined<gates::CNOT>(QubitRef(1), QubitRef(2));
+    benchmark::DoNotOptimize(gate.get_handle());
+  }
+}
+BENCHMARK(gate_predefined_tag);
+
+// Construction of a rotation gate.
+static void gate_predefined_rotation(benchmark::State &state) {
+  ArbData params;
+  params.push_arb_arg<double>(0.5);
+  for (auto _ : state) {
+    Gate gate = Gate::predefined(PredefinedGate::RX, QubitRef(1), params);
+    benchmark::DoNotOptimize(gate.get_handle());
+  }
+}
+BENCHMARK(gate_predefined_rotation);
+
+// Returns a gate map with some common gates, with X and Z last to make
+// detection of CNOT and CZ gates representative of a typical operator.
+static GateMap<int> make_gate_map() {
+  return GateMap<int>(true, true)
+    .with_unitary(0, PredefinedGate::H, 0)
+    .with_unitary(1, PredefinedGate::S, 0)
+    .with_unitary(2, PredefinedGate::T, 0)
+    .with_unitary(3, PredefinedGate::RX, 0)
+    .with_unitary(4, PredefinedGate::RZ, 0)
+    .with_unitary(5, PredefinedGate::Swap, 0)
+    .with_unitary(6, PredefinedGate::X)
+    .with_unitary(7, PredefinedGate::Z);
+}
+
+// Detection of a gate that is known to be a predefined gate.
+static void gatemap_detect_tagged(benchmark::State &state) {
+  GateMap<int> map = make_gate_map();
+  map.set_cache_capacity(state.range(0));
+  Gate gate = Gate::predefined<gates::CNOT>(QubitRef(1), QubitRef(2));
+  const int *key;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.detect(gate, &key, nullptr, nullptr));
+  }
+}
+BENCHMARK(gatemap_detect_tagged)->Arg(0)->Arg(1024);
+
+// Detection of a gate that must be detected by comparing matrices.
+static void gatemap_detect_matrix(benchmark::State &state) {
+  GateMap<int> map = make_gate_map();
+  map.set_cache_capacity(state.range(0));
+  Gate gate = Gate::unitary(QubitRef(2), QubitRef(1), Matrix(PredefinedGate::X));
+  const int *key;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.detect(gate, &key, nullptr, nullptr));
+  }
+}
+BENCHMARK(gatemap_detect_matrix)->Arg(0)->Arg(1024);
+
+// Detection of rotation gates with many different angles, as emitted by
+// variational algorithms.
+static void gatemap_detect_rotations(benchmark::State &state) {
+  GateMap<int> map = make_gate_map();
+  std::vector<Gate> gates;
+  for (int i = 0; i < 1024; i++) {
+    ArbData params;
+    params.push_arb_arg<double>(i * 0.001);
+    gates.push_back(Gate::predefined(PredefinedGate::RX, QubitRef(1), params));
+  }
+  const int *key;
+  size_t index = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.detect(gates[index], &key, nullptr, nullptr));
+    index = (index + 1) % gates.size();
+  }
+}
+BENCHMARK(gatemap_detect_rotations);
@@ -0,0 +1,49 @@
+#include <dqcsim>
+#include <benchmark/benchmark.h>
+
+using namespace dqcsim::wrap;
+
+// Creation and deletion of a handle through the raw C API.
+static void handle_new_delete_raw(benchmark::State &state) {
+  for (auto _ : state) {
+    dqcsim::raw::dqcs_handle_t handle = dqcsim::raw::dqcs_arb_new();
+    benchmark::DoNotOptimize(handle);
+    dqcsim::raw::dqcs_handle_delete(handle);
+  }
+}
+BENCHMARK(handle_new_delete_raw);
+
+// Creation and deletion of a handle through the C++ API.
+static void handle_new_delete(benchmark::State &state) {
+  for (auto _ : state) {
+    ArbData data;
+    benchmark::DoNotOptimize(data.get_handle());
+  }
+}
+BENCHMARK(handle_new_delete);
+
+// Building a qubit set handle with the given number of qubits.
+static void qubit_set_build(benchmark::State &state) {
+  for (auto _ : state) {
+    QubitSet qubits;
+    for (int64_t i = 1; i <= state.range(0); i++) {
+      qubits.push(QubitRef(i));
+    }
+    benchmark::DoNotOptimize(qubits.get_handle());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(qubit_set_build)->Arg(1)->Arg(3)->Arg(64);
+
+// Building a handle-less qubit set with the given number of qubits.
+static void small_qubit_set_build(benchmark::State &state) {
+  for (auto _ : state) {
+    SmallQubitSet<64> qubits;
+    for (int64_t i = 1; i <= state.range(0); i++) {
+      qubits.push(QubitRef(i));
+    }
+    benchmark::DoNotOptimize(qubits.data());
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(small_qubit_set_build)->Arg(1)->Arg(3)->Arg(64);
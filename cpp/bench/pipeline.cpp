@@ -0,0 +1,89 @@
+#include <dqcsim>
+#include <benchmark/benchmark.h>
+#include <stdexcept>
+
+using namespace dqcsim::wrap;
+
+// Frontend run callback that sends the number of gates specified by the
+// first binary argument, alternating between H and CNOT, followed by a
+// measurement that is waited upon to make sure the whole pipeline has
+// processed all gates when the simulation returns.
+static ArbData frontend_run(RunningPluginState &state, ArbData &&args) {
+  uint64_t num_gates = args.pop_arb_arg_as<uint64_t>();
+  QubitSet qubits = state.allocate(2);
+  std::vector<QubitRef> refs = qubits.copy_into_vector();
+  for (uint64_t i = 0; i < num_gates; i++) {
+    if (i & 1) {
+      state.gate<gates::CNOT>(refs[0], refs[1]);
+    } else {
+      state.gate<gates::H>(refs[0]);
+    }
+  }
+  state.measure_z(refs[0]);
+  state.get_measurement(refs[0]);
+  state.free(qubits);
+  return ArbData();
+}
+
+// Backend gate callback that only returns measurement results.
+static MeasurementSet backend_gate(PluginState &state, Gate &&gate) {
+  MeasurementSet measurements;
+  for (const QubitRef &qubit : gate.get_measures().copy_into_vector()) {
+    measurements.set(Measurement(qubit, MeasurementValue::Zero));
+  }
+  return measurements;
+}
+
+// Returns the simulation configuration shared by all pipeline benchmarks,
+// with only the frontend added.
+static SimulationConfiguration make_configuration() {
+  return SimulationConfiguration()
+    .without_reproduction()
+    .with_stderr_verbosity(Loglevel::Error)
+    .with_plugin(Frontend().with_callbacks(
+      Plugin::Frontend("bench", "", "")
+        .with_run(frontend_run)
+    ));
+}
+
+// Runs the given simulation repeatedly, sending the number of gates
+// specified by the benchmark argument each time.
+static void run_pipeline(benchmark::State &state, Simulation &sim) {
+  ArbData args;
+  args.push_arb_arg<uint64_t>(state.range(0));
+  for (auto _ : state) {
+    sim.run(args);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// End-to-end gatestream throughput through a frontend, operator, and
+// backend that all run in threads of this process.
+static void pipeline_threads(benchmark::State &state) {
+  Simulation sim = make_configuration()
+    .with_plugin(Operator().with_callbacks(
+      Plugin::Operator("bench", "", "")
+    ))
+    .with_plugin(Backend().with_callbacks(
+      Plugin::Backend("bench", "", "")
+        .with_gate(backend_gate)
+    ))
+    .build();
+  run_pipeline(state, sim);
+}
+BENCHMARK(pipeline_threads)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+// End-to-end gatestream throughput through the null operator and backend
+// plugin processes.
+static void pipeline_null_processes(benchmark::State &state) {
+  try {
+    Simulation sim = make_configuration()
+      .with_plugin(Operator().with_spec("null"))
+      .with_plugin(Backend().with_spec("null"))
+      .build();
+    run_pipeline(state, sim);
+  } catch (const std::runtime_error &e) {
+    state.SkipWithError(e.what());
+  }
+}
+BENCHMARK(pipeline_null_processes)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
@@ -46,6 +46,7 @@
 #include <cmath>
 #include <limits>
 #include <chrono>
+#include <utility>
 #include <cdqcsim>
 
 /**
@@ -649,6 +650,136 @@ namespace wrap {
     throw std::invalid_argument("unknown path style");
   }
 
+  /**
+   * Represents the NUMA memory placement policies for plugin processes.
+   *
+   * This wraps `raw::dqcs_numa_policy_t`, not including the `invalid` option
+   * (since we use exceptions to communicate failure).
+   */
+  enum class NumaPolicy {
+
+    /**
+     * Specifies that the plugin inherits the memory policy of the simulator.
+     */
+    Default = 0,
+
+    /**
+     * Specifies that memory should be allocated on the given NUMA node when
+     * possible.
+     */
+    Preferred = 1,
+
+    /**
+     * Specifies that memory may only be allocated on the given NUMA nodes.
+     */
+    Bind = 2,
+
+    /**
+     * Specifies that memory should be interleaved over the given NUMA nodes.
+     */
+    Interleave = 3
+
+  };
+
+  /**
+   * Converts a `NumaPolicy` to its raw C enum.
+   *
+   * \param policy The C++ NUMA policy to convert.
+   * \returns The raw NUMA policy.
+   */
+  inline raw::dqcs_numa_policy_t to_raw(NumaPolicy policy) noexcept {
+    switch (policy) {
+      case NumaPolicy::Default:    return raw::dqcs_numa_policy_t::DQCS_NUMA_DEFAULT;
+      case NumaPolicy::Preferred:  return raw::dqcs_numa_policy_t::DQCS_NUMA_PREFERRED;
+      case NumaPolicy::Bind:       return raw::dqcs_numa_policy_t::DQCS_NUMA_BIND;
+      case NumaPolicy::Interleave: return raw::dqcs_numa_policy_t::DQCS_NUMA_INTERLEAVE;
+    }
+    std::cerr << "unknown NUMA policy" << std::endl;
+    std::terminate();
+  }
+
+  /**
+   * Checks a `dqcs_numa_policy_t` return value and converts it to its C++
+   * enum representation; if failure, throws a runtime error with DQCsim's
+   * error message.
+   *
+   * \param policy The raw function return code.
+   * \returns The wrapped NUMA policy.
+   * \throws std::runtime_error When the return code indicated failure.
+   */
+  inline NumaPolicy check(raw::dqcs_numa_policy_t policy) {
+    switch (policy) {
+      case raw::dqcs_numa_policy_t::DQCS_NUMA_DEFAULT:     return NumaPolicy::Default;
+      case raw::dqcs_numa_policy_t::DQCS_NUMA_PREFERRED:   return NumaPolicy::Preferred;
+      case raw::dqcs_numa_policy_t::DQCS_NUMA_BIND:        return NumaPolicy::Bind;
+      case raw::dqcs_numa_policy_t::DQCS_NUMA_INTERLEAVE:  return NumaPolicy::Interleave;
+      case raw::dqcs_numa_policy_t::DQCS_NUMA_INVALID:     throw std::runtime_error(raw::dqcs_error_get());
+    }
+    throw std::invalid_argument("unknown NUMA policy");
+  }
+
+  /**
+   * Represents the strategies a plugin can use to wait for incoming
+   * gatestream messages.
+   *
+   * This wraps `raw::dqcs_receive_strategy_t`, not including the `invalid`
+   * option (since we use exceptions to communicate failure).
+   */
+  enum class ReceiveStrategy {
+
+    /**
+     * Specifies that the plugin blocks in the operating system right away.
+     */
+    Block = 0,
+
+    /**
+     * Specifies that the plugin busy-polls for a while before blocking.
+     */
+    Spin = 1,
+
+    /**
+     * Specifies that the plugin polls for a while before blocking, yielding
+     * to the operating system scheduler between polls.
+     */
+    Yield = 2
+
+  };
+
+  /**
+   * Converts a `ReceiveStrategy` to its raw C enum.
+   *
+   * \param strategy The C++ receive strategy to convert.
+   * \returns The raw receive strategy.
+   */
+  inline raw::dqcs_receive_strategy_t to_raw(ReceiveStrategy strategy) noexcept {
+    switch (strategy) {
+      case ReceiveStrategy::Block:  return raw::dqcs_receive_strategy_t::DQCS_RECV_BLOCK;
+      case ReceiveStrategy::Spin:   return raw::dqcs_receive_strategy_t::DQCS_RECV_SPIN;
+      case ReceiveStrategy::Yield:  return raw::dqcs_receive_strategy_t::DQCS_RECV_YIELD;
+    }
+    std::cerr << "unknown receive strategy" << std::endl;
+    std::terminate();
+  }
+
+  /**
+   * Checks a `dqcs_receive_strategy_t` return value and converts it to its
+   * C++ enum representation; if failure, throws a runtime error with
+   * DQCsim's error message.
+   *
+   * \param strategy The raw function return code.
+   * \returns The wrapped receive strategy.
+   * \throws std::runtime_error When the return code indicated failure.
+   */
+  inline ReceiveStrategy check(raw::dqcs_receive_strategy_t strategy) {
+    switch (strategy) {
+      case raw::dqcs_receive_strategy_t::DQCS_RECV_BLOCK:    return ReceiveStrategy::Block;
+      case raw::dqcs_receive_strategy_t::DQCS_RECV_SPIN:     return ReceiveStrategy::Spin;
+      case raw::dqcs_receive_strategy_t::DQCS_RECV_YIELD:    return ReceiveStrategy::Yield;
+      case raw::dqcs_receive_strategy_t::DQCS_RECV_INVALID:  throw std::runtime_error(raw::dqcs_error_get());
+    }
+    throw std::invalid_argument("unknown receive strategy");
+  }
+
   /**
    * Enumeration of the three types of plugins.
    *
@@ -1411,6 +1542,129 @@ namespace wrap {
     throw std::invalid_argument("unknown plugin type");
   }
 
+  /**
+   * Computes a gate fingerprint, as returned by `Gate::get_fingerprint()`,
+   * at compile time.
+   *
+   * \param type The gate type.
+   * \param predefined The raw predefined gate type that the matrix of the
+   * gate is known to be equal to, or 0 if not known. For measurement and prep
+   * gates, this should be `PredefinedGate::I` for the Z basis.
+   * \param num_controls The number of control qubits.
+   * \param num_operands The number of measured qubits for measurement gates,
+   * or the number of target qubits otherwise.
+   * \returns The fingerprint. Refer to the documentation of the C API
+   * function `dqcs_gate_fingerprint()` for the layout.
+   */
+  constexpr uint64_t gate_fingerprint(
+    GateType type,
+    uint64_t predefined,
+    uint64_t num_controls,
+    uint64_t num_operands
+  ) noexcept {
+    return static_cast<uint64_t>(type)
+      | (predefined << 8)
+      | ((num_controls < 0xFFFFF ? num_controls : 0xFFFFF) << 24)
+      | ((num_operands < 0xFFFFF ? num_operands : 0xFFFFF) << 44);
+  }
+
+  /**
+   * Bitmask selecting the gate type and predefined gate type fields of a gate
+   * fingerprint, i.e. ignoring the qubit counts.
+   */
+  constexpr uint64_t GATE_FINGERPRINT_KIND_MASK = 0xFFFFFF;
+
+  /**
+   * Compile-time tags for non-parameterized predefined gates.
+   *
+   * These types carry the predefined gate type and the number of target and
+   * control qubits as constants, such that `Gate::predefined<gates::CNOT>(c, t)`,
+   * `PluginState::gate<gates::H>(q)`, and `Gate::is<gates::H>()` can check
+   * the qubit count at compile time. Gates constructed this way remember
+   * their predefined gate type, which allows downstream plugins to dispatch
+   * on it without comparing matrices. The matrix itself is not part of the
+   * tag; use `Matrix(G::type)` if you need it.
+   */
+  namespace gates {
+
+    /**
+     * Compile-time tag for a predefined gate type with the given number of
+     * target and control qubits.
+     *
+     * \tparam Type The predefined gate type.
+     * \tparam Targets The number of target qubits of the gate.
+     * \tparam Controls The number of control qubits of the gate.
+     */
+    template <PredefinedGate Type, size_t Targets, size_t Controls = 0>
+    struct PredefinedGateTag {
+
+      /**
+       * The predefined gate type.
+       */
+      static constexpr PredefinedGate type = Type;
+
+      /**
+       * The number of target qubits.
+       */
+      static constexpr size_t num_targets = Targets;
+
+      /**
+       * The number of control qubits.
+       */
+      static constexpr size_t num_controls = Controls;
+
+      /**
+       * The total number of qubits, controls first.
+       */
+      static constexpr size_t num_qubits = Controls + Targets;
+
+      /**
+       * The fingerprint of gates constructed from this tag, as returned by
+       * `Gate::get_fingerprint()`.
+       */
+      static constexpr uint64_t fingerprint = gate_fingerprint(
+        GateType::Unitary, static_cast<uint64_t>(Type), Controls, Targets);
+
+    };
+
+    template <PredefinedGate Type, size_t Targets, size_t Controls>
+    constexpr PredefinedGate PredefinedGateTag<Type, Targets, Controls>::type;
+    template <PredefinedGate Type, size_t Targets, size_t Controls>
+    constexpr size_t PredefinedGateTag<Type, Targets, Controls>::num_targets;
+    template <PredefinedGate Type, size_t Targets, size_t Controls>
+    constexpr size_t PredefinedGateTag<Type, Targets, Controls>::num_controls;
+    template <PredefinedGate Type, size_t Targets, size_t Controls>
+    constexpr size_t PredefinedGateTag<Type, Targets, Controls>::num_qubits;
+    template <PredefinedGate Type, size_t Targets, size_t Controls>
+    constexpr uint64_t PredefinedGateTag<Type, Targets, Controls>::fingerprint;
+
+    using I = PredefinedGateTag<PredefinedGate::I, 1>;
+    using X = PredefinedGateTag<PredefinedGate::X, 1>;
+    using Y = PredefinedGateTag<PredefinedGate::Y, 1>;
+    using Z = PredefinedGateTag<PredefinedGate::Z, 1>;
+    using H = PredefinedGateTag<PredefinedGate::H, 1>;
+    using S = PredefinedGateTag<PredefinedGate::S, 1>;
+    using S_DAG = PredefinedGateTag<PredefinedGate::S_DAG, 1>;
+    using T = PredefinedGateTag<PredefinedGate::T, 1>;
+    using T_DAG = PredefinedGateTag<PredefinedGate::T_DAG, 1>;
+    using RX_90 = PredefinedGateTag<PredefinedGate::RX_90, 1>;
+    using RX_M90 = PredefinedGateTag<PredefinedGate::RX_M90, 1>;
+    using RX_180 = PredefinedGateTag<PredefinedGate::RX_180, 1>;
+    using RY_90 = PredefinedGateTag<PredefinedGate::RY_90, 1>;
+    using RY_M90 = PredefinedGateTag<PredefinedGate::RY_M90, 1>;
+    using RY_180 = PredefinedGateTag<PredefinedGate::RY_180, 1>;
+    using RZ_90 = PredefinedGateTag<PredefinedGate::RZ_90, 1>;
+    using RZ_M90 = PredefinedGateTag<PredefinedGate::RZ_M90, 1>;
+    using RZ_180 = PredefinedGateTag<PredefinedGate::RZ_180, 1>;
+    using Swap = PredefinedGateTag<PredefinedGate::Swap, 2>;
+    using SqSwap = PredefinedGateTag<PredefinedGate::SqSwap, 2>;
+    using CNOT = PredefinedGateTag<PredefinedGate::X, 1, 1>;
+    using CZ = PredefinedGateTag<PredefinedGate::Z, 1, 1>;
+    using Toffoli = PredefinedGateTag<PredefinedGate::X, 1, 2>;
+    using Fredkin = PredefinedGateTag<PredefinedGate::Swap, 2, 1>;
+
+  } // namespace gates
+
   /**
    * Checks a pointer return value; if failure, throws a runtime error with
    * DQCsim's error message.
@@ -1427,6 +1681,21 @@ namespace wrap {
     return pointer;
   }
 
+  /**
+   * Returns whether a message with the given loglevel would be logged.
+   *
+   * This is used by the `DQCSIM_LOG` macro (and its loglevel-specific
+   * friends) to skip formatting messages that nobody is going to see. If no
+   * logger is available in the current thread, this returns `true`, because
+   * `log()` then falls back to writing to stderr.
+   *
+   * \param level The severity level to check.
+   * \returns Whether a message with the given loglevel would be logged.
+   */
+  inline bool log_enabled(wrap::Loglevel level) noexcept {
+    return raw::dqcs_log_enabled(to_raw(level)) != raw::dqcs_bool_return_t::DQCS_FALSE;
+  }
+
   /**
    * Shim around the `dqcs_log_format` C API using `std::string` for the
    * strings.
@@ -1506,18 +1775,47 @@ namespace wrap {
     ) == raw::dqcs_return_t::DQCS_SUCCESS;
   }
 
+  /**
+   * The least severe loglevel that the `DQCSIM_LOG` macro (and its
+   * loglevel-specific friends) compiles in.
+   *
+   * Log statements with a less severe loglevel are removed entirely by the
+   * compiler, including the evaluation of their format arguments. To use
+   * this, define it as the name of a `Loglevel` before including `<dqcsim>`,
+   * for instance using `-DDQCSIM_MIN_LOGLEVEL=Info` to get rid of all debug
+   * and trace messages. Defaults to `Trace`, compiling in everything.
+   */
+  #ifndef DQCSIM_MIN_LOGLEVEL
+  #define DQCSIM_MIN_LOGLEVEL Trace
+  #endif
+
   /**
    * Convenience macro for calling `log()` with automatically determined filename
    * and line number, but a dynamic loglevel (first argument).
    *
+   * Nothing is evaluated or formatted if the loglevel is less severe than
+   * `DQCSIM_MIN_LOGLEVEL`, or if none of the loggers of the current thread
+   * accept it. `Loglevel::Pass` is not subject to `DQCSIM_MIN_LOGLEVEL`, as
+   * it has no severity of its own. The level itself is evaluated exactly
+   * once. Like the call to `log()` it wraps, the macro expands to an
+   * expression of type `void`.
+   *
    * \param level The severity level of the message.
    * \param fmt The `printf`-style format string for the log message.
    * \param ... The arguments for the `printf`-style format string.
    */
-  #define DQCSIM_LOG(level, fmt, ...)             \
-    ::dqcsim::wrap::log(                          \
-      level, "C++", __FILE__, __LINE__,           \
-      fmt, ##__VA_ARGS__)
+  #define DQCSIM_LOG(level, fmt, ...)                                       \
+    ([&]() {                                                                \
+      const ::dqcsim::wrap::Loglevel _dqcsim_level_ = (level);              \
+      if ((_dqcsim_level_ == ::dqcsim::wrap::Loglevel::Pass                 \
+           || _dqcsim_level_                                                \
+              <= ::dqcsim::wrap::Loglevel::DQCSIM_MIN_LOGLEVEL)             \
+          && ::dqcsim::wrap::log_enabled(_dqcsim_level_)) {                 \
+        ::dqcsim::wrap::log(                                                \
+          _dqcsim_level_, "C++", __FILE__, __LINE__,                        \
+          fmt, ##__VA_ARGS__);                                              \
+      }                                                                     \
+    }())
 
   /**
    * Convenience macro for calling `log()` with trace loglevel and automatically
@@ -1915,6 +2213,11 @@ namespace wrap {
      * you need to specify the `nlohmann::json` type as a generic to this
      * function.
      *
+     * \note Canonical CBOR (as returned by `get_arb_cbor_string()`) is only
+     * validated by DQCsim. The CBOR produced by `nlohmann::json` is not
+     * canonical when dictionary keys differ in length, because these are
+     * sorted differently; such objects are converted.
+     *
      * \param json The C++ JSON object representation of the object to set.
      * \throws std::runtime_error When the current handle is invalid.
      */
@@ -1924,6 +2227,105 @@ namespace wrap {
       check(raw::dqcs_arb_cbor_set(handle, cbor.data(), cbor.size()));
     }
 
+    /**
+     * Returns the CBOR encoding of the value at the given JSON pointer
+     * within the arbitrary JSON data.
+     *
+     * The pointer uses the RFC 6901 syntax, for instance `/noise/t1` or
+     * `/qubits/3`. Only the values along the path are decoded, so this is
+     * much faster than `get_arb_json()` for large objects.
+     *
+     * \param pointer The JSON pointer to the value.
+     * \returns A CBOR string representing the value.
+     * \throws std::runtime_error When the current handle is invalid or there
+     * is no value at the given pointer.
+     */
+    std::string get_arb_cbor_string(const std::string &pointer) const {
+      size_t size = check(raw::dqcs_arb_query_cbor(handle, pointer.c_str(), nullptr, 0));
+      std::string cbor;
+      cbor.resize(size);
+      check(raw::dqcs_arb_query_cbor(handle, pointer.c_str(), &cbor.front(), size));
+      return cbor;
+    }
+
+    /**
+     * Returns the value at the given JSON pointer within the arbitrary JSON
+     * data as a JSON object from `nlohmann::json`, without decoding the rest
+     * of the data.
+     *
+     * \param pointer The JSON pointer to the value.
+     * \returns A copy of the value.
+     * \throws std::runtime_error When the current handle is invalid or there
+     * is no value at the given pointer.
+     */
+    template <class JSON>
+    JSON get_arb_json(const std::string &pointer) const {
+      size_t size = check(raw::dqcs_arb_query_cbor(handle, pointer.c_str(), nullptr, 0));
+      std::vector<uint8_t> cbor;
+      cbor.resize(size);
+      check(raw::dqcs_arb_query_cbor(handle, pointer.c_str(), &cbor.front(), size));
+      return JSON::from_cbor(cbor);
+    }
+
+    /**
+     * Returns the number at the given JSON pointer within the arbitrary JSON
+     * data, without decoding the rest of the data.
+     *
+     * \param pointer The JSON pointer to the value.
+     * \returns The number, converted to floating point if it is an integer.
+     * \throws std::runtime_error When the current handle is invalid, there
+     * is no value at the given pointer, or the value is not a number.
+     */
+    double get_arb_cbor_f64(const std::string &pointer) const {
+      double value;
+      check(raw::dqcs_arb_query_f64(handle, pointer.c_str(), &value));
+      return value;
+    }
+
+    /**
+     * Returns the integer at the given JSON pointer within the arbitrary JSON
+     * data, without decoding the rest of the data.
+     *
+     * \param pointer The JSON pointer to the value.
+     * \returns The integer.
+     * \throws std::runtime_error When the current handle is invalid, there
+     * is no value at the given pointer, or the value is not an integer.
+     */
+    int64_t get_arb_cbor_i64(const std::string &pointer) const {
+      int64_t value;
+      check(raw::dqcs_arb_query_i64(handle, pointer.c_str(), &value));
+      return value;
+    }
+
+    /**
+     * Returns the boolean at the given JSON pointer within the arbitrary JSON
+     * data, without decoding the rest of the data.
+     *
+     * \param pointer The JSON pointer to the value.
+     * \returns The boolean.
+     * \throws std::runtime_error When the current handle is invalid, there
+     * is no value at the given pointer, or the value is not a boolean.
+     */
+    bool get_arb_cbor_bool(const std::string &pointer) const {
+      return check(raw::dqcs_arb_query_bool(handle, pointer.c_str()));
+    }
+
+    /**
+     * Returns the string at the given JSON pointer within the arbitrary JSON
+     * data, without decoding the rest of the data.
+     *
+     * \param pointer The JSON pointer to the value.
+     * \returns The string.
+     * \throws std::runtime_error When the current handle is invalid, there
+     * is no value at the given pointer, or the value is not a string.
+     */
+    std::string get_arb_cbor_text(const std::string &pointer) const {
+      char *ptr = check(raw::dqcs_arb_query_text(handle, pointer.c_str()));
+      std::string retval(ptr);
+      std::free(ptr);
+      return retval;
+    }
+
     /**
      * Returns the arbitrary argument at the given index as a (binary) string.
      *
@@ -2161,6 +2563,89 @@ namespace wrap {
       check(raw::dqcs_arb_clear(handle));
     }
 
+    /**
+     * Pushes a binary string stored in shared memory to the back of the
+     * shared argument list.
+     *
+     * The data is copied into shared memory once. When the arb is sent to
+     * another plugin process, only a reference to the shared memory is sent,
+     * so this is intended for large payloads such as initial state vectors.
+     * Only supported on Linux.
+     *
+     * \param data Pointer to the data for the new argument.
+     * \param size The size of the data in bytes.
+     * \throws std::runtime_error When the current handle is invalid or the
+     * shared memory region could not be created.
+     */
+    void push_shared_arb_arg(const void *data, size_t size) {
+      check(raw::dqcs_arb_shared_push(handle, data, size));
+    }
+
+    /**
+     * Pushes a (binary) string stored in shared memory to the back of the
+     * shared argument list.
+     *
+     * \param data The data for the new argument, represented as a (binary)
+     * string.
+     * \throws std::runtime_error When the current handle is invalid or the
+     * shared memory region could not be created.
+     */
+    void push_shared_arb_arg_string(const std::string &data) {
+      push_shared_arb_arg(data.data(), data.size());
+    }
+
+    /**
+     * Returns a pointer to the shared-memory argument at the given index,
+     * without copying it.
+     *
+     * Negative indices are relative to the back of the list, as in Python.
+     * The memory is read-only, and remains valid until the argument is
+     * removed from this arb or the arb is destroyed.
+     *
+     * \param index The index of the argument to retrieve.
+     * \param size Receives the size of the argument in bytes.
+     * \returns A pointer to the contents of the argument.
+     * \throws std::runtime_error When the current handle is invalid or the
+     * argument index is out of range.
+     */
+    const void *get_shared_arb_arg(ssize_t index, size_t &size) const {
+      return check(raw::dqcs_arb_shared_get(handle, index, &size));
+    }
+
+    /**
+     * Returns a copy of the shared-memory argument at the given index as a
+     * (binary) string.
+     *
+     * \param index The index of the argument to retrieve.
+     * \returns The (binary) string representation of the argument.
+     * \throws std::runtime_error When the current handle is invalid or the
+     * argument index is out of range.
+     */
+    std::string get_shared_arb_arg_string(ssize_t index) const {
+      size_t size;
+      const void *data = get_shared_arb_arg(index, size);
+      return std::string(static_cast<const char*>(data), size);
+    }
+
+    /**
+     * Returns the number of shared-memory arguments.
+     *
+     * \returns The number of shared-memory binary string arguments.
+     * \throws std::runtime_error When the current handle is invalid.
+     */
+    size_t get_shared_arb_arg_count() const {
+      return check(raw::dqcs_arb_shared_len(handle));
+    }
+
+    /**
+     * Clears the shared-memory argument list.
+     *
+     * \throws std::runtime_error When the current handle is invalid.
+     */
+    void clear_shared_arb_args() {
+      check(raw::dqcs_arb_shared_clear(handle));
+    }
+
     /**
      * Assigns all arb data from the given arb to this one.
      *
@@ -2615,16 +3100,19 @@ namespace wrap {
     }
 
     /**
-     * Drains the queue into a vector of `ArbCmd`s. This is less performant
-     * than iterating over the queue manually, because it requires copies.
+     * Drains the queue into a vector of `ArbCmd`s. The `ArbCmd`s are moved
+     * out of the queue using a single API call.
      *
      * \returns A `std::vector<ArbCmd>` representation of the queue.
      * \throws std::runtime_error When the handle is invalid.
      */
     std::vector<ArbCmd> drain_into_vector() {
+      std::vector<HandleIndex> handles(size());
+      size_t count = check(raw::dqcs_cq_take_all(handle, handles.data(), handles.size()));
       std::vector<ArbCmd> cmds;
-      for (; size() > 0; next()) {
-        cmds.emplace_back(*this);
+      cmds.reserve(count);
+      for (size_t i = 0; i < count; i++) {
+        cmds.emplace_back(handles[i]);
       }
       return cmds;
     }
@@ -2632,19 +3120,22 @@ namespace wrap {
     /**
      * Copies the queue into a vector of `ArbCmd`s. This is less performant
      * than iterating over the queue manually or using `drain_into_vector()`,
-     * because it requires (additional) copies.
+     * because it requires copies.
      *
-     * \note This function is not `const`, because exceptions during the copy
-     * operation can change its value, and the underlying handle is changed.
-     * However, under normal conditions, the contents appear to be unchanged.
+     * \note This function is not `const` for historical reasons; it does not
+     * modify the queue.
      *
      * \returns A `std::vector<ArbCmd>` representation of the queue.
      * \throws std::runtime_error When the handle is invalid.
      */
     std::vector<ArbCmd> copy_into_vector() {
-      std::vector<ArbCmd> cmds = drain_into_vector();
-      free();
-      handle = ArbCmdQueue::from_iter(cmds).take_handle();
+      std::vector<HandleIndex> handles(size());
+      size_t count = check(raw::dqcs_cq_get_all(handle, handles.data(), handles.size()));
+      std::vector<ArbCmd> cmds;
+      cmds.reserve(count);
+      for (size_t i = 0; i < count; i++) {
+        cmds.emplace_back(handles[i]);
+      }
       return cmds;
     }
 
@@ -2801,104 +3292,325 @@ namespace wrap {
     return QubitRef(qubit);
   }
 
+  // `QubitSpan` relies on arrays of `QubitRef`s having the same layout as
+  // arrays of raw qubit indices.
+  static_assert(sizeof(QubitRef) == sizeof(QubitIndex), "unexpected QubitRef layout");
+
   /**
-   * Represents an ordered set of qubit references.
-   *
-   * DQCsim's API primarily uses these objects to represent the gate operand
-   * lists for multi-qubit gates. They can also be used to represent
-   * multi-qubit registers, but typically a `std::vector<QubitRef>` will be
-   * more suitable for that, as it supports fast and convenient indexation.
-   * You can convert between a `QubitSet` and a vector easily using
-   * `from_iter`, `drain_into_vector`, and `copy_into_vector`.
+   * Fixed-capacity list of qubit references that lives on the stack.
    *
-   * You can use the builder pattern to construct qubit sets in a single line:
+   * Unlike `QubitSet`, this does not wrap a DQCsim handle, so constructing
+   * one does not involve any calls into DQCsim. It can be passed to the
+   * `QubitSpan` overloads of the gate construction functions.
    *
-   * \code
-   * QubitSet().with(1_q).with(2_q).with(3_q);
-   * \endcode
+   * \tparam N The maximum number of qubits that can be stored.
    */
-  class QubitSet : public Handle {
-  public:
+  template <size_t N>
+  class SmallQubitSet {
+  private:
 
     /**
-     * Wraps the given qubit set handle.
-     *
-     * \note This constructor does not verify that the handle is actually
-     * valid.
-     *
-     * \param handle The raw handle to wrap.
+     * Storage for the qubit indices.
      */
-    QubitSet(HandleIndex handle) noexcept : Handle(handle) {
-    }
+    QubitIndex qubits[N];
 
     /**
-     * Constructs an empty qubit set.
-     *
-     * \throws std::runtime_error When construction of the new handle fails for
-     * some reason.
+     * The number of qubits currently stored.
      */
-    QubitSet() : Handle(check(raw::dqcs_qbset_new())) {
+    size_t count;
+
+  public:
+
+    /**
+     * Constructs an empty set.
+     */
+    SmallQubitSet() noexcept : count(0) {
     }
 
     /**
-     * Constructs a qubit set object from an iterable of qubit references.
+     * Constructs a set from a list of raw qubit indices, such as a list
+     * obtained from DQCsim. The indices are assumed to be valid and unique.
      *
-     * \param qubits An iterable of `const QubitRef&` to take the qubits from.
-     * \throws std::runtime_error When construction of the new handle fails for
-     * some reason.
+     * \param indices Pointer to the first qubit index.
+     * \param num_indices The number of qubit indices.
+     * \throws std::runtime_error When the indices do not fit in the set.
      */
-    template <class T>
-    static QubitSet from_iter(const T &qubits) {
-      QubitSet result;
-      for (const QubitRef &qubit : qubits) {
-        result.push(qubit);
+    SmallQubitSet(const QubitIndex *indices, size_t num_indices) : count(num_indices) {
+      if (num_indices > N) {
+        throw std::runtime_error("SmallQubitSet capacity exceeded");
+      }
+      for (size_t i = 0; i < num_indices; i++) {
+        qubits[i] = indices[i];
       }
-      return result;
     }
 
     /**
-     * Copy-constructs a qubit set.
+     * Adds the given qubit reference to the end of this set.
      *
-     * \param src The object to copy from.
-     * \throws std::runtime_error When the source handle is invalid or
-     * construction of the new handle failed for some reason.
+     * \param qubit The qubit reference to add.
+     * \throws std::runtime_error When the set is full or the qubit is
+     * already part of the set.
      */
-    QubitSet(const QubitSet &src) : Handle(check(raw::dqcs_qbset_copy(src.handle))) {
+    void push(const QubitRef &qubit) {
+      if (count == N) {
+        throw std::runtime_error("SmallQubitSet capacity exceeded");
+      }
+      if (contains(qubit)) {
+        throw std::runtime_error("the specified qubit is already part of the set");
+      }
+      qubits[count++] = qubit.get_index();
     }
 
     /**
-     * Copy assignment operator for qubit sets.
+     * Adds the given qubit reference to the end of this set (builder
+     * pattern).
      *
-     * \param src The object to copy from.
-     * \throws std::runtime_error When the source handle is invalid, any
-     * previously wrapped handle in the destination object could not be freed,
-     * or construction of the new handle failed for some reason.
+     * \param qubit The qubit reference to add.
+     * \returns This object.
+     * \throws std::runtime_error When the set is full or the qubit is
+     * already part of the set.
      */
-    void operator=(const QubitSet &src) {
-      QubitSet copy(src);
-      free();
-      handle = copy.take_handle();
+    SmallQubitSet &&with(const QubitRef &qubit) {
+      push(qubit);
+      return std::move(*this);
     }
 
     /**
-     * Default move constructor.
+     * Returns whether the given qubit is part of this set.
+     *
+     * \param qubit The qubit reference to look for.
+     * \returns Whether the qubit is part of this set.
      */
-    QubitSet(QubitSet&&) = default;
+    bool contains(const QubitRef &qubit) const noexcept {
+      for (size_t i = 0; i < count; i++) {
+        if (qubits[i] == qubit.get_index()) return true;
+      }
+      return false;
+    }
 
     /**
-     * Default move assignment.
+     * Returns the number of qubits in this set.
+     *
+     * \returns The number of qubits in this set.
      */
-    QubitSet &operator=(QubitSet&&) = default;
+    size_t size() const noexcept {
+      return count;
+    }
 
     /**
-     * Pushes a qubit into the set. Note that qubit sets are ordered. An
-     * exception is thrown if the qubit is already in the set.
+     * Returns a pointer to the raw qubit indices in this set.
      *
-     * \param qubit The qubit reference to push.
-     * \throws std::runtime_error When the handle is invalid.
+     * \returns A pointer to the first of `size()` qubit indices.
      */
-    void push(const QubitRef &qubit) {
-      check(raw::dqcs_qbset_push(handle, qubit.get_index()));
+    const QubitIndex *data() const noexcept {
+      return qubits;
+    }
+
+  };
+
+  /**
+   * Non-owning reference to a contiguous list of qubit references.
+   *
+   * This is used for the overloads of the gate construction functions that
+   * pass their qubits straight to DQCsim as a C array, avoiding the
+   * construction of `QubitSet` handles. It can be constructed implicitly from
+   * a single `QubitRef`, a brace-enclosed list of them, a
+   * `std::vector<QubitRef>`, or a `SmallQubitSet`.
+   *
+   * \warning The span does not own the referenced qubits. It is intended to be
+   * used as a function argument only.
+   */
+  class QubitSpan {
+  private:
+
+    /**
+     * Pointer to the first qubit index.
+     */
+    const QubitIndex *qubits;
+
+    /**
+     * The number of qubits.
+     */
+    size_t count;
+
+  public:
+
+    /**
+     * Constructs a span from a pointer to raw qubit indices and a length.
+     *
+     * \param qubits Pointer to the first qubit index.
+     * \param count The number of qubits.
+     */
+    QubitSpan(const QubitIndex *qubits, size_t count) noexcept
+      : qubits(qubits), count(count) {
+    }
+
+    /**
+     * Constructs a span from a pointer to qubit references and a length.
+     *
+     * \param qubits Pointer to the first qubit reference.
+     * \param count The number of qubits.
+     */
+    QubitSpan(const QubitRef *qubits, size_t count) noexcept
+      : qubits(reinterpret_cast<const QubitIndex*>(qubits)), count(count) {
+    }
+
+    /**
+     * Constructs a span referring to a single qubit.
+     *
+     * \param qubit The qubit reference.
+     */
+    QubitSpan(const QubitRef &qubit) noexcept
+      : QubitSpan(&qubit, 1) {
+    }
+
+    /**
+     * Constructs a span from a brace-enclosed list of qubit references.
+     *
+     * \param qubits The qubit references. The list only lives until the end
+     * of the full-expression it appears in.
+     */
+    QubitSpan(std::initializer_list<QubitRef> qubits) noexcept
+      : QubitSpan(qubits.begin(), qubits.size()) {
+    }
+
+    /**
+     * Constructs a span from a vector of qubit references.
+     *
+     * \param qubits The qubit references.
+     */
+    QubitSpan(const std::vector<QubitRef> &qubits) noexcept
+      : QubitSpan(qubits.data(), qubits.size()) {
+    }
+
+    /**
+     * Constructs a span from a `SmallQubitSet`.
+     *
+     * \param qubits The qubit set.
+     */
+    template <size_t N>
+    QubitSpan(const SmallQubitSet<N> &qubits) noexcept
+      : QubitSpan(qubits.data(), qubits.size()) {
+    }
+
+    /**
+     * Returns the number of qubits in this span.
+     *
+     * \returns The number of qubits in this span.
+     */
+    size_t size() const noexcept {
+      return count;
+    }
+
+    /**
+     * Returns a pointer to the raw qubit indices in this span.
+     *
+     * \returns A pointer to the first of `size()` qubit indices.
+     */
+    const QubitIndex *data() const noexcept {
+      return qubits;
+    }
+
+  };
+
+  /**
+   * Represents an ordered set of qubit references.
+   *
+   * DQCsim's API primarily uses these objects to represent the gate operand
+   * lists for multi-qubit gates. They can also be used to represent
+   * multi-qubit registers, but typically a `std::vector<QubitRef>` will be
+   * more suitable for that, as it supports fast and convenient indexation.
+   * You can convert between a `QubitSet` and a vector easily using
+   * `from_iter`, `drain_into_vector`, and `copy_into_vector`.
+   *
+   * You can use the builder pattern to construct qubit sets in a single line:
+   *
+   * \code
+   * QubitSet().with(1_q).with(2_q).with(3_q);
+   * \endcode
+   */
+  class QubitSet : public Handle {
+  public:
+
+    /**
+     * Wraps the given qubit set handle.
+     *
+     * \note This constructor does not verify that the handle is actually
+     * valid.
+     *
+     * \param handle The raw handle to wrap.
+     */
+    QubitSet(HandleIndex handle) noexcept : Handle(handle) {
+    }
+
+    /**
+     * Constructs an empty qubit set.
+     *
+     * \throws std::runtime_error When construction of the new handle fails for
+     * some reason.
+     */
+    QubitSet() : Handle(check(raw::dqcs_qbset_new())) {
+    }
+
+    /**
+     * Constructs a qubit set object from an iterable of qubit references.
+     *
+     * \param qubits An iterable of `const QubitRef&` to take the qubits from.
+     * \throws std::runtime_error When construction of the new handle fails for
+     * some reason.
+     */
+    template <class T>
+    static QubitSet from_iter(const T &qubits) {
+      QubitSet result;
+      for (const QubitRef &qubit : qubits) {
+        result.push(qubit);
+      }
+      return result;
+    }
+
+    /**
+     * Copy-constructs a qubit set.
+     *
+     * \param src The object to copy from.
+     * \throws std::runtime_error When the source handle is invalid or
+     * construction of the new handle failed for some reason.
+     */
+    QubitSet(const QubitSet &src) : Handle(check(raw::dqcs_qbset_copy(src.handle))) {
+    }
+
+    /**
+     * Copy assignment operator for qubit sets.
+     *
+     * \param src The object to copy from.
+     * \throws std::runtime_error When the source handle is invalid, any
+     * previously wrapped handle in the destination object could not be freed,
+     * or construction of the new handle failed for some reason.
+     */
+    void operator=(const QubitSet &src) {
+      QubitSet copy(src);
+      free();
+      handle = copy.take_handle();
+    }
+
+    /**
+     * Default move constructor.
+     */
+    QubitSet(QubitSet&&) = default;
+
+    /**
+     * Default move assignment.
+     */
+    QubitSet &operator=(QubitSet&&) = default;
+
+    /**
+     * Pushes a qubit into the set. Note that qubit sets are ordered. An
+     * exception is thrown if the qubit is already in the set.
+     *
+     * \param qubit The qubit reference to push.
+     * \throws std::runtime_error When the handle is invalid.
+     */
+    void push(const QubitRef &qubit) {
+      check(raw::dqcs_qbset_push(handle, qubit.get_index()));
     }
 
     /**
@@ -2958,27 +3670,28 @@ namespace wrap {
      * \throws std::runtime_error When the handle is invalid.
      */
     std::vector<QubitRef> drain_into_vector() {
-      std::vector<QubitRef> qubits;
-      while (size()) {
-        qubits.emplace_back(pop());
-      }
+      std::vector<QubitRef> qubits = copy_into_vector();
+      free();
+      handle = check(raw::dqcs_qbset_new());
       return qubits;
     }
 
     /**
      * Copies the qubit set into a vector.
      *
-     * \note This requires destructive iteration of the source object, so it
-     * isn't not const; if an exception occurs, the state of the source object
-     * may be changed.
-     *
      * \returns A `std::vector<QubitRef>` containing the qubits that are in
      * the set, in insertion order.
      * \throws std::runtime_error When the handle is invalid.
      */
     std::vector<QubitRef> copy_into_vector() const {
-      QubitSet copy(*this);
-      return copy.drain_into_vector();
+      std::vector<QubitIndex> indices(size());
+      size_t count = check(raw::dqcs_qbset_get_all(handle, indices.data(), indices.size()));
+      std::vector<QubitRef> qubits;
+      qubits.reserve(count);
+      for (size_t i = 0; i < count; i++) {
+        qubits.emplace_back(indices[i]);
+      }
+      return qubits;
     }
 
   };
@@ -2988,6 +3701,127 @@ namespace wrap {
    */
   using complex = std::complex<double>;
 
+  /**
+   * Read-only view of the data of a `Matrix`, borrowed directly from DQCsim's
+   * internal representation.
+   *
+   * Constructing a view does not allocate or copy anything, so this is the
+   * preferred way to read gate matrices in performance-sensitive code such as
+   * a backend's `gate` callback.
+   *
+   * \warning The view does not own the data; it is only valid for as long as
+   * the `Matrix` object it was obtained from is alive and still owns its
+   * handle.
+   */
+  class MatrixView {
+  private:
+
+    /**
+     * Pointer to the first element of the matrix.
+     */
+    const complex *elements;
+
+    /**
+     * The number of rows/columns of the matrix.
+     */
+    size_t dim;
+
+  public:
+
+    /**
+     * Constructs a view from a pointer to row-major matrix data and the
+     * dimension of the matrix.
+     *
+     * \param elements Pointer to the first of `dimension * dimension`
+     * complex numbers in row-major form.
+     * \param dimension The number of rows/columns of the matrix.
+     */
+    MatrixView(const complex *elements, size_t dimension) noexcept
+      : elements(elements), dim(dimension) {
+    }
+
+    /**
+     * Returns the number of elements in the matrix.
+     *
+     * \returns The number of elements in the matrix.
+     */
+    size_t size() const noexcept {
+      return dim * dim;
+    }
+
+    /**
+     * Returns the number of rows/columns in the matrix.
+     *
+     * \returns The number of rows/columns in the matrix.
+     */
+    size_t dimension() const noexcept {
+      return dim;
+    }
+
+    /**
+     * Returns a pointer to the matrix data in row-major form.
+     *
+     * \returns A pointer to the first element of the matrix.
+     */
+    const complex *data() const noexcept {
+      return elements;
+    }
+
+    /**
+     * Returns a pointer to the matrix data in row-major form as pairs of
+     * real/imag doubles.
+     *
+     * \returns A pointer to the real part of the first element.
+     */
+    const double *data_as_doubles() const noexcept {
+      return reinterpret_cast<const double*>(elements);
+    }
+
+    /**
+     * Returns the element at the given row-major index without bounds
+     * checking.
+     *
+     * \param index The row-major index of the element.
+     * \returns The requested element.
+     */
+    const complex &operator[](size_t index) const noexcept {
+      return elements[index];
+    }
+
+    /**
+     * Returns the element at the given row and column without bounds
+     * checking.
+     *
+     * \param row The row of the element.
+     * \param column The column of the element.
+     * \returns The requested element.
+     */
+    const complex &operator()(size_t row, size_t column) const noexcept {
+      return elements[row * dim + column];
+    }
+
+    /**
+     * Returns an iterator to the first element of the matrix in row-major
+     * order.
+     *
+     * \returns Pointer to the first element.
+     */
+    const complex *begin() const noexcept {
+      return elements;
+    }
+
+    /**
+     * Returns an iterator past the last element of the matrix in row-major
+     * order.
+     *
+     * \returns Pointer past the last element.
+     */
+    const complex *end() const noexcept {
+      return elements + size();
+    }
+
+  };
+
   /**
    * Represents a square matrix used for describing N-qubit gates.
    *
@@ -3109,6 +3943,9 @@ namespace wrap {
     /**
      * Copy-constructs a matrix.
      *
+     * The matrix data is shared with the source until either is modified, so
+     * this is cheap regardless of the matrix size.
+     *
      * \param src The object to copy from.
      * \throws std::runtime_error When the source handle is invalid or
      * construction of the new handle failed for some reason.
@@ -3179,11 +4016,8 @@ namespace wrap {
      * \throws std::runtime_error When the matrix handle is invalid.
      */
     std::vector<complex> get() const {
-      size_t s = size();
-      std::vector<complex> vec(s);
-      double *data = check(raw::dqcs_mat_get(handle));
-      std::memcpy(vec.data(), data, s * sizeof(complex));
-      return vec;
+      MatrixView v = view();
+      return std::vector<complex>(v.begin(), v.end());
     }
 
     /**
@@ -3194,11 +4028,22 @@ namespace wrap {
      * \throws std::runtime_error When the matrix handle is invalid.
      */
     std::vector<double> get_as_doubles() const {
-      size_t s = size();
-      std::vector<double> vec(s * 2);
-      double *data = check(raw::dqcs_mat_get(handle));
-      std::memcpy(vec.data(), data, 2 * s * sizeof(double));
-      return vec;
+      MatrixView v = view();
+      return std::vector<double>(v.data_as_doubles(), v.data_as_doubles() + 2 * v.size());
+    }
+
+    /**
+     * Returns a read-only view of the data contained by the matrix, without
+     * copying it.
+     *
+     * \returns A view of the data contained by the matrix, valid for as long
+     * as this object owns its handle.
+     * \throws std::runtime_error When the matrix handle is invalid.
+     */
+    MatrixView view() const {
+      size_t dim = dimension();
+      const double *data = check(raw::dqcs_mat_view(handle));
+      return MatrixView(reinterpret_cast<const complex*>(data), dim);
     }
 
     /**
@@ -3301,26 +4146,56 @@ namespace wrap {
     }
 
     /**
-     * Constructs a controlled matrix from the given matrix.
+     * Returns the matrix product of this matrix and the given matrix.
      *
-     * \param number_of_controls The number of control qubits to add.
+     * The result is the matrix that applies `rhs` first and then this matrix.
+     *
+     * \param rhs The right-hand side of the product. Its dimension must match
+     * that of this matrix.
      * \returns The new matrix.
-     * \throws std::runtime_error When the handle is invalid or construction
-     * of the new matrix failed.
+     * \throws std::runtime_error When either handle is invalid or when the
+     * dimensions do not match.
      */
-    Matrix add_controls(size_t number_of_controls) const {
-      return Matrix(check(raw::dqcs_mat_add_controls(handle, number_of_controls)));
+    Matrix multiply(const Matrix &rhs) const {
+      return Matrix(check(raw::dqcs_mat_multiply(handle, rhs.get_handle())));
     }
 
     /**
-     * Splits a controlled matrix into its non-controlled submatrix and the
-     * indices of the control qubits.
+     * Returns the Kronecker product of this matrix and the given matrix.
      *
-     * \param epsilon The maximum magitude of the difference between the column
-     * vectors of the input matrix and the identity matrix (after dephasing if
-     * `ignore_phase` is set) for the column vector to be considered to not
-     * affect the respective entry in the quantum state vector. Note that if
-     * this is greater than zero, the resulting gate may not be exactly
+     * The qubits of this matrix become the most significant qubits of the
+     * result, so they precede those of `rhs` in the target list of a gate
+     * constructed from it.
+     *
+     * \param rhs The right-hand side of the product.
+     * \returns The new matrix.
+     * \throws std::runtime_error When either handle is invalid.
+     */
+    Matrix kron(const Matrix &rhs) const {
+      return Matrix(check(raw::dqcs_mat_kron(handle, rhs.get_handle())));
+    }
+
+    /**
+     * Constructs a controlled matrix from the given matrix.
+     *
+     * \param number_of_controls The number of control qubits to add.
+     * \returns The new matrix.
+     * \throws std::runtime_error When the handle is invalid or construction
+     * of the new matrix failed.
+     */
+    Matrix add_controls(size_t number_of_controls) const {
+      return Matrix(check(raw::dqcs_mat_add_controls(handle, number_of_controls)));
+    }
+
+    /**
+     * Splits a controlled matrix into its non-controlled submatrix and the
+     * indices of the control qubits.
+     *
+     * \param epsilon The maximum magitude of the difference between the column
+     * vectors of the input matrix and the identity matrix (after dephasing if
+     * `ignore_phase` is set) for the column vector to be considered to not
+     * affect the respective entry in the quantum state vector. Note that if
+     * this is greater than zero, the resulting gate may not be exactly
      * equivalent.
      * \param ignore_global_phase If this is set, any global phase in the
      * matrix is ignored, but note that if control qubits are stripped the
@@ -3499,6 +4374,99 @@ namespace wrap {
       return predefined(gate, QubitSet(qubits));
     }
 
+    /**
+     * Constructs a new predefined gate without constructing a qubit set
+     * handle.
+     *
+     * \param gate The type of gate to construct.
+     * \param qubits The qubits that the gate should operate on, for instance
+     * `{a, b}`. This should be at least the number of qubits required by the
+     * gate type; any additional qubits added on the left-hand side will serve
+     * as control qubits for a controlled gate using the specified gate matrix
+     * as its non-controlled submatrix.
+     * \param parameters An `ArbData` object containing the parameterization
+     * data for the predefined gate, if it requires parameters. Refer to the
+     * docs for `PredefinedGate` for more info. Any additional data in the
+     * `ArbData` object will be added to the gate's `ArbData` attachment.
+     * \returns The requested unitary gate.
+     * \throws std::runtime_error When construction of the new handle failed
+     * for some reason.
+     */
+    static Gate predefined(PredefinedGate gate, QubitSpan qubits, ArbData &&parameters) {
+      return Gate(check(raw::dqcs_gate_new_predef_array(
+        to_raw(gate),
+        qubits.data(),
+        qubits.size(),
+        parameters.get_handle()
+      )));
+    }
+
+    /**
+     * Constructs a new predefined gate without constructing a qubit set
+     * handle.
+     *
+     * \param gate The type of gate to construct.
+     * \param qubits The qubits that the gate should operate on, for instance
+     * `{a, b}`. This should be at least the number of qubits required by the
+     * gate type; any additional qubits added on the left-hand side will serve
+     * as control qubits for a controlled gate using the specified gate matrix
+     * as its non-controlled submatrix.
+     * \param parameters An `ArbData` object containing the parameterization
+     * data for the predefined gate, passed by copy.
+     * \returns The requested unitary gate.
+     * \throws std::runtime_error When construction of the new handle failed
+     * for some reason.
+     */
+    static Gate predefined(PredefinedGate gate, QubitSpan qubits, const ArbData &parameters) {
+      return predefined(gate, qubits, ArbData(parameters));
+    }
+
+    /**
+     * Constructs a new non-parameterized predefined gate without constructing
+     * a qubit set handle.
+     *
+     * \param gate The type of gate to construct.
+     * \param qubits The qubits that the gate should operate on, for instance
+     * `{a, b}`. This should be at least the number of qubits required by the
+     * gate type; any additional qubits added on the left-hand side will serve
+     * as control qubits for a controlled gate using the specified gate matrix
+     * as its non-controlled submatrix.
+     * \returns The requested unitary gate.
+     * \throws std::runtime_error When construction of the new handle failed
+     * for some reason.
+     */
+    static Gate predefined(PredefinedGate gate, QubitSpan qubits) {
+      return Gate(check(raw::dqcs_gate_new_predef_array(
+        to_raw(gate),
+        qubits.data(),
+        qubits.size(),
+        0
+      )));
+    }
+
+    /**
+     * Constructs a new predefined gate from a compile-time tag.
+     *
+     * \tparam G The gate tag, for instance `gates::H` or `gates::CNOT`.
+     * \param qubits The qubits that the gate should operate on, control
+     * qubits first. The number of qubits is checked at compile time.
+     * \returns The requested unitary gate.
+     * \throws std::runtime_error When construction of the new handle failed
+     * for some reason.
+     */
+    template <class G, class... Qubits>
+    static Gate predefined(const Qubits&... qubits) {
+      static_assert(sizeof...(Qubits) == G::num_qubits,
+        "wrong number of qubits for predefined gate");
+      const QubitIndex indices[] = {QubitRef(qubits).get_index()...};
+      return Gate(check(raw::dqcs_gate_new_predef_array(
+        to_raw(G::type),
+        indices,
+        sizeof...(Qubits),
+        0
+      )));
+    }
+
     /**
      * Constructs a new custom unitary gate.
      *
@@ -3573,6 +4541,53 @@ namespace wrap {
       return unitary(QubitSet(targets), QubitSet(controls), matrix);
     }
 
+    /**
+     * Constructs a new custom unitary gate without constructing qubit set
+     * handles.
+     *
+     * \param targets The target qubits, for instance `{a, b}`.
+     * \param matrix The matrix to be applied to the target qubits. It must be
+     * appropriately sized for the number of target qubits (2^n by 2^n). The
+     * gate receives a copy of the matrix.
+     * \returns The requested unitary gate.
+     * \throws std::runtime_error When construction of the new handle failed
+     * for some reason.
+     */
+    static Gate unitary(QubitSpan targets, const Matrix &matrix) {
+      return Gate(check(raw::dqcs_gate_new_unitary_array(
+        targets.data(),
+        targets.size(),
+        nullptr,
+        0,
+        matrix.get_handle()
+      )));
+    }
+
+    /**
+     * Constructs a new custom unitary gate with control qubits without
+     * constructing qubit set handles.
+     *
+     * \param targets The target qubits, for instance `{b}`.
+     * \param controls The control qubits, for instance `{a}`. The control
+     * qubits are not represented in the matrix; the backend will supplement
+     * it as needed. The target and control qubits must be disjoint.
+     * \param matrix The matrix to be applied to the target qubits. It must be
+     * appropriately sized for the number of target qubits (2^n by 2^n). The
+     * gate receives a copy of the matrix.
+     * \returns The requested unitary gate.
+     * \throws std::runtime_error When construction of the new handle failed
+     * for some reason.
+     */
+    static Gate unitary(QubitSpan targets, QubitSpan controls, const Matrix &matrix) {
+      return Gate(check(raw::dqcs_gate_new_unitary_array(
+        targets.data(),
+        targets.size(),
+        controls.data(),
+        controls.size(),
+        matrix.get_handle()
+      )));
+    }
+
     /**
      * Constructs a new Z-axis measurement gate.
      *
@@ -3669,6 +4684,58 @@ namespace wrap {
       return measure(QubitSet(measures), Matrix(basis));
     }
 
+    /**
+     * Constructs a new Z-axis measurement gate without constructing a qubit
+     * set handle.
+     *
+     * \param measures The to-be-measured qubits, for instance `{a, b}`. The
+     * measurement results can be queried from `PluginState` after the gate is
+     * executed. Any previous measurement results for those qubits will be
+     * overridden.
+     * \returns The requested measurement gate.
+     * \throws std::runtime_error When construction of the new handle failed
+     * for some reason.
+     */
+    static Gate measure(QubitSpan measures) {
+      return Gate(check(raw::dqcs_gate_new_measurement_array(measures.data(), measures.size(), 0)));
+    }
+
+    /**
+     * Constructs a new measurement gate, measuring in the given Pauli basis,
+     * without constructing a qubit set handle.
+     *
+     * \param measures The to-be-measured qubits, for instance `{a, b}`. The
+     * measurement results can be queried from `PluginState` after the gate is
+     * executed. Any previous measurement results for those qubits will be
+     * overridden.
+     * \param basis The measurement basis.
+     * \returns The requested measurement gate.
+     * \throws std::runtime_error When construction of the new handle failed
+     * for some reason.
+     */
+    static Gate measure(QubitSpan measures, PauliBasis basis) {
+      return measure(measures, Matrix(basis));
+    }
+
+    /**
+     * Constructs a new measurement gate, measuring in the given custom basis,
+     * without constructing a qubit set handle.
+     *
+     * \param measures The to-be-measured qubits, for instance `{a, b}`. The
+     * measurement results can be queried from `PluginState` after the gate is
+     * executed. Any previous measurement results for those qubits will be
+     * overridden.
+     * \param basis The measurement basis, represented as a 2x2 matrix defining
+     * the rotation from the Z basis to the desired basis. The gate receives a
+     * copy of the matrix.
+     * \returns The requested measurement gate.
+     * \throws std::runtime_error When construction of the new handle failed
+     * for some reason.
+     */
+    static Gate measure(QubitSpan measures, const Matrix &basis) {
+      return Gate(check(raw::dqcs_gate_new_measurement_array(measures.data(), measures.size(), basis.get_handle())));
+    }
+
     /**
      * Constructs a new Z-axis prep gate, putting the qubits in the |0> state.
      *
@@ -4142,6 +5209,25 @@ namespace wrap {
       return QubitSet(check(raw::dqcs_gate_targets(handle)));
     }
 
+    /**
+     * Returns the target qubits for this gate as a `SmallQubitSet`.
+     *
+     * Unlike `get_targets()`, this does not construct a qubit set handle, so
+     * this is the preferred way to read the operands of a gate in
+     * performance-sensitive code such as a backend's `gate` callback.
+     *
+     * \tparam N The capacity of the returned set.
+     * \returns A set containing the target qubits for this gate.
+     * \throws std::runtime_error When the current handle is invalid or the
+     * gate has more than `N` target qubits.
+     */
+    template <size_t N = 8>
+    SmallQubitSet<N> get_targets_small() const {
+      QubitIndex indices[N];
+      size_t count = check(raw::dqcs_gate_targets_array(handle, indices, N));
+      return SmallQubitSet<N>(indices, count);
+    }
+
     /**
      * Returns whether this gate has target qubits.
      *
@@ -4163,6 +5249,25 @@ namespace wrap {
       return QubitSet(check(raw::dqcs_gate_controls(handle)));
     }
 
+    /**
+     * Returns the control qubits for this gate as a `SmallQubitSet`.
+     *
+     * Unlike `get_controls()`, this does not construct a qubit set handle, so
+     * this is the preferred way to read the operands of a gate in
+     * performance-sensitive code such as a backend's `gate` callback.
+     *
+     * \tparam N The capacity of the returned set.
+     * \returns A set containing the control qubits for this gate.
+     * \throws std::runtime_error When the current handle is invalid or the
+     * gate has more than `N` control qubits.
+     */
+    template <size_t N = 8>
+    SmallQubitSet<N> get_controls_small() const {
+      QubitIndex indices[N];
+      size_t count = check(raw::dqcs_gate_controls_array(handle, indices, N));
+      return SmallQubitSet<N>(indices, count);
+    }
+
     /**
      * Returns whether this gate has control qubits.
      *
@@ -4186,6 +5291,25 @@ namespace wrap {
       return QubitSet(check(raw::dqcs_gate_measures(handle)));
     }
 
+    /**
+     * Returns the measurement qubits for this gate as a `SmallQubitSet`.
+     *
+     * Unlike `get_measures()`, this does not construct a qubit set handle, so
+     * this is the preferred way to read the operands of a gate in
+     * performance-sensitive code such as a backend's `gate` callback.
+     *
+     * \tparam N The capacity of the returned set.
+     * \returns A set containing the measurement qubits for this gate.
+     * \throws std::runtime_error When the current handle is invalid or the
+     * gate has more than `N` measurement qubits.
+     */
+    template <size_t N = 8>
+    SmallQubitSet<N> get_measures_small() const {
+      QubitIndex indices[N];
+      size_t count = check(raw::dqcs_gate_measures_array(handle, indices, N));
+      return SmallQubitSet<N>(indices, count);
+    }
+
     /**
      * Returns whether this gate has measurement qubits.
      *
@@ -4207,6 +5331,23 @@ namespace wrap {
       return Matrix(check(raw::dqcs_gate_matrix(handle)));
     }
 
+    /**
+     * Returns the matrix that belongs to this gate with the control qubits
+     * folded in.
+     *
+     * The first qubits of the returned matrix correspond to the control
+     * qubits of this gate, followed by the targets. The expansion is cached
+     * for commonly used matrices, so this is cheaper than calling
+     * `Matrix::add_controls()` on the result of `get_matrix()`.
+     *
+     * \returns The controlled matrix that belongs to this gate.
+     * \throws std::runtime_error When the current handle is invalid or the
+     * gate doesn't have a matrix.
+     */
+    Matrix get_controlled_matrix() const {
+      return Matrix(check(raw::dqcs_gate_controlled_matrix(handle)));
+    }
+
     /**
      * Returns whether this gate has a matrix.
      *
@@ -4217,6 +5358,72 @@ namespace wrap {
       return check(raw::dqcs_gate_has_matrix(handle));
     }
 
+    /**
+     * Returns whether this gate is known to be a predefined gate.
+     *
+     * Gates constructed from a predefined gate type remember that type, as
+     * long as this is cheap to track. A gate for which this returns false may
+     * still be equivalent to a predefined gate; use a gate map to detect
+     * those.
+     *
+     * \returns Whether the predefined gate type of this gate is known.
+     * \throws std::runtime_error When the current handle is invalid.
+     */
+    bool has_predefined() const {
+      return check(raw::dqcs_gate_has_predef(handle));
+    }
+
+    /**
+     * Returns the predefined gate type this gate was constructed from.
+     *
+     * The number of control qubits is not part of the returned type; a CNOT
+     * gate for instance returns `PredefinedGate::X`.
+     *
+     * \returns The predefined gate type.
+     * \throws std::runtime_error When the current handle is invalid or the
+     * predefined gate type is not known.
+     */
+    PredefinedGate get_predefined() const {
+      return check(raw::dqcs_gate_predef(handle));
+    }
+
+    /**
+     * Returns whether this gate is known to be the given predefined gate,
+     * including its number of control qubits.
+     *
+     * This does not compare matrices, so it is cheap enough to use for
+     * dispatching in a backend.
+     *
+     * \tparam G The gate tag, for instance `gates::H` or `gates::CNOT`.
+     * \returns Whether this gate is known to be a `G` gate.
+     * \throws std::runtime_error When the current handle is invalid.
+     */
+    template <class G>
+    bool is() const {
+      return get_fingerprint() == G::fingerprint;
+    }
+
+    /**
+     * Returns the fingerprint of this gate.
+     *
+     * The fingerprint packs the gate type, the predefined gate type (if
+     * known), and the qubit counts of the gate into a single integer, which
+     * can be compared against compile-time constants such as
+     * `gates::H::fingerprint` or the result of `gate_fingerprint()`. This
+     * costs a single call into DQCsim and does not compare matrices, so it is
+     * the cheapest way to dispatch on the kind of an incoming gate.
+     *
+     * \returns The fingerprint of this gate.
+     * \throws std::runtime_error When the current handle is invalid.
+     */
+    uint64_t get_fingerprint() const {
+      uint64_t fingerprint = raw::dqcs_gate_fingerprint(handle);
+      if (fingerprint == 0) {
+        throw std::runtime_error(raw::dqcs_error_get());
+      }
+      return fingerprint;
+    }
+
     /**
      * Returns the name of a custom gate.
      *
@@ -4276,7 +5483,12 @@ namespace wrap {
         QubitSet qubits_wrapper = QubitSet();
         ArbData params_wrapper = ArbData();
         params_wrapper.set_arb(gate_wrapper);
-        if (!(*converter)->detect(std::move(gate_wrapper), qubits_wrapper, params_wrapper)) {
+        bool matched = (*converter)->detect(std::move(gate_wrapper), qubits_wrapper, params_wrapper);
+
+        // The gate handle is owned by DQCsim, which reuses the gate object
+        // for the next call, so it must not be deleted here.
+        gate_wrapper.take_handle();
+        if (!matched) {
           return raw::dqcs_bool_return_t::DQCS_FALSE;
         }
         *qubits = qubits_wrapper.take_handle();
@@ -4550,6 +5762,7 @@ namespace wrap {
      * gates: if a gate is received for the second time, the cache will hit,
      * avoiding recomputation of the detector functions. What constitutes
      * "similar gates" is defined by the two booleans passed to this function.
+     * The cache is bounded; use `with_cache_capacity()` to change its size.
      *
      * \param strip_qubit_refs If set, all qubit references associated with the
      * gate will be invalidated (i.e., set to 0), such that for instance an X
@@ -4580,6 +5793,67 @@ namespace wrap {
      */
     GateMap &operator=(GateMap&&) = default;
 
+    /**
+     * Sets the maximum number of gates retained in the detection cache.
+     *
+     * When the cache is full, the least recently used gate is evicted. The
+     * default capacity is 1024 gates.
+     *
+     * \param capacity The maximum number of cached gates. Zero disables the
+     * cache.
+     * \throws std::runtime_error When the gate map handle is invalid.
+     */
+    void set_cache_capacity(size_t capacity) {
+      check(raw::dqcs_gm_cache_capacity_set(handle, capacity));
+    }
+
+    /**
+     * Sets the maximum number of gates retained in the detection cache
+     * (builder pattern).
+     *
+     * When the cache is full, the least recently used gate is evicted. The
+     * default capacity is 1024 gates.
+     *
+     * \param capacity The maximum number of cached gates. Zero disables the
+     * cache.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the gate map handle is invalid.
+     */
+    GateMap &&with_cache_capacity(size_t capacity) {
+      set_cache_capacity(capacity);
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the maximum number of gates retained in the detection cache.
+     *
+     * \returns The maximum number of cached gates.
+     * \throws std::runtime_error When the gate map handle is invalid.
+     */
+    size_t get_cache_capacity() const {
+      return check(raw::dqcs_gm_cache_capacity_get(handle));
+    }
+
+    /**
+     * Returns the number of detections that were served by the cache.
+     *
+     * \returns The number of cache hits.
+     * \throws std::runtime_error When the gate map handle is invalid.
+     */
+    size_t get_cache_hits() const {
+      return check(raw::dqcs_gm_cache_hits(handle));
+    }
+
+    /**
+     * Returns the number of detections that were not served by the cache.
+     *
+     * \returns The number of cache misses.
+     * \throws std::runtime_error When the gate map handle is invalid.
+     */
+    size_t get_cache_misses() const {
+      return check(raw::dqcs_gm_cache_misses(handle));
+    }
+
     /**
      * Adds a unitary gate mapping for the given DQCsim-defined gate.
      *
@@ -5329,42 +6603,469 @@ namespace wrap {
   };
 
   /**
-   * Class representation of the measurement result for a single qubit.
-   *
-   * Measurement objects carry the following information:
-   *
-   *  - which qubit was measured;
-   *  - what the measured state was (zero, one, or undefined);
-   *  - optional arbitrary data.
-   *
-   * You can construct the arbitrary data part of a measurement object with the
-   * builder pattern, for instance:
-   *
-   * \code
-   * Measurement(1_q, MeasurementValue::One)
-   *    .with_json_string("{\"hello\": \"world\"}")
-   *    .with_arg<int>(33)
-   *    .with_arg_string("I'm a string!");
-   * \endcode
+   * Compile-time converter descriptors for `StaticGateMap`.
+   *
+   * Each descriptor maps a kind of DQCsim gate to a `Key` value known at
+   * compile time. A descriptor exposes the key, the fingerprint that
+   * matching gates have (see `Gate::get_fingerprint()`), and the bitmask of
+   * the fingerprint fields that must match. It also knows how to register
+   * itself with a regular `GateMap`, which `StaticGateMap` uses for gates
+   * that do not carry enough information to be matched by fingerprint.
    */
-  class Measurement : public Arb {
-  public:
+  namespace converters {
 
     /**
-     * Wraps the given measurement handle.
-     *
-     * \note This constructor does not verify that the handle is actually
-     * valid.
+     * Maps the predefined gate described by a tag from the `gates` namespace,
+     * with exactly the number of control qubits specified by the tag, to the
+     * given key.
      *
-     * \param handle The raw handle to wrap.
+     * \tparam Key The key type of the gate map.
+     * \tparam K The key that this gate maps to.
+     * \tparam G The gate tag, for instance `gates::H` or `gates::CNOT`.
      */
-    Measurement(HandleIndex handle) noexcept : Arb(handle) {
-    }
+    template <class Key, Key K, class G>
+    struct Unitary {
+
+      /**
+       * The key that matching gates map to.
+       */
+      static constexpr Key key = K;
+
+      /**
+       * The fingerprint of matching gates.
+       */
+      static constexpr uint64_t fingerprint = G::fingerprint;
+
+      /**
+       * The fingerprint fields that must match.
+       */
+      static constexpr uint64_t mask = ~(uint64_t)0;
+
+      /**
+       * Registers the equivalent converter with a regular gate map.
+       */
+      static void add_to(GateMap<size_t> &map, size_t index) {
+        map.with_unitary(index, G::type, (int)G::num_controls);
+      }
+
+    };
+
+    template <class Key, Key K, class G>
+    constexpr Key Unitary<Key, K, G>::key;
+    template <class Key, Key K, class G>
+    constexpr uint64_t Unitary<Key, K, G>::fingerprint;
+    template <class Key, Key K, class G>
+    constexpr uint64_t Unitary<Key, K, G>::mask;
 
     /**
-     * Constructs a measurement object.
+     * Maps Z-basis measurements of any number of qubits to the given key.
      *
-     * \param qubit The qubit reference that this measurement belongs to.
+     * \tparam Key The key type of the gate map.
+     * \tparam K The key that this gate maps to.
+     */
+    template <class Key, Key K>
+    struct Measure {
+
+      /**
+       * The key that matching gates map to.
+       */
+      static constexpr Key key = K;
+
+      /**
+       * The fingerprint of matching gates, ignoring the qubit counts.
+       */
+      static constexpr uint64_t fingerprint = gate_fingerprint(
+        GateType::Measurement, static_cast<uint64_t>(PredefinedGate::I), 0, 0);
+
+      /**
+       * The fingerprint fields that must match.
+       */
+      static constexpr uint64_t mask = GATE_FINGERPRINT_KIND_MASK;
+
+      /**
+       * Registers the equivalent converter with a regular gate map.
+       */
+      static void add_to(GateMap<size_t> &map, size_t index) {
+        map.with_measure(index, PauliBasis::Z);
+      }
+
+    };
+
+    template <class Key, Key K>
+    constexpr Key Measure<Key, K>::key;
+    template <class Key, Key K>
+    constexpr uint64_t Measure<Key, K>::fingerprint;
+    template <class Key, Key K>
+    constexpr uint64_t Measure<Key, K>::mask;
+
+    /**
+     * Maps Z-basis prep gates for any number of qubits to the given key.
+     *
+     * \tparam Key The key type of the gate map.
+     * \tparam K The key that this gate maps to.
+     */
+    template <class Key, Key K>
+    struct Prep {
+
+      /**
+       * The key that matching gates map to.
+       */
+      static constexpr Key key = K;
+
+      /**
+       * The fingerprint of matching gates, ignoring the qubit counts.
+       */
+      static constexpr uint64_t fingerprint = gate_fingerprint(
+        GateType::Prep, static_cast<uint64_t>(PredefinedGate::I), 0, 0);
+
+      /**
+       * The fingerprint fields that must match.
+       */
+      static constexpr uint64_t mask = GATE_FINGERPRINT_KIND_MASK;
+
+      /**
+       * Registers the equivalent converter with a regular gate map.
+       */
+      static void add_to(GateMap<size_t> &map, size_t index) {
+        map.with_prep(index, PauliBasis::Z);
+      }
+
+    };
+
+    template <class Key, Key K>
+    constexpr Key Prep<Key, K>::key;
+    template <class Key, Key K>
+    constexpr uint64_t Prep<Key, K>::fingerprint;
+    template <class Key, Key K>
+    constexpr uint64_t Prep<Key, K>::mask;
+
+  } // namespace converters
+
+  /**
+   * Gate map with its converters fixed at compile time.
+   *
+   * A `StaticGateMap` maps incoming gates to values of a `Key` type, usually
+   * an enumeration of the gates supported by a backend. The converters are
+   * given as template arguments from the `converters` namespace, for
+   * instance:
+   *
+   * \code
+   * enum class Op { H, CNOT, Measure };
+   * using OpMap = StaticGateMap<Op,
+   *   converters::Unitary<Op, Op::H, gates::H>,
+   *   converters::Unitary<Op, Op::CNOT, gates::CNOT>,
+   *   converters::Measure<Op, Op::Measure>>;
+   * \endcode
+   *
+   * The converters are compiled into a flat table of fingerprints. Detecting
+   * a gate costs a single call into DQCsim to get its fingerprint (see
+   * `Gate::get_fingerprint()`) followed by a scan of this table, without
+   * constructing any wrapper objects or calling back into C++. Only gates
+   * that do not match the table are passed to a regular `GateMap`, which
+   * contains the same converters followed by any custom converters added at
+   * runtime. This catches gates whose predefined type is not known, for
+   * instance a unitary gate constructed from an X matrix, as well as gates
+   * handled by custom converters.
+   *
+   * The converters are tried in order, and the compile-time converters take
+   * precedence over the custom converters. Note that the table matches
+   * gates by their exact predefined gate type, so a gate constructed as
+   * `RZ_90` maps to an `RZ_90` converter even if an `S` converter, which is
+   * equal up to global phase, precedes it.
+   *
+   * \tparam Key The key type. Since the keys are template arguments, this
+   * must be an integral or enumeration type.
+   * \tparam Converters The compile-time converters, from the `converters`
+   * namespace.
+   */
+  template <class Key, class... Converters>
+  class StaticGateMap {
+  private:
+
+    /**
+     * Entry of the compile-time dispatch table.
+     */
+    struct Entry {
+
+      /**
+       * The fingerprint of matching gates, masked by `mask`.
+       */
+      uint64_t fingerprint;
+
+      /**
+       * The fingerprint fields that must match.
+       */
+      uint64_t mask;
+
+      /**
+       * The key that matching gates map to.
+       */
+      Key key;
+
+    };
+
+    /**
+     * The compile-time dispatch table. The last entry is a sentinel that
+     * ensures that the array is never empty; it is not scanned.
+     */
+    static constexpr Entry table[sizeof...(Converters) + 1] = {
+      {Converters::fingerprint, Converters::mask, Converters::key}...,
+      {0, ~(uint64_t)0, Key()}
+    };
+
+    /**
+     * Gate map used for gates that do not match the dispatch table. Its
+     * keys are indices into `keys`.
+     */
+    GateMap<size_t> fallback;
+
+    /**
+     * The keys corresponding to the converters in `fallback`. The
+     * compile-time converters come first, in order, followed by the custom
+     * converters.
+     */
+    std::vector<Key> keys;
+
+    /**
+     * Returns the index of the first converter for the given key.
+     */
+    size_t index_of(Key key) const {
+      for (size_t index = 0; index < keys.size(); index++) {
+        if (keys[index] == key) {
+          return index;
+        }
+      }
+      throw std::invalid_argument("no converter defined for the given key");
+    }
+
+  public:
+
+    /**
+     * Constructs a new static gate map.
+     *
+     * \param strip_qubit_refs Passed on to the fallback `GateMap`; see
+     * `GateMap::GateMap()`.
+     * \param strip_data Passed on to the fallback `GateMap`; see
+     * `GateMap::GateMap()`.
+     * \throws std::runtime_error When construction of the fallback gate map
+     * fails.
+     */
+    StaticGateMap(bool strip_qubit_refs = false, bool strip_data = false)
+      : fallback(strip_qubit_refs, strip_data), keys{Converters::key...}
+    {
+      size_t index = 0;
+      int expand[] = {0, (Converters::add_to(fallback, index++), 0)...};
+      (void)expand;
+    }
+
+    /**
+     * Adds a custom gate mapping. Gates that do not match any of the
+     * compile-time converters are passed to the custom converters in the
+     * order in which they were added.
+     *
+     * \param key The key that matching gates map to.
+     * \param converter An object deriving from `CustomGateConverter`,
+     * implemented by you to handle the conversion.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the fallback gate map handle is
+     * invalid.
+     */
+    StaticGateMap &&with_custom(
+      Key key,
+      const std::shared_ptr<CustomGateConverter> &converter
+    ) {
+      fallback.with_custom(keys.size(), converter);
+      keys.push_back(key);
+      return std::move(*this);
+    }
+
+    /**
+     * Adds a custom unitary gate mapping. Gates that do not match any of the
+     * compile-time converters are passed to the custom converters in the
+     * order in which they were added.
+     *
+     * \param key The key that matching gates map to.
+     * \param converter An object deriving from `CustomUnitaryGateConverter`,
+     * implemented by you to handle the conversion.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the fallback gate map handle is
+     * invalid.
+     */
+    StaticGateMap &&with_unitary(
+      Key key,
+      const std::shared_ptr<CustomUnitaryGateConverter> &converter
+    ) {
+      fallback.with_unitary(keys.size(), converter);
+      keys.push_back(key);
+      return std::move(*this);
+    }
+
+    /**
+     * Sets the maximum number of gates retained in the detection cache of
+     * the fallback gate map (builder pattern).
+     *
+     * \param capacity The maximum number of cached gates. Zero disables the
+     * cache.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the fallback gate map handle is
+     * invalid.
+     */
+    StaticGateMap &&with_cache_capacity(size_t capacity) {
+      fallback.set_cache_capacity(capacity);
+      return std::move(*this);
+    }
+
+    /**
+     * Detects the key for an incoming DQCsim gate.
+     *
+     * This is intended for a backend's `gate` callback; the operands can be
+     * read with `Gate::get_targets_small()` and friends.
+     *
+     * \param gate The gate to detect.
+     * \param key Receives the key of the first converter that matched. If
+     * there is no match, this is left unchanged.
+     * \returns Whether a match occurred.
+     * \throws std::runtime_error When the gate handle is invalid or one of
+     * the custom detector functions returned an error.
+     */
+    bool detect(const Gate &gate, Key &key) {
+      uint64_t fingerprint = gate.get_fingerprint();
+      for (size_t index = 0; index < sizeof...(Converters); index++) {
+        if ((fingerprint & table[index].mask) == table[index].fingerprint) {
+          key = table[index].key;
+          return true;
+        }
+      }
+      const size_t *index = nullptr;
+      if (!fallback.detect(gate, &index, nullptr, nullptr)) {
+        return false;
+      }
+      key = keys[*index];
+      return true;
+    }
+
+    /**
+     * Detects the key for an incoming DQCsim gate, also returning its qubit
+     * arguments and parameters in the same form as `GateMap::detect()`.
+     *
+     * \param gate The gate to detect.
+     * \param key Receives the key of the first converter that matched. If
+     * there is no match, this is left unchanged.
+     * \param qubits If non-null and the incoming gate matches, the given
+     * `QubitSet` is set to the qubit arguments for the matched gate.
+     * \param params If non-null and the incoming gate matches, the given
+     * `ArbData` is set to the parameterization data for the matched gate.
+     * \returns Whether a match occurred.
+     * \throws std::runtime_error When the gate handle is invalid or one of
+     * the custom detector functions returned an error.
+     */
+    bool detect(const Gate &gate, Key &key, QubitSet *qubits, ArbData *params) {
+      uint64_t fingerprint = gate.get_fingerprint();
+      for (size_t index = 0; index < sizeof...(Converters); index++) {
+        if ((fingerprint & table[index].mask) == table[index].fingerprint) {
+          key = table[index].key;
+
+          // The compile-time converters take the control qubits, targets,
+          // and measured qubits in that order, at most two of which are
+          // nonempty, and pass the gate data through unchanged.
+          if (qubits) {
+            *qubits = gate.get_controls();
+            for (const QubitRef &qubit : gate.get_targets().drain_into_vector()) {
+              qubits->push(qubit);
+            }
+            for (const QubitRef &qubit : gate.get_measures().drain_into_vector()) {
+              qubits->push(qubit);
+            }
+          }
+          if (params) {
+            *params = ArbData();
+            params->set_arb(gate);
+          }
+          return true;
+        }
+      }
+      const size_t *index = nullptr;
+      if (!fallback.detect(gate, &index, qubits, params)) {
+        return false;
+      }
+      key = keys[*index];
+      return true;
+    }
+
+    /**
+     * Constructs a DQCsim gate for the given key, using the first converter
+     * that maps to it.
+     *
+     * \param key The key of the gate to construct.
+     * \param qubits The qubit arguments for the gate.
+     * \param params The parameterization data for the gate.
+     * \returns The constructed DQCsim gate.
+     * \throws std::invalid_argument When no converter maps to `key`.
+     * \throws std::runtime_error When the converter function returns an
+     * error, or one of the involved handles is invalid.
+     */
+    Gate construct(Key key, QubitSet &&qubits, ArbData &&params) {
+      return fallback.construct(index_of(key), std::move(qubits), std::move(params));
+    }
+
+    /**
+     * Constructs a DQCsim gate for the given key, using the first converter
+     * that maps to it.
+     *
+     * \param key The key of the gate to construct.
+     * \param qubits The qubit arguments for the gate.
+     * \returns The constructed DQCsim gate.
+     * \throws std::invalid_argument When no converter maps to `key`.
+     * \throws std::runtime_error When the converter function returns an
+     * error, or one of the involved handles is invalid.
+     */
+    Gate construct(Key key, QubitSet &&qubits) {
+      return fallback.construct(index_of(key), std::move(qubits));
+    }
+
+  };
+
+  template <class Key, class... Converters>
+  constexpr typename StaticGateMap<Key, Converters...>::Entry
+    StaticGateMap<Key, Converters...>::table[sizeof...(Converters) + 1];
+
+  /**
+   * Class representation of the measurement result for a single qubit.
+   *
+   * Measurement objects carry the following information:
+   *
+   *  - which qubit was measured;
+   *  - what the measured state was (zero, one, or undefined);
+   *  - optional arbitrary data.
+   *
+   * You can construct the arbitrary data part of a measurement object with the
+   * builder pattern, for instance:
+   *
+   * \code
+   * Measurement(1_q, MeasurementValue::One)
+   *    .with_json_string("{\"hello\": \"world\"}")
+   *    .with_arg<int>(33)
+   *    .with_arg_string("I'm a string!");
+   * \endcode
+   */
+  class Measurement : public Arb {
+  public:
+
+    /**
+     * Wraps the given measurement handle.
+     *
+     * \note This constructor does not verify that the handle is actually
+     * valid.
+     *
+     * \param handle The raw handle to wrap.
+     */
+    Measurement(HandleIndex handle) noexcept : Arb(handle) {
+    }
+
+    /**
+     * Constructs a measurement object.
+     *
+     * \param qubit The qubit reference that this measurement belongs to.
      * \param value The measurement value.
      * \throws std::runtime_error When construction of the new handle failed
      * for some reason.
@@ -5648,18 +7349,21 @@ namespace wrap {
      * reason.
      */
     std::vector<Measurement> drain_into_vector() {
+      std::vector<HandleIndex> handles(size());
+      size_t count = check(raw::dqcs_mset_take_all(handle, handles.data(), handles.size()));
       std::vector<Measurement> measurements;
-      while (size()) {
-        measurements.emplace_back(take_any());
+      measurements.reserve(count);
+      for (size_t i = 0; i < count; i++) {
+        measurements.emplace_back(handles[i]);
       }
       return measurements;
     }
 
     /**
-     * Copies the qubit set into a vector.
+     * Copies the measurement set into a vector.
      *
-     * \note This requires destructive iteration, so the function is not const;
-     * if an exception occurs, the state of the measurement set may be changed.
+     * \note This function is not `const` for historical reasons; it does not
+     * modify the measurement set.
      *
      * \returns A `std::vector` containing the individual measurement objects
      * in arbitrary order.
@@ -5668,11 +7372,14 @@ namespace wrap {
      * reason.
      */
     std::vector<Measurement> copy_into_vector() {
-      std::vector<Measurement> vector = drain_into_vector();
-      MeasurementSet copy = MeasurementSet::from_iter(vector);
-      free();
-      handle = copy.take_handle();
-      return vector;
+      std::vector<HandleIndex> handles(size());
+      size_t count = check(raw::dqcs_mset_get_all(handle, handles.data(), handles.size()));
+      std::vector<Measurement> measurements;
+      measurements.reserve(count);
+      for (size_t i = 0; i < count; i++) {
+        measurements.emplace_back(handles[i]);
+      }
+      return measurements;
     }
 
     /**
@@ -5718,6 +7425,99 @@ namespace wrap {
 
   };
 
+  /**
+   * Buffer for gates that are to be sent downstream as a single batch.
+   *
+   * Gates can be pushed into the buffer one at a time, after which the whole
+   * buffer can be sent to the downstream plugin using
+   * `PluginState::gate_batch()`. This only costs a single call into DQCsim
+   * and a single message to the downstream plugin, as opposed to one of each
+   * per gate.
+   */
+  class GateBuffer {
+  private:
+
+    /**
+     * The buffered gates.
+     */
+    std::vector<Gate> gates;
+
+  public:
+
+    /**
+     * Constructs an empty gate buffer.
+     */
+    GateBuffer() noexcept = default;
+
+    /**
+     * Constructs an empty gate buffer with room for the given number of gates.
+     *
+     * \param capacity The number of gates to reserve room for.
+     */
+    explicit GateBuffer(size_t capacity) {
+      gates.reserve(capacity);
+    }
+
+    // Delete the copy constructor and assignment operator; gates cannot be
+    // copied without going through the C API.
+    GateBuffer(const GateBuffer&) = delete;
+    void operator=(const GateBuffer&) = delete;
+
+    // Default move constructor and assignment operator.
+    GateBuffer(GateBuffer&&) = default;
+    GateBuffer &operator=(GateBuffer&&) = default;
+
+    /**
+     * Appends a gate to the buffer.
+     *
+     * \param gate The gate to append.
+     */
+    void push(Gate &&gate) {
+      gates.push_back(std::move(gate));
+    }
+
+    /**
+     * Appends a gate to the buffer (builder pattern).
+     *
+     * \param gate The gate to append.
+     * \returns This buffer, to continue building.
+     */
+    GateBuffer &&with(Gate &&gate) {
+      push(std::move(gate));
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the number of gates in the buffer.
+     *
+     * \returns The number of gates in the buffer.
+     */
+    size_t size() const noexcept {
+      return gates.size();
+    }
+
+    /**
+     * Returns whether the buffer is empty.
+     *
+     * \returns Whether the buffer is empty.
+     */
+    bool empty() const noexcept {
+      return gates.empty();
+    }
+
+    /**
+     * Moves the buffered gates out of the buffer, leaving it empty.
+     *
+     * \returns The buffered gates.
+     */
+    std::vector<Gate> drain() noexcept {
+      std::vector<Gate> result;
+      std::swap(result, gates);
+      return result;
+    }
+
+  };
+
   /**
    * Wrapper for DQCsim's internal plugin state within the context of
    * upstream-synchronous plugin callbacks (that is, the `modify_measurement`
@@ -5773,6 +7573,67 @@ namespace wrap {
       return raw::dqcs_plugin_random_u64(state);
     }
 
+    /**
+     * Fills a buffer with random floating point numbers using the simulator
+     * random seed.
+     *
+     * This yields the same numbers as calling `random_f64()` `num` times, but
+     * requires only a single call into DQCsim.
+     *
+     * \param buffer The buffer to fill. Must have room for at least `num`
+     * doubles.
+     * \param num The number of random numbers to generate.
+     * \throws std::runtime_error When the buffer is null while `num` is
+     * nonzero, or when the plugin state is invalid.
+     */
+    void random_fill_f64(double *buffer, size_t num) {
+      check(raw::dqcs_plugin_random_fill_f64(state, buffer, num));
+    }
+
+    /**
+     * Fills a buffer with random integers using the simulator random seed.
+     *
+     * This yields the same numbers as calling `random_u64()` `num` times, but
+     * requires only a single call into DQCsim.
+     *
+     * \param buffer The buffer to fill. Must have room for at least `num`
+     * integers.
+     * \param num The number of random numbers to generate.
+     * \throws std::runtime_error When the buffer is null while `num` is
+     * nonzero, or when the plugin state is invalid.
+     */
+    void random_fill_u64(uint64_t *buffer, size_t num) {
+      check(raw::dqcs_plugin_random_fill_u64(state, buffer, num));
+    }
+
+    /**
+     * Generates a vector of random floating point numbers using the simulator
+     * random seed.
+     *
+     * \param num The number of random numbers to generate.
+     * \returns A vector of uniformly distributed floating-point numbers
+     * between 0 (inclusive) and 1 (exclusive).
+     * \throws std::runtime_error When the plugin state is invalid.
+     */
+    std::vector<double> random_f64(size_t num) {
+      std::vector<double> result(num);
+      random_fill_f64(result.data(), num);
+      return result;
+    }
+
+    /**
+     * Generates a vector of random integers using the simulator random seed.
+     *
+     * \param num The number of random numbers to generate.
+     * \returns A vector of uniformly distributed unsigned 64-bit integers.
+     * \throws std::runtime_error When the plugin state is invalid.
+     */
+    std::vector<uint64_t> random_u64(size_t num) {
+      std::vector<uint64_t> result(num);
+      random_fill_u64(result.data(), num);
+      return result;
+    }
+
     /**
      * Generates a random value using the simulator random seed.
      *
@@ -5785,9 +7646,7 @@ namespace wrap {
     template <typename T>
     T random() noexcept {
       uint64_t data[(sizeof(T) + 7) / 8];
-      for (size_t i = 0; i < (sizeof(T) + 7) / 8; i++) {
-        data = random_u64();
-      }
+      raw::dqcs_plugin_random_fill_u64(state, data, (sizeof(T) + 7) / 8);
       T retval;
       std::memcpy(&retval, data, sizeof(T));
       return retval;
@@ -5796,10 +7655,72 @@ namespace wrap {
   };
 
   /**
-   * Wrapper for DQCsim's internal plugin state within the context of
-   * downstream-synchronous plugin callbacks.
+   * Refers to the result of a measurement that was sent downstream, which may
+   * not have been received yet.
    *
-   * Cannot be moved or copied, as it must stay in scope of the plugin
+   * Measurement futures are obtained using `PluginState::measurement_future`
+   * or the `measure_*_async` shorthands, and must be consumed using either
+   * `PluginState::wait` or `PluginState::when_ready`. Like `QubitRef`, this is
+   * just a type-safe wrapper around a 64-bit integer.
+   */
+  class MeasurementFuture {
+  private:
+
+    /**
+     * The raw future wrapped by this object.
+     */
+    raw::dqcs_future_t future;
+
+  public:
+
+    /**
+     * Wraps a raw measurement future.
+     *
+     * \param future The raw measurement future to wrap.
+     * \throws std::runtime_error When the future is invalid (zero).
+     */
+    explicit MeasurementFuture(raw::dqcs_future_t future) : future(future) {
+      if (future == 0) {
+        throw std::runtime_error("Measurement futures cannot be zero in DQCsim");
+      }
+    }
+
+    /**
+     * Measurement future equality operator.
+     *
+     * \param other The measurement future to compare with.
+     * \returns Whether the futures refer to the same measurement request.
+     */
+    bool operator==(const MeasurementFuture &other) const noexcept {
+      return future == other.future;
+    }
+
+    /**
+     * Measurement future inequality operator.
+     *
+     * \param other The measurement future to compare with.
+     * \returns Whether the futures refer to different measurement requests.
+     */
+    bool operator!=(const MeasurementFuture &other) const noexcept {
+      return future != other.future;
+    }
+
+    /**
+     * Returns the raw measurement future.
+     *
+     * \returns The raw measurement future.
+     */
+    raw::dqcs_future_t get_raw() const noexcept {
+      return future;
+    }
+
+  };
+
+  /**
+   * Wrapper for DQCsim's internal plugin state within the context of
+   * downstream-synchronous plugin callbacks.
+   *
+   * Cannot be moved or copied, as it must stay in scope of the plugin
    * callbacks. Can also not be constructed except for by the callback wrapper
    * classes.
    */
@@ -5981,7 +7902,23 @@ namespace wrap {
      * plugin will not be (immediately) visible.
      */
     void free(const QubitRef &qubit) {
-      free(QubitSet().with(qubit));
+      free(QubitSpan(qubit));
+    }
+
+    /**
+     * Frees the given downstream qubits without constructing a qubit set
+     * handle.
+     *
+     * \param qubits The qubits to free, for instance `{a, b}`.
+     * \throws std::runtime_error When an asynchronous exception is received
+     * or this is called by a backend plugin.
+     *
+     * \note This function is implemented asynchronously for multiprocessing
+     * performance reasons. Therefore, any exception thrown by the downstream
+     * plugin will not be (immediately) visible.
+     */
+    void free(QubitSpan qubits) {
+      check(raw::dqcs_plugin_free_array(state, qubits.data(), qubits.size()));
     }
 
     /**
@@ -6000,6 +7937,68 @@ namespace wrap {
       check(raw::dqcs_plugin_gate(state, gate.get_handle()));
     }
 
+    /**
+     * Sends a predefined gate identified by a compile-time tag to the
+     * downstream plugin.
+     *
+     * \tparam G The gate tag, for instance `gates::H` or `gates::CNOT`.
+     * \param qubits The qubits that the gate should operate on, control
+     * qubits first. The number of qubits is checked at compile time.
+     * \throws std::runtime_error When the gate could not be constructed, an
+     * asynchronous exception is received, or this is called by a backend
+     * plugin.
+     *
+     * \note This function is implemented asynchronously for multiprocessing
+     * performance reasons. Therefore, any exception thrown by the downstream
+     * plugin will not be (immediately) visible.
+     */
+    template <class G, class... Qubits>
+    void gate(const Qubits&... qubits) {
+      gate(Gate::predefined<G>(qubits...));
+    }
+
+    /**
+     * Sends a sequence of gates to the downstream plugin as a single batch.
+     *
+     * This is equivalent to calling `gate()` for each gate in order, but all
+     * gates are validated before any of them is sent, and the whole batch is
+     * sent as a single message.
+     *
+     * \param gates The gates to send.
+     * \throws std::runtime_error When any of the gate handles is invalid, an
+     * asynchronous exception is received, or this is called by a backend
+     * plugin. In this case, none of the gates are sent.
+     *
+     * \note This function is implemented asynchronously for multiprocessing
+     * performance reasons. Therefore, any exception thrown by the downstream
+     * plugin will not be (immediately) visible.
+     */
+    void gate_batch(std::vector<Gate> &&gates) {
+      std::vector<HandleIndex> handles;
+      handles.reserve(gates.size());
+      for (const Gate &gate : gates) {
+        handles.push_back(gate.get_handle());
+      }
+      check(raw::dqcs_plugin_gate_batch(state, handles.data(), handles.size()));
+    }
+
+    /**
+     * Sends all gates in the given buffer to the downstream plugin as a single
+     * batch, leaving the buffer empty.
+     *
+     * \param buffer The buffer containing the gates to send.
+     * \throws std::runtime_error When any of the gate handles is invalid, an
+     * asynchronous exception is received, or this is called by a backend
+     * plugin. In this case, none of the gates are sent.
+     *
+     * \note This function is implemented asynchronously for multiprocessing
+     * performance reasons. Therefore, any exception thrown by the downstream
+     * plugin will not be (immediately) visible.
+     */
+    void gate_batch(GateBuffer &buffer) {
+      gate_batch(buffer.drain());
+    }
+
     /**
      * Shorthand for sending a single-qubit gate to the downstream plugin.
      *
@@ -6013,8 +8012,8 @@ namespace wrap {
      * plugin will not be (immediately) visible.
      */
     void gate(const Matrix &matrix, const QubitRef &q) {
-      if (matrix.size() == 2) {
-        gate(Gate::unitary(QubitSet().with(q), matrix));
+      if (matrix.dimension() == 2) {
+        gate(Gate::unitary({q}, matrix));
       } else {
         throw std::invalid_argument("matrix has incorrect size");
       }
@@ -6037,10 +8036,11 @@ namespace wrap {
      * plugin will not be (immediately) visible.
      */
     void gate(const Matrix &matrix, const QubitRef &qa, const QubitRef &qb) {
-      if (matrix.size() == 2) {
-        gate(Gate::unitary(QubitSet().with(qb), QubitSet().with(qa), matrix));
-      } else if (matrix.size() == 4) {
-        gate(Gate::unitary(QubitSet().with(qa).with(qb), matrix));
+      size_t dimension = matrix.dimension();
+      if (dimension == 2) {
+        gate(Gate::unitary({qb}, {qa}, matrix));
+      } else if (dimension == 4) {
+        gate(Gate::unitary({qa, qb}, matrix));
       } else {
         throw std::invalid_argument("matrix has incorrect size");
       }
@@ -6073,12 +8073,13 @@ namespace wrap {
      * plugin will not be (immediately) visible.
      */
     void gate(const Matrix &matrix, const QubitRef &qa, const QubitRef &qb, const QubitRef &qc) {
-      if (matrix.size() == 2) {
-        gate(Gate::unitary(QubitSet().with(qc), QubitSet().with(qa).with(qb), matrix));
-      } else if (matrix.size() == 4) {
-        gate(Gate::unitary(QubitSet().with(qb).with(qc), QubitSet().with(qa), matrix));
-      } else if (matrix.size() == 8) {
-        gate(Gate::unitary(QubitSet().with(qa).with(qb).with(qc), matrix));
+      size_t dimension = matrix.dimension();
+      if (dimension == 2) {
+        gate(Gate::unitary({qc}, {qa, qb}, matrix));
+      } else if (dimension == 4) {
+        gate(Gate::unitary({qb, qc}, {qa}, matrix));
+      } else if (dimension == 8) {
+        gate(Gate::unitary({qa, qb, qc}, matrix));
       } else {
         throw std::invalid_argument("matrix has incorrect size");
       }
@@ -6250,6 +8251,57 @@ namespace wrap {
       measure_z(QubitSet(qs));
     }
 
+    /**
+     * Shorthand for sending a single-qubit Z-axis measurement to the
+     * downstream plugin, returning a future for its result.
+     *
+     * \param q The qubit to measure.
+     * \returns A future for the measurement result.
+     * \throws std::runtime_error When an asynchronous exception is received,
+     * or this is called by a backend plugin.
+     */
+    MeasurementFuture measure_z_async(const QubitRef &q) {
+      measure_z(q);
+      return measurement_future(q);
+    }
+
+    /**
+     * Shorthand for sending a single-qubit X-axis measurement to the
+     * downstream plugin, returning a future for its result.
+     *
+     * This sends the same gates as `measure_x`.
+     *
+     * \param q The qubit to measure.
+     * \returns A future for the measurement result.
+     * \throws std::runtime_error When an asynchronous exception is received,
+     * or this is called by a backend plugin.
+     */
+    MeasurementFuture measure_x_async(const QubitRef &q) {
+      gate(Matrix(PredefinedGate::H), q);
+      MeasurementFuture future = measure_z_async(q);
+      gate(Matrix(PredefinedGate::H), q);
+      return future;
+    }
+
+    /**
+     * Shorthand for sending a single-qubit Y-axis measurement to the
+     * downstream plugin, returning a future for its result.
+     *
+     * This sends the same gates as `measure_y`.
+     *
+     * \param q The qubit to measure.
+     * \returns A future for the measurement result.
+     * \throws std::runtime_error When an asynchronous exception is received,
+     * or this is called by a backend plugin.
+     */
+    MeasurementFuture measure_y_async(const QubitRef &q) {
+      gate(Matrix(PredefinedGate::S), q);
+      gate(Matrix(PredefinedGate::Z), q);
+      MeasurementFuture future = measure_x_async(q);
+      gate(Matrix(PredefinedGate::S), q);
+      return future;
+    }
+
     /**
      * Tells the downstream plugin to run for the specified number of cycles.
      *
@@ -6303,6 +8355,81 @@ namespace wrap {
       return Measurement(check(raw::dqcs_plugin_get_measurement(state, qubit.get_index())));
     }
 
+    /**
+     * Returns a future for the latest measurement of the given downstream
+     * qubit, without waiting for the downstream plugin to return it.
+     *
+     * \param qubit The qubit to return a measurement future for.
+     * \returns A future for the latest measurement result, which must be
+     * consumed using `wait`, `when_ready`, or `discard`.
+     * \throws std::runtime_error When the qubit has never been measured or
+     * this is called by a backend plugin.
+     */
+    MeasurementFuture measurement_future(const QubitRef &qubit) {
+      return MeasurementFuture(check(raw::dqcs_plugin_measurement_future(state, qubit.get_index())));
+    }
+
+    /**
+     * Returns whether the result of the given measurement future has been
+     * received, without blocking.
+     *
+     * This depends on how far the downstream plugin has progressed, so it is
+     * not deterministic. Pending `when_ready` callbacks for futures that have
+     * become ready are called before this returns.
+     *
+     * \param future The measurement future to check.
+     * \returns Whether `wait` would return without blocking.
+     * \throws std::runtime_error When the future does not exist or has
+     * already been consumed, or a `when_ready` callback throws.
+     */
+    bool is_ready(const MeasurementFuture &future) {
+      return check(raw::dqcs_plugin_measurement_ready(state, future.get_raw()));
+    }
+
+    /**
+     * Waits for the result of the given measurement future and consumes it.
+     *
+     * \param future The measurement future to wait for.
+     * \returns The measurement result.
+     * \throws std::runtime_error When the future does not exist or has
+     * already been consumed, or a `when_ready` callback throws.
+     */
+    Measurement wait(const MeasurementFuture &future) {
+      return Measurement(check(raw::dqcs_plugin_measurement_wait(state, future.get_raw())));
+    }
+
+    /**
+     * Registers a callback to be called with the result of the given
+     * measurement future, and consumes the future.
+     *
+     * If the result has already been received, the callback is called
+     * immediately. Otherwise, it is called from within the first call to
+     * `is_ready`, `wait`, or `get_measurement` after the result is received.
+     * Callbacks that are still pending when the plugin is finalized are never
+     * called.
+     *
+     * \param future The measurement future to attach the callback to.
+     * \param cb The callback to call with the measurement result.
+     * \throws std::runtime_error When the future does not exist or has
+     * already been consumed, or the callback is called immediately and throws.
+     */
+    void when_ready(const MeasurementFuture &future, std::function<void(PluginState&, Measurement&&)> &&cb);
+
+    /**
+     * Consumes the given measurement future without waiting for its result.
+     *
+     * This releases the resources DQCsim uses to keep track of futures that
+     * turn out not to be needed. The result of the measurement can still be
+     * queried using `get_measurement` once it has been received.
+     *
+     * \param future The measurement future to discard.
+     * \throws std::runtime_error When the future does not exist or has
+     * already been consumed.
+     */
+    void discard(const MeasurementFuture &future) {
+      check(raw::dqcs_plugin_measurement_discard(state, future.get_raw()));
+    }
+
     /**
      * Returns the number of downstream cycles since the latest measurement of
      * the given downstream qubit.
@@ -6415,6 +8542,38 @@ namespace wrap {
       return ArbData(check(raw::dqcs_plugin_recv(state)));
     }
 
+    /**
+     * Records a measurement outcome in the histogram of the simulation.
+     *
+     * The outcome is a bitstring of up to 64 bits, usually the result of one
+     * shot. The host can read back how often each outcome was recorded using
+     * `Simulation::get_outcomes()`, which is much cheaper than sending a
+     * message for every shot.
+     *
+     * \param outcome The outcome to record.
+     * \throws std::runtime_error When recording fails for some reason.
+     */
+    void record_outcome(uint64_t outcome) {
+      check(raw::dqcs_plugin_record_outcome(state, outcome));
+    }
+
+    /**
+     * Records the latest measurement results of the given downstream qubits
+     * as an outcome in the histogram of the simulation.
+     *
+     * Bit i of the recorded outcome is set if the latest measurement of the
+     * i-th qubit returned one. This waits for the measurement results like
+     * `get_measurement()` does.
+     *
+     * \param qubits The qubits to record, at most 64, for instance `{a, b}`.
+     * \throws std::runtime_error When more than 64 qubits are specified, one
+     * of the qubits is not allocated, or one of the measurement results is
+     * undefined.
+     */
+    void record_measurements(QubitSpan qubits) {
+      check(raw::dqcs_plugin_record_measurements(state, qubits.data(), qubits.size()));
+    }
+
   };
 
   /**
@@ -6611,11 +8770,21 @@ namespace wrap {
      */
     typedef Callback<MeasurementSet, UpstreamPluginState&, Measurement&&> ModifyMeasurement;
 
+    /**
+     * Callback wrapper specialized for the `modify_measurements` callback.
+     */
+    typedef Callback<MeasurementSet, UpstreamPluginState&, MeasurementSet&&> ModifyMeasurements;
+
     /**
      * Callback wrapper specialized for the `advance` callback.
      */
     typedef Callback<void, PluginState&, Cycle> Advance;
 
+    /**
+     * Callback wrapper specialized for measurement future continuations.
+     */
+    typedef Callback<void, PluginState&, Measurement&&> MeasurementReady;
+
     /**
      * Callback wrapper specialized for the `*_arb` callbacks.
      */
@@ -6675,6 +8844,7 @@ namespace wrap {
    */
   class CallbackEntryPoints {
   private:
+    friend class PluginState;
     friend class Plugin;
     friend class SimulationConfiguration;
     friend class PluginConfigurationBuilder;
@@ -6851,6 +9021,30 @@ namespace wrap {
       return 0;
     }
 
+    /**
+     * Entry point for the `modify_measurements` callback.
+     */
+    static raw::dqcs_handle_t modify_measurements(
+      void *user_data,
+      raw::dqcs_plugin_state_t state,
+      raw::dqcs_handle_t mset
+    ) noexcept {
+
+      // Wrap inputs.
+      callback::ModifyMeasurements *cb_wrapper = reinterpret_cast<callback::ModifyMeasurements*>(user_data);
+      UpstreamPluginState state_wrapper(state);
+      MeasurementSet mset_wrapper(mset);
+
+      // Catch exceptions thrown in the user function to convert them to
+      // DQCsim's error reporting protocol.
+      try {
+        return (*(cb_wrapper->cb))(state_wrapper, std::move(mset_wrapper)).take_handle();
+      } catch (const std::exception &e) {
+        raw::dqcs_error_set(e.what());
+      }
+      return 0;
+    }
+
     /**
      * Entry point for the `advance` callback.
      */
@@ -6988,6 +9182,31 @@ namespace wrap {
       }
     }
 
+    /**
+     * Entry point for measurement future continuations.
+     */
+    static raw::dqcs_return_t measurement_ready(
+      void *user_data,
+      raw::dqcs_plugin_state_t state,
+      raw::dqcs_handle_t meas
+    ) noexcept {
+
+      // Wrap inputs.
+      callback::MeasurementReady *cb_wrapper = reinterpret_cast<callback::MeasurementReady*>(user_data);
+      PluginState state_wrapper(state);
+      Measurement meas_wrapper(meas);
+
+      // Catch exceptions thrown in the user function to convert them to
+      // DQCsim's error reporting protocol.
+      try {
+        (*(cb_wrapper->cb))(state_wrapper, std::move(meas_wrapper));
+        return raw::dqcs_return_t::DQCS_SUCCESS;
+      } catch (const std::exception &e) {
+        raw::dqcs_error_set(e.what());
+      }
+      return raw::dqcs_return_t::DQCS_FAILURE;
+    }
+
     /**
      * Entry point for freeing callback data structures.
      */
@@ -7000,6 +9219,20 @@ namespace wrap {
   };
   //! \endcond
 
+  // DQCsim takes ownership of the callback even if this fails, so it must not
+  // be deleted here.
+  inline void PluginState::when_ready(
+    const MeasurementFuture &future,
+    std::function<void(PluginState&, Measurement&&)> &&cb
+  ) {
+    check(raw::dqcs_plugin_measurement_when_ready(
+      state,
+      future.get_raw(),
+      CallbackEntryPoints::measurement_ready,
+      CallbackEntryPoints::user_free<callback::MeasurementReady>,
+      new callback::MeasurementReady(std::move(cb))));
+  }
+
   /**
    * Class wrapper for plugin join handles.
    *
@@ -7081,18 +9314,19 @@ namespace wrap {
    * The following matrix shows which functions are required (x), optional (o),
    * and not applicable (-):
    *
-   * | Callback             | Frontend  | Operator  |  Backend  |
-   * |----------------------|:---------:|:---------:|:---------:|
-   * | `initialize`         |     o     |     o     |     o     |
-   * | `drop`               |     o     |     o     |     o     |
-   * | `run`                |     x     |     -     |     -     |
-   * | `allocate`           |     -     |     o     |     o     |
-   * | `free`               |     -     |     o     |     o     |
-   * | `gate`               |     -     |     o     |     x     |
-   * | `modify_measurement` |     -     |     o     |     -     |
-   * | `advance`            |     -     |     o     |     o     |
-   * | `upstream_arb`       |     -     |     o     |     o     |
-   * | `host_arb`           |     o     |     o     |     o     |
+   * | Callback              | Frontend  | Operator  |  Backend  |
+   * |-----------------------|:---------:|:---------:|:---------:|
+   * | `initialize`          |     o     |     o     |     o     |
+   * | `drop`                |     o     |     o     |     o     |
+   * | `run`                 |     x     |     -     |     -     |
+   * | `allocate`            |     -     |     o     |     o     |
+   * | `free`                |     -     |     o     |     o     |
+   * | `gate`                |     -     |     o     |     x     |
+   * | `modify_measurement`  |     -     |     o     |     -     |
+   * | `modify_measurements` |     -     |     o     |     -     |
+   * | `advance`             |     -     |     o     |     o     |
+   * | `upstream_arb`        |     -     |     o     |     o     |
+   * | `host_arb`            |     o     |     o     |     o     |
    *
    * These callbacks perform the following functions.
    *
@@ -7242,6 +9476,17 @@ namespace wrap {
    * asynchronously with respect to the downstream functions, making the timing
    * of these calls non-deterministic based on operating system scheduling.
    *
+   * # Modify-measurements
+   *
+   * This callback replaces the modify-measurement callback when set. Instead
+   * of once for every measurement, it is called once with a set of all the
+   * measurement results received from the downstream plugin at the same
+   * time, such as those for a gate that measures many qubits. It returns the
+   * set of measurements that should be reported to the upstream plugin. The
+   * same rules apply as for the modify-measurement callback. Because a
+   * measurement set can only hold one measurement per qubit, the callback is
+   * called more than once when a qubit was measured multiple times.
+   *
    * # Advance
    *
    * This callback is called when the upstream plugin calls `advance` to
@@ -7424,6 +9669,28 @@ namespace wrap {
       return str;
     }
 
+    /**
+     * Fuses a backend plugin definition into this frontend plugin
+     * definition.
+     *
+     * The gatestream requests of a fused frontend are handled by calling the
+     * callbacks of the fused backend directly, from within the frontend's
+     * thread, instead of sending them downstream.
+     *
+     * \param backend The backend plugin definition to fuse into this
+     * frontend. Note that this must be `std::move()`d in if it is not
+     * constructed in-place. It is only consumed if the call succeeds.
+     * \returns A stand-in backend plugin definition with the metadata of the
+     * fused backend, which must be used in its place in the simulation.
+     * \throws std::runtime_error When this is not a frontend without a fused
+     * backend, or when `backend` is not a backend.
+     */
+    Plugin fuse(Plugin &&backend) {
+      Plugin stand_in(check(raw::dqcs_pdef_fuse(handle, backend.get_handle())));
+      backend.take_handle();
+      return stand_in;
+    }
+
     // Code below is generated using the following Python script:
     // print('    // Code below is generated using the following Python script:')
     // with open(__file__, 'r') as f:
@@ -7503,6 +9770,7 @@ namespace wrap {
     //     ('free',                'free',                 'Free'),
     //     ('gate',                'gate',                 'Gate'),
     //     ('modify-measurement',  'modify_measurement',   'ModifyMeasurement'),
+    //     ('modify-measurements', 'modify_measurements',  'ModifyMeasurements'),
     //     ('advance',             'advance',              'Advance'),
     //     ('upstream-arb',        'upstream_arb',         'Arb'),
     //     ('host-arb',            'host_arb',             'Arb'),
@@ -7961,16 +10229,16 @@ namespace wrap {
   private:
 
     /**
-     * Assigns the advance callback function from a `new`-initialized
-     * raw pointer to a `callback::Advance` object. Callee will ensure that
+     * Assigns the modify-measurements callback function from a `new`-initialized
+     * raw pointer to a `callback::ModifyMeasurements` object. Callee will ensure that
      * `delete` is called.
      */
-    void set_advance(callback::Advance *cb) {
+    void set_modify_measurements(callback::ModifyMeasurements *cb) {
       try {
-        check(raw::dqcs_pdef_set_advance_cb(
+        check(raw::dqcs_pdef_set_modify_measurements_cb(
           handle,
-          CallbackEntryPoints::advance,
-          CallbackEntryPoints::user_free<callback::Advance>,
+          CallbackEntryPoints::modify_measurements,
+          CallbackEntryPoints::user_free<callback::ModifyMeasurements>,
           cb));
       } catch (...) {
         delete cb;
@@ -7981,35 +10249,35 @@ namespace wrap {
   public:
 
     /**
-     * Assigns the advance callback function from a pre-existing
-     * `callback::Advance` object by copy.
+     * Assigns the modify-measurements callback function from a pre-existing
+     * `callback::ModifyMeasurements` object by copy.
      *
      * \param cb The callback object.
      * \returns `&self`, to continue building.
      * \throws std::runtime_error When the current handle is invalid or of an
      * unsupported plugin type, or when the callback object is invalid.
      */
-    Plugin &&with_advance(const callback::Advance &cb) {
-      set_advance(new callback::Advance(cb));
+    Plugin &&with_modify_measurements(const callback::ModifyMeasurements &cb) {
+      set_modify_measurements(new callback::ModifyMeasurements(cb));
       return std::move(*this);
     }
 
     /**
-     * Assigns the advance callback function from a pre-existing
-     * `callback::Advance` object by move.
+     * Assigns the modify-measurements callback function from a pre-existing
+     * `callback::ModifyMeasurements` object by move.
      *
      * \param cb The callback object.
      * \returns `&self`, to continue building.
      * \throws std::runtime_error When the current handle is invalid or of an
      * unsupported plugin type, or when the callback object is invalid.
      */
-    Plugin &&with_advance(callback::Advance &&cb) {
-      set_advance(new callback::Advance(std::move(cb)));
+    Plugin &&with_modify_measurements(callback::ModifyMeasurements &&cb) {
+      set_modify_measurements(new callback::ModifyMeasurements(std::move(cb)));
       return std::move(*this);
     }
 
     /**
-     * Assigns the advance callback function by constructing the
+     * Assigns the modify-measurements callback function by constructing the
      * callback object implicitly.
      *
      * \returns `&self`, to continue building.
@@ -8017,24 +10285,24 @@ namespace wrap {
      * unsupported plugin type, or when the callback object is invalid.
      */
     template<typename... Args>
-    Plugin &&with_advance(Args... args) {
-      set_advance(new callback::Advance(args...));
+    Plugin &&with_modify_measurements(Args... args) {
+      set_modify_measurements(new callback::ModifyMeasurements(args...));
       return std::move(*this);
     }
 
   private:
 
     /**
-     * Assigns the upstream-arb callback function from a `new`-initialized
-     * raw pointer to a `callback::Arb` object. Callee will ensure that
+     * Assigns the advance callback function from a `new`-initialized
+     * raw pointer to a `callback::Advance` object. Callee will ensure that
      * `delete` is called.
      */
-    void set_upstream_arb(callback::Arb *cb) {
+    void set_advance(callback::Advance *cb) {
       try {
-        check(raw::dqcs_pdef_set_upstream_arb_cb(
+        check(raw::dqcs_pdef_set_advance_cb(
           handle,
-          CallbackEntryPoints::upstream_arb,
-          CallbackEntryPoints::user_free<callback::Arb>,
+          CallbackEntryPoints::advance,
+          CallbackEntryPoints::user_free<callback::Advance>,
           cb));
       } catch (...) {
         delete cb;
@@ -8045,31 +10313,95 @@ namespace wrap {
   public:
 
     /**
-     * Assigns the upstream-arb callback function from a pre-existing
-     * `callback::Arb` object by copy.
+     * Assigns the advance callback function from a pre-existing
+     * `callback::Advance` object by copy.
      *
      * \param cb The callback object.
      * \returns `&self`, to continue building.
      * \throws std::runtime_error When the current handle is invalid or of an
      * unsupported plugin type, or when the callback object is invalid.
      */
-    Plugin &&with_upstream_arb(const callback::Arb &cb) {
-      set_upstream_arb(new callback::Arb(cb));
+    Plugin &&with_advance(const callback::Advance &cb) {
+      set_advance(new callback::Advance(cb));
       return std::move(*this);
     }
 
     /**
-     * Assigns the upstream-arb callback function from a pre-existing
-     * `callback::Arb` object by move.
+     * Assigns the advance callback function from a pre-existing
+     * `callback::Advance` object by move.
      *
      * \param cb The callback object.
      * \returns `&self`, to continue building.
      * \throws std::runtime_error When the current handle is invalid or of an
      * unsupported plugin type, or when the callback object is invalid.
      */
-    Plugin &&with_upstream_arb(callback::Arb &&cb) {
-      set_upstream_arb(new callback::Arb(std::move(cb)));
-      return std::move(*this);
+    Plugin &&with_advance(callback::Advance &&cb) {
+      set_advance(new callback::Advance(std::move(cb)));
+      return std::move(*this);
+    }
+
+    /**
+     * Assigns the advance callback function by constructing the
+     * callback object implicitly.
+     *
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the current handle is invalid or of an
+     * unsupported plugin type, or when the callback object is invalid.
+     */
+    template<typename... Args>
+    Plugin &&with_advance(Args... args) {
+      set_advance(new callback::Advance(args...));
+      return std::move(*this);
+    }
+
+  private:
+
+    /**
+     * Assigns the upstream-arb callback function from a `new`-initialized
+     * raw pointer to a `callback::Arb` object. Callee will ensure that
+     * `delete` is called.
+     */
+    void set_upstream_arb(callback::Arb *cb) {
+      try {
+        check(raw::dqcs_pdef_set_upstream_arb_cb(
+          handle,
+          CallbackEntryPoints::upstream_arb,
+          CallbackEntryPoints::user_free<callback::Arb>,
+          cb));
+      } catch (...) {
+        delete cb;
+        throw;
+      }
+    }
+
+  public:
+
+    /**
+     * Assigns the upstream-arb callback function from a pre-existing
+     * `callback::Arb` object by copy.
+     *
+     * \param cb The callback object.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the current handle is invalid or of an
+     * unsupported plugin type, or when the callback object is invalid.
+     */
+    Plugin &&with_upstream_arb(const callback::Arb &cb) {
+      set_upstream_arb(new callback::Arb(cb));
+      return std::move(*this);
+    }
+
+    /**
+     * Assigns the upstream-arb callback function from a pre-existing
+     * `callback::Arb` object by move.
+     *
+     * \param cb The callback object.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the current handle is invalid or of an
+     * unsupported plugin type, or when the callback object is invalid.
+     */
+    Plugin &&with_upstream_arb(callback::Arb &&cb) {
+      set_upstream_arb(new callback::Arb(std::move(cb)));
+      return std::move(*this);
     }
 
     /**
@@ -8310,6 +10642,75 @@ namespace wrap {
      */
     virtual void log_tee(Loglevel verbosity, const std::string &filename) = 0;
 
+    /**
+     * Limits the number of gatestream requests that the plugin may have in
+     * flight to its downstream plugin.
+     *
+     * \param window The maximum number of requests in flight, or 0 for no
+     * limit.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    virtual void set_downstream_window(size_t window) = 0;
+
+    /**
+     * Returns the maximum number of gatestream requests that the plugin may
+     * have in flight to its downstream plugin.
+     *
+     * \returns The maximum number of requests in flight, or 0 if there is no
+     * limit.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    virtual size_t get_downstream_window() const = 0;
+
+    /**
+     * Configures how the plugin waits for incoming gatestream messages.
+     *
+     * \param strategy Whether to block right away, or to busy-poll or poll
+     * while yielding before blocking.
+     * \param spin_time The maximum time to poll for in seconds. Ignored for
+     * `ReceiveStrategy::Block`.
+     * \throws std::runtime_error When the plugin definition handle is invalid
+     * or the polling time is negative or infinite.
+     */
+    virtual void set_receive_strategy(ReceiveStrategy strategy, double spin_time = 0.0) = 0;
+
+    /**
+     * Returns how the plugin waits for incoming gatestream messages.
+     *
+     * \returns The configured receive strategy.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    virtual ReceiveStrategy get_receive_strategy() const = 0;
+
+    /**
+     * Returns the maximum time that the plugin polls for incoming gatestream
+     * messages before blocking.
+     *
+     * \returns The polling time in seconds, or 0 when the plugin blocks right
+     * away.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    virtual double get_receive_spin_time() const = 0;
+
+    /**
+     * Records the gatestream messages that the plugin sends to its downstream
+     * plugin to the given capture file.
+     *
+     * \param filename The capture file to write.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    virtual void set_downstream_capture(const std::string &filename) = 0;
+
+    /**
+     * Returns the file that the gatestream messages sent by the plugin to its
+     * downstream plugin are recorded to.
+     *
+     * \returns The configured capture file.
+     * \throws std::runtime_error When the plugin definition handle is invalid
+     * or recording is disabled.
+     */
+    virtual std::string get_downstream_capture() const = 0;
+
   };
 
   /**
@@ -8556,216 +10957,546 @@ namespace wrap {
     }
 
     /**
-     * Configures a plugin thread to also output its log messages to a file.
+     * Configures a plugin thread to also output its log messages to a file.
+     *
+     * \param verbosity Configures the verbosity level for the tee'd output
+     * file only.
+     * \param filename The path to the file to tee log messages to.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    void log_tee(Loglevel verbosity, const std::string &filename) override {
+      return check(raw::dqcs_pcfg_tee(handle, to_raw(verbosity), filename.c_str()));
+    }
+
+    /**
+     * Configures a plugin thread to also output its log messages to a file
+     * (builder pattern).
+     *
+     * \param verbosity Configures the verbosity level for the tee'd output
+     * file only.
+     * \param filename The path to the file to tee log messages to.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    PluginProcessConfiguration &&with_log_tee(Loglevel verbosity, const std::string &filename) {
+      log_tee(verbosity, filename);
+      return std::move(*this);
+    }
+
+    /**
+     * Configures the capture mode for the stdout stream of the specified
+     * plugin process.
+     *
+     * \param level The loglevel with which stdout is captured.
+     * `Loglevel::Pass` instructs the logging thread to not capture stdout at
+     * all.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    void set_stdout_loglevel(Loglevel level) {
+      check(raw::dqcs_pcfg_stdout_mode_set(handle, to_raw(level)));
+    }
+
+    /**
+     * Configures the capture mode for the stdout stream of the specified
+     * plugin process (builder pattern).
+     *
+     * \param level The loglevel with which stdout is captured.
+     * `Loglevel::Pass` instructs the logging thread to not capture stdout at
+     * all.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    PluginProcessConfiguration &&with_stdout_loglevel(Loglevel level) {
+      set_stdout_loglevel(level);
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the configured stdout capture mode for the specified plugin
+     * process.
+     *
+     * \returns The configured stdout capture mode.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    Loglevel get_stdout_loglevel() const {
+      return check(raw::dqcs_pcfg_stdout_mode_get(handle));
+    }
+
+    /**
+     * Configures the capture mode for the stderr stream of the specified
+     * plugin process.
+     *
+     * \param level The loglevel with which stderr is captured.
+     * `Loglevel::Pass` instructs the logging thread to not capture stderr at
+     * all.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    void set_stderr_loglevel(Loglevel level) {
+      check(raw::dqcs_pcfg_stderr_mode_set(handle, to_raw(level)));
+    }
+
+    /**
+     * Configures the capture mode for the stderr stream of the specified
+     * plugin process (builder pattern).
+     *
+     * \param level The loglevel with which stderr is captured.
+     * `Loglevel::Pass` instructs the logging thread to not capture stderr at
+     * all.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    PluginProcessConfiguration &&with_stderr_loglevel(Loglevel level) {
+      set_stderr_loglevel(level);
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the configured stderr capture mode for the specified plugin
+     * process.
+     *
+     * \returns The configured stderr capture mode.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    Loglevel get_stderr_loglevel() const {
+      return check(raw::dqcs_pcfg_stderr_mode_get(handle));
+    }
+
+    /**
+     * Configures the timeout for the plugin process to connect to DQCsim.
+     *
+     * The default is 5 seconds, so you should normally be able to leave this
+     * alone.
+     *
+     * \param timeout The timeout in seconds. You can use IEEE positive
+     * infinity from `<limits>` to specify an infinite timeout.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    void set_accept_timeout(double timeout) {
+      check(raw::dqcs_pcfg_accept_timeout_set(handle, timeout));
+    }
+
+    /**
+     * Configures the timeout for the plugin process to connect to DQCsim
+     * (builder pattern).
+     *
+     * The default is 5 seconds, so you should normally be able to leave this
+     * alone.
+     *
+     * \param timeout The timeout in seconds. You can use IEEE positive
+     * infinity from `<limits>` to specify an infinite timeout.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    PluginProcessConfiguration &&with_accept_timeout(double timeout) {
+      set_accept_timeout(timeout);
+      return std::move(*this);
+    }
+
+    /**
+     * Disables the timeout for the plugin process to connect to DQCsim
+     * (builder pattern).
+     *
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    PluginProcessConfiguration &&without_accept_timeout() {
+      set_accept_timeout(std::numeric_limits<double>::infinity());
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the configured timeout for the plugin process to connect to
+     * DQCsim.
+     *
+     * \returns The configured timeout in seconds.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    double get_accept_timeout() const {
+      return check(raw::dqcs_pcfg_accept_timeout_get(handle));
+    }
+
+    /**
+     * Configures the timeout for the plugin process to shut down gracefully.
+     *
+     * The default is 5 seconds, so you should normally be able to leave this
+     * alone.
+     *
+     * \param timeout The timeout in seconds. You can use IEEE positive
+     * infinity from `<limits>` to specify an infinite timeout.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    void set_shutdown_timeout(double timeout) {
+      check(raw::dqcs_pcfg_shutdown_timeout_set(handle, timeout));
+    }
+
+    /**
+     * Configures the timeout for the plugin process to shut down gracefully
+     * (builder pattern).
+     *
+     * The default is 5 seconds, so you should normally be able to leave this
+     * alone.
+     *
+     * \param timeout The timeout in seconds. You can use IEEE positive
+     * infinity from `<limits>` to specify an infinite timeout.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    PluginProcessConfiguration &&with_shutdown_timeout(double timeout) {
+      set_shutdown_timeout(timeout);
+      return std::move(*this);
+    }
+
+    /**
+     * Disables the timeout for the plugin process to shut down gracefully
+     * (builder pattern).
+     *
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    PluginProcessConfiguration &&without_shutdown_timeout() {
+      set_shutdown_timeout(std::numeric_limits<double>::infinity());
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the configured timeout for the plugin process to shut down
+     * gracefully.
+     *
+     * \returns The configured timeout in seconds.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    double get_shutdown_timeout() const {
+      return check(raw::dqcs_pcfg_shutdown_timeout_get(handle));
+    }
+
+    /**
+     * Configures the gatestream connection from this plugin to its downstream
+     * plugin to use a ring buffer in shared memory instead of a socket-based
+     * IPC channel.
+     *
+     * \param capacity The size of the ring buffer in bytes. Must be a power of
+     * two of at least 64 bytes. 0 selects the socket-based IPC channel.
+     * \throws std::runtime_error When the plugin definition handle is invalid
+     * or the capacity is invalid.
+     */
+    void set_downstream_shm(size_t capacity) {
+      check(raw::dqcs_pcfg_downstream_shm_set(handle, capacity));
+    }
+
+    /**
+     * Configures the gatestream connection from this plugin to its downstream
+     * plugin to use a ring buffer in shared memory instead of a socket-based
+     * IPC channel (builder pattern).
+     *
+     * \param capacity The size of the ring buffer in bytes. Must be a power of
+     * two of at least 64 bytes. Defaults to one megabyte.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid
+     * or the capacity is invalid.
+     */
+    PluginProcessConfiguration &&with_downstream_shm(size_t capacity = 1 << 20) {
+      set_downstream_shm(capacity);
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the ring buffer capacity configured for the gatestream
+     * connection from this plugin to its downstream plugin.
+     *
+     * \returns The capacity in bytes, or 0 if the connection uses the
+     * socket-based IPC channel.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    size_t get_downstream_shm() const {
+      return check(raw::dqcs_pcfg_downstream_shm_get(handle));
+    }
+
+    /**
+     * Limits the number of gatestream requests that the plugin may have in
+     * flight to its downstream plugin.
+     *
+     * When the limit is reached, the plugin blocks until half of the
+     * outstanding requests have been acknowledged. This bounds the memory
+     * used by queued requests when the plugin is much faster than its
+     * downstream plugin.
+     *
+     * \param window The maximum number of requests in flight, or 0 for no
+     * limit.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    void set_downstream_window(size_t window) override {
+      check(raw::dqcs_pcfg_downstream_window_set(handle, window));
+    }
+
+    /**
+     * Limits the number of gatestream requests that the plugin may have in
+     * flight to its downstream plugin (builder pattern).
+     *
+     * \param window The maximum number of requests in flight, or 0 for no
+     * limit.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    PluginProcessConfiguration &&with_downstream_window(size_t window) {
+      set_downstream_window(window);
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the maximum number of gatestream requests that the plugin may
+     * have in flight to its downstream plugin.
+     *
+     * \returns The maximum number of requests in flight, or 0 if there is no
+     * limit.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    size_t get_downstream_window() const override {
+      return check(raw::dqcs_pcfg_downstream_window_get(handle));
+    }
+
+    /**
+     * Configures how the plugin waits for incoming gatestream messages.
      *
-     * \param verbosity Configures the verbosity level for the tee'd output
-     * file only.
-     * \param filename The path to the file to tee log messages to.
-     * \throws std::runtime_error When the plugin definition handle is invalid.
+     * By default, a plugin blocks in the operating system right away when it
+     * has nothing to do. For tightly-coupled plugins that exchange many small
+     * messages, the wakeup latency can dominate. With
+     * `ReceiveStrategy::Spin` or `ReceiveStrategy::Yield`, the plugin polls
+     * for up to `spin_time` seconds before blocking. The polling time adapts
+     * to the traffic, and only shared-memory and in-process gatestream
+     * channels are polled.
+     *
+     * \param strategy Whether to block right away, or to busy-poll or poll
+     * while yielding before blocking.
+     * \param spin_time The maximum time to poll for in seconds. Ignored for
+     * `ReceiveStrategy::Block`.
+     * \throws std::runtime_error When the plugin definition handle is invalid
+     * or the polling time is negative or infinite.
      */
-    void log_tee(Loglevel verbosity, const std::string &filename) override {
-      return check(raw::dqcs_pcfg_tee(handle, to_raw(verbosity), filename.c_str()));
+    void set_receive_strategy(ReceiveStrategy strategy, double spin_time = 0.0) override {
+      check(raw::dqcs_pcfg_receive_strategy_set(handle, to_raw(strategy), spin_time));
     }
 
     /**
-     * Configures a plugin thread to also output its log messages to a file
+     * Configures how the plugin waits for incoming gatestream messages
      * (builder pattern).
      *
-     * \param verbosity Configures the verbosity level for the tee'd output
-     * file only.
-     * \param filename The path to the file to tee log messages to.
+     * \param strategy Whether to block right away, or to busy-poll or poll
+     * while yielding before blocking.
+     * \param spin_time The maximum time to poll for in seconds. Ignored for
+     * `ReceiveStrategy::Block`.
      * \returns `&self`, to continue building.
-     * \throws std::runtime_error When the plugin definition handle is invalid.
+     * \throws std::runtime_error When the plugin definition handle is invalid
+     * or the polling time is negative or infinite.
      */
-    PluginProcessConfiguration &&with_log_tee(Loglevel verbosity, const std::string &filename) {
-      log_tee(verbosity, filename);
+    PluginProcessConfiguration &&with_receive_strategy(ReceiveStrategy strategy, double spin_time = 0.0) {
+      set_receive_strategy(strategy, spin_time);
       return std::move(*this);
     }
 
     /**
-     * Configures the capture mode for the stdout stream of the specified
-     * plugin process.
+     * Returns how the plugin waits for incoming gatestream messages.
      *
-     * \param level The loglevel with which stdout is captured.
-     * `Loglevel::Pass` instructs the logging thread to not capture stdout at
-     * all.
+     * \returns The configured receive strategy.
      * \throws std::runtime_error When the plugin definition handle is invalid.
      */
-    void set_stdout_loglevel(Loglevel level) {
-      check(raw::dqcs_pcfg_stdout_mode_set(handle, to_raw(level)));
+    ReceiveStrategy get_receive_strategy() const override {
+      return check(raw::dqcs_pcfg_receive_strategy_get(handle));
     }
 
     /**
-     * Configures the capture mode for the stdout stream of the specified
-     * plugin process (builder pattern).
+     * Returns the maximum time that the plugin polls for incoming gatestream
+     * messages before blocking.
      *
-     * \param level The loglevel with which stdout is captured.
-     * `Loglevel::Pass` instructs the logging thread to not capture stdout at
-     * all.
-     * \returns `&self`, to continue building.
+     * \returns The polling time in seconds, or 0 when the plugin blocks right
+     * away.
      * \throws std::runtime_error When the plugin definition handle is invalid.
      */
-    PluginProcessConfiguration &&with_stdout_loglevel(Loglevel level) {
-      set_stdout_loglevel(level);
-      return std::move(*this);
+    double get_receive_spin_time() const override {
+      return check(raw::dqcs_pcfg_receive_spin_time_get(handle));
     }
 
     /**
-     * Returns the configured stdout capture mode for the specified plugin
-     * process.
+     * Records the gatestream messages that the plugin sends to its downstream
+     * plugin to the given capture file.
      *
-     * \returns The configured stdout capture mode.
+     * The file is overwritten when the simulation is constructed. It can be
+     * replayed later using the `dqcsfereplay` frontend, for instance to
+     * benchmark the downstream plugins without running the original frontend
+     * again. Relative paths are
+     * interpreted relative to the working directory of the host. This setting has no effect for backends.
+     *
+     * \param filename The capture file to write.
      * \throws std::runtime_error When the plugin definition handle is invalid.
      */
-    Loglevel get_stdout_loglevel() const {
-      return check(raw::dqcs_pcfg_stdout_mode_get(handle));
+    void set_downstream_capture(const std::string &filename) override {
+      check(raw::dqcs_pcfg_downstream_capture_set(handle, filename.c_str()));
     }
 
     /**
-     * Configures the capture mode for the stderr stream of the specified
-     * plugin process.
+     * Records the gatestream messages that the plugin sends to its downstream
+     * plugin to the given capture file (builder pattern).
      *
-     * \param level The loglevel with which stderr is captured.
-     * `Loglevel::Pass` instructs the logging thread to not capture stderr at
-     * all.
+     * \param filename The capture file to write.
+     * \returns `&self`, to continue building.
      * \throws std::runtime_error When the plugin definition handle is invalid.
      */
-    void set_stderr_loglevel(Loglevel level) {
-      check(raw::dqcs_pcfg_stderr_mode_set(handle, to_raw(level)));
+    PluginProcessConfiguration &&with_downstream_capture(const std::string &filename) {
+      set_downstream_capture(filename);
+      return std::move(*this);
     }
 
     /**
-     * Configures the capture mode for the stderr stream of the specified
-     * plugin process (builder pattern).
+     * Returns the file that the gatestream messages sent by the plugin to its
+     * downstream plugin are recorded to.
      *
-     * \param level The loglevel with which stderr is captured.
-     * `Loglevel::Pass` instructs the logging thread to not capture stderr at
-     * all.
-     * \returns `&self`, to continue building.
-     * \throws std::runtime_error When the plugin definition handle is invalid.
+     * \returns The configured capture file.
+     * \throws std::runtime_error When the plugin definition handle is invalid
+     * or recording is disabled.
      */
-    PluginProcessConfiguration &&with_stderr_loglevel(Loglevel level) {
-      set_stderr_loglevel(level);
-      return std::move(*this);
+    std::string get_downstream_capture() const override {
+      char *ptr = check(raw::dqcs_pcfg_downstream_capture_get(handle));
+      std::string retval(ptr);
+      std::free(ptr);
+      return retval;
     }
 
     /**
-     * Returns the configured stderr capture mode for the specified plugin
-     * process.
+     * Configures whether the plugin process should be kept alive for reuse
+     * after the simulation it is part of ends.
      *
-     * \returns The configured stderr capture mode.
+     * Pooled processes are reset instead of shut down when the simulation
+     * ends, and are reused by later simulations with a compatible pooled
+     * plugin configuration. The plugin must be able to handle its
+     * `initialize()` callback being called again after `drop()`.
+     *
+     * \param pooled Whether the plugin process should be pooled.
      * \throws std::runtime_error When the plugin definition handle is invalid.
      */
-    Loglevel get_stderr_loglevel() const {
-      return check(raw::dqcs_pcfg_stderr_mode_get(handle));
+    void set_pooled(bool pooled) {
+      check(raw::dqcs_pcfg_pooled_set(handle, pooled));
     }
 
     /**
-     * Configures the timeout for the plugin process to connect to DQCsim.
+     * Configures whether the plugin process should be kept alive for reuse
+     * after the simulation it is part of ends (builder pattern).
      *
-     * The default is 5 seconds, so you should normally be able to leave this
-     * alone.
+     * \param pooled Whether the plugin process should be pooled.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    PluginProcessConfiguration &&with_pooled(bool pooled = true) {
+      set_pooled(pooled);
+      return std::move(*this);
+    }
+
+    /**
+     * Returns whether the plugin process is kept alive for reuse after the
+     * simulation it is part of ends.
      *
-     * \param timeout The timeout in seconds. You can use IEEE positive
-     * infinity from `<limits>` to specify an infinite timeout.
+     * \returns Whether the plugin process is pooled.
      * \throws std::runtime_error When the plugin definition handle is invalid.
      */
-    void set_accept_timeout(double timeout) {
-      check(raw::dqcs_pcfg_accept_timeout_set(handle, timeout));
+    bool get_pooled() const {
+      return check(raw::dqcs_pcfg_pooled_get(handle));
     }
 
     /**
-     * Configures the timeout for the plugin process to connect to DQCsim
-     * (builder pattern).
+     * Restricts the plugin process to the given logical CPUs.
      *
-     * The default is 5 seconds, so you should normally be able to leave this
-     * alone.
+     * The affinity is applied before the plugin executable is loaded, so it
+     * also applies to the threads the plugin spawns. An empty list removes
+     * the restriction. This is currently only supported on Linux.
      *
-     * \param timeout The timeout in seconds. You can use IEEE positive
-     * infinity from `<limits>` to specify an infinite timeout.
-     * \returns `&self`, to continue building.
-     * \throws std::runtime_error When the plugin definition handle is invalid.
+     * \param cpus The indices of the CPUs the plugin may run on.
+     * \throws std::runtime_error When the plugin configuration handle is
+     * invalid.
      */
-    PluginProcessConfiguration &&with_accept_timeout(double timeout) {
-      set_accept_timeout(timeout);
-      return std::move(*this);
+    void set_cpu_affinity(const std::vector<size_t> &cpus) {
+      check(raw::dqcs_pcfg_cpu_affinity_set(handle, cpus.data(), cpus.size()));
     }
 
     /**
-     * Disables the timeout for the plugin process to connect to DQCsim
-     * (builder pattern).
+     * Restricts the plugin process to the given logical CPUs (builder
+     * pattern).
      *
+     * \param cpus The indices of the CPUs the plugin may run on.
      * \returns `&self`, to continue building.
-     * \throws std::runtime_error When the plugin definition handle is invalid.
+     * \throws std::runtime_error When the plugin configuration handle is
+     * invalid.
      */
-    PluginProcessConfiguration &&without_accept_timeout() {
-      set_accept_timeout(std::numeric_limits<double>::infinity());
+    PluginProcessConfiguration &&with_cpu_affinity(const std::vector<size_t> &cpus) {
+      set_cpu_affinity(cpus);
       return std::move(*this);
     }
 
     /**
-     * Returns the configured timeout for the plugin process to connect to
-     * DQCsim.
+     * Returns the logical CPUs that the plugin process is restricted to.
      *
-     * \returns The configured timeout in seconds.
-     * \throws std::runtime_error When the plugin definition handle is invalid.
+     * \returns The indices of the CPUs, or an empty list if the plugin
+     * inherits the CPU affinity of the simulator.
+     * \throws std::runtime_error When the plugin configuration handle is
+     * invalid.
      */
-    double get_accept_timeout() const {
-      return check(raw::dqcs_pcfg_accept_timeout_get(handle));
+    std::vector<size_t> get_cpu_affinity() const {
+      std::vector<size_t> cpus(check(raw::dqcs_pcfg_cpu_affinity_get(handle, nullptr, 0)));
+      check(raw::dqcs_pcfg_cpu_affinity_get(handle, cpus.data(), cpus.size()));
+      return cpus;
     }
 
     /**
-     * Configures the timeout for the plugin process to shut down gracefully.
+     * Configures the NUMA memory placement policy for the plugin process.
      *
-     * The default is 5 seconds, so you should normally be able to leave this
-     * alone.
+     * `NumaPolicy::Default` takes no nodes, `NumaPolicy::Preferred` takes
+     * exactly one, and the other policies take one or more. This is
+     * currently only supported on Linux.
      *
-     * \param timeout The timeout in seconds. You can use IEEE positive
-     * infinity from `<limits>` to specify an infinite timeout.
-     * \throws std::runtime_error When the plugin definition handle is invalid.
+     * \param policy The memory placement policy.
+     * \param nodes The indices of the NUMA nodes for the policy.
+     * \throws std::runtime_error When the plugin configuration handle is
+     * invalid, or when the number of nodes does not match the policy.
      */
-    void set_shutdown_timeout(double timeout) {
-      check(raw::dqcs_pcfg_shutdown_timeout_set(handle, timeout));
+    void set_numa_policy(NumaPolicy policy, const std::vector<size_t> &nodes = {}) {
+      check(raw::dqcs_pcfg_numa_policy_set(handle, to_raw(policy), nodes.data(), nodes.size()));
     }
 
     /**
-     * Configures the timeout for the plugin process to shut down gracefully
+     * Configures the NUMA memory placement policy for the plugin process
      * (builder pattern).
      *
-     * The default is 5 seconds, so you should normally be able to leave this
-     * alone.
-     *
-     * \param timeout The timeout in seconds. You can use IEEE positive
-     * infinity from `<limits>` to specify an infinite timeout.
+     * \param policy The memory placement policy.
+     * \param nodes The indices of the NUMA nodes for the policy.
      * \returns `&self`, to continue building.
-     * \throws std::runtime_error When the plugin definition handle is invalid.
+     * \throws std::runtime_error When the plugin configuration handle is
+     * invalid, or when the number of nodes does not match the policy.
      */
-    PluginProcessConfiguration &&with_shutdown_timeout(double timeout) {
-      set_shutdown_timeout(timeout);
+    PluginProcessConfiguration &&with_numa_policy(NumaPolicy policy, const std::vector<size_t> &nodes = {}) {
+      set_numa_policy(policy, nodes);
       return std::move(*this);
     }
 
     /**
-     * Disables the timeout for the plugin process to shut down gracefully
-     * (builder pattern).
+     * Returns the NUMA memory placement policy for the plugin process.
      *
-     * \returns `&self`, to continue building.
-     * \throws std::runtime_error When the plugin definition handle is invalid.
+     * \returns The memory placement policy.
+     * \throws std::runtime_error When the plugin configuration handle is
+     * invalid.
      */
-    PluginProcessConfiguration &&without_shutdown_timeout() {
-      set_shutdown_timeout(std::numeric_limits<double>::infinity());
-      return std::move(*this);
+    NumaPolicy get_numa_policy() const {
+      return check(raw::dqcs_pcfg_numa_policy_get(handle));
     }
 
     /**
-     * Returns the configured timeout for the plugin process to shut down
-     * gracefully.
+     * Returns the NUMA nodes of the memory placement policy for the plugin
+     * process.
      *
-     * \returns The configured timeout in seconds.
-     * \throws std::runtime_error When the plugin definition handle is invalid.
+     * \returns The indices of the NUMA nodes.
+     * \throws std::runtime_error When the plugin configuration handle is
+     * invalid.
      */
-    double get_shutdown_timeout() const {
-      return check(raw::dqcs_pcfg_shutdown_timeout_get(handle));
+    std::vector<size_t> get_numa_nodes() const {
+      std::vector<size_t> nodes(check(raw::dqcs_pcfg_numa_nodes_get(handle, nullptr, 0)));
+      check(raw::dqcs_pcfg_numa_nodes_get(handle, nodes.data(), nodes.size()));
+      return nodes;
     }
 
   };
@@ -8911,6 +11642,154 @@ namespace wrap {
       return std::move(*this);
     }
 
+    /**
+     * Limits the number of gatestream requests that the plugin may have in
+     * flight to its downstream plugin.
+     *
+     * When the limit is reached, the plugin blocks until half of the
+     * outstanding requests have been acknowledged. This bounds the memory
+     * used by queued requests when the plugin is much faster than its
+     * downstream plugin.
+     *
+     * \param window The maximum number of requests in flight, or 0 for no
+     * limit.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    void set_downstream_window(size_t window) override {
+      check(raw::dqcs_tcfg_downstream_window_set(handle, window));
+    }
+
+    /**
+     * Limits the number of gatestream requests that the plugin may have in
+     * flight to its downstream plugin (builder pattern).
+     *
+     * \param window The maximum number of requests in flight, or 0 for no
+     * limit.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    PluginThreadConfiguration &&with_downstream_window(size_t window) {
+      set_downstream_window(window);
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the maximum number of gatestream requests that the plugin may
+     * have in flight to its downstream plugin.
+     *
+     * \returns The maximum number of requests in flight, or 0 if there is no
+     * limit.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    size_t get_downstream_window() const override {
+      return check(raw::dqcs_tcfg_downstream_window_get(handle));
+    }
+
+    /**
+     * Configures how the plugin waits for incoming gatestream messages.
+     *
+     * By default, a plugin blocks in the operating system right away when it
+     * has nothing to do. For tightly-coupled plugins that exchange many small
+     * messages, the wakeup latency can dominate. With
+     * `ReceiveStrategy::Spin` or `ReceiveStrategy::Yield`, the plugin polls
+     * for up to `spin_time` seconds before blocking. The polling time adapts
+     * to the traffic, and only shared-memory and in-process gatestream
+     * channels are polled.
+     *
+     * \param strategy Whether to block right away, or to busy-poll or poll
+     * while yielding before blocking.
+     * \param spin_time The maximum time to poll for in seconds. Ignored for
+     * `ReceiveStrategy::Block`.
+     * \throws std::runtime_error When the plugin definition handle is invalid
+     * or the polling time is negative or infinite.
+     */
+    void set_receive_strategy(ReceiveStrategy strategy, double spin_time = 0.0) override {
+      check(raw::dqcs_tcfg_receive_strategy_set(handle, to_raw(strategy), spin_time));
+    }
+
+    /**
+     * Configures how the plugin waits for incoming gatestream messages
+     * (builder pattern).
+     *
+     * \param strategy Whether to block right away, or to busy-poll or poll
+     * while yielding before blocking.
+     * \param spin_time The maximum time to poll for in seconds. Ignored for
+     * `ReceiveStrategy::Block`.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid
+     * or the polling time is negative or infinite.
+     */
+    PluginThreadConfiguration &&with_receive_strategy(ReceiveStrategy strategy, double spin_time = 0.0) {
+      set_receive_strategy(strategy, spin_time);
+      return std::move(*this);
+    }
+
+    /**
+     * Returns how the plugin waits for incoming gatestream messages.
+     *
+     * \returns The configured receive strategy.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    ReceiveStrategy get_receive_strategy() const override {
+      return check(raw::dqcs_tcfg_receive_strategy_get(handle));
+    }
+
+    /**
+     * Returns the maximum time that the plugin polls for incoming gatestream
+     * messages before blocking.
+     *
+     * \returns The polling time in seconds, or 0 when the plugin blocks right
+     * away.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    double get_receive_spin_time() const override {
+      return check(raw::dqcs_tcfg_receive_spin_time_get(handle));
+    }
+
+    /**
+     * Records the gatestream messages that the plugin sends to its downstream
+     * plugin to the given capture file.
+     *
+     * The file is overwritten when the simulation is constructed. It can be
+     * replayed later using the `dqcsfereplay` frontend, for instance to
+     * benchmark the downstream plugins without running the original frontend
+     * again. This setting has no effect for backends.
+     *
+     * \param filename The capture file to write.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    void set_downstream_capture(const std::string &filename) override {
+      check(raw::dqcs_tcfg_downstream_capture_set(handle, filename.c_str()));
+    }
+
+    /**
+     * Records the gatestream messages that the plugin sends to its downstream
+     * plugin to the given capture file (builder pattern).
+     *
+     * \param filename The capture file to write.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the plugin definition handle is invalid.
+     */
+    PluginThreadConfiguration &&with_downstream_capture(const std::string &filename) {
+      set_downstream_capture(filename);
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the file that the gatestream messages sent by the plugin to its
+     * downstream plugin are recorded to.
+     *
+     * \returns The configured capture file.
+     * \throws std::runtime_error When the plugin definition handle is invalid
+     * or recording is disabled.
+     */
+    std::string get_downstream_capture() const override {
+      char *ptr = check(raw::dqcs_tcfg_downstream_capture_get(handle));
+      std::string retval(ptr);
+      std::free(ptr);
+      return retval;
+    }
+
   };
 
   /**
@@ -9252,27 +12131,116 @@ namespace wrap {
      * a deadlock occurs because the frontend is waiting for a call to
      * `send()`.
      */
-    ArbData run(ArbData &&data) {
-      start(std::move(data));
-      return wait();
+    ArbData run(ArbData &&data) {
+      start(std::move(data));
+      return wait();
+    }
+
+    /**
+     * Runs a program on the simulated accelerator using the given `ArbData`
+     * object as an argument (passed by copy).
+     *
+     * This is just a shorthand for `start()` followed by `wait()`.
+     *
+     * \param data An `ArbData` object to pass to the plugin's `run` callback.
+     * \returns The `ArbData` object that was returned by the frontend plugin's
+     * implementation of the `run` callback.
+     * \throws std::runtime_error When the simulation is in an invalid state or
+     * a deadlock occurs because the frontend is waiting for a call to
+     * `send()`.
+     */
+    ArbData run(const ArbData &data) {
+      start(data);
+      return wait();
+    }
+
+    /**
+     * Runs a program on the simulated accelerator the given number of times
+     * without an argument.
+     *
+     * The plugins are reused for every shot, avoiding the cost of spawning
+     * and initializing them for every run. It is up to the frontend to make
+     * sure that every run starts from a clean state.
+     *
+     * \param num_shots The number of times to run the program.
+     * \returns The `ArbData` objects returned by the frontend plugin's
+     * implementation of the `run` callback, in order.
+     * \throws std::runtime_error When the simulation is in an invalid state or
+     * one of the runs fails.
+     */
+    std::vector<ArbData> run_shots(size_t num_shots) {
+      return shots_from_handles(num_shots, [&](raw::dqcs_handle_t *results) {
+        return raw::dqcs_sim_run_shots(handle, 0, num_shots, results);
+      });
+    }
+
+    /**
+     * Runs a program on the simulated accelerator the given number of times
+     * using the given `ArbData` object as the argument for every run.
+     *
+     * The plugins are reused for every shot, avoiding the cost of spawning
+     * and initializing them for every run. It is up to the frontend to make
+     * sure that every run starts from a clean state.
+     *
+     * \param num_shots The number of times to run the program.
+     * \param data An `ArbData` object to pass to the plugin's `run` callback.
+     * \returns The `ArbData` objects returned by the frontend plugin's
+     * implementation of the `run` callback, in order.
+     * \throws std::runtime_error When the simulation is in an invalid state or
+     * one of the runs fails.
+     */
+    std::vector<ArbData> run_shots(size_t num_shots, const ArbData &data) {
+      return shots_from_handles(num_shots, [&](raw::dqcs_handle_t *results) {
+        return raw::dqcs_sim_run_shots(handle, data.get_handle(), num_shots, results);
+      });
+    }
+
+    /**
+     * Shuts down all idle plugin processes kept alive for reuse.
+     *
+     * \returns The number of processes that were shut down.
+     * \throws std::runtime_error When the pool could not be cleared.
+     */
+    static size_t clear_pool() {
+      return check(raw::dqcs_sim_pool_clear());
+    }
+
+    /**
+     * Returns the histogram of the measurement outcomes recorded by the
+     * frontend using `RunningPluginState::record_outcome()` or
+     * `RunningPluginState::record_measurements()`.
+     *
+     * The outcomes are counted over all runs until the histogram is cleared
+     * using `clear_outcomes()`. They are received along with the responses
+     * of the frontend, so everything recorded up to the last time the
+     * frontend blocked is included, for instance at the end of `wait()` or
+     * `run_shots()`.
+     *
+     * \returns The distinct outcomes and the number of times each was
+     * recorded, in ascending order of outcome.
+     * \throws std::runtime_error When the simulation is in an invalid state.
+     */
+    std::vector<std::pair<uint64_t, uint64_t>> get_outcomes() {
+      size_t num_entries = check(raw::dqcs_sim_outcomes(handle, nullptr, nullptr, 0));
+      std::vector<uint64_t> outcomes(num_entries);
+      std::vector<uint64_t> counts(num_entries);
+      check(raw::dqcs_sim_outcomes(handle, outcomes.data(), counts.data(), num_entries));
+      std::vector<std::pair<uint64_t, uint64_t>> histogram;
+      histogram.reserve(num_entries);
+      for (size_t i = 0; i < num_entries; i++) {
+        histogram.emplace_back(outcomes[i], counts[i]);
+      }
+      return histogram;
     }
 
     /**
-     * Runs a program on the simulated accelerator using the given `ArbData`
-     * object as an argument (passed by copy).
-     *
-     * This is just a shorthand for `start()` followed by `wait()`.
+     * Clears the histogram of the measurement outcomes recorded by the
+     * frontend.
      *
-     * \param data An `ArbData` object to pass to the plugin's `run` callback.
-     * \returns The `ArbData` object that was returned by the frontend plugin's
-     * implementation of the `run` callback.
-     * \throws std::runtime_error When the simulation is in an invalid state or
-     * a deadlock occurs because the frontend is waiting for a call to
-     * `send()`.
+     * \throws std::runtime_error When the simulation is in an invalid state.
      */
-    ArbData run(const ArbData &data) {
-      start(data);
-      return wait();
+    void clear_outcomes() {
+      check(raw::dqcs_sim_outcomes_clear(handle));
     }
 
     /**
@@ -9343,6 +12311,52 @@ namespace wrap {
       check(raw::dqcs_sim_yield(handle));
     }
 
+    /**
+     * Yields to the simulator without waiting for it to block again.
+     *
+     * This is the non-blocking counterpart of `yield()`, allowing a single
+     * thread to drive multiple simulations. Use `yield_poll()` to check
+     * whether the simulation has blocked again, and `wait_ready()` and
+     * `recv_ready()` to check whether `wait()` and `recv()` would return
+     * immediately.
+     *
+     * \throws std::runtime_error When the simulation is in an invalid state.
+     */
+    void yield_async() {
+      check(raw::dqcs_sim_yield_async(handle));
+    }
+
+    /**
+     * Checks whether the yield started using `yield_async()` has completed,
+     * without blocking.
+     *
+     * \returns Whether the yield has completed, or no yield was pending.
+     * \throws std::runtime_error When the simulation is in an invalid state.
+     */
+    bool yield_poll() {
+      return check(raw::dqcs_sim_yield_poll(handle));
+    }
+
+    /**
+     * Returns whether `wait()` would return immediately.
+     *
+     * \returns Whether the frontend plugin's `run` callback has returned.
+     * \throws std::runtime_error When the simulation handle is invalid.
+     */
+    bool wait_ready() const {
+      return check(raw::dqcs_sim_wait_ready(handle));
+    }
+
+    /**
+     * Returns whether `recv()` would return immediately.
+     *
+     * \returns Whether a message sent by the accelerator is available.
+     * \throws std::runtime_error When the simulation handle is invalid.
+     */
+    bool recv_ready() const {
+      return check(raw::dqcs_sim_recv_ready(handle));
+    }
+
     /**
      * Sends an `ArbCmd` (passed by move) to the given plugin (referenced by
      * instance name).
@@ -9536,6 +12550,44 @@ namespace wrap {
       check(raw::dqcs_sim_write_reproduction_file(handle, filename.c_str()));
     }
 
+    /**
+     * Queries the performance statistics collected by the plugins.
+     *
+     * The JSON object of the returned `ArbData` maps the instance name of
+     * each plugin to its statistics. Refer to the documentation of
+     * `dqcs_sim_stats()` for the format. Asynchronous requests that have not
+     * been executed yet are not included; call `yield()` first if you need
+     * those as well.
+     *
+     * \returns The collected statistics.
+     * \throws std::runtime_error When the simulation is in an invalid state.
+     */
+    ArbData get_stats() {
+      return ArbData(check(raw::dqcs_sim_stats(handle)));
+    }
+
+  private:
+
+    /**
+     * Helper for the `run_shots()` functions. Calls the given function with
+     * a buffer for `num_shots` `ArbData` handles, and wraps the handles it
+     * returns.
+     */
+    template <typename F>
+    static std::vector<ArbData> shots_from_handles(size_t num_shots, F fill) {
+      std::vector<raw::dqcs_handle_t> handles(num_shots);
+      check(fill(handles.data()));
+      std::vector<ArbData> results;
+      results.reserve(num_shots);
+      for (raw::dqcs_handle_t result : handles) {
+        results.emplace_back(result);
+      }
+      return results;
+    }
+
+    // Allow `SimulationConfiguration::run_shots()` to use the helper above.
+    friend class SimulationConfiguration;
+
   };
 
   /**
@@ -9705,6 +12757,37 @@ namespace wrap {
       return check(raw::dqcs_scfg_repro_path_style_get(handle));
     }
 
+    /**
+     * Streams the reproduction log to the given file in the binary
+     * reproduction format.
+     *
+     * Instead of keeping the host calls in memory until
+     * `Simulation::write_reproduction_file()` is called, they are appended to
+     * the given file as they are made. `write_reproduction_file()` cannot be
+     * used when streaming.
+     *
+     * \param filename The file to stream the reproduction log to.
+     * \throws std::runtime_error When the simulation configuration handle is
+     * invalid for some reason.
+     */
+    void set_reproduction_stream(const std::string &filename) {
+      check(raw::dqcs_scfg_repro_stream_set(handle, filename.c_str()));
+    }
+
+    /**
+     * Streams the reproduction log to the given file in the binary
+     * reproduction format (builder pattern).
+     *
+     * \param filename The file to stream the reproduction log to.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the simulation configuration handle is
+     * invalid for some reason.
+     */
+    SimulationConfiguration &&with_reproduction_stream(const std::string &filename) {
+      set_reproduction_stream(filename);
+      return std::move(*this);
+    }
+
     /**
      * Disables the reproduction logging system.
      *
@@ -9769,6 +12852,125 @@ namespace wrap {
       return check(raw::dqcs_scfg_dqcsim_verbosity_get(handle));
     }
 
+    /**
+     * Configures the loglevel at which the performance statistics of the
+     * plugins are logged when the simulation is shut down.
+     *
+     * \param level The loglevel to use, or `Loglevel::Off` to disable this.
+     * \throws std::runtime_error When the simulation configuration handle is
+     * invalid for some reason.
+     */
+    void set_stats_verbosity(Loglevel level) {
+      check(raw::dqcs_scfg_stats_verbosity_set(handle, to_raw(level)));
+    }
+
+    /**
+     * Configures the loglevel at which the performance statistics of the
+     * plugins are logged when the simulation is shut down (builder pattern).
+     *
+     * \param level The loglevel to use, or `Loglevel::Off` to disable this.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the simulation configuration handle is
+     * invalid for some reason.
+     */
+    SimulationConfiguration &&with_stats_verbosity(Loglevel level) {
+      set_stats_verbosity(level);
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the loglevel at which the performance statistics of the
+     * plugins are logged when the simulation is shut down.
+     *
+     * \returns The configured loglevel.
+     * \throws std::runtime_error When the simulation configuration handle is
+     * invalid for some reason.
+     */
+    Loglevel get_stats_verbosity() const {
+      return check(raw::dqcs_scfg_stats_verbosity_get(handle));
+    }
+
+    /**
+     * Restricts the log thread of the simulator to the given logical CPUs,
+     * such that it does not compete with the plugins. An empty list removes
+     * the restriction. This is currently only supported on Linux.
+     *
+     * \param cpus The indices of the CPUs the log thread may run on.
+     * \throws std::runtime_error When the simulation configuration handle is
+     * invalid for some reason.
+     */
+    void set_log_thread_affinity(const std::vector<size_t> &cpus) {
+      check(raw::dqcs_scfg_log_thread_affinity_set(handle, cpus.data(), cpus.size()));
+    }
+
+    /**
+     * Restricts the log thread of the simulator to the given logical CPUs
+     * (builder pattern).
+     *
+     * \param cpus The indices of the CPUs the log thread may run on.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the simulation configuration handle is
+     * invalid for some reason.
+     */
+    SimulationConfiguration &&with_log_thread_affinity(const std::vector<size_t> &cpus) {
+      set_log_thread_affinity(cpus);
+      return std::move(*this);
+    }
+
+    /**
+     * Returns the logical CPUs that the log thread of the simulator is
+     * restricted to.
+     *
+     * \returns The indices of the CPUs, or an empty list if the log thread
+     * is not restricted.
+     * \throws std::runtime_error When the simulation configuration handle is
+     * invalid for some reason.
+     */
+    std::vector<size_t> get_log_thread_affinity() const {
+      std::vector<size_t> cpus(check(raw::dqcs_scfg_log_thread_affinity_get(handle, nullptr, 0)));
+      check(raw::dqcs_scfg_log_thread_affinity_get(handle, cpus.data(), cpus.size()));
+      return cpus;
+    }
+
+    /**
+     * Enables tracing.
+     *
+     * The plugins record the time they spend in their callbacks and waiting
+     * for their gatestream requests to be acknowledged. When the simulation
+     * is destroyed, the timeline is written to the given file in the Chrome
+     * trace event format.
+     *
+     * \param filename The file to write the trace to.
+     * \throws std::runtime_error When the simulation configuration handle is
+     * invalid for some reason.
+     */
+    void set_trace_file(const std::string &filename) {
+      check(raw::dqcs_scfg_trace_file_set(handle, filename.c_str()));
+    }
+
+    /**
+     * Enables tracing (builder pattern).
+     *
+     * \param filename The file to write the trace to.
+     * \returns `&self`, to continue building.
+     * \throws std::runtime_error When the simulation configuration handle is
+     * invalid for some reason.
+     */
+    SimulationConfiguration &&with_trace_file(const std::string &filename) {
+      set_trace_file(filename);
+      return std::move(*this);
+    }
+
+    /**
+     * Disables tracing.
+     *
+     * \throws std::runtime_error When the simulation configuration handle is
+     * invalid for some reason.
+     */
+    void disable_trace() {
+      check(raw::dqcs_scfg_trace_file_set(handle, nullptr));
+    }
+
     /**
      * Configures the stderr sink verbosity for a simulation.
      *
@@ -10103,6 +13305,297 @@ namespace wrap {
       return sim;
     }
 
+    /**
+     * Function type used to construct the simulation configurations for
+     * `run_shots()`. It is passed the index of the worker thread that it is
+     * called from.
+     */
+    using Factory = std::function<SimulationConfiguration(size_t)>;
+
+    /**
+     * Runs a program the given number of times on a number of simulations in
+     * parallel, using the given `ArbData` object as the argument for every
+     * run.
+     *
+     * Each worker thread constructs its own simulation from the configuration
+     * returned by `factory`, and runs its share of the shots back-to-back on
+     * it. The seed of each configuration is overridden with one derived from
+     * `seed`, so the results are reproducible for a given seed, shot count,
+     * and thread count.
+     *
+     * \param factory Constructs the configuration for each worker. It is
+     * called from within the worker threads, so it must be thread-safe. Note
+     * that handles cannot be shared between threads, so the configuration
+     * must be constructed from scratch.
+     * \param num_shots The number of times to run the program.
+     * \param num_threads The number of simulations to run in parallel.
+     * \param seed The seed from which the simulation seeds are derived.
+     * \param data An `ArbData` object to pass to the plugin's `run` callback.
+     * \param outcomes An optional simulation to which the outcomes recorded
+     * by the worker simulations are added, such that its `get_outcomes()`
+     * counts them as if all shots were run on it. It is not used to run any
+     * shots itself.
+     * \returns The `ArbData` objects returned by the frontend plugin's
+     * implementation of the `run` callback, in order.
+     * \throws std::runtime_error When constructing one of the simulations or
+     * one of the runs fails.
+     */
+    static std::vector<ArbData> run_shots(
+      const Factory &factory,
+      size_t num_shots,
+      size_t num_threads,
+      uint64_t seed,
+      const ArbData &data,
+      Simulation *outcomes = nullptr
+    ) {
+      return Simulation::shots_from_handles(num_shots, [&](raw::dqcs_handle_t *results) {
+        return raw::dqcs_sim_run_shots_parallel(
+          raw_factory, nullptr, const_cast<Factory*>(&factory),
+          seed, data.get_handle(), num_shots, num_threads, results,
+          outcomes ? outcomes->get_handle() : 0);
+      });
+    }
+
+    /**
+     * Runs a program the given number of times on a number of simulations in
+     * parallel without an argument.
+     *
+     * This is the same as the other overload of `run_shots()`, but passes an
+     * empty `ArbData` to every run.
+     *
+     * \param factory Constructs the configuration for each worker. It is
+     * called from within the worker threads, so it must be thread-safe.
+     * \param num_shots The number of times to run the program.
+     * \param num_threads The number of simulations to run in parallel.
+     * \param seed The seed from which the simulation seeds are derived.
+     * \param outcomes An optional simulation to which the outcomes recorded
+     * by the worker simulations are added.
+     * \returns The `ArbData` objects returned by the frontend plugin's
+     * implementation of the `run` callback, in order.
+     * \throws std::runtime_error When constructing one of the simulations or
+     * one of the runs fails.
+     */
+    static std::vector<ArbData> run_shots(
+      const Factory &factory,
+      size_t num_shots,
+      size_t num_threads,
+      uint64_t seed,
+      Simulation *outcomes = nullptr
+    ) {
+      return Simulation::shots_from_handles(num_shots, [&](raw::dqcs_handle_t *results) {
+        return raw::dqcs_sim_run_shots_parallel(
+          raw_factory, nullptr, const_cast<Factory*>(&factory),
+          seed, 0, num_shots, num_threads, results,
+          outcomes ? outcomes->get_handle() : 0);
+      });
+    }
+
+  private:
+
+    /**
+     * C callback entry point for the `run_shots()` factory.
+     */
+    static raw::dqcs_handle_t raw_factory(const void *user_data, size_t worker) noexcept {
+      try {
+        auto factory = reinterpret_cast<const Factory*>(user_data);
+        return (*factory)(worker).take_handle();
+      } catch (const std::exception &e) {
+        raw::dqcs_error_set(e.what());
+      }
+      return 0;
+    }
+
+  };
+
+  /**
+   * Runs many independent simulations concurrently on a pool of worker
+   * threads, for instance for a parameter sweep.
+   *
+   * Whenever a worker thread is idle, it takes the next job, constructs its
+   * simulation using the factory function, runs the program once, and
+   * destroys the simulation again. The results are passed to a callback in
+   * the calling thread as they complete, so not necessarily in order.
+   */
+  class SimulationPool {
+  public:
+
+    /**
+     * Function type used to construct the simulation configuration for a
+     * job. It is passed the index of the job, and is called from within the
+     * worker threads, so it must be thread-safe. Note that handles cannot be
+     * shared between threads, so the configuration must be constructed from
+     * scratch.
+     */
+    using Factory = std::function<SimulationConfiguration(size_t)>;
+
+    /**
+     * Function type called with the index of a job and the `ArbData` object
+     * returned by the frontend plugin's implementation of the `run` callback
+     * when the job completes successfully.
+     */
+    using ResultCallback = std::function<void(size_t, ArbData&&)>;
+
+    /**
+     * Function type called with the index of a job and the error message
+     * when the job fails.
+     */
+    using ErrorCallback = std::function<void(size_t, const std::string&)>;
+
+  private:
+
+    /**
+     * Constructs the simulation configuration for each job.
+     */
+    Factory factory;
+
+    /**
+     * The number of worker threads, or 0 for one for each logical CPU.
+     */
+    size_t num_threads = 0;
+
+    /**
+     * The maximum number of plugin processes that may be running at the same
+     * time, or 0 for no limit.
+     */
+    size_t max_processes = 0;
+
+    /**
+     * The callbacks passed to `dqcs_sim_run_pool()` through its user data.
+     */
+    struct Context {
+      const Factory *factory;
+      const ResultCallback *on_result;
+      const ErrorCallback *on_error;
+    };
+
+  public:
+
+    /**
+     * Constructs a simulation pool.
+     *
+     * \param factory Constructs the simulation configuration for each job.
+     */
+    SimulationPool(const Factory &factory) : factory(factory) {
+    }
+
+    /**
+     * Sets the number of worker threads.
+     *
+     * \param num_threads The number of worker threads, or 0 to use one for
+     * each logical CPU. This is the default.
+     * \returns `&self`, to continue building.
+     */
+    SimulationPool &&with_threads(size_t num_threads) noexcept {
+      this->num_threads = num_threads;
+      return std::move(*this);
+    }
+
+    /**
+     * Limits the number of plugin processes that may be running at the same
+     * time. A worker waits before constructing a simulation until a slot is
+     * available for each plugin process in it.
+     *
+     * \param max_processes The maximum number of plugin processes, or 0 for
+     * no limit. This is the default.
+     * \returns `&self`, to continue building.
+     */
+    SimulationPool &&with_max_processes(size_t max_processes) noexcept {
+      this->max_processes = max_processes;
+      return std::move(*this);
+    }
+
+    /**
+     * Runs the given number of jobs, passing the same argument to the `run`
+     * callback of every simulation.
+     *
+     * \param num_jobs The number of jobs to run.
+     * \param data An `ArbData` object to pass to the plugin's `run` callback.
+     * \param on_result Called from the calling thread for every job that
+     * completes successfully.
+     * \param on_error Called from the calling thread for every job that
+     * fails. If this is empty, the first failing job stops the pool instead,
+     * and its error is thrown.
+     * \throws std::runtime_error When one of the callbacks throws, or a job
+     * fails while `on_error` is empty. No further jobs are started in that
+     * case.
+     */
+    void run(
+      size_t num_jobs,
+      const ArbData &data,
+      const ResultCallback &on_result,
+      const ErrorCallback &on_error = ErrorCallback()
+    ) const {
+      Context context = {&factory, &on_result, &on_error};
+      check(raw::dqcs_sim_run_pool(
+        raw_factory, raw_result, nullptr, &context,
+        data.get_handle(), num_jobs, num_threads, max_processes));
+    }
+
+    /**
+     * Runs the given number of jobs without an argument.
+     *
+     * This is the same as the other overload of `run()`, but passes an empty
+     * `ArbData` to every simulation.
+     *
+     * \param num_jobs The number of jobs to run.
+     * \param on_result Called from the calling thread for every job that
+     * completes successfully.
+     * \param on_error Called from the calling thread for every job that
+     * fails. If this is empty, the first failing job stops the pool instead,
+     * and its error is thrown.
+     * \throws std::runtime_error When one of the callbacks throws, or a job
+     * fails while `on_error` is empty.
+     */
+    void run(
+      size_t num_jobs,
+      const ResultCallback &on_result,
+      const ErrorCallback &on_error = ErrorCallback()
+    ) const {
+      Context context = {&factory, &on_result, &on_error};
+      check(raw::dqcs_sim_run_pool(
+        raw_factory, raw_result, nullptr, &context,
+        0, num_jobs, num_threads, max_processes));
+    }
+
+  private:
+
+    /**
+     * C callback entry point for the job factory.
+     */
+    static raw::dqcs_handle_t raw_factory(const void *user_data, size_t job) noexcept {
+      try {
+        auto context = reinterpret_cast<const Context*>(user_data);
+        return (*context->factory)(job).take_handle();
+      } catch (const std::exception &e) {
+        raw::dqcs_error_set(e.what());
+      }
+      return 0;
+    }
+
+    /**
+     * C callback entry point for the job results.
+     */
+    static raw::dqcs_return_t raw_result(
+      const void *user_data,
+      size_t job,
+      raw::dqcs_handle_t result
+    ) noexcept {
+      try {
+        auto context = reinterpret_cast<const Context*>(user_data);
+        if (result) {
+          (*context->on_result)(job, ArbData(result));
+        } else if (*context->on_error) {
+          (*context->on_error)(job, raw::dqcs_error_get());
+        } else {
+          return raw::dqcs_return_t::DQCS_FAILURE;
+        }
+        return raw::dqcs_return_t::DQCS_SUCCESS;
+      } catch (const std::exception &e) {
+        raw::dqcs_error_set(e.what());
+      }
+      return raw::dqcs_return_t::DQCS_FAILURE;
+    }
+
   };
 
 } // namespace wrap
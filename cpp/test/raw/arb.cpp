@@ -1,5 +1,7 @@
 #include <dqcsim.h>
 #include "gtest/gtest.h"
+#include <cstring>
+#include <vector>
 
 // Sanity check the handle API.
 TEST(arb, sanity) {
@@ -58,6 +60,44 @@ TEST(arb, json) {
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
 }
 
+// Test reading individual values by means of JSON pointers.
+TEST(arb, query) {
+  unsigned char cbor_buffer[256];
+  double f64;
+  int64_t i64;
+
+  // Create handle.
+  dqcs_handle_t a = dqcs_arb_new();
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(dqcs_arb_json_set(a, "{\"noise\": {\"t1\": 0.5, \"qubits\": [3, 4]}, \"name\": \"x\", \"on\": true}"), dqcs_return_t::DQCS_SUCCESS);
+
+  // Check typed access.
+  EXPECT_EQ(dqcs_arb_query_f64(a, "/noise/t1", &f64), dqcs_return_t::DQCS_SUCCESS) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(f64, 0.5);
+  EXPECT_EQ(dqcs_arb_query_f64(a, "/noise/qubits/1", &f64), dqcs_return_t::DQCS_SUCCESS) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(f64, 4.0);
+  EXPECT_EQ(dqcs_arb_query_i64(a, "/noise/qubits/0", &i64), dqcs_return_t::DQCS_SUCCESS) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(i64, 3);
+  EXPECT_EQ(dqcs_arb_query_bool(a, "/on"), dqcs_bool_return_t::DQCS_TRUE);
+  EXPECT_STREQ(dqcs_arb_query_text(a, "/name"), "x");
+
+  // Check CBOR access.
+  EXPECT_EQ(dqcs_arb_query_cbor(a, "/noise/qubits", cbor_buffer, 256), 3);
+  EXPECT_EQ(memcmp(cbor_buffer, "\x82\x03\x04", 3), 0);
+
+  // Check errors.
+  EXPECT_EQ(dqcs_arb_query_f64(a, "/noise/t2", &f64), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: no value at JSON pointer /noise/t2");
+  EXPECT_EQ(dqcs_arb_query_i64(a, "/noise/t1", &i64), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_EQ(dqcs_arb_query_bool(a, "/name"), dqcs_bool_return_t::DQCS_BOOL_FAILURE);
+
+  // Delete handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
 // Test JSON access by means of CBOR objects.
 TEST(arb, cbor) {
   unsigned char cbor_buffer[256];
@@ -357,3 +397,40 @@ TEST(arb, test3) {
   // Leak check.
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
 }
+
+// Test the shared-memory binary string list.
+TEST(arb, shared) {
+  // Create handle.
+  dqcs_handle_t a = dqcs_arb_new();
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Push a shared argument; it should not end up in the regular list.
+  std::vector<unsigned char> data(1 << 20);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = (unsigned char)i;
+  }
+  EXPECT_EQ(dqcs_arb_shared_push(a, data.data(), data.size()), dqcs_return_t::DQCS_SUCCESS) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(dqcs_arb_shared_len(a), 1);
+  EXPECT_EQ(dqcs_arb_len(a), 0);
+
+  // Access it in place.
+  size_t size = 0;
+  const void *ptr = dqcs_arb_shared_get(a, -1, &size);
+  ASSERT_NE(ptr, nullptr) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(size, data.size());
+  EXPECT_EQ(memcmp(ptr, data.data(), size), 0);
+
+  // Out-of-range indices fail.
+  EXPECT_EQ(dqcs_arb_shared_get(a, 1, &size), nullptr);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: index out of range: 1");
+
+  // Clear the list.
+  EXPECT_EQ(dqcs_arb_shared_clear(a), dqcs_return_t::DQCS_SUCCESS) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(dqcs_arb_shared_len(a), 0);
+
+  // Delete handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
@@ -101,3 +101,34 @@ TEST(cq, test) {
   // Leak check.
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
 }
+
+// Test bulk copying and draining of command queues.
+TEST(cq, get_take_all) {
+  char *s;
+  dqcs_handle_t a = dqcs_cq_new();
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(dqcs_cq_push(a, dqcs_cmd_new("a", "b")), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_cq_push(a, dqcs_cmd_new("c", "d")), dqcs_return_t::DQCS_SUCCESS);
+
+  dqcs_handle_t cmds[2] = {0, 0};
+  EXPECT_EQ(dqcs_cq_get_all(a, cmds, 2), 2);
+  EXPECT_EQ(dqcs_cq_len(a), 2);
+  EXPECT_STREQ(s = dqcs_cmd_iface_get(cmds[1]), "c");
+  if (s) free(s);
+  EXPECT_EQ(dqcs_handle_delete(cmds[0]), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_handle_delete(cmds[1]), dqcs_return_t::DQCS_SUCCESS);
+
+  EXPECT_EQ(dqcs_cq_take_all(a, cmds, 1), 1);
+  EXPECT_EQ(dqcs_cq_len(a), 1);
+  EXPECT_STREQ(s = dqcs_cmd_iface_get(cmds[0]), "a");
+  if (s) free(s);
+  EXPECT_EQ(dqcs_handle_delete(cmds[0]), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_STREQ(s = dqcs_cmd_iface_get(a), "c");
+  if (s) free(s);
+
+  EXPECT_EQ(dqcs_cq_take_all(a, NULL, 1), -1);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: unexpected NULL buffer");
+
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
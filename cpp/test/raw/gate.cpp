@@ -167,6 +167,30 @@ TEST(gate, cnot) {
 
   EXPECT_MATRIX(a, X_MATRIX);
 
+  // The qubit lists can also be copied into arrays directly.
+  dqcs_qubit_t qubits[2] = {0, 0};
+  EXPECT_EQ(dqcs_gate_targets_array(a, qubits, 2), 1);
+  EXPECT_EQ(qubits[0], 1u);
+  EXPECT_EQ(dqcs_gate_controls_array(a, qubits, 2), 1);
+  EXPECT_EQ(qubits[0], 2u);
+  EXPECT_EQ(dqcs_gate_measures_array(a, qubits, 2), 0);
+  EXPECT_EQ(dqcs_gate_targets_array(a, NULL, 0), 1);
+  EXPECT_EQ(dqcs_gate_targets_array(a, NULL, 1), -1);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: unexpected NULL buffer");
+
+  // The controlled matrix folds the control qubit into the matrix.
+  dqcs_handle_t cnot = dqcs_gate_controlled_matrix(a);
+  ASSERT_NE(cnot, 0u) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(dqcs_mat_dimension(cnot), 4);
+  dqcs_handle_t x = dqcs_mat_new(1, X_MATRIX);
+  ASSERT_NE(x, 0u) << "Unexpected error: " << dqcs_error_get();
+  dqcs_handle_t expected = dqcs_mat_add_controls(x, 1);
+  ASSERT_NE(expected, 0u) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(dqcs_mat_approx_eq(cnot, expected, 0.0, false), dqcs_bool_return_t::DQCS_TRUE);
+  EXPECT_EQ(dqcs_handle_delete(expected), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_handle_delete(x), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_handle_delete(cnot), dqcs_return_t::DQCS_SUCCESS);
+
   EXPECT_STREQ(s = dqcs_arb_json_get(a), "{}");
   if (s) free(s);
   EXPECT_EQ(dqcs_arb_len(a), 0);
@@ -94,3 +94,43 @@ TEST(mset, test) {
   // Leak check.
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
 }
+
+// Test bulk copying and draining of measurement sets.
+TEST(mset, get_take_all) {
+  dqcs_handle_t a = dqcs_mset_new();
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+  for (dqcs_qubit_t q = 1; q <= 3; q++) {
+    dqcs_handle_t m = dqcs_meas_new(q, (q == 2) ? dqcs_measurement_t::DQCS_MEAS_ONE : dqcs_measurement_t::DQCS_MEAS_ZERO);
+    ASSERT_NE(m, 0u) << "Unexpected error: " << dqcs_error_get();
+    EXPECT_EQ(dqcs_mset_set(a, m), dqcs_return_t::DQCS_SUCCESS);
+    EXPECT_EQ(dqcs_handle_delete(m), dqcs_return_t::DQCS_SUCCESS);
+  }
+
+  dqcs_handle_t meas[4] = {0, 0, 0, 0};
+
+  // Copying leaves the set intact.
+  EXPECT_EQ(dqcs_mset_get_all(a, meas, 4), 3);
+  EXPECT_EQ(dqcs_mset_len(a), 3);
+  EXPECT_EQ(meas[3], 0u);
+  for (int i = 0; i < 3; i++) {
+    dqcs_qubit_t q = dqcs_meas_qubit_get(meas[i]);
+    EXPECT_EQ(dqcs_meas_value_get(meas[i]), (q == 2) ? dqcs_measurement_t::DQCS_MEAS_ONE : dqcs_measurement_t::DQCS_MEAS_ZERO);
+    EXPECT_EQ(dqcs_handle_delete(meas[i]), dqcs_return_t::DQCS_SUCCESS);
+  }
+
+  // Taking only part of the set leaves the rest.
+  EXPECT_EQ(dqcs_mset_take_all(a, meas, 2), 2);
+  EXPECT_EQ(dqcs_mset_len(a), 1);
+  EXPECT_EQ(dqcs_mset_contains(a, dqcs_meas_qubit_get(meas[0])), dqcs_bool_return_t::DQCS_FALSE);
+  EXPECT_EQ(dqcs_mset_contains(a, dqcs_meas_qubit_get(meas[1])), dqcs_bool_return_t::DQCS_FALSE);
+  EXPECT_EQ(dqcs_handle_delete(meas[0]), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_handle_delete(meas[1]), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_mset_take_all(a, meas, 4), 1);
+  EXPECT_EQ(dqcs_mset_len(a), 0);
+  EXPECT_EQ(dqcs_handle_delete(meas[0]), dqcs_return_t::DQCS_SUCCESS);
+
+  EXPECT_EQ(dqcs_mset_take_all(a, meas, 4), 0);
+
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
@@ -367,6 +367,231 @@ TEST(pcfg, timeout) {
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
 }
 
+// Test gatestream transport configuration.
+TEST(pcfg, downstream_shm) {
+  dqcs_handle_t a;
+
+  // Create a fresh config.
+  a = dqcs_pcfg_new_raw(dqcs_plugin_type_t::DQCS_PTYPE_FRONT, NULL, "x", NULL);
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Check the default (IPC).
+  EXPECT_EQ(dqcs_pcfg_downstream_shm_get(a), 0);
+
+  // Switch to shared memory.
+  EXPECT_EQ(dqcs_pcfg_downstream_shm_set(a, 4096), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_downstream_shm_get(a), 4096);
+
+  // Check that we can't do silly things.
+  EXPECT_EQ(dqcs_pcfg_downstream_shm_set(a, 1000), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: ring buffer capacity must be a power of two of at least 64 bytes");
+  EXPECT_EQ(dqcs_pcfg_downstream_shm_set(a, 32), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_EQ(dqcs_pcfg_downstream_shm_get(a), 4096);
+
+  // Switch back to IPC.
+  EXPECT_EQ(dqcs_pcfg_downstream_shm_set(a, 0), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_downstream_shm_get(a), 0);
+
+  // Delete the handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
+// Test downstream in-flight window configuration.
+TEST(pcfg, downstream_window) {
+  dqcs_handle_t a;
+
+  // Create a fresh config.
+  a = dqcs_pcfg_new_raw(dqcs_plugin_type_t::DQCS_PTYPE_FRONT, NULL, "x", NULL);
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Check the default (no limit).
+  EXPECT_EQ(dqcs_pcfg_downstream_window_get(a), 0);
+
+  // Set a limit.
+  EXPECT_EQ(dqcs_pcfg_downstream_window_set(a, 1024), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_downstream_window_get(a), 1024);
+
+  // Remove the limit again.
+  EXPECT_EQ(dqcs_pcfg_downstream_window_set(a, 0), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_downstream_window_get(a), 0);
+
+  // Check that invalid handles are rejected.
+  EXPECT_EQ(dqcs_pcfg_downstream_window_set(0, 1024), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: handle 0 is invalid");
+  EXPECT_EQ(dqcs_pcfg_downstream_window_get(0), -1);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: handle 0 is invalid");
+
+  // Delete the handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
+// Test receive strategy configuration.
+TEST(pcfg, receive_strategy) {
+  dqcs_handle_t a;
+
+  // Create a fresh config.
+  a = dqcs_pcfg_new_raw(dqcs_plugin_type_t::DQCS_PTYPE_BACK, NULL, "x", NULL);
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Check the default (block right away).
+  EXPECT_EQ(dqcs_pcfg_receive_strategy_get(a), dqcs_receive_strategy_t::DQCS_RECV_BLOCK);
+  EXPECT_EQ(dqcs_pcfg_receive_spin_time_get(a), 0.0);
+
+  // Poll before blocking.
+  EXPECT_EQ(dqcs_pcfg_receive_strategy_set(a, dqcs_receive_strategy_t::DQCS_RECV_SPIN, 0.5), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_receive_strategy_get(a), dqcs_receive_strategy_t::DQCS_RECV_SPIN);
+  EXPECT_EQ(dqcs_pcfg_receive_spin_time_get(a), 0.5);
+  EXPECT_EQ(dqcs_pcfg_receive_strategy_set(a, dqcs_receive_strategy_t::DQCS_RECV_YIELD, 0.25), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_receive_strategy_get(a), dqcs_receive_strategy_t::DQCS_RECV_YIELD);
+  EXPECT_EQ(dqcs_pcfg_receive_spin_time_get(a), 0.25);
+
+  // Check that we can't do silly things.
+  EXPECT_EQ(dqcs_pcfg_receive_strategy_set(a, dqcs_receive_strategy_t::DQCS_RECV_SPIN, -1.0), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: the polling time must be a nonnegative, finite number of seconds");
+  EXPECT_EQ(dqcs_pcfg_receive_strategy_set(a, dqcs_receive_strategy_t::DQCS_RECV_INVALID, 0.0), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: invalid receive strategy");
+  EXPECT_EQ(dqcs_pcfg_receive_strategy_get(a), dqcs_receive_strategy_t::DQCS_RECV_YIELD);
+
+  // Switch back to blocking.
+  EXPECT_EQ(dqcs_pcfg_receive_strategy_set(a, dqcs_receive_strategy_t::DQCS_RECV_BLOCK, 1.0), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_receive_strategy_get(a), dqcs_receive_strategy_t::DQCS_RECV_BLOCK);
+  EXPECT_EQ(dqcs_pcfg_receive_spin_time_get(a), 0.0);
+
+  // Delete the handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
+// Test gatestream capture configuration.
+TEST(pcfg, downstream_capture) {
+  dqcs_handle_t a;
+  char *s;
+
+  // Create a fresh config.
+  a = dqcs_pcfg_new_raw(dqcs_plugin_type_t::DQCS_PTYPE_FRONT, NULL, "x", NULL);
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Check the default (disabled).
+  EXPECT_EQ(dqcs_pcfg_downstream_capture_get(a), nullptr);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: gatestream capture is disabled for this plugin");
+
+  // Enable capturing.
+  EXPECT_EQ(dqcs_pcfg_downstream_capture_set(a, "front.replay"), dqcs_return_t::DQCS_SUCCESS);
+  s = dqcs_pcfg_downstream_capture_get(a);
+  ASSERT_NE(s, nullptr) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_STREQ(s, "front.replay");
+  free(s);
+
+  // Disable it again.
+  EXPECT_EQ(dqcs_pcfg_downstream_capture_set(a, NULL), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_downstream_capture_get(a), nullptr);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: gatestream capture is disabled for this plugin");
+
+  // Check that invalid handles are rejected.
+  EXPECT_EQ(dqcs_pcfg_downstream_capture_set(0, "front.replay"), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: handle 0 is invalid");
+  EXPECT_EQ(dqcs_pcfg_downstream_capture_get(0), nullptr);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: handle 0 is invalid");
+
+  // Delete the handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
+// Test process pooling configuration.
+TEST(pcfg, pooled) {
+  dqcs_handle_t a;
+
+  // Create a fresh config.
+  a = dqcs_pcfg_new_raw(dqcs_plugin_type_t::DQCS_PTYPE_FRONT, NULL, "x", NULL);
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Check the default.
+  EXPECT_EQ(dqcs_pcfg_pooled_get(a), dqcs_bool_return_t::DQCS_FALSE);
+
+  // Enable and disable pooling.
+  EXPECT_EQ(dqcs_pcfg_pooled_set(a, true), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_pooled_get(a), dqcs_bool_return_t::DQCS_TRUE);
+  EXPECT_EQ(dqcs_pcfg_pooled_set(a, false), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_pooled_get(a), dqcs_bool_return_t::DQCS_FALSE);
+
+  // Nothing has been pooled.
+  EXPECT_EQ(dqcs_sim_pool_clear(), 0);
+
+  // Delete the handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
+// Test CPU affinity and NUMA policy configuration.
+TEST(pcfg, placement) {
+  dqcs_handle_t a;
+  size_t buf[4];
+
+  // Create a fresh config.
+  a = dqcs_pcfg_new_raw(dqcs_plugin_type_t::DQCS_PTYPE_BACK, NULL, "x", NULL);
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Check the defaults.
+  EXPECT_EQ(dqcs_pcfg_cpu_affinity_get(a, NULL, 0), 0);
+  EXPECT_EQ(dqcs_pcfg_numa_policy_get(a), dqcs_numa_policy_t::DQCS_NUMA_DEFAULT);
+  EXPECT_EQ(dqcs_pcfg_numa_nodes_get(a, NULL, 0), 0);
+
+  // Set and get the CPU affinity.
+  const size_t cpus[] = {2, 3, 6};
+  EXPECT_EQ(dqcs_pcfg_cpu_affinity_set(a, cpus, 3), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_cpu_affinity_get(a, buf, 2), 3);
+  EXPECT_EQ(buf[0], 2u);
+  EXPECT_EQ(buf[1], 3u);
+  EXPECT_EQ(dqcs_pcfg_cpu_affinity_get(a, buf, 4), 3);
+  EXPECT_EQ(buf[2], 6u);
+  EXPECT_EQ(dqcs_pcfg_cpu_affinity_get(a, NULL, 4), -1);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: unexpected NULL buffer");
+  EXPECT_EQ(dqcs_pcfg_cpu_affinity_set(a, NULL, 3), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: unexpected NULL array");
+  EXPECT_EQ(dqcs_pcfg_cpu_affinity_set(a, NULL, 0), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_cpu_affinity_get(a, NULL, 0), 0);
+
+  // Set and get the NUMA policy.
+  const size_t nodes[] = {1, 0};
+  EXPECT_EQ(dqcs_pcfg_numa_policy_set(a, dqcs_numa_policy_t::DQCS_NUMA_PREFERRED, nodes, 1), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_numa_policy_get(a), dqcs_numa_policy_t::DQCS_NUMA_PREFERRED);
+  EXPECT_EQ(dqcs_pcfg_numa_nodes_get(a, buf, 4), 1);
+  EXPECT_EQ(buf[0], 1u);
+  EXPECT_EQ(dqcs_pcfg_numa_policy_set(a, dqcs_numa_policy_t::DQCS_NUMA_INTERLEAVE, nodes, 2), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_numa_policy_get(a), dqcs_numa_policy_t::DQCS_NUMA_INTERLEAVE);
+  EXPECT_EQ(dqcs_pcfg_numa_nodes_get(a, buf, 4), 2);
+  EXPECT_EQ(buf[0], 1u);
+  EXPECT_EQ(buf[1], 0u);
+  EXPECT_EQ(dqcs_pcfg_numa_policy_set(a, dqcs_numa_policy_t::DQCS_NUMA_PREFERRED, nodes, 2), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: invalid number of NUMA nodes for this policy");
+  EXPECT_EQ(dqcs_pcfg_numa_policy_set(a, dqcs_numa_policy_t::DQCS_NUMA_BIND, NULL, 0), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: invalid number of NUMA nodes for this policy");
+  EXPECT_EQ(dqcs_pcfg_numa_policy_set(a, dqcs_numa_policy_t::DQCS_NUMA_INVALID, NULL, 0), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: invalid NUMA policy");
+  EXPECT_EQ(dqcs_pcfg_numa_policy_get(a), dqcs_numa_policy_t::DQCS_NUMA_INTERLEAVE);
+  EXPECT_EQ(dqcs_pcfg_numa_policy_set(a, dqcs_numa_policy_t::DQCS_NUMA_DEFAULT, NULL, 0), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pcfg_numa_policy_get(a), dqcs_numa_policy_t::DQCS_NUMA_DEFAULT);
+
+  // Delete the handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
 // Test stderr/stdout modes.
 TEST(pcfg, stream_capture_mode) {
   dqcs_handle_t a;
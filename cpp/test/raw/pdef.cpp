@@ -93,6 +93,42 @@ TEST(pdef, metadata) {
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
 }
 
+// Test fusing a backend into a frontend.
+TEST(pdef, fuse) {
+  dqcs_handle_t front = dqcs_pdef_new(dqcs_plugin_type_t::DQCS_PTYPE_FRONT, "a", "b", "c");
+  ASSERT_NE(front, 0u) << "Unexpected error: " << dqcs_error_get();
+  dqcs_handle_t back = dqcs_pdef_new(dqcs_plugin_type_t::DQCS_PTYPE_BACK, "d", "e", "f");
+  ASSERT_NE(back, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Only backends can be fused into frontends.
+  EXPECT_EQ(dqcs_pdef_fuse(back, front), 0u);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: only frontends can have a backend fused into them");
+  EXPECT_EQ(dqcs_pdef_fuse(front, front), 0u);
+  EXPECT_EQ(dqcs_error_get(), "Invalid argument: handle " + std::to_string(front) + " is invalid");
+
+  // Fusing consumes the backend and returns a stand-in with its metadata.
+  dqcs_handle_t stand_in = dqcs_pdef_fuse(front, back);
+  ASSERT_NE(stand_in, 0u) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(dqcs_handle_type(back), dqcs_handle_type_t::DQCS_HTYPE_INVALID);
+  EXPECT_EQ(dqcs_handle_type(stand_in), dqcs_handle_type_t::DQCS_HTYPE_BACK_DEF);
+  char *s;
+  EXPECT_STREQ(s = dqcs_pdef_name(stand_in), "d");
+  if (s) free(s);
+
+  // A frontend can only have one backend fused into it.
+  back = dqcs_pdef_new(dqcs_plugin_type_t::DQCS_PTYPE_BACK, "d", "e", "f");
+  ASSERT_NE(back, 0u) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(dqcs_pdef_fuse(front, back), 0u);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: this frontend already has a backend fused into it");
+
+  EXPECT_EQ(dqcs_handle_delete(front), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_handle_delete(back), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_handle_delete(stand_in), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
 void free_cb(void *user_data) {
   (*((int*)user_data))++;
 }
@@ -150,6 +186,13 @@ dqcs_handle_t modify_measurement_cb(void *user_data, dqcs_plugin_state_t state,
   return 0u;
 }
 
+dqcs_handle_t modify_measurements_cb(void *user_data, dqcs_plugin_state_t state, dqcs_handle_t mset) {
+  (void)user_data;
+  (void)state;
+  (void)mset;
+  return 0u;
+}
+
 dqcs_return_t advance_cb(void *user_data, dqcs_plugin_state_t state,  dqcs_cycle_t cycles) {
   (void)user_data;
   (void)state;
@@ -195,15 +238,17 @@ TEST(pdef, frontend_cb) {
   EXPECT_STREQ(dqcs_error_get(), "Invalid operation: the gate() callback is not supported for frontends");
   EXPECT_EQ(dqcs_pdef_set_modify_measurement_cb(a, modify_measurement_cb, free_cb, &user), dqcs_return_t::DQCS_FAILURE);
   EXPECT_STREQ(dqcs_error_get(), "Invalid operation: the modify_measurement() callback is only supported for operators");
+  EXPECT_EQ(dqcs_pdef_set_modify_measurements_cb(a, modify_measurements_cb, free_cb, &user), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid operation: the modify_measurements() callback is only supported for operators");
   EXPECT_EQ(dqcs_pdef_set_advance_cb(a, advance_cb, free_cb, &user), dqcs_return_t::DQCS_FAILURE);
   EXPECT_STREQ(dqcs_error_get(), "Invalid operation: the advance() callback is not supported for frontends");
   EXPECT_EQ(dqcs_pdef_set_upstream_arb_cb(a, upstream_arb_cb, free_cb, &user), dqcs_return_t::DQCS_FAILURE);
   EXPECT_STREQ(dqcs_error_get(), "Invalid operation: the upstream_arb() callback is not supported for frontends");
-  EXPECT_EQ(user, 6);
+  EXPECT_EQ(user, 7);
 
   // Delete handle.
   EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
-  EXPECT_EQ(user, 10);
+  EXPECT_EQ(user, 11);
 
   // Leak check.
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
@@ -224,6 +269,7 @@ TEST(pdef, operator_cb) {
   EXPECT_EQ(dqcs_pdef_set_free_cb(a, free_cb, free_cb, &user), dqcs_return_t::DQCS_SUCCESS);
   EXPECT_EQ(dqcs_pdef_set_gate_cb(a, gate_cb, free_cb, &user), dqcs_return_t::DQCS_SUCCESS);
   EXPECT_EQ(dqcs_pdef_set_modify_measurement_cb(a, modify_measurement_cb, free_cb, &user), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_pdef_set_modify_measurements_cb(a, modify_measurements_cb, free_cb, &user), dqcs_return_t::DQCS_SUCCESS);
   EXPECT_EQ(dqcs_pdef_set_advance_cb(a, advance_cb, free_cb, &user), dqcs_return_t::DQCS_SUCCESS);
   EXPECT_EQ(dqcs_pdef_set_upstream_arb_cb(a, upstream_arb_cb, free_cb, &user), dqcs_return_t::DQCS_SUCCESS);
   EXPECT_EQ(dqcs_pdef_set_host_arb_cb(a, host_arb_cb, free_cb, &user), dqcs_return_t::DQCS_SUCCESS);
@@ -236,7 +282,7 @@ TEST(pdef, operator_cb) {
 
   // Delete handle.
   EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
-  EXPECT_EQ(user, 10);
+  EXPECT_EQ(user, 11);
 
   // Leak check.
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
@@ -264,13 +310,15 @@ TEST(pdef, backend_cb) {
   // Try setting nonsensical callbacks.
   EXPECT_EQ(dqcs_pdef_set_modify_measurement_cb(a, modify_measurement_cb, free_cb, &user), dqcs_return_t::DQCS_FAILURE);
   EXPECT_STREQ(dqcs_error_get(), "Invalid operation: the modify_measurement() callback is only supported for operators");
+  EXPECT_EQ(dqcs_pdef_set_modify_measurements_cb(a, modify_measurements_cb, free_cb, &user), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid operation: the modify_measurements() callback is only supported for operators");
   EXPECT_EQ(dqcs_pdef_set_run_cb(a, run_cb, free_cb, &user), dqcs_return_t::DQCS_FAILURE);
   EXPECT_STREQ(dqcs_error_get(), "Invalid operation: the run() callback is only supported for frontends");
-  EXPECT_EQ(user, 2);
+  EXPECT_EQ(user, 3);
 
   // Delete handle.
   EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
-  EXPECT_EQ(user, 10);
+  EXPECT_EQ(user, 11);
 
   // Leak check.
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
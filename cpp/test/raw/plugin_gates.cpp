@@ -43,6 +43,21 @@
   if (dqcs_plugin_gate(state, gate) != dqcs_return_t::DQCS_SUCCESS) return dqcs_return_t::DQCS_FAILURE; \
   } while (0)
 
+#define BATCH_GATE(batch, name, targets, controls, measures) do { \
+  dqcs_handle_t targets_handle, controls_handle, measures_handle; \
+  QBSET(targets_handle, targets); \
+  QBSET(controls_handle, controls); \
+  QBSET(measures_handle, measures); \
+  dqcs_handle_t gate = dqcs_gate_new_custom(name, targets_handle, controls_handle, measures_handle, 0); \
+  if (!gate) return dqcs_return_t::DQCS_FAILURE; \
+  batch.push_back(gate); \
+  } while (0)
+
+#define SEND_BATCH(batch) do { \
+  if (dqcs_plugin_gate_batch(state, batch.data(), batch.size()) != dqcs_return_t::DQCS_SUCCESS) return dqcs_return_t::DQCS_FAILURE; \
+  batch.clear(); \
+  } while (0)
+
 #define ADVANCE(cycles) do { \
   if (!dqcs_plugin_advance(state, cycles)) return dqcs_return_t::DQCS_FAILURE; \
   } while (0)
@@ -600,3 +615,306 @@ TEST(plugin_gates, with_feedback_with_broken_operator) {
   EXPECT_ADVANCE(back_data.ops, 5);
   EXPECT_DONE(back_data.ops);
 }
+
+// Test sending gates in batches.
+dqcs_return_t initialize_cb_batch(void *user_data, dqcs_plugin_state_t state, dqcs_handle_t init_cmds) {
+  (void)user_data;
+  (void)init_cmds;
+  std::vector<dqcs_handle_t> batch;
+  ALLOC(10);
+
+  // Empty batches are no-ops.
+  SEND_BATCH(batch);
+
+  // Batches containing an invalid gate are rejected as a whole, and the
+  // handles are not consumed.
+  BATCH_GATE(batch, "X", QUBITS(1), QUBITS(), QUBITS());
+  BATCH_GATE(batch, "X", QUBITS(11), QUBITS(), QUBITS());
+  if (dqcs_plugin_gate_batch(state, batch.data(), batch.size()) != dqcs_return_t::DQCS_FAILURE) {
+    dqcs_error_set("Batch with invalid gate was not rejected");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+  for (dqcs_handle_t gate : batch) {
+    if (dqcs_handle_delete(gate) != dqcs_return_t::DQCS_SUCCESS) return dqcs_return_t::DQCS_FAILURE;
+  }
+  batch.clear();
+
+  BATCH_GATE(batch, "MEAS", QUBITS(), QUBITS(), QUBITS(1, 2, 3));
+  BATCH_GATE(batch, "X", QUBITS(1), QUBITS(), QUBITS());
+  BATCH_GATE(batch, "Y", QUBITS(2), QUBITS(), QUBITS());
+  BATCH_GATE(batch, "CNOT", QUBITS(4), QUBITS(5), QUBITS());
+  SEND_BATCH(batch);
+  ADVANCE(3);
+  BATCH_GATE(batch, "MEAS", QUBITS(), QUBITS(), QUBITS(2));
+  SEND_BATCH(batch);
+  FREE(1, 2, 3, 4, 5, 6, 7, 8, 9, 10);
+  return dqcs_return_t::DQCS_SUCCESS;
+}
+
+TEST(plugin_gates, batch) {
+  back_data_t back_data;
+
+  SIM_HEADER;
+  ASSERT_EQ(dqcs_pdef_set_initialize_cb(front, initialize_cb_batch, NULL, NULL), dqcs_return_t::DQCS_SUCCESS);
+  ASSERT_EQ(dqcs_pdef_set_gate_cb(back, back_gate_cb, NULL, &back_data), dqcs_return_t::DQCS_SUCCESS);
+  ASSERT_EQ(dqcs_pdef_set_advance_cb(back, back_advance_cb, NULL, &back_data), dqcs_return_t::DQCS_SUCCESS);
+  SIM_CONSTRUCT;
+  SIM_FOOTER;
+
+  EXPECT_GATE(back_data.ops, "MEAS", QUBITS(), QUBITS(), QUBITS(1, 2, 3));
+  EXPECT_GATE(back_data.ops, "X", QUBITS(1), QUBITS(), QUBITS());
+  EXPECT_GATE(back_data.ops, "Y", QUBITS(2), QUBITS(), QUBITS());
+  EXPECT_GATE(back_data.ops, "CNOT", QUBITS(4), QUBITS(5), QUBITS());
+  EXPECT_ADVANCE(back_data.ops, 3);
+  EXPECT_GATE(back_data.ops, "MEAS", QUBITS(), QUBITS(), QUBITS(2));
+  EXPECT_DONE(back_data.ops);
+}
+
+TEST(plugin_gates, batch_with_operator) {
+  back_data_t back_data, oper_data;
+
+  SIM_HEADER;
+  ASSERT_EQ(dqcs_pdef_set_initialize_cb(front, initialize_cb_batch, NULL, NULL), dqcs_return_t::DQCS_SUCCESS);
+
+  ASSERT_EQ(dqcs_pdef_set_allocate_cb(oper, op_allocate_cb, NULL, &oper_data), dqcs_return_t::DQCS_SUCCESS);
+  ASSERT_EQ(dqcs_pdef_set_free_cb(oper, op_free_cb, NULL, &back_data), dqcs_return_t::DQCS_SUCCESS);
+  ASSERT_EQ(dqcs_pdef_set_gate_cb(oper, op_gate_cb, NULL, &oper_data), dqcs_return_t::DQCS_SUCCESS);
+  ASSERT_EQ(dqcs_pdef_set_advance_cb(oper, op_advance_cb, NULL, &oper_data), dqcs_return_t::DQCS_SUCCESS);
+  ASSERT_EQ(dqcs_pdef_set_modify_measurement_cb(oper, op_modify_measurement_cb, NULL, &oper_data), dqcs_return_t::DQCS_SUCCESS);
+
+  ASSERT_EQ(dqcs_pdef_set_gate_cb(back, back_gate_cb, NULL, &back_data), dqcs_return_t::DQCS_SUCCESS);
+  ASSERT_EQ(dqcs_pdef_set_advance_cb(back, back_advance_cb, NULL, &back_data), dqcs_return_t::DQCS_SUCCESS);
+  SIM_CONSTRUCT;
+  SIM_FOOTER;
+
+  EXPECT_GATE(oper_data.ops, "MEAS", QUBITS(), QUBITS(), QUBITS(1, 2, 3));
+  EXPECT_GATE(oper_data.ops, "X", QUBITS(1), QUBITS(), QUBITS());
+  EXPECT_GATE(oper_data.ops, "Y", QUBITS(2), QUBITS(), QUBITS());
+  EXPECT_GATE(oper_data.ops, "CNOT", QUBITS(4), QUBITS(5), QUBITS());
+  EXPECT_ADVANCE(oper_data.ops, 3);
+  EXPECT_GATE(oper_data.ops, "MEAS", QUBITS(), QUBITS(), QUBITS(2));
+  EXPECT_DONE(oper_data.ops);
+
+  EXPECT_GATE(back_data.ops, "MEAS", QUBITS(), QUBITS(), QUBITS(3, 4));
+  EXPECT_ADVANCE(back_data.ops, 1);
+  EXPECT_GATE(back_data.ops, "X", QUBITS(1, 2), QUBITS(), QUBITS());
+  EXPECT_ADVANCE(back_data.ops, 1);
+  EXPECT_GATE(back_data.ops, "Y", QUBITS(3, 4), QUBITS(), QUBITS());
+  EXPECT_ADVANCE(back_data.ops, 1);
+  EXPECT_GATE(back_data.ops, "CNOT", QUBITS(7, 8), QUBITS(9, 10), QUBITS());
+  EXPECT_ADVANCE(back_data.ops, 1);
+  EXPECT_ADVANCE(back_data.ops, 6);
+  EXPECT_GATE(back_data.ops, "MEAS", QUBITS(), QUBITS(), QUBITS(3, 4));
+  EXPECT_ADVANCE(back_data.ops, 1);
+  EXPECT_DONE(back_data.ops);
+}
+
+// Test measurement futures.
+dqcs_return_t future_cb(void *user_data, dqcs_plugin_state_t state, dqcs_handle_t meas) {
+  (void)state;
+  if (dqcs_meas_qubit_get(meas) != 2) {
+    dqcs_error_set("Received measurement data for wrong qubit");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+  (*(int*)user_data)++;
+  return dqcs_return_t::DQCS_SUCCESS;
+}
+
+dqcs_return_t initialize_cb_futures(void *user_data, dqcs_plugin_state_t state, dqcs_handle_t init_cmds) {
+  (void)user_data;
+  (void)init_cmds;
+  int called = 0;
+  ALLOC(3);
+
+  // Futures cannot be created for qubits that were never measured.
+  if (dqcs_plugin_measurement_future(state, 1) != 0) {
+    dqcs_error_set("Future for unmeasured qubit was not rejected");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+
+  GATE("MEAS", QUBITS(), QUBITS(), QUBITS(1, 2));
+  dqcs_future_t f1 = dqcs_plugin_measurement_future(state, 1);
+  dqcs_future_t f2 = dqcs_plugin_measurement_future(state, 2);
+  if (!f1 || !f2) return dqcs_return_t::DQCS_FAILURE;
+  if (dqcs_plugin_measurement_when_ready(state, f2, future_cb, NULL, &called) != dqcs_return_t::DQCS_SUCCESS) {
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+
+  // Independent gates can be sent while the measurement is in flight.
+  GATE("X", QUBITS(3), QUBITS(), QUBITS());
+
+  // Waiting for the first future also resolves the second, since they belong
+  // to the same gate, so its continuation must have been called.
+  dqcs_handle_t meas = dqcs_plugin_measurement_wait(state, f1);
+  if (!meas) return dqcs_return_t::DQCS_FAILURE;
+  if (dqcs_meas_qubit_get(meas) != 1 || dqcs_meas_value_get(meas) != dqcs_measurement_t::DQCS_MEAS_ZERO) {
+    dqcs_error_set("Received unexpected measurement");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+  dqcs_handle_delete(meas);
+  if (called != 1) {
+    dqcs_error_set("Continuation was not called exactly once");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+
+  // Futures are consumed by waiting for them and by attaching continuations.
+  if (dqcs_plugin_measurement_wait(state, f1) != 0) {
+    dqcs_error_set("Consumed future was not rejected");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+  if (dqcs_plugin_measurement_ready(state, f2) != dqcs_bool_return_t::DQCS_BOOL_FAILURE) {
+    dqcs_error_set("Consumed future was not rejected");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+
+  // A future for a received measurement is ready immediately, so its
+  // continuation is called right away.
+  dqcs_future_t f3 = dqcs_plugin_measurement_future(state, 2);
+  if (dqcs_plugin_measurement_ready(state, f3) != dqcs_bool_return_t::DQCS_TRUE) {
+    dqcs_error_set("Future for received measurement is not ready");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+  if (dqcs_plugin_measurement_when_ready(state, f3, future_cb, NULL, &called) != dqcs_return_t::DQCS_SUCCESS) {
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+  if (called != 2) {
+    dqcs_error_set("Continuation was not called immediately");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+
+  // Futures that are not needed can be discarded, both while pending and
+  // when ready. This consumes them as well.
+  GATE("MEAS", QUBITS(), QUBITS(), QUBITS(1));
+  dqcs_future_t f4 = dqcs_plugin_measurement_future(state, 1);
+  dqcs_future_t f5 = dqcs_plugin_measurement_future(state, 2);
+  if (dqcs_plugin_measurement_discard(state, f4) != dqcs_return_t::DQCS_SUCCESS) {
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+  if (dqcs_plugin_measurement_discard(state, f5) != dqcs_return_t::DQCS_SUCCESS) {
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+  if (dqcs_plugin_measurement_discard(state, f4) != dqcs_return_t::DQCS_FAILURE) {
+    dqcs_error_set("Discarded future was not rejected");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+  if (dqcs_plugin_measurement_wait(state, f5) != 0) {
+    dqcs_error_set("Discarded future was not rejected");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+  meas = dqcs_plugin_get_measurement(state, 1);
+  if (!meas) return dqcs_return_t::DQCS_FAILURE;
+  dqcs_handle_delete(meas);
+
+  FREE(1, 2, 3);
+  return dqcs_return_t::DQCS_SUCCESS;
+}
+
+TEST(plugin_gates, futures) {
+  back_data_t back_data;
+
+  SIM_HEADER;
+  ASSERT_EQ(dqcs_pdef_set_initialize_cb(front, initialize_cb_futures, NULL, NULL), dqcs_return_t::DQCS_SUCCESS);
+  ASSERT_EQ(dqcs_pdef_set_gate_cb(back, back_gate_cb, NULL, &back_data), dqcs_return_t::DQCS_SUCCESS);
+  ASSERT_EQ(dqcs_pdef_set_advance_cb(back, back_advance_cb, NULL, &back_data), dqcs_return_t::DQCS_SUCCESS);
+  SIM_CONSTRUCT;
+  SIM_FOOTER;
+
+  EXPECT_GATE(back_data.ops, "MEAS", QUBITS(), QUBITS(), QUBITS(1, 2));
+  EXPECT_GATE(back_data.ops, "X", QUBITS(3), QUBITS(), QUBITS());
+  EXPECT_GATE(back_data.ops, "MEAS", QUBITS(), QUBITS(), QUBITS(1));
+  EXPECT_DONE(back_data.ops);
+}
+
+// Test sending predefined gates in bulk from flat arrays.
+dqcs_return_t initialize_cb_predef_batch(void *user_data, dqcs_plugin_state_t state, dqcs_handle_t init_cmds) {
+  (void)user_data;
+  (void)init_cmds;
+  ALLOC(3);
+
+  const dqcs_predefined_gate_t types[] = {
+    dqcs_predefined_gate_t::DQCS_GATE_H,
+    dqcs_predefined_gate_t::DQCS_GATE_PAULI_X,
+    dqcs_predefined_gate_t::DQCS_GATE_RZ,
+    dqcs_predefined_gate_t::DQCS_GATE_SWAP
+  };
+  const dqcs_qubit_t qubits[] = {
+    0, 0, 1,
+    0, 1, 2,
+    0, 0, 3,
+    0, 2, 3
+  };
+  const double params[] = {0.0, 0.0, 0.5, 0.0};
+
+  // The qubit table must have the same number of entries for each gate.
+  if (dqcs_plugin_gate_predef_batch(state, types, 4, qubits, 11, params, 4) != dqcs_return_t::DQCS_FAILURE) {
+    dqcs_error_set("Ragged qubit table was not rejected");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+
+  // Matrix-parameterized gates are not supported.
+  const dqcs_predefined_gate_t u_type = dqcs_predefined_gate_t::DQCS_GATE_U1;
+  if (dqcs_plugin_gate_predef_batch(state, &u_type, 1, qubits + 2, 1, params, 1) != dqcs_return_t::DQCS_FAILURE) {
+    dqcs_error_set("U gate was not rejected");
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+
+  if (dqcs_plugin_gate_predef_batch(state, types, 4, qubits, 12, params, 4) != dqcs_return_t::DQCS_SUCCESS) return dqcs_return_t::DQCS_FAILURE;
+  FREE(1, 2, 3);
+  return dqcs_return_t::DQCS_SUCCESS;
+}
+
+typedef struct {
+  dqcs_predefined_gate_t type;
+  std::vector<dqcs_qubit_t> targets;
+  std::vector<dqcs_qubit_t> controls;
+} predef_op_t;
+
+dqcs_handle_t back_predef_gate_cb(void *user_data, dqcs_plugin_state_t state, dqcs_handle_t gate) {
+  (void)state;
+  std::vector<predef_op_t> *ops = (std::vector<predef_op_t>*)user_data;
+  predef_op_t op;
+  dqcs_handle_t qubits;
+
+  op.type = dqcs_gate_predef(gate);
+
+  qubits = dqcs_gate_targets(gate);
+  while (dqcs_qubit_t qubit = dqcs_qbset_pop(qubits)) {
+    op.targets.push_back(qubit);
+  }
+  dqcs_handle_delete(qubits);
+
+  qubits = dqcs_gate_controls(gate);
+  while (dqcs_qubit_t qubit = dqcs_qbset_pop(qubits)) {
+    op.controls.push_back(qubit);
+  }
+  dqcs_handle_delete(qubits);
+
+  dqcs_handle_delete(gate);
+
+  ops->push_back(op);
+  return dqcs_mset_new();
+}
+
+TEST(plugin_gates, predef_batch) {
+  std::vector<predef_op_t> ops;
+
+  SIM_HEADER;
+  ASSERT_EQ(dqcs_pdef_set_initialize_cb(front, initialize_cb_predef_batch, NULL, NULL), dqcs_return_t::DQCS_SUCCESS);
+  ASSERT_EQ(dqcs_pdef_set_gate_cb(back, back_predef_gate_cb, NULL, &ops), dqcs_return_t::DQCS_SUCCESS);
+  SIM_CONSTRUCT;
+  SIM_FOOTER;
+
+  ASSERT_EQ(ops.size(), 4u);
+  EXPECT_EQ(ops[0].type, dqcs_predefined_gate_t::DQCS_GATE_H);
+  EXPECT_QUBITS(ops[0].targets, 1);
+  EXPECT_EQ(ops[0].controls.size(), 0u);
+  EXPECT_EQ(ops[1].type, dqcs_predefined_gate_t::DQCS_GATE_PAULI_X);
+  EXPECT_QUBITS(ops[1].targets, 2);
+  EXPECT_QUBITS(ops[1].controls, 1);
+  EXPECT_EQ(ops[2].type, dqcs_predefined_gate_t::DQCS_GATE_RZ);
+  EXPECT_QUBITS(ops[2].targets, 3);
+  EXPECT_EQ(ops[2].controls.size(), 0u);
+  EXPECT_EQ(ops[3].type, dqcs_predefined_gate_t::DQCS_GATE_SWAP);
+  EXPECT_QUBITS(ops[3].targets, 2, 3);
+  EXPECT_EQ(ops[3].controls.size(), 0u);
+}
@@ -338,3 +338,10 @@ TEST(plugin_init_drop_log, drop_error_back) {
 
   EXPECT_NO_MORE_MSGS(data);
 }
+
+// Test checking whether a loglevel is enabled without a logger.
+TEST(plugin_init_drop_log, enabled_without_logger) {
+  EXPECT_EQ(dqcs_log_enabled(dqcs_loglevel_t::DQCS_LOG_FATAL), dqcs_bool_return_t::DQCS_BOOL_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid operation: no logger available");
+  EXPECT_EQ(dqcs_log_enabled(dqcs_loglevel_t::DQCS_LOG_OFF), dqcs_bool_return_t::DQCS_BOOL_FAILURE);
+}
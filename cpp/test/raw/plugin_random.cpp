@@ -212,3 +212,88 @@ TEST(plugin_random, system_consistency) {
   EXPECT_EQ(b.u64s.size(), 3u);
   EXPECT_EQ(b.u64s.front(), 16429946247105183054llu);
 }
+
+namespace random_fill {
+
+  dqcs_return_t initialize_cb_single(void *user_data, dqcs_plugin_state_t state, dqcs_handle_t init_cmds) {
+    dqcs_log_debug("initialize_cb_single");
+    dqcs_handle_delete(init_cmds);
+
+    samples_t *samples = (samples_t*)user_data;
+
+    for (int i = 0; i < 6; i++) {
+      samples->f64s.push(dqcs_plugin_random_f64(state));
+    }
+    for (int i = 0; i < 6; i++) {
+      samples->u64s.push(dqcs_plugin_random_u64(state));
+    }
+
+    return dqcs_return_t::DQCS_SUCCESS;
+  }
+
+  dqcs_return_t initialize_cb_fill(void *user_data, dqcs_plugin_state_t state, dqcs_handle_t init_cmds) {
+    dqcs_log_debug("initialize_cb_fill");
+    dqcs_handle_delete(init_cmds);
+
+    samples_t *samples = (samples_t*)user_data;
+    double f64s[6];
+    uint64_t u64s[6];
+
+    if (dqcs_plugin_random_fill_f64(state, f64s, 6) != dqcs_return_t::DQCS_SUCCESS) return dqcs_return_t::DQCS_FAILURE;
+    if (dqcs_plugin_random_fill_u64(state, u64s, 0) != dqcs_return_t::DQCS_SUCCESS) return dqcs_return_t::DQCS_FAILURE;
+    if (dqcs_plugin_random_fill_u64(state, u64s, 6) != dqcs_return_t::DQCS_SUCCESS) return dqcs_return_t::DQCS_FAILURE;
+    if (dqcs_plugin_random_fill_u64(state, NULL, 6) != dqcs_return_t::DQCS_FAILURE) return dqcs_return_t::DQCS_FAILURE;
+
+    for (int i = 0; i < 6; i++) {
+      samples->f64s.push(f64s[i]);
+      samples->u64s.push(u64s[i]);
+    }
+
+    return dqcs_return_t::DQCS_SUCCESS;
+  }
+
+}
+
+// Check that filling a buffer with random numbers produces the same stream as
+// requesting them one at a time.
+TEST(plugin_random, fill_consistency) {
+  samples_t a, b;
+
+  {
+    SIM_HEADER;
+    ASSERT_EQ(dqcs_scfg_seed_set(sim, 33), dqcs_return_t::DQCS_SUCCESS);
+    ASSERT_EQ(dqcs_pdef_set_initialize_cb(front, random_fill::initialize_cb_single, NULL, &a), dqcs_return_t::DQCS_SUCCESS);
+    ASSERT_EQ(dqcs_pdef_set_initialize_cb(oper, random_fill::initialize_cb_single, NULL, &a), dqcs_return_t::DQCS_SUCCESS);
+    ASSERT_EQ(dqcs_pdef_set_initialize_cb(back, random_fill::initialize_cb_single, NULL, &a), dqcs_return_t::DQCS_SUCCESS);
+    SIM_CONSTRUCT;
+    SIM_FOOTER;
+  }
+
+  {
+    SIM_HEADER;
+    ASSERT_EQ(dqcs_scfg_seed_set(sim, 33), dqcs_return_t::DQCS_SUCCESS);
+    ASSERT_EQ(dqcs_pdef_set_initialize_cb(front, random_fill::initialize_cb_fill, NULL, &b), dqcs_return_t::DQCS_SUCCESS);
+    ASSERT_EQ(dqcs_pdef_set_initialize_cb(oper, random_fill::initialize_cb_fill, NULL, &b), dqcs_return_t::DQCS_SUCCESS);
+    ASSERT_EQ(dqcs_pdef_set_initialize_cb(back, random_fill::initialize_cb_fill, NULL, &b), dqcs_return_t::DQCS_SUCCESS);
+    SIM_CONSTRUCT;
+    SIM_FOOTER;
+  }
+
+  EXPECT_EQ(a.f64s.size(), 18u);
+  EXPECT_EQ(b.f64s.size(), 18u);
+  EXPECT_EQ(a.u64s.size(), 18u);
+  EXPECT_EQ(b.u64s.size(), 18u);
+
+  while (!a.f64s.empty() && !b.f64s.empty()) {
+    EXPECT_UNIT_RANGE(b.f64s.front());
+    EXPECT_EQ(a.f64s.front(), b.f64s.front());
+    a.f64s.pop();
+    b.f64s.pop();
+  }
+
+  while (!a.u64s.empty() && !b.u64s.empty()) {
+    EXPECT_EQ(a.u64s.front(), b.u64s.front());
+    a.u64s.pop();
+    b.u64s.pop();
+  }
+}
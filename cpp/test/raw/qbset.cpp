@@ -76,3 +76,32 @@ TEST(qbset, test) {
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
 }
 
+
+// Test bulk copying of qubit sets into C arrays.
+TEST(qbset, get_all) {
+  dqcs_handle_t a = dqcs_qbset_new();
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_EQ(dqcs_qbset_get_all(a, NULL, 0), 0);
+  EXPECT_EQ(dqcs_qbset_push(a, 4u), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_qbset_push(a, 42u), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_qbset_push(a, 16u), dqcs_return_t::DQCS_SUCCESS);
+
+  dqcs_qubit_t qubits[4] = {0, 0, 0, 0};
+  EXPECT_EQ(dqcs_qbset_get_all(a, qubits, 4), 3);
+  EXPECT_EQ(qubits[0], 4u);
+  EXPECT_EQ(qubits[1], 42u);
+  EXPECT_EQ(qubits[2], 16u);
+  EXPECT_EQ(qubits[3], 0u);
+  EXPECT_EQ(dqcs_qbset_len(a), 3);
+
+  dqcs_qubit_t partial[2] = {0, 0};
+  EXPECT_EQ(dqcs_qbset_get_all(a, partial, 1), 1);
+  EXPECT_EQ(partial[0], 4u);
+  EXPECT_EQ(partial[1], 0u);
+
+  EXPECT_EQ(dqcs_qbset_get_all(a, NULL, 3), -1);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: unexpected NULL buffer");
+
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
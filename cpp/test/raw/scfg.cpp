@@ -46,6 +46,16 @@ TEST(scfg, repro) {
   EXPECT_STREQ(dqcs_error_get(), "Invalid argument: invalid path style");
   EXPECT_EQ(dqcs_scfg_repro_path_style_get(a), dqcs_path_style_t::DQCS_PATH_STYLE_KEEP);
 
+  // Check reproduction streaming.
+  EXPECT_EQ(dqcs_scfg_repro_stream_get(a), nullptr);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: reproduction streaming is disabled for this configuration");
+  EXPECT_EQ(dqcs_scfg_repro_stream_set(a, "test.repro"), dqcs_return_t::DQCS_SUCCESS);
+  char *s = dqcs_scfg_repro_stream_get(a);
+  EXPECT_STREQ(s, "test.repro");
+  if (s) free(s);
+  EXPECT_EQ(dqcs_scfg_repro_stream_set(a, NULL), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_scfg_repro_stream_get(a), nullptr);
+
   // Check disabling reproduction.
   EXPECT_EQ(dqcs_scfg_repro_disable(a), dqcs_return_t::DQCS_SUCCESS);
   EXPECT_EQ(dqcs_scfg_repro_path_style_get(a), dqcs_path_style_t::DQCS_PATH_STYLE_INVALID);
@@ -109,6 +119,78 @@ TEST(scfg, verbosity) {
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
 }
 
+// Test the statistics verbosity configuration API.
+TEST(scfg, stats_verbosity) {
+  // Create handle.
+  dqcs_handle_t a = dqcs_scfg_new();
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Statistics are not logged by default.
+  EXPECT_EQ(dqcs_scfg_stats_verbosity_get(a), dqcs_loglevel_t::DQCS_LOG_OFF);
+
+  EXPECT_EQ(dqcs_scfg_stats_verbosity_set(a, dqcs_loglevel_t::DQCS_LOG_INFO), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_scfg_stats_verbosity_get(a), dqcs_loglevel_t::DQCS_LOG_INFO);
+
+  EXPECT_EQ(dqcs_scfg_stats_verbosity_set(a, dqcs_loglevel_t::DQCS_LOG_PASS), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: invalid loglevel filter DQCS_LOG_PASS");
+  EXPECT_EQ(dqcs_scfg_stats_verbosity_get(a), dqcs_loglevel_t::DQCS_LOG_INFO);
+
+  // Delete handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
+// Test the log thread affinity configuration API.
+TEST(scfg, log_thread_affinity) {
+  // Create handle.
+  dqcs_handle_t a = dqcs_scfg_new();
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // The log thread is not pinned by default.
+  EXPECT_EQ(dqcs_scfg_log_thread_affinity_get(a, NULL, 0), 0);
+
+  size_t buf[2];
+  const size_t cpus[] = {5};
+  EXPECT_EQ(dqcs_scfg_log_thread_affinity_set(a, cpus, 1), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_scfg_log_thread_affinity_get(a, buf, 2), 1);
+  EXPECT_EQ(buf[0], 5u);
+  EXPECT_EQ(dqcs_scfg_log_thread_affinity_set(a, NULL, 0), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_scfg_log_thread_affinity_get(a, buf, 2), 0);
+
+  // Delete handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
+// Test the trace file configuration API.
+TEST(scfg, trace_file) {
+  // Create handle.
+  dqcs_handle_t a = dqcs_scfg_new();
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Tracing is disabled by default.
+  EXPECT_EQ(dqcs_scfg_trace_file_get(a), nullptr);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: tracing is disabled for this configuration");
+
+  EXPECT_EQ(dqcs_scfg_trace_file_set(a, "trace.json"), dqcs_return_t::DQCS_SUCCESS);
+  char *s = dqcs_scfg_trace_file_get(a);
+  EXPECT_STREQ(s, "trace.json");
+  if (s) free(s);
+
+  EXPECT_EQ(dqcs_scfg_trace_file_set(a, NULL), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_scfg_trace_file_get(a), nullptr);
+
+  // Delete handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
 // Test the stderr verbosity configuration API.
 TEST(scfg, stderr) {
   // Create handle.
@@ -401,3 +401,238 @@ TEST(sim_host, message_queues) {
 
   SIM_FOOTER;
 }
+
+// Multiple shots on the same simulation.
+TEST(sim_host, run_shots) {
+  SIM_HEADER;
+  user_data_t ud = {"run() was here", 0};
+  dqcs_pdef_set_run_cb(front, run_cb, NULL, &ud);
+  SIM_CONSTRUCT;
+
+  dqcs_handle_t a;
+  MAKE_ARB(a, "{}", "a");
+  dqcs_handle_t results[3] = {0, 0, 0};
+  EXPECT_EQ(dqcs_sim_run_shots(sim, a, 3, results), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(ud.counter, 3);
+  for (int i = 0; i < 3; i++) {
+    CHECK_ARB(results[i], "{}", "a", "run() was here");
+  }
+
+  // The argument is borrowed.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  EXPECT_EQ(dqcs_sim_run_shots(sim, 0, 1, NULL), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: unexpected NULL buffer");
+
+  SIM_FOOTER;
+}
+
+dqcs_handle_t outcome_run_cb(void *user_data, dqcs_plugin_state_t state, dqcs_handle_t args) {
+  dqcs_plugin_record_outcome(state, 3);
+  dqcs_plugin_record_outcome(state, dqcs_plugin_random_u64(state) & 1);
+  return args;
+}
+
+// Measurement outcome histograms.
+TEST(sim_host, outcomes) {
+  SIM_HEADER;
+  dqcs_pdef_set_run_cb(front, outcome_run_cb, NULL, NULL);
+  SIM_CONSTRUCT;
+
+  EXPECT_EQ(dqcs_sim_outcomes(sim, NULL, NULL, 0), 0);
+
+  dqcs_handle_t a;
+  MAKE_ARB(a, "{}");
+  dqcs_handle_t results[4] = {0, 0, 0, 0};
+  EXPECT_EQ(dqcs_sim_run_shots(sim, a, 4, results), dqcs_return_t::DQCS_SUCCESS);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(dqcs_handle_delete(results[i]), dqcs_return_t::DQCS_SUCCESS);
+  }
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  uint64_t outcomes[3] = {0, 0, 0};
+  uint64_t counts[3] = {0, 0, 0};
+  ssize_t num_entries = dqcs_sim_outcomes(sim, outcomes, counts, 3);
+  ASSERT_GE(num_entries, 2);
+  ASSERT_LE(num_entries, 3);
+  uint64_t total = 0;
+  for (ssize_t i = 0; i < num_entries; i++) {
+    total += counts[i];
+  }
+  EXPECT_EQ(total, 8u);
+  EXPECT_EQ(outcomes[num_entries - 1], 3u);
+  EXPECT_EQ(counts[num_entries - 1], 4u);
+
+  EXPECT_EQ(dqcs_sim_outcomes(sim, NULL, counts, 3), -1);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: unexpected NULL buffer");
+
+  EXPECT_EQ(dqcs_sim_outcomes_clear(sim), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_sim_outcomes(sim, NULL, NULL, 0), 0);
+
+  SIM_FOOTER;
+}
+
+dqcs_handle_t random_run_cb(void *user_data, dqcs_plugin_state_t state, dqcs_handle_t args) {
+  dqcs_arb_push_str(args, std::to_string(dqcs_plugin_random_u64(state)).c_str());
+  return args;
+}
+
+dqcs_handle_t shot_configuration(dqcs_handle_t (*run_cb)(void*, dqcs_plugin_state_t, dqcs_handle_t)) {
+  dqcs_handle_t scfg = dqcs_scfg_new();
+  dqcs_scfg_repro_disable(scfg);
+  dqcs_handle_t front = dqcs_pdef_new(dqcs_plugin_type_t::DQCS_PTYPE_FRONT, "a", "b", "c");
+  dqcs_pdef_set_run_cb(front, run_cb, NULL, NULL);
+  dqcs_scfg_push_plugin(scfg, dqcs_tcfg_new(front, NULL));
+  dqcs_handle_t back = dqcs_pdef_new(dqcs_plugin_type_t::DQCS_PTYPE_BACK, "a", "b", "c");
+  dqcs_scfg_push_plugin(scfg, dqcs_tcfg_new(back, NULL));
+  return scfg;
+}
+
+dqcs_handle_t shot_factory(const void *user_data, size_t worker) {
+  return shot_configuration(random_run_cb);
+}
+
+dqcs_handle_t outcome_shot_factory(const void *user_data, size_t worker) {
+  return shot_configuration(outcome_run_cb);
+}
+
+dqcs_handle_t failing_shot_factory(const void *user_data, size_t worker) {
+  dqcs_error_set("no simulation for you");
+  return 0;
+}
+
+// Multiple shots on parallel simulations.
+TEST(sim_host, run_shots_parallel) {
+  dqcs_handle_t a[5], b[5];
+  EXPECT_EQ(dqcs_sim_run_shots_parallel(shot_factory, NULL, NULL, 42, 0, 5, 2, a, 0), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+  EXPECT_EQ(dqcs_sim_run_shots_parallel(shot_factory, NULL, NULL, 42, 0, 5, 2, b, 0), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+  for (int i = 0; i < 5; i++) {
+    char *x = dqcs_arb_get_str(a[i], 0);
+    char *y = dqcs_arb_get_str(b[i], 0);
+    EXPECT_STREQ(x, y);
+    if (x) free(x);
+    if (y) free(y);
+    EXPECT_EQ(dqcs_handle_delete(a[i]), dqcs_return_t::DQCS_SUCCESS);
+    EXPECT_EQ(dqcs_handle_delete(b[i]), dqcs_return_t::DQCS_SUCCESS);
+  }
+
+  EXPECT_EQ(dqcs_sim_run_shots_parallel(failing_shot_factory, NULL, NULL, 42, 0, 5, 2, a, 0), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "no simulation for you");
+
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
+// Returns the total number of outcomes recorded by the given simulation, and
+// the number of times the outcome 3 was recorded through count3.
+uint64_t outcome_totals(dqcs_handle_t sim, uint64_t *count3) {
+  uint64_t outcomes[3] = {0, 0, 0};
+  uint64_t counts[3] = {0, 0, 0};
+  ssize_t num_entries = dqcs_sim_outcomes(sim, outcomes, counts, 3);
+  EXPECT_GE(num_entries, 0);
+  EXPECT_LE(num_entries, 3);
+  uint64_t total = 0;
+  *count3 = 0;
+  for (ssize_t i = 0; i < num_entries; i++) {
+    total += counts[i];
+    if (outcomes[i] == 3) {
+      *count3 = counts[i];
+    }
+  }
+  return total;
+}
+
+// The outcomes of parallel shots are added to a simulation, and match those
+// of the same shots run serially.
+TEST(sim_host, run_shots_parallel_outcomes) {
+  SIM_HEADER;
+  dqcs_pdef_set_run_cb(front, outcome_run_cb, NULL, NULL);
+  SIM_CONSTRUCT;
+
+  dqcs_handle_t results[5];
+  EXPECT_EQ(dqcs_sim_run_shots(sim, 0, 5, results), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(dqcs_handle_delete(results[i]), dqcs_return_t::DQCS_SUCCESS);
+  }
+  uint64_t serial_count3;
+  uint64_t serial_total = outcome_totals(sim, &serial_count3);
+  EXPECT_EQ(serial_total, 10u);
+  EXPECT_EQ(serial_count3, 5u);
+
+  EXPECT_EQ(dqcs_sim_outcomes_clear(sim), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_sim_run_shots_parallel(outcome_shot_factory, NULL, NULL, 42, 0, 5, 2, results, sim), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(dqcs_handle_delete(results[i]), dqcs_return_t::DQCS_SUCCESS);
+  }
+  uint64_t parallel_count3;
+  uint64_t parallel_total = outcome_totals(sim, &parallel_count3);
+  EXPECT_EQ(parallel_total, serial_total);
+  EXPECT_EQ(parallel_count3, serial_count3);
+
+  // Without a simulation, the outcomes are discarded.
+  EXPECT_EQ(dqcs_sim_run_shots_parallel(outcome_shot_factory, NULL, NULL, 42, 0, 5, 2, results, 0), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+  for (int i = 0; i < 5; i++) {
+    EXPECT_EQ(dqcs_handle_delete(results[i]), dqcs_return_t::DQCS_SUCCESS);
+  }
+  EXPECT_EQ(outcome_totals(sim, &parallel_count3), serial_total);
+
+  // Outcomes can only be added to a simulation.
+  dqcs_handle_t a;
+  MAKE_ARB(a, "{}");
+  EXPECT_EQ(dqcs_sim_run_shots_parallel(outcome_shot_factory, NULL, NULL, 42, 0, 5, 2, results, a), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  SIM_FOOTER;
+}
+
+dqcs_return_t pool_result(const void *user_data, size_t job, dqcs_handle_t result) {
+  int *results = (int*)user_data;
+  if (!result) {
+    return dqcs_return_t::DQCS_FAILURE;
+  }
+  results[job]++;
+  return dqcs_handle_delete(result);
+}
+
+// Independent simulations on a pool of worker threads.
+TEST(sim_host, run_pool) {
+  int results[7] = {0, 0, 0, 0, 0, 0, 0};
+  EXPECT_EQ(dqcs_sim_run_pool(shot_factory, pool_result, NULL, results, 0, 7, 3, 0), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+  for (int i = 0; i < 7; i++) {
+    EXPECT_EQ(results[i], 1);
+  }
+
+  EXPECT_EQ(dqcs_sim_run_pool(failing_shot_factory, pool_result, NULL, results, 0, 7, 3, 0), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "no simulation for you");
+
+  EXPECT_EQ(dqcs_sim_run_pool(shot_factory, NULL, NULL, results, 0, 7, 3, 0), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: the result callback is required");
+
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
+// Querying the performance statistics of the plugins.
+TEST(sim_host, stats) {
+  SIM_HEADER;
+  user_data_t ud = {"run() was here", 0};
+  dqcs_pdef_set_run_cb(front, run_cb, NULL, &ud);
+  SIM_CONSTRUCT;
+
+  EXPECT_EQ(dqcs_sim_start(sim, 0), dqcs_return_t::DQCS_SUCCESS);
+  dqcs_handle_t a = dqcs_sim_wait(sim);
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  dqcs_handle_t stats = dqcs_sim_stats(sim);
+  ASSERT_NE(stats, 0u) << "Unexpected error: " << dqcs_error_get();
+  char *json = dqcs_arb_json_get(stats);
+  ASSERT_NE(json, nullptr) << "Unexpected error: " << dqcs_error_get();
+  std::string s(json);
+  free(json);
+  EXPECT_NE(s.find("\"front\":{"), std::string::npos) << s;
+  EXPECT_NE(s.find("\"op1\":{"), std::string::npos) << s;
+  EXPECT_NE(s.find("\"back\":{"), std::string::npos) << s;
+  EXPECT_NE(s.find("\"gates_sent\":0"), std::string::npos) << s;
+  EXPECT_NE(s.find("\"gate_callback\":{"), std::string::npos) << s;
+  EXPECT_EQ(dqcs_handle_delete(stats), dqcs_return_t::DQCS_SUCCESS);
+
+  SIM_FOOTER;
+}
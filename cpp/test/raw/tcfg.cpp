@@ -231,3 +231,126 @@ TEST(tcfg, verbosity) {
   // Leak check.
   EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
 }
+
+// Test downstream in-flight window configuration.
+TEST(tcfg, downstream_window) {
+  dqcs_handle_t a;
+
+  // Create a fresh config.
+  a = dqcs_pdef_new(dqcs_plugin_type_t::DQCS_PTYPE_FRONT, "a", "b", "c");
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+  a = dqcs_tcfg_new(a, "d");
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Check the default (no limit).
+  EXPECT_EQ(dqcs_tcfg_downstream_window_get(a), 0);
+
+  // Set a limit.
+  EXPECT_EQ(dqcs_tcfg_downstream_window_set(a, 1024), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_tcfg_downstream_window_get(a), 1024);
+
+  // Remove the limit again.
+  EXPECT_EQ(dqcs_tcfg_downstream_window_set(a, 0), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_tcfg_downstream_window_get(a), 0);
+
+  // Check that invalid handles are rejected.
+  EXPECT_EQ(dqcs_tcfg_downstream_window_set(0, 1024), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: handle 0 is invalid");
+  EXPECT_EQ(dqcs_tcfg_downstream_window_get(0), -1);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: handle 0 is invalid");
+
+  // Delete the handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
+// Test receive strategy configuration.
+TEST(tcfg, receive_strategy) {
+  dqcs_handle_t a;
+
+  // Create a fresh config.
+  a = dqcs_pdef_new(dqcs_plugin_type_t::DQCS_PTYPE_BACK, "a", "b", "c");
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+  a = dqcs_tcfg_new(a, "d");
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Check the default (block right away).
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_get(a), dqcs_receive_strategy_t::DQCS_RECV_BLOCK);
+  EXPECT_EQ(dqcs_tcfg_receive_spin_time_get(a), 0.0);
+
+  // Poll before blocking.
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_set(a, dqcs_receive_strategy_t::DQCS_RECV_SPIN, 0.5), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_get(a), dqcs_receive_strategy_t::DQCS_RECV_SPIN);
+  EXPECT_EQ(dqcs_tcfg_receive_spin_time_get(a), 0.5);
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_set(a, dqcs_receive_strategy_t::DQCS_RECV_YIELD, 0.25), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_get(a), dqcs_receive_strategy_t::DQCS_RECV_YIELD);
+  EXPECT_EQ(dqcs_tcfg_receive_spin_time_get(a), 0.25);
+
+  // Check that we can't do silly things.
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_set(a, dqcs_receive_strategy_t::DQCS_RECV_SPIN, -1.0), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: the polling time must be a nonnegative, finite number of seconds");
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_set(a, dqcs_receive_strategy_t::DQCS_RECV_INVALID, 0.0), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: invalid receive strategy");
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_get(a), dqcs_receive_strategy_t::DQCS_RECV_YIELD);
+
+  // Switch back to blocking.
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_set(a, dqcs_receive_strategy_t::DQCS_RECV_BLOCK, 1.0), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_get(a), dqcs_receive_strategy_t::DQCS_RECV_BLOCK);
+  EXPECT_EQ(dqcs_tcfg_receive_spin_time_get(a), 0.0);
+
+  // Check that invalid handles are rejected.
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_set(0, dqcs_receive_strategy_t::DQCS_RECV_SPIN, 0.5), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: handle 0 is invalid");
+  EXPECT_EQ(dqcs_tcfg_receive_strategy_get(0), dqcs_receive_strategy_t::DQCS_RECV_INVALID);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: handle 0 is invalid");
+  EXPECT_EQ(dqcs_tcfg_receive_spin_time_get(0), -1.0);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: handle 0 is invalid");
+
+  // Delete the handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
+
+// Test gatestream capture configuration.
+TEST(tcfg, downstream_capture) {
+  dqcs_handle_t a;
+  char *s;
+
+  // Create a fresh config.
+  a = dqcs_pdef_new(dqcs_plugin_type_t::DQCS_PTYPE_FRONT, "a", "b", "c");
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+  a = dqcs_tcfg_new(a, "d");
+  ASSERT_NE(a, 0u) << "Unexpected error: " << dqcs_error_get();
+
+  // Check the default (disabled).
+  EXPECT_EQ(dqcs_tcfg_downstream_capture_get(a), nullptr);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: gatestream capture is disabled for this plugin");
+
+  // Enable capturing.
+  EXPECT_EQ(dqcs_tcfg_downstream_capture_set(a, "front.replay"), dqcs_return_t::DQCS_SUCCESS);
+  s = dqcs_tcfg_downstream_capture_get(a);
+  ASSERT_NE(s, nullptr) << "Unexpected error: " << dqcs_error_get();
+  EXPECT_STREQ(s, "front.replay");
+  free(s);
+
+  // Disable it again.
+  EXPECT_EQ(dqcs_tcfg_downstream_capture_set(a, NULL), dqcs_return_t::DQCS_SUCCESS);
+  EXPECT_EQ(dqcs_tcfg_downstream_capture_get(a), nullptr);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: gatestream capture is disabled for this plugin");
+
+  // Check that invalid handles are rejected.
+  EXPECT_EQ(dqcs_tcfg_downstream_capture_set(0, "front.replay"), dqcs_return_t::DQCS_FAILURE);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: handle 0 is invalid");
+  EXPECT_EQ(dqcs_tcfg_downstream_capture_get(0), nullptr);
+  EXPECT_STREQ(dqcs_error_get(), "Invalid argument: handle 0 is invalid");
+
+  // Delete the handle.
+  EXPECT_EQ(dqcs_handle_delete(a), dqcs_return_t::DQCS_SUCCESS);
+
+  // Leak check.
+  EXPECT_EQ(dqcs_handle_leak_check(), dqcs_return_t::DQCS_SUCCESS) << dqcs_error_get();
+}
@@ -150,3 +150,101 @@ TEST(gate, custom_no_matrix) {
   EXPECT_EQ(gate->get_name(), "test");
   EXPECT_TRUE(gate->has_name());
 }
+
+TEST(gate, matrix_view) {
+  wrap::complex matrix_data[] = {
+    1.0, 2.0,
+    wrap::complex(0.0, 3.0), 4.0
+  };
+  wrap::Matrix matrix = wrap::Matrix(1, matrix_data);
+  wrap::MatrixView view = matrix.view();
+  EXPECT_EQ(view.size(), 4);
+  EXPECT_EQ(view.dimension(), 2);
+  EXPECT_EQ(view(0, 1), wrap::complex(2.0));
+  EXPECT_EQ(view(1, 0), wrap::complex(0.0, 3.0));
+  EXPECT_EQ(view[3], wrap::complex(4.0));
+  EXPECT_EQ(view.data_as_doubles()[3], 0.0);
+  EXPECT_EQ(view.data(), matrix.view().data());
+  EXPECT_EQ(std::vector<wrap::complex>(view.begin(), view.end()), matrix.get());
+  EXPECT_EQ(matrix.get_as_doubles(), std::vector<double>({1.0, 0.0, 2.0, 0.0, 0.0, 3.0, 4.0, 0.0}));
+}
+
+TEST(gate, matrix_products) {
+  wrap::Matrix x(wrap::PredefinedGate::X);
+  wrap::Matrix z(wrap::PredefinedGate::Z);
+  wrap::Matrix y(wrap::PredefinedGate::Y);
+  EXPECT_TRUE(x.multiply(x).approx_eq(wrap::Matrix(wrap::PredefinedGate::I)));
+  EXPECT_TRUE(z.multiply(x).approx_eq(y, 0.000001, true));
+  EXPECT_FALSE(z.multiply(x).approx_eq(y, 0.000001, false));
+
+  wrap::Matrix xi = x.kron(wrap::Matrix(wrap::PredefinedGate::I));
+  EXPECT_EQ(xi.num_qubits(), 2);
+  EXPECT_EQ(xi.view()(0, 2), wrap::complex(1.0));
+  EXPECT_EQ(xi.view()(0, 1), wrap::complex(0.0));
+  EXPECT_ERROR(x.multiply(xi), "Invalid argument: cannot multiply matrices of dimension 2 and 4");
+}
+
+TEST(gate, qubit_span) {
+  wrap::Matrix x_matrix(wrap::PredefinedGate::X);
+  wrap::Gate cnot = wrap::Gate::unitary({wrap::QubitRef(2)}, {wrap::QubitRef(1)}, x_matrix);
+  EXPECT_EQ(cnot.get_type(), wrap::GateType::Unitary);
+  EXPECT_EQ(cnot.get_targets().dump(), std::string("QubitReferenceSet(\n    [\n        QubitRef(\n            2,\n        ),\n    ],\n)"));
+  EXPECT_EQ(cnot.get_controls().dump(), std::string("QubitReferenceSet(\n    [\n        QubitRef(\n            1,\n        ),\n    ],\n)"));
+
+  // The matrix is borrowed, so it can be reused.
+  EXPECT_TRUE(x_matrix.approx_eq(wrap::Gate::unitary(wrap::QubitRef(3), x_matrix).get_matrix()));
+
+  wrap::SmallQubitSet<3> qubits = wrap::SmallQubitSet<3>().with(wrap::QubitRef(1)).with(wrap::QubitRef(2));
+  EXPECT_EQ(qubits.size(), 2);
+  EXPECT_TRUE(qubits.contains(wrap::QubitRef(2)));
+  EXPECT_ERROR(qubits.push(wrap::QubitRef(1)), "the specified qubit is already part of the set");
+  qubits.push(wrap::QubitRef(3));
+  EXPECT_ERROR(qubits.push(wrap::QubitRef(4)), "SmallQubitSet capacity exceeded");
+  wrap::Gate toffoli = wrap::Gate::predefined(wrap::PredefinedGate::X, qubits);
+  EXPECT_EQ(toffoli.get_targets().dump(), std::string("QubitReferenceSet(\n    [\n        QubitRef(\n            3,\n        ),\n    ],\n)"));
+  EXPECT_EQ(toffoli.get_controls().size(), 2);
+
+  // The qubits of a gate can be read back without constructing handles.
+  wrap::SmallQubitSet<2> controls = toffoli.get_controls_small<2>();
+  EXPECT_EQ(controls.size(), 2);
+  EXPECT_TRUE(controls.contains(wrap::QubitRef(1)));
+  EXPECT_EQ(toffoli.get_targets_small().size(), 1);
+  EXPECT_EQ(toffoli.get_targets_small().data()[0], 3u);
+  EXPECT_EQ(toffoli.get_measures_small().size(), 0);
+  EXPECT_ERROR(toffoli.get_controls_small<1>(), "SmallQubitSet capacity exceeded");
+
+  std::vector<wrap::QubitRef> measures = {wrap::QubitRef(4), wrap::QubitRef(5)};
+  wrap::Gate measure = wrap::Gate::measure(measures, wrap::PauliBasis::X);
+  EXPECT_EQ(measure.get_type(), wrap::GateType::Measurement);
+  EXPECT_EQ(measure.get_measures().size(), 2);
+
+  EXPECT_ERROR(wrap::Gate::measure({wrap::QubitRef(4), wrap::QubitRef(4)}), "Invalid argument: cannot use qubit 4 twice");
+  EXPECT_ERROR(wrap::Gate::unitary({wrap::QubitRef(1)}, {wrap::QubitRef(1)}, x_matrix), "Invalid argument: qubit 1 is used more than once");
+}
+
+TEST(gate, predefined_tags) {
+  wrap::Gate cnot = wrap::Gate::predefined<wrap::gates::CNOT>(wrap::QubitRef(1), wrap::QubitRef(2));
+  EXPECT_EQ(cnot.get_controls().size(), 1);
+  EXPECT_EQ(cnot.get_targets().size(), 1);
+  EXPECT_TRUE(cnot.has_predefined());
+  EXPECT_EQ(cnot.get_predefined(), wrap::PredefinedGate::X);
+  EXPECT_TRUE(cnot.is<wrap::gates::CNOT>());
+  EXPECT_FALSE(cnot.is<wrap::gates::X>());
+  EXPECT_FALSE(cnot.is<wrap::gates::CZ>());
+  EXPECT_TRUE(wrap::Matrix(wrap::PredefinedGate::X).approx_eq(cnot.get_matrix()));
+
+  wrap::Gate h = wrap::Gate::predefined(wrap::PredefinedGate::H, wrap::QubitRef(3));
+  EXPECT_TRUE(h.is<wrap::gates::H>());
+
+  // Rotations are tagged, other parameterized and custom unitary gates are
+  // not.
+  wrap::Gate rx = wrap::Gate::predefined(wrap::PredefinedGate::RX, wrap::QubitRef(1), wrap::ArbData().with_arg(1.0));
+  EXPECT_EQ(rx.get_predefined(), wrap::PredefinedGate::RX);
+  EXPECT_TRUE(wrap::Matrix(wrap::PredefinedGate::RX, wrap::ArbData().with_arg(1.0)).approx_eq(rx.get_matrix()));
+  wrap::Gate r = wrap::Gate::predefined(wrap::PredefinedGate::R, wrap::QubitRef(1), wrap::ArbData().with_arg(1.0).with_arg(2.0).with_arg(3.0));
+  EXPECT_FALSE(r.has_predefined());
+  wrap::Gate x = wrap::Gate::unitary(wrap::QubitRef(1), wrap::Matrix(wrap::PredefinedGate::X));
+  EXPECT_FALSE(x.has_predefined());
+  EXPECT_FALSE(x.is<wrap::gates::X>());
+  EXPECT_ERROR(x.get_predefined(), "Invalid argument: gate is not known to be a predefined gate");
+}
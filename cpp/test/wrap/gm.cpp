@@ -373,3 +373,106 @@ ArbData(\n\
   }
   dqcsim::raw::dqcs_handle_leak_check();
 }
+
+TEST(gatemap, cache) {{
+  auto map = GateMap<MyUnboundGate, MyBoundGate>()
+    .with_unitary(MyUnboundGate("x"), PredefinedGate::X, 0)
+    .with_unitary(MyUnboundGate("swap"), PredefinedGate::SWAP)
+    .with_cache_capacity(1);
+  EXPECT_EQ(map.get_cache_capacity(), 1u);
+
+  const MyUnboundGate *key = nullptr;
+  auto x = Gate::predefined(PredefinedGate::X, QubitSet().with(1_q));
+  auto swap = Gate::predefined(PredefinedGate::SWAP, QubitSet().with(1_q).with(2_q));
+  EXPECT_EQ(map.detect(x, &key, nullptr, nullptr), true);
+  EXPECT_EQ(key->name, "x");
+  EXPECT_EQ(map.detect(x, &key, nullptr, nullptr), true);
+  EXPECT_EQ(map.get_cache_hits(), 1u);
+  EXPECT_EQ(map.get_cache_misses(), 1u);
+
+  // The capacity is one gate, so alternating between two gates never hits.
+  EXPECT_EQ(map.detect(swap, &key, nullptr, nullptr), true);
+  EXPECT_EQ(key->name, "swap");
+  EXPECT_EQ(map.detect(x, &key, nullptr, nullptr), true);
+  EXPECT_EQ(key->name, "x");
+  EXPECT_EQ(map.get_cache_hits(), 1u);
+  EXPECT_EQ(map.get_cache_misses(), 3u);
+
+  map.set_cache_capacity(0);
+  EXPECT_EQ(map.detect(x, &key, nullptr, nullptr), true);
+  EXPECT_EQ(map.get_cache_hits(), 1u);
+  EXPECT_EQ(map.get_cache_misses(), 4u);
+
+  }
+  dqcsim::raw::dqcs_handle_leak_check();
+}
+
+enum class MyOp { H, CNOT, Measure, Prep, Custom };
+
+using MyStaticGateMap = StaticGateMap<MyOp,
+  converters::Unitary<MyOp, MyOp::H, gates::H>,
+  converters::Unitary<MyOp, MyOp::CNOT, gates::CNOT>,
+  converters::Measure<MyOp, MyOp::Measure>,
+  converters::Prep<MyOp, MyOp::Prep>>;
+
+TEST(gatemap, fingerprint) {{
+  EXPECT_EQ(Gate::predefined<gates::H>(1_q).get_fingerprint(), gates::H::fingerprint);
+  EXPECT_EQ(Gate::predefined<gates::CNOT>(1_q, 2_q).get_fingerprint(), gates::CNOT::fingerprint);
+  EXPECT_NE(gates::CNOT::fingerprint, gates::Toffoli::fingerprint);
+  EXPECT_EQ(Gate::measure(QubitSet().with(1_q).with(2_q)).get_fingerprint(),
+    gate_fingerprint(GateType::Measurement, static_cast<uint64_t>(PredefinedGate::I), 0, 2));
+  EXPECT_EQ(Gate::measure(QubitSet().with(1_q), PauliBasis::X).get_fingerprint(),
+    gate_fingerprint(GateType::Measurement, 0, 0, 1));
+  EXPECT_EQ(Gate::unitary(QubitSet().with(1_q), Matrix(PredefinedGate::X)).get_fingerprint(),
+    gate_fingerprint(GateType::Unitary, 0, 0, 1));
+  EXPECT_EQ(Gate::custom("custom", QubitSet().with(1_q)).get_fingerprint(),
+    gate_fingerprint(GateType::Custom, 0, 0, 0));
+  }
+  dqcsim::raw::dqcs_handle_leak_check();
+}
+
+TEST(gatemap, static_gate_map) {{
+  auto map = MyStaticGateMap()
+    .with_custom(MyOp::Custom, std::make_shared<MyCustomGateConverter>());
+
+  // Gates with a known predefined type are matched by fingerprint.
+  MyOp key = MyOp::Custom;
+  EXPECT_EQ(map.detect(Gate::predefined<gates::CNOT>(1_q, 2_q), key), true);
+  EXPECT_EQ(key, MyOp::CNOT);
+  EXPECT_EQ(map.detect(Gate::predefined<gates::H>(3_q), key), true);
+  EXPECT_EQ(key, MyOp::H);
+  EXPECT_EQ(map.detect(Gate::measure(QubitSet().with(1_q).with(2_q)), key), true);
+  EXPECT_EQ(key, MyOp::Measure);
+  EXPECT_EQ(map.detect(Gate::prep(QubitSet().with(1_q)), key), true);
+  EXPECT_EQ(key, MyOp::Prep);
+
+  // Gates that do not match the table fall back to the regular gate map.
+  key = MyOp::Custom;
+  EXPECT_EQ(map.detect(Gate::unitary(QubitSet().with(1_q), Matrix(PredefinedGate::H)), key), true);
+  EXPECT_EQ(key, MyOp::H);
+  key = MyOp::H;
+  QubitSet qubits = QubitSet(0);
+  ArbData params = ArbData(0);
+  EXPECT_EQ(map.detect(Gate::custom("custom", QubitSet().with(3_q).with(4_q)), key, &qubits, &params), true);
+  EXPECT_EQ(key, MyOp::Custom);
+  EXPECT_EQ(qubits.size(), 2);
+  EXPECT_EQ(params.pop_arb_arg_as<int>(), 42);
+  key = MyOp::Custom;
+  EXPECT_EQ(map.detect(Gate::predefined<gates::Swap>(1_q, 2_q), key), false);
+  EXPECT_EQ(map.detect(Gate::predefined<gates::Toffoli>(1_q, 2_q, 3_q), key), false);
+  EXPECT_EQ(key, MyOp::Custom);
+
+  // The qubits and parameters of fingerprint matches are the same as those
+  // returned by a regular gate map.
+  EXPECT_EQ(map.detect(Gate::predefined<gates::CNOT>(1_q, 2_q).with_arg(33), key, &qubits, &params), true);
+  EXPECT_EQ(key, MyOp::CNOT);
+  EXPECT_EQ(qubits.copy_into_vector(), std::vector<QubitRef>({1_q, 2_q}));
+  EXPECT_EQ(params.pop_arb_arg_as<int>(), 33);
+
+  // Construction goes through the regular gate map.
+  Gate cnot = map.construct(MyOp::CNOT, QubitSet().with(1_q).with(2_q));
+  EXPECT_TRUE(cnot.is<gates::CNOT>());
+  EXPECT_ERROR(map.construct(MyOp::H, QubitSet().with(1_q).with(2_q)), "Invalid argument: expected 0 control and 1 target qubits");
+  }
+  dqcsim::raw::dqcs_handle_leak_check();
+}
@@ -0,0 +1,107 @@
+#include <dqcsim>
+#include "util.hpp"
+#include "gtest/gtest.h"
+
+using namespace dqcsim;
+
+// Constructs a simulation of which the frontend returns its argument with
+// the job index appended to it.
+static wrap::SimulationConfiguration job_configuration(size_t job) {
+  return wrap::SimulationConfiguration()
+    .without_reproduction()
+    .with_stderr_verbosity(wrap::Loglevel::Error)
+    .with_plugin(wrap::Frontend().with_callbacks(
+      wrap::Plugin::Frontend("a", "b", "c")
+        .with_run([job](wrap::RunningPluginState &state, wrap::ArbData &&args) -> wrap::ArbData {
+          (void)state;
+          args.push_arb_arg<uint64_t>(job);
+          return std::move(args);
+        })
+    ))
+    .with_plugin(wrap::Backend().with_callbacks(
+      wrap::Plugin::Backend("a", "b", "c")
+    ));
+}
+
+// Independent simulations on a pool of worker threads.
+TEST(sim_pool, results) {
+  std::vector<int> results(7, 0);
+  wrap::ArbData data;
+  data.push_arb_arg<uint64_t>(42);
+  wrap::SimulationPool(job_configuration)
+    .with_threads(3)
+    .run(7, data, [&results](size_t job, wrap::ArbData &&result) {
+      ASSERT_LT(job, results.size());
+      ASSERT_EQ(result.get_arb_arg_count(), 2u);
+      EXPECT_EQ(result.get_arb_arg_as<uint64_t>(0), 42u);
+      EXPECT_EQ(result.get_arb_arg_as<uint64_t>(1), job);
+      results[job]++;
+    });
+  for (int count : results) {
+    EXPECT_EQ(count, 1);
+  }
+
+  // Without an argument, the frontends receive an empty ArbData.
+  size_t num_results = 0;
+  wrap::SimulationPool(job_configuration)
+    .with_threads(2)
+    .with_max_processes(4)
+    .run(3, [&num_results](size_t job, wrap::ArbData &&result) {
+      ASSERT_EQ(result.get_arb_arg_count(), 1u);
+      EXPECT_EQ(result.get_arb_arg_as<uint64_t>(0), job);
+      num_results++;
+    });
+  EXPECT_EQ(num_results, 3u);
+
+  wrap::check(raw::dqcs_handle_leak_check());
+}
+
+// Failing jobs are reported through the error callback, or stop the pool if
+// there is none.
+TEST(sim_pool, errors) {
+  auto factory = [](size_t job) -> wrap::SimulationConfiguration {
+    if (job == 3) {
+      throw std::runtime_error("no simulation for you");
+    }
+    return job_configuration(job);
+  };
+
+  std::vector<int> results(7, 0);
+  std::vector<int> errors(7, 0);
+  wrap::SimulationPool(factory)
+    .with_threads(3)
+    .run(7, [&results](size_t job, wrap::ArbData &&result) {
+      (void)result;
+      results[job]++;
+    }, [&errors](size_t job, const std::string &error) {
+      EXPECT_EQ(error, "no simulation for you");
+      errors[job]++;
+    });
+  for (size_t job = 0; job < 7; job++) {
+    EXPECT_EQ(results[job], job == 3 ? 0 : 1);
+    EXPECT_EQ(errors[job], job == 3 ? 1 : 0);
+  }
+
+  EXPECT_ERROR(
+    wrap::SimulationPool(factory)
+      .with_threads(3)
+      .run(7, [](size_t job, wrap::ArbData &&result) {
+        (void)job;
+        (void)result;
+      }),
+    "no simulation for you");
+
+  // Exceptions thrown by the callbacks stop the pool as well.
+  EXPECT_ERROR(
+    wrap::SimulationPool(job_configuration)
+      .with_threads(3)
+      .run(7, [](size_t job, wrap::ArbData &&result) {
+        (void)result;
+        if (job == 5) {
+          throw std::runtime_error("I don't like this result");
+        }
+      }),
+    "I don't like this result");
+
+  wrap::check(raw::dqcs_handle_leak_check());
+}
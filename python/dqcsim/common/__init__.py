@@ -6,9 +6,11 @@ __all__ = [ #@
     'ArbCmdQueue',
     'Handle',
     'Measurement',
+    'MatrixView',
     'MeasurementSet',
     'QubitSet',
     'Loglevel',
+    'PredefinedGate',
 ]
 
 __pdoc__ = { #@
@@ -17,6 +19,8 @@ __pdoc__ = { #@
     'ArbCmdQueue': False,
     'handle': False,
     'Handle': False,
+    'mat': False,
+    'MatrixView': False,
     'mset': False,
     'MeasurementSet': False,
     'qbset': False,
@@ -35,6 +39,7 @@ from dqcsim.common.arb import ArbData
 from dqcsim.common.cmd import ArbCmd
 from dqcsim.common.cq import ArbCmdQueue
 from dqcsim.common.handle import Handle
+from dqcsim.common.mat import MatrixView
 from dqcsim.common.meas import Measurement
 from dqcsim.common.mset import MeasurementSet
 from dqcsim.common.qbset import QubitSet
@@ -51,3 +56,34 @@ class Loglevel(IntEnum):
     FATAL = raw.DQCS_LOG_FATAL
     OFF = raw.DQCS_LOG_OFF
 
+
+class PredefinedGate(IntEnum):
+    """Enumeration of the predefined gate types that can be sent in bulk using
+    `GateStreamSource.gate_batch()`."""
+
+    I = raw.DQCS_GATE_PAULI_I
+    X = raw.DQCS_GATE_PAULI_X
+    Y = raw.DQCS_GATE_PAULI_Y
+    Z = raw.DQCS_GATE_PAULI_Z
+    H = raw.DQCS_GATE_H
+    S = raw.DQCS_GATE_S
+    SDAG = raw.DQCS_GATE_S_DAG
+    T = raw.DQCS_GATE_T
+    TDAG = raw.DQCS_GATE_T_DAG
+    RX90 = raw.DQCS_GATE_RX_90
+    RXM90 = raw.DQCS_GATE_RX_M90
+    RX180 = raw.DQCS_GATE_RX_180
+    RY90 = raw.DQCS_GATE_RY_90
+    RYM90 = raw.DQCS_GATE_RY_M90
+    RY180 = raw.DQCS_GATE_RY_180
+    RZ90 = raw.DQCS_GATE_RZ_90
+    RZM90 = raw.DQCS_GATE_RZ_M90
+    RZ180 = raw.DQCS_GATE_RZ_180
+    RX = raw.DQCS_GATE_RX
+    RY = raw.DQCS_GATE_RY
+    RZ = raw.DQCS_GATE_RZ
+    PHASE_K = raw.DQCS_GATE_PHASE_K
+    PHASE = raw.DQCS_GATE_PHASE
+    R = raw.DQCS_GATE_R
+    SWAP = raw.DQCS_GATE_SWAP
+    SQRT_SWAP = raw.DQCS_GATE_SQRT_SWAP
@@ -0,0 +1,31 @@
+import dqcsim._dqcsim as raw
+from dqcsim.common.handle import Handle
+
+class MatrixView(object):
+    """Exposes the data of a DQCsim matrix handle to NumPy without copying it.
+
+    The object implements NumPy's array interface, so `numpy.asarray()` turns
+    it into a read-only two-dimensional `complex128` array that refers
+    directly to the matrix data owned by DQCsim. NumPy keeps a reference to
+    the view, which in turn owns the matrix handle, so the data remains valid
+    for as long as the array is alive."""
+
+    def __init__(self, handle):
+        super().__init__()
+        if not isinstance(handle, Handle):
+            handle = Handle(handle)
+        self._handle = handle
+        with handle as hndl:
+            dim = raw.dqcs_mat_dimension(hndl)
+            ptr = raw.dqcs_mat_view(hndl)
+        self.__array_interface__ = {
+            'shape': (dim, dim),
+            'typestr': '<c16',
+            'data': (ptr, True),
+            'version': 3,
+        }
+
+    def array(self):
+        """Returns the matrix as a read-only NumPy array."""
+        import numpy
+        return numpy.asarray(self)
@@ -59,6 +59,13 @@ class Simulator(object):
             reproduction file is enabled, and if it is, what style to use for
             storing filesystem paths.
 
+          - `repro_stream = str or None` (default: `None`)
+
+            When specified, the reproduction log is streamed to the given file
+            in DQCsim's binary reproduction format while the simulation runs,
+            instead of being kept in memory until `write_reproduction_file()`
+            is called.
+
           - `dqcsim_verbosity = Loglevel` (default: `Loglevel.TRACE`)
 
             Sets the minimum loglevel that a message generated by DQCsim itself
@@ -66,6 +73,18 @@ class Simulator(object):
             plugin-specific verbosities. This defaults to `Loglevel.TRACE` to
             effectively disable the filter.
 
+          - `stats_verbosity = Loglevel` (default: `Loglevel.OFF`)
+
+            Sets the loglevel at which the performance statistics of the
+            plugins are logged when the simulation is stopped. The statistics
+            are not logged when this is `Loglevel.OFF`.
+
+          - `trace_out = str or None` (default: `None`)
+
+            When specified, the plugins record a timeline of their callbacks
+            and gatestream round trips, which is written to the given file in
+            the Chrome trace event format when the simulation is stopped.
+
           - `stderr_verbosity = Loglevel` (default: `Loglevel.INFO`)
 
             Sets the minimum loglevel needed for a message to be logged to
@@ -124,10 +143,22 @@ class Simulator(object):
         if self._repro not in {'keep', 'absolute', 'relative', None}:
             raise TypeError("repro must be 'keep', 'absolute', 'relative', or None")
 
+        self._repro_stream = kwargs.pop('repro_stream', None)
+        if self._repro_stream is not None and not isinstance(self._repro_stream, str):
+            raise TypeError("repro_stream must be a string or None")
+
         self._dqcsim_verbosity = kwargs.pop('dqcsim_verbosity', Loglevel.TRACE)
         if not isinstance(self._dqcsim_verbosity, Loglevel):
             raise TypeError("dqcsim_verbosity must be a Loglevel")
 
+        self._stats_verbosity = kwargs.pop('stats_verbosity', Loglevel.OFF)
+        if not isinstance(self._stats_verbosity, Loglevel):
+            raise TypeError("stats_verbosity must be a Loglevel")
+
+        self._trace_out = kwargs.pop('trace_out', None)
+        if self._trace_out is not None and not isinstance(self._trace_out, str):
+            raise TypeError("trace_out must be a string or None")
+
         self._stderr_verbosity = kwargs.pop('stderr_verbosity', Loglevel.INFO)
         if not isinstance(self._stderr_verbosity, Loglevel):
             raise TypeError("stderr_verbosity must be a Loglevel")
@@ -611,10 +642,15 @@ class Simulator(object):
                     'relative': raw.DQCS_PATH_STYLE_RELATIVE,
                     'absolute': raw.DQCS_PATH_STYLE_ABSOLUTE,
                 }[self._repro])
+                if self._repro_stream is not None:
+                    raw.dqcs_scfg_repro_stream_set(scfg, self._repro_stream)
 
             # Configure regular logging.
             raw.dqcs_scfg_dqcsim_verbosity_set(scfg, int(self._dqcsim_verbosity))
             raw.dqcs_scfg_stderr_verbosity_set(scfg, int(self._stderr_verbosity))
+            raw.dqcs_scfg_stats_verbosity_set(scfg, int(self._stats_verbosity))
+            if self._trace_out is not None:
+                raw.dqcs_scfg_trace_file_set(scfg, self._trace_out)
             if self._log_capture is not None:
                 raw.dqcs_scfg_log_callback_pyfun(scfg, int(self._log_capture_verbosity), self._log_capture)
             for key, value in self._tee.items():
@@ -775,6 +811,19 @@ class Simulator(object):
                     raw.dqcs_sim_get_author(sim, str(target)),
                     raw.dqcs_sim_get_version(sim, str(target)))
 
+    def get_stats(self):
+        """Returns the performance statistics collected by the plugins.
+
+        The statistics are returned as an `ArbData` object, of which the JSON
+        object maps the name of each plugin to a dictionary of counters and
+        timing histograms. Requests that are still queued up on the host side
+        are not included; call `yeeld()` first if you need those as well.
+        """
+        if self._sim_handle is None:
+            raise RuntimeError("No simulation is currently running")
+        with self._sim_handle as sim:
+            return ArbData._from_raw(Handle(raw.dqcs_sim_stats(sim)))
+
     def __len__(self):
         """Returns the number of plugins in the pipeline."""
         l = len(self._opers)
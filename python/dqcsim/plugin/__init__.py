@@ -399,6 +399,14 @@ class Plugin(object):
         """Routes an `ArbCmd` that originates from the host."""
         return self._route_arb(state_handle, 'host', cmd_handle)
 
+    def _matrix_from_raw(self, handle):
+        """Converts a matrix handle to the representation used by the
+        callbacks, taking ownership of the handle."""
+        if getattr(self, 'numpy_matrices', False):
+            return MatrixView(handle).array()
+        with handle as mat:
+            return raw.dqcs_mat_get(mat)
+
     def _new_pdef(self, typ):
         """Constructs a pdef `Handle` configured with appropriate metadata and
         the callbacks common to all plugins."""
@@ -795,6 +803,45 @@ class GateStreamSource(Plugin):
                     with gate as gate:
                         self._pc(raw.dqcs_plugin_gate, gate)
 
+    def gate_batch(self, gate_types, qubits, params=None):
+        """Instructs the downstream plugin to execute a sequence of predefined
+        unitary gates described by NumPy arrays.
+
+        This is equivalent to calling the gate functions one by one, but the
+        whole sequence is handed to DQCsim in a single call and is sent
+        downstream as a single message. This makes it much faster for large
+        numbers of gates. It requires NumPy.
+
+        `gate_types` must be a one-dimensional array of
+        `dqcsim.common.PredefinedGate` values, one per gate. `qubits` must be
+        an array of qubit references with one row per gate; it may be
+        one-dimensional if each gate acts on a single qubit. Rows may be
+        padded with zeros at the start to make gates with differing numbers of
+        qubits fit in one array. The rightmost qubits in a row are the targets
+        of the gate, and any qubits before them become control qubits. For
+        instance, a CNOT gate is described by `PredefinedGate.X` with the row
+        `[control, target]`.
+
+        `params` is only needed if any of the gates is parameterized. It must
+        then be an array of floats with one row per gate. The rotation gates
+        and `PHASE` use the first column as θ, `PHASE_K` uses it as k, and `R`
+        uses the first three columns as θ, φ and λ. Unused entries are
+        ignored.
+
+        If any of the gates is invalid, none of them are sent.
+        """
+        import numpy
+        gate_types = numpy.ascontiguousarray(gate_types, dtype=numpy.intc).reshape(-1)
+        num_gates = len(gate_types)
+        if not num_gates:
+            return
+        qubits = numpy.ascontiguousarray(qubits, dtype=numpy.uint64).reshape(num_gates, -1)
+        if params is None:
+            params = numpy.zeros(0, dtype=numpy.float64)
+        else:
+            params = numpy.ascontiguousarray(params, dtype=numpy.float64).reshape(num_gates, -1)
+        self._pc(raw.dqcs_plugin_gate_predef_batch, gate_types, qubits, params)
+
     def get_measurement(self, qubit):
         """Returns the `Measurement` representing the latest measurement result
         for the given downstream qubit."""
@@ -815,7 +862,11 @@ class GateStreamSource(Plugin):
 
         `cycles` must be a nonnegative integer, representing the number of
         cycles to advance the simulation by. The simulation time after the
-        advancement is returned."""
+        advancement is returned.
+
+        Consecutive advancements are combined and sent along with the next
+        gate, so the downstream plugin sees a single `handle_advance()` call
+        for the total number of cycles."""
         return self._pc(raw.dqcs_plugin_advance, int(cycles))
 
     def get_cycle(self):
@@ -908,6 +959,24 @@ class Frontend(GateStreamSource):
         handle = Handle(self._pc(raw.dqcs_plugin_recv))
         return ArbData._from_raw(handle)
 
+    def record_outcome(self, outcome):
+        """Records a measurement outcome in the histogram of the simulation.
+
+        The outcome is an integer of up to 64 bits, usually representing the
+        result of a single shot. The host can read back how often each outcome
+        was recorded without having to receive a message for every shot."""
+        self._pc(raw.dqcs_plugin_record_outcome, outcome)
+
+    def record_measurements(self, *qubits):
+        """Records the latest measurement results of the given qubits as an
+        outcome in the histogram of the simulation.
+
+        Bit i of the recorded outcome is set if the latest measurement of the
+        i-th qubit returned one. At most 64 qubits can be specified, and all
+        of them must have a defined measurement result."""
+        import array
+        self._pc(raw.dqcs_plugin_record_measurements, array.array('Q', qubits))
+
     #==========================================================================
     # Callback helpers
     #==========================================================================
@@ -1109,8 +1178,16 @@ class Operator(GateStreamSource):
         command is forwarded downstream. If there is at least one, it is NOT
         forwarded downstream, even if the requested operation does not have a
         handler (an error will be reported instead).
+
+    Gate matrices are passed to the callbacks as row-major lists of Python
+    complex numbers by default. Set the `numpy_matrices` class attribute to
+    `True` to receive them as read-only two-dimensional NumPy arrays instead.
+    These refer directly to the matrix data owned by DQCsim, so they are
+    constructed without copying the matrix. This requires NumPy.
     """
 
+    numpy_matrices = False
+
     #==========================================================================
     # Callback helpers
     #==========================================================================
@@ -1166,8 +1243,7 @@ class Operator(GateStreamSource):
         controls = QubitSet._from_raw(Handle(raw.dqcs_gate_controls(gate_handle)))
         measures = QubitSet._from_raw(Handle(raw.dqcs_gate_measures(gate_handle)))
         if raw.dqcs_gate_has_matrix(gate_handle):
-            matrix = raw.dqcs_gate_matrix(gate_handle)
-            matrix = raw.dqcs_mat_get(matrix)
+            matrix = self._matrix_from_raw(Handle(raw.dqcs_gate_matrix(gate_handle)))
         else:
             matrix = None
 
@@ -1391,8 +1467,16 @@ class Backend(Plugin):
         the ArbCmd, and **kwargs is set to the JSON object. If you return None,
         an empty ArbData object will be automatically generated for the
         response.
+
+    Gate matrices are passed to the callbacks as row-major lists of Python
+    complex numbers by default. Set the `numpy_matrices` class attribute to
+    `True` to receive them as read-only two-dimensional NumPy arrays instead.
+    These refer directly to the matrix data owned by DQCsim, so they are
+    constructed without copying the matrix. This requires NumPy.
     """
 
+    numpy_matrices = False
+
     #==========================================================================
     # Callback helpers
     #==========================================================================
@@ -1423,8 +1507,7 @@ class Backend(Plugin):
         controls = QubitSet._from_raw(Handle(raw.dqcs_gate_controls(gate_handle)))
         measures = QubitSet._from_raw(Handle(raw.dqcs_gate_measures(gate_handle)))
         if raw.dqcs_gate_has_matrix(gate_handle):
-            matrix = raw.dqcs_gate_matrix(gate_handle)
-            matrix = raw.dqcs_mat_get(matrix)
+            matrix = self._matrix_from_raw(Handle(raw.dqcs_gate_matrix(gate_handle)))
         else:
             matrix = None
 
@@ -1439,6 +1522,12 @@ class Backend(Plugin):
                     pass
 
                 # Convert the gate matrix to a controlled gate matrix.
+                if self.numpy_matrices:
+                    with Handle(raw.dqcs_gate_matrix(gate_handle)) as mat:
+                        matrix = MatrixView(raw.dqcs_mat_add_controls(mat, len(controls))).array()
+                    targets = controls + targets
+                    self._cb(state_handle, 'handle_unitary_gate', targets, matrix, data)
+                    return MeasurementSet._to_raw([]).take()
                 cur_nq = len(targets)
                 cur_size = 2**cur_nq
                 assert(len(matrix) == cur_size * cur_size)
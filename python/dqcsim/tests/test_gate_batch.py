@@ -0,0 +1,78 @@
+import unittest, math
+from dqcsim.common import *
+from dqcsim.host import *
+from dqcsim.plugin import *
+
+try:
+    import numpy
+except ImportError:
+    numpy = None
+
+@plugin("Test frontend plugin", "Test", "0.1")
+class TestFrontend(Frontend):
+    def handle_run(self, *args, **kwargs):
+        self.allocate(3)
+        self.gate_batch(
+            [PredefinedGate.H, PredefinedGate.X, PredefinedGate.RZ, PredefinedGate.SWAP],
+            numpy.array([
+                [0, 0, 1],
+                [0, 1, 2],
+                [0, 0, 3],
+                [0, 2, 3],
+            ]),
+            numpy.array([0.0, 0.0, math.pi, 0.0]))
+        self.gate_batch([PredefinedGate.X] * 3, [1, 2, 3])
+        self.free(1, 2, 3)
+
+@plugin("Test backend plugin", "Test", "0.1")
+class TestBackend(Backend):
+    numpy_matrices = True
+
+    def __init__(self):
+        super().__init__()
+        self.call_log = []
+
+    def handle_unitary_gate(self, targets, matrix, arb):
+        self.call_log.append((targets, matrix.shape))
+
+    def handle_measurement_gate(self, measures, matrix, arb):
+        return [Measurement(qubit, 0) for qubit in measures]
+
+    def handle_host_get_log(self):
+        log = self.call_log
+        self.call_log = []
+        return ArbData(log=[[targets, list(shape)] for targets, shape in log])
+
+@unittest.skipIf(numpy is None, "NumPy is not available")
+class Tests(unittest.TestCase):
+    def test_gate_batch(self):
+        sim = Simulator(
+            TestFrontend(), TestBackend(),
+            repro=None, stderr_verbosity=Loglevel.ERROR
+        )
+        sim.simulate()
+        sim.start()
+        sim.wait()
+        log = sim.arb('back', 'get', 'log')['log']
+        sim.stop()
+
+        self.assertEqual(log, [
+            [[1], [2, 2]],
+            [[1, 2], [4, 4]],
+            [[3], [2, 2]],
+            [[2, 3], [4, 4]],
+            [[1], [2, 2]],
+            [[2], [2, 2]],
+            [[3], [2, 2]],
+        ])
+
+    def test_matrix_view(self):
+        import dqcsim._dqcsim as raw
+        matrix = numpy.array([[0.0, 1.0], [1.0j, 0.0]])
+        view = MatrixView(Handle(raw.dqcs_mat_new(matrix))).array()
+        self.assertEqual(view.shape, (2, 2))
+        self.assertFalse(view.flags.writeable)
+        self.assertTrue(numpy.array_equal(view, matrix))
+
+if __name__ == '__main__':
+    unittest.main()
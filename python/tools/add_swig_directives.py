@@ -184,10 +184,13 @@ error_return_value_map = {
     # Return values that indicate errors with NULL:
     'char *': '== NULL',
     'double *': '== NULL',
+    'const double *': '== NULL',
+    'const void *': '== NULL',
 
     # Return values that indicate errors with zero:
     'dqcs_handle_t': '== 0',
     'dqcs_qubit_t': '== 0',
+    'dqcs_future_t': '== 0',
 
     # Return values that indicate errors with negative numbers (-1):
     'double': '< 0',
@@ -202,6 +205,9 @@ error_return_value_map = {
     'dqcs_path_style_t': '== DQCS_PATH_STYLE_INVALID',
     'dqcs_plugin_type_t': '== DQCS_PTYPE_INVALID',
     'dqcs_gate_type_t': '== DQCS_GATE_TYPE_INVALID',
+    'dqcs_predefined_gate_t': '== DQCS_GATE_INVALID',
+    'dqcs_numa_policy_t': '== DQCS_NUMA_INVALID',
+    'dqcs_receive_strategy_t': '== DQCS_RECV_INVALID',
 }
 
 error_fmt = '''\
@@ -238,6 +244,26 @@ void dqcs_swig_callback_cleanup(void *user) {
     Py_XDECREF((PyObject*)user);
     PyGILState_Release(gstate);
 }
+
+// Acquires a C-contiguous buffer of the given item size from a Python object
+// supporting the buffer protocol, such as a NumPy array. kinds lists the
+// struct format characters that are acceptable. Returns 0 on success; in
+// that case the buffer must be released with PyBuffer_Release(). Returns -1
+// with a Python exception set otherwise.
+int dqcs_swig_get_array(PyObject *obj, Py_buffer *view, size_t itemsize, const char *kinds, const char *what) {
+    if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0) {
+        return -1;
+    }
+    const char *format = view->format ? view->format : "B";
+    while (*format && strchr("@=<>!", *format)) format++;
+    if ((size_t)view->itemsize != itemsize || !format[0] || format[1] || !strchr(kinds, format[0])) {
+        PyBuffer_Release(view);
+        PyErr_Format(PyExc_ValueError, "%s must be a contiguous array of %d-byte %s", what,
+            (int)itemsize, strcmp(kinds, "d") ? "integers" : "floats");
+        return -1;
+    }
+    return 0;
+}
 %}
 
 %typemap(out) double* dqcs_mat_get {
@@ -255,12 +281,26 @@ void dqcs_swig_callback_cleanup(void *user) {
   }
 }
 
-%typemap(in) (size_t num_qubits, const double *matrix) {
-  if (!PySequence_Check($input)) {
+%typemap(in) (size_t num_qubits, const double *matrix) (Py_buffer view, int have_view = 0) {
+  // Contiguous complex128 buffers (such as NumPy arrays) are copied in one
+  // go; anything else is treated as a sequence of Python numbers.
+  size_t len;
+  if (PyObject_CheckBuffer($input)) {
+    if (PyObject_GetBuffer($input, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0) {
+      SWIG_fail;
+    }
+    have_view = 1;
+    if (view.itemsize != 2 * sizeof(double) || view.format == NULL || strcmp(view.format, "Zd")) {
+      PyErr_SetString(PyExc_ValueError, "Matrix buffer must contain complex doubles");
+      SWIG_fail;
+    }
+    len = view.len / view.itemsize;
+  } else if (PySequence_Check($input)) {
+    len = PySequence_Length($input);
+  } else {
     PyErr_SetString(PyExc_ValueError, "Expected a sequence");
     SWIG_fail;
   }
-  size_t len = PySequence_Length($input);
   $1 = 0;
   size_t x = len;
   while (x > 1) {
@@ -276,19 +316,75 @@ void dqcs_swig_callback_cleanup(void *user) {
     PyErr_SetString(PyExc_ValueError, "Failed to allocate memory");
     SWIG_fail;
   }
-  for (size_t i = 0; i < len; i++) {
-    PyObject *o = PySequence_GetItem($input, i);
-    if (PyNumber_Check(o)) {
-      Py_complex pc = PyComplex_AsCComplex(o);
-      $2[i * 2] = pc.real;
-      $2[i * 2 + 1] = pc.imag;
-    } else {
-      PyErr_SetString(PyExc_ValueError, "Sequence elements must be numbers");
-      SWIG_fail;
+  if (have_view) {
+    memcpy($2, view.buf, len * 2 * sizeof(double));
+    PyBuffer_Release(&view);
+    have_view = 0;
+  } else {
+    for (size_t i = 0; i < len; i++) {
+      PyObject *o = PySequence_GetItem($input, i);
+      if (PyNumber_Check(o)) {
+        Py_complex pc = PyComplex_AsCComplex(o);
+        $2[i * 2] = pc.real;
+        $2[i * 2 + 1] = pc.imag;
+      } else {
+        PyErr_SetString(PyExc_ValueError, "Sequence elements must be numbers");
+        SWIG_fail;
+      }
     }
   }
 }
 
+%typemap(freearg) (size_t num_qubits, const double *matrix) {
+  if (have_view$argnum) {
+    PyBuffer_Release(&view$argnum);
+  }
+  if ($2 != NULL) {
+    free((void*)$2);
+  }
+}
+
+%typemap(in) (const dqcs_predefined_gate_t *gate_types, size_t num_gates) (Py_buffer view, int have_view = 0) {
+  if (dqcs_swig_get_array($input, &view, sizeof(dqcs_predefined_gate_t), "bBhHiIlLqQnN", "gate_types") < 0) {
+    SWIG_fail;
+  }
+  have_view = 1;
+  $1 = (const dqcs_predefined_gate_t*)view.buf;
+  $2 = view.len / view.itemsize;
+}
+
+%typemap(in) (const dqcs_qubit_t *qubits, size_t num_qubits) (Py_buffer view, int have_view = 0) {
+  if (dqcs_swig_get_array($input, &view, sizeof(dqcs_qubit_t), "bBhHiIlLqQnN", "qubits") < 0) {
+    SWIG_fail;
+  }
+  have_view = 1;
+  $1 = (const dqcs_qubit_t*)view.buf;
+  $2 = view.len / view.itemsize;
+}
+
+%typemap(in) (const double *params, size_t num_params) (Py_buffer view, int have_view = 0) {
+  if (dqcs_swig_get_array($input, &view, sizeof(double), "d", "params") < 0) {
+    SWIG_fail;
+  }
+  have_view = 1;
+  $1 = (const double*)view.buf;
+  $2 = view.len / view.itemsize;
+}
+
+%typemap(freearg) (const dqcs_predefined_gate_t *gate_types, size_t num_gates),
+                  (const dqcs_qubit_t *qubits, size_t num_qubits),
+                  (const double *params, size_t num_params) {
+  if (have_view$argnum) {
+    PyBuffer_Release(&view$argnum);
+  }
+}
+
+// dqcs_mat_view() returns the address of the borrowed matrix data as an
+// integer, to be wrapped in a NumPy array interface by the Python code.
+%typemap(out) const double* dqcs_mat_view {
+  $result = PyLong_FromVoidPtr((void*)$1);
+}
+
 %typemap(freearg) (const double *matrix, size_t matrix_len) {
   if ($1 != NULL) {
     free($1);
@@ -0,0 +1,295 @@
+//! End-to-end scaling benchmark based on the null plugins.
+//!
+//! This sweeps the number of operators in the pipeline, the number of qubits
+//! allocated by the frontend, and the number of gates per measurement round
+//! trip, with all plugins running either as threads within this process or
+//! as separate processes. One parameter is varied at a time, keeping the
+//! others at their baseline value. The results are written to stdout as a
+//! JSON array with one object per configuration. Each configuration runs in
+//! a fresh child process of this benchmark, such that the peak memory usage
+//! and startup time are measured independently.
+//!
+//! Usage:
+//!
+//! ```text
+//! dqcsbench [--gates <n>] [--mode thread|process]
+//! ```
+//!
+//! The process variant uses the `dqcsfenull`, `dqcsopnull` and `dqcsbenull`
+//! executables, which are looked for in the working directory, the directory
+//! of this executable, and the system $PATH.
+use dqcsim::{
+    common::{
+        error::{inv_arg, Result},
+        log::LoglevelFilter,
+        types::{ArbData, PluginMetadata, PluginType},
+    },
+    host::{
+        accelerator::Accelerator,
+        configuration::{
+            PluginConfiguration, PluginLogConfiguration, PluginProcessConfiguration,
+            PluginProcessSpecification, PluginThreadConfiguration, SimulatorConfiguration,
+        },
+        simulator::Simulator,
+    },
+    plugin::null::{null_backend, null_frontend, null_operator, NullWorkload, NullWorkloadResult},
+};
+use serde::{Deserialize, Serialize};
+use std::{env, process, process::Command, time::Instant};
+
+/// Numbers of operators in the pipeline to sweep over.
+const OPERATORS: &[usize] = &[0, 1, 2, 4, 8];
+
+/// Numbers of qubits allocated by the frontend to sweep over.
+const QUBITS: &[usize] = &[1, 16, 256, 4096, 65536];
+
+/// Numbers of gates per measurement round trip to sweep over. Zero means
+/// that only a single measurement is done at the end.
+const GATES_PER_MEASUREMENT: &[usize] = &[1, 10, 100, 1000, 0];
+
+/// The default number of gates sent by the frontend.
+const DEFAULT_GATES: usize = 100_000;
+
+/// How the plugins are run.
+#[derive(Debug, Clone, Copy, PartialEq, Deserialize, Serialize)]
+#[serde(rename_all = "lowercase")]
+enum Mode {
+    /// All plugins run in threads within the benchmark process.
+    Thread,
+
+    /// All plugins run in separate processes.
+    Process,
+}
+
+/// A single benchmark configuration.
+#[derive(Debug, Clone, Copy, PartialEq, Deserialize, Serialize)]
+struct BenchConfiguration {
+    mode: Mode,
+    operators: usize,
+    qubits: usize,
+    gates: usize,
+    gates_per_measurement: usize,
+}
+
+/// The results of a single benchmark configuration.
+#[derive(Debug, Clone, Copy, PartialEq, Deserialize, Serialize)]
+struct BenchResult {
+    #[serde(flatten)]
+    configuration: BenchConfiguration,
+
+    /// The time it took to construct the simulator, including spawning and
+    /// initializing all the plugins, in seconds.
+    startup_seconds: f64,
+
+    /// The time between starting the frontend and receiving its return
+    /// value, in seconds.
+    run_seconds: f64,
+
+    /// The timing information reported by the frontend.
+    #[serde(flatten)]
+    workload: NullWorkloadResult,
+
+    /// The peak resident set size of the benchmark process, including the
+    /// plugin threads, in KiB.
+    peak_rss_kib: u64,
+
+    /// The peak resident set size of the largest plugin process, in KiB.
+    peak_plugin_rss_kib: u64,
+}
+
+/// Returns the peak resident set size in KiB for the given `getrusage()`
+/// target, or 0 if it is not available.
+fn peak_rss_kib(who: libc::c_int) -> u64 {
+    let mut usage: libc::rusage = unsafe { std::mem::zeroed() };
+    if unsafe { libc::getrusage(who, &mut usage) } != 0 {
+        return 0;
+    }
+    let peak = usage.ru_maxrss as u64;
+    if cfg!(target_os = "macos") {
+        peak / 1024
+    } else {
+        peak
+    }
+}
+
+/// Returns the plugin configuration for the null plugin of the given type.
+fn plugin(mode: Mode, typ: PluginType) -> Result<Box<dyn PluginConfiguration>> {
+    Ok(match mode {
+        Mode::Thread => {
+            let metadata = PluginMetadata::new("null", "TU Delft QCE", "0.1.0");
+            let definition = match typ {
+                PluginType::Frontend => null_frontend(metadata),
+                PluginType::Operator => null_operator(metadata),
+                PluginType::Backend => null_backend(metadata),
+            };
+            PluginThreadConfiguration::new(
+                definition,
+                PluginLogConfiguration::new("", LoglevelFilter::Off),
+            )
+            .into()
+        }
+        Mode::Process => {
+            let mut configuration = PluginProcessConfiguration::new(
+                "",
+                PluginProcessSpecification::from_sugar("null", typ)?,
+            );
+            configuration.nonfunctional.verbosity = LoglevelFilter::Off;
+            configuration.into()
+        }
+    })
+}
+
+/// Runs a single benchmark configuration within this process.
+fn run(configuration: BenchConfiguration) -> Result<BenchResult> {
+    let mut simulator_configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(plugin(configuration.mode, PluginType::Frontend)?);
+    for _ in 0..configuration.operators {
+        simulator_configuration =
+            simulator_configuration.with_plugin(plugin(configuration.mode, PluginType::Operator)?);
+    }
+    simulator_configuration =
+        simulator_configuration.with_plugin(plugin(configuration.mode, PluginType::Backend)?);
+
+    let start = Instant::now();
+    let mut simulator = Simulator::new(simulator_configuration)?;
+    let startup_seconds = start.elapsed().as_secs_f64();
+
+    let workload = NullWorkload {
+        qubits: configuration.qubits,
+        gates: configuration.gates,
+        gates_per_measurement: configuration.gates_per_measurement,
+    };
+    let args = ArbData::from_json(serde_json::to_string(&workload)?, vec![])?;
+    let start = Instant::now();
+    simulator.simulation.start(args)?;
+    let ret = simulator.simulation.wait()?;
+    let run_seconds = start.elapsed().as_secs_f64();
+    let workload: NullWorkloadResult = serde_json::from_str(&ret.get_json()?)?;
+
+    // Dropping the simulator waits for the plugin processes to exit, which
+    // is needed for their resource usage to be available.
+    drop(simulator);
+
+    Ok(BenchResult {
+        configuration,
+        startup_seconds,
+        run_seconds,
+        workload,
+        peak_rss_kib: peak_rss_kib(libc::RUSAGE_SELF),
+        peak_plugin_rss_kib: peak_rss_kib(libc::RUSAGE_CHILDREN),
+    })
+}
+
+/// Runs the JSON-encoded benchmark configuration passed to a child process,
+/// returning the JSON-encoded result.
+fn run_json(configuration: &str) -> Result<String> {
+    let result = run(serde_json::from_str(configuration)?)?;
+    Ok(serde_json::to_string(&result)?)
+}
+
+/// Runs a single benchmark configuration in a child process.
+fn run_child(configuration: BenchConfiguration) -> Result<BenchResult> {
+    let output = Command::new(env::current_exe()?)
+        .arg("--run")
+        .arg(serde_json::to_string(&configuration)?)
+        .output()?;
+    if !output.status.success() {
+        return inv_arg(format!(
+            "benchmark {} failed: {}",
+            serde_json::to_string(&configuration)?,
+            String::from_utf8_lossy(&output.stderr).trim()
+        ));
+    }
+    Ok(serde_json::from_slice(&output.stdout)?)
+}
+
+/// Returns the configurations to run, varying one parameter at a time.
+fn sweep(modes: &[Mode], gates: usize) -> Vec<BenchConfiguration> {
+    let mut configurations = vec![];
+    for &mode in modes {
+        let baseline = BenchConfiguration {
+            mode,
+            operators: 1,
+            qubits: 16,
+            gates,
+            gates_per_measurement: 100,
+        };
+        let variations =
+            OPERATORS
+                .iter()
+                .map(|&operators| BenchConfiguration {
+                    operators,
+                    ..baseline
+                })
+                .chain(
+                    QUBITS
+                        .iter()
+                        .map(|&qubits| BenchConfiguration { qubits, ..baseline }),
+                )
+                .chain(GATES_PER_MEASUREMENT.iter().map(|&gates_per_measurement| {
+                    BenchConfiguration {
+                        gates_per_measurement,
+                        ..baseline
+                    }
+                }));
+        for configuration in variations {
+            if !configurations.contains(&configuration) {
+                configurations.push(configuration);
+            }
+        }
+    }
+    configurations
+}
+
+fn usage() -> ! {
+    eprintln!("Usage: dqcsbench [--gates <n>] [--mode thread|process]");
+    process::exit(1);
+}
+
+fn main() {
+    let mut args = env::args().skip(1);
+    let mut gates = DEFAULT_GATES;
+    let mut modes = vec![Mode::Thread, Mode::Process];
+    while let Some(arg) = args.next() {
+        let value = args.next().unwrap_or_else(|| usage());
+        match &arg[..] {
+            "--run" => {
+                match run_json(&value) {
+                    Ok(result) => println!("{}", result),
+                    Err(e) => {
+                        eprintln!("{}", e);
+                        process::exit(1);
+                    }
+                }
+                return;
+            }
+            "--gates" => gates = value.parse().unwrap_or_else(|_| usage()),
+            "--mode" => {
+                modes = match &value[..] {
+                    "thread" => vec![Mode::Thread],
+                    "process" => vec![Mode::Process],
+                    _ => usage(),
+                }
+            }
+            _ => usage(),
+        }
+    }
+
+    let mut results = vec![];
+    for configuration in sweep(&modes, gates) {
+        eprintln!(
+            "Running {}...",
+            serde_json::to_string(&configuration).unwrap()
+        );
+        match run_child(configuration) {
+            Ok(result) => results.push(result),
+            Err(e) => {
+                eprintln!("{}", e);
+                process::exit(1);
+            }
+        }
+    }
+    println!("{}", serde_json::to_string_pretty(&results).unwrap());
+}
@@ -47,6 +47,13 @@ pub struct DQCsimStructOpt {
     #[structopt(long = "no-repro-out")]
     pub no_repro_out: bool,
 
+    /// Writes the reproduction file in DQCsim's binary format. The host calls
+    /// are then appended to the file as they are made, instead of being kept
+    /// in memory until the end of the run. --reproduce and
+    /// --reproduce-exactly detect the format automatically.
+    #[structopt(long = "repro-binary", conflicts_with = "no-repro-out")]
+    pub repro_binary: bool,
+
     /// Configures the way paths are stored in the reproduction file. The
     /// default is to save the paths as they were specified on the command
     /// line. The alternatives are to force usage of absolute paths or to force
@@ -140,6 +147,23 @@ pub struct DQCsimStructOpt {
     )]
     pub plugin_level: LoglevelFilter,
 
+    /// Logs the performance statistics of each plugin at the given level
+    /// when the simulation is shut down.
+    #[structopt(
+        long = "stats-level",
+        value_name = "level",
+        default_value = "off",
+        case_insensitive = true,
+        parse(try_from_str = friendly_enum_parse)
+    )]
+    pub stats_level: LoglevelFilter,
+
+    /// Records a timeline of the plugin callbacks and gatestream round trips
+    /// and writes it to the specified file in the Chrome trace event format,
+    /// which can be opened with chrome://tracing or the Perfetto UI.
+    #[structopt(long = "trace-out", value_name = "filename", parse(from_os_str))]
+    pub trace_out: Option<PathBuf>,
+
     /// Shows a more complete help message than --help.
     #[structopt(long = "long-help")]
     pub long_help: bool,
@@ -265,6 +289,7 @@ mod tests {
             host_stdout: false,
             repro_out: None,
             no_repro_out: false,
+            repro_binary: false,
             repro_path_style: ReproductionPathStyle::Keep,
             reproduce: None,
             reproduce_exactly: None,
@@ -273,6 +298,8 @@ mod tests {
             tee_files: vec![],
             dqcsim_level: LoglevelFilter::Trace,
             plugin_level: LoglevelFilter::Trace,
+            stats_level: LoglevelFilter::Off,
+            trace_out: None,
             long_help: false,
         };
         assert_eq!(
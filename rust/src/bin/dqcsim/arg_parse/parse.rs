@@ -228,6 +228,10 @@ pub struct CommandLineConfiguration {
 
     /// Reproduction output filename.
     pub reproduction_file: Option<PathBuf>,
+
+    /// Reader for the host calls of a binary reproduction file, to be made
+    /// after `host_calls`.
+    pub host_call_stream: Option<ReproductionReader>,
 }
 
 git_testament!(TESTAMENT);
@@ -329,8 +333,13 @@ impl CommandLineConfiguration {
                 } else {
                     Some(dqcsim_opts.repro_path_style)
                 },
+                stats_level: dqcsim_opts.stats_level,
+                trace_file: dqcsim_opts.trace_out.clone(),
+                reproduction_stream: None,
+                log_thread_affinity: vec![],
             },
             reproduction_file: dqcsim_opts.repro_out.clone(),
+            host_call_stream: None,
         };
 
         // Configure the plugins and handle the reconfiguration options.
@@ -346,11 +355,14 @@ impl CommandLineConfiguration {
                 .unwrap();
 
             // Parse the reproduction file and update the configuration with
-            // it.
-            config.host_calls = Reproduction::from_file(file)
-                .or_else(|e| format_error_ctxt("While reading reproduction file", e))?
+            // it. The host calls of binary reproduction files are streamed
+            // from the file while the simulation runs.
+            let (reproduction, host_call_stream) = Reproduction::open(file)
+                .or_else(|e| format_error_ctxt("While reading reproduction file", e))?;
+            config.host_calls = reproduction
                 .to_run(&mut config.dqcsim, plugin_mods, exact)
                 .or_else(|e| format_error_ctxt("While loading reproduction file", e))?;
+            config.host_call_stream = host_call_stream;
         } else {
             // Construct the plugin vector from the plugin definitions.
             let (first_specification, defs) = pcp.get_defs()?;
@@ -415,6 +427,11 @@ impl CommandLineConfiguration {
             config.reproduction_file.take();
         }
 
+        // Binary reproduction files are written while the simulation runs.
+        if dqcsim_opts.repro_binary {
+            config.dqcsim.reproduction_stream = config.reproduction_file.take();
+        }
+
         Ok(config)
     }
 }
@@ -453,9 +470,10 @@ mod tests {
             host_stdout: true,
             dqcsim: SimulatorConfiguration::default().with_seed("test"),
             reproduction_file: None,
+            host_call_stream: None,
         };
 
-        assert_eq!(format!("{:?}", c), "CommandLineConfiguration { host_calls: [], host_stdout: true, dqcsim: SimulatorConfiguration { seed: Seed { value: 14402189752926126668 }, stderr_level: Info, tee_files: [], log_callback: None, dqcsim_level: Trace, plugins: [], reproduction_path_style: Some(Keep) }, reproduction_file: None }");
+        assert_eq!(format!("{:?}", c), "CommandLineConfiguration { host_calls: [], host_stdout: true, dqcsim: SimulatorConfiguration { seed: Seed { value: 14402189752926126668 }, stderr_level: Info, tee_files: [], log_callback: None, dqcsim_level: Trace, plugins: [], reproduction_path_style: Some(Keep), stats_level: Off, trace_file: None, reproduction_stream: None, log_thread_affinity: [] }, reproduction_file: None, host_call_stream: None }");
     }
 
     #[test]
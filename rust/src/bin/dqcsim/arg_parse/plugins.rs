@@ -57,6 +57,13 @@ impl PluginNonfunctionalOpts {
             shutdown_timeout: self
                 .shutdown_timeout
                 .unwrap_or_else(|| Timeout::from_seconds(5)),
+            downstream_transport: GatestreamTransport::default(),
+            downstream_window: 0,
+            receive_strategy: ReceiveStrategy::default(),
+            downstream_capture: None,
+            pooled: false,
+            cpu_affinity: vec![],
+            numa_policy: NumaPolicy::Default,
         }
     }
 }
@@ -156,6 +163,13 @@ mod tests {
                 stderr_mode: StreamCaptureMode::Capture(Loglevel::Info),
                 accept_timeout: Timeout::from_seconds(5),
                 shutdown_timeout: Timeout::from_seconds(5),
+                downstream_transport: GatestreamTransport::Ipc,
+                downstream_window: 0,
+                receive_strategy: ReceiveStrategy::Block,
+                downstream_capture: None,
+                pooled: false,
+                cpu_affinity: vec![],
+                numa_policy: NumaPolicy::Default,
             }
         );
 
@@ -183,6 +197,13 @@ mod tests {
                 stderr_mode: StreamCaptureMode::Pass,
                 accept_timeout: Timeout::Infinite,
                 shutdown_timeout: Timeout::from_seconds(1),
+                downstream_transport: GatestreamTransport::Ipc,
+                downstream_window: 0,
+                receive_strategy: ReceiveStrategy::Block,
+                downstream_capture: None,
+                pooled: false,
+                cpu_affinity: vec![],
+                numa_policy: NumaPolicy::Default,
             }
         );
     }
@@ -73,7 +73,13 @@ where
         e
     })?;
 
-    let sim_result = run(&mut sim, cfg.host_stdout, cfg.host_calls.drain(..));
+    let mut sim_result = run(&mut sim, cfg.host_stdout, cfg.host_calls.drain(..));
+    if sim_result.is_ok() {
+        if let Some(host_call_stream) = cfg.host_call_stream.take() {
+            sim_result = host_call_stream
+                .try_for_each(|host_call| run(&mut sim, cfg.host_stdout, Some(host_call?)));
+        }
+    }
 
     if let Some(filename) = cfg.reproduction_file {
         match sim.simulation.write_reproduction_file(&filename) {
@@ -0,0 +1,17 @@
+//! Operator that fuses consecutive unitary gates into a single gate. Pass
+//! a `fusion.two_qubit` initialization command to fuse two-qubit gates as
+//! well.
+use dqcsim::{
+    common::types::PluginMetadata,
+    plugin::{fusion::fusion_operator, state::PluginState},
+};
+use std::env;
+
+fn main() {
+    let definition = fusion_operator(
+        PluginMetadata::new("Gate fusion operator", "TU Delft QCE", "0.1.0"),
+        false,
+    );
+
+    PluginState::run(&definition, env::args().nth(1).unwrap()).unwrap();
+}
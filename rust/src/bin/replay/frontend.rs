@@ -0,0 +1,18 @@
+//! Frontend that replays a gatestream capture file into the downstream
+//! plugin. The capture file is passed as the script argument, so a file with
+//! the `.replay` extension can be used directly as the frontend on the
+//! command line.
+use dqcsim::{
+    common::types::PluginMetadata,
+    plugin::{replay::replay_frontend, state::PluginState},
+};
+use std::env;
+
+fn main() {
+    let definition = replay_frontend(
+        PluginMetadata::new("Gatestream replay frontend", "TU Delft QCE", "0.1.0"),
+        env::args().nth(1).unwrap(),
+    );
+
+    PluginState::run(&definition, env::args().nth(2).unwrap()).unwrap();
+}
@@ -83,11 +83,7 @@ pub struct APIState {
     /// Mapping from handle to object.
     ///
     /// This contains all API-managed data.
-    pub objects: HashMap<dqcs_handle_t, APIObject>,
-
-    /// This variable stores the handle value that will be used for the next
-    /// allocation.
-    pub handle_counter: dqcs_handle_t,
+    pub objects: HandleTable<APIObject>,
 
     /// The handle that currently owns DQCsim's thread-local resources. This
     /// serves as a lock to ensure that no more than one object using
@@ -103,10 +99,7 @@ impl APIState {
     /// Stuffs the given object into the API-managed storage. Returns the
     /// handle created for it.
     pub fn push(&mut self, object: APIObject) -> dqcs_handle_t {
-        let handle = self.handle_counter;
-        self.objects.insert(handle, object);
-        self.handle_counter = handle + 1;
-        handle
+        self.objects.insert(object)
     }
 
     /// Claims the thread-local storage lock for the given handle.
@@ -121,7 +114,7 @@ impl APIState {
     /// Returns whether DQCsim's thread-locals are currently in use.
     pub fn thread_locals_claimed(&self) -> bool {
         if let Some(h) = self.thread_locals_used_by {
-            self.objects.contains_key(&h)
+            self.objects.contains(h)
         } else {
             false
         }
@@ -143,7 +136,7 @@ impl APIState {
 impl Drop for APIState {
     fn drop(&mut self) {
         let mut warn = false;
-        for (_, v) in self.objects.drain() {
+        for v in self.objects.drain() {
             if let APIObject::Simulator(_) = v {
                 warn = true;
                 std::mem::forget(v);
@@ -168,8 +161,7 @@ thread_local! {
     /// a configuration object is consumed into the object it configures, they
     /// should move out of this state.
     pub static API_STATE: RefCell<APIState> = RefCell::new(APIState {
-        objects: HashMap::new(),
-        handle_counter: 1,
+        objects: HandleTable::new(),
         thread_locals_used_by: None,
         last_error: None,
     });
@@ -277,11 +269,17 @@ pub struct ResolvedHandle {
 
 impl Drop for ResolvedHandle {
     /// If no ownership was taken over the API object with the given handle,
-    /// insert it back into the thread-local object pool.
+    /// insert it back into the thread-local object pool. Otherwise, the slot
+    /// reserved for it is freed, invalidating the handle.
     fn drop(&mut self) {
-        if let Some(ob) = self.ob.take() {
-            API_STATE.with(|state| state.borrow_mut().objects.insert(self.handle, ob));
-        }
+        API_STATE.with(|state| {
+            let mut state = state.borrow_mut();
+            if let Some(ob) = self.ob.take() {
+                state.objects.restore(self.handle, ob);
+            } else {
+                state.objects.release(self.handle);
+            }
+        });
     }
 }
 
@@ -479,7 +477,7 @@ mutate_api_object_as! {PluginJoinHandle, pjoin:
 /// container object is dropped, unless ownership of the object was taken
 /// over.
 pub fn resolve(handle: dqcs_handle_t) -> Result<ResolvedHandle> {
-    if let Some(ob) = API_STATE.with(|state| state.borrow_mut().objects.remove(&handle)) {
+    if let Some(ob) = API_STATE.with(|state| state.borrow_mut().objects.take(handle)) {
         Ok(ResolvedHandle {
             ob: Some(ob),
             handle,
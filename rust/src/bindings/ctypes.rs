@@ -38,6 +38,16 @@ pub type dqcs_handle_t = c_ulonglong;
 #[allow(non_camel_case_types)]
 pub type dqcs_qubit_t = c_ulonglong;
 
+/// Type for a measurement future.
+///
+/// Measurement futures refer to the result of a measurement that was sent to
+/// the downstream plugin, but which may not have been received yet. They are
+/// positive integers counting upwards from 1, and are only meaningful to the
+/// plugin that created them. The value zero is reserved for invalid
+/// references or error propagation.
+#[allow(non_camel_case_types)]
+pub type dqcs_future_t = c_ulonglong;
+
 /// Type for a simulation cycle timestamp.
 ///
 /// Timestamps count upward from zero. The type is signed to allow usage of -1
@@ -524,6 +534,85 @@ impl From<ReproductionPathStyle> for dqcs_path_style_t {
     }
 }
 
+/// NUMA memory placement policy for plugin processes.
+#[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq)]
+#[allow(non_camel_case_types)]
+pub enum dqcs_numa_policy_t {
+    /// Error value used to indicate that something went wrong.
+    DQCS_NUMA_INVALID = -1,
+
+    /// Specifies that the plugin inherits the memory policy of the simulator.
+    DQCS_NUMA_DEFAULT = 0,
+
+    /// Specifies that memory should be allocated on the given NUMA node when
+    /// possible.
+    DQCS_NUMA_PREFERRED = 1,
+
+    /// Specifies that memory may only be allocated on the given NUMA nodes.
+    DQCS_NUMA_BIND = 2,
+
+    /// Specifies that memory should be interleaved over the given NUMA nodes.
+    DQCS_NUMA_INTERLEAVE = 3,
+}
+
+impl From<&NumaPolicy> for dqcs_numa_policy_t {
+    fn from(x: &NumaPolicy) -> dqcs_numa_policy_t {
+        match x {
+            NumaPolicy::Default => dqcs_numa_policy_t::DQCS_NUMA_DEFAULT,
+            NumaPolicy::Preferred(_) => dqcs_numa_policy_t::DQCS_NUMA_PREFERRED,
+            NumaPolicy::Bind(_) => dqcs_numa_policy_t::DQCS_NUMA_BIND,
+            NumaPolicy::Interleave(_) => dqcs_numa_policy_t::DQCS_NUMA_INTERLEAVE,
+        }
+    }
+}
+
+/// Strategy used by a plugin to wait for incoming gatestream messages.
+#[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq)]
+#[allow(non_camel_case_types)]
+pub enum dqcs_receive_strategy_t {
+    /// Error value used to indicate that something went wrong.
+    DQCS_RECV_INVALID = -1,
+
+    /// Specifies that the plugin blocks in the operating system right away.
+    DQCS_RECV_BLOCK = 0,
+
+    /// Specifies that the plugin busy-polls for a while before blocking.
+    DQCS_RECV_SPIN = 1,
+
+    /// Specifies that the plugin polls for a while before blocking, yielding
+    /// to the operating system scheduler between polls.
+    DQCS_RECV_YIELD = 2,
+}
+
+impl From<ReceiveStrategy> for dqcs_receive_strategy_t {
+    fn from(x: ReceiveStrategy) -> dqcs_receive_strategy_t {
+        match x {
+            ReceiveStrategy::Block => dqcs_receive_strategy_t::DQCS_RECV_BLOCK,
+            ReceiveStrategy::Spin(_) => dqcs_receive_strategy_t::DQCS_RECV_SPIN,
+            ReceiveStrategy::Yield(_) => dqcs_receive_strategy_t::DQCS_RECV_YIELD,
+        }
+    }
+}
+
+impl dqcs_receive_strategy_t {
+    /// Converts to a `ReceiveStrategy`, using the given polling time in
+    /// seconds.
+    pub fn with_spin_time(self, spin_time: f64) -> Result<ReceiveStrategy> {
+        if !spin_time.is_finite() || spin_time < 0.0 {
+            inv_arg("the polling time must be a nonnegative, finite number of seconds")?;
+        }
+        let spin_time = std::time::Duration::from_nanos((spin_time * 1_000_000_000.0_f64) as u64);
+        match self {
+            dqcs_receive_strategy_t::DQCS_RECV_BLOCK => Ok(ReceiveStrategy::Block),
+            dqcs_receive_strategy_t::DQCS_RECV_SPIN => Ok(ReceiveStrategy::Spin(spin_time)),
+            dqcs_receive_strategy_t::DQCS_RECV_YIELD => Ok(ReceiveStrategy::Yield(spin_time)),
+            dqcs_receive_strategy_t::DQCS_RECV_INVALID => inv_arg("invalid receive strategy"),
+        }
+    }
+}
+
 /// Enumeration of gates defined by DQCsim.
 #[repr(C)]
 #[derive(Debug, Copy, Clone, PartialEq)]
@@ -921,6 +1010,43 @@ impl TryFrom<dqcs_predefined_gate_t> for UnitaryGateType {
     }
 }
 
+impl From<UnitaryGateType> for dqcs_predefined_gate_t {
+    fn from(gate_type: UnitaryGateType) -> Self {
+        match gate_type {
+            UnitaryGateType::I => dqcs_predefined_gate_t::DQCS_GATE_PAULI_I,
+            UnitaryGateType::X => dqcs_predefined_gate_t::DQCS_GATE_PAULI_X,
+            UnitaryGateType::Y => dqcs_predefined_gate_t::DQCS_GATE_PAULI_Y,
+            UnitaryGateType::Z => dqcs_predefined_gate_t::DQCS_GATE_PAULI_Z,
+            UnitaryGateType::H => dqcs_predefined_gate_t::DQCS_GATE_H,
+            UnitaryGateType::S => dqcs_predefined_gate_t::DQCS_GATE_S,
+            UnitaryGateType::SDAG => dqcs_predefined_gate_t::DQCS_GATE_S_DAG,
+            UnitaryGateType::T => dqcs_predefined_gate_t::DQCS_GATE_T,
+            UnitaryGateType::TDAG => dqcs_predefined_gate_t::DQCS_GATE_T_DAG,
+            UnitaryGateType::RX90 => dqcs_predefined_gate_t::DQCS_GATE_RX_90,
+            UnitaryGateType::RXM90 => dqcs_predefined_gate_t::DQCS_GATE_RX_M90,
+            UnitaryGateType::RX180 => dqcs_predefined_gate_t::DQCS_GATE_RX_180,
+            UnitaryGateType::RY90 => dqcs_predefined_gate_t::DQCS_GATE_RY_90,
+            UnitaryGateType::RYM90 => dqcs_predefined_gate_t::DQCS_GATE_RY_M90,
+            UnitaryGateType::RY180 => dqcs_predefined_gate_t::DQCS_GATE_RY_180,
+            UnitaryGateType::RZ90 => dqcs_predefined_gate_t::DQCS_GATE_RZ_90,
+            UnitaryGateType::RZM90 => dqcs_predefined_gate_t::DQCS_GATE_RZ_M90,
+            UnitaryGateType::RZ180 => dqcs_predefined_gate_t::DQCS_GATE_RZ_180,
+            UnitaryGateType::RX => dqcs_predefined_gate_t::DQCS_GATE_RX,
+            UnitaryGateType::RY => dqcs_predefined_gate_t::DQCS_GATE_RY,
+            UnitaryGateType::Phase => dqcs_predefined_gate_t::DQCS_GATE_PHASE,
+            UnitaryGateType::PhaseK => dqcs_predefined_gate_t::DQCS_GATE_PHASE_K,
+            UnitaryGateType::RZ => dqcs_predefined_gate_t::DQCS_GATE_RZ,
+            UnitaryGateType::U(1) => dqcs_predefined_gate_t::DQCS_GATE_U1,
+            UnitaryGateType::R => dqcs_predefined_gate_t::DQCS_GATE_R,
+            UnitaryGateType::SWAP => dqcs_predefined_gate_t::DQCS_GATE_SWAP,
+            UnitaryGateType::SQSWAP => dqcs_predefined_gate_t::DQCS_GATE_SQRT_SWAP,
+            UnitaryGateType::U(2) => dqcs_predefined_gate_t::DQCS_GATE_U2,
+            UnitaryGateType::U(3) => dqcs_predefined_gate_t::DQCS_GATE_U3,
+            UnitaryGateType::U(_) => dqcs_predefined_gate_t::DQCS_GATE_INVALID,
+        }
+    }
+}
+
 /// Enumeration of Pauli bases.
 #[repr(C)]
 #[derive(Debug, Copy, Clone, PartialEq)]
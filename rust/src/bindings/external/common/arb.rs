@@ -37,6 +37,11 @@ pub extern "C" fn dqcs_arb_json_get(arb: dqcs_handle_t) -> *mut c_char {
 }
 
 /// Sets the JSON/CBOR object of an `ArbData` object by means of a CBOR object.
+///
+/// If the object is already in canonical form, as is the case for objects
+/// returned by `dqcs_arb_cbor_get()`, it is only validated. Otherwise, it is
+/// converted to canonical form (sorted dictionaries, shortest encodings, and
+/// definite lengths), which is slower for large objects.
 #[no_mangle]
 pub extern "C" fn dqcs_arb_cbor_set(
     arb: dqcs_handle_t,
@@ -72,6 +77,104 @@ pub extern "C" fn dqcs_arb_cbor_get(
     })
 }
 
+/// Returns the CBOR encoding of the value at the given JSON pointer within
+/// the JSON/CBOR object of an `ArbData` object.
+///
+/// The pointer uses the RFC 6901 syntax, for instance `/noise/t1` for key
+/// `t1` of the dictionary at key `noise`, or `/qubits/3` for the fourth entry
+/// of the array at key `qubits`. The empty string refers to the object
+/// itself. Only the values along the path are parsed, so this is much faster
+/// than decoding the whole object when only a single value is needed.
+///
+/// The buffer semantics are the same as for `dqcs_arb_cbor_get()`. This
+/// function returns -1 on failure, including when there is no value at the
+/// given pointer.
+#[no_mangle]
+pub extern "C" fn dqcs_arb_query_cbor(
+    arb: dqcs_handle_t,
+    pointer: *const c_char,
+    obj: *mut c_void,
+    obj_size: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(arb as &ArbData);
+        return_raw(arb.get_cbor_at(receive_str(pointer)?)?, obj, obj_size)
+    })
+}
+
+/// Reads the number at the given JSON pointer within the JSON/CBOR object of
+/// an `ArbData` object, without decoding the rest of the object.
+///
+/// See `dqcs_arb_query_cbor()` for the pointer syntax. Integers are converted
+/// to floating point. The number is written to `value`.
+#[no_mangle]
+pub extern "C" fn dqcs_arb_query_f64(
+    arb: dqcs_handle_t,
+    pointer: *const c_char,
+    value: *mut c_double,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(arb as &ArbData);
+        if value.is_null() {
+            inv_arg("value is null")?;
+        }
+        let result = arb.get_cbor_value(receive_str(pointer)?)?;
+        unsafe { *value = result };
+        Ok(())
+    })
+}
+
+/// Reads the integer at the given JSON pointer within the JSON/CBOR object
+/// of an `ArbData` object, without decoding the rest of the object.
+///
+/// See `dqcs_arb_query_cbor()` for the pointer syntax. The integer is written
+/// to `value`. Floating point numbers are not converted; querying them fails.
+#[no_mangle]
+pub extern "C" fn dqcs_arb_query_i64(
+    arb: dqcs_handle_t,
+    pointer: *const c_char,
+    value: *mut i64,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(arb as &ArbData);
+        if value.is_null() {
+            inv_arg("value is null")?;
+        }
+        let result = arb.get_cbor_value(receive_str(pointer)?)?;
+        unsafe { *value = result };
+        Ok(())
+    })
+}
+
+/// Reads the boolean at the given JSON pointer within the JSON/CBOR object
+/// of an `ArbData` object, without decoding the rest of the object.
+///
+/// See `dqcs_arb_query_cbor()` for the pointer syntax.
+#[no_mangle]
+pub extern "C" fn dqcs_arb_query_bool(
+    arb: dqcs_handle_t,
+    pointer: *const c_char,
+) -> dqcs_bool_return_t {
+    api_return_bool(|| {
+        resolve!(arb as &ArbData);
+        arb.get_cbor_value(receive_str(pointer)?)
+    })
+}
+
+/// Reads the string at the given JSON pointer within the JSON/CBOR object of
+/// an `ArbData` object, without decoding the rest of the object.
+///
+/// See `dqcs_arb_query_cbor()` for the pointer syntax. On success, this
+/// **returns a newly allocated string. Free it with `free()` when you're done
+/// with it to avoid memory leaks.** On failure, this returns `NULL`.
+#[no_mangle]
+pub extern "C" fn dqcs_arb_query_text(arb: dqcs_handle_t, pointer: *const c_char) -> *mut c_char {
+    api_return_string(|| {
+        resolve!(arb as &ArbData);
+        arb.get_cbor_value(receive_str(pointer)?)
+    })
+}
+
 /// Pushes an unstructured string argument to the back of the list.
 #[no_mangle]
 pub extern "C" fn dqcs_arb_push_str(arb: dqcs_handle_t, s: *const c_char) -> dqcs_return_t {
@@ -321,6 +424,77 @@ pub extern "C" fn dqcs_arb_clear(arb: dqcs_handle_t) -> dqcs_return_t {
     })
 }
 
+/// Pushes a binary string stored in shared memory to the back of the shared
+/// argument list.
+///
+/// The data is copied into a sealed, read-only shared memory region once.
+/// When the `ArbData` is sent to another plugin process afterwards, only a
+/// reference to this region is sent, so large payloads such as initial state
+/// vectors are not copied again. Measurement data and other data sent back
+/// upstream through the gatestream is the exception; it is copied. The
+/// shared argument list is separate from the regular binary string list.
+/// Shared arguments are only supported on Linux.
+#[no_mangle]
+pub extern "C" fn dqcs_arb_shared_push(
+    arb: dqcs_handle_t,
+    obj: *const c_void,
+    obj_size: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(arb as &mut ArbData);
+        arb.get_shared_args_mut()
+            .push(SharedArg::from_bytes(receive_raw(obj, obj_size)?)?);
+        Ok(())
+    })
+}
+
+/// Returns a pointer to the contents of the shared-memory binary string at
+/// the specified index.
+///
+/// The size of the string is written to `obj_size`. The returned memory is
+/// read-only, and remains valid until the shared argument is removed from
+/// the `ArbData` or the `ArbData` is deleted. Unlike `dqcs_arb_get_raw()`,
+/// this does not copy the data.
+///
+/// This function returns `NULL` on failure.
+#[no_mangle]
+pub extern "C" fn dqcs_arb_shared_get(
+    arb: dqcs_handle_t,
+    index: ssize_t,
+    obj_size: *mut size_t,
+) -> *const c_void {
+    api_return(null(), || {
+        resolve!(arb as &ArbData);
+        if obj_size.is_null() {
+            inv_arg("obj_size is null")?;
+        }
+        let shared = arb.get_shared_args();
+        let data = shared[receive_index(shared.len(), index, false)?].as_bytes();
+        unsafe { *obj_size = data.len() };
+        Ok(data.as_ptr() as *const c_void)
+    })
+}
+
+/// Returns the number of shared-memory binary strings, or -1 to indicate
+/// failure.
+#[no_mangle]
+pub extern "C" fn dqcs_arb_shared_len(arb: dqcs_handle_t) -> ssize_t {
+    api_return(-1, || {
+        resolve!(arb as &ArbData);
+        Ok(arb.get_shared_args().len() as ssize_t)
+    })
+}
+
+/// Clears the shared-memory binary string list.
+#[no_mangle]
+pub extern "C" fn dqcs_arb_shared_clear(arb: dqcs_handle_t) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(arb as &mut ArbData);
+        arb.clear_shared_args();
+        Ok(())
+    })
+}
+
 /// Copies the data from one object to another.
 #[no_mangle]
 pub extern "C" fn dqcs_arb_assign(dest: dqcs_handle_t, src: dqcs_handle_t) -> dqcs_return_t {
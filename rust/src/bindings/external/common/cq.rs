@@ -65,3 +65,64 @@ pub extern "C" fn dqcs_cq_len(cq: dqcs_handle_t) -> ssize_t {
         Ok(cq.len() as ssize_t)
     })
 }
+
+/// Copies the `ArbCmd` objects in the given queue into new `ArbCmd` handles,
+/// written to a caller-provided array.
+///
+/// `cmds` must point to an array of at least `max_cmds` handles. The first
+/// `max_cmds` commands in the queue are copied, in queue order. The queue
+/// itself is not modified. The caller takes ownership of the returned
+/// handles and must delete them when it is done with them.
+///
+/// This function returns the number of handles written, or -1 to indicate
+/// failure.
+#[no_mangle]
+pub extern "C" fn dqcs_cq_get_all(
+    cq: dqcs_handle_t,
+    cmds: *mut dqcs_handle_t,
+    max_cmds: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(cq as &ArbCmdQueue);
+        let count = std::cmp::min(cq.len(), max_cmds);
+        if count > 0 && cmds.is_null() {
+            return inv_arg("unexpected NULL buffer");
+        }
+        for (i, cmd) in cq.iter().take(count).enumerate() {
+            unsafe { *cmds.add(i) = insert(cmd.clone()) };
+        }
+        Ok(count as ssize_t)
+    })
+}
+
+/// Moves the `ArbCmd` objects in the given queue into new `ArbCmd` handles,
+/// written to a caller-provided array.
+///
+/// This is equivalent to copying the front of the queue into a new `ArbCmd`
+/// and calling `dqcs_cq_next()` up to `max_cmds` times, but requires only a
+/// single call. `cmds` must point to an array of at least `max_cmds`
+/// handles. The commands are written in queue order. The caller takes
+/// ownership of the returned handles and must delete them when it is done
+/// with them. If the queue contains more than `max_cmds` commands, the
+/// remainder stays in the queue.
+///
+/// This function returns the number of handles written, or -1 to indicate
+/// failure.
+#[no_mangle]
+pub extern "C" fn dqcs_cq_take_all(
+    cq: dqcs_handle_t,
+    cmds: *mut dqcs_handle_t,
+    max_cmds: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(cq as &mut ArbCmdQueue);
+        let count = std::cmp::min(cq.len(), max_cmds);
+        if count > 0 && cmds.is_null() {
+            return inv_arg("unexpected NULL buffer");
+        }
+        for (i, cmd) in cq.drain(..count).enumerate() {
+            unsafe { *cmds.add(i) = insert(cmd) };
+        }
+        Ok(count as ssize_t)
+    })
+}
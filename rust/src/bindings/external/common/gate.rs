@@ -78,6 +78,29 @@ pub extern "C" fn dqcs_gate_new_predef(
     })
 }
 
+/// Constructs a new predefined unitary gate using a C array of qubits.
+///
+/// This function is equivalent to `dqcs_gate_new_predef()`, but takes the
+/// qubits from the array of `num_qubits` qubit references pointed to by
+/// `qubits` instead of from a qubit set handle. This saves constructing and
+/// filling a qubit set through the API.
+///
+/// This function returns the handle to the gate, or 0 to indicate failure.
+/// The parameterization data (if specified) is consumed/deleted by this
+/// function if and only if it succeeds.
+#[no_mangle]
+pub extern "C" fn dqcs_gate_new_predef_array(
+    gate_type: dqcs_predefined_gate_t,
+    qubits: *const dqcs_qubit_t,
+    num_qubits: size_t,
+    param_data: dqcs_handle_t,
+) -> dqcs_handle_t {
+    api_return(0, || {
+        let qubit_vec = receive_qubits(qubits, num_qubits)?;
+        new_predef_helper(gate_type, qubit_vec, param_data)
+    })
+}
+
 /// Constructs a new predefined unitary one-qubit gate.
 ///
 /// This function is simply a shorthand for `dqcs_gate_new_predef()` with
@@ -231,6 +254,39 @@ pub extern "C" fn dqcs_gate_new_unitary(
     })
 }
 
+/// Constructs a new unitary gate using C arrays of qubits.
+///
+/// This function is equivalent to `dqcs_gate_new_unitary()`, but takes the
+/// target and control qubits from the arrays of `num_targets` and
+/// `num_controls` qubit references pointed to by `targets` and `controls`
+/// instead of from qubit set handles. `controls` may be `NULL` if
+/// `num_controls` is zero.
+///
+/// Unlike `dqcs_gate_new_unitary()`, `matrix` is a borrowed handle: the gate
+/// receives a copy of it. This allows the same matrix to be used for many
+/// gates.
+///
+/// This function returns the handle to the gate, or 0 to indicate failure.
+#[no_mangle]
+pub extern "C" fn dqcs_gate_new_unitary_array(
+    targets: *const dqcs_qubit_t,
+    num_targets: size_t,
+    controls: *const dqcs_qubit_t,
+    num_controls: size_t,
+    matrix: dqcs_handle_t,
+) -> dqcs_handle_t {
+    api_return(0, || {
+        let target_vec = receive_qubits(targets, num_targets)?;
+        let control_vec = receive_qubits(controls, num_controls)?;
+        resolve!(matrix as &Matrix);
+        Ok(insert(Gate::new_unitary(
+            target_vec,
+            control_vec,
+            matrix.clone(),
+        )?))
+    })
+}
+
 /// Constructs a new measurement gate.
 ///
 /// `measures` must be a handle to a qubit set. `matrix` is an optional matrix
@@ -282,6 +338,34 @@ pub extern "C" fn dqcs_gate_new_measurement(
     })
 }
 
+/// Constructs a new measurement gate using a C array of qubits.
+///
+/// This function is equivalent to `dqcs_gate_new_measurement()`, but takes
+/// the measured qubits from the array of `num_measures` qubit references
+/// pointed to by `measures` instead of from a qubit set handle.
+///
+/// Unlike `dqcs_gate_new_measurement()`, `matrix` is a borrowed handle: the
+/// gate receives a copy of it. If zero, the Z basis is used.
+///
+/// This function returns the handle to the gate, or 0 to indicate failure.
+#[no_mangle]
+pub extern "C" fn dqcs_gate_new_measurement_array(
+    measures: *const dqcs_qubit_t,
+    num_measures: size_t,
+    matrix: dqcs_handle_t,
+) -> dqcs_handle_t {
+    api_return(0, || {
+        let measure_vec = receive_qubits(measures, num_measures)?;
+        let matrix = if matrix == 0 {
+            Matrix::new_identity(2)
+        } else {
+            resolve!(matrix as &Matrix);
+            matrix.clone()
+        };
+        Ok(insert(Gate::new_measurement(measure_vec, matrix)?))
+    })
+}
+
 /// Constructs a new prep gate.
 ///
 /// `targets` must be a handle to a qubit set. `matrix` is an optional matrix
@@ -488,6 +572,22 @@ pub extern "C" fn dqcs_gate_name(gate: dqcs_handle_t) -> *mut c_char {
     })
 }
 
+/// Helper function for the `dqcs_gate_*_array()` functions.
+fn copy_qubits(
+    source: &[QubitRef],
+    qubits: *mut dqcs_qubit_t,
+    max_qubits: size_t,
+) -> Result<ssize_t> {
+    let count = std::cmp::min(source.len(), max_qubits);
+    if count > 0 && qubits.is_null() {
+        return inv_arg("unexpected NULL buffer");
+    }
+    for (i, qubit) in source.iter().take(count).enumerate() {
+        unsafe { *qubits.add(i) = qubit.to_foreign()? };
+    }
+    Ok(source.len() as ssize_t)
+}
+
 /// Returns whether the specified gate has target qubits.
 #[no_mangle]
 pub extern "C" fn dqcs_gate_has_targets(gate: dqcs_handle_t) -> dqcs_bool_return_t {
@@ -509,6 +609,27 @@ pub extern "C" fn dqcs_gate_targets(gate: dqcs_handle_t) -> dqcs_handle_t {
     })
 }
 
+/// Copies the qubits targeted by this gate into a caller-provided array.
+///
+/// Unlike `dqcs_gate_targets()`, this does not construct a qubit set handle,
+/// so this is the cheaper option for performance-sensitive callbacks.
+/// `qubits` must point to an array of at least `max_qubits` qubit
+/// references. The first `max_qubits` qubits are written to it.
+///
+/// This function returns the total number of qubits, which may be larger
+/// than `max_qubits`, or -1 to indicate failure.
+#[no_mangle]
+pub extern "C" fn dqcs_gate_targets_array(
+    gate: dqcs_handle_t,
+    qubits: *mut dqcs_qubit_t,
+    max_qubits: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(gate as &Gate);
+        copy_qubits(gate.get_targets(), qubits, max_qubits)
+    })
+}
+
 /// Returns whether the specified gate has control qubits.
 #[no_mangle]
 pub extern "C" fn dqcs_gate_has_controls(gate: dqcs_handle_t) -> dqcs_bool_return_t {
@@ -530,6 +651,27 @@ pub extern "C" fn dqcs_gate_controls(gate: dqcs_handle_t) -> dqcs_handle_t {
     })
 }
 
+/// Copies the qubits that control this gate into a caller-provided array.
+///
+/// Unlike `dqcs_gate_controls()`, this does not construct a qubit set handle,
+/// so this is the cheaper option for performance-sensitive callbacks.
+/// `qubits` must point to an array of at least `max_qubits` qubit
+/// references. The first `max_qubits` qubits are written to it.
+///
+/// This function returns the total number of qubits, which may be larger
+/// than `max_qubits`, or -1 to indicate failure.
+#[no_mangle]
+pub extern "C" fn dqcs_gate_controls_array(
+    gate: dqcs_handle_t,
+    qubits: *mut dqcs_qubit_t,
+    max_qubits: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(gate as &Gate);
+        copy_qubits(gate.get_controls(), qubits, max_qubits)
+    })
+}
+
 /// Returns whether the specified gate measures any qubits.
 #[no_mangle]
 pub extern "C" fn dqcs_gate_has_measures(gate: dqcs_handle_t) -> dqcs_bool_return_t {
@@ -551,6 +693,27 @@ pub extern "C" fn dqcs_gate_measures(gate: dqcs_handle_t) -> dqcs_handle_t {
     })
 }
 
+/// Copies the qubits measured by this gate into a caller-provided array.
+///
+/// Unlike `dqcs_gate_measures()`, this does not construct a qubit set handle,
+/// so this is the cheaper option for performance-sensitive callbacks.
+/// `qubits` must point to an array of at least `max_qubits` qubit
+/// references. The first `max_qubits` qubits are written to it.
+///
+/// This function returns the total number of qubits, which may be larger
+/// than `max_qubits`, or -1 to indicate failure.
+#[no_mangle]
+pub extern "C" fn dqcs_gate_measures_array(
+    gate: dqcs_handle_t,
+    qubits: *mut dqcs_qubit_t,
+    max_qubits: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(gate as &Gate);
+        copy_qubits(gate.get_measures(), qubits, max_qubits)
+    })
+}
+
 /// Returns whether a unitary matrix is associated with this gate.
 #[no_mangle]
 pub extern "C" fn dqcs_gate_has_matrix(gate: dqcs_handle_t) -> dqcs_bool_return_t {
@@ -577,6 +740,138 @@ pub extern "C" fn dqcs_gate_matrix(gate: dqcs_handle_t) -> dqcs_handle_t {
     })
 }
 
+/// Returns a copy of the unitary matrix associated with this gate with the
+/// control qubits folded in.
+///
+/// The first qubits of the returned matrix correspond to the control qubits
+/// of the gate, in the order returned by `dqcs_gate_controls()`, followed by
+/// the target qubits. This is the matrix that `dqcs_gate_expand_control()`
+/// would produce, but without constructing a new gate. The expansion is
+/// cached for commonly used matrices, so querying the controlled matrix of
+/// for instance a Toffoli gate repeatedly only costs a copy.
+///
+/// If this function succeeds, a new matrix handle is returned. If it fails,
+/// 0 is returned.
+#[no_mangle]
+pub extern "C" fn dqcs_gate_controlled_matrix(gate: dqcs_handle_t) -> dqcs_handle_t {
+    api_return(0, || {
+        resolve!(gate as &Gate);
+        Ok(insert(Matrix::clone(
+            &gate
+                .get_controlled_matrix()
+                .ok_or_else(oe_inv_arg("no matrix associated with gate"))?,
+        )))
+    })
+}
+
+/// Returns whether this gate is known to be a predefined gate.
+///>
+///> Gates constructed using `dqcs_gate_new_predef()` or friends, or by a gate
+///> map for a predefined gate type, remember the predefined gate type they
+///> were constructed from, for as long as this is cheap to track. This allows
+///> plugins to identify such gates without comparing matrices. Note that a
+///> gate for which this returns false may still be equivalent to a predefined
+///> gate; use a gate map to detect those.
+#[no_mangle]
+pub extern "C" fn dqcs_gate_has_predef(gate: dqcs_handle_t) -> dqcs_bool_return_t {
+    api_return_bool(|| {
+        resolve!(gate as &Gate);
+        Ok(gate.get_predefined().is_some())
+    })
+}
+
+/// Returns the predefined gate type this gate was constructed from, if
+/// known.
+///>
+///> Only predefined gate types without parameters and the RX, RY, RZ, and
+///> phase rotations are tracked. The number of control qubits is not part of
+///> the returned type; a CNOT gate will for instance return
+///> `DQCS_GATE_PAULI_X`, with one qubit in its `controls` set. If the type is
+///> not known, `DQCS_GATE_INVALID` is returned.
+#[no_mangle]
+pub extern "C" fn dqcs_gate_predef(gate: dqcs_handle_t) -> dqcs_predefined_gate_t {
+    api_return(dqcs_predefined_gate_t::DQCS_GATE_INVALID, || {
+        resolve!(gate as &Gate);
+        Ok(gate
+            .get_predefined()
+            .ok_or_else(oe_inv_arg("gate is not known to be a predefined gate"))?
+            .into())
+    })
+}
+
+/// Returns a fingerprint of the gate that identifies what kind of gate it is
+/// without comparing matrices.
+///>
+///> The fingerprint packs the following fields into a 64-bit integer, from
+///> least to most significant bit:
+///>
+///>  - bits 0..8: the `dqcs_gate_type_t` of the gate;
+///>  - bits 8..24: the `dqcs_predefined_gate_t` that the matrix of the gate is
+///>    known to be equal to, or 0 if this is not known. For measurement and
+///>    prep gates, this is `DQCS_GATE_PAULI_I` if the basis matrix is exactly
+///>    the identity matrix, i.e. for Z-basis measurements and preps;
+///>  - bits 24..44: the number of control qubits;
+///>  - bits 44..64: the number of measured qubits for measurement gates, or
+///>    the number of target qubits otherwise.
+///>
+///> The qubit counts saturate at 2^20-1. The predefined gate type is only
+///> known under the conditions listed for `dqcs_gate_predef()`, and custom
+///> gates only report their gate type, so the fingerprint is meant to speed up
+///> dispatching on common gates, not to replace a gate map.
+///>
+///> A valid fingerprint is never zero, so 0 is returned to indicate failure.
+#[no_mangle]
+pub extern "C" fn dqcs_gate_fingerprint(gate: dqcs_handle_t) -> u64 {
+    api_return(0, || {
+        resolve!(gate as &Gate);
+        Ok(fingerprint(gate))
+    })
+}
+
+/// Computes the fingerprint returned by `dqcs_gate_fingerprint()`.
+fn fingerprint(gate: &Gate) -> u64 {
+    fn saturate(count: usize) -> u64 {
+        std::cmp::min(count as u64, (1 << 20) - 1)
+    }
+    let typ: dqcs_gate_type_t = gate.get_type().into();
+    let (predefined, operands) = match gate.get_type() {
+        GateType::Unitary => (
+            gate.get_predefined()
+                .map(|predefined| dqcs_predefined_gate_t::from(predefined) as u64)
+                .unwrap_or(0),
+            gate.get_targets().len(),
+        ),
+        GateType::Measurement | GateType::Prep => {
+            let z_basis = gate.get_matrix().map_or(false, |basis| {
+                basis.dimension() == 2
+                    && basis[(0, 0)] == Complex64::new(1.0, 0.0)
+                    && basis[(0, 1)] == Complex64::new(0.0, 0.0)
+                    && basis[(1, 0)] == Complex64::new(0.0, 0.0)
+                    && basis[(1, 1)] == Complex64::new(1.0, 0.0)
+            });
+            (
+                if z_basis {
+                    dqcs_predefined_gate_t::DQCS_GATE_PAULI_I as u64
+                } else {
+                    0
+                },
+                if gate.get_type() == &GateType::Measurement {
+                    gate.get_measures().len()
+                } else {
+                    gate.get_targets().len()
+                },
+            )
+        }
+        GateType::Custom(_) => (0, 0),
+    };
+    let controls = if gate.get_type() == &GateType::Unitary {
+        saturate(gate.get_controls().len())
+    } else {
+        0
+    };
+    (typ as u64) | (predefined << 8) | (controls << 24) | (saturate(operands) << 44)
+}
+
 /// Utility function that detects control qubits in the `targets` list of the
 /// gate by means of the gate matrix, and reduces them into `controls` qubits.
 ///>
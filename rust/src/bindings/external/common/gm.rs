@@ -1,6 +1,6 @@
 use super::*;
 use crate::common::gates::UnitaryGateType;
-use std::convert::TryFrom;
+use std::{cell::RefCell, convert::TryFrom};
 
 /// Converts a qubit count match number to an Option for slightly more
 /// idiomatic rust code outside of this file.
@@ -12,6 +12,15 @@ fn expected_qubit_count(num_qubits: isize) -> Option<usize> {
     }
 }
 
+/// Moves the gate object identified by the given handle into `spare`,
+/// deleting the handle. This is no-op if the handle was already deleted.
+fn recycle_gate(handle: dqcs_handle_t, spare: &RefCell<Option<Gate>>) {
+    if let Ok(mut handle) = resolve(handle) {
+        let gate: Result<Gate> = handle.take();
+        spare.replace(gate.ok());
+    }
+}
+
 /// Constructs a new gate map.
 ///>
 ///> Returns a handle to a gate map with no mappings attached to it yet. Use
@@ -22,7 +31,9 @@ fn expected_qubit_count(num_qubits: isize) -> Option<usize> {
 ///>
 ///> Gate maps objects retain a cache to speed up detection of similar DQCsim
 ///> gates: if a gate is received for the second time, the cache will hit,
-///> avoiding recomputation of the detector functions. What constitutes
+///> avoiding recomputation of the detector functions. The cache holds up to
+///> 1024 gates by default, evicting the least recently used gate when full;
+///> use `dqcs_gm_cache_capacity_set()` to change this. What constitutes
 ///> "similar gates" is defined by the two booleans passed to this function. If
 ///> `strip_qubit_refs` is set, all qubit references associated with the gate
 ///> will be invalidated (i.e., set to 0), such that for instance an X gate
@@ -106,6 +117,61 @@ pub extern "C" fn dqcs_gm_new(
     })
 }
 
+/// Sets the maximum number of gates retained in the detection cache of a
+/// gate map.
+///>
+///> `gm` must be a handle to a gate map object (`dqcs_gm_new()`). When the
+///> cache is full, the least recently used gate is evicted. Setting the
+///> capacity to 0 disables the cache; this is useful when the incoming gates
+///> are rarely repeated, such as when qubit references are not stripped and
+///> the circuit is not regular. If the new capacity is smaller than the
+///> current number of cached gates, the least recently used gates are evicted
+///> immediately.
+#[no_mangle]
+pub extern "C" fn dqcs_gm_cache_capacity_set(gm: dqcs_handle_t, capacity: size_t) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(gm as &mut GateMap);
+        gm.map.set_cache_capacity(capacity);
+        Ok(())
+    })
+}
+
+/// Returns the maximum number of gates retained in the detection cache of a
+/// gate map.
+///>
+///> Returns -1 to indicate failure.
+#[no_mangle]
+pub extern "C" fn dqcs_gm_cache_capacity_get(gm: dqcs_handle_t) -> ssize_t {
+    api_return(-1, || {
+        resolve!(gm as &GateMap);
+        Ok(gm.map.cache_capacity() as ssize_t)
+    })
+}
+
+/// Returns the number of `dqcs_gm_detect()` calls that were served by the
+/// detection cache of a gate map.
+///>
+///> Returns -1 to indicate failure.
+#[no_mangle]
+pub extern "C" fn dqcs_gm_cache_hits(gm: dqcs_handle_t) -> ssize_t {
+    api_return(-1, || {
+        resolve!(gm as &GateMap);
+        Ok(gm.map.cache_hits() as ssize_t)
+    })
+}
+
+/// Returns the number of `dqcs_gm_detect()` calls that were not served by the
+/// detection cache of a gate map.
+///>
+///> Returns -1 to indicate failure.
+#[no_mangle]
+pub extern "C" fn dqcs_gm_cache_misses(gm: dqcs_handle_t) -> ssize_t {
+    api_return(-1, || {
+        resolve!(gm as &GateMap);
+        Ok(gm.map.cache_misses() as ssize_t)
+    })
+}
+
 /// Adds a unitary gate mapping for the given DQCsim-defined gate to the
 /// given gate map.
 ///>
@@ -544,6 +610,11 @@ pub extern "C" fn dqcs_gm_add_prep(
 ///> call `dqcs_error_set()` with the error message and return
 ///> `DQCS_BOOL_FAILURE`.
 ///>
+///> The gate handle passed to the detector remains owned by DQCsim. Where
+///> possible, DQCsim reuses the gate object for the next detector call, so it
+///> does not have to allocate a new one for each call. The detector may still
+///> delete the handle, but this defeats that reuse.
+///>
 ///> The constructor callback performs the reverse operation. It receives an
 ///> `ArbData` handle containing the parameterization data and a qubit set, and
 ///> must construct a gate based on this information. If construction succeeds,
@@ -585,12 +656,25 @@ pub extern "C" fn dqcs_gm_add_custom(
         let constructor_user_data = UserData::new(constructor_user_free, constructor_user_data);
         resolve!(gm as &mut GateMap);
         let key = gm.make_key(key);
+
+        // Most detectors are offered far more gates than they match. The gate
+        // objects passed to the detector are therefore recycled when they
+        // are not consumed, such that offering a gate usually only copies
+        // it into existing buffers, instead of allocating a new copy.
+        let spare: RefCell<Option<Gate>> = RefCell::new(None);
+
         gm.map.push(
             key,
             Box::new(CustomGateConverter::new(
                 move |gate| {
                     if let Some(detector) = detector {
-                        let gate = insert(gate.clone());
+                        let gate = insert(match spare.take() {
+                            Some(mut spare) => {
+                                spare.clone_from(gate);
+                                spare
+                            }
+                            None => gate.clone(),
+                        });
                         let mut qubits: dqcs_handle_t = 0;
                         let mut param_data: dqcs_handle_t = 0;
                         let result = cb_return_bool(detector(
@@ -605,7 +689,7 @@ pub extern "C" fn dqcs_gm_add_custom(
                                 take!(gate as Gate);
                                 gate.data
                             } else {
-                                delete!(gate);
+                                recycle_gate(gate, &spare);
                                 take!(param_data as ArbData);
                                 param_data
                             };
@@ -618,7 +702,7 @@ pub extern "C" fn dqcs_gm_add_custom(
                             Ok(Some((qubits, param_data)))
                         } else {
                             // Detector returned no match or an error.
-                            delete!(gate);
+                            recycle_gate(gate, &spare);
                             if param_data != 0 {
                                 delete!(param_data);
                             }
@@ -6,7 +6,7 @@ pub extern "C" fn dqcs_handle_type(handle: dqcs_handle_t) -> dqcs_handle_type_t
     api_return(dqcs_handle_type_t::DQCS_HTYPE_INVALID, || {
         API_STATE.with(|state| {
             let state = state.borrow();
-            match &state.objects.get(&handle) {
+            match &state.objects.get(handle) {
                 None => inv_arg(format!("handle {} is invalid", handle)),
                 Some(APIObject::ArbData(_)) => Ok(dqcs_handle_type_t::DQCS_HTYPE_ARB_DATA),
                 Some(APIObject::ArbCmd(_)) => Ok(dqcs_handle_type_t::DQCS_HTYPE_ARB_CMD),
@@ -84,7 +84,8 @@ pub extern "C" fn dqcs_handle_delete(handle: dqcs_handle_t) -> dqcs_return_t {
 /// undefined behavior or errors when DQCsim tries to do it for you.
 #[no_mangle]
 pub extern "C" fn dqcs_handle_delete_all() -> dqcs_return_t {
-    API_STATE.with(|state| state.borrow_mut().objects.clear());
+    let objects = API_STATE.with(|state| state.borrow_mut().objects.drain());
+    drop(objects);
     dqcs_return_t::DQCS_SUCCESS
 }
 
@@ -97,10 +98,10 @@ pub extern "C" fn dqcs_handle_delete_all() -> dqcs_return_t {
 pub extern "C" fn dqcs_handle_leak_check() -> dqcs_return_t {
     api_return_none(|| {
         API_STATE.with(|state| {
-            let remain = state.borrow().objects.len();
-            if remain == 0 {
+            if state.borrow().objects.is_empty() {
                 Ok(())
             } else {
+                let remain = state.borrow().objects.len();
                 let mut msg = format!("Leak check: {} handles remain", remain);
                 let state = state.borrow();
                 let sorted: std::collections::BTreeMap<_, _> = state.objects.iter().collect();
@@ -65,3 +65,19 @@ pub extern "C" fn dqcs_log_raw(
         }
     })
 }
+
+/// Returns whether a log message with the given level would be logged.
+///
+/// This allows the message to be composed only when it is actually going to
+/// be used. `dqcs_log_format()` and the logging macros call this function
+/// before formatting the message, so there is usually no need to call it
+/// directly. It returns `DQCS_TRUE` if any of the loggers of the current
+/// thread accepts the given level, `DQCS_FALSE` if none of them do, or
+/// `DQCS_BOOL_FAILURE` if no logger is available in the current thread.
+#[no_mangle]
+pub extern "C" fn dqcs_log_enabled(level: dqcs_loglevel_t) -> dqcs_bool_return_t {
+    api_return_bool(|| {
+        let level = level.into_loglevel()?;
+        crate::common::log::enabled(level).ok_or_else(oe_inv_op("no logger available"))
+    })
+}
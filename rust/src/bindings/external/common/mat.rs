@@ -2,7 +2,7 @@ use super::*;
 use crate::common::gates::UnitaryGateType;
 use std::convert::{TryFrom, TryInto};
 use std::mem::size_of;
-use std::ptr::null_mut;
+use std::ptr::{null, null_mut};
 
 /// Constructs a new gate matrix.
 ///>
@@ -161,6 +161,24 @@ pub extern "C" fn dqcs_mat_get(mat: dqcs_handle_t) -> *mut c_double {
     })
 }
 
+/// Returns a pointer to the data of the given matrix without copying it.
+///>
+///> If this function succeeds, a pointer to the matrix data is returned. The
+///> layout of the data is the same as for `dqcs_mat_get()`: row-major form,
+///> using pairs of doubles for the real vs. imaginary component of each
+///> entry. Unlike `dqcs_mat_get()`, the data is borrowed from the matrix
+///> object: it must not be mutated or freed, and it remains valid only until
+///> the matrix handle is deleted or consumed by another function. Use
+///> `dqcs_mat_len()` or `dqcs_mat_dimension()` to get the size of the
+///> array. On failure, this function returns `NULL`.
+#[no_mangle]
+pub extern "C" fn dqcs_mat_view(mat: dqcs_handle_t) -> *const c_double {
+    api_return(null(), || {
+        resolve!(mat as &Matrix);
+        Ok(mat.as_ptr())
+    })
+}
+
 /// Approximately compares two matrices.
 ///>
 ///> `a` and `b` are borrowed matrix handles.
@@ -289,12 +307,46 @@ pub extern "C" fn dqcs_mat_is_predef(
     })
 }
 
+/// Multiplies two matrices.
+///>
+///> `a` and `b` are borrowed matrix handles of equal dimension. This function
+///> returns a new matrix handle with the matrix product `a * b`, which is the
+///> matrix that applies `b` first and then `a`, or 0 if it fails.
+#[no_mangle]
+pub extern "C" fn dqcs_mat_multiply(a: dqcs_handle_t, b: dqcs_handle_t) -> dqcs_handle_t {
+    api_return(0, || {
+        resolve!(a as &Matrix);
+        resolve!(b as &Matrix);
+        Ok(insert(a.multiply(b)?))
+    })
+}
+
+/// Computes the Kronecker product of two matrices.
+///>
+///> `a` and `b` are borrowed matrix handles. This function returns a new
+///> matrix handle with the Kronecker product of `a` and `b`, or 0 if it
+///> fails. The qubits of `a` become the most significant qubits of the
+///> result, so they precede those of `b` in the target list of a gate
+///> constructed from it.
+#[no_mangle]
+pub extern "C" fn dqcs_mat_kron(a: dqcs_handle_t, b: dqcs_handle_t) -> dqcs_handle_t {
+    api_return(0, || {
+        resolve!(a as &Matrix);
+        resolve!(b as &Matrix);
+        Ok(insert(a.kron(b)))
+    })
+}
+
 /// Constructs a controlled matrix from the given matrix.
 ///>
 ///> `mat` specifies the matrix to use as the non-controlled submatrix. This
 ///> is a borrowed handle. `number_of_controls` specifies the number of control
 ///> qubits to add. This function returns a new matrix handle with the
 ///> constructed matrix, or 0 if it fails.
+///>
+///> With zero controls, this function returns a copy of the matrix. Matrix
+///> data is reference-counted and only copied when either matrix is
+///> modified, so this copy is cheap regardless of the matrix size.
 #[no_mangle]
 pub extern "C" fn dqcs_mat_add_controls(
     mat: dqcs_handle_t,
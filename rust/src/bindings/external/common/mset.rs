@@ -111,3 +111,64 @@ pub extern "C" fn dqcs_mset_take_any(mset: dqcs_handle_t) -> dqcs_handle_t {
         Ok(insert(x))
     })
 }
+
+/// Copies the measurement results in the given set into new measurement
+/// handles, written to a caller-provided array.
+///
+/// `meas` must point to an array of at least `max_meas` handles. Up to
+/// `max_meas` measurement results are copied, in arbitrary order. The set
+/// itself is not modified. The caller takes ownership of the returned
+/// handles and must delete them when it is done with them.
+///
+/// This function returns the number of handles written, or -1 to indicate
+/// failure.
+#[no_mangle]
+pub extern "C" fn dqcs_mset_get_all(
+    mset: dqcs_handle_t,
+    meas: *mut dqcs_handle_t,
+    max_meas: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(mset as &QubitMeasurementResultSet);
+        let count = std::cmp::min(mset.len(), max_meas);
+        if count > 0 && meas.is_null() {
+            return inv_arg("unexpected NULL buffer");
+        }
+        for (i, x) in mset.values().take(count).enumerate() {
+            unsafe { *meas.add(i) = insert(x.clone()) };
+        }
+        Ok(count as ssize_t)
+    })
+}
+
+/// Moves the measurement results in the given set into new measurement
+/// handles, written to a caller-provided array.
+///
+/// This is equivalent to calling `dqcs_mset_take_any()` up to `max_meas`
+/// times, but requires only a single call. `meas` must point to an array of
+/// at least `max_meas` handles. The caller takes ownership of the returned
+/// handles and must delete them when it is done with them. If the set
+/// contains more than `max_meas` results, the remainder stays in the set.
+///
+/// This function returns the number of handles written, or -1 to indicate
+/// failure.
+#[no_mangle]
+pub extern "C" fn dqcs_mset_take_all(
+    mset: dqcs_handle_t,
+    meas: *mut dqcs_handle_t,
+    max_meas: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(mset as &mut QubitMeasurementResultSet);
+        let count = std::cmp::min(mset.len(), max_meas);
+        if count > 0 && meas.is_null() {
+            return inv_arg("unexpected NULL buffer");
+        }
+        let qubits: Vec<QubitRef> = mset.keys().take(count).cloned().collect();
+        for (i, qubit) in qubits.iter().enumerate() {
+            let x = mset.remove(qubit).unwrap();
+            unsafe { *meas.add(i) = insert(x) };
+        }
+        Ok(count as ssize_t)
+    })
+}
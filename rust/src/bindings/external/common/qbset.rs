@@ -70,6 +70,35 @@ pub extern "C" fn dqcs_qbset_len(qbset: dqcs_handle_t) -> ssize_t {
     })
 }
 
+/// Copies the qubits in the given set into a caller-provided array.
+///
+/// `qubits` must point to an array of at least `max_qubits` qubit
+/// references. The first `max_qubits` qubits in the set are written to it,
+/// in insertion order. The set itself is not modified. This is equivalent to
+/// popping the qubits from a copy of the set, but requires only a single
+/// call.
+///
+/// This function returns the number of qubits written, or -1 to indicate
+/// failure.
+#[no_mangle]
+pub extern "C" fn dqcs_qbset_get_all(
+    qbset: dqcs_handle_t,
+    qubits: *mut dqcs_qubit_t,
+    max_qubits: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(qbset as &QubitReferenceSet);
+        let count = std::cmp::min(qbset.len(), max_qubits);
+        if count > 0 && qubits.is_null() {
+            return inv_arg("unexpected NULL buffer");
+        }
+        for (i, qubit) in qbset.iter().take(count).enumerate() {
+            unsafe { *qubits.add(i) = qubit.to_foreign()? };
+        }
+        Ok(count as ssize_t)
+    })
+}
+
 /// Returns a copy of the given qubit set, intended for non-destructive
 /// iteration.
 #[no_mangle]
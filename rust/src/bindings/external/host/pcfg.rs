@@ -343,3 +343,321 @@ pub extern "C" fn dqcs_pcfg_shutdown_timeout_get(pcfg: dqcs_handle_t) -> f64 {
         Ok(pcfg.nonfunctional.shutdown_timeout.to_double())
     })
 }
+
+/// Configures the gatestream connection from this plugin to its downstream
+/// plugin to use a ring buffer in shared memory, instead of a socket-based
+/// IPC channel.
+///
+/// `capacity` specifies the size of the ring buffer in bytes, which must be a
+/// power of two of at least 64 bytes. Typical values lie around one megabyte.
+/// Specifying 0 selects the default socket-based IPC channel.
+///
+/// Shared memory avoids a system call and kernel wakeup for every gatestream
+/// message; the downstream plugin is only woken up through the operating
+/// system when it is actually waiting for messages. This setting has no
+/// effect for backends.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_downstream_shm_set(
+    pcfg: dqcs_handle_t,
+    capacity: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(pcfg as &mut PluginProcessConfiguration);
+        pcfg.nonfunctional.downstream_transport = if capacity == 0 {
+            GatestreamTransport::Ipc
+        } else if capacity < 64 || !capacity.is_power_of_two() {
+            return inv_arg("ring buffer capacity must be a power of two of at least 64 bytes");
+        } else {
+            GatestreamTransport::SharedMemory(capacity)
+        };
+        Ok(())
+    })
+}
+
+/// Returns the ring buffer capacity configured for the gatestream connection
+/// from this plugin to its downstream plugin.
+///
+/// Returns 0 if the connection uses the default socket-based IPC channel, or
+/// -1 when the function fails.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_downstream_shm_get(pcfg: dqcs_handle_t) -> ssize_t {
+    api_return(-1, || {
+        resolve!(pcfg as &PluginProcessConfiguration);
+        Ok(match pcfg.nonfunctional.downstream_transport {
+            GatestreamTransport::Ipc | GatestreamTransport::InProcess => 0,
+            GatestreamTransport::SharedMemory(capacity) => capacity as ssize_t,
+        })
+    })
+}
+
+/// Limits the number of gatestream requests that the plugin may have in
+/// flight to its downstream plugin.
+///
+/// When this limit is reached, the plugin blocks until half of the
+/// outstanding requests have been acknowledged. This bounds the memory used
+/// by requests queued up in the channel when the plugin produces them faster
+/// than its downstream plugin can handle them, while still keeping the
+/// pipeline filled. A value of 0 disables the limit, which is the default.
+/// The time spent waiting is reported through the `throttled` statistic of
+/// `dqcs_sim_stats()`. This setting has no effect for backends.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_downstream_window_set(
+    pcfg: dqcs_handle_t,
+    window: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(pcfg as &mut PluginProcessConfiguration);
+        pcfg.nonfunctional.downstream_window = window;
+        Ok(())
+    })
+}
+
+/// Returns the maximum number of gatestream requests that the plugin may
+/// have in flight to its downstream plugin.
+///
+/// Returns 0 if there is no limit, or -1 when the function fails.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_downstream_window_get(pcfg: dqcs_handle_t) -> ssize_t {
+    api_return(-1, || {
+        resolve!(pcfg as &PluginProcessConfiguration);
+        Ok(pcfg.nonfunctional.downstream_window as ssize_t)
+    })
+}
+
+/// Configures how the plugin waits for incoming gatestream messages.
+///
+/// By default (`DQCS_RECV_BLOCK`), a plugin that has nothing to do blocks in
+/// the operating system until the next message arrives. For tightly-coupled
+/// plugins that exchange many small messages, such as an operator that needs
+/// every measurement result of its backend, the resulting wakeup latency can
+/// dominate. `DQCS_RECV_SPIN` and `DQCS_RECV_YIELD` make the plugin poll for
+/// up to `spin_time` seconds before blocking, either busy-waiting or yielding
+/// to the scheduler between polls. The polling time is adapted to the
+/// traffic: it is halved every time polling times out, and restored when a
+/// message arrives in time. Polling only applies to shared-memory and
+/// in-process gatestream channels. How often each path was taken is reported
+/// through the `spin_hits`, `spin_misses`, and `blocked` statistics of
+/// `dqcs_sim_stats()`. `spin_time` is ignored for `DQCS_RECV_BLOCK`.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_receive_strategy_set(
+    pcfg: dqcs_handle_t,
+    strategy: dqcs_receive_strategy_t,
+    spin_time: f64,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(pcfg as &mut PluginProcessConfiguration);
+        pcfg.nonfunctional.receive_strategy = strategy.with_spin_time(spin_time)?;
+        Ok(())
+    })
+}
+
+/// Returns how the plugin waits for incoming gatestream messages.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_receive_strategy_get(pcfg: dqcs_handle_t) -> dqcs_receive_strategy_t {
+    api_return(dqcs_receive_strategy_t::DQCS_RECV_INVALID, || {
+        resolve!(pcfg as &PluginProcessConfiguration);
+        Ok(pcfg.nonfunctional.receive_strategy.into())
+    })
+}
+
+/// Returns the maximum time in seconds that the plugin polls for incoming
+/// gatestream messages before blocking.
+///
+/// Returns 0 for `DQCS_RECV_BLOCK`, or -1 when the function fails.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_receive_spin_time_get(pcfg: dqcs_handle_t) -> f64 {
+    api_return(-1.0, || {
+        resolve!(pcfg as &PluginProcessConfiguration);
+        Ok(pcfg.nonfunctional.receive_strategy.spin_time().as_nanos() as f64 * 0.000_000_001_f64)
+    })
+}
+
+/// Records the gatestream messages that the plugin sends to its downstream
+/// plugin to the given capture file.
+///
+/// The file is overwritten when the simulation is constructed. It can be
+/// replayed into a backend later using the `dqcsfereplay` frontend, for
+/// instance to benchmark the backend without running the original frontend
+/// again. Relative paths are interpreted relative to the working directory of
+/// the host, not that of the plugin. Passing `NULL` disables recording, which
+/// is the default. This setting has no effect for backends.
+///
+/// For a frontend with a backend fused into it (`dqcs_pdef_fuse()`), the
+/// requests handled by the fused backend are recorded instead, so the
+/// capture can be replayed into a regular backend.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_downstream_capture_set(
+    pcfg: dqcs_handle_t,
+    filename: *const c_char,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(pcfg as &mut PluginProcessConfiguration);
+        pcfg.nonfunctional.downstream_capture =
+            receive_optional_str(filename)?.map(std::path::PathBuf::from);
+        Ok(())
+    })
+}
+
+/// Returns the file that the gatestream messages sent by the plugin to its
+/// downstream plugin are recorded to.
+///
+/// On success, this **returns a newly allocated string containing the
+/// filename. Free it with `free()` when you're done with it to avoid memory
+/// leaks.** On failure, or when recording is disabled, this returns `NULL`.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_downstream_capture_get(pcfg: dqcs_handle_t) -> *mut c_char {
+    api_return_string(|| {
+        resolve!(pcfg as &PluginProcessConfiguration);
+        Ok(pcfg
+            .nonfunctional
+            .downstream_capture
+            .as_ref()
+            .ok_or_else(oe_inv_arg("gatestream capture is disabled for this plugin"))?
+            .to_string_lossy()
+            .to_string())
+    })
+}
+
+/// Configures whether the plugin process should be kept alive for reuse after
+/// the simulation it is part of ends.
+///
+/// When enabled, the plugin is sent a reset request instead of an abort
+/// request when the simulation is dropped. The plugin calls its `drop()`
+/// callback, disconnects from its neighbors, and is then parked in a
+/// process-wide pool. A later simulation with a plugin configuration that has
+/// pooling enabled and the same name, executable, script, environment, working
+/// directory, stream capture modes, CPU affinity, and NUMA policy takes the
+/// process from the pool
+/// instead of spawning a new one. This avoids the process startup and
+/// connection overhead when running many short simulations back to back.
+///
+/// Plugins reused this way must be able to handle their `initialize()`
+/// callback being called again after `drop()`. Use `dqcs_sim_pool_clear()` to
+/// shut down all idle processes in the pool.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_pooled_set(pcfg: dqcs_handle_t, pooled: bool) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(pcfg as &mut PluginProcessConfiguration);
+        pcfg.nonfunctional.pooled = pooled;
+        Ok(())
+    })
+}
+
+/// Returns whether the plugin process is kept alive for reuse after the
+/// simulation it is part of ends.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_pooled_get(pcfg: dqcs_handle_t) -> dqcs_bool_return_t {
+    api_return_bool(|| {
+        resolve!(pcfg as &PluginProcessConfiguration);
+        Ok(pcfg.nonfunctional.pooled)
+    })
+}
+
+/// Restricts the plugin process to the given logical CPUs.
+///
+/// `cpus` points to an array of `num_cpus` CPU indices, as numbered by the
+/// operating system. The affinity is applied to the plugin process before its
+/// executable is loaded, so it also applies to any threads the plugin spawns.
+/// Passing zero CPUs removes the restriction, such that the plugin inherits
+/// the CPU affinity of the simulator; this is the default. Spawning the plugin
+/// fails if the affinity cannot be applied, for instance because none of the
+/// CPUs are available to the simulator. This is currently only supported on
+/// Linux.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_cpu_affinity_set(
+    pcfg: dqcs_handle_t,
+    cpus: *const size_t,
+    num_cpus: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(pcfg as &mut PluginProcessConfiguration);
+        pcfg.nonfunctional.cpu_affinity = receive_indices(cpus, num_cpus)?;
+        Ok(())
+    })
+}
+
+/// Returns the logical CPUs that the plugin process is restricted to.
+///
+/// At most `max_cpus` CPU indices are written to the `cpus` buffer. The
+/// return value is the total number of CPUs, which may be more. 0 means that
+/// the plugin inherits the CPU affinity of the simulator. -1 is returned when
+/// the function fails.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_cpu_affinity_get(
+    pcfg: dqcs_handle_t,
+    cpus: *mut size_t,
+    max_cpus: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(pcfg as &PluginProcessConfiguration);
+        return_indices(&pcfg.nonfunctional.cpu_affinity, cpus, max_cpus)
+    })
+}
+
+/// Configures the NUMA memory placement policy for the plugin process.
+///
+/// `nodes` points to an array of `num_nodes` NUMA node indices, as numbered by
+/// the operating system. `DQCS_NUMA_DEFAULT` takes no nodes,
+/// `DQCS_NUMA_PREFERRED` takes exactly one, and `DQCS_NUMA_BIND` and
+/// `DQCS_NUMA_INTERLEAVE` take one or more. The policy is applied to the
+/// plugin process before its executable is loaded, so it applies to all
+/// memory the plugin allocates. Combine this with
+/// `dqcs_pcfg_cpu_affinity_set()` to keep a backend's state and the CPUs
+/// operating on it on the same socket. Spawning the plugin fails if the policy
+/// cannot be applied. This is currently only supported on Linux.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_numa_policy_set(
+    pcfg: dqcs_handle_t,
+    policy: dqcs_numa_policy_t,
+    nodes: *const size_t,
+    num_nodes: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(pcfg as &mut PluginProcessConfiguration);
+        let nodes = receive_indices(nodes, num_nodes)?;
+        pcfg.nonfunctional.numa_policy = match (policy, nodes.len()) {
+            (dqcs_numa_policy_t::DQCS_NUMA_DEFAULT, 0) => NumaPolicy::Default,
+            (dqcs_numa_policy_t::DQCS_NUMA_PREFERRED, 1) => NumaPolicy::Preferred(nodes[0]),
+            (dqcs_numa_policy_t::DQCS_NUMA_BIND, n) if n > 0 => NumaPolicy::Bind(nodes),
+            (dqcs_numa_policy_t::DQCS_NUMA_INTERLEAVE, n) if n > 0 => NumaPolicy::Interleave(nodes),
+            (dqcs_numa_policy_t::DQCS_NUMA_INVALID, _) => inv_arg("invalid NUMA policy")?,
+            _ => inv_arg("invalid number of NUMA nodes for this policy")?,
+        };
+        Ok(())
+    })
+}
+
+/// Returns the NUMA memory placement policy for the plugin process.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_numa_policy_get(pcfg: dqcs_handle_t) -> dqcs_numa_policy_t {
+    api_return(dqcs_numa_policy_t::DQCS_NUMA_INVALID, || {
+        resolve!(pcfg as &PluginProcessConfiguration);
+        Ok((&pcfg.nonfunctional.numa_policy).into())
+    })
+}
+
+/// Returns the NUMA nodes of the memory placement policy for the plugin
+/// process.
+///
+/// At most `max_nodes` node indices are written to the `nodes` buffer. The
+/// return value is the total number of nodes, which may be more, or -1 when
+/// the function fails.
+#[no_mangle]
+pub extern "C" fn dqcs_pcfg_numa_nodes_get(
+    pcfg: dqcs_handle_t,
+    nodes: *mut size_t,
+    max_nodes: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(pcfg as &PluginProcessConfiguration);
+        match &pcfg.nonfunctional.numa_policy {
+            NumaPolicy::Default => return_indices(&[], nodes, max_nodes),
+            NumaPolicy::Preferred(node) => {
+                return_indices(std::slice::from_ref(node), nodes, max_nodes)
+            }
+            NumaPolicy::Bind(list) | NumaPolicy::Interleave(list) => {
+                return_indices(list, nodes, max_nodes)
+            }
+        }
+    })
+}
@@ -256,6 +256,109 @@ pub extern "C" fn dqcs_scfg_dqcsim_verbosity_get(scfg: dqcs_handle_t) -> dqcs_lo
     })
 }
 
+/// Configures the loglevel at which the performance statistics of the
+/// plugins are logged when the simulation is shut down.
+///
+/// The default is `DQCS_LOG_OFF`, which disables this. The statistics are
+/// logged through DQCsim's own logger, so they are subject to the verbosity
+/// configured with `dqcs_scfg_dqcsim_verbosity_set()` as well.
+#[no_mangle]
+pub extern "C" fn dqcs_scfg_stats_verbosity_set(
+    scfg: dqcs_handle_t,
+    level: dqcs_loglevel_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(scfg as &mut SimulatorConfiguration);
+        scfg.stats_level = level.into_loglevel_filter()?;
+        Ok(())
+    })
+}
+
+/// Returns the loglevel at which plugin statistics are logged at shutdown.
+#[no_mangle]
+pub extern "C" fn dqcs_scfg_stats_verbosity_get(scfg: dqcs_handle_t) -> dqcs_loglevel_t {
+    api_return(dqcs_loglevel_t::DQCS_LOG_INVALID, || {
+        resolve!(scfg as &SimulatorConfiguration);
+        Ok(scfg.stats_level.into())
+    })
+}
+
+/// Enables or disables tracing.
+///
+/// When a filename is specified, the plugins record the time they spend in
+/// their callbacks and waiting for their gatestream requests to be
+/// acknowledged. When the simulation is deleted, the recorded timeline is
+/// written to the given file in the Chrome trace event format, which can be
+/// opened with `chrome://tracing` or the Perfetto UI. Passing `NULL` disables
+/// tracing again, which is the default.
+#[no_mangle]
+pub extern "C" fn dqcs_scfg_trace_file_set(
+    scfg: dqcs_handle_t,
+    filename: *const c_char,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(scfg as &mut SimulatorConfiguration);
+        scfg.trace_file = receive_optional_str(filename)?.map(std::path::PathBuf::from);
+        Ok(())
+    })
+}
+
+/// Returns the file that the trace of the simulation will be written to.
+///
+/// On success, this **returns a newly allocated string containing the
+/// filename. Free it with `free()` when you're done with it to avoid memory
+/// leaks.** On failure, or when tracing is disabled, this returns `NULL`.
+#[no_mangle]
+pub extern "C" fn dqcs_scfg_trace_file_get(scfg: dqcs_handle_t) -> *mut c_char {
+    api_return_string(|| {
+        resolve!(scfg as &SimulatorConfiguration);
+        Ok(scfg
+            .trace_file
+            .as_ref()
+            .ok_or_else(oe_inv_arg("tracing is disabled for this configuration"))?
+            .to_string_lossy()
+            .to_string())
+    })
+}
+
+/// Restricts the log thread of the simulator to the given logical CPUs.
+///
+/// `cpus` points to an array of `num_cpus` CPU indices, as numbered by the
+/// operating system. Pinning the log thread to a CPU that the plugins do not
+/// use keeps log processing from competing with the plugins. Passing zero
+/// CPUs removes the restriction; this is the default. This is currently only
+/// supported on Linux.
+#[no_mangle]
+pub extern "C" fn dqcs_scfg_log_thread_affinity_set(
+    scfg: dqcs_handle_t,
+    cpus: *const size_t,
+    num_cpus: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(scfg as &mut SimulatorConfiguration);
+        scfg.log_thread_affinity = receive_indices(cpus, num_cpus)?;
+        Ok(())
+    })
+}
+
+/// Returns the logical CPUs that the log thread of the simulator is
+/// restricted to.
+///
+/// At most `max_cpus` CPU indices are written to the `cpus` buffer. The
+/// return value is the total number of CPUs, which may be more. 0 means that
+/// the log thread is not restricted. -1 is returned when the function fails.
+#[no_mangle]
+pub extern "C" fn dqcs_scfg_log_thread_affinity_get(
+    scfg: dqcs_handle_t,
+    cpus: *mut size_t,
+    max_cpus: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(scfg as &SimulatorConfiguration);
+        return_indices(&scfg.log_thread_affinity, cpus, max_cpus)
+    })
+}
+
 /// Sets the path style used when writing reproduction files.
 #[no_mangle]
 pub extern "C" fn dqcs_scfg_repro_path_style_set(
@@ -285,6 +388,50 @@ pub extern "C" fn dqcs_scfg_repro_path_style_get(scfg: dqcs_handle_t) -> dqcs_pa
     })
 }
 
+/// Streams the reproduction log to the given file in the binary reproduction
+/// format.
+///
+/// Normally, the host calls are kept in memory until the reproduction file is
+/// written using `dqcs_sim_write_reproduction_file()`. When a stream file is
+/// configured, the host calls are appended to it as they are made instead,
+/// such that memory usage does not grow with the length of the run. The
+/// resulting file can be used with the `--reproduce` and
+/// `--reproduce-exactly` options of the command line interface just like a
+/// regular reproduction file. `dqcs_sim_write_reproduction_file()` cannot be
+/// used when streaming. Passing `NULL` disables streaming again, which is the
+/// default.
+#[no_mangle]
+pub extern "C" fn dqcs_scfg_repro_stream_set(
+    scfg: dqcs_handle_t,
+    filename: *const c_char,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(scfg as &mut SimulatorConfiguration);
+        scfg.reproduction_stream = receive_optional_str(filename)?.map(std::path::PathBuf::from);
+        Ok(())
+    })
+}
+
+/// Returns the file that the reproduction log will be streamed to.
+///
+/// On success, this **returns a newly allocated string containing the
+/// filename. Free it with `free()` when you're done with it to avoid memory
+/// leaks.** On failure, or when streaming is disabled, this returns `NULL`.
+#[no_mangle]
+pub extern "C" fn dqcs_scfg_repro_stream_get(scfg: dqcs_handle_t) -> *mut c_char {
+    api_return_string(|| {
+        resolve!(scfg as &SimulatorConfiguration);
+        Ok(scfg
+            .reproduction_stream
+            .as_ref()
+            .ok_or_else(oe_inv_arg(
+                "reproduction streaming is disabled for this configuration",
+            ))?
+            .to_string_lossy()
+            .to_string())
+    })
+}
+
 /// Disables the reproduction logging system.
 ///
 /// Calling this will disable the warnings printed when a simulation that
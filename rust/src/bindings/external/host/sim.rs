@@ -1,5 +1,6 @@
 use super::*;
-use crate::host::accelerator::Accelerator;
+use crate::host::{accelerator::Accelerator, plugin::pool, simulation_pool::SimulationPool};
+use std::sync::Arc;
 
 /// Constructs a DQCsim simulation.
 ///
@@ -59,6 +60,208 @@ pub extern "C" fn dqcs_sim_wait(sim: dqcs_handle_t) -> dqcs_handle_t {
     })
 }
 
+/// Runs a program on the simulated accelerator multiple times.
+///
+/// This is equivalent to calling `dqcs_sim_start()` followed by
+/// `dqcs_sim_wait()` `num_shots` times, reusing the same plugin processes for
+/// every shot. It is up to the frontend to make sure that every run starts
+/// from a clean state.
+///
+/// The `ArbData` handle is optional; if 0 is passed, an empty data object is
+/// used. The handle is borrowed; the same argument is passed to every run.
+///
+/// `results` must point to a buffer that can hold `num_shots` handles. When
+/// this function succeeds, it is filled with handles to the return values of
+/// each run, in order. When the function fails, nothing is written to the
+/// buffer.
+#[no_mangle]
+pub extern "C" fn dqcs_sim_run_shots(
+    sim: dqcs_handle_t,
+    data: dqcs_handle_t,
+    num_shots: size_t,
+    results: *mut dqcs_handle_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        if results.is_null() && num_shots > 0 {
+            inv_arg("unexpected NULL buffer")?;
+        }
+        resolve!(sim as &mut Simulator);
+        resolve!(optional data as &ArbData);
+        let data = data.cloned().unwrap_or_default();
+        let shots = sim.simulation.run_shots(data, num_shots)?;
+        let results = unsafe { std::slice::from_raw_parts_mut(results, num_shots) };
+        for (result, shot) in results.iter_mut().zip(shots) {
+            *result = insert(shot);
+        }
+        if let Some(sim) = sim.as_mut() {
+            let sim: &mut Simulator = sim.as_mut()?;
+            sim.simulation.add_outcomes(outcomes);
+        }
+        Ok(())
+    })
+}
+
+/// User data wrapper for the `dqcs_sim_run_shots_parallel()` and
+/// `dqcs_sim_run_pool()` callbacks, which is shared by the worker threads.
+struct SharedUserData(UserData);
+
+// The user is responsible for making the factory callback thread-safe.
+unsafe impl Sync for SharedUserData {}
+
+/// Runs a program multiple times on a number of simulations in parallel.
+///
+/// Each of the `num_threads` worker threads constructs its own simulation and
+/// runs its share of the `num_shots` shots back-to-back, as if by
+/// `dqcs_sim_run_shots()`. The shots are divided into contiguous chunks, one
+/// for each worker.
+///
+/// The simulation configurations are constructed by the `factory` callback.
+/// It is called once from within every worker thread, so it must be
+/// thread-safe. It receives `user_data` and the index of the worker, and must
+/// return a handle to a new simulation configuration (`dqcs_scfg_new()`), or
+/// call `dqcs_error_set()` and return 0 to report an error. Note that handles
+/// are thread-local, so the factory must construct the configuration from
+/// scratch. The seed of the configuration is overridden with a seed derived
+/// from `seed`, such that the results only depend on `seed`, `num_shots`,
+/// and `num_threads`. `user_free` is an optional callback used to free
+/// `user_data` when all workers are done.
+///
+/// The `ArbData` handle is optional; if 0 is passed, an empty data object is
+/// used. The handle is borrowed; the same argument is passed to every run.
+///
+/// `results` must point to a buffer that can hold `num_shots` handles. When
+/// this function succeeds, it is filled with handles to the return values of
+/// each run, in order. When the function fails, nothing is written to the
+/// buffer.
+///
+/// The outcomes recorded by the worker simulations are combined and added to
+/// the histogram of the simulation referred to by `sim`, such that
+/// `dqcs_sim_outcomes()` reports the same totals as it would after running
+/// all shots using `dqcs_sim_run_shots()`. This handle is optional; if 0 is
+/// passed, the outcomes are discarded. The simulation itself is not used to
+/// run any shots.
+#[no_mangle]
+pub extern "C" fn dqcs_sim_run_shots_parallel(
+    factory: Option<extern "C" fn(user_data: *const c_void, worker: size_t) -> dqcs_handle_t>,
+    user_free: Option<extern "C" fn(user_data: *mut c_void)>,
+    user_data: *mut c_void,
+    seed: u64,
+    data: dqcs_handle_t,
+    num_shots: size_t,
+    num_threads: size_t,
+    results: *mut dqcs_handle_t,
+    sim: dqcs_handle_t,
+) -> dqcs_return_t {
+    let user_data = SharedUserData(UserData::new(user_free, user_data));
+    api_return_none(|| {
+        let factory = factory.ok_or_else(oe_inv_arg("the factory callback is required"))?;
+        if results.is_null() && num_shots > 0 {
+            inv_arg("unexpected NULL buffer")?;
+        }
+        resolve!(optional data as &ArbData);
+        let data = data.cloned().unwrap_or_default();
+        let mut sim = if sim == 0 { None } else { Some(resolve(sim)?) };
+        if let Some(sim) = sim.as_mut() {
+            let _: &mut Simulator = sim.as_mut()?;
+        }
+        let (shots, outcomes) = Simulator::run_shots_parallel(
+            move |worker| {
+                let scfg = cb_return(0, factory(user_data.0.data(), worker))?;
+                take!(scfg as SimulatorConfiguration);
+                Ok(scfg)
+            },
+            seed,
+            data,
+            num_shots,
+            num_threads,
+        )?;
+        let results = unsafe { std::slice::from_raw_parts_mut(results, num_shots) };
+        for (result, shot) in results.iter_mut().zip(shots) {
+            *result = insert(shot);
+        }
+        Ok(())
+    })
+}
+
+/// Runs a program once on each of a number of independent simulations,
+/// using a pool of worker threads, and reports the results as they complete.
+///
+/// This is intended for parameter sweeps and the like. Whenever a worker
+/// thread is idle, it takes the next job, constructs its simulation, runs
+/// the program once as if by `dqcs_sim_start()` followed by
+/// `dqcs_sim_wait()`, and destroys the simulation again. Jobs are started in
+/// order of their index, but may complete in any order.
+///
+/// The simulation configurations are constructed by the `factory` callback.
+/// It is called from within the worker threads, so it must be thread-safe.
+/// It receives `user_data` and the index of the job, and must return a
+/// handle to a new simulation configuration (`dqcs_scfg_new()`), or call
+/// `dqcs_error_set()` and return 0 to report an error. Note that handles are
+/// thread-local, so the factory must construct the configuration from
+/// scratch. Unlike `dqcs_sim_run_shots_parallel()`, the seeds of the
+/// configurations are not overridden.
+///
+/// The `result` callback is called from the calling thread whenever a job
+/// completes. It receives `user_data`, the index of the job, and a handle to
+/// the `ArbData` returned by the frontend's `run()` callback, which it takes
+/// ownership of. If the job failed, the handle is 0 and the error message
+/// can be retrieved using `dqcs_error_get()`. If the callback returns
+/// failure, no further jobs are started, the remaining results are
+/// discarded, and this function fails with the error set by the callback.
+/// `user_free` is an optional callback used to free `user_data` when this
+/// function returns.
+///
+/// `num_threads` specifies the number of worker threads, or 0 to use one
+/// for each logical CPU. `max_processes` limits the number of plugin
+/// processes that may be running at the same time, or 0 for no limit. A
+/// worker waits before constructing a simulation until one slot is
+/// available for each plugin process configuration in it.
+///
+/// The `ArbData` handle is optional; if 0 is passed, an empty data object is
+/// used. The handle is borrowed; the same argument is passed to every run.
+#[no_mangle]
+pub extern "C" fn dqcs_sim_run_pool(
+    factory: Option<extern "C" fn(user_data: *const c_void, job: size_t) -> dqcs_handle_t>,
+    result: Option<
+        extern "C" fn(
+            user_data: *const c_void,
+            job: size_t,
+            result: dqcs_handle_t,
+        ) -> dqcs_return_t,
+    >,
+    user_free: Option<extern "C" fn(user_data: *mut c_void)>,
+    user_data: *mut c_void,
+    data: dqcs_handle_t,
+    num_jobs: size_t,
+    num_threads: size_t,
+    max_processes: size_t,
+) -> dqcs_return_t {
+    let user_data = Arc::new(SharedUserData(UserData::new(user_free, user_data)));
+    api_return_none(|| {
+        let factory = factory.ok_or_else(oe_inv_arg("the factory callback is required"))?;
+        let result = result.ok_or_else(oe_inv_arg("the result callback is required"))?;
+        resolve!(optional data as &ArbData);
+        let data = data.cloned().unwrap_or_default();
+        let factory_user_data = Arc::clone(&user_data);
+        SimulationPool::default()
+            .with_threads(num_threads)
+            .with_max_processes(max_processes)
+            .run(
+                move |job| {
+                    let scfg = cb_return(0, factory(factory_user_data.0.data(), job))?;
+                    take!(scfg as SimulatorConfiguration);
+                    Ok(scfg)
+                },
+                data,
+                num_jobs,
+                |job, outcome| {
+                    let handle = api_return(0, || Ok(insert(outcome?)));
+                    cb_return_none(result(user_data.0.data(), job, handle))
+                },
+            )
+    })
+}
+
 /// Sends a message to the simulated accelerator.
 ///
 /// This is an asynchronous call: nothing happens until `yield()`,
@@ -96,6 +299,60 @@ pub extern "C" fn dqcs_sim_recv(sim: dqcs_handle_t) -> dqcs_handle_t {
     })
 }
 
+/// Reads the histogram of the measurement outcomes recorded by the frontend.
+///
+/// The frontend records outcomes using `dqcs_plugin_record_outcome()` or
+/// `dqcs_plugin_record_measurements()`. The simulation counts them over all
+/// runs, until the histogram is cleared using `dqcs_sim_outcomes_clear()`.
+/// Outcomes are received along with the responses of the frontend, so this
+/// includes everything recorded up to the last time the frontend blocked,
+/// for instance at the end of `dqcs_sim_wait()` or `dqcs_sim_run_shots()`.
+/// `dqcs_sim_run_shots_parallel()` can add the outcomes of its worker
+/// simulations to this histogram as well.
+///
+/// The distinct outcomes are written to the array pointed to by `outcomes`
+/// in ascending order, and the number of times each was recorded to the
+/// array pointed to by `counts`. Both arrays must be able to hold
+/// `max_entries` entries; only the first `max_entries` entries are written.
+/// Pass 0 for `max_entries` to only query the number of entries.
+///
+/// This function returns the total number of distinct outcomes, which may
+/// be larger than `max_entries`, or -1 to indicate failure.
+#[no_mangle]
+pub extern "C" fn dqcs_sim_outcomes(
+    sim: dqcs_handle_t,
+    outcomes: *mut u64,
+    counts: *mut u64,
+    max_entries: size_t,
+) -> ssize_t {
+    api_return(-1, || {
+        resolve!(sim as &mut Simulator);
+        let histogram = sim.simulation.get_outcomes()?;
+        let entries = histogram.entries();
+        let count = std::cmp::min(entries.len(), max_entries);
+        if count > 0 && (outcomes.is_null() || counts.is_null()) {
+            return inv_arg("unexpected NULL buffer");
+        }
+        for (i, (outcome, num)) in entries.iter().take(count).enumerate() {
+            unsafe {
+                *outcomes.add(i) = *outcome;
+                *counts.add(i) = *num;
+            }
+        }
+        Ok(entries.len() as ssize_t)
+    })
+}
+
+/// Clears the histogram of the measurement outcomes recorded by the frontend.
+#[no_mangle]
+pub extern "C" fn dqcs_sim_outcomes_clear(sim: dqcs_handle_t) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(sim as &mut Simulator);
+        sim.simulation.take_outcomes()?;
+        Ok(())
+    })
+}
+
 /// Yields to the simulator.
 ///
 /// The simulation runs until it blocks again. This is useful if you want an
@@ -114,6 +371,58 @@ pub extern "C" fn dqcs_sim_yield(sim: dqcs_handle_t) -> dqcs_return_t {
     })
 }
 
+/// Yields to the simulator without waiting for it to block again.
+///
+/// This is the non-blocking counterpart of `dqcs_sim_yield()`, allowing a
+/// single thread to drive multiple simulations. After calling this, use
+/// `dqcs_sim_yield_poll()` to check whether the simulation has blocked
+/// again, and `dqcs_sim_wait_ready()` and `dqcs_sim_recv_ready()` to check
+/// whether `dqcs_sim_wait()` and `dqcs_sim_recv()` would return immediately.
+///
+/// This function does nothing if a previous asynchronous yield has not
+/// completed yet. All other simulation functions that interact with the
+/// plugins block until it has.
+#[no_mangle]
+pub extern "C" fn dqcs_sim_yield_async(sim: dqcs_handle_t) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(sim as &mut Simulator);
+        sim.simulation.yield_async()?;
+        Ok(())
+    })
+}
+
+/// Checks whether the yield started using `dqcs_sim_yield_async()` has
+/// completed, without blocking.
+///
+/// Returns true if it has, or if no asynchronous yield was pending.
+#[no_mangle]
+pub extern "C" fn dqcs_sim_yield_poll(sim: dqcs_handle_t) -> dqcs_bool_return_t {
+    api_return_bool(|| {
+        resolve!(sim as &mut Simulator);
+        sim.simulation.poll_yield()
+    })
+}
+
+/// Returns whether `dqcs_sim_wait()` would return immediately, because the
+/// accelerator's `run()` function has returned.
+#[no_mangle]
+pub extern "C" fn dqcs_sim_wait_ready(sim: dqcs_handle_t) -> dqcs_bool_return_t {
+    api_return_bool(|| {
+        resolve!(sim as &Simulator);
+        Ok(sim.simulation.is_wait_ready())
+    })
+}
+
+/// Returns whether `dqcs_sim_recv()` would return immediately, because the
+/// accelerator has sent a message that has not been received yet.
+#[no_mangle]
+pub extern "C" fn dqcs_sim_recv_ready(sim: dqcs_handle_t) -> dqcs_bool_return_t {
+    api_return_bool(|| {
+        resolve!(sim as &Simulator);
+        Ok(sim.simulation.is_recv_ready())
+    })
+}
+
 /// Sends an `ArbCmd` message to one of the plugins, referenced by name.
 ///
 /// `ArbCmd`s are executed immediately after yielding to the simulator, so
@@ -276,6 +585,61 @@ pub extern "C" fn dqcs_sim_get_version_idx(sim: dqcs_handle_t, index: ssize_t) -
     })
 }
 
+/// Queries the performance statistics collected by the plugins.
+///
+/// The statistics are returned as a new `ArbData` handle. Its JSON object
+/// maps the instance name of each plugin to an object with the following
+/// entries:
+///
+///  - `gates_sent`, `gates_received`: the number of gates the plugin sent
+///    downstream and received from upstream;
+///  - `messages_sent`, `messages_received`: the number of messages the
+///    plugin exchanged with the simulator and the neighboring plugins;
+///  - `bytes_sent`, `bytes_received`: the number of gatestream payload
+///    bytes the plugin exchanged through shared-memory channels (socket-based
+///    channels are not counted);
+///  - `send`, `recv`: histograms of the time spent sending messages and
+///    waiting for incoming messages;
+///  - `spin_hits`, `spin_misses`: the number of times a message did or did
+///    not arrive while polling for it, as configured using
+///    `dqcs_pcfg_receive_strategy_set()` or
+///    `dqcs_tcfg_receive_strategy_set()`;
+///  - `blocked`: the number of times the plugin blocked in the operating
+///    system to wait for a message;
+///  - `sync_blocked`: histogram of the time spent blocking on the downstream
+///    plugin to acknowledge requests;
+///  - `throttled`: histogram of the part of that time spent waiting for room
+///    in the in-flight window configured using
+///    `dqcs_pcfg_downstream_window_set()` or
+///    `dqcs_tcfg_downstream_window_set()`;
+///  - `gate_callback`, `advance_callback`, `modify_measurement_callback`:
+///    histograms of the time spent in these user callbacks.
+///
+/// Each histogram is an object with `count`, `total_ns`, and `max_ns`
+/// entries, and a `buckets` array, of which entry i counts the samples that
+/// took at least 2^(i-1) and less than 2^i nanoseconds.
+///
+/// Should multiple plugins share an instance name, all but the first are
+/// keyed by their name followed by `#` and their index in the pipeline, with
+/// the frontend at index 0.
+///
+/// Asynchronous requests that have not been executed yet are not included.
+/// Call `dqcs_sim_yield()` first if you need those as well.
+#[no_mangle]
+pub extern "C" fn dqcs_sim_stats(sim: dqcs_handle_t) -> dqcs_handle_t {
+    api_return(0, || {
+        resolve!(sim as &mut Simulator);
+        let mut stats = serde_json::Map::new();
+        for (name, plugin_stats) in sim.simulation.get_stats()? {
+            stats.insert(name, serde_json::to_value(plugin_stats)?);
+        }
+        Ok(insert(ArbData::from_json(
+            serde_json::Value::Object(stats).to_string(),
+            vec![],
+        )?))
+    })
+}
+
 /// Writes a reproduction file for the simulation so far.
 #[no_mangle]
 pub extern "C" fn dqcs_sim_write_reproduction_file(
@@ -288,3 +652,19 @@ pub extern "C" fn dqcs_sim_write_reproduction_file(
             .write_reproduction_file(receive_str(filename)?)
     })
 }
+
+/// Shuts down all idle plugin processes kept alive for reuse.
+///
+/// Plugin processes configured with `dqcs_pcfg_pooled_set()` are parked in a
+/// process-wide pool when their simulation is dropped. They exit by
+/// themselves when the host process terminates, but this function can be used
+/// to shut them down earlier, for instance after changing the plugin
+/// executable. Processes that are part of a running simulation are not
+/// affected.
+///
+/// Returns the number of processes that were shut down, or -1 when the
+/// function fails.
+#[no_mangle]
+pub extern "C" fn dqcs_sim_pool_clear() -> ssize_t {
+    api_return(-1, || Ok(pool::clear() as ssize_t))
+}
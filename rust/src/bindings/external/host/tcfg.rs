@@ -130,3 +130,128 @@ pub extern "C" fn dqcs_tcfg_tee(
         Ok(())
     })
 }
+
+/// Limits the number of gatestream requests that the plugin thread may have
+/// in flight to its downstream plugin.
+///
+/// When this limit is reached, the plugin blocks until half of the
+/// outstanding requests have been acknowledged. This bounds the memory used
+/// by requests queued up in the channel when the plugin produces them faster
+/// than its downstream plugin can handle them, while still keeping the
+/// pipeline filled. A value of 0 disables the limit, which is the default.
+/// The time spent waiting is reported through the `throttled` statistic of
+/// `dqcs_sim_stats()`. This setting has no effect for backends.
+#[no_mangle]
+pub extern "C" fn dqcs_tcfg_downstream_window_set(
+    tcfg: dqcs_handle_t,
+    window: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(tcfg as &mut PluginThreadConfiguration);
+        tcfg.downstream_window = window;
+        Ok(())
+    })
+}
+
+/// Returns the maximum number of gatestream requests that the plugin thread
+/// may have in flight to its downstream plugin.
+///
+/// Returns 0 if there is no limit, or -1 when the function fails.
+#[no_mangle]
+pub extern "C" fn dqcs_tcfg_downstream_window_get(tcfg: dqcs_handle_t) -> ssize_t {
+    api_return(-1, || {
+        resolve!(tcfg as &PluginThreadConfiguration);
+        Ok(tcfg.downstream_window as ssize_t)
+    })
+}
+
+/// Configures how the plugin thread waits for incoming gatestream messages.
+///
+/// By default (`DQCS_RECV_BLOCK`), a plugin that has nothing to do blocks in
+/// the operating system until the next message arrives. For tightly-coupled
+/// plugins that exchange many small messages, such as an operator that needs
+/// every measurement result of its backend, the resulting wakeup latency can
+/// dominate. `DQCS_RECV_SPIN` and `DQCS_RECV_YIELD` make the plugin poll for
+/// up to `spin_time` seconds before blocking, either busy-waiting or yielding
+/// to the scheduler between polls. The polling time is adapted to the
+/// traffic: it is halved every time polling times out, and restored when a
+/// message arrives in time. Polling only applies to shared-memory and
+/// in-process gatestream channels. How often each path was taken is reported
+/// through the `spin_hits`, `spin_misses`, and `blocked` statistics of
+/// `dqcs_sim_stats()`. `spin_time` is ignored for `DQCS_RECV_BLOCK`.
+#[no_mangle]
+pub extern "C" fn dqcs_tcfg_receive_strategy_set(
+    tcfg: dqcs_handle_t,
+    strategy: dqcs_receive_strategy_t,
+    spin_time: f64,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(tcfg as &mut PluginThreadConfiguration);
+        tcfg.receive_strategy = strategy.with_spin_time(spin_time)?;
+        Ok(())
+    })
+}
+
+/// Returns how the plugin thread waits for incoming gatestream messages.
+#[no_mangle]
+pub extern "C" fn dqcs_tcfg_receive_strategy_get(tcfg: dqcs_handle_t) -> dqcs_receive_strategy_t {
+    api_return(dqcs_receive_strategy_t::DQCS_RECV_INVALID, || {
+        resolve!(tcfg as &PluginThreadConfiguration);
+        Ok(tcfg.receive_strategy.into())
+    })
+}
+
+/// Returns the maximum time in seconds that the plugin polls for incoming
+/// gatestream messages before blocking.
+///
+/// Returns 0 for `DQCS_RECV_BLOCK`, or -1 when the function fails.
+#[no_mangle]
+pub extern "C" fn dqcs_tcfg_receive_spin_time_get(tcfg: dqcs_handle_t) -> f64 {
+    api_return(-1.0, || {
+        resolve!(tcfg as &PluginThreadConfiguration);
+        Ok(tcfg.receive_strategy.spin_time().as_nanos() as f64 * 0.000_000_001_f64)
+    })
+}
+
+/// Records the gatestream messages that the plugin thread sends to its
+/// downstream plugin to the given capture file.
+///
+/// The file is overwritten when the simulation is constructed. It can be
+/// replayed into a backend later using the `dqcsfereplay` frontend, for
+/// instance to benchmark the backend without running the original frontend
+/// again. Passing `NULL` disables recording, which is the default. This
+/// setting has no effect for backends.
+///
+/// For a frontend with a backend fused into it (`dqcs_pdef_fuse()`), the
+/// requests handled by the fused backend are recorded instead, so the
+/// capture can be replayed into a regular backend.
+#[no_mangle]
+pub extern "C" fn dqcs_tcfg_downstream_capture_set(
+    tcfg: dqcs_handle_t,
+    filename: *const c_char,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        resolve!(tcfg as &mut PluginThreadConfiguration);
+        tcfg.downstream_capture = receive_optional_str(filename)?.map(std::path::PathBuf::from);
+        Ok(())
+    })
+}
+
+/// Returns the file that the gatestream messages sent by the plugin thread to
+/// its downstream plugin are recorded to.
+///
+/// On success, this **returns a newly allocated string containing the
+/// filename. Free it with `free()` when you're done with it to avoid memory
+/// leaks.** On failure, or when recording is disabled, this returns `NULL`.
+#[no_mangle]
+pub extern "C" fn dqcs_tcfg_downstream_capture_get(tcfg: dqcs_handle_t) -> *mut c_char {
+    api_return_string(|| {
+        resolve!(tcfg as &PluginThreadConfiguration);
+        Ok(tcfg
+            .downstream_capture
+            .as_ref()
+            .ok_or_else(oe_inv_arg("gatestream capture is disabled for this plugin"))?
+            .to_string_lossy()
+            .to_string())
+    })
+}
@@ -445,7 +445,8 @@ pub extern "C" fn dqcs_pdef_set_gate_cb(
 /// function's `measured` list.
 ///
 /// The default behavior for this callback is to return the measurement
-/// without modification.
+/// without modification. Setting this callback replaces any callback set
+/// using `dqcs_pdef_set_modify_measurements_cb()`.
 #[no_mangle]
 pub extern "C" fn dqcs_pdef_set_modify_measurement_cb(
     pdef: dqcs_handle_t,
@@ -480,6 +481,96 @@ pub extern "C" fn dqcs_pdef_set_modify_measurement_cb(
                 result
             },
         );
+        pdef.modify_measurements = None;
+        Ok(())
+    })
+}
+
+/// Sets the batched measurement modification callback for operators.
+///
+/// This callback serves the same purpose as the one set using
+/// `dqcs_pdef_set_modify_measurement_cb()`, but is called once for all the
+/// measurement results received from the downstream plugin at the same
+/// time, instead of once for each of them. This considerably reduces the
+/// overhead when many qubits are measured at once, for instance for
+/// syndrome extraction.
+///
+/// The callback takes a handle to a measurement set containing the received
+/// measurements as an argument, and must return one of the following
+/// things:
+///
+///  - a valid handle to a measurement set, which may or may not be the
+///    supplied one (this object is automatically deleted after the callback
+///    returns); or
+///  - 0 to report an error, after calling the error string using
+///    `dqcs_set_error()`.
+///
+/// Because a measurement set can only contain a single measurement for each
+/// qubit, the callback is called multiple times when the same qubit was
+/// measured more than once. The returned measurements are sent upstream in
+/// the order of the supplied measurements for the same qubits; any
+/// additional measurements are sent after those.
+///
+/// The same restrictions as for `dqcs_pdef_set_modify_measurement_cb()`
+/// apply with respect to the plugin commands that may be called. Setting
+/// this callback replaces any callback set using
+/// `dqcs_pdef_set_modify_measurement_cb()`.
+#[no_mangle]
+pub extern "C" fn dqcs_pdef_set_modify_measurements_cb(
+    pdef: dqcs_handle_t,
+    callback: Option<
+        extern "C" fn(
+            user_data: *mut c_void,
+            state: dqcs_plugin_state_t,
+            mset: dqcs_handle_t,
+        ) -> dqcs_handle_t,
+    >,
+    user_free: Option<extern "C" fn(user_data: *mut c_void)>,
+    user_data: *mut c_void,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        let data = UserData::new(user_free, user_data);
+        let callback = callback.ok_or_else(oe_inv_arg("callback cannot be null"))?;
+        resolve!(pdef as &mut PluginDefinition);
+        if pdef.get_type() != PluginType::Operator {
+            return inv_op("the modify_measurements() callback is only supported for operators");
+        }
+        pdef.modify_measurements = Some(Box::new(
+            move |state: &mut PluginState,
+                  measurements: Vec<QubitMeasurementResult>|
+                  -> Result<Vec<QubitMeasurementResult>> {
+                let mut modified = Vec::with_capacity(measurements.len());
+                let mut measurements = measurements.into_iter().peekable();
+                while measurements.peek().is_some() {
+                    // Take the measurements up to the first qubit that is
+                    // measured a second time, remembering their order.
+                    let mut order = HashMap::new();
+                    let mut mset = QubitMeasurementResultSet::new();
+                    while let Some(measurement) = measurements.peek() {
+                        if order.contains_key(&measurement.qubit) {
+                            break;
+                        }
+                        let measurement = measurements.next().unwrap();
+                        order.insert(measurement.qubit, order.len());
+                        mset.insert(measurement.qubit, measurement);
+                    }
+
+                    let mset_handle = insert(mset);
+                    let result = cb_return(0, callback(data.data(), state.into(), mset_handle))
+                        .and_then(|result| {
+                            take!(result as QubitMeasurementResultSet);
+                            let mut result: Vec<_> = result.into_iter().map(|(_, m)| m).collect();
+                            result.sort_by_key(|m| {
+                                order.get(&m.qubit).cloned().unwrap_or_else(|| order.len())
+                            });
+                            Ok(result)
+                        });
+                    delete!(mset_handle);
+                    modified.extend(result?);
+                }
+                Ok(modified)
+            },
+        ));
         Ok(())
     })
 }
@@ -619,3 +710,41 @@ pub extern "C" fn dqcs_pdef_set_host_arb_cb(
         Ok(())
     })
 }
+
+/// Fuses a backend plugin definition into a frontend plugin definition.
+///
+/// The gatestream requests of a fused frontend are not sent to its
+/// downstream plugin. Instead, they are handled by calling the callbacks of
+/// the fused backend directly, from within the frontend's thread. This
+/// removes all channel and thread switching overhead, which is useful to get
+/// a baseline for the performance of the plugins themselves.
+///
+/// `frontend` must be a frontend plugin definition that does not have a
+/// backend fused into it yet, and `backend` must be a backend plugin
+/// definition. The backend definition handle is consumed by this function if
+/// and only if it is successful.
+///
+/// The simulation still needs a backend plugin downstream of the frontend.
+/// On success, this returns a handle to a new backend plugin definition with
+/// the metadata of the fused backend, which must be used in its place. This
+/// stand-in never receives any gatestream requests. `ArbCmd`s sent to it by
+/// the host are rejected, since they cannot be delivered to the fused
+/// backend. The `initialize` callback of the fused backend is called by the
+/// frontend without any initialization commands. On failure, this returns 0.
+#[no_mangle]
+pub extern "C" fn dqcs_pdef_fuse(frontend: dqcs_handle_t, backend: dqcs_handle_t) -> dqcs_handle_t {
+    api_return(0, || {
+        resolve!(frontend as &mut PluginDefinition);
+        resolve!(backend as pending PluginDefinition);
+        let backend_ob: &PluginDefinition = backend.as_ref()?;
+        if frontend.get_type() != PluginType::Frontend {
+            inv_arg("only frontends can have a backend fused into them")?;
+        } else if frontend.get_fused_backend().is_some() {
+            inv_arg("this frontend already has a backend fused into it")?;
+        } else if backend_ob.get_type() != PluginType::Backend {
+            inv_arg("only backends can be fused into a frontend")?;
+        }
+        take!(resolved backend as PluginDefinition);
+        Ok(insert(frontend.fuse(backend)?))
+    })
+}
@@ -1,4 +1,6 @@
 use super::*;
+use crate::common::gates::UnitaryGateType;
+use std::convert::TryFrom;
 
 /// Executes a plugin in the current thread.
 ///
@@ -100,6 +102,47 @@ pub extern "C" fn dqcs_plugin_recv(plugin: dqcs_plugin_state_t) -> dqcs_handle_t
     api_return(0, || Ok(insert(plugin.resolve()?.recv()?)))
 }
 
+/// Records a measurement outcome in the histogram of the simulation.
+///
+/// `outcome` is a bitstring of up to 64 bits, usually the result of one
+/// shot. The host can read back how often each outcome was recorded using
+/// `dqcs_sim_outcomes()`. Recorded outcomes are sent to the host along with
+/// the messages queued by `dqcs_plugin_send()`, but only one entry per
+/// distinct outcome is sent, so this is much cheaper than sending an
+/// `ArbData` message for every shot.
+///
+/// Only frontends can record outcomes. Calling this from any other plugin
+/// results in an error.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_record_outcome(
+    plugin: dqcs_plugin_state_t,
+    outcome: u64,
+) -> dqcs_return_t {
+    api_return_none(|| plugin.resolve()?.record_outcome(outcome))
+}
+
+/// Records the latest measurement results of the given downstream qubits as
+/// an outcome in the histogram of the simulation.
+///
+/// `qubits` must point to an array of `num_qubits` qubit references, where
+/// `num_qubits` is at most 64. Bit i of the recorded outcome is set if the
+/// latest measurement of the i-th qubit returned one. This waits for the
+/// measurement results like `dqcs_plugin_get_measurement()` does, and fails
+/// if any of them is undefined. Refer to `dqcs_plugin_record_outcome()` for
+/// more information.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_record_measurements(
+    plugin: dqcs_plugin_state_t,
+    qubits: *const dqcs_qubit_t,
+    num_qubits: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        let qubits = receive_qubits(qubits, num_qubits)?;
+        plugin.resolve()?.record_measurements(&qubits)?;
+        Ok(())
+    })
+}
+
 /// Allocate the given number of downstream qubits.
 ///
 /// Backend plugins are not allowed to call this. Doing so will result in an
@@ -158,6 +201,27 @@ pub extern "C" fn dqcs_plugin_free(
     })
 }
 
+/// Free the given downstream qubits, specified as a C array.
+///
+/// This function is equivalent to `dqcs_plugin_free()`, but takes the qubits
+/// from the array of `num_qubits` qubit references pointed to by `qubits`
+/// instead of from a qubit set handle.
+///
+/// Backend plugins are not allowed to call this. Doing so will result in an
+/// error.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_free_array(
+    plugin: dqcs_plugin_state_t,
+    qubits: *const dqcs_qubit_t,
+    num_qubits: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        let qubits = receive_qubits(qubits, num_qubits)?;
+        plugin.resolve()?.free(qubits)?;
+        Ok(())
+    })
+}
+
 /// Tells the downstream plugin to execute a gate.
 ///
 /// Backend plugins are not allowed to call this. Doing so will result in an
@@ -179,6 +243,183 @@ pub extern "C" fn dqcs_plugin_gate(
     })
 }
 
+/// Tells the downstream plugin to execute a sequence of gates.
+///
+/// Backend plugins are not allowed to call this. Doing so will result in an
+/// error.
+///
+/// `gates` must point to an array of `num_gates` valid gate handles. This is
+/// equivalent to calling `dqcs_plugin_gate()` for each gate in order, except
+/// that all gates are validated before any of them is sent, and that the
+/// batch is sent to the downstream plugin as a single message. The gate
+/// objects are consumed by this function, i.e. the handles become invalid, if
+/// and only if it succeeds.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_gate_batch(
+    plugin: dqcs_plugin_state_t,
+    gates: *const dqcs_handle_t,
+    num_gates: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        if num_gates == 0 {
+            return Ok(());
+        } else if gates.is_null() {
+            return inv_arg("unexpected NULL gate array");
+        }
+        let handles = unsafe { std::slice::from_raw_parts(gates, num_gates) };
+        let mut resolved = Vec::with_capacity(num_gates);
+        let mut gate_obs = Vec::with_capacity(num_gates);
+        for gate in handles.iter().cloned() {
+            resolve!(gate as pending Gate);
+            clone!(gate_ob: Gate = resolved gate);
+            gate_obs.push(gate_ob);
+            resolved.push(gate);
+        }
+        plugin.resolve()?.gate_batch(gate_obs)?;
+        for mut gate in resolved {
+            delete!(resolved gate);
+        }
+        Ok(())
+    })
+}
+
+/// Tells the downstream plugin to execute a sequence of predefined unitary
+/// gates, described by flat arrays.
+///
+/// Backend plugins are not allowed to call this. Doing so will result in an
+/// error.
+///
+/// `gate_types` must point to an array of `num_gates` predefined gate types.
+/// `qubits` must point to an array of `num_qubits` qubit references, where
+/// `num_qubits` is a multiple of `num_gates`; it is interpreted as a
+/// row-major table with one row per gate. Zeros at the start of a row are
+/// ignored, allowing gates with fewer qubits to share the table with larger
+/// ones. The remaining qubits are interpreted as for
+/// `dqcs_gate_new_predef()`: the rightmost qubits become the targets, and
+/// any qubits before them become control qubits.
+///
+/// `params` must likewise point to a table of `num_params` doubles with one
+/// row per gate, which may be empty if none of the gates are parameterized.
+/// `DQCS_GATE_RX`, `DQCS_GATE_RY`, `DQCS_GATE_RZ` and `DQCS_GATE_PHASE` take
+/// θ from the first column. `DQCS_GATE_PHASE_K` takes k from the first
+/// column, which must then hold a nonnegative integer. `DQCS_GATE_R` takes
+/// θ, φ and λ from the first three columns. Columns that are not used by a
+/// gate are ignored. The `DQCS_GATE_U*` types cannot be used with this
+/// function, as they are parameterized by a full matrix.
+///
+/// The gates are constructed without going through any handles, and then
+/// sent like `dqcs_plugin_gate_batch()` does: if any gate is invalid, none of
+/// them are sent. This is intended for language bindings that can hand over
+/// array data in bulk, such as NumPy arrays in Python.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_gate_predef_batch(
+    plugin: dqcs_plugin_state_t,
+    gate_types: *const dqcs_predefined_gate_t,
+    num_gates: size_t,
+    qubits: *const dqcs_qubit_t,
+    num_qubits: size_t,
+    params: *const c_double,
+    num_params: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        if num_gates == 0 {
+            return Ok(());
+        } else if gate_types.is_null() {
+            return inv_arg("unexpected NULL gate type array");
+        } else if num_qubits % num_gates != 0 || num_qubits == 0 {
+            return inv_arg("the qubit array must have a nonzero number of entries per gate");
+        } else if num_params % num_gates != 0 {
+            return inv_arg("the parameter array must have the same number of entries per gate");
+        } else if qubits.is_null() {
+            return inv_arg("unexpected NULL qubit array");
+        } else if num_params > 0 && params.is_null() {
+            return inv_arg("unexpected NULL parameter array");
+        }
+        let gate_types = unsafe { std::slice::from_raw_parts(gate_types, num_gates) };
+        let qubits = unsafe { std::slice::from_raw_parts(qubits, num_qubits) };
+        let params = if num_params > 0 {
+            unsafe { std::slice::from_raw_parts(params, num_params) }
+        } else {
+            &[]
+        };
+        let qubits_per_gate = num_qubits / num_gates;
+        let params_per_gate = num_params / num_gates;
+
+        // Converters are only needed for the gate types that are not plain
+        // rotations. They're constructed once per gate type per call.
+        let mut converters: Vec<(
+            UnitaryGateType,
+            Box<dyn Converter<Input = Gate, Output = (Vec<QubitRef>, ArbData)>>,
+        )> = vec![];
+
+        let mut gates = Vec::with_capacity(num_gates);
+        for (index, &gate_type) in gate_types.iter().enumerate() {
+            let gate_type = UnitaryGateType::try_from(gate_type)?;
+            let row = &qubits[index * qubits_per_gate..(index + 1) * qubits_per_gate];
+            let row = &row[row.iter().take_while(|&&qubit| qubit == 0).count()..];
+            let row = receive_qubits(row.as_ptr(), row.len())?;
+            let param_row = &params[index * params_per_gate..(index + 1) * params_per_gate];
+            let num_params_needed = match gate_type {
+                UnitaryGateType::R => 3,
+                UnitaryGateType::U(_) => {
+                    return inv_arg(format!(
+                        "gate {}: matrix-parameterized gates cannot be sent in bulk",
+                        index
+                    ));
+                }
+                _ if gate_type.is_parameterized() => 1,
+                _ => 0,
+            };
+            if param_row.len() < num_params_needed {
+                inv_arg(format!(
+                    "gate {}: {:?} needs {} parameter(s)",
+                    index, gate_type, num_params_needed
+                ))?;
+            }
+
+            // Rotations are constructed directly; they're stored symbolically
+            // anyway.
+            if gate_type.is_rotation() {
+                let (target, controls) = row
+                    .split_last()
+                    .ok_or_else(oe_inv_arg(format!("gate {}: need at least 1 qubit", index)))?;
+                gates.push(Gate::new_rotation(
+                    gate_type,
+                    param_row[0],
+                    *target,
+                    controls.iter().cloned(),
+                )?);
+                continue;
+            }
+
+            let mut data = ArbData::default();
+            match gate_type {
+                UnitaryGateType::PhaseK => {
+                    let k = param_row[0];
+                    if k < 0.0 || k.fract() != 0.0 {
+                        inv_arg(format!(
+                            "gate {}: k must be a nonnegative integer, got {}",
+                            index, k
+                        ))?;
+                    }
+                    (k as u64).to_arb(&mut data);
+                }
+                UnitaryGateType::R => (param_row[0], param_row[1], param_row[2]).to_arb(&mut data),
+                _ => (),
+            }
+            let converter = match converters.iter().position(|(t, _)| *t == gate_type) {
+                Some(position) => &converters[position].1,
+                None => {
+                    converters.push((gate_type, gate_type.into_gate_converter(None, 0., false)));
+                    &converters.last().unwrap().1
+                }
+            };
+            gates.push(converter.construct(&(row, data))?);
+        }
+        plugin.resolve()?.gate_batch(gates)
+    })
+}
+
 /// Returns the latest measurement of the given downstream qubit.
 ///
 /// Backend plugins are not allowed to call this. Doing so will result in an
@@ -198,6 +439,153 @@ pub extern "C" fn dqcs_plugin_get_measurement(
     })
 }
 
+/// Returns a future for the latest measurement of the given downstream qubit.
+///
+/// Unlike `dqcs_plugin_get_measurement()`, this does not wait for the
+/// downstream plugin to return the measurement result. This allows you to
+/// send more gates downstream while the measurement is in flight, and only
+/// wait for or react to the result once it is needed. The future refers to
+/// the most recent gate sent downstream that measures the qubit; if its
+/// result has already been received, the future is ready immediately.
+///
+/// The returned future must be consumed using
+/// `dqcs_plugin_measurement_wait()`, `dqcs_plugin_measurement_when_ready()`,
+/// or `dqcs_plugin_measurement_discard()`. Until then, DQCsim keeps track of
+/// it.
+///
+/// Backend plugins are not allowed to call this. Doing so will result in an
+/// error.
+///
+/// If the function succeeds, it returns the future. Otherwise it returns 0.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_measurement_future(
+    plugin: dqcs_plugin_state_t,
+    qubit: dqcs_qubit_t,
+) -> dqcs_future_t {
+    api_return(0, || {
+        let qubit =
+            QubitRef::from_foreign(qubit).ok_or_else(oe_inv_arg("0 is not a valid qubit"))?;
+        Ok(plugin.resolve()?.measurement_future(qubit)?.to_foreign())
+    })
+}
+
+/// Returns whether the result of the given measurement future has been
+/// received, without blocking.
+///
+/// Only responses that the downstream plugin has already delivered are
+/// handled. Whether a future is ready at a given point in time thus depends
+/// on operating system scheduling, so plugins that need to behave
+/// deterministically should not base their behavior on the result of this
+/// function. Continuations registered using
+/// `dqcs_plugin_measurement_when_ready()` for futures that have become ready
+/// are called before this function returns.
+///
+/// This does not consume the future.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_measurement_ready(
+    plugin: dqcs_plugin_state_t,
+    future: dqcs_future_t,
+) -> dqcs_bool_return_t {
+    api_return_bool(|| {
+        let future = MeasurementFuture::from_foreign(future)
+            .ok_or_else(oe_inv_arg("0 is not a valid measurement future"))?;
+        plugin.resolve()?.measurement_ready(future)
+    })
+}
+
+/// Waits for the result of the given measurement future and consumes it.
+///
+/// This only waits for the downstream plugin to handle the gates up to and
+/// including the measurement the future refers to. Continuations registered
+/// using `dqcs_plugin_measurement_when_ready()` for futures that have become
+/// ready are called before this function returns.
+///
+/// If the function succeeds, it returns a new handle to a qubit measurement
+/// result object. Otherwise it returns 0.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_measurement_wait(
+    plugin: dqcs_plugin_state_t,
+    future: dqcs_future_t,
+) -> dqcs_handle_t {
+    api_return(0, || {
+        let future = MeasurementFuture::from_foreign(future)
+            .ok_or_else(oe_inv_arg("0 is not a valid measurement future"))?;
+        Ok(insert(plugin.resolve()?.wait_measurement(future)?))
+    })
+}
+
+/// Registers a callback function to be called with the result of the given
+/// measurement future, and consumes the future.
+///
+/// If the result has already been received, the callback is called
+/// immediately. Otherwise, it is called from within the first call to
+/// `dqcs_plugin_measurement_ready()`, `dqcs_plugin_measurement_wait()`, or
+/// `dqcs_plugin_get_measurement()` after the result is received. Callbacks
+/// that are still pending when the plugin is finalized are never called, but
+/// their user data is still freed.
+///
+/// The callback receives the plugin state and a handle to the qubit
+/// measurement result object, which is automatically deleted after the
+/// callback returns. It is allowed to call any plugin function that
+/// `dqcs_plugin_get_measurement()` can be called from. It must return
+/// `DQCS_SUCCESS` or, to report an error, call `dqcs_error_set()` and return
+/// `DQCS_FAILURE`. The error is propagated through the function that called
+/// the callback.
+///
+/// The `user_free` function is called with `user_data` when the callback is
+/// dropped, regardless of whether it was called. This also happens when this
+/// function fails, so ownership of `user_data` is always transferred.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_measurement_when_ready(
+    plugin: dqcs_plugin_state_t,
+    future: dqcs_future_t,
+    callback: Option<
+        extern "C" fn(
+            user_data: *mut c_void,
+            state: dqcs_plugin_state_t,
+            meas: dqcs_handle_t,
+        ) -> dqcs_return_t,
+    >,
+    user_free: Option<extern "C" fn(user_data: *mut c_void)>,
+    user_data: *mut c_void,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        let data = UserData::new(user_free, user_data);
+        let callback = callback.ok_or_else(oe_inv_arg("callback cannot be null"))?;
+        let future = MeasurementFuture::from_foreign(future)
+            .ok_or_else(oe_inv_arg("0 is not a valid measurement future"))?;
+        plugin.resolve()?.when_measurement_ready(
+            future,
+            Box::new(
+                move |state: &mut PluginState, meas: QubitMeasurementResult| -> Result<()> {
+                    let meas_handle = insert(meas);
+                    let result = cb_return_none(callback(data.data(), state.into(), meas_handle));
+                    delete!(meas_handle);
+                    result
+                },
+            ),
+        )
+    })
+}
+
+/// Consumes the given measurement future without waiting for its result.
+///
+/// Use this for futures that turn out not to be needed, to release the
+/// resources DQCsim uses to keep track of them. The measurement itself is
+/// not affected; its result can still be queried using
+/// `dqcs_plugin_get_measurement()`.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_measurement_discard(
+    plugin: dqcs_plugin_state_t,
+    future: dqcs_future_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        let future = MeasurementFuture::from_foreign(future)
+            .ok_or_else(oe_inv_arg("0 is not a valid measurement future"))?;
+        plugin.resolve()?.discard_measurement_future(future)
+    })
+}
+
 /// Returns the number of downstream cycles since the latest measurement of the
 /// given downstream qubit.
 ///
@@ -238,6 +626,10 @@ pub extern "C" fn dqcs_plugin_get_cycles_between_measures(
 
 /// Tells the downstream plugin to run for the specified number of cycles.
 ///
+/// Consecutive advancements are summed up and sent along with the next gate,
+/// so the downstream plugin receives a single `advance()` callback for the
+/// total number of cycles right before the gate is executed.
+///
 /// Backend plugins are not allowed to call this. Doing so will result in an
 /// error.
 ///
@@ -308,3 +700,52 @@ pub extern "C" fn dqcs_plugin_random_u64(plugin: dqcs_plugin_state_t) -> dqcs_ha
 pub extern "C" fn dqcs_plugin_random_f64(plugin: dqcs_plugin_state_t) -> c_double {
     api_return(0.0, || Ok(plugin.resolve()?.random_f64()))
 }
+
+/// Fills a buffer with random unsigned 64-bit numbers using the simulator
+/// random seed.
+///
+/// `buffer` must point to an array of at least `num` integers. The result is
+/// the same as calling `dqcs_plugin_random_u64()` `num` times, but requires
+/// only a single call into DQCsim.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_random_fill_u64(
+    plugin: dqcs_plugin_state_t,
+    buffer: *mut u64,
+    num: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        let plugin = plugin.resolve()?;
+        if num == 0 {
+            return Ok(());
+        } else if buffer.is_null() {
+            return inv_arg("unexpected NULL buffer");
+        }
+        plugin.random_fill_u64(unsafe { std::slice::from_raw_parts_mut(buffer, num) });
+        Ok(())
+    })
+}
+
+/// Fills a buffer with random floating point numbers using the simulator
+/// random seed.
+///
+/// `buffer` must point to an array of at least `num` doubles. The generated
+/// numbers are uniformly distributed in the range `[0,1>`. The result is the
+/// same as calling `dqcs_plugin_random_f64()` `num` times, but requires only
+/// a single call into DQCsim.
+#[no_mangle]
+pub extern "C" fn dqcs_plugin_random_fill_f64(
+    plugin: dqcs_plugin_state_t,
+    buffer: *mut c_double,
+    num: size_t,
+) -> dqcs_return_t {
+    api_return_none(|| {
+        let plugin = plugin.resolve()?;
+        if num == 0 {
+            return Ok(());
+        } else if buffer.is_null() {
+            return inv_arg("unexpected NULL buffer");
+        }
+        plugin.random_fill_f64(unsafe { std::slice::from_raw_parts_mut(buffer, num) });
+        Ok(())
+    })
+}
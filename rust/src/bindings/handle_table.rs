@@ -0,0 +1,259 @@
+use super::*;
+
+/// Number of bits of a handle used for the slot index.
+const INDEX_BITS: u32 = 32;
+
+/// Mask for the slot index bits of a handle.
+const INDEX_MASK: dqcs_handle_t = (1 << INDEX_BITS) - 1;
+
+/// State of a slot in the handle table.
+#[derive(Debug)]
+enum Slot<T> {
+    /// The slot contains a live object.
+    Occupied(u32, T),
+
+    /// The object in this slot has been temporarily moved out by `take()`.
+    /// The slot remains reserved for it until it is either put back with
+    /// `restore()` or released with `release()`.
+    Taken(u32),
+
+    /// The slot is free. The generation is the one that will be used for the
+    /// next object stored in it.
+    Free(u32),
+}
+
+/// Generational arena mapping handles to objects.
+///
+/// Handles encode the index of the slot in the lower 32 bits (offset by one,
+/// such that 0 is never a valid handle) and the generation of the slot in the
+/// upper 32 bits. The generation is incremented whenever an object is removed
+/// from a slot, so stale handles are detected without a map lookup. Freed
+/// slots are reused, so the table never grows beyond the peak number of live
+/// objects. As long as no objects have been deleted, handles are allocated
+/// sequentially starting from 1.
+#[derive(Debug)]
+pub struct HandleTable<T> {
+    /// The slots.
+    slots: Vec<Slot<T>>,
+
+    /// Indices of the free slots.
+    free: Vec<usize>,
+
+    /// Number of objects currently stored in the table, including taken ones.
+    live: usize,
+}
+
+impl<T> Default for HandleTable<T> {
+    fn default() -> HandleTable<T> {
+        HandleTable::new()
+    }
+}
+
+impl<T> HandleTable<T> {
+    /// Constructs an empty handle table.
+    pub fn new() -> HandleTable<T> {
+        HandleTable {
+            slots: vec![],
+            free: vec![],
+            live: 0,
+        }
+    }
+
+    /// Encodes a slot index and generation into a handle.
+    fn encode(index: usize, generation: u32) -> dqcs_handle_t {
+        ((generation as dqcs_handle_t) << INDEX_BITS) | (index as dqcs_handle_t + 1)
+    }
+
+    /// Decodes a handle into its slot index and generation.
+    fn decode(handle: dqcs_handle_t) -> Option<(usize, u32)> {
+        let index = handle & INDEX_MASK;
+        if index == 0 {
+            None
+        } else {
+            Some(((index - 1) as usize, (handle >> INDEX_BITS) as u32))
+        }
+    }
+
+    /// Stores the given object in the table, returning its handle.
+    pub fn insert(&mut self, object: T) -> dqcs_handle_t {
+        self.live += 1;
+        if let Some(index) = self.free.pop() {
+            let generation = match self.slots[index] {
+                Slot::Free(generation) => generation,
+                _ => unreachable!("free list points to used slot"),
+            };
+            self.slots[index] = Slot::Occupied(generation, object);
+            Self::encode(index, generation)
+        } else {
+            let index = self.slots.len();
+            self.slots.push(Slot::Occupied(0, object));
+            Self::encode(index, 0)
+        }
+    }
+
+    /// Returns a reference to the object identified by the given handle, if
+    /// it is live and not currently taken.
+    pub fn get(&self, handle: dqcs_handle_t) -> Option<&T> {
+        let (index, generation) = Self::decode(handle)?;
+        match self.slots.get(index) {
+            Some(Slot::Occupied(g, object)) if *g == generation => Some(object),
+            _ => None,
+        }
+    }
+
+    /// Returns whether the given handle refers to a live object that is not
+    /// currently taken.
+    pub fn contains(&self, handle: dqcs_handle_t) -> bool {
+        self.get(handle).is_some()
+    }
+
+    /// Returns the slot index for the given handle if the generation of the
+    /// handle matches, and whether the object in it is currently taken.
+    fn lookup(&self, handle: dqcs_handle_t) -> Option<(usize, bool)> {
+        let (index, generation) = Self::decode(handle)?;
+        match self.slots.get(index)? {
+            Slot::Occupied(g, _) if *g == generation => Some((index, false)),
+            Slot::Taken(g) if *g == generation => Some((index, true)),
+            _ => None,
+        }
+    }
+
+    /// Moves the object identified by the given handle out of the table,
+    /// while keeping its slot reserved. The object must later be passed back
+    /// to `restore()`, or the slot must be released with `release()`.
+    pub fn take(&mut self, handle: dqcs_handle_t) -> Option<T> {
+        if let Some((index, false)) = self.lookup(handle) {
+            let generation = (handle >> INDEX_BITS) as u32;
+            match std::mem::replace(&mut self.slots[index], Slot::Taken(generation)) {
+                Slot::Occupied(_, object) => Some(object),
+                _ => unreachable!(),
+            }
+        } else {
+            None
+        }
+    }
+
+    /// Puts an object previously moved out using `take()` back into its slot.
+    pub fn restore(&mut self, handle: dqcs_handle_t, object: T) {
+        if let Some((index, true)) = self.lookup(handle) {
+            let generation = (handle >> INDEX_BITS) as u32;
+            self.slots[index] = Slot::Occupied(generation, object);
+        }
+    }
+
+    /// Releases the slot of an object previously moved out using `take()`,
+    /// invalidating its handle.
+    pub fn release(&mut self, handle: dqcs_handle_t) {
+        if let Some((index, true)) = self.lookup(handle) {
+            let generation = (handle >> INDEX_BITS) as u32;
+            self.slots[index] = Slot::Free(generation.wrapping_add(1));
+            self.free.push(index);
+            self.live -= 1;
+        }
+    }
+
+    /// Returns the number of objects in the table, including those that are
+    /// currently taken.
+    pub fn len(&self) -> usize {
+        self.live
+    }
+
+    /// Returns whether the table is empty.
+    pub fn is_empty(&self) -> bool {
+        self.live == 0
+    }
+
+    /// Iterates over all live objects that are not currently taken, in
+    /// ascending slot order.
+    pub fn iter(&self) -> impl Iterator<Item = (dqcs_handle_t, &T)> {
+        self.slots
+            .iter()
+            .enumerate()
+            .filter_map(|(index, slot)| match slot {
+                Slot::Occupied(generation, object) => {
+                    Some((Self::encode(index, *generation), object))
+                }
+                _ => None,
+            })
+    }
+
+    /// Removes all objects that are not currently taken from the table, and
+    /// returns them.
+    pub fn drain(&mut self) -> Vec<T> {
+        let mut objects = vec![];
+        for index in 0..self.slots.len() {
+            let generation = match self.slots[index] {
+                Slot::Occupied(generation, _) => generation,
+                _ => continue,
+            };
+            let next = Slot::Free(generation.wrapping_add(1));
+            if let Slot::Occupied(_, object) = std::mem::replace(&mut self.slots[index], next) {
+                objects.push(object);
+            }
+            self.free.push(index);
+        }
+        self.live -= objects.len();
+        objects
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn sequential() {
+        let mut table = HandleTable::new();
+        assert_eq!(table.insert("a"), 1);
+        assert_eq!(table.insert("b"), 2);
+        assert_eq!(table.insert("c"), 3);
+        assert_eq!(table.len(), 3);
+        assert_eq!(table.get(2), Some(&"b"));
+        assert_eq!(table.get(0), None);
+        assert_eq!(table.get(4), None);
+    }
+
+    #[test]
+    fn stale_handles() {
+        let mut table = HandleTable::new();
+        let a = table.insert("a");
+        assert_eq!(table.take(a), Some("a"));
+        assert_eq!(table.get(a), None);
+        assert_eq!(table.len(), 1);
+        table.release(a);
+        assert_eq!(table.len(), 0);
+        let b = table.insert("b");
+        assert_ne!(a, b);
+        assert_eq!(a & INDEX_MASK, b & INDEX_MASK);
+        assert_eq!(table.get(a), None);
+        assert_eq!(table.take(a), None);
+        table.release(a);
+        assert_eq!(table.get(b), Some(&"b"));
+    }
+
+    #[test]
+    fn restore() {
+        let mut table = HandleTable::new();
+        let a = table.insert("a");
+        let b = table.insert("b");
+        let x = table.take(a).unwrap();
+        assert!(!table.contains(a));
+        assert_eq!(table.iter().collect::<Vec<_>>(), vec![(b, &"b")]);
+        table.restore(a, x);
+        assert_eq!(table.get(a), Some(&"a"));
+    }
+
+    #[test]
+    fn drain() {
+        let mut table = HandleTable::new();
+        let a = table.insert("a");
+        let b = table.insert("b");
+        let x = table.take(b).unwrap();
+        assert_eq!(table.drain(), vec!["a"]);
+        assert_eq!(table.len(), 1);
+        assert!(!table.contains(a));
+        table.restore(b, x);
+        assert_eq!(table.get(b), Some(&"b"));
+        assert_ne!(table.insert("c"), a);
+    }
+}
@@ -32,6 +32,11 @@ pub use external::*;
 mod api_state;
 use api_state::*;
 
+// Module containing the generational arena used by the API state to map
+// handles to objects.
+mod handle_table;
+use handle_table::*;
+
 // Module containing utility functions and auxiliary data structures.
 mod util;
 use util::*;
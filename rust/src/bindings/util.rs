@@ -47,6 +47,58 @@ pub fn return_raw(obj_in: &[u8], obj_out: *mut c_void, obj_size: usize) -> Resul
     }
 }
 
+/// Convenience function for converting a C array of qubit indices to a
+/// vector of `QubitRef`s, with the same restrictions as a qubit reference set.
+pub fn receive_qubits(qubits: *const dqcs_qubit_t, num_qubits: size_t) -> Result<Vec<QubitRef>> {
+    if num_qubits == 0 {
+        return Ok(vec![]);
+    } else if qubits.is_null() {
+        return inv_arg("unexpected NULL qubit array");
+    }
+    let mut vec = Vec::with_capacity(num_qubits);
+    for &qubit in unsafe { std::slice::from_raw_parts(qubits, num_qubits) } {
+        let qubit = QubitRef::from_foreign(qubit)
+            .ok_or_else(oe_inv_arg("0 is not a valid qubit reference"))?;
+        if vec.contains(&qubit) {
+            inv_arg(format!("cannot use qubit {} twice", qubit))?;
+        }
+        vec.push(qubit);
+    }
+    Ok(vec)
+}
+
+/// Convenience function for converting a C array of CPU or NUMA node
+/// indices to a vector.
+pub fn receive_indices(indices: *const size_t, num_indices: size_t) -> Result<Vec<usize>> {
+    if num_indices == 0 {
+        Ok(vec![])
+    } else if indices.is_null() {
+        inv_arg("unexpected NULL array")
+    } else {
+        Ok(unsafe { std::slice::from_raw_parts(indices, num_indices) }.to_vec())
+    }
+}
+
+/// Convenience function for copying a list of CPU or NUMA node indices to a
+/// C array of the given size. Returns the number of indices in the list,
+/// which may be more than the number that was copied.
+pub fn return_indices(
+    indices_in: &[usize],
+    indices_out: *mut size_t,
+    max_indices: size_t,
+) -> Result<ssize_t> {
+    if max_indices > 0 && indices_out.is_null() {
+        inv_arg("unexpected NULL buffer")
+    } else {
+        let copy_count = std::cmp::min(indices_in.len(), max_indices);
+        if copy_count > 0 {
+            unsafe { std::slice::from_raw_parts_mut(indices_out, copy_count) }
+                .copy_from_slice(&indices_in[..copy_count]);
+        }
+        Ok(indices_in.len() as ssize_t)
+    }
+}
+
 /// Converts an index Pythonically and checks bounds.
 ///
 /// By "Pythonically" we mean that the list length is added to the index if it
@@ -0,0 +1,149 @@
+//! CPU affinity and NUMA memory policy control.
+//!
+//! Thin wrappers around the Linux scheduler and memory policy system calls,
+//! used to place plugin processes and simulator threads on specific CPUs and
+//! NUMA nodes. The functions do not allocate, such that they can be called
+//! between `fork()` and `exec()` when spawning a plugin process. On other
+//! platforms they fail with `ENOSYS`, unless they are asked to leave the
+//! placement as it is.
+
+use crate::host::configuration::NumaPolicy;
+use std::io;
+
+/// The number of NUMA nodes that can be specified in a memory policy.
+#[cfg(target_os = "linux")]
+const MAX_NUMA_NODES: usize = 1024;
+
+/// The number of words in a NUMA node mask.
+#[cfg(target_os = "linux")]
+const NODE_MASK_WORDS: usize = MAX_NUMA_NODES / (8 * std::mem::size_of::<libc::c_ulong>());
+
+/// Builds a CPU set from the given list of logical CPU indices.
+#[cfg(target_os = "linux")]
+fn cpu_set(cpus: &[usize]) -> io::Result<libc::cpu_set_t> {
+    let mut set: libc::cpu_set_t = unsafe { std::mem::zeroed() };
+    for &cpu in cpus {
+        if cpu >= 8 * std::mem::size_of::<libc::cpu_set_t>() {
+            return Err(io::Error::from_raw_os_error(libc::EINVAL));
+        }
+        unsafe { libc::CPU_SET(cpu, &mut set) };
+    }
+    Ok(set)
+}
+
+/// Restricts the calling thread to the given logical CPUs. Threads and
+/// processes spawned by the thread afterwards inherit the restriction. This
+/// is no-op if the list is empty.
+pub fn set_current_affinity(cpus: &[usize]) -> io::Result<()> {
+    if cpus.is_empty() {
+        return Ok(());
+    }
+    #[cfg(target_os = "linux")]
+    {
+        let set = cpu_set(cpus)?;
+        if unsafe { libc::sched_setaffinity(0, std::mem::size_of::<libc::cpu_set_t>(), &set) } != 0
+        {
+            return Err(io::Error::last_os_error());
+        }
+        Ok(())
+    }
+    #[cfg(not(target_os = "linux"))]
+    Err(io::Error::from_raw_os_error(libc::ENOSYS))
+}
+
+/// Restricts the given thread to the given logical CPUs. This is no-op if
+/// the list is empty.
+pub fn set_thread_affinity(thread: libc::pthread_t, cpus: &[usize]) -> io::Result<()> {
+    if cpus.is_empty() {
+        return Ok(());
+    }
+    #[cfg(target_os = "linux")]
+    {
+        let set = cpu_set(cpus)?;
+        let result = unsafe {
+            libc::pthread_setaffinity_np(thread, std::mem::size_of::<libc::cpu_set_t>(), &set)
+        };
+        if result != 0 {
+            return Err(io::Error::from_raw_os_error(result));
+        }
+        Ok(())
+    }
+    #[cfg(not(target_os = "linux"))]
+    {
+        let _ = thread;
+        Err(io::Error::from_raw_os_error(libc::ENOSYS))
+    }
+}
+
+/// Sets the NUMA memory policy of the calling thread. Threads and processes
+/// spawned by the thread afterwards inherit the policy. This is no-op for
+/// `NumaPolicy::Default`.
+pub fn set_current_numa_policy(policy: &NumaPolicy) -> io::Result<()> {
+    // Mode constants from linux/mempolicy.h.
+    let (mode, nodes): (libc::c_int, &[usize]) = match policy {
+        NumaPolicy::Default => return Ok(()),
+        NumaPolicy::Preferred(node) => (1, std::slice::from_ref(node)),
+        NumaPolicy::Bind(nodes) => (2, nodes),
+        NumaPolicy::Interleave(nodes) => (3, nodes),
+    };
+    #[cfg(target_os = "linux")]
+    {
+        let bits = 8 * std::mem::size_of::<libc::c_ulong>();
+        let mut mask: [libc::c_ulong; NODE_MASK_WORDS] = [0; NODE_MASK_WORDS];
+        for &node in nodes {
+            if node >= MAX_NUMA_NODES {
+                return Err(io::Error::from_raw_os_error(libc::EINVAL));
+            }
+            mask[node / bits] |= 1 << (node % bits);
+        }
+        // The kernel ignores the last bit of the mask passed to it, hence
+        // the + 1.
+        let result = unsafe {
+            libc::syscall(
+                libc::SYS_set_mempolicy,
+                mode,
+                mask.as_ptr(),
+                MAX_NUMA_NODES + 1,
+            )
+        };
+        if result != 0 {
+            return Err(io::Error::last_os_error());
+        }
+        Ok(())
+    }
+    #[cfg(not(target_os = "linux"))]
+    {
+        let _ = (mode, nodes);
+        Err(io::Error::from_raw_os_error(libc::ENOSYS))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn noop() {
+        set_current_affinity(&[]).unwrap();
+        set_current_numa_policy(&NumaPolicy::Default).unwrap();
+    }
+
+    #[cfg(target_os = "linux")]
+    #[test]
+    fn affinity() {
+        let thread = std::thread::spawn(|| {
+            // Pick the first CPU we are allowed to run on.
+            let mut set: libc::cpu_set_t = unsafe { std::mem::zeroed() };
+            let size = std::mem::size_of::<libc::cpu_set_t>();
+            assert_eq!(unsafe { libc::sched_getaffinity(0, size, &mut set) }, 0);
+            let cpu = (0..8 * size)
+                .find(|&cpu| unsafe { libc::CPU_ISSET(cpu, &set) })
+                .unwrap();
+
+            set_current_affinity(&[cpu]).unwrap();
+            assert_eq!(unsafe { libc::sched_getcpu() }, cpu as libc::c_int);
+            assert!(set_current_affinity(&[1 << 20]).is_err());
+        });
+        thread.join().unwrap();
+    }
+}
@@ -8,12 +8,23 @@
 
 use crate::common::{
     error::{inv_arg, oe_err, oe_inv_arg, Result},
-    gates::UnboundUnitaryGate,
+    gates::{UnboundUnitaryGate, UnitaryGateType},
     types::{ArbData, Gate, GateType, Matrix, QubitRef},
 };
 use integer_sqrt::IntegerSquareRoot;
 use num_complex::Complex64;
-use std::{cell::RefCell, collections::HashMap, convert::TryInto, f64::consts::PI, hash::Hash};
+use std::{
+    cell::RefCell,
+    collections::{BTreeMap, HashMap},
+    convert::TryInto,
+    f64::consts::PI,
+    hash::Hash,
+    rc::Rc,
+};
+
+/// The default maximum number of entries in the detection cache of a
+/// ConverterMap.
+pub const DEFAULT_CACHE_CAPACITY: usize = 1024;
 
 /// A type that can be constructed from (part of) an ArbData object.
 ///
@@ -195,6 +206,101 @@ pub trait Converter {
     ///  - `Ok(O)`: successful construction
     ///  - `Err(_)`: something went wrong during construction
     fn construct(&self, input: &Self::Output) -> Result<Self::Input>;
+    /// Returns the structural constraints that an input must satisfy for the
+    /// detector to possibly match it. ConverterMap checks these before
+    /// calling `detect()`, such that converters that cannot match are skipped
+    /// cheaply. The default is to place no constraints.
+    fn filter(&self) -> GateFilter {
+        GateFilter::default()
+    }
+}
+
+/// Cheap structural summary of a gate, computed once when a ConverterMap
+/// detects it and checked against the `GateFilter` of each converter.
+#[derive(Debug, Clone, PartialEq, Eq, Hash)]
+pub struct GateShape {
+    /// The type of the gate.
+    pub gate_type: GateType,
+    /// The number of target qubits, which also determines the dimension of
+    /// the matrix of a unitary gate.
+    pub num_targets: usize,
+    /// The number of control qubits.
+    pub num_controls: usize,
+    /// The number of measured qubits.
+    pub num_measures: usize,
+    /// The fingerprint of the matrix of a unitary gate, if it has one that
+    /// is cheap to obtain.
+    pub fingerprint: Option<u64>,
+}
+
+/// Types that can be summarized by a `GateShape`.
+pub trait Shaped {
+    /// Returns the structural summary of this object.
+    fn shape(&self) -> GateShape;
+
+    /// Returns whether detection results for this object are worth caching.
+    fn cacheable(&self) -> bool {
+        true
+    }
+}
+
+impl Shaped for Gate {
+    fn shape(&self) -> GateShape {
+        GateShape {
+            gate_type: self.get_type().clone(),
+            num_targets: self.get_targets().len(),
+            num_controls: self.get_controls().len(),
+            num_measures: self.get_measures().len(),
+            fingerprint: if self.get_type() == &GateType::Unitary
+                && self.get_predefined_angle().is_none()
+            {
+                self.get_matrix().map(Matrix::fingerprint)
+            } else {
+                None
+            },
+        }
+    }
+
+    /// Symbolic rotation gates are detected without comparing matrices, and
+    /// typically all have different angles, so caching them would only
+    /// evict useful entries.
+    fn cacheable(&self) -> bool {
+        self.get_predefined_angle().is_none()
+    }
+}
+
+/// Structural constraints placed on a gate by a converter. None means that
+/// the corresponding property is not constrained.
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct GateFilter {
+    /// The required gate type.
+    pub gate_type: Option<GateType>,
+    /// The required number of target qubits.
+    pub num_targets: Option<usize>,
+    /// The required number of control qubits.
+    pub num_controls: Option<usize>,
+    /// The required number of measured qubits.
+    pub num_measures: Option<usize>,
+    /// The fingerprint of the only matrix that the converter can match.
+    /// ConverterMap indexes converters that specify this in a hash table,
+    /// such that they need not be checked one by one. This is not checked
+    /// when the shape of the gate has no fingerprint.
+    pub fingerprint: Option<u64>,
+}
+
+impl GateFilter {
+    /// Returns whether a gate with the given shape satisfies this filter.
+    pub fn matches(&self, shape: &GateShape) -> bool {
+        self.gate_type
+            .as_ref()
+            .map_or(true, |gate_type| gate_type == &shape.gate_type)
+            && self.num_targets.map_or(true, |n| n == shape.num_targets)
+            && self.num_controls.map_or(true, |n| n == shape.num_controls)
+            && self.num_measures.map_or(true, |n| n == shape.num_measures)
+            && self.fingerprint.map_or(true, |fingerprint| {
+                shape.fingerprint.map_or(true, |other| other == fingerprint)
+            })
+    }
 }
 
 /// A type that represents a possibly parameterized matrix form, allowing
@@ -218,6 +324,16 @@ pub trait MatrixConverter {
     ) -> Result<Option<Self::Parameters>>;
     /// Constructs a matrix from the given parameter set.
     fn construct_matrix(&self, parameters: &Self::Parameters) -> Result<Matrix>;
+    /// Returns the number of qubits of the matrices that this converter can
+    /// detect, or None if this is not known in advance.
+    fn num_qubits(&self) -> Option<usize> {
+        None
+    }
+    /// Returns the fingerprint of the only matrix that this converter can
+    /// detect, or None if it can detect more than one.
+    fn fingerprint(&self) -> Option<u64> {
+        None
+    }
 }
 
 impl<T> Converter for T
@@ -236,6 +352,14 @@ where
         self.construct_matrix(parameters)
             .map(|matrix| (matrix, 0., false))
     }
+
+    fn filter(&self) -> GateFilter {
+        GateFilter {
+            num_targets: self.num_qubits(),
+            fingerprint: self.fingerprint(),
+            ..GateFilter::default()
+        }
+    }
 }
 
 /// A type that represents a possibly parameterized matrix form, allowing
@@ -316,6 +440,14 @@ impl MatrixConverter for FixedMatrixConverter {
     fn construct_matrix(&self, _: &Self::Parameters) -> Result<Matrix> {
         Ok(self.matrix.clone())
     }
+
+    fn num_qubits(&self) -> Option<usize> {
+        self.matrix.num_qubits()
+    }
+
+    fn fingerprint(&self) -> Option<u64> {
+        Some(self.matrix.fingerprint())
+    }
 }
 
 /// Normalizes the given complex number, defaulting to 1 if the norm is zero.
@@ -370,6 +502,10 @@ impl MatrixConverter for RxMatrixConverter {
     fn construct_matrix(&self, theta: &Self::Parameters) -> Result<Matrix> {
         Ok(UnboundUnitaryGate::RX(*theta).into())
     }
+
+    fn num_qubits(&self) -> Option<usize> {
+        Some(1)
+    }
 }
 
 /// Matrix converter object for the RY matrix.
@@ -401,6 +537,10 @@ impl MatrixConverter for RyMatrixConverter {
     fn construct_matrix(&self, theta: &Self::Parameters) -> Result<Matrix> {
         Ok(UnboundUnitaryGate::RY(*theta).into())
     }
+
+    fn num_qubits(&self) -> Option<usize> {
+        Some(1)
+    }
 }
 
 /// Matrix converter object for the RZ matrix.
@@ -433,6 +573,10 @@ impl MatrixConverter for RzMatrixConverter {
     fn construct_matrix(&self, theta: &Self::Parameters) -> Result<Matrix> {
         Ok(UnboundUnitaryGate::RZ(*theta).into())
     }
+
+    fn num_qubits(&self) -> Option<usize> {
+        Some(1)
+    }
 }
 
 /// Matrix converter object for the phase submatrix.
@@ -465,6 +609,10 @@ impl MatrixConverter for PhaseMatrixConverter {
     fn construct_matrix(&self, theta: &Self::Parameters) -> Result<Matrix> {
         Ok(UnboundUnitaryGate::Phase(*theta).into())
     }
+
+    fn num_qubits(&self) -> Option<usize> {
+        Some(1)
+    }
 }
 
 /// Matrix converter object for the phase submatrix using θ = π/2^k​.
@@ -502,6 +650,10 @@ impl MatrixConverter for PhaseKMatrixConverter {
     fn construct_matrix(&self, k: &Self::Parameters) -> Result<Matrix> {
         Ok(UnboundUnitaryGate::PhaseK(*k).into())
     }
+
+    fn num_qubits(&self) -> Option<usize> {
+        Some(1)
+    }
 }
 
 /// Matrix converter object for the R (= IBM U) gate.
@@ -550,6 +702,10 @@ impl MatrixConverter for RMatrixConverter {
     fn construct_matrix(&self, params: &Self::Parameters) -> Result<Matrix> {
         Ok(UnboundUnitaryGate::R(params.0, params.1, params.2).into())
     }
+
+    fn num_qubits(&self) -> Option<usize> {
+        Some(1)
+    }
 }
 
 /// Matrix converter object for any matrix of a certain size - simply has the
@@ -603,6 +759,10 @@ impl MatrixConverter for UMatrixConverter {
         }
         Ok(matrix.clone())
     }
+
+    fn num_qubits(&self) -> Option<usize> {
+        self.num_qubits
+    }
 }
 
 /// Converter implementation for regular unitary gate matrices.
@@ -674,6 +834,15 @@ where
             self.num_controls,
         ))
     }
+
+    fn filter(&self) -> GateFilter {
+        GateFilter {
+            num_targets: self.converter.num_qubits(),
+            num_controls: self.num_controls,
+            fingerprint: self.converter.fingerprint(),
+            ..GateFilter::default()
+        }
+    }
 }
 
 /// Converter implementation for unitary gates based on a matrix converter.
@@ -690,6 +859,9 @@ where
 {
     /// The wrapped matrix converter.
     matrix_converter: M,
+    /// The structural constraints of this converter, derived from those of
+    /// the matrix converter upon construction.
+    filter: GateFilter,
 }
 
 impl<M> From<M> for UnitaryGateConverter<M>
@@ -697,7 +869,14 @@ where
     M: Converter<Input = (Matrix, Option<usize>)>,
 {
     fn from(matrix_converter: M) -> Self {
-        Self { matrix_converter }
+        let filter = GateFilter {
+            gate_type: Some(GateType::Unitary),
+            ..matrix_converter.filter()
+        };
+        Self {
+            matrix_converter,
+            filter,
+        }
     }
 }
 
@@ -771,6 +950,139 @@ where
 
         Ok(gate)
     }
+
+    fn filter(&self) -> GateFilter {
+        self.filter.clone()
+    }
+}
+
+/// Converter implementation for non-parameterized predefined unitary gates
+/// and single-angle rotation gates.
+///
+/// Gates constructed by this converter are tagged with their predefined gate
+/// type, which is propagated through the gatestream. Rotation gates are
+/// stored symbolically, such that their matrix need not be computed unless
+/// it is requested. Detection of tagged gates only checks the tag and the
+/// number of control qubits; other gates are detected by comparing their
+/// matrix as usual.
+pub struct PredefinedGateConverter {
+    /// The predefined gate type.
+    gate_type: UnitaryGateType,
+    /// How many control qubits are expected. If None, no constraint is placed
+    /// on this.
+    num_controls: Option<usize>,
+    /// The converter used for gates that are not tagged with the gate type,
+    /// and for construction of non-rotation gates.
+    converter: Box<dyn Converter<Input = Gate, Output = (Vec<QubitRef>, ArbData)>>,
+}
+
+impl PredefinedGateConverter {
+    /// Constructs a converter for the given predefined gate type, which must
+    /// either not be parameterized or be a rotation.
+    pub fn new(
+        gate_type: UnitaryGateType,
+        num_controls: Option<usize>,
+        epsilon: f64,
+        ignore_global_phase: bool,
+    ) -> Result<Self> {
+        let converter: Box<dyn Converter<Input = Gate, Output = (Vec<QubitRef>, ArbData)>> =
+            match gate_type {
+                UnitaryGateType::RX => Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
+                    RxMatrixConverter::default(),
+                    num_controls,
+                    epsilon,
+                    ignore_global_phase,
+                ))),
+                UnitaryGateType::RY => Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
+                    RyMatrixConverter::default(),
+                    num_controls,
+                    epsilon,
+                    ignore_global_phase,
+                ))),
+                UnitaryGateType::RZ => Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
+                    RzMatrixConverter::default(),
+                    num_controls,
+                    epsilon,
+                    ignore_global_phase,
+                ))),
+                UnitaryGateType::Phase => {
+                    Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
+                        PhaseMatrixConverter::default(),
+                        num_controls,
+                        epsilon,
+                        ignore_global_phase,
+                    )))
+                }
+                _ => {
+                    let matrix: Matrix = match gate_type.try_into() {
+                        Ok(matrix) => matrix,
+                        Err(e) => return inv_arg(e),
+                    };
+                    Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
+                        FixedMatrixConverter::from(matrix),
+                        num_controls,
+                        epsilon,
+                        ignore_global_phase,
+                    )))
+                }
+            };
+        Ok(Self {
+            gate_type,
+            num_controls,
+            converter,
+        })
+    }
+}
+
+impl Converter for PredefinedGateConverter {
+    type Input = Gate;
+    type Output = (Vec<QubitRef>, ArbData);
+
+    fn detect(&self, gate: &Gate) -> Result<Option<Self::Output>> {
+        if gate.get_predefined() == Some(self.gate_type)
+            && self
+                .num_controls
+                .map_or(true, |n| n == gate.get_controls().len())
+        {
+            let mut qubits = gate.get_controls().to_vec();
+            qubits.extend(gate.get_targets().iter());
+            let mut data = gate.data.clone();
+            if let Some(theta) = gate.get_predefined_angle() {
+                theta.to_arb(&mut data);
+            }
+            Ok(Some((qubits, data)))
+        } else {
+            self.converter.detect(gate)
+        }
+    }
+
+    fn construct(&self, output: &Self::Output) -> Result<Gate> {
+        if !self.gate_type.is_rotation() {
+            let mut gate = self.converter.construct(output)?;
+            gate.set_predefined(self.gate_type);
+            return Ok(gate);
+        }
+
+        let (qubits, data) = output;
+        let mut data = data.clone();
+        let theta = f64::from_arb(&mut data)?;
+        let (target, controls) = qubits
+            .split_last()
+            .ok_or_else(oe_inv_arg("need at least 1 qubits"))?;
+        if let Some(expected) = self.num_controls {
+            if controls.len() != expected {
+                inv_arg(format!("expected {} control and 1 target qubits", expected))?;
+            }
+        }
+        let mut gate =
+            Gate::new_rotation(self.gate_type, theta, *target, controls.iter().cloned())?;
+        gate.data.copy_from(&data);
+        Ok(gate)
+    }
+
+    fn filter(&self) -> GateFilter {
+        self.converter.filter()
+    }
 }
 
 /// Converter implementation for measurement gates.
@@ -836,6 +1148,14 @@ impl Converter for MeasurementGateConverter {
 
         Ok(gate)
     }
+
+    fn filter(&self) -> GateFilter {
+        GateFilter {
+            gate_type: Some(GateType::Measurement),
+            num_measures: self.num_measures,
+            ..GateFilter::default()
+        }
+    }
 }
 
 /// Converter implementation for prep gates.
@@ -901,6 +1221,14 @@ impl Converter for PrepGateConverter {
 
         Ok(gate)
     }
+
+    fn filter(&self) -> GateFilter {
+        GateFilter {
+            gate_type: Some(GateType::Prep),
+            num_targets: self.num_targets,
+            ..GateFilter::default()
+        }
+    }
 }
 
 /// Lambda-based converter implementation for unitary gate matrices.
@@ -936,26 +1264,139 @@ impl<'f> Converter for CustomGateConverter<'f> {
     }
 }
 
+/// Bounded least-recently-used cache used by ConverterMap to remember
+/// detection results.
+///
+/// Keys are reference counted such that the recency index can refer to them
+/// without cloning the (potentially large) key objects.
+struct DetectionCache<I, V>
+where
+    I: Eq + Hash,
+{
+    /// The maximum number of entries in the cache. Zero disables caching.
+    capacity: usize,
+    /// The cached values, along with the tick at which they were last used.
+    entries: HashMap<Rc<I>, (u64, V)>,
+    /// Maps the last-used ticks of the entries back to their keys, ordered
+    /// from least to most recently used.
+    recency: BTreeMap<u64, Rc<I>>,
+    /// Monotonic counter used to order accesses.
+    tick: u64,
+    /// The number of lookups that hit.
+    hits: u64,
+    /// The number of lookups that missed.
+    misses: u64,
+}
+
+impl<I, V> DetectionCache<I, V>
+where
+    I: Eq + Hash,
+{
+    /// Constructs an empty cache with the given capacity.
+    fn new(capacity: usize) -> Self {
+        DetectionCache {
+            capacity,
+            entries: HashMap::new(),
+            recency: BTreeMap::new(),
+            tick: 0,
+            hits: 0,
+            misses: 0,
+        }
+    }
+
+    /// Looks up the given key, marking it as most recently used if it is
+    /// present.
+    fn get(&mut self, key: &I) -> Option<&V> {
+        if let Some((tick, value)) = self.entries.get_mut(key) {
+            self.tick += 1;
+            let key = self.recency.remove(&*tick).unwrap();
+            self.recency.insert(self.tick, key);
+            *tick = self.tick;
+            self.hits += 1;
+            Some(value)
+        } else {
+            self.misses += 1;
+            None
+        }
+    }
+
+    /// Inserts the given entry, evicting the least recently used entry if
+    /// the cache is full and the key is not already present.
+    fn insert(&mut self, key: I, value: V) {
+        if self.capacity == 0 {
+            return;
+        }
+        if !self.entries.contains_key(&key) {
+            self.shrink_to(self.capacity - 1);
+        }
+        self.tick += 1;
+        let key = Rc::new(key);
+        self.recency.insert(self.tick, key.clone());
+        if let Some((tick, _)) = self.entries.insert(key, (self.tick, value)) {
+            self.recency.remove(&tick);
+        }
+    }
+
+    /// Evicts least recently used entries until at most `len` remain.
+    fn shrink_to(&mut self, len: usize) {
+        while self.entries.len() > len {
+            let tick = *self.recency.keys().next().unwrap();
+            let key = self.recency.remove(&tick).unwrap();
+            self.entries.remove(&key);
+        }
+    }
+
+    /// Changes the capacity of the cache, evicting entries if necessary.
+    fn set_capacity(&mut self, capacity: usize) {
+        self.capacity = capacity;
+        self.shrink_to(capacity);
+    }
+
+    /// Removes all entries for which the given predicate returns false.
+    fn retain(&mut self, mut f: impl FnMut(&V) -> bool) {
+        let recency = &mut self.recency;
+        self.entries.retain(|_, (tick, value)| {
+            let keep = f(value);
+            if !keep {
+                recency.remove(&*tick);
+            }
+            keep
+        });
+    }
+
+    /// Removes all entries. The hit/miss counters are not affected.
+    fn clear(&mut self) {
+        self.entries.clear();
+        self.recency.clear();
+    }
+}
+
 /// K: user-defined key for identifying which converter to use
 /// I: detector input = constructor output
 /// O: detector output = constructor input
 pub struct ConverterMap<'c, K, I, O>
 where
     K: Eq + Hash + Clone,
-    I: Eq + Hash + Clone,
+    I: Eq + Hash + Clone + Shaped,
     O: Clone,
 {
     /// The collection of `Converter`s are stored in this map as trait objects
     /// with a wrapping tuple including the corresponding key.
     converters: HashMap<K, Box<dyn Converter<Input = I, Output = O> + 'c>>,
-    /// The order in which converters are called when
-    order: Vec<K>,
+    /// The order in which converters are called when detecting, along with
+    /// the structural filter of each converter, queried once when the
+    /// converter is added.
+    order: Vec<(K, GateFilter)>,
+    /// The positions in `order` of the converters whose filter specifies a
+    /// fingerprint, indexed by said fingerprint.
+    indexed: HashMap<u64, Vec<usize>>,
+    /// The positions in `order` of the other converters.
+    unindexed: Vec<usize>,
     /// Function that preprocesses the input type to a cache key, removing
     /// unnecessary information to improve performance.
     cache_key_generator: Box<dyn Fn(&I) -> I>,
-    /// The cache is stored in a HashMap that maps from input type I to the
-    /// output type (K, O).
-    cache: RefCell<HashMap<I, Option<(K, O)>>>,
+    /// The cache maps from input type I to the output type (K, O).
+    cache: RefCell<DetectionCache<I, Option<(K, O)>>>,
     /// Whether the detector cache should be used to short-circuit straight to
     /// the detection result (true), or only to the converter key (false).
     fully_cached: bool,
@@ -964,7 +1405,7 @@ where
 impl<'c, K, I, O> Default for ConverterMap<'c, K, I, O>
 where
     K: Eq + Hash + Clone,
-    I: Eq + Hash + Clone,
+    I: Eq + Hash + Clone + Shaped,
     O: Clone,
 {
     fn default() -> Self {
@@ -975,7 +1416,7 @@ where
 impl<'c, K, I, O> ConverterMap<'c, K, I, O>
 where
     K: Eq + Hash + Clone,
-    I: Eq + Hash + Clone,
+    I: Eq + Hash + Clone + Shaped,
     O: Clone,
 {
     /// Constructs a new empty ConverterMap.
@@ -991,8 +1432,10 @@ where
         ConverterMap {
             converters: HashMap::new(),
             order: vec![],
+            indexed: HashMap::new(),
+            unindexed: vec![],
             cache_key_generator,
-            cache: RefCell::new(HashMap::new()),
+            cache: RefCell::new(DetectionCache::new(DEFAULT_CACHE_CAPACITY)),
             fully_cached,
         }
     }
@@ -1005,17 +1448,19 @@ where
         converter: Box<dyn Converter<Input = I, Output = O> + 'c>,
     ) {
         let key: K = key.into();
-        self.cache.borrow_mut().retain(|_, v| {
+        self.cache.borrow_mut().retain(|v| {
             if let Some((k, _)) = v {
                 k != &key
             } else {
                 false
             }
         });
+        let filter = converter.filter();
         if self.converters.insert(key.clone(), converter).is_some() {
-            self.order.retain(|k| k != &key);
+            self.order.retain(|(k, _)| k != &key);
         }
-        self.order.push(key);
+        self.order.push((key, filter));
+        self.reindex();
     }
 
     /// Inserts a Converter at position index within the collection of Detectors
@@ -1029,10 +1474,12 @@ where
     ) {
         self.clear_cache();
         let key: K = key.into();
+        let filter = converter.filter();
         if self.converters.insert(key.clone(), converter).is_some() {
-            self.order.retain(|k| k != &key);
+            self.order.retain(|(k, _)| k != &key);
         }
-        self.order.insert(index, key);
+        self.order.insert(index, (key, filter));
+        self.reindex();
     }
 
     /// Appends the specified Converter with the corresponding specified key to
@@ -1046,11 +1493,50 @@ where
         self
     }
 
+    /// Rebuilds the fingerprint index after the converters or their order
+    /// changed.
+    fn reindex(&mut self) {
+        self.indexed.clear();
+        self.unindexed.clear();
+        for (position, (_, filter)) in self.order.iter().enumerate() {
+            if let Some(fingerprint) = filter.fingerprint {
+                self.indexed
+                    .entry(fingerprint)
+                    .or_insert_with(Vec::new)
+                    .push(position);
+            } else {
+                self.unindexed.push(position);
+            }
+        }
+    }
+
     /// Clears the cache.
     pub fn clear_cache(&self) {
         self.cache.borrow_mut().clear();
     }
 
+    /// Returns the maximum number of entries in the detection cache.
+    pub fn cache_capacity(&self) -> usize {
+        self.cache.borrow().capacity
+    }
+
+    /// Sets the maximum number of entries in the detection cache. When the
+    /// cache is full, the least recently used entry is evicted. Zero disables
+    /// the cache entirely.
+    pub fn set_cache_capacity(&mut self, capacity: usize) {
+        self.cache.borrow_mut().set_capacity(capacity);
+    }
+
+    /// Returns the number of detections that were served by the cache.
+    pub fn cache_hits(&self) -> u64 {
+        self.cache.borrow().hits
+    }
+
+    /// Returns the number of detections that were not served by the cache.
+    pub fn cache_misses(&self) -> u64 {
+        self.cache.borrow().misses
+    }
+
     /// Returns the number of Detectors in the collection.
     pub fn len(&self) -> usize {
         self.converters.len()
@@ -1060,23 +1546,111 @@ where
     pub fn is_empty(&self) -> bool {
         self.converters.is_empty()
     }
+
+    /// Checks all converters in order without consulting the cache, skipping
+    /// those that cannot match based on the structure of the input.
+    ///
+    /// If the input has a fingerprint, only the converters that either have
+    /// the same fingerprint or have none are checked at first, using the
+    /// fingerprint index. Since approximately equal matrices may still have
+    /// different fingerprints, the converters with a different fingerprint
+    /// that precede the first match are checked as well, or all of them if
+    /// there is no match. The result is therefore the same as when all
+    /// converters are checked in order.
+    fn detect_uncached(&self, input: &I) -> Result<Option<(K, O)>> {
+        let shape = input.shape();
+        let fingerprint = match shape.fingerprint {
+            Some(fingerprint) => fingerprint,
+            None => {
+                return Ok(self
+                    .detect_at(input, &shape, 0..self.order.len())?
+                    .map(|(_, result)| result))
+            }
+        };
+
+        // Merge the positions of the unindexed converters with those of the
+        // converters with a matching fingerprint, such that they are checked
+        // in order.
+        let mut unindexed = self.unindexed.iter().copied().peekable();
+        let mut indexed = self
+            .indexed
+            .get(&fingerprint)
+            .into_iter()
+            .flatten()
+            .copied()
+            .peekable();
+        let candidates =
+            std::iter::from_fn(
+                || match (unindexed.peek().copied(), indexed.peek().copied()) {
+                    (Some(a), Some(b)) if a < b => unindexed.next(),
+                    (Some(_), None) => unindexed.next(),
+                    _ => indexed.next(),
+                },
+            );
+        let found = self.detect_at(input, &shape, candidates)?;
+
+        // An earlier converter with a different fingerprint still takes
+        // precedence over the one found through the index.
+        let end = found
+            .as_ref()
+            .map_or(self.order.len(), |(position, _)| *position);
+        let remaining = self.order[..end]
+            .iter()
+            .enumerate()
+            .filter(|(_, (_, filter))| filter.fingerprint.map_or(false, |f| f != fingerprint))
+            .map(|(position, _)| position);
+        let shape = GateShape {
+            fingerprint: None,
+            ..shape
+        };
+        Ok(self
+            .detect_at(input, &shape, remaining)?
+            .or(found)
+            .map(|(_, result)| result))
+    }
+
+    /// Checks the converters at the given positions in `order` in turn,
+    /// skipping those that cannot match the given shape. Returns the position
+    /// of the first matching converter along with its result.
+    fn detect_at(
+        &self,
+        input: &I,
+        shape: &GateShape,
+        positions: impl Iterator<Item = usize>,
+    ) -> Result<Option<(usize, (K, O))>> {
+        positions
+            .map(|position| (position, &self.order[position]))
+            .filter(|(_, (_, filter))| filter.matches(shape))
+            .find_map(|(position, (k, _))| {
+                self.converters[k]
+                    .detect(input)
+                    .map(|res| res.map(|output| (position, (k.clone(), output))))
+                    .transpose()
+            })
+            .transpose()
+    }
 }
 
 impl<'c, I, K, O> Converter for ConverterMap<'c, K, I, O>
 where
     K: Eq + Hash + Clone,
-    I: Eq + Hash + Clone,
+    I: Eq + Hash + Clone + Shaped,
     O: Clone,
 {
     type Input = I;
     type Output = (K, O);
 
     fn detect(&self, input: &I) -> Result<Option<(K, O)>> {
+        // Bypass the cache entirely for inputs that are not worth caching.
+        if !input.cacheable() {
+            return self.detect_uncached(input);
+        }
+
         // Get the cache key for this input.
         let cache_key = (self.cache_key_generator)(input);
 
         // Check the cache.
-        if let Some(hit) = self.cache.borrow().get(&cache_key) {
+        if let Some(hit) = self.cache.borrow_mut().get(&cache_key) {
             // Cache hit. If we're fully cached, we can return the output
             // immediately. If we're not fully cached, we need to call the
             // detector function that matched this input the previous time.
@@ -1095,20 +1669,12 @@ where
                 return Ok(None);
             }
         }
-        // Cache miss. Check all converters in order.
-        self.order
-            .iter()
-            .find_map(|k| {
-                self.converters[k]
-                    .detect(input)
-                    .map(|res| res.map(|output| (k.clone(), output)))
-                    .transpose()
-            })
-            .transpose()
-            .map(|output| {
-                self.cache.borrow_mut().insert(cache_key, output.clone());
-                output
-            })
+
+        // Cache miss.
+        self.detect_uncached(input).map(|output| {
+            self.cache.borrow_mut().insert(cache_key, output.clone());
+            output
+        })
     }
 
     fn construct(&self, input: &(K, O)) -> Result<I> {
@@ -2044,4 +2610,292 @@ mod tests {
             ))
         );
     }
+
+    #[test]
+    fn detection_cache() {
+        let mut cache: DetectionCache<u32, &str> = DetectionCache::new(2);
+        assert_eq!(cache.get(&1), None);
+        cache.insert(1, "a");
+        cache.insert(2, "b");
+        assert_eq!(cache.get(&1), Some(&"a"));
+        cache.insert(3, "c");
+        assert_eq!(cache.get(&2), None);
+        assert_eq!(cache.get(&1), Some(&"a"));
+        assert_eq!(cache.get(&3), Some(&"c"));
+        assert_eq!((cache.hits, cache.misses), (3, 2));
+
+        // Replacing an entry does not evict anything.
+        cache.insert(3, "d");
+        assert_eq!(cache.get(&1), Some(&"a"));
+        assert_eq!(cache.get(&3), Some(&"d"));
+        assert_eq!(cache.entries.len(), cache.recency.len());
+
+        cache.retain(|v| v != &"a");
+        assert_eq!(cache.get(&1), None);
+        assert_eq!(cache.entries.len(), cache.recency.len());
+
+        cache.set_capacity(0);
+        cache.insert(4, "d");
+        assert_eq!(cache.get(&3), None);
+        assert_eq!(cache.get(&4), None);
+        assert!(cache.recency.is_empty());
+    }
+
+    #[test]
+    fn converter_map_filter() {
+        let mut map: ConverterMap<UnitaryGateType, Gate, (Vec<QubitRef>, ArbData)> =
+            ConverterMap::default()
+                .with(
+                    UnitaryGateType::RX,
+                    UnitaryGateType::RX.into_gate_converter(Some(0), 0.001, false),
+                )
+                .with(
+                    UnitaryGateType::SWAP,
+                    UnitaryGateType::SWAP.into_gate_converter(None, 0.001, false),
+                )
+                .with(
+                    UnitaryGateType::U(1),
+                    UnitaryGateType::U(1).into_gate_converter(None, 0., false),
+                );
+
+        assert_eq!(
+            map.order.iter().map(|(_, f)| f.clone()).collect::<Vec<_>>(),
+            vec![
+                GateFilter {
+                    gate_type: Some(GateType::Unitary),
+                    num_targets: Some(1),
+                    num_controls: Some(0),
+                    num_measures: None,
+                    fingerprint: None,
+                },
+                GateFilter {
+                    gate_type: Some(GateType::Unitary),
+                    num_targets: Some(2),
+                    num_controls: None,
+                    num_measures: None,
+                    fingerprint: Some(Matrix::from(UnboundUnitaryGate::SWAP).fingerprint()),
+                },
+                GateFilter {
+                    gate_type: Some(GateType::Unitary),
+                    num_targets: Some(1),
+                    num_controls: None,
+                    num_measures: None,
+                    fingerprint: None,
+                },
+            ]
+        );
+
+        let q1 = QubitRef::from_foreign(1).unwrap();
+        let q2 = QubitRef::from_foreign(2).unwrap();
+        let swap = Gate::from(BoundUnitaryGate::SWAP(q1, q2));
+        let cx =
+            Gate::new_unitary(vec![q1], vec![q2], Matrix::from(UnboundUnitaryGate::X)).unwrap();
+        assert_eq!(
+            map.detect(&swap).unwrap().map(|(k, _)| k),
+            Some(UnitaryGateType::SWAP)
+        );
+        assert_eq!(
+            map.detect(&cx).unwrap().map(|(k, _)| k),
+            Some(UnitaryGateType::U(1))
+        );
+        assert_eq!(
+            map.detect(&swap).unwrap().map(|(k, _)| k),
+            Some(UnitaryGateType::SWAP)
+        );
+        assert_eq!((map.cache_hits(), map.cache_misses()), (1, 2));
+
+        map.set_cache_capacity(1);
+        assert_eq!(map.cache_capacity(), 1);
+        map.detect(&cx).unwrap();
+        map.detect(&cx).unwrap();
+        assert_eq!((map.cache_hits(), map.cache_misses()), (2, 3));
+        map.detect(&swap).unwrap();
+        assert_eq!((map.cache_hits(), map.cache_misses()), (2, 4));
+    }
+
+    #[test]
+    fn converter_map_fingerprint() {
+        let phase = |cos: f64| {
+            let theta = cos.acos();
+            Matrix::new(vec![
+                c!(1.),
+                c!(0.),
+                c!(0.),
+                Complex64::new(theta.cos(), theta.sin()),
+            ])
+            .unwrap()
+        };
+        let mut map: ConverterMap<usize, Gate, (Vec<QubitRef>, ArbData)> = ConverterMap::default()
+            .with(
+                0,
+                UnitaryGateType::X.into_gate_converter(Some(0), 0.001, true),
+            )
+            .with(
+                1,
+                UnitaryGateType::H.into_gate_converter(Some(0), 0.001, true),
+            )
+            .with(
+                2,
+                UnitaryGateType::RX.into_gate_converter(Some(0), 0.001, true),
+            )
+            .with(
+                3,
+                Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
+                    FixedMatrixConverter::from(phase(1000.5 / 1024. - 1.0e-6)),
+                    Some(0),
+                    0.01,
+                    true,
+                ))),
+            );
+        assert_eq!(map.unindexed, vec![2]);
+        assert_eq!(map.indexed.values().map(Vec::len).sum::<usize>(), 3);
+        map.set_cache_capacity(0);
+
+        let q1 = QubitRef::from_foreign(1).unwrap();
+        let gate = |matrix: Matrix| Gate::new_unitary(vec![q1], vec![], matrix).unwrap();
+
+        // Converters are found through the index regardless of global phase,
+        // but unindexed converters earlier in the order still take
+        // precedence.
+        let mut h = Matrix::from(UnboundUnitaryGate::H);
+        for i in 0..h.len() {
+            h[i] *= Complex64::new(0., 1.);
+        }
+        assert_eq!(map.detect(&gate(h)).unwrap().map(|(k, _)| k), Some(1));
+        assert_eq!(
+            map.detect(&Gate::from(BoundUnitaryGate::X(q1)))
+                .unwrap()
+                .map(|(k, _)| k),
+            Some(0)
+        );
+        assert_eq!(
+            map.detect(&Gate::from(BoundUnitaryGate::RX(PI / 2., q1)))
+                .unwrap()
+                .map(|(k, _)| k),
+            Some(2)
+        );
+        let x = Matrix::from(UnboundUnitaryGate::X);
+        map.insert(
+            0,
+            4,
+            UnitaryGateType::RX.into_gate_converter(Some(0), 0.001, true),
+        );
+        assert_eq!(map.detect(&gate(x)).unwrap().map(|(k, _)| k), Some(4));
+
+        // Matrices that are approximately equal but quantize differently are
+        // still detected.
+        let matrix = phase(1000.5 / 1024. + 1.0e-6);
+        assert_ne!(
+            matrix.fingerprint(),
+            phase(1000.5 / 1024. - 1.0e-6).fingerprint()
+        );
+        assert_eq!(
+            map.detect(&gate(matrix.clone())).unwrap().map(|(k, _)| k),
+            Some(3)
+        );
+        assert_eq!(
+            map.detect(&gate(Matrix::from(UnboundUnitaryGate::Y)))
+                .unwrap()
+                .map(|(k, _)| k),
+            None
+        );
+
+        // This includes the case where a later, unindexed converter matches
+        // as well, as the order of the converters takes precedence.
+        map.push(
+            5,
+            UnitaryGateType::U(1).into_gate_converter(Some(0), 0.001, true),
+        );
+        assert_eq!(map.detect(&gate(matrix)).unwrap().map(|(k, _)| k), Some(3));
+        assert_eq!(
+            map.detect(&gate(Matrix::from(UnboundUnitaryGate::Y)))
+                .unwrap()
+                .map(|(k, _)| k),
+            Some(5)
+        );
+    }
+
+    #[test]
+    fn predefined_gate_tag() {
+        let q1 = QubitRef::from_foreign(1).unwrap();
+        let q2 = QubitRef::from_foreign(2).unwrap();
+        let converter =
+            PredefinedGateConverter::new(UnitaryGateType::X, Some(1), 0., false).unwrap();
+        let cnot = converter
+            .construct(&(vec![q1, q2], ArbData::default()))
+            .unwrap();
+        assert_eq!(cnot.get_predefined(), Some(UnitaryGateType::X));
+        assert_eq!(cnot.get_controls(), &[q1]);
+        assert_eq!(
+            converter.detect(&cnot).unwrap().map(|(q, _)| q),
+            Some(vec![q1, q2])
+        );
+
+        // Untagged gates are detected by their matrix, and the tag does not
+        // affect gate equality.
+        let untagged =
+            Gate::new_unitary(vec![q2], vec![q1], Matrix::from(UnboundUnitaryGate::X)).unwrap();
+        assert_eq!(untagged.get_predefined(), None);
+        assert_eq!(untagged, cnot);
+        assert_eq!(
+            converter.detect(&untagged).unwrap().map(|(q, _)| q),
+            Some(vec![q1, q2])
+        );
+
+        // The number of controls is still checked for tagged gates.
+        let x = Gate::from(BoundUnitaryGate::X(q1));
+        assert_eq!(x.get_predefined(), Some(UnitaryGateType::X));
+        assert_eq!(converter.detect(&x).unwrap(), None);
+
+        assert!(PredefinedGateConverter::new(UnitaryGateType::R, None, 0., false).is_err());
+    }
+
+    #[test]
+    fn symbolic_rotation() {
+        let q1 = QubitRef::from_foreign(1).unwrap();
+        let q2 = QubitRef::from_foreign(2).unwrap();
+        let map: ConverterMap<UnitaryGateType, Gate, (Vec<QubitRef>, ArbData)> =
+            ConverterMap::default().with(
+                UnitaryGateType::RX,
+                UnitaryGateType::RX.into_gate_converter(Some(1), 0.001, false),
+            );
+        let mut data = ArbData::default();
+        0.25f64.to_arb(&mut data);
+        let crx = map
+            .construct(&(UnitaryGateType::RX, (vec![q1, q2], data)))
+            .unwrap();
+        assert_eq!(crx.get_predefined_angle(), Some(0.25));
+        assert_eq!(crx.get_controls(), &[q1]);
+
+        // Detection of a symbolic rotation reads the angle directly and does
+        // not go through the cache.
+        let (key, (qubits, mut data)) = map.detect(&crx).unwrap().unwrap();
+        assert_eq!(key, UnitaryGateType::RX);
+        assert_eq!(qubits, vec![q1, q2]);
+        assert_eq!(f64::from_arb(&mut data).unwrap(), 0.25);
+        assert_eq!((map.cache_hits(), map.cache_misses()), (0, 0));
+
+        // The matrix is computed on demand, and equals the matrix of an
+        // explicitly constructed gate.
+        let explicit = Gate::new_unitary(
+            vec![q2],
+            vec![q1],
+            Matrix::from(UnboundUnitaryGate::RX(0.25)),
+        )
+        .unwrap();
+        assert_eq!(crx.get_matrix(), explicit.get_matrix());
+        assert_eq!(crx, explicit);
+        let (_, (_, mut data)) = map.detect(&explicit).unwrap().unwrap();
+        assert!(approx_eq!(
+            f64,
+            f64::from_arb(&mut data).unwrap(),
+            0.25,
+            epsilon = 0.0001
+        ));
+        assert_eq!((map.cache_hits(), map.cache_misses()), (0, 1));
+
+        assert!(map
+            .construct(&(UnitaryGateType::RX, (vec![q1], ArbData::default())))
+            .is_err());
+    }
 }
@@ -237,6 +237,15 @@ impl From<serde_json::Error> for Error {
     }
 }
 
+impl From<serde_cbor::Error> for Error {
+    fn from(error: serde_cbor::Error) -> Error {
+        let msg = error.to_string();
+        Error {
+            ctx: Context::new(ErrorKind::InvalidArgument(msg)),
+        }
+    }
+}
+
 impl From<std::str::Utf8Error> for Error {
     fn from(error: std::str::Utf8Error) -> Error {
         let msg = error.to_string();
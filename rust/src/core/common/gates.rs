@@ -2,7 +2,9 @@
 //!
 //! The types defined here are provided to facilitate plugin developers. They
 //! are not to be confused with the [`Gate`] type used in gatestream
-//! [`protocol`], and are not relied on in the core of DQCsim.
+//! [`protocol`], and are not relied on in the core of DQCsim, except that
+//! gates carry the [`UnitaryGateType`] they were constructed from as a hint
+//! if it is not parameterized or a rotation.
 //!
 //! The following gate types are defined in this module:
 //!
@@ -40,11 +42,13 @@
 use crate::common::{
     converter::{
         Converter, FixedMatrixConverter, MatrixConverterArb, PhaseKMatrixConverter,
-        PhaseMatrixConverter, RMatrixConverter, RxMatrixConverter, RyMatrixConverter,
-        RzMatrixConverter, UMatrixConverter, UnitaryConverter, UnitaryGateConverter,
+        PhaseMatrixConverter, PredefinedGateConverter, RMatrixConverter, RxMatrixConverter,
+        RyMatrixConverter, RzMatrixConverter, UMatrixConverter, UnitaryConverter,
+        UnitaryGateConverter,
     },
     types::{ArbData, Gate, Matrix, QubitRef},
 };
+use serde::{Deserialize, Serialize};
 use std::{
     convert::{TryFrom, TryInto},
     f64::consts::{FRAC_1_SQRT_2, PI},
@@ -58,7 +62,7 @@ use std::{
 /// specified.
 ///
 /// [`UnitaryGateType::U`]: ./enum.UnitaryGateType.html#variant.U
-#[derive(Clone, Copy, Debug, PartialEq, Hash, Eq)]
+#[derive(Clone, Copy, Debug, PartialEq, Hash, Eq, Serialize, Deserialize)]
 pub enum UnitaryGateType {
     /// Identity.
     I,
@@ -298,8 +302,23 @@ impl From<BoundUnitaryGate<'_, '_>> for Matrix {
 
 impl From<BoundUnitaryGate<'_, '_>> for Gate {
     fn from(bound_gate: BoundUnitaryGate<'_, '_>) -> Gate {
-        let matrix = Matrix::from(bound_gate);
         match bound_gate {
+            BoundUnitaryGate::RX(theta, q) => {
+                return Gate::new_rotation(UnitaryGateType::RX, theta, q, vec![]).unwrap()
+            }
+            BoundUnitaryGate::RY(theta, q) => {
+                return Gate::new_rotation(UnitaryGateType::RY, theta, q, vec![]).unwrap()
+            }
+            BoundUnitaryGate::RZ(theta, q) => {
+                return Gate::new_rotation(UnitaryGateType::RZ, theta, q, vec![]).unwrap()
+            }
+            BoundUnitaryGate::Phase(theta, q) => {
+                return Gate::new_rotation(UnitaryGateType::Phase, theta, q, vec![]).unwrap()
+            }
+            _ => (),
+        }
+        let matrix = Matrix::from(bound_gate);
+        let mut gate = match bound_gate {
             BoundUnitaryGate::I(q)
             | BoundUnitaryGate::X(q)
             | BoundUnitaryGate::Y(q)
@@ -329,7 +348,12 @@ impl From<BoundUnitaryGate<'_, '_>> for Gate {
             }
             BoundUnitaryGate::U(matrix, q) => Gate::new_unitary(q.to_vec(), vec![], matrix.clone()),
         }
-        .unwrap()
+        .unwrap();
+        let gate_type = UnitaryGateType::from(bound_gate);
+        if !gate_type.is_parameterized() {
+            gate.set_predefined(gate_type);
+        }
+        gate
     }
 }
 
@@ -581,6 +605,32 @@ impl From<UnitaryGateType> for Box<dyn MatrixConverterArb> {
 }
 
 impl UnitaryGateType {
+    /// Returns whether the matrix of this gate type depends on parameters.
+    pub fn is_parameterized(self) -> bool {
+        match self {
+            UnitaryGateType::RX
+            | UnitaryGateType::RY
+            | UnitaryGateType::RZ
+            | UnitaryGateType::Phase
+            | UnitaryGateType::PhaseK
+            | UnitaryGateType::R
+            | UnitaryGateType::U(_) => true,
+            _ => false,
+        }
+    }
+
+    /// Returns whether this gate type is a single-qubit rotation that is fully
+    /// described by a single angle.
+    pub fn is_rotation(self) -> bool {
+        match self {
+            UnitaryGateType::RX
+            | UnitaryGateType::RY
+            | UnitaryGateType::RZ
+            | UnitaryGateType::Phase => true,
+            _ => false,
+        }
+    }
+
     pub fn into_gate_converter(
         self,
         num_controls: Option<usize>,
@@ -588,30 +638,6 @@ impl UnitaryGateType {
         ignore_global_phase: bool,
     ) -> Box<dyn Converter<Input = Gate, Output = (Vec<QubitRef>, ArbData)>> {
         match self {
-            UnitaryGateType::RX => Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
-                RxMatrixConverter::default(),
-                num_controls,
-                epsilon,
-                ignore_global_phase,
-            ))),
-            UnitaryGateType::RY => Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
-                RyMatrixConverter::default(),
-                num_controls,
-                epsilon,
-                ignore_global_phase,
-            ))),
-            UnitaryGateType::RZ => Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
-                RzMatrixConverter::default(),
-                num_controls,
-                epsilon,
-                ignore_global_phase,
-            ))),
-            UnitaryGateType::Phase => Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
-                PhaseMatrixConverter::default(),
-                num_controls,
-                epsilon,
-                ignore_global_phase,
-            ))),
             UnitaryGateType::PhaseK => Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
                 PhaseKMatrixConverter::default(),
                 num_controls,
@@ -632,12 +658,10 @@ impl UnitaryGateType {
                     ignore_global_phase,
                 )))
             }
-            _ => Box::new(UnitaryGateConverter::from(UnitaryConverter::new(
-                FixedMatrixConverter::from(Matrix::try_from(self).unwrap()),
-                num_controls,
-                epsilon,
-                ignore_global_phase,
-            ))),
+            _ => Box::new(
+                PredefinedGateConverter::new(self, num_controls, epsilon, ignore_global_phase)
+                    .unwrap(),
+            ),
         }
     }
 }
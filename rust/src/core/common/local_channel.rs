@@ -0,0 +1,307 @@
+//! In-process channel implementation.
+//!
+//! Defines a single-producer single-consumer channel that moves messages
+//! between threads of the same process through a `crossbeam_channel`, as an
+//! alternative to the channels of [`ipc_channel`] and [`shm_channel`] for
+//! plugins that run as threads within the simulator. Messages are moved
+//! as-is; they are never serialized.
+//!
+//! Like a shared-memory channel, each channel has an auxiliary
+//! `ipc_channel` doorbell, through which the producer wakes up the consumer
+//! when the consumer is parked (and only then), such that the consumer can
+//! wait on it together with all its other channels using an
+//! `IpcReceiverSet`.
+//!
+//! Channels are constructed in one thread using [`local_channel`] or
+//! [`local_channel_rev`]. These return the local side of the channel, and a
+//! serializable handle for the other side that can be sent to the peer
+//! thread through any `ipc_channel` channel, where it is opened using
+//! `open()`. Because the crossbeam endpoints themselves cannot be
+//! serialized, they are kept in a process-wide table until the handle is
+//! opened; the handle only carries the key into this table. Opening a handle
+//! in a different process than the one it was constructed in therefore
+//! fails.
+//!
+//! [`ipc_channel`]: ../../../ipc_channel/index.html
+//! [`shm_channel`]: ../shm_channel/index.html
+//! [`local_channel`]: ./fn.local_channel.html
+//! [`local_channel_rev`]: ./fn.local_channel_rev.html
+
+use crate::common::{
+    channel::{Receiver, Sender},
+    error::{inv_arg, Error, Result},
+};
+use crossbeam_channel::TryRecvError;
+use ipc_channel::ipc;
+use lazy_static::lazy_static;
+use serde::{Deserialize, Serialize};
+use std::{
+    any::Any,
+    collections::HashMap,
+    marker::PhantomData,
+    sync::{
+        atomic::{AtomicBool, AtomicU64, Ordering},
+        Arc, Mutex,
+    },
+};
+
+lazy_static! {
+    /// Channel endpoints that have not been claimed by their handle yet.
+    static ref ENDPOINTS: Mutex<HashMap<u64, Box<dyn Any + Send>>> = Mutex::new(HashMap::new());
+}
+
+/// Source of the keys into `ENDPOINTS`.
+static NEXT_KEY: AtomicU64 = AtomicU64::new(0);
+
+/// Stores a channel endpoint in the process-wide table, returning its key.
+fn register(endpoint: Box<dyn Any + Send>) -> u64 {
+    let key = NEXT_KEY.fetch_add(1, Ordering::Relaxed);
+    ENDPOINTS.lock().unwrap().insert(key, endpoint);
+    key
+}
+
+/// Takes a channel endpoint out of the process-wide table.
+fn claim<E: 'static>(pid: u32, key: u64) -> Result<E> {
+    if pid != std::process::id() {
+        return inv_arg("in-process channel handle opened in a different process");
+    }
+    match ENDPOINTS.lock().unwrap().remove(&key) {
+        Some(endpoint) => Ok(*endpoint
+            .downcast::<E>()
+            .expect("in-process channel endpoint has unexpected type")),
+        None => inv_arg("in-process channel handle was already opened"),
+    }
+}
+
+/// Sender side of an in-process channel.
+#[derive(Debug)]
+pub struct LocalSender<T> {
+    /// The channel that the messages are moved through.
+    sender: crossbeam_channel::Sender<T>,
+
+    /// Set by the consumer when it is about to block on the doorbell.
+    parked: Arc<AtomicBool>,
+
+    /// Doorbell used to wake up the consumer when it is parked.
+    doorbell: ipc::IpcSender<()>,
+}
+
+/// Receiver side of an in-process channel.
+#[derive(Debug)]
+pub struct LocalReceiver<T> {
+    /// The channel that the messages are moved through.
+    receiver: crossbeam_channel::Receiver<T>,
+
+    /// Set when we're about to block on the doorbell.
+    parked: Arc<AtomicBool>,
+
+    /// Doorbell used by the producer to wake us up when we're parked. This
+    /// is taken out of the receiver when the doorbell is to be waited upon
+    /// through an `IpcReceiverSet`.
+    doorbell: Option<ipc::IpcReceiver<()>>,
+}
+
+/// Serializable handle to the sender side of an in-process channel, to be
+/// sent to and opened by the producer thread.
+#[derive(Debug, Serialize, Deserialize)]
+#[serde(bound = "")]
+pub struct LocalSenderHandle<T> {
+    pid: u32,
+    key: u64,
+    doorbell: ipc::IpcSender<()>,
+    phantom: PhantomData<T>,
+}
+
+/// Serializable handle to the receiver side of an in-process channel, to be
+/// sent to and opened by the consumer thread.
+#[derive(Debug, Serialize, Deserialize)]
+#[serde(bound = "")]
+pub struct LocalReceiverHandle<T> {
+    pid: u32,
+    key: u64,
+    doorbell: ipc::IpcReceiver<()>,
+    phantom: PhantomData<T>,
+}
+
+/// Constructs an in-process channel of which this thread is the producer.
+///
+/// The returned receiver handle is to be sent to the consumer thread.
+pub fn local_channel<T: Send + 'static>() -> Result<(LocalSender<T>, LocalReceiverHandle<T>)> {
+    let (sender, receiver) = crossbeam_channel::unbounded::<T>();
+    let parked = Arc::new(AtomicBool::new(false));
+    let (doorbell_tx, doorbell_rx) = ipc::channel()?;
+    let key = register(Box::new((receiver, parked.clone())));
+    Ok((
+        LocalSender {
+            sender,
+            parked,
+            doorbell: doorbell_tx,
+        },
+        LocalReceiverHandle {
+            pid: std::process::id(),
+            key,
+            doorbell: doorbell_rx,
+            phantom: PhantomData,
+        },
+    ))
+}
+
+/// Constructs an in-process channel of which this thread is the consumer.
+///
+/// The returned sender handle is to be sent to the producer thread.
+pub fn local_channel_rev<T: Send + 'static>() -> Result<(LocalSenderHandle<T>, LocalReceiver<T>)> {
+    let (sender, receiver) = crossbeam_channel::unbounded::<T>();
+    let parked = Arc::new(AtomicBool::new(false));
+    let (doorbell_tx, doorbell_rx) = ipc::channel()?;
+    let key = register(Box::new((sender, parked.clone())));
+    Ok((
+        LocalSenderHandle {
+            pid: std::process::id(),
+            key,
+            doorbell: doorbell_tx,
+            phantom: PhantomData,
+        },
+        LocalReceiver {
+            receiver,
+            parked,
+            doorbell: Some(doorbell_rx),
+        },
+    ))
+}
+
+impl<T: Send + 'static> LocalSenderHandle<T> {
+    /// Claims the sender side of the channel.
+    pub fn open(self) -> Result<LocalSender<T>> {
+        let (sender, parked) = claim(self.pid, self.key)?;
+        Ok(LocalSender {
+            sender,
+            parked,
+            doorbell: self.doorbell,
+        })
+    }
+}
+
+impl<T: Send + 'static> LocalReceiverHandle<T> {
+    /// Claims the receiver side of the channel.
+    pub fn open(self) -> Result<LocalReceiver<T>> {
+        let (receiver, parked) = claim(self.pid, self.key)?;
+        Ok(LocalReceiver {
+            receiver,
+            parked,
+            doorbell: Some(self.doorbell),
+        })
+    }
+}
+
+impl<T> Sender for LocalSender<T> {
+    type Item = T;
+    type Error = Error;
+
+    fn send(&self, item: Self::Item) -> Result<()> {
+        self.sender.send(item)?;
+
+        // Only ring the doorbell when the consumer is parked. The consumer
+        // may be parked without waiting for us, in which case the doorbell
+        // message is simply ignored.
+        if self.parked.load(Ordering::SeqCst) && self.parked.swap(false, Ordering::SeqCst) {
+            self.doorbell.send(())?;
+        }
+        Ok(())
+    }
+}
+
+impl<T> LocalReceiver<T> {
+    /// Takes the doorbell receiver out of this receiver, such that it can be
+    /// waited upon along with other channels through an `IpcReceiverSet`.
+    /// The messages received through the doorbell carry no information; they
+    /// only indicate that `try_recv()` should be called.
+    ///
+    /// After this, `recv()` can no longer block efficiently; it falls back to
+    /// polling.
+    pub fn take_doorbell(&mut self) -> Option<ipc::IpcReceiver<()>> {
+        self.doorbell.take()
+    }
+
+    /// Receives a message if one is available, without blocking.
+    ///
+    /// A disconnected producer is not reported here; it is detected through
+    /// the doorbell channel closing.
+    pub fn try_recv(&self) -> Result<Option<T>> {
+        match self.receiver.try_recv() {
+            Ok(item) => Ok(Some(item)),
+            Err(TryRecvError::Empty) | Err(TryRecvError::Disconnected) => Ok(None),
+        }
+    }
+
+    /// Tells the producer that we're about to block on the doorbell.
+    ///
+    /// Returns false if a message became available in the meantime, in which
+    /// case the caller should not block but call `try_recv()` instead.
+    pub fn park(&self) -> bool {
+        self.parked.store(true, Ordering::SeqCst);
+        if !self.receiver.is_empty() {
+            self.parked.store(false, Ordering::SeqCst);
+            false
+        } else {
+            true
+        }
+    }
+}
+
+impl<T> Receiver for LocalReceiver<T> {
+    type Item = T;
+    type Error = Error;
+
+    fn recv(&self) -> Result<Self::Item> {
+        loop {
+            if let Some(item) = self.try_recv()? {
+                return Ok(item);
+            }
+            if self.park() {
+                if let Some(doorbell) = self.doorbell.as_ref() {
+                    doorbell.recv()?;
+                } else {
+                    std::thread::yield_now();
+                }
+            }
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn open_once() {
+        let (_tx, rx) = local_channel::<u32>().unwrap();
+        let LocalReceiverHandle { pid, key, .. } = rx;
+        assert!(
+            claim::<(crossbeam_channel::Receiver<u32>, Arc<AtomicBool>)>(pid + 1, key).is_err()
+        );
+        assert!(claim::<(crossbeam_channel::Receiver<u32>, Arc<AtomicBool>)>(pid, key).is_ok());
+        assert!(claim::<(crossbeam_channel::Receiver<u32>, Arc<AtomicBool>)>(pid, key).is_err());
+    }
+
+    #[test]
+    fn threaded() {
+        let (tx, mut rx) = local_channel_rev::<Vec<u64>>().unwrap();
+        let doorbell = rx.take_doorbell().unwrap();
+        let producer = std::thread::spawn(move || {
+            let tx = tx.open().unwrap();
+            for i in 0..10000 {
+                tx.send(vec![i]).unwrap();
+            }
+        });
+        let mut expected = 0;
+        while expected < 10000 {
+            if let Some(i) = rx.try_recv().unwrap() {
+                assert_eq!(i, vec![expected]);
+                expected += 1;
+            } else if rx.park() {
+                doorbell.recv().unwrap();
+            }
+        }
+        producer.join().unwrap();
+    }
+}
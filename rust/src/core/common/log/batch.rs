@@ -0,0 +1,208 @@
+//! A batching log proxy implementation.
+//!
+//! This module defines the [`BatchProxy`] struct and implements the [`Log`]
+//! trait for it.
+//!
+//! # Use
+//!
+//! Plugins use a [`BatchProxy`] to send their log records to the log thread
+//! of the simulator. Instead of sending every record as a separate IPC
+//! message, records are collected in a thread-local buffer and sent as a
+//! single message when one of the following happens:
+//!
+//!  - the buffer holds [`MAX_BATCH_SIZE`] records;
+//!  - a record is logged while the oldest buffered record is older than
+//!    [`MAX_BATCH_AGE`];
+//!  - a record with loglevel `Warn` or more severe is logged, such that
+//!    problems are reported right away;
+//!  - [`Log::flush()`] is called, which plugins do before blocking and before
+//!    responding to the simulator;
+//!  - a record is logged while the thread is panicking, such that nothing
+//!    logged during unwinding is held back;
+//!  - the proxy is dropped, which also happens when a plugin thread exits
+//!    because of a panic.
+//!
+//! There is no timer: the age of the buffer is only checked when a record is
+//! logged. A record logged right before a long computation that does not log
+//! anything is therefore held back until that computation is done, and the
+//! plugin logs another record, blocks, or responds to the simulator.
+//!
+//! When a plugin process is killed or aborts, for instance due to a
+//! segmentation fault, the records that were still buffered are lost. These
+//! are less severe than `Warn` and were all logged since the plugin last
+//! blocked or responded to the simulator, but may include the debug messages
+//! leading up to the crash.
+//!
+//! [`BatchProxy`]: ./struct.BatchProxy.html
+//! [`Log`]: ../trait.Log.html
+//! [`Log::flush()`]: ../trait.Log.html#method.flush
+//! [`MAX_BATCH_SIZE`]: ./constant.MAX_BATCH_SIZE.html
+//! [`MAX_BATCH_AGE`]: ./constant.MAX_BATCH_AGE.html
+
+use crate::common::log::{Log, LogRecord, Loglevel, LoglevelFilter, Sender};
+use std::{
+    cell::{Cell, RefCell},
+    time::{Duration, Instant},
+};
+
+/// The maximum number of records sent in a single batch.
+pub const MAX_BATCH_SIZE: usize = 256;
+
+/// The maximum amount of time a record is buffered before the batch is sent,
+/// as long as records keep coming in. The age is only checked when a record
+/// is logged.
+pub const MAX_BATCH_AGE: Duration = Duration::from_millis(10);
+
+/// A [`BatchProxy`] is a logger implementation (`Log`) which buffers log
+/// records and sends them in batches using its Sender side of a Channel.
+///
+/// [`BatchProxy`]: ./struct.BatchProxy.html
+#[derive(Debug)]
+pub struct BatchProxy<T: Sender<Item = Vec<LogRecord>>> {
+    name: String,
+    level: LoglevelFilter,
+    sender: T,
+    buffer: RefCell<Vec<LogRecord>>,
+    oldest: Cell<Option<Instant>>,
+}
+
+impl<T: Sender<Item = Vec<LogRecord>>> BatchProxy<T> {
+    fn new(name: impl Into<String>, level: LoglevelFilter, sender: T) -> BatchProxy<T> {
+        BatchProxy {
+            name: name.into(),
+            level,
+            sender,
+            buffer: RefCell::new(Vec::with_capacity(MAX_BATCH_SIZE)),
+            oldest: Cell::new(None),
+        }
+    }
+
+    /// Return a new boxed BatchProxy for the provided sender and level.
+    pub fn boxed(name: impl Into<String>, level: LoglevelFilter, sender: T) -> Box<BatchProxy<T>> {
+        Box::new(BatchProxy::new(name, level, sender))
+    }
+
+    /// Sends the buffered records, if any.
+    fn ship(&self) -> Result<(), T::Error> {
+        self.oldest.set(None);
+        let batch = self.buffer.replace(Vec::with_capacity(MAX_BATCH_SIZE));
+        if batch.is_empty() {
+            Ok(())
+        } else {
+            self.sender.send(batch)
+        }
+    }
+}
+
+impl<T: Sender<Item = Vec<LogRecord>>> Log for BatchProxy<T> {
+    fn name(&self) -> &str {
+        self.name.as_ref()
+    }
+    fn enabled(&self, level: Loglevel) -> bool {
+        LoglevelFilter::from(level) <= self.level
+    }
+    fn log(&self, record: &LogRecord) {
+        let len = {
+            let mut buffer = self.buffer.borrow_mut();
+            buffer.push(record.clone());
+            buffer.len()
+        };
+        let oldest = match self.oldest.get() {
+            Some(oldest) => oldest,
+            None => {
+                let now = Instant::now();
+                self.oldest.set(Some(now));
+                now
+            }
+        };
+        if len >= MAX_BATCH_SIZE
+            || record.level() <= Loglevel::Warn
+            || oldest.elapsed() >= MAX_BATCH_AGE
+            || std::thread::panicking()
+        {
+            self.flush();
+        }
+    }
+    fn flush(&self) {
+        let result = self.ship();
+        // Panicking while already panicking would abort, losing the original
+        // panic message as well.
+        if !std::thread::panicking() {
+            result.expect("BatchProxy failed to send records");
+        }
+    }
+}
+
+impl<T: Sender<Item = Vec<LogRecord>>> Drop for BatchProxy<T> {
+    fn drop(&mut self) {
+        // Don't panic when the receiver is already gone; there's nobody left
+        // to report the records to anyway.
+        self.ship().ok();
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn record(level: Loglevel) -> LogRecord {
+        LogRecord::new("logger", "message", level, "path", "file", 1, 1, 1)
+    }
+
+    #[test]
+    fn batching() {
+        let (sender, receiver) = crossbeam_channel::unbounded();
+        let proxy = BatchProxy::boxed("batch", LoglevelFilter::Trace, sender);
+
+        // Informational records are buffered.
+        proxy.log(&record(Loglevel::Info));
+        proxy.log(&record(Loglevel::Debug));
+        assert!(receiver.try_recv().is_err());
+
+        // Flushing sends them as a single batch.
+        proxy.flush();
+        assert_eq!(receiver.try_recv().unwrap().len(), 2);
+        proxy.flush();
+        assert!(receiver.try_recv().is_err());
+
+        // Warnings are sent right away, along with what was buffered.
+        proxy.log(&record(Loglevel::Trace));
+        proxy.log(&record(Loglevel::Warn));
+        assert_eq!(receiver.try_recv().unwrap().len(), 2);
+
+        // Full batches are sent right away.
+        for _ in 0..MAX_BATCH_SIZE {
+            proxy.log(&record(Loglevel::Trace));
+        }
+        assert_eq!(receiver.try_recv().unwrap().len(), MAX_BATCH_SIZE);
+
+        // Dropping the proxy sends the remainder.
+        proxy.log(&record(Loglevel::Trace));
+        drop(proxy);
+        assert_eq!(receiver.try_recv().unwrap().len(), 1);
+        assert!(receiver.try_recv().is_err());
+    }
+
+    #[test]
+    fn panicking() {
+        struct LogOnDrop<'a>(&'a dyn Log);
+        impl<'a> Drop for LogOnDrop<'a> {
+            fn drop(&mut self) {
+                self.0.log(&record(Loglevel::Trace));
+            }
+        }
+
+        let (sender, receiver) = crossbeam_channel::unbounded();
+        let proxy = BatchProxy::boxed("batch", LoglevelFilter::Trace, sender);
+
+        // Records logged while unwinding are sent right away, along with
+        // what was buffered.
+        proxy.log(&record(Loglevel::Debug));
+        let result = std::panic::catch_unwind(std::panic::AssertUnwindSafe(|| {
+            let _guard = LogOnDrop(proxy.as_ref());
+            panic!("crash");
+        }));
+        assert!(result.is_err());
+        assert_eq!(receiver.try_recv().unwrap().len(), 2);
+    }
+}
@@ -108,6 +108,7 @@
 #[doc(hidden)]
 pub use ref_thread_local as _ref_thread_local;
 
+pub mod batch;
 pub mod callback;
 pub mod proxy;
 pub mod stdio;
@@ -159,6 +160,8 @@ pub trait Log {
     fn enabled(&self, level: Loglevel) -> bool;
     /// Log the incoming record
     fn log(&self, record: &LogRecord);
+    /// Write out any records that were buffered by this logger
+    fn flush(&self) {}
 }
 
 thread_local! {
@@ -468,6 +471,40 @@ pub fn deinit() -> error::Result<()> {
     update(None)
 }
 
+/// Flush the thread-local loggers.
+///
+/// Loggers may buffer records to reduce the per-record overhead. This writes
+/// out or sends whatever they have buffered.
+pub fn flush() {
+    LOGGERS
+        .try_with(|loggers| {
+            if let Ok(loggers) = loggers.try_borrow() {
+                loggers
+                    .iter()
+                    .flat_map(|loggers| loggers.iter())
+                    .for_each(|logger| logger.flush());
+            }
+        })
+        .ok();
+}
+
+/// Returns whether any of the thread-local loggers accepts records of the
+/// given level, or `None` if no loggers are available in the current thread.
+///
+/// This allows callers to skip composing a message that would be dropped
+/// anyway.
+pub fn enabled(level: Loglevel) -> Option<bool> {
+    LOGGERS
+        .try_with(|loggers| {
+            loggers
+                .try_borrow()
+                .ok()?
+                .as_ref()
+                .map(|loggers| loggers.iter().any(|logger| logger.enabled(level)))
+        })
+        .unwrap_or(None)
+}
+
 #[macro_export]
 macro_rules! log {
     (? target: $target:expr, location: ($file:expr, $line:expr), $lvl:expr, $($arg:tt)+) => ({
@@ -590,7 +627,7 @@ macro_rules! trace {
 
 #[cfg(test)]
 mod tests {
-    use super::{LogRecord, Loglevel, LoglevelFilter};
+    use super::{deinit, enabled, init, Log, LogRecord, Loglevel, LoglevelFilter};
 
     #[test]
     fn level_order() {
@@ -624,6 +661,33 @@ mod tests {
         assert!(Loglevel::try_from(LoglevelFilter::Off).is_err());
     }
 
+    struct FilterLogger(LoglevelFilter);
+
+    impl Log for FilterLogger {
+        fn name(&self) -> &str {
+            "filter"
+        }
+        fn enabled(&self, level: Loglevel) -> bool {
+            LoglevelFilter::from(level) <= self.0
+        }
+        fn log(&self, _: &LogRecord) {}
+    }
+
+    #[test]
+    fn enabled_levels() {
+        assert_eq!(enabled(Loglevel::Fatal), None);
+        init(vec![
+            Box::new(FilterLogger(LoglevelFilter::Warn)),
+            Box::new(FilterLogger(LoglevelFilter::Info)),
+        ])
+        .unwrap();
+        assert_eq!(enabled(Loglevel::Fatal), Some(true));
+        assert_eq!(enabled(Loglevel::Info), Some(true));
+        assert_eq!(enabled(Loglevel::Debug), Some(false));
+        deinit().unwrap();
+        assert_eq!(enabled(Loglevel::Fatal), None);
+    }
+
     #[test]
     fn log_record_debug_getters() {
         let record = LogRecord::new("", "", Loglevel::Debug, "path", "file", 1234u32, 1u32, 1u64);
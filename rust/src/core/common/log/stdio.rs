@@ -1,15 +1,50 @@
 //! Utility function to spawn a log proxy implementation to forward standard i/o streams.
 
 use crate::{
-    common::log::{init, proxy::LogProxy, LogRecord, Loglevel, LoglevelFilter},
+    common::{
+        channel::Sender,
+        log::{init, proxy::LogProxy, LogRecord, Loglevel, LoglevelFilter},
+    },
     error, log, trace,
 };
-use crossbeam_channel::Sender;
 use std::{
     io::Read,
+    sync::{Arc, Mutex},
     thread::{spawn, JoinHandle},
 };
 
+/// Log record sender for standard i/o proxies that can be connected to a
+/// different log thread while the proxy is running.
+///
+/// This is used for plugin processes that outlive the simulation they were
+/// spawned for. Records sent while disconnected are discarded.
+#[derive(Debug, Clone, Default)]
+pub struct StdioTarget(Arc<Mutex<Option<crossbeam_channel::Sender<LogRecord>>>>);
+
+impl StdioTarget {
+    /// Forwards all subsequent records to the given log channel.
+    pub fn connect(&self, sender: crossbeam_channel::Sender<LogRecord>) {
+        self.0.lock().unwrap().replace(sender);
+    }
+
+    /// Releases the current log channel.
+    pub fn disconnect(&self) {
+        self.0.lock().unwrap().take();
+    }
+}
+
+impl Sender for StdioTarget {
+    type Item = LogRecord;
+    type Error = crossbeam_channel::SendError<LogRecord>;
+
+    fn send(&self, item: LogRecord) -> Result<(), Self::Error> {
+        match self.0.lock().unwrap().as_ref() {
+            Some(sender) => sender.send(item),
+            None => Ok(()),
+        }
+    }
+}
+
 /// Forward standard i/o to log channel.
 ///
 /// Spawns a thread which takes a readable stream and forwards lines as log
@@ -20,7 +55,7 @@ use std::{
 pub fn proxy_stdio(
     name: impl Into<String>,
     mut stream: Box<dyn Read + Send>,
-    sender: Sender<LogRecord>,
+    sender: impl Sender<Item = LogRecord> + Send + 'static,
     level: Loglevel,
 ) -> JoinHandle<()> {
     let name = name.into();
@@ -5,7 +5,17 @@ use crate::common::{
 };
 use failure::Fail;
 use serde::{Deserialize, Serialize};
-use std::{fs::File, io::Write, path::PathBuf};
+use std::{
+    cell::{Cell, RefCell},
+    fs::File,
+    io::{BufWriter, Write},
+    path::PathBuf,
+    time::{Duration, Instant},
+};
+
+/// The maximum amount of time between two fsyncs of a tee file, as long as
+/// records keep coming in.
+const SYNC_INTERVAL: Duration = Duration::from_secs(1);
 
 /// Error structure used for reporting TeeFile errors.
 #[derive(Debug, Fail, PartialEq)]
@@ -38,24 +48,52 @@ impl TeeFileConfiguration {
 /// TeeFile is the combination of a TeeFileConfiguration and a handle to the
 /// tee file. TeeFile implements the Log trait and can write log records to
 /// the file.
+///
+/// Records are written through a buffer, which is written out when the
+/// logger is flushed, when a record with loglevel `Warn` or more severe is
+/// logged, and when the file is dropped. The file is synced to disk at most
+/// `SYNC_INTERVAL` after a record was written, as long as records keep
+/// coming in, and when the file is dropped.
 #[derive(Debug)]
 pub struct TeeFile {
     /// The TeeFileConfiguration
     pub configuration: TeeFileConfiguration,
-    /// The file handle, wrapper in an Option to allow implementation of the
-    /// Log trait.
-    buffer: Option<File>,
+    /// The buffered file handle, wrapped in a RefCell to allow implementation
+    /// of the Log trait.
+    buffer: Option<RefCell<BufWriter<File>>>,
+    /// The last time the file was synced to disk.
+    last_sync: Cell<Instant>,
 }
 
 impl TeeFile {
     /// Constructs a new tee file. Consumes the provided configuration.
     pub fn new(configuration: TeeFileConfiguration) -> Result<TeeFile> {
-        let buffer = Some(File::create(&configuration.file)?);
+        let buffer = Some(RefCell::new(BufWriter::new(File::create(
+            &configuration.file,
+        )?)));
         Ok(TeeFile {
             buffer,
             configuration,
+            last_sync: Cell::new(Instant::now()),
         })
     }
+
+    /// Writes out the buffer and syncs the file to disk.
+    fn sync(&self) -> std::io::Result<()> {
+        self.last_sync.set(Instant::now());
+        if let Some(buffer) = self.buffer.as_ref() {
+            let mut buffer = buffer.borrow_mut();
+            buffer.flush()?;
+            buffer.get_ref().sync_data()?;
+        }
+        Ok(())
+    }
+}
+
+impl Drop for TeeFile {
+    fn drop(&mut self) {
+        self.sync().ok();
+    }
 }
 
 impl Log for TeeFile {
@@ -66,8 +104,23 @@ impl Log for TeeFile {
         LoglevelFilter::from(level) <= self.configuration.filter
     }
     fn log(&self, record: &LogRecord) {
-        if let Some(mut buffer) = self.buffer.as_ref() {
+        if let Some(buffer) = self.buffer.as_ref() {
+            let mut buffer = buffer.borrow_mut();
             writeln!(buffer, "{}", record).expect("Failed to write to file");
+            if record.level() <= Loglevel::Warn {
+                buffer.flush().expect("Failed to write to file");
+            }
+        }
+        if self.last_sync.get().elapsed() >= SYNC_INTERVAL {
+            self.sync().expect("Failed to sync file");
+        }
+    }
+    fn flush(&self) {
+        if let Some(buffer) = self.buffer.as_ref() {
+            buffer
+                .borrow_mut()
+                .flush()
+                .expect("Failed to write to file");
         }
     }
 }
@@ -146,7 +199,7 @@ mod test {
         let tf = TeeFile::new(tfc);
 
         assert!(
-            format!("{:?}", tf.unwrap()).starts_with("TeeFile { configuration: TeeFileConfiguration { filter: Trace, file: \"/dev/zero\" }, buffer: Some(File {")
+            format!("{:?}", tf.unwrap()).starts_with("TeeFile { configuration: TeeFileConfiguration { filter: Trace, file: \"/dev/zero\" }, buffer: Some(RefCell { value: BufWriter { writer: File {")
         );
     }
 
@@ -2,6 +2,7 @@
 
 use crate::{
     common::{
+        affinity,
         error::{err, Result},
         log::{
             callback::LogCallback,
@@ -13,13 +14,13 @@ use crate::{
     },
     trace,
 };
-use std::thread;
+use std::{os::unix::thread::JoinHandleExt, thread};
 use term::stderr;
 
 #[derive(Debug)]
 pub struct LogThread {
     sender: Option<crossbeam_channel::Sender<LogRecord>>,
-    ipc_sender: Option<ipc_channel::ipc::IpcSender<LogRecord>>,
+    ipc_sender: Option<ipc_channel::ipc::IpcSender<Vec<LogRecord>>>,
     handler: Option<thread::JoinHandle<Result<()>>>,
 }
 
@@ -42,8 +43,10 @@ impl LogThread {
         let (sender, receiver): (_, crossbeam_channel::Receiver<LogRecord>) =
             crossbeam_channel::unbounded();
 
-        // Create the IPC log channel.
-        let (ipc_sender, ipc_receiver) = ipc_channel::ipc::channel()?;
+        // Create the IPC log channel. Plugins send their records through this
+        // channel in batches.
+        let (ipc_sender, ipc_receiver): (_, ipc_channel::ipc::IpcReceiver<Vec<LogRecord>>) =
+            ipc_channel::ipc::channel()?;
 
         // Spawn the local channel log thread.
         let handler = thread::spawn(move || {
@@ -69,7 +72,19 @@ impl LogThread {
                 .collect::<Result<Vec<_>>>()
                 .or_else(|e| err(e.to_string()))?;
 
-            while let Ok(record) = receiver.recv() {
+            loop {
+                let record = match receiver.try_recv() {
+                    Ok(record) => record,
+                    Err(_) => {
+                        // We're about to block, so this is a good time to
+                        // write out what the tee files buffered.
+                        tee_files.iter().for_each(TeeFile::flush);
+                        match receiver.recv() {
+                            Ok(record) => record,
+                            Err(_) => break,
+                        }
+                    }
+                };
                 let level = LoglevelFilter::from(record.level());
 
                 // Callback
@@ -169,9 +184,18 @@ impl LogThread {
             Ok(())
         });
 
-        // Start the IPC proxy.
-        ipc_channel::router::ROUTER
-            .route_ipc_receiver_to_crossbeam_sender(ipc_receiver, sender.clone());
+        // Start the IPC proxy, which unpacks the batches sent by the plugins.
+        let ipc_proxy = sender.clone();
+        ipc_channel::router::ROUTER.add_route(
+            ipc_receiver.to_opaque(),
+            Box::new(move |message| {
+                if let Ok(records) = message.to::<Vec<LogRecord>>() {
+                    for record in records {
+                        ipc_proxy.send(record).ok();
+                    }
+                }
+            }),
+        );
 
         // Start a LogProxy for the current thread.
         init(vec![LogProxy::boxed(name, proxy_level, sender.clone())])?;
@@ -187,9 +211,18 @@ impl LogThread {
         self.sender.clone().unwrap()
     }
 
-    pub fn get_ipc_sender(&self) -> ipc_channel::ipc::IpcSender<LogRecord> {
+    pub fn get_ipc_sender(&self) -> ipc_channel::ipc::IpcSender<Vec<LogRecord>> {
         self.ipc_sender.clone().unwrap()
     }
+
+    /// Restricts the log thread to the given logical CPUs, such that it does
+    /// not compete with the plugins for their CPUs. This is no-op if the list
+    /// is empty.
+    pub fn set_affinity(&self, cpus: &[usize]) -> Result<()> {
+        let handler = self.handler.as_ref().expect("LogThread failed to start");
+        affinity::set_thread_affinity(handler.as_pthread_t(), cpus)?;
+        Ok(())
+    }
 }
 
 /// Drops the sender side of the log channel and wait for the log thread to drop.
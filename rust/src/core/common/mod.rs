@@ -2,10 +2,13 @@
 
 #[macro_use]
 pub mod util;
+pub mod affinity;
 pub mod channel;
 pub mod converter;
 pub mod error;
 pub mod gates;
+pub mod local_channel;
 pub mod log;
 pub mod protocol;
+pub mod shm_channel;
 pub mod types;
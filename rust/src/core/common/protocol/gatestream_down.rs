@@ -43,6 +43,29 @@ pub enum PipelinedGatestreamDown {
     /// Requests execution of a gate.
     Gate(Gate),
 
+    /// Requests execution of a sequence of gates.
+    ///
+    /// This is semantically identical to sending the gates one by one using
+    /// `Gate` messages, except that the whole batch is associated with a
+    /// single sequence number. That is, the batch is acknowledged as a whole.
+    GateBatch(Vec<Gate>),
+
     /// Advances the simulation by the specified number of cycles.
     Advance(Cycles),
+
+    /// Advances the simulation by the specified number of cycles, and then
+    /// requests execution of a gate.
+    ///
+    /// This is semantically identical to an `Advance` message followed by a
+    /// `Gate` message. It is what consecutive `advance()` calls followed by
+    /// a gate are coalesced into, such that timing-accurate gatestreams
+    /// don't need a separate message for every advancement.
+    TimedGate(Cycles, Gate),
+
+    /// Advances the simulation by the specified number of cycles, and then
+    /// requests execution of a sequence of gates.
+    ///
+    /// This is semantically identical to an `Advance` message followed by a
+    /// `GateBatch` message.
+    TimedGateBatch(Cycles, Vec<Gate>),
 }
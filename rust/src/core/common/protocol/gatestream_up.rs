@@ -22,6 +22,13 @@ pub enum GatestreamUp {
     /// not contain the sequence number itself.
     Measured(QubitMeasurementResult),
 
+    /// Specifies that the specified qubits were measured.
+    ///
+    /// This is equivalent to a `Measured` message for each measurement in
+    /// order, but avoids the per-message overhead when a gate or a series of
+    /// gates measures many qubits at once.
+    MeasuredBatch(Vec<QubitMeasurementResult>),
+
     /// Indicates that the simulation was advanced by the specified number of
     /// cycles.
     Advanced(Cycles),
@@ -1,4 +1,4 @@
-use crate::common::types::{ArbData, PluginMetadata};
+use crate::common::types::{ArbData, OutcomeHistogram, PluginMetadata, PluginStats, TraceEvent};
 use serde::{Deserialize, Serialize};
 
 /// Plugin to simulator responses.
@@ -18,6 +18,12 @@ pub enum PluginToSimulator {
 
     /// Success response to `SimulatorToPlugin::ArbRequest`.
     ArbResponse(ArbData),
+
+    /// Success response to `SimulatorToPlugin::StatsRequest`.
+    Stats(PluginStats),
+
+    /// Success response to `SimulatorToPlugin::TraceRequest`.
+    Trace(Vec<TraceEvent>),
 }
 
 /// Initialization response.
@@ -43,4 +49,8 @@ pub struct FrontendRunResponse {
     /// Messages queued up through the frontend's `send()` function, to be
     /// consumed by the host's `recv()` function.
     pub messages: Vec<ArbData>,
+
+    /// Outcomes recorded through the frontend's `record_outcome()` function
+    /// since the previous response, to be added to the host's histogram.
+    pub outcomes: OutcomeHistogram,
 }
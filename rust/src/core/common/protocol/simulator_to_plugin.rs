@@ -3,10 +3,11 @@ use crate::{
         log::LogRecord,
         types::{ArbCmd, ArbData, PluginType},
     },
-    host::configuration::PluginLogConfiguration,
+    host::configuration::{GatestreamTransport, PluginLogConfiguration, ReceiveStrategy},
 };
 use ipc_channel::ipc::IpcSender;
 use serde::{Deserialize, Serialize};
+use std::path::PathBuf;
 
 /// Simulator/host to plugin requests.
 #[derive(Debug, PartialEq, Serialize, Deserialize)]
@@ -65,6 +66,27 @@ pub enum SimulatorToPlugin {
     ///  - failure: `PluginToSimulator::Failure`
     Abort,
 
+    /// Request to finish the current simulation and return to the state the
+    /// plugin was in before it was initialized, such that it can be reused
+    /// for a subsequent simulation.
+    ///
+    /// In response, the plugin must:
+    ///
+    ///  - wait for all requests sent downstream to be acknowledged;
+    ///  - call the user's implementation of the `drop()` callback;
+    ///  - disconnect from its upstream and downstream plugins;
+    ///  - reset its internal state and shut down its logging facilities.
+    ///
+    /// After this, the next message must be `SimulatorToPlugin::Initialize`
+    /// again. Plugins reused this way must thus be able to handle their
+    /// `initialize()` callback being called again after `drop()`.
+    ///
+    /// The valid responses to this message are:
+    ///
+    ///  - success: `PluginToSimulator::Success`
+    ///  - failure: `PluginToSimulator::Failure`
+    Reset,
+
     /// Passes control from the host to the frontend plugin.
     ///
     /// This is only to be sent to frontends. In response, the frontend must:
@@ -93,6 +115,25 @@ pub enum SimulatorToPlugin {
     ///  - success: `PluginToSimulator::ArbResponse`
     ///  - failure: `PluginToSimulator::Failure`
     ArbRequest(ArbCmd),
+
+    /// Requests the performance statistics the plugin collected for the
+    /// current simulation.
+    ///
+    /// The valid responses to this message are:
+    ///
+    ///  - success: `PluginToSimulator::Stats`
+    ///  - failure: `PluginToSimulator::Failure`
+    StatsRequest,
+
+    /// Requests the timeline events the plugin recorded since the previous
+    /// `TraceRequest`. Plugins only record events if tracing was enabled
+    /// when they were initialized.
+    ///
+    /// The valid responses to this message are:
+    ///
+    ///  - success: `PluginToSimulator::Trace`
+    ///  - failure: `PluginToSimulator::Failure`
+    TraceRequest,
 }
 
 impl Into<SimulatorToPlugin> for ArbCmd {
@@ -110,6 +151,21 @@ pub struct PluginInitializeRequest {
     /// for backends.
     pub downstream: Option<String>,
 
+    /// The kind of channel to use for the connection with the downstream
+    /// plugin. Ignored for backends.
+    pub downstream_transport: GatestreamTransport,
+
+    /// The maximum number of requests that may be in flight to the
+    /// downstream plugin, or 0 for no limit. Ignored for backends.
+    pub downstream_window: usize,
+
+    /// How the plugin waits for incoming gatestream messages.
+    pub receive_strategy: ReceiveStrategy,
+
+    /// When specified, the messages sent to the downstream plugin are
+    /// recorded to this gatestream capture file. Ignored for backends.
+    pub downstream_capture: Option<PathBuf>,
+
     /// The expected plugin type.
     pub plugin_type: PluginType,
 
@@ -119,9 +175,13 @@ pub struct PluginInitializeRequest {
     /// Configuration for the logging subsystem of the plugin.
     pub log_configuration: PluginLogConfiguration,
 
-    /// Sender side of the log channel. Can be used by a Plugin to send log
-    /// records to the simulator.
-    pub log_channel: IpcSender<LogRecord>,
+    /// Sender side of the log channel. Can be used by a Plugin to send
+    /// batches of log records to the simulator.
+    pub log_channel: IpcSender<Vec<LogRecord>>,
+
+    /// Whether the plugin should record timeline events, to be retrieved
+    /// later through `SimulatorToPlugin::TraceRequest`.
+    pub trace: bool,
 }
 
 impl Into<SimulatorToPlugin> for PluginInitializeRequest {
@@ -133,8 +193,13 @@ impl Into<SimulatorToPlugin> for PluginInitializeRequest {
 impl PartialEq for PluginInitializeRequest {
     fn eq(&self, other: &PluginInitializeRequest) -> bool {
         self.downstream == other.downstream
+            && self.downstream_transport == other.downstream_transport
+            && self.downstream_window == other.downstream_window
+            && self.receive_strategy == other.receive_strategy
+            && self.downstream_capture == other.downstream_capture
             && self.plugin_type == other.plugin_type
             && self.log_configuration == other.log_configuration
+            && self.trace == other.trace
     }
 }
 
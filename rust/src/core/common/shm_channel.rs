@@ -0,0 +1,592 @@
+//! Shared-memory channel implementation.
+//!
+//! Defines a single-producer single-consumer channel that passes messages
+//! between processes through a ring buffer in shared memory, as an
+//! alternative to the socket-based channels of [`ipc_channel`].
+//!
+//! Each channel consists of a memory-mapped file containing the ring buffer
+//! and two auxiliary `ipc_channel` channels: a doorbell channel, through
+//! which the producer wakes up the consumer when the consumer is parked (and
+//! only then), and an overflow channel, through which messages that are too
+//! large for the ring buffer are sent. Because the doorbell is a regular
+//! `IpcReceiver`, the consumer can wait on it together with all its other
+//! channels using an `IpcReceiverSet`.
+//!
+//! Channels are constructed in one process using [`shm_channel`] or
+//! [`shm_channel_rev`]. These return the local side of the channel, and a
+//! serializable handle for the other side that can be sent to the peer
+//! process through any `ipc_channel` channel, where it is opened using
+//! `open()`.
+//!
+//! [`ipc_channel`]: ../../../ipc_channel/index.html
+//! [`shm_channel`]: ./fn.shm_channel.html
+//! [`shm_channel_rev`]: ./fn.shm_channel_rev.html
+
+use crate::common::{
+    channel::{Channel, Receiver, Sender},
+    error::{inv_arg, Error, ErrorKind, Result},
+};
+use ipc_channel::ipc;
+use serde::{Deserialize, Serialize};
+use std::{
+    fs::{remove_file, OpenOptions},
+    hint::spin_loop,
+    marker::PhantomData,
+    os::unix::{fs::OpenOptionsExt, io::AsRawFd},
+    path::{Path, PathBuf},
+    ptr::null_mut,
+    sync::atomic::{AtomicU32, AtomicU64, AtomicUsize, Ordering},
+    time::Duration,
+};
+
+/// Default ring buffer capacity in bytes.
+pub const DEFAULT_SHM_CAPACITY: usize = 1 << 20;
+
+/// Offset of the producer position within the mapped region.
+const HEAD_OFFSET: usize = 0;
+
+/// Offset of the consumer position within the mapped region. Placed in a
+/// different cache line than the producer position to prevent false sharing.
+const TAIL_OFFSET: usize = 64;
+
+/// Offset of the consumer-parked flag within the mapped region.
+const PARKED_OFFSET: usize = 128;
+
+/// Offset of the ring buffer data within the mapped region.
+const DATA_OFFSET: usize = 192;
+
+/// Frame length value used to indicate that the message was sent through the
+/// overflow channel.
+const OVERFLOW_MARKER: u32 = std::u32::MAX;
+
+/// Number of times the producer spins before it starts yielding when the
+/// ring buffer is full.
+const FULL_SPIN_COUNT: usize = 256;
+
+/// Counter used to generate unique ring buffer filenames within this process.
+static RING_COUNTER: AtomicUsize = AtomicUsize::new(0);
+
+/// Converts a serialization error to our error type.
+fn serialization_error(error: serde_cbor::Error) -> Error {
+    ErrorKind::IPCError(error.to_string()).into()
+}
+
+/// Memory-mapped ring buffer shared between two processes.
+///
+/// The producer only ever writes the head position and the data region, the
+/// consumer only ever writes the tail position. Both positions increase
+/// monotonically and are reduced modulo the capacity to index the data
+/// region.
+#[derive(Debug)]
+struct ShmRing {
+    /// Base address of the mapped region.
+    base: *mut u8,
+
+    /// Size of the mapped region in bytes.
+    len: usize,
+
+    /// Capacity of the ring buffer in bytes. Always a power of two.
+    capacity: usize,
+
+    /// Path to the backing file, if this side of the channel is responsible
+    /// for removing it.
+    owned_path: Option<PathBuf>,
+}
+
+// The mapping is only accessed through atomics and by the single side of the
+// channel that owns the ShmRing, so it is safe to move it between threads.
+unsafe impl Send for ShmRing {}
+
+impl ShmRing {
+    /// Creates a new ring buffer file in the system's temporary directory and
+    /// maps it. The file is only accessible to the current user.
+    fn create(capacity: usize) -> Result<ShmRing> {
+        if capacity < 64 || !capacity.is_power_of_two() {
+            return inv_arg(format!(
+                "shared-memory ring buffer capacity must be a power of two of at least 64 bytes, got {}",
+                capacity
+            ));
+        }
+        let mut path = std::env::temp_dir();
+        path.push(format!(
+            "dqcsim-ring-{}-{}-{:016x}",
+            std::process::id(),
+            RING_COUNTER.fetch_add(1, Ordering::Relaxed),
+            rand::random::<u64>()
+        ));
+        let file = OpenOptions::new()
+            .read(true)
+            .write(true)
+            .create_new(true)
+            .mode(0o600)
+            .open(&path)?;
+        file.set_len((DATA_OFFSET + capacity) as u64)?;
+        let mut ring = ShmRing::map(&file, capacity)?;
+        ring.owned_path.replace(path);
+        Ok(ring)
+    }
+
+    /// Opens and maps an existing ring buffer file, then removes the file.
+    /// The mapping remains valid until it is dropped.
+    fn open(path: &Path, capacity: usize) -> Result<ShmRing> {
+        let file = OpenOptions::new().read(true).write(true).open(path)?;
+        if file.metadata()?.len() != (DATA_OFFSET + capacity) as u64 {
+            return inv_arg("shared-memory ring buffer file has unexpected size");
+        }
+        let ring = ShmRing::map(&file, capacity)?;
+        // Both sides have the file mapped now, so it is no longer needed.
+        remove_file(path).ok();
+        Ok(ring)
+    }
+
+    /// Maps the given file, which must have the appropriate size.
+    fn map(file: &std::fs::File, capacity: usize) -> Result<ShmRing> {
+        let len = DATA_OFFSET + capacity;
+        let base = unsafe {
+            libc::mmap(
+                null_mut(),
+                len,
+                libc::PROT_READ | libc::PROT_WRITE,
+                libc::MAP_SHARED,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        if base == libc::MAP_FAILED {
+            return Err(std::io::Error::last_os_error().into());
+        }
+        Ok(ShmRing {
+            base: base as *mut u8,
+            len,
+            capacity,
+            owned_path: None,
+        })
+    }
+
+    /// Returns a reference to the producer position.
+    fn head(&self) -> &AtomicU64 {
+        unsafe { &*(self.base.add(HEAD_OFFSET) as *const AtomicU64) }
+    }
+
+    /// Returns a reference to the consumer position.
+    fn tail(&self) -> &AtomicU64 {
+        unsafe { &*(self.base.add(TAIL_OFFSET) as *const AtomicU64) }
+    }
+
+    /// Returns a reference to the consumer-parked flag.
+    fn parked(&self) -> &AtomicU32 {
+        unsafe { &*(self.base.add(PARKED_OFFSET) as *const AtomicU32) }
+    }
+
+    /// Copies data into the ring buffer at the given position, wrapping
+    /// around as needed. The caller must ensure that the region is free.
+    fn write_at(&self, position: u64, data: &[u8]) {
+        let index = (position as usize) & (self.capacity - 1);
+        let first = std::cmp::min(data.len(), self.capacity - index);
+        unsafe {
+            let region = self.base.add(DATA_OFFSET);
+            std::ptr::copy_nonoverlapping(data.as_ptr(), region.add(index), first);
+            std::ptr::copy_nonoverlapping(data.as_ptr().add(first), region, data.len() - first);
+        }
+    }
+
+    /// Copies data out of the ring buffer at the given position, wrapping
+    /// around as needed. The caller must ensure that the region is filled.
+    fn read_at(&self, position: u64, data: &mut [u8]) {
+        let index = (position as usize) & (self.capacity - 1);
+        let first = std::cmp::min(data.len(), self.capacity - index);
+        unsafe {
+            let region = self.base.add(DATA_OFFSET);
+            std::ptr::copy_nonoverlapping(region.add(index), data.as_mut_ptr(), first);
+            std::ptr::copy_nonoverlapping(region, data.as_mut_ptr().add(first), data.len() - first);
+        }
+    }
+}
+
+impl Drop for ShmRing {
+    fn drop(&mut self) {
+        unsafe {
+            libc::munmap(self.base as *mut libc::c_void, self.len);
+        }
+        // If the peer never connected, the file still exists.
+        if let Some(path) = self.owned_path.take() {
+            remove_file(path).ok();
+        }
+    }
+}
+
+/// Sender side of a shared-memory channel.
+#[derive(Debug)]
+pub struct ShmSender<T> {
+    /// The shared ring buffer.
+    ring: ShmRing,
+
+    /// Doorbell used to wake up the consumer when it is parked.
+    doorbell: ipc::IpcSender<()>,
+
+    /// Channel for messages that don't fit in the ring buffer.
+    overflow: ipc::IpcSender<Vec<u8>>,
+
+    /// Number of payload bytes sent so far.
+    bytes: AtomicU64,
+
+    /// Message type marker.
+    phantom: PhantomData<T>,
+}
+
+/// Receiver side of a shared-memory channel.
+#[derive(Debug)]
+pub struct ShmReceiver<T> {
+    /// The shared ring buffer.
+    ring: ShmRing,
+
+    /// Doorbell used by the producer to wake us up when we're parked. This
+    /// is taken out of the receiver when the doorbell is to be waited upon
+    /// through an `IpcReceiverSet`.
+    doorbell: Option<ipc::IpcReceiver<()>>,
+
+    /// Channel for messages that don't fit in the ring buffer.
+    overflow: ipc::IpcReceiver<Vec<u8>>,
+
+    /// Number of payload bytes received so far.
+    bytes: AtomicU64,
+
+    /// Message type marker.
+    phantom: PhantomData<T>,
+}
+
+/// Serializable handle to the sender side of a shared-memory channel, to be
+/// sent to and opened by the producer process.
+#[derive(Debug, Serialize, Deserialize)]
+#[serde(bound = "")]
+pub struct ShmSenderHandle<T> {
+    path: PathBuf,
+    capacity: usize,
+    doorbell: ipc::IpcSender<()>,
+    overflow: ipc::IpcSender<Vec<u8>>,
+    phantom: PhantomData<T>,
+}
+
+/// Serializable handle to the receiver side of a shared-memory channel, to be
+/// sent to and opened by the consumer process.
+#[derive(Debug, Serialize, Deserialize)]
+#[serde(bound = "")]
+pub struct ShmReceiverHandle<T> {
+    path: PathBuf,
+    capacity: usize,
+    doorbell: ipc::IpcReceiver<()>,
+    overflow: ipc::IpcReceiver<Vec<u8>>,
+    phantom: PhantomData<T>,
+}
+
+/// Constructs a shared-memory channel with a ring buffer of the given
+/// capacity in bytes, of which this process is the producer.
+///
+/// The returned receiver handle is to be sent to the consumer process.
+pub fn shm_channel<T>(capacity: usize) -> Result<(ShmSender<T>, ShmReceiverHandle<T>)> {
+    let ring = ShmRing::create(capacity)?;
+    let path = ring.owned_path.clone().unwrap();
+    let (doorbell_tx, doorbell_rx) = ipc::channel()?;
+    let (overflow_tx, overflow_rx) = ipc::channel()?;
+    Ok((
+        ShmSender {
+            ring,
+            doorbell: doorbell_tx,
+            overflow: overflow_tx,
+            bytes: AtomicU64::new(0),
+            phantom: PhantomData,
+        },
+        ShmReceiverHandle {
+            path,
+            capacity,
+            doorbell: doorbell_rx,
+            overflow: overflow_rx,
+            phantom: PhantomData,
+        },
+    ))
+}
+
+/// Constructs a shared-memory channel with a ring buffer of the given
+/// capacity in bytes, of which this process is the consumer.
+///
+/// The returned sender handle is to be sent to the producer process.
+pub fn shm_channel_rev<T>(capacity: usize) -> Result<(ShmSenderHandle<T>, ShmReceiver<T>)> {
+    let ring = ShmRing::create(capacity)?;
+    let path = ring.owned_path.clone().unwrap();
+    let (doorbell_tx, doorbell_rx) = ipc::channel()?;
+    let (overflow_tx, overflow_rx) = ipc::channel()?;
+    Ok((
+        ShmSenderHandle {
+            path,
+            capacity,
+            doorbell: doorbell_tx,
+            overflow: overflow_tx,
+            phantom: PhantomData,
+        },
+        ShmReceiver {
+            ring,
+            doorbell: Some(doorbell_rx),
+            overflow: overflow_rx,
+            bytes: AtomicU64::new(0),
+            phantom: PhantomData,
+        },
+    ))
+}
+
+impl<T> ShmSenderHandle<T> {
+    /// Maps the shared memory of the channel into this process, returning the
+    /// sender.
+    pub fn open(self) -> Result<ShmSender<T>> {
+        Ok(ShmSender {
+            ring: ShmRing::open(&self.path, self.capacity)?,
+            doorbell: self.doorbell,
+            overflow: self.overflow,
+            bytes: AtomicU64::new(0),
+            phantom: PhantomData,
+        })
+    }
+}
+
+impl<T> ShmReceiverHandle<T> {
+    /// Maps the shared memory of the channel into this process, returning the
+    /// receiver.
+    pub fn open(self) -> Result<ShmReceiver<T>> {
+        Ok(ShmReceiver {
+            ring: ShmRing::open(&self.path, self.capacity)?,
+            doorbell: Some(self.doorbell),
+            overflow: self.overflow,
+            bytes: AtomicU64::new(0),
+            phantom: PhantomData,
+        })
+    }
+}
+
+impl<T> ShmSender<T> {
+    /// Returns the number of payload bytes sent through this channel so far.
+    pub fn bytes(&self) -> u64 {
+        self.bytes.load(Ordering::Relaxed)
+    }
+}
+
+impl<T: Serialize> ShmSender<T> {
+    /// Waits until the given number of bytes is free in the ring buffer.
+    ///
+    /// While waiting, the doorbell is periodically rung, both to make sure
+    /// that the consumer is awake and to detect that it has disconnected.
+    fn wait_for_space(&self, head: u64, size: usize) -> Result<()> {
+        let mut iteration = 0;
+        loop {
+            let tail = self.ring.tail().load(Ordering::Acquire);
+            if self.ring.capacity - ((head - tail) as usize) >= size {
+                return Ok(());
+            }
+            iteration += 1;
+            if iteration < FULL_SPIN_COUNT {
+                spin_loop();
+            } else {
+                self.doorbell.send(())?;
+                std::thread::sleep(Duration::from_micros(50));
+            }
+        }
+    }
+
+    /// Writes a frame into the ring buffer and publishes it.
+    fn push_frame(&self, length: u32, data: &[u8]) -> Result<()> {
+        let head = self.ring.head().load(Ordering::Relaxed);
+        self.wait_for_space(head, 4 + data.len())?;
+        self.ring.write_at(head, &length.to_le_bytes());
+        self.ring.write_at(head + 4, data);
+        self.ring
+            .head()
+            .store(head + 4 + data.len() as u64, Ordering::SeqCst);
+
+        // Only ring the doorbell when the consumer is parked. The consumer
+        // sets the flag before checking the head position for the last time,
+        // so either it sees our update, or we see its flag.
+        if self.ring.parked().load(Ordering::SeqCst) != 0
+            && self.ring.parked().swap(0, Ordering::SeqCst) != 0
+        {
+            self.doorbell.send(())?;
+        }
+        Ok(())
+    }
+}
+
+impl<T: Serialize> Sender for ShmSender<T> {
+    type Item = T;
+    type Error = Error;
+
+    fn send(&self, item: Self::Item) -> Result<()> {
+        let data = serde_cbor::to_vec(&item).map_err(serialization_error)?;
+        self.bytes.fetch_add(data.len() as u64, Ordering::Relaxed);
+        if 4 + data.len() > self.ring.capacity / 2 {
+            // Too large for the ring buffer. Put a marker frame in the ring
+            // to preserve message order, and send the data out-of-band.
+            self.push_frame(OVERFLOW_MARKER, &[])?;
+            self.overflow.send(data)?;
+        } else {
+            self.push_frame(data.len() as u32, &data)?;
+        }
+        Ok(())
+    }
+}
+
+impl<T> ShmReceiver<T>
+where
+    T: for<'de> Deserialize<'de>,
+{
+    /// Returns the number of payload bytes received through this channel so
+    /// far.
+    pub fn bytes(&self) -> u64 {
+        self.bytes.load(Ordering::Relaxed)
+    }
+
+    /// Takes the doorbell receiver out of this receiver, such that it can be
+    /// waited upon along with other channels through an `IpcReceiverSet`.
+    /// The messages received through the doorbell carry no information; they
+    /// only indicate that `try_recv()` should be called.
+    ///
+    /// After this, `recv()` can no longer block efficiently; it falls back to
+    /// polling.
+    pub fn take_doorbell(&mut self) -> Option<ipc::IpcReceiver<()>> {
+        self.doorbell.take()
+    }
+
+    /// Receives a message if one is available, without blocking.
+    pub fn try_recv(&self) -> Result<Option<T>> {
+        let tail = self.ring.tail().load(Ordering::Relaxed);
+        let head = self.ring.head().load(Ordering::Acquire);
+        if head == tail {
+            return Ok(None);
+        }
+        let mut length = [0u8; 4];
+        self.ring.read_at(tail, &mut length);
+        let length = u32::from_le_bytes(length);
+        let data = if length == OVERFLOW_MARKER {
+            self.ring.tail().store(tail + 4, Ordering::Release);
+            self.overflow.recv()?
+        } else {
+            let mut data = vec![0u8; length as usize];
+            self.ring.read_at(tail + 4, &mut data);
+            self.ring
+                .tail()
+                .store(tail + 4 + u64::from(length), Ordering::Release);
+            data
+        };
+        self.bytes.fetch_add(data.len() as u64, Ordering::Relaxed);
+        Ok(Some(
+            serde_cbor::from_slice(&data).map_err(serialization_error)?,
+        ))
+    }
+
+    /// Tells the producer that we're about to block on the doorbell.
+    ///
+    /// Returns false if a message became available in the meantime, in which
+    /// case the caller should not block but call `try_recv()` instead.
+    pub fn park(&self) -> bool {
+        self.ring.parked().store(1, Ordering::SeqCst);
+        if self.ring.head().load(Ordering::SeqCst) != self.ring.tail().load(Ordering::Relaxed) {
+            self.ring.parked().store(0, Ordering::SeqCst);
+            false
+        } else {
+            true
+        }
+    }
+}
+
+impl<T> Receiver for ShmReceiver<T>
+where
+    T: for<'de> Deserialize<'de>,
+{
+    type Item = T;
+    type Error = Error;
+
+    fn recv(&self) -> Result<Self::Item> {
+        loop {
+            if let Some(item) = self.try_recv()? {
+                return Ok(item);
+            }
+            if self.park() {
+                if let Some(doorbell) = self.doorbell.as_ref() {
+                    doorbell.recv()?;
+                } else {
+                    std::thread::yield_now();
+                }
+            }
+        }
+    }
+}
+
+pub type ShmChannel<T, U> = (ShmSender<T>, ShmReceiver<U>);
+
+impl<T, U> Channel for ShmChannel<T, U>
+where
+    T: Serialize + Into<U>,
+    U: for<'de> Deserialize<'de> + From<T>,
+{
+    type SenderItem = T;
+    type ReceiverItem = U;
+    type Sender = ShmSender<T>;
+    type Receiver = ShmReceiver<U>;
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn bad_capacity() {
+        assert!(shm_channel::<u32>(0).is_err());
+        assert!(shm_channel::<u32>(1000).is_err());
+    }
+
+    #[test]
+    fn private_file() {
+        use std::os::unix::fs::PermissionsExt;
+        let ring = ShmRing::create(64).unwrap();
+        let path = ring.owned_path.clone().unwrap();
+        let mode = std::fs::metadata(&path).unwrap().permissions().mode();
+        assert_eq!(mode & 0o777, 0o600);
+    }
+
+    #[test]
+    fn in_order() {
+        let (tx, rx) = shm_channel::<Vec<u32>>(256).unwrap();
+        let rx = rx.open().unwrap();
+        assert_eq!(rx.try_recv().unwrap(), None);
+        for i in 0..100 {
+            tx.send(vec![i; (i % 7) as usize]).unwrap();
+            if i % 3 == 0 {
+                // Overflowing messages must stay in order.
+                tx.send(vec![i; 100]).unwrap();
+            }
+            assert_eq!(rx.recv().unwrap(), vec![i; (i % 7) as usize]);
+            if i % 3 == 0 {
+                assert_eq!(rx.recv().unwrap(), vec![i; 100]);
+            }
+        }
+        assert_eq!(rx.try_recv().unwrap(), None);
+    }
+
+    #[test]
+    fn threaded() {
+        let (tx, mut rx) = shm_channel_rev::<u64>(64).unwrap();
+        let doorbell = rx.take_doorbell().unwrap();
+        let producer = std::thread::spawn(move || {
+            let tx = tx.open().unwrap();
+            for i in 0..10000 {
+                tx.send(i).unwrap();
+            }
+        });
+        let mut expected = 0;
+        while expected < 10000 {
+            if let Some(i) = rx.try_recv().unwrap() {
+                assert_eq!(i, expected);
+                expected += 1;
+            } else if rx.park() {
+                doorbell.recv().unwrap();
+            }
+        }
+        producer.join().unwrap();
+    }
+}
@@ -1,6 +1,14 @@
-use crate::common::error::{inv_arg, Error, Result};
-use serde::{Deserialize, Serialize};
-use std::fmt;
+use crate::common::{
+    error::{inv_arg, Error, Result},
+    types::SharedArg,
+};
+use serde::{de::DeserializeOwned, Deserialize, Deserializer, Serialize, Serializer};
+use std::{
+    fmt,
+    hash::{Hash, Hasher},
+    ops::Deref,
+    sync::Arc,
+};
 
 mod cbor_canon {
     use crate::common::error::{inv_arg, oe_inv_arg, Result};
@@ -55,6 +63,151 @@ mod cbor_canon {
         Ok((major, minor, additional, index))
     }
 
+    /// Returns the minor type for the shortest encoding of the given
+    /// additional information value.
+    fn shortest_minor(additional: u64) -> u8 {
+        if additional <= 23 {
+            additional as u8
+        } else if additional <= 0xFF {
+            24
+        } else if additional <= 0xFFFF {
+            25
+        } else if additional <= 0xFFFF_FFFF {
+            26
+        } else {
+            27
+        }
+    }
+
+    /// Returns the length of the value at the front of the given CBOR string
+    /// if that value is in canonical form, i.e., if `canonicalize_int()`
+    /// would copy it unchanged, or `None` if it is not or is invalid. Unlike
+    /// `canonicalize_int()`, this does not allocate.
+    fn canonical_len(input: &[u8]) -> Option<usize> {
+        let (major, minor, additional, tag_len) = read_tag(input).ok()?;
+        let additional = additional?;
+        if major != 7 && minor != shortest_minor(additional) {
+            return None;
+        }
+        let input = &input[tag_len..];
+        let content_len = match major {
+            0 | 1 | 7 => 0,
+            2 | 3 => {
+                if additional > input.len() as u64 {
+                    return None;
+                }
+                additional as usize
+            }
+            4 => {
+                let mut index = 0;
+                for _ in 0..additional {
+                    index += canonical_len(&input[index..])?;
+                }
+                index
+            }
+            5 => {
+                // key/value pairs must be ordered by their byte representations
+                let mut index = 0;
+                let mut previous: Option<&[u8]> = None;
+                for _ in 0..additional {
+                    let start = index;
+                    index += canonical_len(&input[index..])?;
+                    index += canonical_len(&input[index..])?;
+                    let pair = &input[start..index];
+                    if previous.map_or(false, |previous| previous > pair) {
+                        return None;
+                    }
+                    previous.replace(pair);
+                }
+                index
+            }
+            6 => canonical_len(input)?,
+            _ => unreachable!(),
+        };
+        Some(tag_len + content_len)
+    }
+
+    /// Returns whether the given CBOR value is valid and in canonical form.
+    pub fn is_canonical(input: &[u8]) -> bool {
+        canonical_len(input) == Some(input.len())
+    }
+
+    /// Returns the encoding of the value at the given JSON pointer (RFC 6901)
+    /// within the given canonical CBOR value. Only the values along the path
+    /// are parsed; the rest of the object is skipped over without decoding
+    /// it.
+    pub fn lookup<'a>(input: &'a [u8], pointer: &str) -> Result<&'a [u8]> {
+        if pointer.is_empty() {
+            return Ok(input);
+        }
+        if !pointer.starts_with('/') {
+            inv_arg(format!(
+                "invalid JSON pointer {}: must be empty or start with /",
+                pointer
+            ))?;
+        }
+        let mut value = input;
+        for token in pointer[1..].split('/') {
+            let token = token.replace("~1", "/").replace("~0", "~");
+            value = lookup_child(value, &token)?
+                .ok_or_else(oe_inv_arg(format!("no value at JSON pointer {}", pointer)))?;
+        }
+        Ok(value)
+    }
+
+    /// Returns the encoding of the child of the given canonical CBOR value
+    /// that is referred to by the given JSON pointer reference token, if
+    /// there is one.
+    fn lookup_child<'a>(value: &'a [u8], token: &str) -> Result<Option<&'a [u8]>> {
+        // Skip past any semantic tags.
+        let mut value = value;
+        let (major, additional, tag_len) = loop {
+            let (major, _, additional, tag_len) = read_tag(value)?;
+            if major != 6 {
+                break (major, additional, tag_len);
+            }
+            value = &value[tag_len..];
+        };
+        let count = additional.ok_or_else(oe_inv_arg(
+            "invalid CBOR: indefinite length in canonical object",
+        ))?;
+
+        // Returns the next item of the array or dict and advances past it.
+        let mut index = tag_len;
+        let mut next = move || -> Result<&'a [u8]> {
+            let len = canonical_len(&value[index..])
+                .ok_or_else(oe_inv_arg("invalid CBOR: expected canonical object"))?;
+            let item: &'a [u8] = &value[index..index + len];
+            index += len;
+            Ok(item)
+        };
+
+        match major {
+            4 => {
+                let position = match token.parse::<u64>() {
+                    Ok(position) if position < count => position,
+                    _ => return Ok(None),
+                };
+                for _ in 0..position {
+                    next()?;
+                }
+                Ok(Some(next()?))
+            }
+            5 => {
+                for _ in 0..count {
+                    let key = next()?;
+                    let item = next()?;
+                    let (key_major, _, _, key_tag_len) = read_tag(key)?;
+                    if key_major == 3 && &key[key_tag_len..] == token.as_bytes() {
+                        return Ok(Some(item));
+                    }
+                }
+                Ok(None)
+            }
+            _ => Ok(None),
+        }
+    }
+
     /// Canonicalizes the value at the front of the given cbor string. Output is
     /// pushed to the back of `output`. Returns the number of input bytes consumed.
     fn canonicalize_int(input: &[u8], output: &mut Vec<u8>) -> Result<usize> {
@@ -209,16 +362,8 @@ mod cbor_canon {
         // type is used so we can't remove this information.
         let minor = if major == 7 {
             minor
-        } else if additional <= 23 {
-            additional as u8
-        } else if additional <= 0xFF {
-            24
-        } else if additional <= 0xFFFF {
-            25
-        } else if additional <= 0xFFFF_FFFF {
-            26
         } else {
-            27
+            shortest_minor(additional)
         };
 
         // Construct the canonicalized tag.
@@ -241,6 +386,11 @@ mod cbor_canon {
     /// Canonicalizes the given CBOR value.
     pub fn canonizalize(input: &[u8]) -> Result<Vec<u8>> {
         //eprintln!("--------------------------");
+        // Values that are already canonical, such as those produced by
+        // another ArbData, only need to be validated.
+        if is_canonical(input) {
+            return Ok(input.to_vec());
+        }
         let mut output = vec![];
         let len = canonicalize_int(input, &mut output)?;
         if len != input.len() {
@@ -431,20 +581,178 @@ mod cbor_canon {
                 vec![0xFB, 0xFF, 0xF0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00],
             ];
             for cbor in data {
-                cbor_cmp_golden(&cbor[..], &canonizalize(&cbor[..]).unwrap());
+                let canonical = canonizalize(&cbor[..]).unwrap();
+                cbor_cmp_golden(&cbor[..], &canonical);
+                assert!(is_canonical(&canonical));
+                assert_eq!(canonizalize(&canonical).unwrap(), canonical);
             }
         }
+
+        #[test]
+        fn non_canonical() {
+            // Non-shortest integer, indefinite-length array, unsorted dict.
+            assert!(!is_canonical(&[0x18, 0x01]));
+            assert!(!is_canonical(&[0x9F, 0x01, 0xFF]));
+            assert!(!is_canonical(&[0xA2, 0x61, 0x62, 0x01, 0x61, 0x61, 0x02]));
+            assert!(is_canonical(&[0xA2, 0x61, 0x61, 0x02, 0x61, 0x62, 0x01]));
+
+            // Incomplete or trailing data.
+            assert!(!is_canonical(&[0x82, 0x01]));
+            assert!(!is_canonical(&[0x01, 0x02]));
+            assert!(!is_canonical(&[]));
+        }
+
+        #[test]
+        fn lookup() {
+            // {"a": [1, {"b~/c": true}], "x": "y"}
+            let cbor = canonizalize(&[
+                0xA2, 0x61, 0x78, 0x61, 0x79, 0x61, 0x61, 0x82, 0x01, 0xA1, 0x64, 0x62, 0x7E, 0x2F,
+                0x63, 0xF5,
+            ])
+            .unwrap();
+            assert_eq!(super::lookup(&cbor, "").unwrap(), &cbor[..]);
+            assert_eq!(super::lookup(&cbor, "/x").unwrap(), &[0x61, 0x79]);
+            assert_eq!(super::lookup(&cbor, "/a/0").unwrap(), &[0x01]);
+            assert_eq!(super::lookup(&cbor, "/a/1/b~0~1c").unwrap(), &[0xF5]);
+            assert_eq!(
+                super::lookup(&cbor, "/a/2").unwrap_err().to_string(),
+                "Invalid argument: no value at JSON pointer /a/2"
+            );
+            assert!(super::lookup(&cbor, "/y").is_err());
+            assert!(super::lookup(&cbor, "/x/0").is_err());
+            assert!(super::lookup(&cbor, "x").is_err());
+        }
+    }
+}
+
+/// Copy-on-write vector used for the fields of `ArbData`.
+///
+/// Cloning only increments a reference count; the vector is copied when a
+/// shared instance is first modified. Empty vectors are represented without
+/// an allocation. Serializes the same way as a `Vec<T>`.
+#[derive(Clone)]
+struct CowVec<T>(Option<Arc<Vec<T>>>);
+
+impl<T> Default for CowVec<T> {
+    fn default() -> Self {
+        CowVec(None)
+    }
+}
+
+impl<T: Clone> CowVec<T> {
+    /// Returns a mutable reference to the vector, copying it first if it is
+    /// shared.
+    fn make_mut(&mut self) -> &mut Vec<T> {
+        Arc::make_mut(self.0.get_or_insert_with(|| Arc::new(vec![])))
+    }
+
+    /// Clears the vector, releasing this reference to its contents.
+    fn clear(&mut self) {
+        self.0 = None;
+    }
+}
+
+impl<T> From<Vec<T>> for CowVec<T> {
+    fn from(vec: Vec<T>) -> Self {
+        if vec.is_empty() {
+            CowVec(None)
+        } else {
+            CowVec(Some(Arc::new(vec)))
+        }
+    }
+}
+
+impl<T> Deref for CowVec<T> {
+    type Target = [T];
+    fn deref(&self) -> &[T] {
+        match &self.0 {
+            Some(vec) => &vec[..],
+            None => &[],
+        }
+    }
+}
+
+impl<T: fmt::Debug> fmt::Debug for CowVec<T> {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        self[..].fmt(f)
+    }
+}
+
+impl<T: Hash> Hash for CowVec<T> {
+    fn hash<H: Hasher>(&self, state: &mut H) {
+        self[..].hash(state)
+    }
+}
+
+impl<T: PartialEq> PartialEq for CowVec<T> {
+    fn eq(&self, other: &Self) -> bool {
+        self[..] == other[..]
+    }
+}
+
+impl<T: Serialize> Serialize for CowVec<T> {
+    fn serialize<S: Serializer>(&self, serializer: S) -> std::result::Result<S::Ok, S::Error> {
+        self[..].serialize(serializer)
+    }
+}
+
+impl<'de, T: Deserialize<'de>> Deserialize<'de> for CowVec<T> {
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> std::result::Result<Self, D::Error> {
+        Vec::<T>::deserialize(deserializer).map(CowVec::from)
     }
 }
 
 const EMPTY_CBOR: &[u8] = &[0xA0];
 
+/// Serde helpers for the CBOR field of `ArbData`, which represents the empty
+/// object `{}` using an empty vector. The serialized form always contains the
+/// actual CBOR object, such that it does not depend on this optimization.
+mod empty_cbor {
+    use super::{CowVec, EMPTY_CBOR};
+    use serde::{Deserialize, Deserializer, Serialize, Serializer};
+
+    pub fn serialize<S: Serializer>(cbor: &[u8], serializer: S) -> Result<S::Ok, S::Error> {
+        if cbor.is_empty() {
+            EMPTY_CBOR.serialize(serializer)
+        } else {
+            cbor.serialize(serializer)
+        }
+    }
+
+    pub fn deserialize<'de, D: Deserializer<'de>>(deserializer: D) -> Result<CowVec<u8>, D::Error> {
+        let cbor = Vec::<u8>::deserialize(deserializer)?;
+        if cbor == EMPTY_CBOR {
+            Ok(CowVec::default())
+        } else {
+            Ok(CowVec::from(cbor))
+        }
+    }
+}
+
 /// Represents an ArbData structure, consisting of an (unparsed, TODO) JSON
-/// string and a list of binary strings.
+/// string, a list of binary strings, and a list of binary strings stored in
+/// shared memory.
+///
+/// The latter are intended for large payloads, such as initial state vectors
+/// passed to a backend through an `ArbCmd`. Unlike the regular binary
+/// arguments, they are not copied when the `ArbData` is sent to another
+/// process; see `SharedArg`.
+///
+/// An `ArbData` is attached to every gate and measurement, and most of them
+/// carry neither a JSON object nor binary arguments. The CBOR object is
+/// therefore stored with the empty object `{}` represented as an empty
+/// vector, such that constructing, clearing, and cloning such an `ArbData`
+/// does not allocate. The CBOR object and the binary arguments are shared
+/// between clones until one of them is modified, so copying a non-empty
+/// `ArbData` does not copy its contents either.
 #[derive(Clone, Hash, PartialEq, Deserialize, Serialize)]
 pub struct ArbData {
-    cbor: Vec<u8>,
-    args: Vec<Vec<u8>>,
+    /// The canonical CBOR object, or an empty vector for `{}`.
+    #[serde(with = "empty_cbor")]
+    cbor: CowVec<u8>,
+    args: CowVec<Vec<u8>>,
+    #[serde(default)]
+    shared: Vec<SharedArg>,
 }
 
 impl Eq for ArbData {}
@@ -456,12 +764,14 @@ impl fmt::Debug for ArbData {
         let mut ser = serde_json::Serializer::pretty(&mut output);
         serde_transcode::transcode(&mut de, &mut ser).unwrap();
         let output = String::from_utf8(output).unwrap();*/
-        let value: serde_cbor::Value = serde_cbor::from_slice(&self.cbor).unwrap();
+        let value: serde_cbor::Value = serde_cbor::from_slice(self.get_cbor()).unwrap();
 
-        fmt.debug_struct("ArbData")
-            .field("json", &value)
-            .field("args", &self.args)
-            .finish()
+        let mut fmt = fmt.debug_struct("ArbData");
+        fmt.field("json", &value).field("args", &self.args);
+        if !self.shared.is_empty() {
+            fmt.field("shared", &self.shared);
+        }
+        fmt.finish()
     }
 }
 
@@ -642,8 +952,9 @@ impl ArbData {
     /// the default JSON object and zero binary arguments, use `default()`.
     pub fn from_str_args_only(s: &str) -> Result<Self> {
         Ok(ArbData {
-            cbor: EMPTY_CBOR.to_owned(),
-            args: ArbData::scan_unstructured_args(&mut s.chars())?,
+            cbor: CowVec::default(),
+            args: CowVec::from(ArbData::scan_unstructured_args(&mut s.chars())?),
+            shared: vec![],
         })
     }
 
@@ -651,8 +962,9 @@ impl ArbData {
     /// JSON/CBOR object.
     pub fn from_args(args: impl Into<Vec<Vec<u8>>>) -> Self {
         ArbData {
-            cbor: EMPTY_CBOR.to_owned(),
-            args: args.into(),
+            cbor: CowVec::default(),
+            args: CowVec::from(args.into()),
+            shared: vec![],
         }
     }
 
@@ -660,19 +972,38 @@ impl ArbData {
     /// ensuring that the CBOR object is valid.
     pub fn from_cbor(cbor: impl AsRef<[u8]>, args: impl Into<Vec<Vec<u8>>>) -> Result<Self> {
         let mut arb_data = ArbData {
-            cbor: vec![],
-            args: args.into(),
+            cbor: CowVec::default(),
+            args: CowVec::from(args.into()),
+            shared: vec![],
         };
         arb_data.set_cbor(cbor)?;
         Ok(arb_data)
     }
 
+    /// Construct an `ArbData` from a CBOR object and binary arguments without
+    /// validating the CBOR object.
+    ///
+    /// This is intended for CBOR that comes from a trusted source, such as
+    /// `get_cbor()` of another `ArbData`. The CBOR object must be valid and
+    /// in canonical form; if it is not, equality and hashing will not behave
+    /// correctly, and conversion to JSON may fail.
+    pub fn from_cbor_unchecked(cbor: impl Into<Vec<u8>>, args: impl Into<Vec<Vec<u8>>>) -> Self {
+        let mut arb_data = ArbData {
+            cbor: CowVec::default(),
+            args: CowVec::from(args.into()),
+            shared: vec![],
+        };
+        arb_data.set_cbor_unchecked(cbor);
+        arb_data
+    }
+
     /// Construct an `ArbData` from a JSON object and binary arguments, while
     /// ensuring that the JSON object is valid.
     pub fn from_json(json: impl AsRef<str>, args: impl Into<Vec<Vec<u8>>>) -> Result<Self> {
         let mut arb_data = ArbData {
-            cbor: vec![],
-            args: args.into(),
+            cbor: CowVec::default(),
+            args: CowVec::from(args.into()),
+            shared: vec![],
         };
         arb_data.set_json(json)?;
         Ok(arb_data)
@@ -681,7 +1012,7 @@ impl ArbData {
     /// Returns the JSON/CBOR data field as a JSON string.
     pub fn get_json(&self) -> Result<String> {
         let mut output: Vec<u8> = vec![];
-        let mut de = serde_cbor::de::Deserializer::from_slice(&self.cbor);
+        let mut de = serde_cbor::de::Deserializer::from_slice(self.get_cbor());
         let mut ser = serde_json::Serializer::new(&mut output);
         serde_transcode::transcode(&mut de, &mut ser)?;
         Ok(String::from_utf8(output)?)
@@ -689,17 +1020,56 @@ impl ArbData {
 
     /// Returns the JSON/CBOR data field as a CBOR string.
     pub fn get_cbor(&self) -> &[u8] {
-        &self.cbor
+        if self.cbor.is_empty() {
+            EMPTY_CBOR
+        } else {
+            &self.cbor[..]
+        }
+    }
+
+    /// Returns the CBOR encoding of the value at the given JSON pointer
+    /// (RFC 6901) within the JSON/CBOR data field, such as `/noise/t1` or
+    /// `/qubits/3`.
+    ///
+    /// Only the values along the path are parsed, so this is much faster than
+    /// decoding the whole object when only one value is needed.
+    pub fn get_cbor_at(&self, pointer: &str) -> Result<&[u8]> {
+        cbor_canon::lookup(self.get_cbor(), pointer)
+    }
+
+    /// Decodes the value at the given JSON pointer within the JSON/CBOR data
+    /// field, without decoding the rest of the object.
+    pub fn get_cbor_value<T: DeserializeOwned>(&self, pointer: &str) -> Result<T> {
+        serde_cbor::from_slice(self.get_cbor_at(pointer)?).or_else(|e| {
+            inv_arg(format!(
+                "unexpected value type at JSON pointer {}: {}",
+                pointer, e
+            ))
+        })
     }
 
     /// Provides a reference to the binary argument vector.
     pub fn get_args(&self) -> &[Vec<u8>] {
-        &self.args
+        &self.args[..]
     }
 
     /// Provides a mutable reference to the binary argument vector.
+    ///
+    /// If the arguments are shared with a clone of this `ArbData`, they are
+    /// copied first.
     pub fn get_args_mut(&mut self) -> &mut Vec<Vec<u8>> {
-        &mut self.args
+        self.args.make_mut()
+    }
+
+    /// Provides a reference to the shared-memory binary argument vector.
+    pub fn get_shared_args(&self) -> &[SharedArg] {
+        &self.shared
+    }
+
+    /// Provides a mutable reference to the shared-memory binary argument
+    /// vector.
+    pub fn get_shared_args_mut(&mut self) -> &mut Vec<SharedArg> {
+        &mut self.shared
     }
 
     /// Sets the JSON/CBOR data field by means of a JSON string.
@@ -710,25 +1080,42 @@ impl ArbData {
         if let Err(e) = serde_transcode::transcode(&mut de, &mut ser) {
             inv_arg(e.to_string())
         } else {
-            self.cbor = cbor_canon::canonizalize(&output)?;
-            Ok(())
+            self.set_cbor(output)
         }
     }
 
     /// Sets the JSON/CBOR data field by means of a CBOR string.
     pub fn set_cbor(&mut self, cbor: impl AsRef<[u8]>) -> Result<()> {
-        self.cbor = cbor_canon::canonizalize(cbor.as_ref())?;
+        let cbor = cbor.as_ref();
+        if cbor == EMPTY_CBOR {
+            self.cbor.clear();
+        } else {
+            self.set_cbor_unchecked(cbor_canon::canonizalize(cbor)?);
+        }
         Ok(())
     }
 
+    /// Sets the JSON/CBOR data field by means of a CBOR string, without
+    /// validating it.
+    ///
+    /// The same restrictions as for `from_cbor_unchecked()` apply.
+    pub fn set_cbor_unchecked(&mut self, cbor: impl Into<Vec<u8>>) {
+        let cbor = cbor.into();
+        if cbor == EMPTY_CBOR {
+            self.cbor.clear();
+        } else {
+            self.cbor = CowVec::from(cbor);
+        }
+    }
+
     /// Provides a reference to the binary argument vector.
     pub fn set_args(&mut self, args: impl Into<Vec<Vec<u8>>>) {
-        self.args = args.into();
+        self.args = CowVec::from(args.into());
     }
 
     /// Resets the CBOR to an empty object.
     pub fn clear_cbor(&mut self) {
-        self.set_cbor(EMPTY_CBOR).unwrap();
+        self.cbor.clear();
     }
 
     /// Clears the binary arguments vector.
@@ -736,16 +1123,23 @@ impl ArbData {
         self.args.clear();
     }
 
-    /// Clears the CBOR object and binary arguments vector.
+    /// Clears the shared-memory binary arguments vector.
+    pub fn clear_shared_args(&mut self) {
+        self.shared.clear();
+    }
+
+    /// Clears the CBOR object and both binary arguments vectors.
     pub fn clear(&mut self) {
         self.clear_cbor();
         self.clear_args();
+        self.clear_shared_args();
     }
 
     /// Copies the data from another ArbData to this one.
     pub fn copy_from(&mut self, src: &ArbData) {
-        self.cbor = src.get_cbor().to_vec();
-        self.args = src.get_args().to_vec();
+        self.cbor.clone_from(&src.cbor);
+        self.args.clone_from(&src.args);
+        self.shared.clone_from(&src.shared);
     }
 }
 
@@ -768,13 +1162,11 @@ impl ::std::str::FromStr for ArbData {
     /// and zero binary arguments, use `default()`.
     fn from_str(s: &str) -> std::result::Result<Self, Self::Err> {
         let mut iterator = s.chars();
-        let mut output = ArbData {
-            cbor: cbor_canon::canonizalize(&ArbData::scan_json_arg(&mut iterator)?)?,
-            args: vec![],
-        };
+        let mut output = ArbData::default();
+        output.set_cbor(ArbData::scan_json_arg(&mut iterator)?)?;
         match iterator.next() {
             Some(',') => {
-                output.args = ArbData::scan_unstructured_args(&mut iterator)?;
+                output.args = CowVec::from(ArbData::scan_unstructured_args(&mut iterator)?);
                 Ok(output)
             }
             Some(c) => inv_arg(format!(
@@ -816,15 +1208,16 @@ impl Default for ArbData {
     /// arguments.
     fn default() -> Self {
         ArbData {
-            cbor: EMPTY_CBOR.to_owned(),
-            args: vec![],
+            cbor: CowVec::default(),
+            args: CowVec::default(),
+            shared: vec![],
         }
     }
 }
 
 #[cfg(test)]
 mod test {
-    use super::ArbData;
+    use super::{ArbData, SharedArg};
     use serde_json::json;
     use std::str::FromStr;
 
@@ -891,6 +1284,25 @@ mod test {
         );
     }
 
+    #[test]
+    fn empty_cbor() {
+        let mut data = ArbData::from_json("{\"test\": 42}", vec![]).unwrap();
+        assert_ne!(data, ArbData::default());
+        data.set_json(" { } ").unwrap();
+        assert_eq!(data, ArbData::default());
+        assert_eq!(data.get_cbor(), &[0xA0]);
+        assert_eq!(
+            ArbData::from_cbor_unchecked(vec![0xA0], vec![]),
+            ArbData::default()
+        );
+
+        // The serialized form contains the actual CBOR object.
+        let serialized = serde_json::to_string(&data).unwrap();
+        assert_eq!(serialized, "{\"cbor\":[160],\"args\":[],\"shared\":[]}");
+        let deserialized: ArbData = serde_json::from_str(&serialized).unwrap();
+        assert_eq!(deserialized, ArbData::default());
+    }
+
     #[test]
     fn eq() {
         let args: Vec<Vec<u8>> = vec![b"x", b"y", b"z"]
@@ -901,4 +1313,56 @@ mod test {
         let data_ = ArbData::from_json(json!({"test": 42}).to_string(), args).unwrap();
         assert_eq!(data, data_);
     }
+
+    #[test]
+    fn get_cbor_value() {
+        let data = ArbData::from_json(
+            r#"{"noise": {"t1": 1.5e-5, "qubits": [3, 4]}, "name": "x"}"#,
+            vec![],
+        )
+        .unwrap();
+        assert_eq!(data.get_cbor_value::<f64>("/noise/t1").unwrap(), 1.5e-5);
+        assert_eq!(data.get_cbor_value::<f64>("/noise/qubits/1").unwrap(), 4.0);
+        assert_eq!(data.get_cbor_value::<i64>("/noise/qubits/0").unwrap(), 3);
+        assert_eq!(data.get_cbor_value::<String>("/name").unwrap(), "x");
+        assert!(data.get_cbor_value::<i64>("/name").is_err());
+        assert!(data.get_cbor_value::<i64>("/noise/t2").is_err());
+    }
+
+    #[test]
+    fn copy_on_write() {
+        let data = ArbData::from_json(r#"{"a": 1}"#, vec![b"x".to_vec()]).unwrap();
+        let mut copy = data.clone();
+        assert!(std::ptr::eq(data.get_cbor(), copy.get_cbor()));
+        assert!(std::ptr::eq(data.get_args(), copy.get_args()));
+
+        copy.get_args_mut().push(b"y".to_vec());
+        assert_eq!(data.get_args(), &[b"x".to_vec()]);
+        assert_eq!(copy.get_args(), &[b"x".to_vec(), b"y".to_vec()]);
+        assert!(std::ptr::eq(data.get_cbor(), copy.get_cbor()));
+
+        copy.set_json(r#"{"a": 2}"#).unwrap();
+        assert_eq!(data.get_json().unwrap(), r#"{"a":1}"#);
+        assert_eq!(copy.get_json().unwrap(), r#"{"a":2}"#);
+    }
+
+    #[cfg(target_os = "linux")]
+    #[test]
+    fn shared_args() {
+        let mut data = ArbData::from_args(vec![b"x".to_vec()]);
+        data.get_shared_args_mut()
+            .push(SharedArg::from_bytes(&[1, 2, 3]).unwrap());
+        assert_ne!(data, ArbData::from_args(vec![b"x".to_vec()]));
+
+        let received: ArbData =
+            serde_cbor::from_slice(&serde_cbor::to_vec(&data).unwrap()).unwrap();
+        assert_eq!(received, data);
+        assert_eq!(received.get_shared_args()[0].as_bytes(), &[1, 2, 3]);
+
+        let mut copy = ArbData::default();
+        copy.copy_from(&data);
+        assert_eq!(copy, data);
+        copy.clear();
+        assert!(copy.get_shared_args().is_empty());
+    }
 }
@@ -1,10 +1,17 @@
 use crate::common::{
     error::{inv_arg, Result},
+    gates::{UnboundUnitaryGate, UnitaryGateType},
     types::{ArbData, Matrix, QubitRef},
 };
 use num_complex::Complex64;
-use serde::{Deserialize, Serialize};
-use std::{collections::HashSet, convert::TryInto};
+use serde::{de, Deserialize, Deserializer, Serialize, Serializer};
+use std::{
+    collections::HashSet,
+    convert::{TryFrom, TryInto},
+    fmt,
+    hash::{Hash, Hasher},
+    sync::{Arc, OnceLock},
+};
 
 /// Represents a type of quantum or mixed quantum-classical gate.
 #[derive(Debug, Eq, PartialEq, Clone, Serialize, Deserialize, Hash)]
@@ -71,8 +78,48 @@ pub enum GateType {
     Custom(String),
 }
 
+/// Symbolic description of the matrix of a unitary gate in terms of a
+/// predefined gate type.
+#[derive(Debug, Clone, Copy, PartialEq, Serialize, Deserialize)]
+struct Predefined {
+    /// The predefined gate type.
+    gate_type: UnitaryGateType,
+    /// The rotation angle, for the RX, RY, RZ, and Phase gate types.
+    theta: Option<f64>,
+}
+
+impl Predefined {
+    /// Returns whether the angle is specified if and only if the gate type
+    /// needs it, and the gate type is not otherwise parameterized.
+    fn is_valid(self) -> bool {
+        if self.gate_type.is_rotation() {
+            self.theta.is_some()
+        } else {
+            self.theta.is_none() && !self.gate_type.is_parameterized()
+        }
+    }
+
+    /// Constructs the matrix described by this object, which must be valid.
+    fn to_matrix(self) -> Matrix {
+        match (self.gate_type, self.theta) {
+            (UnitaryGateType::RX, Some(theta)) => UnboundUnitaryGate::RX(theta).into(),
+            (UnitaryGateType::RY, Some(theta)) => UnboundUnitaryGate::RY(theta).into(),
+            (UnitaryGateType::RZ, Some(theta)) => UnboundUnitaryGate::RZ(theta).into(),
+            (UnitaryGateType::Phase, Some(theta)) => UnboundUnitaryGate::Phase(theta).into(),
+            (gate_type, _) => Matrix::try_from(gate_type).unwrap(),
+        }
+    }
+}
+
 /// Represents a type of quantum or mixed quantum-classical gate.
-#[derive(Debug, Eq, PartialEq, Clone, Serialize, Deserialize, Hash)]
+///
+/// When serialized, the matrix of a gate that is known to be a predefined
+/// gate is replaced by the predefined gate type, and is reconstructed from it
+/// when deserialized. This saves sending up to 32 floating point numbers per
+/// gate over the gatestream.
+///
+/// Rotation gates constructed with `new_rotation()` are stored symbolically.
+/// Their matrix is only computed when it is first requested.
 pub struct Gate {
     /// Type of gate. See enum definition. The significance of the targets,
     /// controls, measures, and matrix fields is documented there.
@@ -87,11 +134,154 @@ pub struct Gate {
     /// The set of qubits measured by this gate.
     measures: Vec<QubitRef>,
 
-    /// An optional matrix.
-    matrix: Option<Matrix>,
+    /// An optional matrix. For gates with a symbolic predefined form, this
+    /// is only filled in when the matrix is first requested.
+    matrix: OnceLock<Matrix>,
 
     /// User-defined classical data to pass along with the gate.
     pub data: ArbData,
+
+    /// The predefined gate that the matrix of this unitary gate is exactly
+    /// equal to, if known. This allows detectors to recognize the gate
+    /// without comparing matrices. It is not a part of the identity of the
+    /// gate, so it does not take part in equality and hashing.
+    predefined: Option<Predefined>,
+}
+
+/// Wraps an optional matrix in the lazily initialized cell used by `Gate`.
+fn matrix_cell(matrix: Option<Matrix>) -> OnceLock<Matrix> {
+    match matrix {
+        Some(matrix) => OnceLock::from(matrix),
+        None => OnceLock::new(),
+    }
+}
+
+/// Serialized form of a gate, borrowing from the original.
+#[derive(Serialize)]
+struct GateWireRef<'a> {
+    typ: &'a GateType,
+    targets: &'a [QubitRef],
+    controls: &'a [QubitRef],
+    measures: &'a [QubitRef],
+    matrix: Option<&'a Matrix>,
+    data: &'a ArbData,
+    predefined: Option<Predefined>,
+}
+
+/// Deserialized form of a gate. The matrix is omitted when the predefined
+/// gate type is known.
+#[derive(Deserialize)]
+struct GateWire {
+    typ: GateType,
+    targets: Vec<QubitRef>,
+    controls: Vec<QubitRef>,
+    measures: Vec<QubitRef>,
+    matrix: Option<Matrix>,
+    data: ArbData,
+    predefined: Option<Predefined>,
+}
+
+impl Serialize for Gate {
+    fn serialize<S: Serializer>(&self, serializer: S) -> std::result::Result<S::Ok, S::Error> {
+        GateWireRef {
+            typ: &self.typ,
+            targets: &self.targets,
+            controls: &self.controls,
+            measures: &self.measures,
+            matrix: if self.predefined.is_some() {
+                None
+            } else {
+                self.matrix.get()
+            },
+            data: &self.data,
+            predefined: self.predefined,
+        }
+        .serialize(serializer)
+    }
+}
+
+impl<'de> Deserialize<'de> for Gate {
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> std::result::Result<Gate, D::Error> {
+        let wire = GateWire::deserialize(deserializer)?;
+        if let Some(predefined) = wire.predefined {
+            if !predefined.is_valid() {
+                return Err(de::Error::custom("invalid predefined gate"));
+            }
+        }
+        Ok(Gate {
+            typ: wire.typ,
+            targets: wire.targets,
+            controls: wire.controls,
+            measures: wire.measures,
+            matrix: matrix_cell(wire.matrix),
+            data: wire.data,
+            predefined: wire.predefined,
+        })
+    }
+}
+
+impl Clone for Gate {
+    fn clone(&self) -> Self {
+        Gate {
+            typ: self.typ.clone(),
+            targets: self.targets.clone(),
+            controls: self.controls.clone(),
+            measures: self.measures.clone(),
+            matrix: self.matrix.clone(),
+            data: self.data.clone(),
+            predefined: self.predefined,
+        }
+    }
+
+    /// Overwrites this gate with a copy of `source`, reusing the buffers of
+    /// the qubit lists and the attached data where possible. This allows
+    /// gate objects to be recycled without allocating for every gate.
+    fn clone_from(&mut self, source: &Self) {
+        self.typ.clone_from(&source.typ);
+        self.targets.clone_from(&source.targets);
+        self.controls.clone_from(&source.controls);
+        self.measures.clone_from(&source.measures);
+        self.matrix = source.matrix.clone();
+        self.data.copy_from(&source.data);
+        self.predefined = source.predefined;
+    }
+}
+
+impl PartialEq for Gate {
+    fn eq(&self, other: &Gate) -> bool {
+        self.typ == other.typ
+            && self.targets == other.targets
+            && self.controls == other.controls
+            && self.measures == other.measures
+            && self.get_matrix() == other.get_matrix()
+            && self.data == other.data
+    }
+}
+
+impl Eq for Gate {}
+
+impl Hash for Gate {
+    fn hash<H: Hasher>(&self, state: &mut H) {
+        self.typ.hash(state);
+        self.targets.hash(state);
+        self.controls.hash(state);
+        self.measures.hash(state);
+        self.get_matrix().hash(state);
+        self.data.hash(state);
+    }
+}
+
+impl fmt::Debug for Gate {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.debug_struct("Gate")
+            .field("typ", &self.typ)
+            .field("targets", &self.targets)
+            .field("controls", &self.controls)
+            .field("measures", &self.measures)
+            .field("matrix", &self.get_matrix())
+            .field("data", &self.data)
+            .finish()
+    }
 }
 
 impl Gate {
@@ -138,8 +328,50 @@ impl Gate {
             targets,
             controls,
             measures: vec![],
-            matrix: Some(matrix),
+            matrix: OnceLock::from(matrix),
             data: ArbData::default(),
+            predefined: None,
+        })
+    }
+
+    /// Constructs a new single-qubit rotation gate of the given predefined
+    /// type, which must be RX, RY, RZ, or Phase.
+    ///
+    /// The gate is stored symbolically; its matrix is only computed when it
+    /// is first requested.
+    pub fn new_rotation(
+        gate_type: UnitaryGateType,
+        theta: f64,
+        target: QubitRef,
+        controls: impl IntoIterator<Item = QubitRef>,
+    ) -> Result<Gate> {
+        let controls: Vec<QubitRef> = controls.into_iter().collect();
+
+        // Check the gate type.
+        if !gate_type.is_rotation() {
+            return inv_arg(format!("{:?} is not a rotation gate", gate_type));
+        }
+
+        // Enforce uniqueness of the qubits.
+        let mut set = HashSet::new();
+        for qubit in Some(&target).into_iter().chain(controls.iter()) {
+            if !set.insert(qubit) {
+                return inv_arg(format!("qubit {} is used more than once", qubit));
+            }
+        }
+
+        // Construct the Gate structure.
+        Ok(Gate {
+            typ: GateType::Unitary,
+            targets: vec![target],
+            controls,
+            measures: vec![],
+            matrix: OnceLock::new(),
+            data: ArbData::default(),
+            predefined: Some(Predefined {
+                gate_type,
+                theta: Some(theta),
+            }),
         })
     }
 
@@ -178,8 +410,9 @@ impl Gate {
             targets: vec![],
             controls: vec![],
             measures,
-            matrix: Some(matrix),
+            matrix: OnceLock::from(matrix),
             data: ArbData::default(),
+            predefined: None,
         })
     }
 
@@ -218,8 +451,9 @@ impl Gate {
             targets,
             controls: vec![],
             measures: vec![],
-            matrix: Some(matrix),
+            matrix: OnceLock::from(matrix),
             data: ArbData::default(),
+            predefined: None,
         })
     }
 
@@ -266,8 +500,9 @@ impl Gate {
             targets,
             controls,
             measures,
-            matrix,
+            matrix: matrix_cell(matrix),
             data,
+            predefined: None,
         })
     }
 
@@ -301,15 +536,50 @@ impl Gate {
     }
 
     /// Returns the gate matrix.
+    ///
+    /// For rotation gates that are stored symbolically, the matrix is
+    /// computed when this is first called.
     pub fn get_matrix(&self) -> Option<&Matrix> {
-        self.matrix.as_ref()
+        match self.predefined {
+            Some(predefined) => Some(self.matrix.get_or_init(|| predefined.to_matrix())),
+            None => self.matrix.get(),
+        }
+    }
+
+    /// Returns the predefined gate type that the matrix of this gate is known
+    /// to be equal to, if any.
+    ///
+    /// This is set for gates constructed through a converter for such a gate
+    /// type, and propagated through the gatestream. Gates with an equal
+    /// matrix that were constructed differently may not have it set. Of the
+    /// parameterized gate types, only the rotations are tracked; see
+    /// `get_predefined_angle()`.
+    pub fn get_predefined(&self) -> Option<UnitaryGateType> {
+        self.predefined.map(|predefined| predefined.gate_type)
+    }
+
+    /// Returns the rotation angle of a symbolically stored RX, RY, RZ, or
+    /// Phase gate.
+    pub fn get_predefined_angle(&self) -> Option<f64> {
+        self.predefined.and_then(|predefined| predefined.theta)
+    }
+
+    /// Marks the matrix of this gate as being exactly the matrix of the given
+    /// non-parameterized predefined gate type.
+    pub(crate) fn set_predefined(&mut self, gate_type: UnitaryGateType) {
+        debug_assert!(!gate_type.is_parameterized());
+        self.predefined = Some(Predefined {
+            gate_type,
+            theta: None,
+        });
     }
 
     /// Returns a new Gate with its controls moved to the matrix.
     pub fn with_matrix_controls(&self) -> Self {
         let num_controls = self.controls.len();
         if self.typ == GateType::Unitary && num_controls > 0 {
-            let matrix = self.matrix.as_ref().unwrap().add_controls(num_controls);
+            let matrix =
+                Matrix::clone(&self.get_matrix().unwrap().add_controls_cached(num_controls));
             let mut targets = self.controls.clone();
             targets.append(&mut self.targets.clone());
             Gate {
@@ -317,33 +587,63 @@ impl Gate {
                 targets,
                 controls: vec![],
                 measures: self.measures.to_vec(),
-                matrix: Some(matrix),
+                matrix: OnceLock::from(matrix),
                 data: self.data.clone(),
+                predefined: None,
             }
         } else {
             self.clone()
         }
     }
 
+    /// Returns the matrix of a unitary gate with its control qubits folded
+    /// in, such that the first `get_controls().len()` qubits of the matrix
+    /// are the control qubits, followed by the targets. This is the matrix
+    /// that `with_matrix_controls()` would yield, but the result is shared
+    /// through the controlled-matrix cache, so repeated calls for the same
+    /// gate do not copy or recompute it. Returns None for gates other than
+    /// unitary gates.
+    pub fn get_controlled_matrix(&self) -> Option<Arc<Matrix>> {
+        if self.typ == GateType::Unitary {
+            self.get_matrix()
+                .map(|matrix| matrix.add_controls_cached(self.controls.len()))
+        } else {
+            None
+        }
+    }
+
     /// Returns a new Gate with controls encoded in the matrix moved to the
     /// Gate controls field. Forwards the epsilon and ignore_global_phase args
     /// to the Matrix::strip_control method.
     pub fn with_gate_controls(&self, epsilon: f64, ignore_global_phase: bool) -> Self {
         if self.typ == GateType::Unitary {
-            let matrix = self.matrix.as_ref().unwrap();
-            let (control_set, matrix) = matrix.strip_control(epsilon, ignore_global_phase);
+            let stripped = self
+                .get_matrix()
+                .unwrap()
+                .strip_control_cached(epsilon, ignore_global_phase);
+            let (control_set, matrix) = &*stripped;
             let mut targets = self.get_targets().to_vec();
             let mut controls = vec![];
             for c in control_set {
-                controls.push(targets.remove(c));
+                controls.push(targets.remove(*c));
             }
+
+            // The predefined gate type only remains valid if the matrix was
+            // not modified.
+            let predefined = if controls.is_empty() {
+                self.predefined
+            } else {
+                None
+            };
+
             Gate {
                 typ: self.typ.clone(),
                 targets,
                 controls,
                 measures: self.measures.to_vec(),
-                matrix: Some(matrix),
+                matrix: OnceLock::from(matrix.clone()),
                 data: self.data.clone(),
+                predefined,
             }
         } else {
             self.clone()
@@ -362,6 +662,7 @@ impl Gate {
             measures: vec![QubitRef::null(); self.measures.len()],
             matrix: self.matrix.clone(),
             data: self.data.clone(),
+            predefined: self.predefined,
         }
     }
 }
@@ -369,11 +670,35 @@ impl Gate {
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::common::gates::BoundUnitaryGate;
 
     fn qref(q: u64) -> QubitRef {
         QubitRef::from_foreign(q).unwrap()
     }
 
+    #[test]
+    fn compact_serialization() {
+        let tagged = Gate::from(BoundUnitaryGate::SWAP(qref(1), qref(2)));
+        let untagged = Gate::new_unitary(
+            vec![qref(1), qref(2)],
+            vec![],
+            tagged.get_matrix().unwrap().clone(),
+        )
+        .unwrap();
+        assert_eq!(tagged, untagged);
+
+        let tagged_cbor = serde_cbor::to_vec(&tagged).unwrap();
+        let untagged_cbor = serde_cbor::to_vec(&untagged).unwrap();
+        assert!(tagged_cbor.len() * 3 < untagged_cbor.len());
+
+        let tagged_copy: Gate = serde_cbor::from_slice(&tagged_cbor).unwrap();
+        assert_eq!(tagged_copy, tagged);
+        assert_eq!(tagged_copy.get_predefined(), Some(UnitaryGateType::SWAP));
+        let untagged_copy: Gate = serde_cbor::from_slice(&untagged_cbor).unwrap();
+        assert_eq!(untagged_copy, untagged);
+        assert_eq!(untagged_copy.get_predefined(), None);
+    }
+
     #[test]
     fn new_unitary_no_targets() {
         let targets = vec![];
@@ -672,7 +997,19 @@ mod tests {
             Complex64::new(1f64, 0f64),
         ];
         let g = Gate::new_unitary(targets, controls, matrix).unwrap();
-        assert_eq!(serde_json::to_string(&g).unwrap(), "{\"typ\":\"Unitary\",\"targets\":[1],\"controls\":[2],\"measures\":[],\"matrix\":{\"data\":[{\"re\":1.0,\"im\":0.0},{\"re\":0.0,\"im\":0.0},{\"re\":0.0,\"im\":0.0},{\"re\":1.0,\"im\":0.0}],\"dimension\":2},\"data\":{\"cbor\":[160],\"args\":[]}}");
+        assert_eq!(serde_json::to_string(&g).unwrap(), "{\"typ\":\"Unitary\",\"targets\":[1],\"controls\":[2],\"measures\":[],\"matrix\":{\"data\":[{\"re\":1.0,\"im\":0.0},{\"re\":0.0,\"im\":0.0},{\"re\":0.0,\"im\":0.0},{\"re\":1.0,\"im\":0.0}],\"dimension\":2},\"data\":{\"cbor\":[160],\"args\":[],\"shared\":[]}}");
+    }
+
+    #[test]
+    fn clone_from() {
+        let mut gate =
+            Gate::new_unitary(vec![qref(1), qref(2)], vec![], Matrix::new_identity(4)).unwrap();
+        let source =
+            Gate::new_unitary(vec![qref(4)], vec![qref(5)], Matrix::new_identity(2)).unwrap();
+        let targets = gate.targets.as_ptr();
+        gate.clone_from(&source);
+        assert_eq!(gate, source);
+        assert_eq!(gate.targets.as_ptr(), targets);
     }
 
     #[test]
@@ -721,5 +1058,18 @@ mod tests {
         let cnot = x.with_matrix_controls();
         assert_eq!(cnot.get_controls(), &[]);
         assert_eq!(cnot.get_targets(), &[qref(2), qref(1)]);
+
+        let controlled = x.get_controlled_matrix().unwrap();
+        assert_eq!(&*controlled, cnot.get_matrix().unwrap());
+        assert!(Arc::ptr_eq(
+            &controlled,
+            &x.get_controlled_matrix().unwrap()
+        ));
+        assert!(
+            Gate::new_measurement(vec![qref(1)], Matrix::new_identity(2))
+                .unwrap()
+                .get_controlled_matrix()
+                .is_none()
+        );
     }
 }
@@ -8,21 +8,135 @@ use serde::{Deserialize, Serialize};
 #[cfg(feature = "bindings")]
 use std::os::raw::c_double;
 use std::{
-    collections::HashSet,
+    collections::{hash_map::DefaultHasher, HashMap, HashSet},
     convert::TryFrom,
     f64::consts::FRAC_1_SQRT_2,
     fmt,
-    fmt::{Display, Formatter},
+    fmt::{Debug, Display, Formatter},
     hash::{Hash, Hasher},
     ops::{Index, IndexMut},
+    sync::{Arc, Mutex, MutexGuard, OnceLock, PoisonError},
 };
 
+/// Number of independent accumulators used by the reduction kernels. Keeping
+/// the partial sums in separate lanes allows the compiler to map them onto
+/// SIMD registers, which it cannot do for a single floating-point accumulator
+/// without changing the rounding behavior.
+const LANES: usize = 4;
+
+/// Number of elements reduced between the early-exit checks of the
+/// comparison functions.
+const BLOCK: usize = 16;
+
+/// Returns the sum of `f(i)` for `i` in `0..len`, using `LANES` independent
+/// accumulators.
+#[inline(always)]
+fn lane_sum<T, F>(len: usize, f: F) -> T
+where
+    T: Copy + Default + std::ops::Add<Output = T>,
+    F: Fn(usize) -> T,
+{
+    let mut acc = [T::default(); LANES];
+    let full = len - len % LANES;
+    for base in (0..full).step_by(LANES) {
+        for (lane, acc) in acc.iter_mut().enumerate() {
+            *acc = *acc + f(base + lane);
+        }
+    }
+    let mut sum = (full..len).fold(T::default(), |sum, i| sum + f(i));
+    for acc in acc.iter() {
+        sum = sum + *acc;
+    }
+    sum
+}
+
+/// Returns the sum of the squared magnitudes of `a[i] - b[i] * phase`.
+fn sum_sqr_error(a: &[Complex64], b: &[Complex64], phase: Complex64) -> f64 {
+    let b = &b[..a.len()];
+    lane_sum(a.len(), |i| (a[i] - b[i] * phase).norm_sqr())
+}
+
+/// Returns the sum of the squared magnitudes of the elements of `a`.
+fn sum_norm_sqr(a: &[Complex64]) -> f64 {
+    lane_sum(a.len(), |i| a[i].norm_sqr())
+}
+
+/// Returns the inner product of `a` and `b`, i.e. the sum of
+/// `a[i] * conj(b[i])`.
+fn inner_product(a: &[Complex64], b: &[Complex64]) -> Complex64 {
+    let b = &b[..a.len()];
+    lane_sum(a.len(), |i| a[i] * b[i].conj())
+}
+
+/// Quantization step applied to the (dephased) elements of a matrix when
+/// computing its fingerprint.
+const FINGERPRINT_STEP: f64 = 1.0 / 1024.0;
+
+/// The maximum number of results kept by the controlled-matrix cache.
+const CONTROL_CACHE_CAPACITY: usize = 256;
+
+/// The maximum dimension of the matrices kept by the controlled-matrix
+/// cache. Larger matrices are rare and would make the cache very large, so
+/// operations on them are not memoized.
+const CONTROL_CACHE_MAX_DIMENSION: usize = 64;
+
+/// The result of `Matrix::strip_control()`: the indices of the control
+/// qubits and the submatrix.
+pub type StrippedMatrix = (HashSet<usize>, Matrix);
+
+/// Process-wide cache for the results of `Matrix::add_controls()` and
+/// `Matrix::strip_control()`, used by the `_cached` variants of these
+/// functions.
+///
+/// Entries are bucketed by the fingerprint of the input matrix, which is
+/// cached by the matrix itself (and is usually known already for gates that
+/// went through a `ConverterMap`), and then compared exactly, so a hit
+/// always returns the result for exactly the same input. The cache is
+/// cleared when it is full.
+#[derive(Default)]
+struct ControlCache {
+    /// Results of `add_controls()`, keyed by fingerprint and number of
+    /// controls.
+    added: HashMap<(u64, usize), Vec<(Matrix, Arc<Matrix>)>>,
+    /// Results of `strip_control()`, keyed by fingerprint, epsilon bits, and
+    /// whether global phase is ignored.
+    stripped: HashMap<(u64, u64, bool), Vec<(Matrix, Arc<StrippedMatrix>)>>,
+    /// The total number of results in the cache.
+    len: usize,
+}
+
+impl ControlCache {
+    /// Returns the process-wide cache.
+    fn global() -> &'static Mutex<ControlCache> {
+        static CACHE: OnceLock<Mutex<ControlCache>> = OnceLock::new();
+        CACHE.get_or_init(Default::default)
+    }
+
+    /// Locks the given cache. A panic while the cache was locked leaves it
+    /// consistent, so poisoning is ignored.
+    fn lock(cache: &Mutex<ControlCache>) -> MutexGuard<ControlCache> {
+        cache.lock().unwrap_or_else(PoisonError::into_inner)
+    }
+
+    /// Makes room for a new result.
+    fn reserve(&mut self) {
+        if self.len >= CONTROL_CACHE_CAPACITY {
+            *self = ControlCache::default();
+        }
+        self.len += 1;
+    }
+}
+
 /// Matrix wrapper for `Gate` matrices.
-#[derive(Clone, Debug, Serialize, Deserialize)]
+///
+/// The elements are reference-counted and copied on write, so cloning a
+/// matrix, for instance when a gate is forwarded or its matrix is queried
+/// through the API, does not copy the elements.
+#[derive(Clone, Serialize, Deserialize)]
 pub struct Matrix {
-    /// The elements in the matrix stored as a `Vec<Complex64>`.
+    /// The elements in the matrix stored as a shared `Vec<Complex64>`.
     #[serde(with = "complex_serde")]
-    data: Vec<Complex64>,
+    data: Arc<Vec<Complex64>>,
     /// Dimension of inner data.
     dimension: usize,
     // TODO: we can't have serde skip the above field because then it becomes 0
@@ -30,11 +144,23 @@ pub struct Matrix {
     // meh though that the serialization format now allows receiving a broken
     // matrix. OTOH, it could already do that, since for serde there's no square
     // number check on data.len().
+    /// Lazily computed fingerprint of the matrix; see `fingerprint()`.
+    #[serde(skip)]
+    fingerprint: OnceLock<u64>,
+}
+
+impl Debug for Matrix {
+    fn fmt(&self, f: &mut Formatter) -> fmt::Result {
+        f.debug_struct("Matrix")
+            .field("data", &self.data)
+            .field("dimension", &self.dimension)
+            .finish()
+    }
 }
 
-/// This mod provides ser/de for Vec<Complex64>.
+/// This mod provides ser/de for Arc<Vec<Complex64>>.
 mod complex_serde {
-    use super::Complex64;
+    use super::{Arc, Complex64};
     use serde::{
         ser::SerializeSeq,
         {Deserialize, Deserializer, Serialize, Serializer},
@@ -60,14 +186,16 @@ mod complex_serde {
         seq.end()
     }
 
-    pub fn deserialize<'de, D>(deserializer: D) -> std::result::Result<Vec<Complex64>, D::Error>
+    pub fn deserialize<'de, D>(
+        deserializer: D,
+    ) -> std::result::Result<Arc<Vec<Complex64>>, D::Error>
     where
         D: Deserializer<'de>,
     {
         #[derive(Deserialize)]
         struct Wrapper(#[serde(with = "Complex64Def")] Complex64);
         let v = Vec::deserialize(deserializer)?;
-        Ok(v.into_iter().map(|Wrapper(c)| c).collect())
+        Ok(Arc::new(v.into_iter().map(|Wrapper(c)| c).collect()))
     }
 }
 
@@ -106,7 +234,8 @@ impl Index<(usize, usize)> for Matrix {
 
 impl IndexMut<(usize, usize)> for Matrix {
     fn index_mut(&mut self, index: (usize, usize)) -> &mut Self::Output {
-        &mut self.data[index.0 * self.dimension + index.1]
+        self.fingerprint = OnceLock::new();
+        &mut Arc::make_mut(&mut self.data)[index.0 * self.dimension + index.1]
     }
 }
 
@@ -119,7 +248,8 @@ impl Index<usize> for Matrix {
 
 impl IndexMut<usize> for Matrix {
     fn index_mut(&mut self, index: usize) -> &mut Self::Output {
-        &mut self.data[index]
+        self.fingerprint = OnceLock::new();
+        &mut Arc::make_mut(&mut self.data)[index]
     }
 }
 
@@ -135,7 +265,9 @@ impl IntoIterator for Matrix {
     type IntoIter = std::vec::IntoIter<Self::Item>;
 
     fn into_iter(self) -> Self::IntoIter {
-        self.data.into_iter()
+        Arc::try_unwrap(self.data)
+            .unwrap_or_else(|data| (*data).clone())
+            .into_iter()
     }
 }
 
@@ -162,7 +294,8 @@ impl Matrix {
         }
         Ok(Matrix {
             dimension: elements.len().integer_sqrt(),
-            data: elements,
+            data: Arc::new(elements),
+            fingerprint: OnceLock::new(),
         })
     }
 
@@ -185,30 +318,52 @@ impl Matrix {
             return false;
         }
         let phase_delta = if ignore_global_phase {
-            let phase_delta =
-                self.data
-                    .iter()
-                    .zip(other.data.iter())
-                    .fold(c!(0.), |mut phase_delta, (a, b)| {
-                        phase_delta += a * b.conj();
-                        phase_delta
-                    });
+            let phase_delta = inner_product(&self.data, &other.data);
             phase_delta / phase_delta.norm()
         } else {
             c!(1.)
         };
-        self.data
-            .iter()
-            .zip(other.data.iter())
-            .try_fold(epsilon * epsilon, |mut tolerance, (a, b)| {
-                tolerance -= (a - b * phase_delta).norm_sqr();
-                if tolerance.is_sign_negative() {
-                    None
-                } else {
-                    Some(tolerance)
-                }
-            })
-            .is_some()
+        let mut tolerance = epsilon * epsilon;
+        for (a, b) in self.data.chunks(BLOCK).zip(other.data.chunks(BLOCK)) {
+            tolerance -= sum_sqr_error(a, b, phase_delta);
+            if tolerance.is_sign_negative() {
+                return false;
+            }
+        }
+        true
+    }
+
+    /// Returns a hash of this Matrix that does not depend on its global phase
+    /// or on small numerical differences between its elements.
+    ///
+    /// The matrix is dephased using the first element with a squared
+    /// magnitude of at least half the average of a unitary matrix, and the
+    /// elements are then quantized before hashing. Matrices that are
+    /// approximately equal, ignoring global phase, thus almost always have
+    /// the same fingerprint, allowing them to be looked up in a hash table.
+    /// Elements that lie close to a quantization boundary or to the pivot
+    /// threshold can still put approximately equal matrices in different
+    /// buckets, so a fingerprint mismatch does not rule out a match.
+    ///
+    /// The fingerprint is computed when it is first needed and cached until
+    /// the matrix is modified.
+    pub fn fingerprint(&self) -> u64 {
+        *self.fingerprint.get_or_init(|| {
+            let threshold = 0.5 / self.dimension.max(1) as f64;
+            let phase = self
+                .data
+                .iter()
+                .find(|x| x.norm_sqr() >= threshold)
+                .map_or(c!(1.), |x| x.unscale(x.norm()).conj());
+            let mut hasher = DefaultHasher::new();
+            self.dimension.hash(&mut hasher);
+            for x in self.data.iter() {
+                let x = x * phase;
+                ((x.re / FINGERPRINT_STEP).round() as i64).hash(&mut hasher);
+                ((x.im / FINGERPRINT_STEP).round() as i64).hash(&mut hasher);
+            }
+            hasher.finish()
+        })
     }
 
     /// Approximately compares two matrices representing bases with each other.
@@ -264,41 +419,129 @@ impl Matrix {
         let mut tolerance = epsilon * epsilon;
 
         // Check if result of matrix multiplication of self and our hermetian
-        // is identity.
+        // is identity. Element (i, j) of this product is the inner product of
+        // rows i and j. The product is itself hermetian, so we only compute
+        // its upper triangle, and count the off-diagonal elements twice.
         for i in 0..self.dimension {
-            for j in 0..self.dimension {
-                let element = (0..self.dimension).fold(Complex64::new(0., 0.), |acc, k| {
-                    acc + (self[i * self.dimension + k] * self[j * self.dimension + k].conj())
-                });
-                let expected = if i == j {
-                    Complex64::new(1., 0.)
-                } else {
-                    Complex64::new(0., 0.)
-                };
-                tolerance -= (expected - element).norm_sqr();
-                if tolerance < 0. {
-                    return false;
-                }
+            let row_i = self.row(i);
+            tolerance -= (c!(1.) - inner_product(row_i, row_i)).norm_sqr();
+            for j in i + 1..self.dimension {
+                tolerance -= 2. * inner_product(row_i, self.row(j)).norm_sqr();
+            }
+            if tolerance < 0. {
+                return false;
             }
         }
         true
     }
 
+    /// Returns the matrix product of this Matrix and `rhs`, i.e. the Matrix
+    /// that applies `rhs` first and then this Matrix.
+    pub fn multiply(&self, rhs: &Matrix) -> Result<Matrix> {
+        let dimension = self.dimension();
+        if rhs.dimension() != dimension {
+            return inv_arg(format!(
+                "cannot multiply matrices of dimension {} and {}",
+                dimension,
+                rhs.dimension()
+            ));
+        }
+        // Accumulate scaled rows of rhs into each output row, such that all
+        // inner loops run over contiguous memory. Gate matrices tend to be
+        // sparse, so zero elements are skipped.
+        let mut data = vec![c!(0.); dimension * dimension];
+        for (row, output) in data.chunks_mut(dimension.max(1)).enumerate() {
+            for (k, a) in self.row(row).iter().enumerate() {
+                if *a == c!(0.) {
+                    continue;
+                }
+                for (output, b) in output.iter_mut().zip(rhs.row(k)) {
+                    *output += a * b;
+                }
+            }
+        }
+        Ok(Matrix {
+            data: Arc::new(data),
+            dimension,
+            fingerprint: OnceLock::new(),
+        })
+    }
+
+    /// Returns the Kronecker product of this Matrix and `rhs`. The qubits of
+    /// this Matrix become the most significant qubits of the result, so they
+    /// precede those of `rhs` in the target list of the resulting gate.
+    pub fn kron(&self, rhs: &Matrix) -> Matrix {
+        let dimension = self.dimension() * rhs.dimension();
+        let mut data = Vec::with_capacity(dimension * dimension);
+        for row in 0..dimension {
+            let rhs_row = rhs.row(row % rhs.dimension());
+            for a in self.row(row / rhs.dimension()) {
+                data.extend(rhs_row.iter().map(|b| a * b));
+            }
+        }
+        Matrix {
+            data: Arc::new(data),
+            dimension,
+            fingerprint: OnceLock::new(),
+        }
+    }
+
     /// Returns new Matrix with `number_of_control` qubits added.
+    ///
+    /// With zero controls, this is equivalent to `clone()`, which shares the
+    /// elements instead of copying them.
     pub fn add_controls(&self, number_of_controls: usize) -> Self {
+        if number_of_controls == 0 {
+            return self.clone();
+        }
         let dimension = self.dimension() * 2usize.pow(number_of_controls as u32);
+        let offset = dimension - self.dimension();
         let mut output = Matrix::new_identity(dimension);
+        let data = Arc::make_mut(&mut output.data);
         for row in 0..self.dimension() {
-            for col in 0..self.dimension() {
-                output[(
-                    row + dimension - self.dimension(),
-                    col + dimension - self.dimension(),
-                )] = self[(row, col)];
-            }
+            let start = (row + offset) * dimension + offset;
+            data[start..start + self.dimension()].copy_from_slice(self.row(row));
         }
         output
     }
 
+    /// Same as `add_controls()`, but memoizes the result in a process-wide
+    /// cache, such that expanding the same matrix again, for instance for
+    /// every Toffoli gate in a gatestream, only costs a lookup.
+    pub fn add_controls_cached(&self, number_of_controls: usize) -> Arc<Matrix> {
+        self.add_controls_in(ControlCache::global(), number_of_controls)
+    }
+
+    /// Implementation of `add_controls_cached()` using the given cache.
+    fn add_controls_in(
+        &self,
+        cache: &Mutex<ControlCache>,
+        number_of_controls: usize,
+    ) -> Arc<Matrix> {
+        let cacheable = 2usize
+            .checked_pow(number_of_controls as u32)
+            .and_then(|factor| factor.checked_mul(self.dimension()))
+            .map_or(false, |dimension| dimension <= CONTROL_CACHE_MAX_DIMENSION);
+        if !cacheable {
+            return Arc::new(self.add_controls(number_of_controls));
+        }
+        let key = (self.fingerprint(), number_of_controls);
+        if let Some(bucket) = ControlCache::lock(cache).added.get(&key) {
+            if let Some((_, result)) = bucket.iter().find(|(input, _)| input == self) {
+                return result.clone();
+            }
+        }
+        let result = Arc::new(self.add_controls(number_of_controls));
+        let mut cache = ControlCache::lock(cache);
+        cache.reserve();
+        cache
+            .added
+            .entry(key)
+            .or_default()
+            .push((self.clone(), result.clone()));
+        result
+    }
+
     /// Returns new Matrix with control behavior removed from the Matrix, and
     /// the control indices corresponding to the target qubits acting as
     /// control in the original Matrix.
@@ -344,13 +587,14 @@ impl Matrix {
         let epsilon_sqr = epsilon.powi(2);
         let mut controls_int = self.dimension() - 1;
         for i in 0..self.dimension() - 1 {
-            let mut error_sqr = 0.0;
-            for j in 0..self.dimension() {
-                if i == j {
-                    error_sqr += (self[(i, j)] - phase).norm_sqr();
-                } else {
-                    error_sqr += self[(i, j)].norm_sqr();
-                }
+            // The error is computed as the sum of the squared magnitudes of
+            // the elements, corrected for the diagonal element. Since only
+            // non-negative terms are added after the correction, the partial
+            // sums never exceed the total, so we can stop early.
+            let row = self.row(i);
+            let mut error_sqr = (row[i] - phase).norm_sqr() - row[i].norm_sqr();
+            for block in row.chunks(BLOCK) {
+                error_sqr += sum_norm_sqr(block);
                 if error_sqr > epsilon_sqr {
                     controls_int &= i;
                     if controls_int == 0 {
@@ -394,6 +638,44 @@ impl Matrix {
         (controls, Matrix::new(entries).unwrap())
     }
 
+    /// Same as `strip_control()`, but memoizes the result in a process-wide
+    /// cache, such that stripping the controls of the same matrix again only
+    /// costs a lookup.
+    pub fn strip_control_cached(
+        &self,
+        epsilon: f64,
+        ignore_global_phase: bool,
+    ) -> Arc<StrippedMatrix> {
+        self.strip_control_in(ControlCache::global(), epsilon, ignore_global_phase)
+    }
+
+    /// Implementation of `strip_control_cached()` using the given cache.
+    fn strip_control_in(
+        &self,
+        cache: &Mutex<ControlCache>,
+        epsilon: f64,
+        ignore_global_phase: bool,
+    ) -> Arc<StrippedMatrix> {
+        if self.dimension() > CONTROL_CACHE_MAX_DIMENSION {
+            return Arc::new(self.strip_control(epsilon, ignore_global_phase));
+        }
+        let key = (self.fingerprint(), epsilon.to_bits(), ignore_global_phase);
+        if let Some(bucket) = ControlCache::lock(cache).stripped.get(&key) {
+            if let Some((_, result)) = bucket.iter().find(|(input, _)| input == self) {
+                return result.clone();
+            }
+        }
+        let result = Arc::new(self.strip_control(epsilon, ignore_global_phase));
+        let mut cache = ControlCache::lock(cache);
+        cache.reserve();
+        cache
+            .stripped
+            .entry(key)
+            .or_default()
+            .push((self.clone(), result.clone()));
+        result
+    }
+
     /// Returns the number of elements in the Matrix.
     pub fn len(&self) -> usize {
         self.data.len()
@@ -414,6 +696,11 @@ impl Matrix {
         log_2(self.dimension)
     }
 
+    /// Returns the elements of the given row as a slice.
+    fn row(&self, row: usize) -> &[Complex64] {
+        &self.data[row * self.dimension..(row + 1) * self.dimension]
+    }
+
     /// Returns the element at given row and colum index.
     /// Returns `None` for out of bound indices.
     pub fn get(&self, row: usize, column: usize) -> Option<&Complex64> {
@@ -493,6 +780,96 @@ mod tests {
         assert_eq!(h, hh);
     }
 
+    #[test]
+    fn matrix_products() {
+        let x = matrix!(
+            0., 1.;
+            1., 0.;
+        );
+        let z = matrix!(
+            1., 0.;
+            0., (-1.);
+        );
+        assert_eq!(x.multiply(&x).unwrap(), Matrix::new_identity(2));
+        assert_eq!(
+            x.multiply(&z).unwrap(),
+            matrix!(
+                0., (-1.);
+                1., 0.;
+            )
+        );
+        assert!(x.multiply(&Matrix::new_identity(4)).is_err());
+
+        let xi = x.kron(&Matrix::new_identity(2));
+        assert_eq!(xi.dimension(), 4);
+        assert_eq!(xi[(0, 2)], Complex64::new(1., 0.));
+        assert_eq!(xi[(1, 3)], Complex64::new(1., 0.));
+        assert_eq!(xi[(0, 1)], Complex64::new(0., 0.));
+        assert_eq!(
+            Matrix::new_identity(2).kron(&x)[(0, 1)],
+            Complex64::new(1., 0.)
+        );
+    }
+
+    #[test]
+    fn matrix_kernels() {
+        // Use matrices larger than the lane and block sizes of the kernels.
+        let h: Matrix = UnboundUnitaryGate::H.into();
+        let h3 = h.kron(&h).kron(&h);
+        assert_eq!(h3.dimension(), 8);
+        assert!(h3.approx_unitary(1.0e-9));
+        assert!(h3
+            .multiply(&h3)
+            .unwrap()
+            .approx_eq(&Matrix::new_identity(8), 1.0e-9, false));
+
+        let mut phased = h3.clone();
+        for i in 0..phased.len() {
+            phased[i] *= Complex64::new(0., 1.);
+        }
+        assert!(phased.approx_eq(&h3, 1.0e-9, true));
+        assert!(!phased.approx_eq(&h3, 1.0e-9, false));
+
+        let mut broken = h3.clone();
+        broken[(7, 7)] += 0.1;
+        assert!(!broken.approx_unitary(1.0e-3));
+        assert!(!broken.approx_eq(&h3, 1.0e-3, true));
+        assert!(broken.approx_eq(&h3, 0.2, true));
+
+        let x: Matrix = UnboundUnitaryGate::X.into();
+        let (controls, matrix) = x.add_controls(3).strip_control(1.0e-9, false);
+        assert_eq!(controls, HashSet::from_iter(vec![0, 1, 2]));
+        assert!(matrix.approx_eq(&x, 1.0e-9, false));
+    }
+
+    #[test]
+    fn matrix_fingerprint() {
+        let x: Matrix = UnboundUnitaryGate::X.into();
+        let y: Matrix = UnboundUnitaryGate::Y.into();
+        let h: Matrix = UnboundUnitaryGate::H.into();
+        assert_ne!(x.fingerprint(), y.fingerprint());
+        assert_ne!(x.fingerprint(), h.fingerprint());
+        assert_ne!(x.fingerprint(), x.add_controls(1).fingerprint());
+
+        // Global phase and small deviations do not affect the fingerprint.
+        let mut phased = h.clone();
+        for i in 0..phased.len() {
+            phased[i] *= Complex64::from_polar(1., 1.234);
+        }
+        phased[3] += 1.0e-9;
+        assert_eq!(phased.fingerprint(), h.fingerprint());
+
+        // The cached fingerprint is invalidated by modifications.
+        let mut z = x.clone();
+        assert_eq!(z.fingerprint(), x.fingerprint());
+        z[(0, 0)] = c!(1.);
+        z[(0, 1)] = c!(0.);
+        z[(1, 0)] = c!(0.);
+        z[(1, 1)] = c!(-1.);
+        let expected: Matrix = UnboundUnitaryGate::Z.into();
+        assert_eq!(z.fingerprint(), expected.fingerprint());
+    }
+
     #[test]
     fn matrix_approx_eq() {
         let x1 = matrix!(
@@ -582,6 +959,18 @@ mod tests {
         assert!(y2.basis_approx_eq(&y2, 0.));
     }
 
+    #[test]
+    fn copy_on_write() {
+        let a = Matrix::new_identity(4);
+        let mut b = a.clone();
+        assert!(Arc::ptr_eq(&a.data, &b.data));
+        assert!(Arc::ptr_eq(&a.data, &a.add_controls(0).data));
+        b[(0, 1)] = c!(1.);
+        assert!(!Arc::ptr_eq(&a.data, &b.data));
+        assert_eq!(a, Matrix::new_identity(4));
+        assert_eq!(b[(0, 1)], c!(1.));
+    }
+
     #[test]
     fn add_controls() {
         let x: Matrix = UnboundUnitaryGate::X.into();
@@ -597,6 +986,41 @@ mod tests {
         ));
     }
 
+    #[test]
+    fn controls_cached() {
+        // Other tests use the process-wide cache concurrently, which may
+        // clear it at any time, so this uses a cache of its own.
+        let cache = Mutex::new(ControlCache::default());
+
+        let x: Matrix = UnboundUnitaryGate::X.into();
+        let toffoli = x.add_controls_in(&cache, 2);
+        assert_eq!(*toffoli, x.add_controls(2));
+        assert!(Arc::ptr_eq(&toffoli, &x.add_controls_in(&cache, 2)));
+        assert!(!Arc::ptr_eq(&toffoli, &x.add_controls_in(&cache, 1)));
+
+        // Approximately equal matrices share a fingerprint, but must not
+        // share results.
+        let mut y = x.clone();
+        y[1] += c!(1.0e-9);
+        assert_eq!(x.fingerprint(), y.fingerprint());
+        assert_eq!(*y.add_controls_in(&cache, 2), y.add_controls(2));
+
+        let stripped = toffoli.strip_control_in(&cache, 0.0001, false);
+        assert_eq!(*stripped, toffoli.strip_control(0.0001, false));
+        assert!(Arc::ptr_eq(
+            &stripped,
+            &toffoli.strip_control_in(&cache, 0.0001, false)
+        ));
+        assert!(!Arc::ptr_eq(
+            &stripped,
+            &toffoli.strip_control_in(&cache, 0.0001, true)
+        ));
+
+        // The process-wide cache gives the same results.
+        assert_eq!(*x.add_controls_cached(2), *toffoli);
+        assert_eq!(*toffoli.strip_control_cached(0.0001, false), *stripped);
+    }
+
     #[test]
     fn strip_control() {
         let cnot_a = matrix!(
@@ -17,6 +17,10 @@ pub use qubit_ref::{QubitRef, QubitRefGenerator};
 mod arb_data;
 pub use arb_data::ArbData;
 
+// Binary arguments backed by shared memory.
+mod shared_arg;
+pub use shared_arg::{with_exported_shared_args, with_inline_shared_args, SharedArg};
+
 // User-defined/implementation-specific commands.
 mod arb_cmd;
 pub use arb_cmd::ArbCmd;
@@ -40,3 +44,15 @@ pub use plugin_metadata::PluginMetadata;
 // Matrix wrapper for gate matrices.
 mod matrix;
 pub use matrix::{Basis, Matrix};
+
+// Performance counters collected by plugins.
+mod stats;
+pub use stats::{DurationHistogram, PluginStats};
+
+// Histograms of measurement outcomes recorded by frontends.
+mod outcome_histogram;
+pub use outcome_histogram::OutcomeHistogram;
+
+// Timeline events recorded by plugins when tracing is enabled.
+mod trace_event;
+pub use trace_event::{TraceEvent, TraceEventKind};
@@ -0,0 +1,112 @@
+use serde::{Deserialize, Serialize};
+use std::collections::HashMap;
+
+/// Histogram of measurement outcomes recorded by a frontend.
+///
+/// Each outcome is a bitstring of up to 64 bits packed into a `u64`, for
+/// instance the measurement results of a register with bit i representing
+/// qubit i. Frontends record one outcome per shot, and the histograms are
+/// shipped to the host along with the responses to run requests, so the
+/// host can read back the counts for many shots at once instead of
+/// receiving and parsing a message for every shot.
+#[derive(Debug, Clone, Default, PartialEq, Serialize, Deserialize)]
+pub struct OutcomeHistogram {
+    /// The number of times each outcome was recorded.
+    counts: HashMap<u64, u64>,
+}
+
+impl OutcomeHistogram {
+    /// Records the given outcome once.
+    pub fn record(&mut self, outcome: u64) {
+        self.record_count(outcome, 1);
+    }
+
+    /// Records the given outcome `count` times.
+    pub fn record_count(&mut self, outcome: u64, count: u64) {
+        if count > 0 {
+            *self.counts.entry(outcome).or_insert(0) += count;
+        }
+    }
+
+    /// Adds the counts of another histogram to this one.
+    pub fn merge(&mut self, other: OutcomeHistogram) {
+        if self.counts.is_empty() {
+            self.counts = other.counts;
+        } else {
+            for (outcome, count) in other.counts {
+                self.record_count(outcome, count);
+            }
+        }
+    }
+
+    /// Returns the number of times the given outcome was recorded.
+    pub fn count(&self, outcome: u64) -> u64 {
+        self.counts.get(&outcome).cloned().unwrap_or(0)
+    }
+
+    /// Returns the total number of recorded outcomes.
+    pub fn total(&self) -> u64 {
+        self.counts.values().sum()
+    }
+
+    /// Returns the number of distinct outcomes.
+    pub fn len(&self) -> usize {
+        self.counts.len()
+    }
+
+    /// Returns whether no outcomes were recorded.
+    pub fn is_empty(&self) -> bool {
+        self.counts.is_empty()
+    }
+
+    /// Returns the distinct outcomes and their counts, sorted by outcome.
+    pub fn entries(&self) -> Vec<(u64, u64)> {
+        let mut entries: Vec<_> = self
+            .counts
+            .iter()
+            .map(|(&outcome, &count)| (outcome, count))
+            .collect();
+        entries.sort_unstable();
+        entries
+    }
+
+    /// Removes all recorded outcomes.
+    pub fn clear(&mut self) {
+        self.counts.clear();
+    }
+
+    /// Takes the recorded outcomes, leaving an empty histogram.
+    pub fn take(&mut self) -> OutcomeHistogram {
+        std::mem::replace(self, OutcomeHistogram::default())
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn histogram() {
+        let mut histogram = OutcomeHistogram::default();
+        assert!(histogram.is_empty());
+        histogram.record(3);
+        histogram.record(0);
+        histogram.record(3);
+        histogram.record_count(1, 0);
+        assert_eq!(histogram.len(), 2);
+        assert_eq!(histogram.total(), 3);
+        assert_eq!(histogram.count(3), 2);
+        assert_eq!(histogram.count(1), 0);
+        assert_eq!(histogram.entries(), vec![(0, 1), (3, 2)]);
+
+        let mut other = OutcomeHistogram::default();
+        other.record(1);
+        other.record(3);
+        histogram.merge(other.take());
+        assert!(other.is_empty());
+        assert_eq!(histogram.entries(), vec![(0, 1), (1, 1), (3, 3)]);
+
+        histogram.clear();
+        assert_eq!(histogram.total(), 0);
+    }
+}
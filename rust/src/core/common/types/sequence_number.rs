@@ -35,6 +35,12 @@ impl SequenceNumber {
         }
     }
 
+    /// Returns the sequence number that comes the given number of sequence
+    /// numbers before this one, saturating at `SequenceNumber::none()`.
+    pub fn preceding_by(self, count: u64) -> SequenceNumber {
+        SequenceNumber(self.0.saturating_sub(count))
+    }
+
     /// "None" value for sequence numbers, used to indicate that nothing has
     /// been transferred yet.
     pub fn none() -> SequenceNumber {
@@ -128,6 +134,9 @@ mod tests {
         assert!(sn.acknowledges(SequenceNumber(1)));
         assert!(sn.acknowledges(SequenceNumber(2)));
         assert!(!sn.acknowledges(SequenceNumber(3)));
+        assert_eq!(sn.preceding_by(0), SequenceNumber(2));
+        assert_eq!(sn.preceding_by(2), SequenceNumber(0));
+        assert_eq!(sn.preceding_by(5), SequenceNumber(0));
     }
 
     #[test]
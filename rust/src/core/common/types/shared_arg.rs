@@ -0,0 +1,453 @@
+//! Binary arguments backed by shared memory.
+//!
+//! Regular `ArbData` binary arguments are serialized along with the rest of
+//! the message whenever they cross a process boundary, which is expensive
+//! for multi-megabyte payloads such as initial state vectors or noise
+//! models. A `SharedArg` instead stores its contents in a sealed (read-only)
+//! memfd region. When it is sent to another process, only a reference to the
+//! memfd is serialized; the receiver opens the memfd through `/proc` and maps
+//! the same physical pages, so the contents are never copied.
+//!
+//! Each process that holds a `SharedArg` keeps the memfd open, such that it
+//! can forward the argument to further processes, and the kernel releases the
+//! memory when the last process drops it. Consequently, a serialized
+//! reference is only valid as long as the sending process still holds the
+//! argument. Senders therefore serialize their messages within
+//! `with_exported_shared_args()`, and hold on to the arguments it returns
+//! until the receiver acknowledges the message:
+//!
+//!  - the simulator keeps the arguments of a request to a plugin until the
+//!    plugin responds;
+//!  - a plugin keeps the arguments of its responses to the simulator until
+//!    the simulator sends its next request;
+//!  - an upstream plugin keeps the arguments of a pipelined gatestream
+//!    request until the downstream plugin reports its completion, and those
+//!    of an `ArbCmd` until the downstream plugin responds to it.
+//!
+//! Gatestream responses, such as measurement data, are not acknowledged, so
+//! these are always serialized with the contents inline.
+//!
+//! Files must remain readable after the run, so human-readable formats (the
+//! YAML reproduction files) store the contents inline as well, and so do
+//! binary formats when they are serialized within
+//! `with_inline_shared_args()`.
+//!
+//! Shared arguments are only supported on Linux.
+
+use crate::common::error::{inv_arg, Result};
+use serde::{de::Error as _, Deserialize, Deserializer, Serialize, Serializer};
+use std::{
+    cell::{Cell, RefCell},
+    fmt,
+    fs::File,
+    hash::{Hash, Hasher},
+    ops::Deref,
+    os::unix::{fs::MetadataExt, io::AsRawFd},
+    sync::Arc,
+};
+
+/// `memfd_create()` flags and the file seals used to make the region
+/// read-only. Defined here because not all versions of the libc crate export
+/// them.
+#[cfg(target_os = "linux")]
+const MFD_CLOEXEC: libc::c_uint = 0x0001;
+#[cfg(target_os = "linux")]
+const MFD_ALLOW_SEALING: libc::c_uint = 0x0002;
+#[cfg(target_os = "linux")]
+const F_ADD_SEALS: libc::c_int = 1033;
+#[cfg(target_os = "linux")]
+const F_GET_SEALS: libc::c_int = 1034;
+#[cfg(target_os = "linux")]
+const SEALS: libc::c_int = 0x0002 | 0x0004 | 0x0008; // SHRINK | GROW | WRITE
+
+thread_local! {
+    /// Whether shared arguments are currently (de)serialized by value.
+    static INLINE: Cell<bool> = Cell::new(false);
+
+    /// The shared arguments serialized by reference so far within the
+    /// innermost `with_exported_shared_args()` call, if any.
+    static EXPORTED: RefCell<Option<Vec<SharedArg>>> = RefCell::new(None);
+}
+
+/// Restores the previous inline flag when dropped, such that it is also
+/// restored when the closure passed to `with_inline_shared_args()` panics.
+struct InlineGuard(bool);
+
+impl Drop for InlineGuard {
+    fn drop(&mut self) {
+        INLINE.with(|inline| inline.set(self.0));
+    }
+}
+
+/// Runs the given closure such that shared arguments (de)serialized by it
+/// using any format are stored by value rather than by reference. This must
+/// be used when writing or reading files.
+pub fn with_inline_shared_args<T>(f: impl FnOnce() -> T) -> T {
+    let _guard = InlineGuard(INLINE.with(|inline| inline.replace(true)));
+    f()
+}
+
+/// Restores the previous export list when dropped, for the same reason as
+/// `InlineGuard`.
+struct ExportGuard(Option<Vec<SharedArg>>);
+
+impl Drop for ExportGuard {
+    fn drop(&mut self) {
+        EXPORTED.with(|exported| exported.replace(self.0.take()));
+    }
+}
+
+/// Runs the given closure, returning the shared arguments that it serialized
+/// by reference along with its result. The references can only be resolved
+/// by the receiver as long as the returned arguments are kept alive.
+pub fn with_exported_shared_args<T>(f: impl FnOnce() -> T) -> (T, Vec<SharedArg>) {
+    let guard = ExportGuard(EXPORTED.with(|exported| exported.replace(Some(vec![]))));
+    let result = f();
+    let exported = EXPORTED.with(|exported| exported.borrow_mut().take());
+    drop(guard);
+    (result, exported.unwrap_or_default())
+}
+
+/// Serialized reference to the memfd of a shared argument.
+#[derive(Serialize, Deserialize)]
+struct Handle {
+    /// The process that sent the reference.
+    pid: u32,
+
+    /// The file descriptor of the memfd within that process.
+    fd: i32,
+
+    /// The inode number of the memfd, used to detect that the file
+    /// descriptor was closed and reused in the meantime.
+    inode: u64,
+
+    /// The size of the region in bytes.
+    len: u64,
+}
+
+/// A read-only mapping of a sealed memfd.
+struct Region {
+    /// The memfd, kept open such that the region can be forwarded.
+    file: File,
+
+    /// Base address of the mapping. Dangling if the region is empty.
+    base: *const u8,
+
+    /// Size of the region in bytes.
+    len: usize,
+}
+
+// The mapping is read-only and owned by the Region.
+unsafe impl Send for Region {}
+unsafe impl Sync for Region {}
+
+impl Region {
+    /// Maps the given sealed memfd read-only.
+    fn map(file: File, len: usize) -> Result<Region> {
+        if len == 0 {
+            return Ok(Region {
+                file,
+                base: std::ptr::NonNull::dangling().as_ptr(),
+                len,
+            });
+        }
+        let base = unsafe {
+            libc::mmap(
+                std::ptr::null_mut(),
+                len,
+                libc::PROT_READ,
+                libc::MAP_SHARED,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        if base == libc::MAP_FAILED {
+            return Err(std::io::Error::last_os_error().into());
+        }
+        Ok(Region {
+            file,
+            base: base as *const u8,
+            len,
+        })
+    }
+
+    /// Creates a new memfd of the given size, lets the callback fill it,
+    /// and then seals and maps it.
+    #[cfg(target_os = "linux")]
+    fn create(len: usize, fill: impl FnOnce(&mut [u8])) -> Result<Region> {
+        use std::os::unix::io::FromRawFd;
+
+        let fd = unsafe {
+            libc::syscall(
+                libc::SYS_memfd_create,
+                b"dqcsim-arb\0".as_ptr(),
+                MFD_CLOEXEC | MFD_ALLOW_SEALING,
+            )
+        };
+        if fd < 0 {
+            return Err(std::io::Error::last_os_error().into());
+        }
+        let file = unsafe { File::from_raw_fd(fd as libc::c_int) };
+        file.set_len(len as u64)?;
+        if len > 0 {
+            // The writable mapping must be gone before the region can be
+            // sealed against writes.
+            let base = unsafe {
+                libc::mmap(
+                    std::ptr::null_mut(),
+                    len,
+                    libc::PROT_READ | libc::PROT_WRITE,
+                    libc::MAP_SHARED,
+                    file.as_raw_fd(),
+                    0,
+                )
+            };
+            if base == libc::MAP_FAILED {
+                return Err(std::io::Error::last_os_error().into());
+            }
+            fill(unsafe { std::slice::from_raw_parts_mut(base as *mut u8, len) });
+            unsafe { libc::munmap(base, len) };
+        }
+        if unsafe { libc::fcntl(file.as_raw_fd(), F_ADD_SEALS, SEALS) } != 0 {
+            return Err(std::io::Error::last_os_error().into());
+        }
+        Region::map(file, len)
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    fn create(_len: usize, _fill: impl FnOnce(&mut [u8])) -> Result<Region> {
+        Err(std::io::Error::from_raw_os_error(libc::ENOSYS).into())
+    }
+
+    /// Opens the memfd referred to by a handle received from another process
+    /// (or this one) and maps it.
+    #[cfg(target_os = "linux")]
+    fn open(handle: &Handle) -> Result<Region> {
+        let unavailable = || {
+            inv_arg(format!(
+                "shared ArbData argument from process {} is no longer available",
+                handle.pid
+            ))
+        };
+        let file = match File::open(format!("/proc/{}/fd/{}", handle.pid, handle.fd)) {
+            Ok(file) => file,
+            Err(_) => return unavailable(),
+        };
+        let metadata = file.metadata()?;
+        if metadata.ino() != handle.inode || metadata.len() != handle.len {
+            return unavailable();
+        }
+        let seals = unsafe { libc::fcntl(file.as_raw_fd(), F_GET_SEALS) };
+        if seals < 0 || seals & SEALS != SEALS {
+            return inv_arg("shared ArbData argument is not sealed");
+        }
+        Region::map(file, handle.len as usize)
+    }
+
+    #[cfg(not(target_os = "linux"))]
+    fn open(_handle: &Handle) -> Result<Region> {
+        Err(std::io::Error::from_raw_os_error(libc::ENOSYS).into())
+    }
+}
+
+impl Drop for Region {
+    fn drop(&mut self) {
+        if self.len > 0 {
+            unsafe {
+                libc::munmap(self.base as *mut libc::c_void, self.len);
+            }
+        }
+    }
+}
+
+/// An immutable binary argument stored in shared memory, as described in the
+/// [module documentation]. Cloning a `SharedArg` does not copy its contents.
+///
+/// [module documentation]: ./index.html
+#[derive(Clone)]
+pub struct SharedArg {
+    region: Arc<Region>,
+}
+
+impl SharedArg {
+    /// Creates a shared argument of the given size, the contents of which
+    /// are written by the given callback. The buffer passed to the callback
+    /// is zero-initialized and is the shared memory itself, so this avoids
+    /// the copy made by `from_bytes()`.
+    pub fn new(len: usize, fill: impl FnOnce(&mut [u8])) -> Result<SharedArg> {
+        Ok(SharedArg {
+            region: Arc::new(Region::create(len, fill)?),
+        })
+    }
+
+    /// Creates a shared argument by copying the given data into shared
+    /// memory.
+    pub fn from_bytes(data: &[u8]) -> Result<SharedArg> {
+        SharedArg::new(data.len(), |buffer| buffer.copy_from_slice(data))
+    }
+
+    /// Returns the contents of the argument.
+    pub fn as_bytes(&self) -> &[u8] {
+        unsafe { std::slice::from_raw_parts(self.region.base, self.region.len) }
+    }
+}
+
+impl Deref for SharedArg {
+    type Target = [u8];
+
+    fn deref(&self) -> &[u8] {
+        self.as_bytes()
+    }
+}
+
+impl AsRef<[u8]> for SharedArg {
+    fn as_ref(&self) -> &[u8] {
+        self.as_bytes()
+    }
+}
+
+impl PartialEq for SharedArg {
+    fn eq(&self, other: &SharedArg) -> bool {
+        Arc::ptr_eq(&self.region, &other.region) || self.as_bytes() == other.as_bytes()
+    }
+}
+
+impl Eq for SharedArg {}
+
+impl Hash for SharedArg {
+    fn hash<H: Hasher>(&self, state: &mut H) {
+        self.as_bytes().hash(state);
+    }
+}
+
+impl fmt::Debug for SharedArg {
+    fn fmt(&self, fmt: &mut fmt::Formatter) -> fmt::Result {
+        fmt.debug_struct("SharedArg")
+            .field("len", &self.region.len)
+            .finish()
+    }
+}
+
+impl Serialize for SharedArg {
+    fn serialize<S: Serializer>(&self, serializer: S) -> std::result::Result<S::Ok, S::Error> {
+        if serializer.is_human_readable() || INLINE.with(Cell::get) {
+            self.as_bytes().serialize(serializer)
+        } else {
+            EXPORTED.with(|exported| {
+                if let Some(exported) = exported.borrow_mut().as_mut() {
+                    exported.push(self.clone());
+                }
+            });
+            Handle {
+                pid: std::process::id(),
+                fd: self.region.file.as_raw_fd(),
+                inode: self
+                    .region
+                    .file
+                    .metadata()
+                    .map_err(serde::ser::Error::custom)?
+                    .ino(),
+                len: self.region.len as u64,
+            }
+            .serialize(serializer)
+        }
+    }
+}
+
+impl<'de> Deserialize<'de> for SharedArg {
+    fn deserialize<D: Deserializer<'de>>(deserializer: D) -> std::result::Result<Self, D::Error> {
+        if deserializer.is_human_readable() || INLINE.with(Cell::get) {
+            SharedArg::from_bytes(&Vec::<u8>::deserialize(deserializer)?).map_err(D::Error::custom)
+        } else {
+            Ok(SharedArg {
+                region: Arc::new(
+                    Region::open(&Handle::deserialize(deserializer)?).map_err(D::Error::custom)?,
+                ),
+            })
+        }
+    }
+}
+
+#[cfg(all(test, target_os = "linux"))]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn contents() {
+        let arg = SharedArg::new(4096, |buffer| {
+            assert!(buffer.iter().all(|byte| *byte == 0));
+            buffer[1000] = 42;
+        })
+        .unwrap();
+        assert_eq!(arg.len(), 4096);
+        assert_eq!(arg[1000], 42);
+        assert_eq!(arg, arg.clone());
+        assert_ne!(arg, SharedArg::from_bytes(&[1, 2, 3]).unwrap());
+
+        let empty = SharedArg::from_bytes(&[]).unwrap();
+        assert!(empty.is_empty());
+        assert_eq!(empty, SharedArg::from_bytes(&[]).unwrap());
+    }
+
+    #[test]
+    fn serialization() {
+        let data: Vec<u8> = (0..10000).map(|i| i as u8).collect();
+        let arg = SharedArg::from_bytes(&data).unwrap();
+
+        // Binary formats only carry a reference to the memfd, which is
+        // mapped again on the receiving side.
+        let cbor = serde_cbor::to_vec(&arg).unwrap();
+        assert!(cbor.len() < 100);
+        let received: SharedArg = serde_cbor::from_slice(&cbor).unwrap();
+        assert_eq!(received.as_bytes(), &data[..]);
+        assert_ne!(received.as_bytes().as_ptr(), arg.as_bytes().as_ptr());
+
+        // Human-readable formats carry the contents.
+        let json = serde_json::to_string(&arg).unwrap();
+        let received: SharedArg = serde_json::from_str(&json).unwrap();
+        assert_eq!(received.as_bytes(), &data[..]);
+
+        // References to arguments that have been dropped can no longer be
+        // resolved.
+        drop(arg);
+        assert!(serde_cbor::from_slice::<SharedArg>(&cbor).is_err());
+
+        // Binary files carry the contents as well.
+        let cbor = with_inline_shared_args(|| serde_cbor::to_vec(&received).unwrap());
+        assert!(cbor.len() > data.len());
+        let received: SharedArg =
+            with_inline_shared_args(|| serde_cbor::from_slice(&cbor).unwrap());
+        assert_eq!(received.as_bytes(), &data[..]);
+    }
+
+    #[test]
+    fn exports() {
+        let arg = SharedArg::from_bytes(&[1, 2, 3]).unwrap();
+
+        // The references serialized by the closure stay valid for as long as
+        // the returned arguments are kept alive, even when the original
+        // argument is dropped.
+        let (cbor, exported) = with_exported_shared_args(|| serde_cbor::to_vec(&arg).unwrap());
+        assert_eq!(exported, vec![arg.clone()]);
+        drop(arg);
+        let received: SharedArg = serde_cbor::from_slice(&cbor).unwrap();
+        assert_eq!(received.as_bytes(), &[1, 2, 3]);
+        drop(exported);
+        assert!(serde_cbor::from_slice::<SharedArg>(&cbor).is_err());
+
+        // Inline arguments are not exported.
+        let (_, exported) = with_exported_shared_args(|| {
+            with_inline_shared_args(|| serde_cbor::to_vec(&received).unwrap())
+        });
+        assert!(exported.is_empty());
+    }
+
+    #[test]
+    fn inline_panic() {
+        let result = std::panic::catch_unwind(|| {
+            with_inline_shared_args(|| panic!("oops"));
+        });
+        assert!(result.is_err());
+        assert!(!INLINE.with(Cell::get));
+    }
+}
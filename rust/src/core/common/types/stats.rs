@@ -0,0 +1,223 @@
+use serde::{Deserialize, Serialize};
+use std::{fmt, time::Duration};
+
+/// Number of buckets in a `DurationHistogram`. The last bucket collects
+/// everything from 2^31 ns (about two seconds) upwards.
+const NUM_BUCKETS: usize = 32;
+
+/// Histogram of durations with logarithmic buckets.
+///
+/// Bucket `i` counts the samples that took at least 2^(i-1) and less than
+/// 2^i nanoseconds; bucket 0 counts the samples that took less than a
+/// nanosecond. Recording a sample is just a handful of integer operations,
+/// so histograms can be updated on the hot path.
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct DurationHistogram {
+    /// The number of recorded samples.
+    count: u64,
+
+    /// The sum of all recorded samples in nanoseconds.
+    total_ns: u64,
+
+    /// The longest recorded sample in nanoseconds.
+    max_ns: u64,
+
+    /// The number of samples in each bucket.
+    buckets: Vec<u64>,
+}
+
+impl Default for DurationHistogram {
+    fn default() -> DurationHistogram {
+        DurationHistogram {
+            count: 0,
+            total_ns: 0,
+            max_ns: 0,
+            buckets: vec![0; NUM_BUCKETS],
+        }
+    }
+}
+
+impl DurationHistogram {
+    /// Records a sample.
+    pub fn record(&mut self, duration: Duration) {
+        let ns = duration.as_secs() * 1_000_000_000 + u64::from(duration.subsec_nanos());
+        let bucket = (64 - ns.leading_zeros() as usize).min(NUM_BUCKETS - 1);
+        self.count += 1;
+        self.total_ns = self.total_ns.saturating_add(ns);
+        self.max_ns = self.max_ns.max(ns);
+        self.buckets[bucket] += 1;
+    }
+
+    /// Returns the number of recorded samples.
+    pub fn count(&self) -> u64 {
+        self.count
+    }
+
+    /// Returns the sum of all recorded samples.
+    pub fn total(&self) -> Duration {
+        Duration::from_nanos(self.total_ns)
+    }
+
+    /// Returns the longest recorded sample.
+    pub fn max(&self) -> Duration {
+        Duration::from_nanos(self.max_ns)
+    }
+
+    /// Returns the average of the recorded samples, or zero if there are
+    /// none.
+    pub fn mean(&self) -> Duration {
+        if self.count == 0 {
+            Duration::from_nanos(0)
+        } else {
+            Duration::from_nanos(self.total_ns / self.count)
+        }
+    }
+
+    /// Returns the number of samples in each logarithmic bucket.
+    pub fn buckets(&self) -> &[u64] {
+        &self.buckets
+    }
+}
+
+impl fmt::Display for DurationHistogram {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        write!(
+            f,
+            "{} samples, total {:?}, mean {:?}, max {:?}",
+            self.count,
+            self.total(),
+            self.mean(),
+            self.max()
+        )
+    }
+}
+
+/// Performance statistics collected by a plugin over the course of a
+/// simulation.
+///
+/// Byte counts only include traffic through shared-memory gatestream
+/// channels; the size of messages sent through socket-based IPC channels is
+/// not known to DQCsim.
+#[derive(Debug, Clone, Default, PartialEq, Serialize, Deserialize)]
+pub struct PluginStats {
+    /// The number of gates sent downstream.
+    pub gates_sent: u64,
+
+    /// The number of gates received from upstream.
+    pub gates_received: u64,
+
+    /// The number of messages sent to the simulator and other plugins.
+    pub messages_sent: u64,
+
+    /// The number of messages received from the simulator and other plugins.
+    pub messages_received: u64,
+
+    /// The number of gatestream payload bytes sent.
+    pub bytes_sent: u64,
+
+    /// The number of gatestream payload bytes received.
+    pub bytes_received: u64,
+
+    /// Time spent sending messages.
+    pub send: DurationHistogram,
+
+    /// Time spent waiting for incoming messages.
+    pub recv: DurationHistogram,
+
+    /// The number of times a message arrived while polling for it, as
+    /// configured by the receive strategy.
+    pub spin_hits: u64,
+
+    /// The number of times polling for a message timed out, after which the
+    /// plugin blocked.
+    pub spin_misses: u64,
+
+    /// The number of times the plugin blocked in the operating system to wait
+    /// for a message.
+    pub blocked: u64,
+
+    /// Time spent blocked waiting for the downstream plugin to catch up.
+    pub sync_blocked: DurationHistogram,
+
+    /// Time spent blocked because the maximum number of requests was in
+    /// flight to the downstream plugin. This time is also included in
+    /// `sync_blocked`.
+    pub throttled: DurationHistogram,
+
+    /// Time spent in the `gate()` callback.
+    pub gate_callback: DurationHistogram,
+
+    /// Time spent in the `advance()` callback.
+    pub advance_callback: DurationHistogram,
+
+    /// Time spent in the `modify_measurement()` callback.
+    pub modify_measurement_callback: DurationHistogram,
+}
+
+impl fmt::Display for PluginStats {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        writeln!(
+            f,
+            "gates: {} sent, {} received",
+            self.gates_sent, self.gates_received
+        )?;
+        writeln!(
+            f,
+            "messages: {} sent, {} received",
+            self.messages_sent, self.messages_received
+        )?;
+        writeln!(
+            f,
+            "gatestream bytes: {} sent, {} received",
+            self.bytes_sent, self.bytes_received
+        )?;
+        writeln!(f, "send: {}", self.send)?;
+        writeln!(f, "recv: {}", self.recv)?;
+        writeln!(
+            f,
+            "receive waits: {} spin hits, {} spin misses, {} blocked",
+            self.spin_hits, self.spin_misses, self.blocked
+        )?;
+        writeln!(f, "downstream sync: {}", self.sync_blocked)?;
+        writeln!(f, "throttled: {}", self.throttled)?;
+        writeln!(f, "gate(): {}", self.gate_callback)?;
+        writeln!(f, "advance(): {}", self.advance_callback)?;
+        write!(
+            f,
+            "modify_measurement(): {}",
+            self.modify_measurement_callback
+        )
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn histogram() {
+        let mut histogram = DurationHistogram::default();
+        assert_eq!(histogram.mean(), Duration::from_nanos(0));
+        histogram.record(Duration::from_nanos(0));
+        histogram.record(Duration::from_nanos(1));
+        histogram.record(Duration::from_nanos(3));
+        histogram.record(Duration::from_nanos(4));
+        histogram.record(Duration::from_secs(100));
+        assert_eq!(histogram.count(), 5);
+        assert_eq!(histogram.max(), Duration::from_secs(100));
+        assert_eq!(histogram.total(), Duration::from_nanos(100_000_000_008));
+        assert_eq!(&histogram.buckets()[..4], &[1, 1, 1, 1]);
+        assert_eq!(histogram.buckets()[NUM_BUCKETS - 1], 1);
+        assert_eq!(histogram.buckets().iter().sum::<u64>(), 5);
+    }
+
+    #[test]
+    fn serialize() {
+        let mut stats = PluginStats::default();
+        stats.gates_sent = 3;
+        stats.send.record(Duration::from_micros(2));
+        let json = serde_json::to_string(&stats).unwrap();
+        let stats2: PluginStats = serde_json::from_str(&json).unwrap();
+        assert_eq!(stats, stats2);
+    }
+}
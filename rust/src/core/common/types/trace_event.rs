@@ -0,0 +1,40 @@
+use crate::common::types::SequenceNumber;
+use serde::{Deserialize, Serialize};
+use std::borrow::Cow;
+
+/// The kind of span a `TraceEvent` describes.
+#[derive(Debug, Clone, Copy, PartialEq, Serialize, Deserialize)]
+pub enum TraceEventKind {
+    /// Time spent in a user callback or in a blocking operation. Spans of
+    /// this kind recorded by a single plugin are properly nested.
+    Span,
+
+    /// Time between sending the gatestream request with the contained
+    /// sequence number downstream and receiving its acknowledgement. These
+    /// spans may overlap arbitrarily.
+    RoundTrip(SequenceNumber),
+}
+
+/// A span of time recorded by a plugin when tracing is enabled.
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+pub struct TraceEvent {
+    /// Name of the span, usually the name of the callback. This is only
+    /// owned after the event has been sent to the host.
+    pub name: Cow<'static, str>,
+
+    /// The kind of span.
+    pub kind: TraceEventKind,
+
+    /// Start of the span in nanoseconds since the UNIX epoch, such that the
+    /// events of different plugin processes can be put on a single timeline.
+    pub start: u64,
+
+    /// Duration of the span in nanoseconds.
+    pub duration: u64,
+
+    /// Process ID of the plugin.
+    pub pid: u32,
+
+    /// Thread ID of the plugin.
+    pub tid: u64,
+}
@@ -15,4 +15,21 @@ pub trait Accelerator {
 
     /// Waits for the accelerator to send a message to us.
     fn recv(&mut self) -> Result<ArbData>;
+
+    /// Runs a program on the accelerator the given number of times with the
+    /// same argument, and returns the return values of each run in order.
+    ///
+    /// The plugins are reused for every shot, avoiding the cost of spawning
+    /// and initializing them. It is up to the frontend to make sure that
+    /// every run starts from a clean state, for instance by freeing all
+    /// qubits it allocates before returning.
+    fn run_shots(&mut self, args: impl Into<ArbData>, num_shots: usize) -> Result<Vec<ArbData>> {
+        let args = args.into();
+        let mut results = Vec::with_capacity(num_shots);
+        for _ in 0..num_shots {
+            self.start(args.clone())?;
+            results.push(self.wait()?);
+        }
+        Ok(results)
+    }
 }
@@ -0,0 +1,39 @@
+use crate::common::shm_channel::DEFAULT_SHM_CAPACITY;
+use serde::{Deserialize, Serialize};
+
+/// Gatestream transport.
+///
+/// Specifies which kind of channel is used for the gatestream connection
+/// between a plugin and its downstream plugin.
+#[derive(Debug, Clone, Copy, PartialEq, Deserialize, Serialize)]
+pub enum GatestreamTransport {
+    /// Use a regular socket-based IPC channel. This is the default.
+    Ipc,
+
+    /// Use a ring buffer in shared memory with the given capacity in bytes,
+    /// which must be a power of two. The consumer is only woken up through
+    /// the operating system when it is waiting for messages, so this is
+    /// considerably faster than `Ipc` for long gatestreams.
+    SharedMemory(usize),
+
+    /// Move the messages to the downstream plugin thread through an
+    /// in-process channel, without serializing them. Only valid when both
+    /// plugins run as threads within the simulator process; the simulator
+    /// selects this transport instead of `Ipc` automatically when all
+    /// plugins of a simulation are threads.
+    InProcess,
+}
+
+impl GatestreamTransport {
+    /// Returns the shared-memory transport with the default ring buffer
+    /// capacity.
+    pub fn shared_memory() -> GatestreamTransport {
+        GatestreamTransport::SharedMemory(DEFAULT_SHM_CAPACITY)
+    }
+}
+
+impl Default for GatestreamTransport {
+    fn default() -> GatestreamTransport {
+        GatestreamTransport::Ipc
+    }
+}
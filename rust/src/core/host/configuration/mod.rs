@@ -6,6 +6,15 @@ pub use env_mod::EnvMod;
 mod stream_capture_mode;
 pub use stream_capture_mode::StreamCaptureMode;
 
+mod gatestream_transport;
+pub use gatestream_transport::GatestreamTransport;
+
+mod numa_policy;
+pub use numa_policy::NumaPolicy;
+
+mod receive_strategy;
+pub use receive_strategy::ReceiveStrategy;
+
 mod seed;
 pub use seed::Seed;
 
@@ -0,0 +1,30 @@
+use serde::{Deserialize, Serialize};
+
+/// NUMA memory placement policy for a plugin process.
+///
+/// The policy is applied to the plugin process before its executable is
+/// loaded, so it covers all memory the plugin allocates. This is currently
+/// only supported on Linux; spawning a plugin with a policy other than
+/// `Default` fails on other platforms.
+#[derive(Debug, Clone, PartialEq, Deserialize, Serialize)]
+pub enum NumaPolicy {
+    /// Inherit the memory policy of the simulator process. This is the
+    /// default.
+    Default,
+
+    /// Allocate memory on the given NUMA node when possible, falling back to
+    /// other nodes when it runs out of memory.
+    Preferred(usize),
+
+    /// Only allocate memory on the given NUMA nodes.
+    Bind(Vec<usize>),
+
+    /// Interleave memory allocations over the given NUMA nodes page by page.
+    Interleave(Vec<usize>),
+}
+
+impl Default for NumaPolicy {
+    fn default() -> NumaPolicy {
+        NumaPolicy::Default
+    }
+}
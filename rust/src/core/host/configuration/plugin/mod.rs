@@ -26,6 +26,11 @@ pub trait PluginConfiguration: Debug {
     /// Returns the plugin type.
     fn get_type(&self) -> PluginType;
 
+    /// Returns whether instantiating the plugin spawns a separate process.
+    fn spawns_process(&self) -> bool {
+        false
+    }
+
     /// Returns the PluginReproduction when possible. Otherwise return an
     /// error.
     fn get_reproduction(&self, path_style: ReproductionPathStyle) -> Result<PluginReproduction>;
@@ -6,7 +6,8 @@ use crate::{
     },
     host::{
         configuration::{
-            env_mod::EnvMod, plugin::log::PluginLogConfiguration,
+            env_mod::EnvMod, gatestream_transport::GatestreamTransport, numa_policy::NumaPolicy,
+            plugin::log::PluginLogConfiguration, receive_strategy::ReceiveStrategy,
             stream_capture_mode::StreamCaptureMode, timeout::Timeout, PluginConfiguration,
             ReproductionPathStyle,
         },
@@ -222,6 +223,42 @@ pub struct PluginProcessNonfunctionalConfiguration {
     /// Specifies the timeout duration to wait for the plugin to shutdown after
     /// sending the abort request.
     pub shutdown_timeout: Timeout,
+
+    /// Specifies the kind of channel used for the gatestream connection from
+    /// this plugin to its downstream plugin. Ignored for backends.
+    #[serde(default)]
+    pub downstream_transport: GatestreamTransport,
+
+    /// Specifies the maximum number of requests this plugin may have in
+    /// flight to its downstream plugin before it blocks to wait for them to
+    /// be acknowledged, or 0 for no limit. Ignored for backends.
+    #[serde(default)]
+    pub downstream_window: usize,
+
+    /// Specifies how the plugin waits for incoming gatestream messages.
+    #[serde(default)]
+    pub receive_strategy: ReceiveStrategy,
+
+    /// When specified, the messages this plugin sends to its downstream
+    /// plugin are recorded to this gatestream capture file, which can be
+    /// replayed later using the replay frontend. Ignored for backends.
+    #[serde(default)]
+    pub downstream_capture: Option<PathBuf>,
+
+    /// Specifies whether the plugin process should be kept alive after the
+    /// simulation ends, such that a subsequent simulation with a compatible
+    /// plugin configuration can reuse it instead of spawning a new process.
+    #[serde(default)]
+    pub pooled: bool,
+
+    /// Specifies the logical CPUs that the plugin process may run on. If
+    /// empty, the process inherits the CPU affinity of the simulator.
+    #[serde(default)]
+    pub cpu_affinity: Vec<usize>,
+
+    /// Specifies the NUMA memory placement policy for the plugin process.
+    #[serde(default)]
+    pub numa_policy: NumaPolicy,
 }
 
 impl Default for PluginProcessNonfunctionalConfiguration {
@@ -233,6 +270,13 @@ impl Default for PluginProcessNonfunctionalConfiguration {
             stderr_mode: StreamCaptureMode::Capture(Loglevel::Info),
             accept_timeout: Timeout::from_seconds(5),
             shutdown_timeout: Timeout::from_seconds(5),
+            downstream_transport: GatestreamTransport::default(),
+            downstream_window: 0,
+            receive_strategy: ReceiveStrategy::default(),
+            downstream_capture: None,
+            pooled: false,
+            cpu_affinity: vec![],
+            numa_policy: NumaPolicy::default(),
         }
     }
 }
@@ -294,6 +338,10 @@ impl PluginConfiguration for PluginProcessConfiguration {
         self.specification.typ
     }
 
+    fn spawns_process(&self) -> bool {
+        true
+    }
+
     fn get_reproduction(&self, path_style: ReproductionPathStyle) -> Result<PluginReproduction> {
         Ok(PluginReproduction {
             name: self.name.clone(),
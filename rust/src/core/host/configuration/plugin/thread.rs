@@ -5,7 +5,10 @@ use crate::{
         types::{ArbCmd, PluginType},
     },
     host::{
-        configuration::{PluginConfiguration, PluginLogConfiguration, ReproductionPathStyle},
+        configuration::{
+            GatestreamTransport, PluginConfiguration, PluginLogConfiguration, ReceiveStrategy,
+            ReproductionPathStyle,
+        },
         plugin::{
             thread::{PluginThread, PluginThreadClosure},
             Plugin,
@@ -15,7 +18,7 @@ use crate::{
     plugin::{definition::PluginDefinition, state::PluginState},
     trace,
 };
-use std::fmt;
+use std::{fmt, path::PathBuf};
 
 /// Represents the complete configuration for a plugin running in a local
 /// thread.
@@ -37,6 +40,30 @@ pub struct PluginThreadConfiguration {
 
     /// Configuration for the logging subsystem of the plugin.
     pub log_configuration: PluginLogConfiguration,
+
+    /// The kind of channel used for the gatestream connection from this
+    /// plugin to its downstream plugin. Ignored for backends.
+    pub downstream_transport: GatestreamTransport,
+
+    /// The maximum number of requests this plugin may have in flight to its
+    /// downstream plugin before it blocks to wait for them to be
+    /// acknowledged, or 0 for no limit. Ignored for backends.
+    pub downstream_window: usize,
+
+    /// How the plugin waits for incoming gatestream messages.
+    pub receive_strategy: ReceiveStrategy,
+
+    /// When specified, the messages this plugin sends to its downstream
+    /// plugin are recorded to this gatestream capture file. Ignored for
+    /// backends.
+    pub downstream_capture: Option<PathBuf>,
+
+    /// Whether the closure runs the plugin in the calling thread. This is
+    /// set by `new()`. Closures passed to `new_raw()` may spawn a plugin
+    /// process instead, so it is cleared there. When all plugins of a
+    /// simulation run in their thread, gatestream connections configured to
+    /// use the default IPC transport use in-process channels instead.
+    pub in_process: bool,
 }
 
 impl fmt::Debug for PluginThreadConfiguration {
@@ -46,6 +73,11 @@ impl fmt::Debug for PluginThreadConfiguration {
             .field("plugin_type", &self.plugin_type)
             .field("init_cmds", &self.init_cmds)
             .field("log_configuration", &self.log_configuration)
+            .field("downstream_transport", &self.downstream_transport)
+            .field("downstream_window", &self.downstream_window)
+            .field("receive_strategy", &self.receive_strategy)
+            .field("downstream_capture", &self.downstream_capture)
+            .field("in_process", &self.in_process)
             .finish()
     }
 }
@@ -59,14 +91,17 @@ impl PluginThreadConfiguration {
         log_configuration: PluginLogConfiguration,
     ) -> PluginThreadConfiguration {
         let plugin_type = definition.get_type();
-        PluginThreadConfiguration::new_raw(
-            Box::new(move |server| {
-                PluginState::run(&definition, server).expect("Plugin thread failed");
-                trace!("$");
-            }),
-            plugin_type,
-            log_configuration,
-        )
+        PluginThreadConfiguration {
+            in_process: true,
+            ..PluginThreadConfiguration::new_raw(
+                Box::new(move |server| {
+                    PluginState::run(&definition, server).expect("Plugin thread failed");
+                    trace!("$");
+                }),
+                plugin_type,
+                log_configuration,
+            )
+        }
     }
 
     /// Creates a new plugin through a custom closure.
@@ -82,6 +117,11 @@ impl PluginThreadConfiguration {
             plugin_type,
             init_cmds: vec![],
             log_configuration,
+            downstream_transport: GatestreamTransport::default(),
+            downstream_window: 0,
+            receive_strategy: ReceiveStrategy::default(),
+            downstream_capture: None,
+            in_process: false,
         }
     }
 
@@ -90,6 +130,40 @@ impl PluginThreadConfiguration {
         self.init_cmds.push(cmd.into());
         self
     }
+
+    /// Sets the kind of channel used for the gatestream connection to the
+    /// downstream plugin, builder style.
+    pub fn with_downstream_transport(
+        mut self,
+        transport: GatestreamTransport,
+    ) -> PluginThreadConfiguration {
+        self.downstream_transport = transport;
+        self
+    }
+
+    /// Limits the number of requests that may be in flight to the downstream
+    /// plugin, builder style. 0 means no limit.
+    pub fn with_downstream_window(mut self, window: usize) -> PluginThreadConfiguration {
+        self.downstream_window = window;
+        self
+    }
+
+    /// Sets how the plugin waits for incoming gatestream messages, builder
+    /// style.
+    pub fn with_receive_strategy(mut self, strategy: ReceiveStrategy) -> PluginThreadConfiguration {
+        self.receive_strategy = strategy;
+        self
+    }
+
+    /// Records the messages sent to the downstream plugin to the given
+    /// gatestream capture file, builder style.
+    pub fn with_downstream_capture(
+        mut self,
+        file: impl Into<PathBuf>,
+    ) -> PluginThreadConfiguration {
+        self.downstream_capture = Some(file.into());
+        self
+    }
 }
 
 impl Into<Box<dyn PluginConfiguration>> for PluginThreadConfiguration {
@@ -0,0 +1,68 @@
+use serde::{Deserialize, Serialize};
+use std::time::Duration;
+
+/// Strategy used by a plugin to wait for incoming gatestream messages.
+///
+/// Waiting for a message normally means blocking in the operating system
+/// until the sender wakes the plugin up. For tightly-coupled plugin pairs
+/// that exchange many small messages, for instance an operator that needs
+/// every measurement result from its backend, the wakeup latency can dominate
+/// the simulation time. The spinning strategies avoid this by polling for a
+/// while before blocking, at the cost of burning CPU time while waiting.
+///
+/// Polling only applies to gatestream connections that use shared memory or
+/// in-process channels; messages arriving through socket-based IPC channels
+/// are only picked up once the plugin blocks. The spin duration adapts to
+/// the traffic: it is halved every time spinning fails to receive a message,
+/// and reset to the configured duration when it succeeds, such that a plugin
+/// that is idle for a long time does not keep burning CPU time.
+#[derive(Debug, Clone, Copy, PartialEq, Deserialize, Serialize)]
+pub enum ReceiveStrategy {
+    /// Block in the operating system right away. This is the default.
+    Block,
+
+    /// Busy-poll for up to the given duration before blocking, using a
+    /// processor spin-loop hint between polls. This gives the lowest
+    /// latency, but occupies a processor core while waiting.
+    Spin(Duration),
+
+    /// Poll for up to the given duration before blocking, yielding to the
+    /// operating system scheduler between polls. This is friendlier when
+    /// there are more busy threads than processor cores.
+    Yield(Duration),
+}
+
+impl ReceiveStrategy {
+    /// Returns the maximum duration to poll for before blocking.
+    pub fn spin_time(&self) -> Duration {
+        match self {
+            ReceiveStrategy::Block => Duration::default(),
+            ReceiveStrategy::Spin(duration) | ReceiveStrategy::Yield(duration) => *duration,
+        }
+    }
+}
+
+impl Default for ReceiveStrategy {
+    fn default() -> ReceiveStrategy {
+        ReceiveStrategy::Block
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn spin_time() {
+        assert_eq!(ReceiveStrategy::default(), ReceiveStrategy::Block);
+        assert_eq!(ReceiveStrategy::Block.spin_time(), Duration::default());
+        assert_eq!(
+            ReceiveStrategy::Spin(Duration::from_micros(50)).spin_time(),
+            Duration::from_micros(50)
+        );
+        assert_eq!(
+            ReceiveStrategy::Yield(Duration::from_millis(1)).spin_time(),
+            Duration::from_millis(1)
+        );
+    }
+}
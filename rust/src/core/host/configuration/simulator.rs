@@ -6,6 +6,7 @@ use crate::{
     },
     host::configuration::{PluginConfiguration, ReproductionPathStyle, Seed},
 };
+use std::path::PathBuf;
 
 /// The complete configuration for a DQCsim run.
 #[derive(Debug)]
@@ -31,6 +32,25 @@ pub struct SimulatorConfiguration {
 
     /// The path style used when writing the reproduction file.
     pub reproduction_path_style: Option<ReproductionPathStyle>,
+
+    /// The loglevel at which the performance statistics of the plugins are
+    /// logged when the simulation is shut down, or `Off` to not log them.
+    pub stats_level: LoglevelFilter,
+
+    /// When specified, the plugins record the time they spend in their
+    /// callbacks and waiting for gatestream requests to be acknowledged, and
+    /// the resulting timeline is written to this file in the Chrome trace
+    /// event format when the simulation is shut down.
+    pub trace_file: Option<PathBuf>,
+
+    /// When specified, the host calls are streamed to this file in the binary
+    /// reproduction format as they are made, instead of being kept in memory
+    /// until a reproduction file is written.
+    pub reproduction_stream: Option<PathBuf>,
+
+    /// The logical CPUs that the log thread of the simulator may run on. If
+    /// empty, the log thread may run on any CPU.
+    pub log_thread_affinity: Vec<usize>,
 }
 
 impl SimulatorConfiguration {
@@ -82,6 +102,36 @@ impl SimulatorConfiguration {
         self
     }
 
+    /// Sets the loglevel at which plugin statistics are logged at shutdown.
+    pub fn with_stats_level(mut self, level: impl Into<LoglevelFilter>) -> SimulatorConfiguration {
+        self.stats_level = level.into();
+        self
+    }
+
+    /// Enables tracing, writing the timeline to the given file.
+    pub fn with_trace_file(mut self, trace_file: impl Into<PathBuf>) -> SimulatorConfiguration {
+        self.trace_file = Some(trace_file.into());
+        self
+    }
+
+    /// Streams the reproduction log to the given binary reproduction file.
+    pub fn with_reproduction_stream(
+        mut self,
+        reproduction_stream: impl Into<PathBuf>,
+    ) -> SimulatorConfiguration {
+        self.reproduction_stream = Some(reproduction_stream.into());
+        self
+    }
+
+    /// Restricts the log thread to the given logical CPUs.
+    pub fn with_log_thread_affinity(
+        mut self,
+        cpus: impl IntoIterator<Item = usize>,
+    ) -> SimulatorConfiguration {
+        self.log_thread_affinity = cpus.into_iter().collect();
+        self
+    }
+
     /// Disables the reproduction logging system.
     pub fn without_reproduction(mut self) -> SimulatorConfiguration {
         self.reproduction_path_style = None;
@@ -204,6 +254,10 @@ impl Default for SimulatorConfiguration {
             dqcsim_level: LoglevelFilter::Trace,
             plugins: vec![],
             reproduction_path_style: Some(ReproductionPathStyle::Keep),
+            stats_level: LoglevelFilter::Off,
+            trace_file: None,
+            reproduction_stream: None,
+            log_thread_affinity: vec![],
         }
     }
 }
@@ -5,4 +5,6 @@ pub mod configuration;
 pub mod plugin;
 pub mod reproduction;
 pub mod simulation;
+pub mod simulation_pool;
 pub mod simulator;
+pub mod trace;
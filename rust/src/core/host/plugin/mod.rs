@@ -1,6 +1,7 @@
 //! Contains structs that manage the lifetime and connections of a single
 //! plugin.
 
+pub mod pool;
 pub mod process;
 pub mod thread;
 
@@ -12,11 +13,11 @@ use crate::{
             PluginAcceptUpstreamRequest, PluginInitializeRequest, PluginInitializeResponse,
             PluginToSimulator, PluginUserInitializeRequest, SimulatorToPlugin,
         },
-        types::{ArbCmd, ArbData, PluginType},
+        types::{ArbCmd, ArbData, PluginStats, PluginType, TraceEvent},
     },
-    host::configuration::PluginLogConfiguration,
+    host::configuration::{GatestreamTransport, PluginLogConfiguration, ReceiveStrategy},
 };
-use std::fmt::Debug;
+use std::{fmt::Debug, path::PathBuf};
 
 #[macro_export]
 macro_rules! checked_rpc {
@@ -60,8 +61,54 @@ pub trait Plugin: Debug {
     /// Returns the logging configuration for this plugin.
     fn log_configuration(&self) -> PluginLogConfiguration;
 
-    /// Send the SimulatorToPlugin message to the plugin.
-    fn rpc(&mut self, msg: SimulatorToPlugin) -> Result<PluginToSimulator>;
+    /// Returns the kind of channel to use for the gatestream connection to
+    /// the downstream plugin.
+    fn downstream_transport(&self) -> GatestreamTransport {
+        GatestreamTransport::default()
+    }
+
+    /// Returns the maximum number of requests this plugin may have in flight
+    /// to the downstream plugin, or 0 for no limit.
+    fn downstream_window(&self) -> usize {
+        0
+    }
+
+    /// Returns how this plugin waits for incoming gatestream messages.
+    fn receive_strategy(&self) -> ReceiveStrategy {
+        ReceiveStrategy::default()
+    }
+
+    /// Returns the gatestream capture file that the messages this plugin
+    /// sends downstream are to be recorded to, if any.
+    fn downstream_capture(&self) -> Option<PathBuf> {
+        None
+    }
+
+    /// Returns whether this plugin runs in a thread within the simulator
+    /// process. When all plugins of a simulation do, the gatestream
+    /// connections between them use in-process channels.
+    fn in_process(&self) -> bool {
+        false
+    }
+
+    /// Send the SimulatorToPlugin message to the plugin without waiting for
+    /// the response, which must then be received using [`rpc_response`] or
+    /// [`try_rpc_response`].
+    fn rpc_request(&mut self, msg: SimulatorToPlugin) -> Result<()>;
+
+    /// Waits for the response to the request sent using [`rpc_request`].
+    fn rpc_response(&mut self) -> Result<PluginToSimulator>;
+
+    /// Returns the response to the request sent using [`rpc_request`] if it
+    /// has arrived, without blocking.
+    fn try_rpc_response(&mut self) -> Result<Option<PluginToSimulator>>;
+
+    /// Send the SimulatorToPlugin message to the plugin and wait for the
+    /// response.
+    fn rpc(&mut self, msg: SimulatorToPlugin) -> Result<PluginToSimulator> {
+        self.rpc_request(msg)?;
+        self.rpc_response()
+    }
 }
 
 impl dyn Plugin {
@@ -70,21 +117,30 @@ impl dyn Plugin {
         self.log_configuration().name
     }
 
-    /// Sends an `PluginInitializeRequest` to this plugin.
+    /// Sends an `PluginInitializeRequest` to this plugin, telling it to
+    /// connect to the given downstream plugin address using the given kind
+    /// of channel.
     pub fn initialize(
         &mut self,
         logger: &LogThread,
         downstream: &Option<String>,
+        downstream_transport: GatestreamTransport,
         seed: u64,
+        trace: bool,
     ) -> Result<PluginInitializeResponse> {
         checked_rpc!(
             self,
             PluginInitializeRequest {
                 downstream: downstream.clone(),
+                downstream_transport,
+                downstream_window: self.downstream_window(),
+                receive_strategy: self.receive_strategy(),
+                downstream_capture: self.downstream_capture(),
                 plugin_type: self.plugin_type(),
                 seed,
                 log_configuration: self.log_configuration(),
                 log_channel: logger.get_ipc_sender(),
+                trace,
             },
             expect Initialized
         )
@@ -115,4 +171,24 @@ impl dyn Plugin {
             expect ArbResponse
         )
     }
+
+    /// Requests the performance statistics collected by this plugin for the
+    /// current simulation.
+    pub fn stats(&mut self) -> Result<PluginStats> {
+        checked_rpc!(
+            self,
+            SimulatorToPlugin::StatsRequest,
+            expect Stats
+        )
+    }
+
+    /// Requests the timeline events recorded by this plugin since the
+    /// previous call.
+    pub fn trace(&mut self) -> Result<Vec<TraceEvent>> {
+        checked_rpc!(
+            self,
+            SimulatorToPlugin::TraceRequest,
+            expect Trace
+        )
+    }
 }
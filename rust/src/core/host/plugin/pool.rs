@@ -0,0 +1,113 @@
+//! Process-wide pool of idle plugin processes.
+//!
+//! Plugin processes configured with `pooled` set are not shut down when their
+//! simulation ends. Instead, they are sent a `SimulatorToPlugin::Reset`
+//! request and parked here, such that the next simulation that needs a
+//! plugin with a compatible configuration can skip spawning the process and
+//! connecting to it.
+
+use crate::{
+    common::{channel::SimulatorChannel, log::stdio::StdioTarget},
+    host::configuration::{EnvMod, NumaPolicy, PluginProcessConfiguration, StreamCaptureMode},
+    trace,
+};
+use lazy_static::lazy_static;
+use std::{path::PathBuf, process, sync::Mutex};
+
+/// The part of a plugin process configuration that is fixed once the process
+/// has been spawned. A pooled process can only be reused for a configuration
+/// with an equal key.
+#[derive(Debug, Clone, PartialEq)]
+pub struct PoolKey {
+    name: String,
+    executable: PathBuf,
+    script: Option<PathBuf>,
+    env: Vec<EnvMod>,
+    work: PathBuf,
+    stdout_mode: StreamCaptureMode,
+    stderr_mode: StreamCaptureMode,
+    cpu_affinity: Vec<usize>,
+    numa_policy: NumaPolicy,
+}
+
+impl From<&PluginProcessConfiguration> for PoolKey {
+    fn from(configuration: &PluginProcessConfiguration) -> PoolKey {
+        PoolKey {
+            name: configuration.name.clone(),
+            executable: configuration.specification.executable.clone(),
+            script: configuration.specification.script.clone(),
+            env: configuration.functional.env.clone(),
+            work: configuration.functional.work.clone(),
+            stdout_mode: configuration.nonfunctional.stdout_mode.clone(),
+            stderr_mode: configuration.nonfunctional.stderr_mode.clone(),
+            cpu_affinity: configuration.nonfunctional.cpu_affinity.clone(),
+            numa_policy: configuration.nonfunctional.numa_policy.clone(),
+        }
+    }
+}
+
+/// An idle plugin process, waiting for a new `Initialize` request.
+#[derive(Debug)]
+pub struct PooledProcess {
+    /// The configuration key this process was spawned for.
+    pub key: PoolKey,
+    /// The child process.
+    pub child: process::Child,
+    /// The channel to the plugin.
+    pub channel: SimulatorChannel,
+    /// Log targets of the stdout and stderr proxies, if captured.
+    pub stdio: Vec<StdioTarget>,
+}
+
+lazy_static! {
+    static ref POOL: Mutex<Vec<PooledProcess>> = Mutex::new(vec![]);
+}
+
+/// Takes a live process spawned for the given key out of the pool, if there
+/// is one. Processes that have exited in the meantime are discarded.
+pub fn take(key: &PoolKey) -> Option<PooledProcess> {
+    let mut pool = POOL.lock().unwrap();
+    while let Some(index) = pool.iter().position(|process| &process.key == key) {
+        let mut process = pool.swap_remove(index);
+        match process.child.try_wait() {
+            Ok(None) => return Some(process),
+            _ => trace!("Discarding pooled {} process that exited", key.name),
+        }
+    }
+    None
+}
+
+/// Parks an idle process in the pool.
+pub fn put(process: PooledProcess) {
+    for target in process.stdio.iter() {
+        target.disconnect();
+    }
+    POOL.lock().unwrap().push(process);
+}
+
+/// Returns the number of processes currently in the pool.
+pub fn len() -> usize {
+    POOL.lock().unwrap().len()
+}
+
+/// Shuts down all processes in the pool, returning how many there were.
+///
+/// The plugins have already finalized their last simulation when they were
+/// reset, so they are not sent an abort request. Closing their simulator
+/// channel is enough to make them exit.
+pub fn clear() -> usize {
+    let processes: Vec<_> = POOL.lock().unwrap().drain(..).collect();
+    let count = processes.len();
+    for process in processes {
+        let PooledProcess {
+            key,
+            mut child,
+            channel,
+            ..
+        } = process;
+        drop(channel);
+        trace!("Waiting for pooled {} process to exit", key.name);
+        let _ = child.wait();
+    }
+    count
+}
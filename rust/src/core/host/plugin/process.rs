@@ -2,24 +2,37 @@
 //! process.
 
 use crate::{
+    checked_rpc,
     common::{
+        affinity,
         channel::SimulatorChannel,
         error::{err, inv_op, ErrorKind, Result},
-        log::{stdio::proxy_stdio, thread::LogThread},
+        log::{
+            stdio::{proxy_stdio, StdioTarget},
+            thread::LogThread,
+            Loglevel,
+        },
         protocol::{PluginToSimulator, SimulatorToPlugin},
-        types::{ArbCmd, PluginType},
+        types::{with_exported_shared_args, ArbCmd, PluginType, SharedArg},
     },
     host::{
         configuration::{
-            EnvMod, PluginLogConfiguration, PluginProcessConfiguration, StreamCaptureMode, Timeout,
+            EnvMod, GatestreamTransport, NumaPolicy, PluginLogConfiguration,
+            PluginProcessConfiguration, ReceiveStrategy, StreamCaptureMode, Timeout,
+        },
+        plugin::{
+            pool::{self, PoolKey, PooledProcess},
+            Plugin,
         },
-        plugin::Plugin,
     },
     info, trace, warn,
 };
 use ipc_channel::ipc;
 use is_executable::IsExecutable;
-use std::{process, sync, thread, time};
+use std::{
+    env::current_dir, io::Read, os::unix::process::CommandExt, path::PathBuf, process, sync,
+    thread, time,
+};
 
 /// A Plugin running in a child process.
 ///
@@ -37,6 +50,12 @@ pub struct PluginProcess {
     /// The SimulatorChannel is populated by the spawn method of the Plugin
     /// trait.
     channel: Option<SimulatorChannel>,
+    /// Log targets of the stdout and stderr proxies. Only used for pooled
+    /// processes, as these outlive the log thread of the simulation.
+    stdio: Vec<StdioTarget>,
+    /// Shared arguments referenced by the pending request, which must be
+    /// kept alive until the plugin responds.
+    exported: Vec<SharedArg>,
 }
 
 impl PluginProcess {
@@ -49,6 +68,64 @@ impl PluginProcess {
             configuration,
             child: None,
             channel: None,
+            stdio: vec![],
+            exported: vec![],
+        }
+    }
+
+    /// Takes a compatible process out of the pool and connects its stdio
+    /// proxies to the given log thread. Returns false if there is none.
+    fn reuse(&mut self, logger: &LogThread) -> bool {
+        if let Some(process) = pool::take(&PoolKey::from(&self.configuration)) {
+            trace!("Reusing pooled process for {}", self.configuration.name);
+            for target in process.stdio.iter() {
+                target.connect(logger.get_sender());
+            }
+            self.child = Some(process.child);
+            self.channel = Some(process.channel);
+            self.stdio = process.stdio;
+            true
+        } else {
+            false
+        }
+    }
+
+    /// Resets the plugin and parks the process in the pool. The process is
+    /// only parked when it is still running and the reset succeeds.
+    fn recycle(&mut self) -> Result<bool> {
+        match self.child.as_mut().map(process::Child::try_wait) {
+            Some(Ok(None)) => {}
+            _ => return Ok(false),
+        }
+        checked_rpc!(self, SimulatorToPlugin::Reset)?;
+        trace!("Parking {} process in the pool", self.configuration.name);
+        pool::put(PooledProcess {
+            key: PoolKey::from(&self.configuration),
+            child: self.child.take().unwrap(),
+            channel: self.channel.take().unwrap(),
+            stdio: self.stdio.drain(..).collect(),
+        });
+        Ok(true)
+    }
+
+    /// Forwards a captured stdio stream of the child process to the log
+    /// thread. Pooled processes get a log target that can be connected to
+    /// the log thread of a later simulation.
+    fn proxy(
+        &mut self,
+        stream: Box<dyn Read + Send>,
+        suffix: &str,
+        logger: &LogThread,
+        level: Loglevel,
+    ) {
+        let name = format!("{}::{}", self.configuration.name, suffix);
+        if self.configuration.nonfunctional.pooled {
+            let target = StdioTarget::default();
+            target.connect(logger.get_sender());
+            self.stdio.push(target.clone());
+            proxy_stdio(name, stream, target, level);
+        } else {
+            proxy_stdio(name, stream, logger.get_sender(), level);
         }
     }
 }
@@ -58,7 +135,14 @@ impl Plugin for PluginProcess {
     /// The simulator address is passed as the first argument to the child
     /// process, or as the 2nd argument to the interpreter when the
     /// configuration specifies a script.
+    ///
+    /// Pooled plugins reuse an idle process from the pool if there is a
+    /// compatible one. The simulator then skips straight to initialization.
     fn spawn(&mut self, logger: &LogThread) -> Result<()> {
+        if self.configuration.nonfunctional.pooled && self.reuse(logger) {
+            return Ok(());
+        }
+
         // Setup connection channel
         let (server, server_name) = ipc::IpcOneShotServer::new()?;
 
@@ -105,25 +189,31 @@ impl Plugin for PluginProcess {
                 }
             });
 
+        // CPU affinity and NUMA policy. These are applied in the child
+        // after forking, such that the plugin starts out on the right CPUs
+        // and all its memory is allocated according to the policy.
+        let cpu_affinity = self.configuration.nonfunctional.cpu_affinity.clone();
+        let numa_policy = self.configuration.nonfunctional.numa_policy.clone();
+        if !cpu_affinity.is_empty() || numa_policy != NumaPolicy::Default {
+            unsafe {
+                command.pre_exec(move || {
+                    affinity::set_current_numa_policy(&numa_policy)?;
+                    affinity::set_current_affinity(&cpu_affinity)
+                });
+            }
+        }
+
         // Spawn child process
         self.child = Some(command.spawn()?);
 
         // Setup pipes
         if let StreamCaptureMode::Capture(level) = self.configuration.nonfunctional.stderr_mode {
-            proxy_stdio(
-                format!("{}::stderr", self.configuration.name),
-                Box::new(self.child.as_mut().unwrap().stderr.take().expect("stderr")),
-                logger.get_sender(),
-                level,
-            );
+            let stderr = self.child.as_mut().unwrap().stderr.take().expect("stderr");
+            self.proxy(Box::new(stderr), "stderr", logger, level);
         }
         if let StreamCaptureMode::Capture(level) = self.configuration.nonfunctional.stdout_mode {
-            proxy_stdio(
-                format!("{}::stdout", self.configuration.name),
-                Box::new(self.child.as_mut().unwrap().stdout.take().expect("stdout")),
-                logger.get_sender(),
-                level,
-            );
+            let stdout = self.child.as_mut().unwrap().stdout.take().expect("stdout");
+            self.proxy(Box::new(stdout), "stdout", logger, level);
         }
 
         // Connect and get channel from child process
@@ -186,9 +276,54 @@ impl Plugin for PluginProcess {
         PluginLogConfiguration::from(&self.configuration)
     }
 
-    fn rpc(&mut self, msg: SimulatorToPlugin) -> Result<PluginToSimulator> {
-        self.channel.as_ref().unwrap().0.send(msg)?;
-        Ok(self.channel.as_ref().unwrap().1.recv()?)
+    fn downstream_transport(&self) -> GatestreamTransport {
+        self.configuration.nonfunctional.downstream_transport
+    }
+
+    fn downstream_window(&self) -> usize {
+        self.configuration.nonfunctional.downstream_window
+    }
+
+    fn receive_strategy(&self) -> ReceiveStrategy {
+        self.configuration.nonfunctional.receive_strategy
+    }
+
+    /// Relative capture file paths are interpreted relative to the working
+    /// directory of the simulator, not that of the plugin.
+    fn downstream_capture(&self) -> Option<PathBuf> {
+        self.configuration
+            .nonfunctional
+            .downstream_capture
+            .as_ref()
+            .map(|file| match current_dir() {
+                Ok(dir) => dir.join(file),
+                Err(_) => file.clone(),
+            })
+    }
+
+    fn rpc_request(&mut self, msg: SimulatorToPlugin) -> Result<()> {
+        let channel = self.channel.as_ref().unwrap();
+        let (result, exported) = with_exported_shared_args(|| channel.0.send(msg));
+        result?;
+        self.exported = exported;
+        Ok(())
+    }
+
+    fn rpc_response(&mut self) -> Result<PluginToSimulator> {
+        let response = self.channel.as_ref().unwrap().1.recv()?;
+        self.exported.clear();
+        Ok(response)
+    }
+
+    fn try_rpc_response(&mut self) -> Result<Option<PluginToSimulator>> {
+        match self.channel.as_ref().unwrap().1.try_recv() {
+            Ok(response) => {
+                self.exported.clear();
+                Ok(Some(response))
+            }
+            Err(ipc::TryRecvError::Empty) => Ok(None),
+            Err(ipc::TryRecvError::IpcError(e)) => Err(e.into()),
+        }
     }
 }
 
@@ -196,16 +331,32 @@ impl Drop for PluginProcess {
     fn drop(&mut self) {
         trace!("Dropping PluginProcess");
 
+        // Try to reset pooled plugins for reuse instead of shutting them
+        // down. If that fails, the plugin has already been finalized, so we
+        // close its channel instead of sending an abort request, which makes
+        // it exit.
+        if self.configuration.nonfunctional.pooled {
+            match self.recycle() {
+                Ok(true) => return,
+                Ok(false) => {}
+                Err(e) => {
+                    warn!("Failed to reset pooled PluginProcess: {}", e);
+                    self.channel.take();
+                }
+            }
+        }
+
         if self.child.is_none() {
             trace!("PluginProcess has no child process handle");
         } else {
-            if self
-                .child
-                .as_mut()
-                .expect("Child process")
-                .try_wait()
-                .expect("PluginProcess failed")
-                .is_none()
+            if self.channel.is_some()
+                && self
+                    .child
+                    .as_mut()
+                    .expect("Child process")
+                    .try_wait()
+                    .expect("PluginProcess failed")
+                    .is_none()
             {
                 trace!(
                     "Aborting PluginProcess (timeout: {:?})",
@@ -7,17 +7,19 @@ use crate::{
         error::Result,
         log::thread::LogThread,
         protocol::{PluginToSimulator, SimulatorToPlugin},
-        types::{ArbCmd, PluginType},
+        types::{with_exported_shared_args, ArbCmd, PluginType, SharedArg},
     },
     error, fatal,
     host::{
-        configuration::{PluginLogConfiguration, PluginThreadConfiguration},
+        configuration::{
+            GatestreamTransport, PluginLogConfiguration, PluginThreadConfiguration, ReceiveStrategy,
+        },
         plugin::Plugin,
     },
     trace,
 };
 use ipc_channel::ipc;
-use std::{fmt, thread};
+use std::{fmt, path::PathBuf, thread};
 
 pub type PluginThreadClosure = Box<dyn Fn(String) + Send>;
 
@@ -28,6 +30,14 @@ pub struct PluginThread {
     plugin_type: PluginType,
     init_cmds: Vec<ArbCmd>,
     log_configuration: PluginLogConfiguration,
+    downstream_transport: GatestreamTransport,
+    downstream_window: usize,
+    receive_strategy: ReceiveStrategy,
+    downstream_capture: Option<PathBuf>,
+    in_process: bool,
+    /// Shared arguments referenced by the pending request, which must be
+    /// kept alive until the plugin responds.
+    exported: Vec<SharedArg>,
 }
 
 impl fmt::Debug for PluginThread {
@@ -50,6 +60,12 @@ impl PluginThread {
             plugin_type: configuration.plugin_type,
             init_cmds: configuration.init_cmds,
             log_configuration: configuration.log_configuration,
+            downstream_transport: configuration.downstream_transport,
+            downstream_window: configuration.downstream_window,
+            receive_strategy: configuration.receive_strategy,
+            downstream_capture: configuration.downstream_capture,
+            in_process: configuration.in_process,
+            exported: vec![],
         }
     }
 }
@@ -85,9 +101,29 @@ impl Plugin for PluginThread {
         Ok(())
     }
 
-    fn rpc(&mut self, msg: SimulatorToPlugin) -> Result<PluginToSimulator> {
-        self.channel.as_ref().unwrap().0.send(msg)?;
-        Ok(self.channel.as_ref().unwrap().1.recv()?)
+    fn rpc_request(&mut self, msg: SimulatorToPlugin) -> Result<()> {
+        let channel = self.channel.as_ref().unwrap();
+        let (result, exported) = with_exported_shared_args(|| channel.0.send(msg));
+        result?;
+        self.exported = exported;
+        Ok(())
+    }
+
+    fn rpc_response(&mut self) -> Result<PluginToSimulator> {
+        let response = self.channel.as_ref().unwrap().1.recv()?;
+        self.exported.clear();
+        Ok(response)
+    }
+
+    fn try_rpc_response(&mut self) -> Result<Option<PluginToSimulator>> {
+        match self.channel.as_ref().unwrap().1.try_recv() {
+            Ok(response) => {
+                self.exported.clear();
+                Ok(Some(response))
+            }
+            Err(ipc::TryRecvError::Empty) => Ok(None),
+            Err(ipc::TryRecvError::IpcError(e)) => Err(e.into()),
+        }
     }
 
     fn plugin_type(&self) -> PluginType {
@@ -101,6 +137,26 @@ impl Plugin for PluginThread {
     fn log_configuration(&self) -> PluginLogConfiguration {
         self.log_configuration.clone()
     }
+
+    fn downstream_transport(&self) -> GatestreamTransport {
+        self.downstream_transport
+    }
+
+    fn downstream_window(&self) -> usize {
+        self.downstream_window
+    }
+
+    fn receive_strategy(&self) -> ReceiveStrategy {
+        self.receive_strategy
+    }
+
+    fn downstream_capture(&self) -> Option<PathBuf> {
+        self.downstream_capture.clone()
+    }
+
+    fn in_process(&self) -> bool {
+        self.in_process
+    }
 }
 
 fn join_thread(handle: thread::JoinHandle<()>, name: impl fmt::Display) {
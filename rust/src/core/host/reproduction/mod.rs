@@ -15,6 +15,9 @@ use std::path::{Path, PathBuf};
 mod host_call;
 pub use host_call::HostCall;
 
+pub mod stream;
+pub use stream::{ReproductionReader, ReproductionWriter};
+
 /// The contents of a plugin configuration in a reproduction file.
 #[derive(Debug, Clone, PartialEq, Deserialize, Serialize)]
 pub struct PluginReproduction {
@@ -234,10 +237,34 @@ impl Reproduction {
     }
 
     /// Constructs a reproduction structure from a file.
+    ///
+    /// Both YAML and binary reproduction files are supported. Note that this
+    /// loads all host calls into memory; use `open()` to stream the host
+    /// calls from binary reproduction files instead.
     pub fn from_file(file: impl AsRef<Path>) -> Result<Reproduction> {
-        Ok(serde_yaml::from_reader(&mut std::fs::File::open(
-            file.as_ref(),
-        )?)?)
+        let (mut reproduction, reader) = Reproduction::open(file)?;
+        if let Some(reader) = reader {
+            reproduction.host_calls = reader.collect::<Result<Vec<_>>>()?;
+        }
+        Ok(reproduction)
+    }
+
+    /// Opens a reproduction file.
+    ///
+    /// YAML reproduction files are loaded completely. For binary reproduction
+    /// files, only the configuration is loaded; the host calls are left out
+    /// of the returned structure, and are instead returned as a reader that
+    /// reads them from the file one at a time.
+    pub fn open(file: impl AsRef<Path>) -> Result<(Reproduction, Option<ReproductionReader>)> {
+        if stream::is_stream_file(file.as_ref())? {
+            let (reproduction, reader) = ReproductionReader::open(file)?;
+            Ok((reproduction, Some(reader)))
+        } else {
+            Ok((
+                serde_yaml::from_reader(&mut std::fs::File::open(file.as_ref())?)?,
+                None,
+            ))
+        }
     }
 
     /// Writes a reproduction structure to a file.
@@ -0,0 +1,219 @@
+//! Streaming binary reproduction file format.
+//!
+//! YAML reproduction files can only be written once the run is complete,
+//! which means that all host calls must be kept in memory until then. The
+//! binary format is append-only instead: host calls are written to the file
+//! as they are recorded, and read back one at a time when the run is
+//! reproduced, so neither side needs memory proportional to the length of
+//! the run.
+//!
+//! A binary reproduction file starts with the eight-byte `MAGIC` string,
+//! followed by a sequence of records. Each record is a little-endian `u32`
+//! length followed by that many bytes of CBOR. The first record is the
+//! `Reproduction` structure with an empty host call list; each subsequent
+//! record is a single `HostCall`. If DQCsim crashes while writing a record,
+//! the truncated record is ignored when reading the file back; all calls up
+//! to that point can still be reproduced.
+
+use crate::{
+    common::{
+        error::{err, Result},
+        types::with_inline_shared_args,
+    },
+    host::reproduction::{HostCall, Reproduction},
+    warn,
+};
+use serde::{de::DeserializeOwned, Serialize};
+use std::{
+    fs::File,
+    io::{BufReader, BufWriter, ErrorKind, Read, Write},
+    path::Path,
+};
+
+/// Magic string identifying a binary reproduction file.
+pub const MAGIC: &[u8; 8] = b"DQCSREP1";
+
+/// Returns whether the given file starts with the binary reproduction file
+/// magic string.
+pub fn is_stream_file(file: impl AsRef<Path>) -> Result<bool> {
+    let mut magic = [0u8; 8];
+    match File::open(file.as_ref())?.read_exact(&mut magic) {
+        Ok(_) => Ok(&magic == MAGIC),
+        Err(ref e) if e.kind() == ErrorKind::UnexpectedEof => Ok(false),
+        Err(e) => Err(e.into()),
+    }
+}
+
+/// Appends host calls to a binary reproduction file as they are recorded.
+#[derive(Debug)]
+pub struct ReproductionWriter {
+    writer: BufWriter<File>,
+}
+
+impl ReproductionWriter {
+    /// Creates a binary reproduction file for the given reproduction
+    /// structure. The host calls already contained in the structure are
+    /// written immediately.
+    pub fn create(
+        file: impl AsRef<Path>,
+        reproduction: &Reproduction,
+    ) -> Result<ReproductionWriter> {
+        let mut writer = ReproductionWriter {
+            writer: BufWriter::new(File::create(file.as_ref())?),
+        };
+        writer.writer.write_all(MAGIC)?;
+        writer.write_record(&Reproduction {
+            seed: reproduction.seed,
+            plugins: reproduction.plugins.clone(),
+            host_calls: vec![],
+            hostname: reproduction.hostname.clone(),
+            username: reproduction.username.clone(),
+            workdir: reproduction.workdir.clone(),
+        })?;
+        for host_call in &reproduction.host_calls {
+            writer.record(host_call)?;
+        }
+        Ok(writer)
+    }
+
+    /// Appends a single record.
+    fn write_record(&mut self, value: &impl Serialize) -> Result<()> {
+        let data = with_inline_shared_args(|| serde_cbor::to_vec(value))?;
+        self.writer.write_all(&(data.len() as u32).to_le_bytes())?;
+        self.writer.write_all(&data)?;
+        Ok(())
+    }
+
+    /// Appends a host call to the file.
+    pub fn record(&mut self, host_call: &HostCall) -> Result<()> {
+        self.write_record(host_call)
+    }
+
+    /// Writes out any buffered host calls.
+    pub fn flush(&mut self) -> Result<()> {
+        self.writer.flush()?;
+        Ok(())
+    }
+}
+
+/// Reads the host calls from a binary reproduction file one at a time.
+#[derive(Debug)]
+pub struct ReproductionReader {
+    reader: BufReader<File>,
+}
+
+impl ReproductionReader {
+    /// Opens a binary reproduction file. Returns the reproduction structure
+    /// stored in the header, with an empty host call list, and a reader for
+    /// the host calls.
+    pub fn open(file: impl AsRef<Path>) -> Result<(Reproduction, ReproductionReader)> {
+        let mut reader = ReproductionReader {
+            reader: BufReader::new(File::open(file.as_ref())?),
+        };
+        let mut magic = [0u8; 8];
+        reader.reader.read_exact(&mut magic)?;
+        if &magic != MAGIC {
+            return err("not a binary reproduction file");
+        }
+        match reader.read_record()? {
+            Some(reproduction) => Ok((reproduction, reader)),
+            None => err("binary reproduction file is truncated"),
+        }
+    }
+
+    /// Reads the next record. Returns `None` at the end of the file, or if
+    /// the record is truncated.
+    fn read_record<T: DeserializeOwned>(&mut self) -> Result<Option<T>> {
+        let mut length = [0u8; 4];
+        if !self.read_all(&mut length)? {
+            return Ok(None);
+        }
+        let mut data = vec![0u8; u32::from_le_bytes(length) as usize];
+        if !self.read_all(&mut data)? {
+            warn!("Ignoring truncated record at the end of the reproduction file");
+            return Ok(None);
+        }
+        Ok(Some(with_inline_shared_args(|| {
+            serde_cbor::from_slice(&data)
+        })?))
+    }
+
+    /// Fills the given buffer. Returns false if the end of the file was
+    /// reached first.
+    fn read_all(&mut self, buffer: &mut [u8]) -> Result<bool> {
+        match self.reader.read_exact(buffer) {
+            Ok(_) => Ok(true),
+            Err(ref e) if e.kind() == ErrorKind::UnexpectedEof => Ok(false),
+            Err(e) => Err(e.into()),
+        }
+    }
+}
+
+impl Iterator for ReproductionReader {
+    type Item = Result<HostCall>;
+
+    fn next(&mut self) -> Option<Result<HostCall>> {
+        self.read_record().transpose()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::common::types::{ArbCmd, ArbData};
+    use std::{fs::OpenOptions, path::PathBuf};
+
+    fn reproduction() -> Reproduction {
+        Reproduction {
+            seed: 42,
+            plugins: vec![],
+            host_calls: vec![HostCall::Start(ArbData::default())],
+            hostname: "host".to_string(),
+            username: "user".to_string(),
+            workdir: PathBuf::from("/tmp"),
+        }
+    }
+
+    #[test]
+    fn round_trip() {
+        let file = std::env::temp_dir().join(format!("dqcsim-repro-{}.bin", std::process::id()));
+        let mut writer = ReproductionWriter::create(&file, &reproduction()).unwrap();
+        writer.record(&HostCall::Send(ArbData::default())).unwrap();
+        writer
+            .record(&HostCall::Arb(
+                "back".to_string(),
+                ArbCmd::new("a", "b", ArbData::default()),
+            ))
+            .unwrap();
+        writer.record(&HostCall::Wait).unwrap();
+        drop(writer);
+        assert!(is_stream_file(&file).unwrap());
+
+        let (header, reader) = ReproductionReader::open(&file).unwrap();
+        assert_eq!(
+            header,
+            Reproduction {
+                host_calls: vec![],
+                ..reproduction()
+            }
+        );
+        let host_calls = reader.collect::<Result<Vec<_>>>().unwrap();
+        assert_eq!(host_calls.len(), 4);
+        assert_eq!(host_calls[0], HostCall::Start(ArbData::default()));
+        assert_eq!(host_calls[3], HostCall::Wait);
+
+        // Truncate the last record; the calls before it should still be
+        // readable.
+        let length = std::fs::metadata(&file).unwrap().len();
+        OpenOptions::new()
+            .write(true)
+            .open(&file)
+            .unwrap()
+            .set_len(length - 1)
+            .unwrap();
+        let (_, reader) = ReproductionReader::open(&file).unwrap();
+        assert_eq!(reader.collect::<Result<Vec<_>>>().unwrap().len(), 3);
+
+        std::fs::remove_file(&file).unwrap();
+    }
+}
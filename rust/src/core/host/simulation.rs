@@ -2,21 +2,21 @@
 //! plugins.
 
 use crate::{
-    checked_rpc,
     common::{
         error::{err, inv_arg, inv_op, Result},
-        log::thread::LogThread,
+        log::{thread::LogThread, Loglevel},
         protocol::{FrontendRunRequest, PluginToSimulator},
-        types::{ArbCmd, ArbData, PluginMetadata},
+        types::{ArbCmd, ArbData, OutcomeHistogram, PluginMetadata, PluginStats},
     },
     debug, error, fatal,
     host::{
         accelerator::Accelerator,
-        configuration::Seed,
+        configuration::{GatestreamTransport, Seed},
         plugin::Plugin,
-        reproduction::{HostCall, Reproduction},
+        reproduction::{HostCall, Reproduction, ReproductionWriter},
+        trace::write_chrome_trace,
     },
-    info, trace,
+    info, log, trace, warn,
 };
 use rand_chacha::{
     rand_core::{RngCore, SeedableRng},
@@ -123,17 +123,34 @@ pub struct Simulation {
     /// Objects received from the accelerator, to be consumed using `recv()`.
     accelerator_to_host_data: VecDeque<ArbData>,
 
+    /// Outcomes recorded by the accelerator, accumulated over all runs until
+    /// cleared using `take_outcomes()`.
+    outcomes: OutcomeHistogram,
+
+    /// Set while a yield started using `yield_async()` has not completed
+    /// yet, i.e. the accelerator is running and its run response has not
+    /// been received.
+    yield_pending: bool,
+
     /// Reproduction storage.
     reproduction_log: Option<Reproduction>,
+
+    /// Binary reproduction file that host calls are appended to instead of
+    /// being stored in `reproduction_log`, if streaming was enabled.
+    reproduction_stream: Option<ReproductionWriter>,
 }
 
 impl Simulation {
     /// Constructs a Simulation from a collection of PluginInstance and a random seed.
+    ///
+    /// When `trace` is set, the plugins are told to record timeline events,
+    /// which can be written to a file using `write_trace()`.
     pub fn new(
         mut pipeline: Pipeline,
         seed: Seed,
         reproduction_log: Option<Reproduction>,
         logger: &LogThread,
+        trace: bool,
     ) -> Result<Simulation> {
         trace!("Constructing Simulation");
         if pipeline.len() < 2 {
@@ -153,12 +170,25 @@ impl Simulation {
             err("Failed to spawn plugin(s)")?
         }
 
+        // When all plugins run as threads within this process, gatestream
+        // messages can be moved between them without serializing them. This
+        // replaces the default IPC transport only; an explicitly configured
+        // transport is respected.
+        let in_process = pipeline.iter().all(|plugin| plugin.in_process());
+        if in_process {
+            debug!("All plugins are threads, using in-process gatestream channels");
+        }
+
         // Initialize the plugins.
         let mut downstream = None;
         let mut metadata = vec![];
         let mut rng = ChaChaRng::seed_from_u64(seed.value);
         for plugin in pipeline.iter_mut().rev() {
-            let res = plugin.initialize(logger, &downstream, rng.next_u64())?;
+            let transport = match plugin.downstream_transport() {
+                GatestreamTransport::Ipc if in_process => GatestreamTransport::InProcess,
+                transport => transport,
+            };
+            let res = plugin.initialize(logger, &downstream, transport, rng.next_u64(), trace)?;
             downstream = res.upstream;
             metadata.push(res.metadata);
         }
@@ -196,7 +226,10 @@ impl Simulation {
             state: AcceleratorState::Idle,
             host_to_accelerator_data: VecDeque::new(),
             accelerator_to_host_data: VecDeque::new(),
+            outcomes: OutcomeHistogram::default(),
+            yield_pending: false,
             reproduction_log,
+            reproduction_stream: None,
         })
     }
 
@@ -227,6 +260,22 @@ impl Simulation {
     /// Internal function used to yield to the accelerator. This is called
     /// whenever we need to block to get data from the simulation.
     fn internal_yield(&mut self) -> Result<()> {
+        self.finish_yield()?;
+        self.begin_yield()?;
+        self.finish_yield()
+    }
+
+    /// Sends the pending `start()` and `send()` data to the accelerator and
+    /// lets it run, without waiting for it to block again.
+    fn begin_yield(&mut self) -> Result<()> {
+        // Write out the host calls recorded so far, such that they survive if
+        // the simulation crashes.
+        if let Some(stream) = self.reproduction_stream.as_mut() {
+            if let Err(e) = stream.flush() {
+                warn!("Failed to write to reproduction file: {}", e.to_string());
+            }
+        }
+
         // If a `start()` is pending, move the state to `Blocked` and send the
         // start command to the accelerator.
         let start = if self.state.is_start_pending() {
@@ -240,17 +289,35 @@ impl Simulation {
         let messages = self.host_to_accelerator_data.drain(..).collect();
 
         // Send the run RPC.
-        let response = checked_rpc!(
-            self.accelerator_mut(),
-            FrontendRunRequest {
-                start,
-                messages,
-            },
-            expect RunResponse
-        )?;
+        self.accelerator_mut()
+            .rpc_request(FrontendRunRequest { start, messages }.into())?;
+        self.yield_pending = true;
+        Ok(())
+    }
+
+    /// Waits for the accelerator to block again if a yield is pending.
+    fn finish_yield(&mut self) -> Result<()> {
+        if self.yield_pending {
+            self.yield_pending = false;
+            let response = self.accelerator_mut().rpc_response()?;
+            self.complete_yield(response)?;
+        }
+        Ok(())
+    }
+
+    /// Processes the response of the accelerator to the run RPC sent by
+    /// `begin_yield()`.
+    fn complete_yield(&mut self, response: PluginToSimulator) -> Result<()> {
+        self.yield_pending = false;
+        let response = match response {
+            PluginToSimulator::RunResponse(x) => x,
+            PluginToSimulator::Failure(e) => return err(e),
+            _ => return err("Protocol error: unexpected response from plugin"),
+        };
 
         // Queue up the messages sent to us by the accelerator.
         self.accelerator_to_host_data.extend(response.messages);
+        self.outcomes.merge(response.outcomes);
 
         // If we received a `run()` return value from accelerator, move to the
         // zombie state.
@@ -266,7 +333,15 @@ impl Simulation {
 
     /// Records a host call to the reproduction log, if we have one.
     fn record_host_call(&mut self, host_call: HostCall) {
-        if let Some(log) = self.reproduction_log.as_mut() {
+        if let Some(stream) = self.reproduction_stream.as_mut() {
+            debug!("streaming host call to reproduction file: {:?}", &host_call);
+            if let Err(e) = stream.record(&host_call) {
+                warn!("Failed to write to reproduction file: {}", e.to_string());
+                warn!("Therefore, you will not be able to reproduce this run on the command line later.");
+                self.reproduction_stream = None;
+                self.reproduction_log = None;
+            }
+        } else if let Some(log) = self.reproduction_log.as_mut() {
             debug!("recording host call to reproduction log: {:?}", &host_call);
             log.record(host_call);
         }
@@ -287,6 +362,74 @@ impl Simulation {
         self.internal_yield()
     }
 
+    /// Yields to the accelerator without waiting for it to block again.
+    ///
+    /// This is the non-blocking counterpart of `yield_to_accelerator()`. It
+    /// lets a single thread drive many simulations: start a yield for every
+    /// simulation, and then call `poll_yield()` on each of them until it
+    /// returns true. Once it does, `is_wait_ready()` and `is_recv_ready()`
+    /// tell whether `wait()` and `recv()` can return without blocking.
+    ///
+    /// This function does nothing if a yield is already pending. Any other
+    /// call that interacts with the plugins first blocks until the pending
+    /// yield completes.
+    pub fn yield_async(&mut self) -> Result<()> {
+        if !self.yield_pending {
+            self.record_host_call(HostCall::Yield);
+            self.begin_yield()?;
+        }
+        Ok(())
+    }
+
+    /// Checks whether the yield started using `yield_async()` has completed,
+    /// without blocking. Returns true if it has, or if no yield was pending.
+    pub fn poll_yield(&mut self) -> Result<bool> {
+        if self.yield_pending {
+            if let Some(response) = self.accelerator_mut().try_rpc_response()? {
+                self.complete_yield(response)?;
+            }
+        }
+        Ok(!self.yield_pending)
+    }
+
+    /// Returns whether `wait()` would return the accelerator's `run()`
+    /// return value without yielding to the accelerator.
+    pub fn is_wait_ready(&self) -> bool {
+        !self.yield_pending && self.state.is_wait_pending()
+    }
+
+    /// Returns whether `recv()` would return a message without yielding to
+    /// the accelerator.
+    pub fn is_recv_ready(&self) -> bool {
+        !self.yield_pending && !self.accelerator_to_host_data.is_empty()
+    }
+
+    /// Returns the histogram of the outcomes recorded by the accelerator
+    /// using `record_outcome()`, accumulated over all runs so far.
+    ///
+    /// Outcomes are sent along with the responses of the accelerator, so this
+    /// includes everything recorded up to the last time the accelerator
+    /// blocked, for instance in `wait()`. This does not yield to the
+    /// accelerator, but it does wait for a yield started using
+    /// `yield_async()` to complete.
+    pub fn get_outcomes(&mut self) -> Result<&OutcomeHistogram> {
+        self.finish_yield()?;
+        Ok(&self.outcomes)
+    }
+
+    /// Like `get_outcomes()`, but clears the histogram, such that it only
+    /// accumulates outcomes recorded from here on.
+    pub fn take_outcomes(&mut self) -> Result<OutcomeHistogram> {
+        self.finish_yield()?;
+        Ok(self.outcomes.take())
+    }
+
+    /// Adds the given outcomes to the histogram returned by `get_outcomes()`,
+    /// for instance those returned by `Simulator::run_shots_parallel()`.
+    pub fn add_outcomes(&mut self, outcomes: OutcomeHistogram) {
+        self.outcomes.merge(outcomes);
+    }
+
     /// Sends an `ArbCmd` message to one of the plugins, referenced by name.
     ///
     /// `ArbCmd`s are executed immediately after yielding to the simulator, so
@@ -363,9 +506,91 @@ impl Simulation {
         Ok(&self.pipeline[self.convert_plugin_index(index)?].metadata)
     }
 
+    /// Requests the performance statistics collected by each plugin, in
+    /// front to back order, along with the instance names of the plugins.
+    ///
+    /// The returned names are unique. Should multiple plugins share an
+    /// instance name, all but the first get their pipeline index appended
+    /// to it, as in `name#2`.
+    ///
+    /// Unlike `arb()`, this does not yield to the accelerator first, so
+    /// asynchronous requests that are still pending are not included. It
+    /// does wait for a yield started using `yield_async()` to complete.
+    pub fn get_stats(&mut self) -> Result<Vec<(String, PluginStats)>> {
+        self.finish_yield()?;
+        let mut stats: Vec<(String, PluginStats)> = vec![];
+        for (index, p) in self.pipeline.iter_mut().enumerate() {
+            let mut name = p.plugin.name();
+            if stats.iter().any(|(n, _)| *n == name) {
+                name = format!("{}#{}", name, index);
+            }
+            stats.push((name, p.plugin.stats()?));
+        }
+        Ok(stats)
+    }
+
+    /// Writes the performance statistics of all plugins to the log at the
+    /// given level, after yielding to the accelerator to make sure that all
+    /// pending requests have been processed.
+    pub fn log_stats(&mut self, level: Loglevel) {
+        if let Err(e) = self.internal_yield() {
+            error!("Implicit yield to frontend failed: {}", e.to_string());
+        }
+        match self.get_stats() {
+            Ok(stats) => {
+                for (name, stats) in stats {
+                    for line in stats.to_string().lines() {
+                        log!(level, "{}: {}", name, line);
+                    }
+                }
+            }
+            Err(e) => error!("Failed to query plugin statistics: {}", e.to_string()),
+        }
+    }
+
+    /// Writes the timeline events recorded by the plugins since the previous
+    /// call to a file in the Chrome trace event format, after yielding to the
+    /// accelerator to make sure that all pending requests have been
+    /// processed.
+    ///
+    /// The file only contains events if tracing was enabled when the
+    /// simulation was constructed.
+    pub fn write_trace(&mut self, filename: impl AsRef<Path>) -> Result<()> {
+        self.internal_yield()?;
+        let events = self
+            .pipeline
+            .iter_mut()
+            .map(|p| Ok((p.plugin.name(), p.plugin.trace()?)))
+            .collect::<Result<Vec<_>>>()?;
+        write_chrome_trace(filename, &events)
+    }
+
+    /// Starts streaming the reproduction log to a binary reproduction file.
+    ///
+    /// The host calls recorded so far are written immediately. Afterwards,
+    /// host calls are appended to the file as they are made, instead of being
+    /// kept in memory. This means that `write_reproduction_file()` can no
+    /// longer be used.
+    pub fn stream_reproduction_file(&mut self, filename: impl AsRef<Path>) -> Result<()> {
+        if self.reproduction_stream.is_some() {
+            inv_op("the reproduction log is already being streamed to a file")
+        } else if let Some(log) = self.reproduction_log.as_mut() {
+            self.reproduction_stream = Some(ReproductionWriter::create(filename, log)?);
+            log.host_calls.clear();
+            Ok(())
+        } else {
+            inv_op(
+                "cannot stream reproduction file; \
+                 we failed earlier on when attempting to construct the logger.",
+            )
+        }
+    }
+
     /// Writes a the reproduction log to a file.
     pub fn write_reproduction_file(&self, filename: impl AsRef<Path>) -> Result<()> {
-        if let Some(log) = &self.reproduction_log {
+        if self.reproduction_stream.is_some() {
+            inv_op("the reproduction log is being streamed to a binary reproduction file")
+        } else if let Some(log) = &self.reproduction_log {
             log.to_file(filename)
         } else {
             inv_op(
@@ -399,6 +624,7 @@ impl Accelerator for Simulation {
     ///
     /// Deadlocks are detected and prevented by throwing an error message.
     fn wait(&mut self) -> Result<ArbData> {
+        self.finish_yield()?;
         if self.state.is_idle() {
             inv_op("accelerator is not running; call start() first")
         } else {
@@ -431,6 +657,7 @@ impl Accelerator for Simulation {
     ///
     /// Deadlocks are detected and prevented by throwing an error message.
     fn recv(&mut self) -> Result<ArbData> {
+        self.finish_yield()?;
         if self.state.is_idle() && self.accelerator_to_host_data.is_empty() {
             err("Deadlock: recv() called while queue is empty and accelerator is idle")
         } else {
@@ -0,0 +1,302 @@
+//! Runs many independent simulations concurrently on a pool of threads.
+//!
+//! Parameter sweeps consist of many short, independent simulations. Running
+//! them back-to-back wastes cores, and statically dividing them between
+//! threads (as `Simulator::run_shots_parallel()` does for shots) leaves cores
+//! idle when some simulations take much longer than others. A
+//! [`SimulationPool`] instead lets each worker thread take the next job as
+//! soon as it finishes its previous one, and hands the results back to the
+//! calling thread as they complete.
+//!
+//! [`SimulationPool`]: ./struct.SimulationPool.html
+
+use crate::{
+    common::{
+        error::{err, Result},
+        types::ArbData,
+    },
+    host::{accelerator::Accelerator, configuration::SimulatorConfiguration, simulator::Simulator},
+};
+use std::{
+    sync::{
+        atomic::{AtomicBool, AtomicUsize, Ordering},
+        Arc, Condvar, Mutex,
+    },
+    thread,
+};
+
+/// Counting semaphore limiting the number of plugin processes that the
+/// simulations of a pool may have running at the same time.
+#[derive(Debug)]
+struct ProcessLimit {
+    /// The maximum number of processes, or 0 for no limit.
+    max: usize,
+
+    /// The number of processes currently reserved.
+    in_use: Mutex<usize>,
+
+    /// Notified whenever processes are released.
+    released: Condvar,
+}
+
+impl ProcessLimit {
+    fn new(max: usize) -> ProcessLimit {
+        ProcessLimit {
+            max,
+            in_use: Mutex::new(0),
+            released: Condvar::new(),
+        }
+    }
+
+    /// Blocks until the given number of processes can be reserved, and
+    /// reserves them. A simulation that needs more processes than the limit
+    /// reserves all of them, such that it can still run on its own. Returns
+    /// the number of processes that were reserved.
+    fn acquire(&self, processes: usize) -> usize {
+        if self.max == 0 || processes == 0 {
+            return 0;
+        }
+        let processes = processes.min(self.max);
+        let mut in_use = self.in_use.lock().unwrap();
+        while *in_use + processes > self.max {
+            in_use = self.released.wait(in_use).unwrap();
+        }
+        *in_use += processes;
+        processes
+    }
+
+    /// Releases processes reserved by `acquire()`.
+    fn release(&self, processes: usize) {
+        if processes > 0 {
+            *self.in_use.lock().unwrap() -= processes;
+            self.released.notify_all();
+        }
+    }
+}
+
+/// Pool of worker threads for running many independent simulations.
+#[derive(Debug, Clone, Copy, PartialEq)]
+pub struct SimulationPool {
+    /// The number of worker threads, or 0 to use one for each logical CPU.
+    pub num_threads: usize,
+
+    /// The maximum number of plugin processes that may be running at the same
+    /// time, or 0 for no limit.
+    pub max_processes: usize,
+}
+
+impl Default for SimulationPool {
+    fn default() -> SimulationPool {
+        SimulationPool {
+            num_threads: 0,
+            max_processes: 0,
+        }
+    }
+}
+
+impl SimulationPool {
+    /// Sets the number of worker threads. 0 means one for each logical CPU.
+    pub fn with_threads(mut self, num_threads: usize) -> SimulationPool {
+        self.num_threads = num_threads;
+        self
+    }
+
+    /// Limits the number of plugin processes that may be running at the same
+    /// time. 0 means no limit.
+    ///
+    /// Before a simulation is constructed, the worker reserves one slot for
+    /// every plugin process configuration in it, waiting if necessary. Only
+    /// `PluginProcessConfiguration`s are counted; threads that spawn their
+    /// own processes are not.
+    pub fn with_max_processes(mut self, max_processes: usize) -> SimulationPool {
+        self.max_processes = max_processes;
+        self
+    }
+
+    /// Returns the number of worker threads to use for the given number of
+    /// jobs.
+    fn worker_count(&self, num_jobs: usize) -> usize {
+        let num_threads = if self.num_threads == 0 {
+            thread::available_parallelism()
+                .map(|n| n.get())
+                .unwrap_or(1)
+        } else {
+            self.num_threads
+        };
+        num_threads.min(num_jobs).max(1)
+    }
+
+    /// Runs `num_jobs` independent simulations, each of which runs the
+    /// program once with the given argument.
+    ///
+    /// `factory` is called from within a worker thread to construct the
+    /// configuration for each job; it is passed the index of the job. Jobs
+    /// are started in order of their index, by whichever worker is idle
+    /// first. Unlike `Simulator::run_shots_parallel()`, the seeds of the
+    /// configurations are left as they are.
+    ///
+    /// `on_result` is called from the calling thread with the index and the
+    /// outcome of each job as they complete, so not necessarily in order. If
+    /// it returns an error, no new jobs are started, the jobs that are still
+    /// running are completed without reporting their results, and the error
+    /// is returned. Errors of individual jobs are passed to `on_result`; they
+    /// do not stop the pool by themselves.
+    pub fn run<F, R>(
+        &self,
+        factory: F,
+        args: ArbData,
+        num_jobs: usize,
+        mut on_result: R,
+    ) -> Result<()>
+    where
+        F: Fn(usize) -> Result<SimulatorConfiguration> + Send + Sync + 'static,
+        R: FnMut(usize, Result<ArbData>) -> Result<()>,
+    {
+        let factory = Arc::new(factory);
+        let limit = Arc::new(ProcessLimit::new(self.max_processes));
+        let next_job = Arc::new(AtomicUsize::new(0));
+        let abort = Arc::new(AtomicBool::new(false));
+        let (results_tx, results_rx) = crossbeam_channel::unbounded();
+
+        let workers: Vec<_> = (0..self.worker_count(num_jobs))
+            .map(|_| {
+                let factory = Arc::clone(&factory);
+                let limit = Arc::clone(&limit);
+                let next_job = Arc::clone(&next_job);
+                let abort = Arc::clone(&abort);
+                let results_tx = results_tx.clone();
+                let args = args.clone();
+                thread::spawn(move || {
+                    while !abort.load(Ordering::Relaxed) {
+                        let job = next_job.fetch_add(1, Ordering::Relaxed);
+                        if job >= num_jobs {
+                            break;
+                        }
+                        let result = factory(job).and_then(|configuration| {
+                            let processes = configuration
+                                .plugins
+                                .iter()
+                                .filter(|plugin| plugin.spawns_process())
+                                .count();
+                            let reserved = limit.acquire(processes);
+                            let result = Simulator::new(configuration).and_then(|mut simulator| {
+                                simulator.simulation.start(args.clone())?;
+                                simulator.simulation.wait()
+                            });
+                            limit.release(reserved);
+                            result
+                        });
+                        if results_tx.send((job, result)).is_err() {
+                            break;
+                        }
+                    }
+                })
+            })
+            .collect();
+        drop(results_tx);
+
+        // Report the results as they come in, until all workers are done.
+        let mut outcome = Ok(());
+        for (job, result) in results_rx.iter() {
+            if outcome.is_ok() {
+                if let Err(e) = on_result(job, result) {
+                    abort.store(true, Ordering::Relaxed);
+                    outcome = Err(e);
+                }
+            }
+        }
+
+        // Join all workers before returning, such that no simulations are
+        // left running in the background.
+        let panicked = workers
+            .into_iter()
+            .map(|worker| worker.join())
+            .any(|result| result.is_err());
+        if panicked {
+            return err("worker thread panicked");
+        }
+        outcome
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::{
+        common::{
+            error::inv_arg,
+            log::LoglevelFilter,
+            types::{PluginMetadata, PluginType},
+        },
+        host::configuration::{PluginLogConfiguration, PluginThreadConfiguration},
+        plugin::definition::PluginDefinition,
+    };
+
+    fn configuration(job: usize) -> Result<SimulatorConfiguration> {
+        let mut frontend =
+            PluginDefinition::new(PluginType::Frontend, PluginMetadata::new("", "", ""));
+        frontend.run =
+            Box::new(move |_, _| Ok(ArbData::from_args(vec![job.to_le_bytes().to_vec()])));
+        Ok(SimulatorConfiguration::default()
+            .without_reproduction()
+            .without_logging()
+            .with_plugin(PluginThreadConfiguration::new(
+                frontend,
+                PluginLogConfiguration::new("", LoglevelFilter::Off),
+            ))
+            .with_plugin(PluginThreadConfiguration::new(
+                PluginDefinition::new(PluginType::Backend, PluginMetadata::new("", "", "")),
+                PluginLogConfiguration::new("", LoglevelFilter::Off),
+            )))
+    }
+
+    #[test]
+    fn run() {
+        let mut done = vec![false; 10];
+        SimulationPool::default()
+            .with_threads(3)
+            .run(configuration, ArbData::default(), 10, |job, result| {
+                assert_eq!(result?.get_args()[0], job.to_le_bytes().to_vec());
+                done[job] = true;
+                Ok(())
+            })
+            .unwrap();
+        assert!(done.into_iter().all(|x| x));
+
+        let mut count = 0;
+        let result = SimulationPool::default().with_threads(2).run(
+            |job| {
+                if job == 3 {
+                    inv_arg("no simulation for you")
+                } else {
+                    configuration(job)
+                }
+            },
+            ArbData::default(),
+            1000,
+            |_, result| {
+                count += 1;
+                result.map(|_| ())
+            },
+        );
+        assert_eq!(
+            result.unwrap_err().to_string(),
+            "Invalid argument: no simulation for you"
+        );
+        assert!(count < 1000);
+    }
+
+    #[test]
+    fn process_limit() {
+        let limit = ProcessLimit::new(3);
+        assert_eq!(limit.acquire(2), 2);
+        assert_eq!(limit.acquire(0), 0);
+        assert_eq!(limit.acquire(1), 1);
+        limit.release(3);
+        assert_eq!(limit.acquire(5), 3);
+        assert_eq!(*limit.in_use.lock().unwrap(), 3);
+
+        let unlimited = ProcessLimit::new(0);
+        assert_eq!(unlimited.acquire(100), 0);
+    }
+}
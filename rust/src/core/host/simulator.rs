@@ -1,8 +1,14 @@
 //! Simulator driver: wraps a `Simulation` and a `LogThread`.
 
 use crate::{
-    common::{error::Result, log::thread::LogThread},
+    common::{
+        error::{err, Result},
+        log::{thread::LogThread, Loglevel, LoglevelFilter},
+        types::{ArbData, OutcomeHistogram},
+    },
+    error,
     host::{
+        accelerator::Accelerator,
         configuration::{PluginConfiguration, SimulatorConfiguration},
         plugin::Plugin,
         reproduction::Reproduction,
@@ -10,6 +16,11 @@ use crate::{
     },
     trace, warn,
 };
+use rand_chacha::{
+    rand_core::{RngCore, SeedableRng},
+    ChaChaRng,
+};
+use std::{path::PathBuf, sync::Arc, thread};
 
 /// Simulator driver instance.
 ///
@@ -36,6 +47,14 @@ pub struct Simulator {
 
     /// The Simulation driven by this Simulator.
     pub simulation: Simulation,
+
+    /// The loglevel at which the plugin statistics are logged when the
+    /// Simulator is dropped.
+    stats_level: LoglevelFilter,
+
+    /// The file to write the timeline events of the plugins to when the
+    /// Simulator is dropped, if tracing is enabled.
+    trace_file: Option<PathBuf>,
 }
 
 impl Simulator {
@@ -62,6 +81,7 @@ impl Simulator {
             configuration.log_callback,
             configuration.tee_files,
         )?;
+        log_thread.set_affinity(&configuration.log_thread_affinity)?;
 
         // Now that we can log, report any failures to create the reproduction
         // logger as a warning.
@@ -83,19 +103,112 @@ impl Simulator {
             .collect();
 
         // Construct simulation.
-        let simulation = Simulation::new(pipeline, configuration.seed, reproduction, &log_thread)?;
+        let mut simulation = Simulation::new(
+            pipeline,
+            configuration.seed,
+            reproduction,
+            &log_thread,
+            configuration.trace_file.is_some(),
+        )?;
+
+        // Start streaming the reproduction log if requested.
+        if let Some(filename) = configuration.reproduction_stream {
+            if let Err(e) = simulation.stream_reproduction_file(&filename) {
+                warn!(
+                    "Failed to stream reproduction log to {:?}: {}",
+                    filename,
+                    e.to_string()
+                );
+            }
+        }
 
         Ok(Simulator {
             log_thread,
             simulation,
+            stats_level: configuration.stats_level,
+            trace_file: configuration.trace_file,
         })
     }
+
+    /// Runs a program the given number of times on a number of simulations
+    /// in parallel, and returns the return values of each run in order, along
+    /// with the outcomes recorded by all the simulations combined.
+    ///
+    /// `factory` is called once from within each worker thread to construct
+    /// the configuration for that worker's simulation; it is passed the index
+    /// of the worker. The seed of the returned configuration is overridden
+    /// with a seed derived from `seed`, such that the results only depend on
+    /// `seed`, `num_shots`, and `num_threads`. The shots are divided into
+    /// contiguous chunks, one for each worker, and each worker runs its shots
+    /// back-to-back using `Accelerator::run_shots()`. The outcome histograms
+    /// of the workers are merged, such that they count the same outcomes as
+    /// `Simulation::get_outcomes()` would after running all shots on a single
+    /// simulation.
+    pub fn run_shots_parallel<F>(
+        factory: F,
+        seed: u64,
+        args: ArbData,
+        num_shots: usize,
+        num_threads: usize,
+    ) -> Result<(Vec<ArbData>, OutcomeHistogram)>
+    where
+        F: Fn(usize) -> Result<SimulatorConfiguration> + Send + Sync + 'static,
+    {
+        let num_threads = num_threads.max(1).min(num_shots);
+        let factory = Arc::new(factory);
+        let mut rng = ChaChaRng::seed_from_u64(seed);
+        let workers: Vec<_> = (0..num_threads)
+            .map(|worker| {
+                let factory = Arc::clone(&factory);
+                let args = args.clone();
+                let worker_seed = rng.next_u64();
+                let worker_shots =
+                    (worker + 1) * num_shots / num_threads - worker * num_shots / num_threads;
+                thread::spawn(move || -> Result<(Vec<ArbData>, OutcomeHistogram)> {
+                    let mut configuration = factory(worker)?;
+                    configuration.seed.value = worker_seed;
+                    let mut simulator = Simulator::new(configuration)?;
+                    let shots = simulator.simulation.run_shots(args, worker_shots)?;
+                    Ok((shots, simulator.simulation.take_outcomes()?))
+                })
+            })
+            .collect();
+
+        // Join all workers before reporting errors, such that no simulations
+        // are left running in the background.
+        let outcomes: Vec<_> = workers.into_iter().map(|worker| worker.join()).collect();
+        let mut results = Vec::with_capacity(num_shots);
+        let mut histogram = OutcomeHistogram::default();
+        for outcome in outcomes {
+            match outcome {
+                Ok(worker) => {
+                    let (shots, worker_histogram) = worker?;
+                    results.extend(shots);
+                    histogram.merge(worker_histogram);
+                }
+                Err(_) => return err("worker thread panicked"),
+            }
+        }
+        Ok((results, histogram))
+    }
 }
 
 impl Drop for Simulator {
     fn drop(&mut self) {
         trace!("Dropping Simulator");
 
+        // Log the plugin statistics while the plugins are still around.
+        if let Ok(level) = Loglevel::try_from(self.stats_level) {
+            self.simulation.log_stats(level);
+        }
+
+        // Write the timeline of the simulation.
+        if let Some(trace_file) = self.trace_file.as_ref() {
+            if let Err(e) = self.simulation.write_trace(trace_file) {
+                error!("Failed to write trace file: {}", e.to_string());
+            }
+        }
+
         // Drain the simulation pipeline to drop the Plugin instances before
         // dropping the log thread.
         self.simulation.drop_plugins();
@@ -0,0 +1,152 @@
+//! Writer for the timeline events recorded by plugins.
+//!
+//! The events of all plugins are merged into a single file in the Chrome
+//! trace event format, which can be opened with `chrome://tracing` or the
+//! Perfetto UI. Each plugin is shown as a thread, named after the plugin
+//! instance, with its callbacks as properly nested spans. The round trips of
+//! gatestream requests are shown as asynchronous spans, since many of them
+//! can be in flight at the same time.
+
+use crate::common::{
+    error::Result,
+    types::{TraceEvent, TraceEventKind},
+};
+use serde_json::{json, Value};
+use std::{fs::File, io::BufWriter, path::Path};
+
+/// Converts a timestamp or duration in nanoseconds to the microseconds used
+/// by the trace event format.
+fn micros(nanos: u64) -> f64 {
+    nanos as f64 / 1000.0
+}
+
+/// Converts the events recorded by the given plugins, in front to back
+/// order, to a JSON object in the Chrome trace event format.
+///
+/// Timestamps are made relative to the earliest event, such that they can
+/// be represented accurately.
+pub fn to_chrome_trace(plugins: &[(String, Vec<TraceEvent>)]) -> Value {
+    let origin = plugins
+        .iter()
+        .flat_map(|(_, events)| events.iter().map(|event| event.start))
+        .min()
+        .unwrap_or(0);
+
+    let mut trace_events = vec![];
+    for (index, (name, events)) in plugins.iter().enumerate() {
+        // Name the thread after the plugin, and sort the threads in pipeline
+        // order.
+        if let Some(event) = events.first() {
+            trace_events.push(json!({
+                "name": "thread_name",
+                "ph": "M",
+                "pid": event.pid,
+                "tid": event.tid,
+                "args": { "name": name },
+            }));
+            trace_events.push(json!({
+                "name": "thread_sort_index",
+                "ph": "M",
+                "pid": event.pid,
+                "tid": event.tid,
+                "args": { "sort_index": index },
+            }));
+        }
+
+        for event in events {
+            let ts = micros(event.start - origin);
+            match event.kind {
+                TraceEventKind::Span => trace_events.push(json!({
+                    "name": event.name,
+                    "cat": "callback",
+                    "ph": "X",
+                    "ts": ts,
+                    "dur": micros(event.duration),
+                    "pid": event.pid,
+                    "tid": event.tid,
+                })),
+                TraceEventKind::RoundTrip(sequence) => {
+                    let id = format!("{}:{}", index, sequence);
+                    trace_events.push(json!({
+                        "name": event.name,
+                        "cat": "gatestream",
+                        "ph": "b",
+                        "id": id,
+                        "ts": ts,
+                        "pid": event.pid,
+                        "tid": event.tid,
+                        "args": { "sequence": sequence },
+                    }));
+                    trace_events.push(json!({
+                        "name": event.name,
+                        "cat": "gatestream",
+                        "ph": "e",
+                        "id": id,
+                        "ts": micros(event.start + event.duration - origin),
+                        "pid": event.pid,
+                        "tid": event.tid,
+                    }));
+                }
+            }
+        }
+    }
+
+    json!({
+        "traceEvents": trace_events,
+        "displayTimeUnit": "ns",
+    })
+}
+
+/// Writes the events recorded by the given plugins, in front to back order,
+/// to a file in the Chrome trace event format.
+pub fn write_chrome_trace(
+    filename: impl AsRef<Path>,
+    plugins: &[(String, Vec<TraceEvent>)],
+) -> Result<()> {
+    let file = BufWriter::new(File::create(filename.as_ref())?);
+    serde_json::to_writer(file, &to_chrome_trace(plugins))?;
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::common::types::SequenceNumberGenerator;
+    use std::borrow::Cow;
+
+    #[test]
+    fn chrome_trace() {
+        let sequence = SequenceNumberGenerator::new().get_next();
+        let front = vec![
+            TraceEvent {
+                name: Cow::Borrowed("run"),
+                kind: TraceEventKind::Span,
+                start: 1_000_000,
+                duration: 5_000,
+                pid: 1,
+                tid: 2,
+            },
+            TraceEvent {
+                name: Cow::Borrowed("round trip"),
+                kind: TraceEventKind::RoundTrip(sequence),
+                start: 1_001_000,
+                duration: 2_000,
+                pid: 1,
+                tid: 2,
+            },
+        ];
+        let trace = to_chrome_trace(&[("front".to_string(), front), ("back".to_string(), vec![])]);
+        let events = trace["traceEvents"].as_array().unwrap();
+        assert_eq!(events.len(), 5);
+        assert_eq!(events[0]["args"]["name"], "front");
+        assert_eq!(events[2]["ph"], "X");
+        assert_eq!(events[2]["ts"], 0.0);
+        assert_eq!(events[2]["dur"], 5.0);
+        assert_eq!(events[3]["ph"], "b");
+        assert_eq!(events[3]["ts"], 1.0);
+        assert_eq!(events[3]["args"]["sequence"], 1);
+        assert_eq!(events[4]["ph"], "e");
+        assert_eq!(events[4]["ts"], 3.0);
+        assert_eq!(events[3]["id"], events[4]["id"]);
+    }
+}
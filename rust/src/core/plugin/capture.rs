@@ -0,0 +1,220 @@
+//! Gatestream capture file format.
+//!
+//! A plugin can be configured to record every message that it sends to its
+//! downstream plugin to a capture file. The file can later be replayed by the
+//! frontend defined in the `replay` module, such that a backend (or a chain
+//! of operators and a backend) can be benchmarked without having to run the
+//! original, possibly slow, frontend again.
+//!
+//! A capture file starts with the eight-byte `MAGIC` string, followed by a
+//! sequence of records. Like the binary reproduction file format, each
+//! record is a little-endian `u32` length followed by that many bytes of
+//! CBOR, in this case a single `GatestreamDown` message. The file is written
+//! through a buffer as the messages are sent, and read back by mapping it
+//! into memory, such that replaying does not need to copy the file. If the
+//! recording plugin crashes while writing a record, the truncated record is
+//! ignored when reading the file back.
+
+use crate::{
+    common::{
+        error::{err, Result},
+        protocol::GatestreamDown,
+        types::with_inline_shared_args,
+    },
+    warn,
+};
+use std::{
+    fs::File,
+    io::{BufWriter, Write},
+    os::unix::io::AsRawFd,
+    path::Path,
+    ptr::null_mut,
+};
+
+/// Magic string identifying a gatestream capture file.
+pub const MAGIC: &[u8; 8] = b"DQCSGST1";
+
+/// Appends gatestream messages to a capture file as they are sent.
+#[derive(Debug)]
+pub struct CaptureWriter {
+    writer: BufWriter<File>,
+}
+
+impl CaptureWriter {
+    /// Creates a new, empty capture file, overwriting any existing file.
+    pub fn create(file: impl AsRef<Path>) -> Result<CaptureWriter> {
+        let mut writer = BufWriter::new(File::create(file.as_ref())?);
+        writer.write_all(MAGIC)?;
+        Ok(CaptureWriter { writer })
+    }
+
+    /// Appends a message to the file.
+    pub fn record(&mut self, message: &GatestreamDown) -> Result<()> {
+        let data = with_inline_shared_args(|| serde_cbor::to_vec(message))?;
+        self.writer.write_all(&(data.len() as u32).to_le_bytes())?;
+        self.writer.write_all(&data)?;
+        Ok(())
+    }
+
+    /// Writes out any buffered messages.
+    pub fn flush(&mut self) -> Result<()> {
+        self.writer.flush()?;
+        Ok(())
+    }
+}
+
+/// Reads the messages from a capture file one at a time.
+#[derive(Debug)]
+pub struct CaptureReader {
+    /// Base address of the memory-mapped file.
+    base: *const u8,
+
+    /// Size of the file in bytes.
+    len: usize,
+
+    /// Offset of the next record.
+    offset: usize,
+}
+
+// The mapping is read-only and owned by the reader.
+unsafe impl Send for CaptureReader {}
+
+impl CaptureReader {
+    /// Opens and maps a capture file.
+    pub fn open(file: impl AsRef<Path>) -> Result<CaptureReader> {
+        let file = File::open(file.as_ref())?;
+        let len = file.metadata()?.len() as usize;
+        if len < MAGIC.len() {
+            return err("not a gatestream capture file");
+        }
+        let base = unsafe {
+            libc::mmap(
+                null_mut(),
+                len,
+                libc::PROT_READ,
+                libc::MAP_PRIVATE,
+                file.as_raw_fd(),
+                0,
+            )
+        };
+        if base == libc::MAP_FAILED {
+            return Err(std::io::Error::last_os_error().into());
+        }
+        let reader = CaptureReader {
+            base: base as *const u8,
+            len,
+            offset: MAGIC.len(),
+        };
+        if &reader.data()[..MAGIC.len()] != MAGIC {
+            return err("not a gatestream capture file");
+        }
+        Ok(reader)
+    }
+
+    /// Returns the contents of the file.
+    fn data(&self) -> &[u8] {
+        unsafe { std::slice::from_raw_parts(self.base, self.len) }
+    }
+
+    /// Returns the next record without decoding it, or `None` at the end of
+    /// the file or if the record is truncated.
+    fn next_record(&mut self) -> Option<&[u8]> {
+        let start = self.offset + 4;
+        if start > self.len {
+            if self.offset < self.len {
+                warn!("Ignoring truncated record at the end of the capture file");
+                self.offset = self.len;
+            }
+            return None;
+        }
+        let mut length = [0u8; 4];
+        length.copy_from_slice(&self.data()[self.offset..start]);
+        let end = start + u32::from_le_bytes(length) as usize;
+        if end > self.len {
+            warn!("Ignoring truncated record at the end of the capture file");
+            self.offset = self.len;
+            return None;
+        }
+        self.offset = end;
+        Some(&self.data()[start..end])
+    }
+}
+
+impl Iterator for CaptureReader {
+    type Item = Result<GatestreamDown>;
+
+    fn next(&mut self) -> Option<Result<GatestreamDown>> {
+        self.next_record().map(|record| {
+            with_inline_shared_args(|| serde_cbor::from_slice(record)).map_err(|e| e.into())
+        })
+    }
+}
+
+impl Drop for CaptureReader {
+    fn drop(&mut self) {
+        unsafe {
+            libc::munmap(self.base as *mut libc::c_void, self.len);
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::common::{
+        protocol::PipelinedGatestreamDown,
+        types::{ArbCmd, ArbData, Gate, Matrix, QubitRef, SequenceNumberGenerator},
+    };
+    use std::fs::OpenOptions;
+
+    #[test]
+    fn round_trip() {
+        let file = std::env::temp_dir().join(format!("dqcsim-capture-{}.bin", std::process::id()));
+        let mut sequence = SequenceNumberGenerator::new();
+        let qubit = QubitRef::from_foreign(1).unwrap();
+        let messages = vec![
+            GatestreamDown::Pipelined(
+                sequence.get_next(),
+                PipelinedGatestreamDown::Allocate(1, vec![]),
+            ),
+            GatestreamDown::Pipelined(
+                sequence.get_next(),
+                PipelinedGatestreamDown::Gate(
+                    Gate::new_measurement(vec![qubit], Matrix::new_identity(2)).unwrap(),
+                ),
+            ),
+            GatestreamDown::ArbRequest(ArbCmd::new("a", "b", ArbData::default())),
+            GatestreamDown::Pipelined(
+                sequence.get_next(),
+                PipelinedGatestreamDown::Free(vec![qubit]),
+            ),
+        ];
+
+        let mut writer = CaptureWriter::create(&file).unwrap();
+        for message in messages.iter() {
+            writer.record(message).unwrap();
+        }
+        drop(writer);
+
+        let reader = CaptureReader::open(&file).unwrap();
+        assert_eq!(reader.collect::<Result<Vec<_>>>().unwrap(), messages);
+
+        // Truncate the last record; the messages before it should still be
+        // readable.
+        let length = std::fs::metadata(&file).unwrap().len();
+        OpenOptions::new()
+            .write(true)
+            .open(&file)
+            .unwrap()
+            .set_len(length - 1)
+            .unwrap();
+        let reader = CaptureReader::open(&file).unwrap();
+        assert_eq!(reader.collect::<Result<Vec<_>>>().unwrap().len(), 3);
+
+        // Files without the magic string are rejected.
+        std::fs::write(&file, b"DQCSREP1").unwrap();
+        assert!(CaptureReader::open(&file).is_err());
+
+        std::fs::remove_file(&file).unwrap();
+    }
+}
@@ -20,14 +20,35 @@
 
 use crate::{
     common::{
-        channel::{PluginChannel, UpstreamChannel},
+        channel::{PluginChannel, Sender, UpstreamChannel},
         error::{inv_op, ErrorKind, Result},
+        local_channel::{
+            local_channel, local_channel_rev, LocalReceiver, LocalReceiverHandle, LocalSender,
+            LocalSenderHandle,
+        },
+        log,
         protocol::{GatestreamDown, GatestreamUp, PluginToSimulator, SimulatorToPlugin},
+        shm_channel::{
+            shm_channel, shm_channel_rev, ShmReceiver, ShmReceiverHandle, ShmSender,
+            ShmSenderHandle,
+        },
+        types::{
+            with_exported_shared_args, with_inline_shared_args, PluginStats, SequenceNumber,
+            SharedArg,
+        },
     },
+    host::configuration::{GatestreamTransport, ReceiveStrategy},
     trace,
 };
-use ipc_channel::ipc::{IpcOneShotServer, IpcReceiverSet, IpcSelectionResult, IpcSender};
-use std::collections::{HashMap, VecDeque};
+use ipc_channel::ipc::{
+    IpcOneShotServer, IpcReceiverSet, IpcSelectionResult, IpcSender, OpaqueIpcMessage,
+};
+use serde::{Deserialize, Serialize};
+use std::{
+    collections::{HashMap, VecDeque},
+    thread,
+    time::{Duration, Instant},
+};
 
 /// Incoming enum used to map incoming requests in the IpcReceiverSet used in
 /// the Connection wrapper.
@@ -39,6 +60,109 @@ enum Incoming {
     Upstream,
     /// Variant used to label incoming downstream responses ([`GatestreamUp`]).
     Downstream,
+    /// Variant used to label the doorbell of the shared-memory or in-process
+    /// upstream request channel.
+    UpstreamDoorbell,
+    /// Variant used to label the doorbell of the shared-memory or in-process
+    /// downstream response channel.
+    DownstreamDoorbell,
+}
+
+impl Incoming {
+    /// Deserializes a message received through the channel labeled by this
+    /// variant. Returns None for doorbells, which carry no data.
+    fn receive(self, msg: OpaqueIpcMessage) -> Result<Option<IncomingMessage>> {
+        Ok(Some(match self {
+            Incoming::Simulator => IncomingMessage::Simulator(msg.to()?),
+            Incoming::Upstream => IncomingMessage::Upstream(msg.to()?),
+            // Gatestream responses carry shared arguments by value.
+            Incoming::Downstream => {
+                IncomingMessage::Downstream(with_inline_shared_args(|| msg.to())?)
+            }
+            Incoming::UpstreamDoorbell | Incoming::DownstreamDoorbell => return Ok(None),
+        }))
+    }
+}
+
+/// Gatestream connection message sent from the upstream plugin to the
+/// downstream plugin through the latter's one-shot server.
+#[derive(Debug, Serialize, Deserialize)]
+enum UpstreamHandshake {
+    /// Socket-based IPC channel pair.
+    Ipc(UpstreamChannel),
+    /// Shared-memory channel pair.
+    SharedMemory(ShmSenderHandle<GatestreamUp>, ShmReceiverHandle<GatestreamDown>),
+    /// In-process channel pair.
+    InProcess(
+        LocalSenderHandle<GatestreamUp>,
+        LocalReceiverHandle<GatestreamDown>,
+    ),
+}
+
+/// Sender side of a gatestream connection.
+#[derive(Debug)]
+enum GatestreamSender<T: Serialize> {
+    Ipc(IpcSender<T>),
+    SharedMemory(ShmSender<T>),
+    InProcess(LocalSender<T>),
+}
+
+impl<T: Serialize> GatestreamSender<T> {
+    /// Sends a message through whichever kind of channel this is.
+    fn send(&self, message: T) -> Result<()> {
+        match self {
+            GatestreamSender::Ipc(sender) => sender.send(message)?,
+            GatestreamSender::SharedMemory(sender) => Sender::send(sender, message)?,
+            GatestreamSender::InProcess(sender) => Sender::send(sender, message)?,
+        }
+        Ok(())
+    }
+
+    /// Returns the number of payload bytes sent through this channel, if
+    /// known. Only shared-memory channels keep track of this; in-process
+    /// channels don't serialize anything.
+    fn bytes(&self) -> u64 {
+        match self {
+            GatestreamSender::Ipc(_) | GatestreamSender::InProcess(_) => 0,
+            GatestreamSender::SharedMemory(sender) => sender.bytes(),
+        }
+    }
+}
+
+/// Receiver side of a gatestream connection that is polled rather than read
+/// through the receiver set. Only its doorbell is part of the receiver set.
+#[derive(Debug)]
+enum PolledReceiver<T> {
+    SharedMemory(ShmReceiver<T>),
+    InProcess(LocalReceiver<T>),
+}
+
+impl<T: for<'de> Deserialize<'de>> PolledReceiver<T> {
+    /// Receives a message if one is available, without blocking.
+    fn try_recv(&self) -> Result<Option<T>> {
+        match self {
+            PolledReceiver::SharedMemory(receiver) => receiver.try_recv(),
+            PolledReceiver::InProcess(receiver) => receiver.try_recv(),
+        }
+    }
+
+    /// Tells the producer that we're about to block on the doorbell. Returns
+    /// false if a message became available in the meantime.
+    fn park(&self) -> bool {
+        match self {
+            PolledReceiver::SharedMemory(receiver) => receiver.park(),
+            PolledReceiver::InProcess(receiver) => receiver.park(),
+        }
+    }
+
+    /// Returns the number of payload bytes received through this channel, if
+    /// known.
+    fn bytes(&self) -> u64 {
+        match self {
+            PolledReceiver::SharedMemory(receiver) => receiver.bytes(),
+            PolledReceiver::InProcess(_) => 0,
+        }
+    }
 }
 
 /// Incoming messages variants.
@@ -64,6 +188,124 @@ pub enum OutgoingMessage {
     Downstream(GatestreamDown),
 }
 
+/// Buffer for incoming messages that have been received but not handled yet.
+///
+/// Messages are kept in a separate queue for each source, such that the
+/// next downstream message can be taken without scanning past buffered
+/// simulator and upstream requests. Each message is tagged with its arrival
+/// index, such that `pop_front()` can still return the messages in the
+/// order they were received.
+#[derive(Debug, Default)]
+struct IncomingBuffer {
+    /// Buffered requests from the simulator.
+    simulator: VecDeque<(u64, SimulatorToPlugin)>,
+    /// Buffered requests from the upstream plugin.
+    upstream: VecDeque<(u64, GatestreamDown)>,
+    /// Buffered responses from the downstream plugin.
+    downstream: VecDeque<(u64, GatestreamUp)>,
+    /// Arrival index for the next message.
+    next_index: u64,
+}
+
+impl IncomingBuffer {
+    /// Appends a received message to the buffer.
+    fn push(&mut self, message: IncomingMessage) {
+        let index = self.next_index;
+        self.next_index += 1;
+        match message {
+            IncomingMessage::Simulator(msg) => self.simulator.push_back((index, msg)),
+            IncomingMessage::Upstream(msg) => self.upstream.push_back((index, msg)),
+            IncomingMessage::Downstream(msg) => self.downstream.push_back((index, msg)),
+        }
+    }
+
+    /// Returns whether the buffer is empty.
+    fn is_empty(&self) -> bool {
+        self.simulator.is_empty() && self.upstream.is_empty() && self.downstream.is_empty()
+    }
+
+    /// Takes the message that was received first from the buffer.
+    fn pop_front(&mut self) -> Option<IncomingMessage> {
+        // Queues that are empty are treated as if their next message arrives
+        // last.
+        fn front<T>(queue: &VecDeque<(u64, T)>) -> u64 {
+            queue.front().map_or(u64::MAX, |(index, _)| *index)
+        }
+        let simulator = front(&self.simulator);
+        let upstream = front(&self.upstream);
+        let downstream = front(&self.downstream);
+        if simulator < upstream && simulator < downstream {
+            self.simulator
+                .pop_front()
+                .map(|(_, msg)| IncomingMessage::Simulator(msg))
+        } else if upstream < downstream {
+            self.upstream
+                .pop_front()
+                .map(|(_, msg)| IncomingMessage::Upstream(msg))
+        } else {
+            self.downstream
+                .pop_front()
+                .map(|(_, msg)| IncomingMessage::Downstream(msg))
+        }
+    }
+
+    /// Takes the downstream message that was received first from the buffer.
+    fn pop_downstream(&mut self) -> Option<IncomingMessage> {
+        self.downstream
+            .pop_front()
+            .map(|(_, msg)| IncomingMessage::Downstream(msg))
+    }
+
+    /// Discards all buffered gatestream messages.
+    fn clear_gatestream(&mut self) {
+        self.upstream.clear();
+        self.downstream.clear();
+    }
+}
+
+/// Shared arguments that were sent by reference, and that must be kept alive
+/// until the receiver acknowledges the message they were sent in. See the
+/// `shared_arg` module for the acknowledgement rules.
+#[derive(Debug, Default)]
+struct SharedArgExports {
+    /// Arguments referenced by the responses sent to the simulator since its
+    /// previous request.
+    simulator: Vec<SharedArg>,
+    /// Arguments referenced by the requests sent downstream, along with the
+    /// sequence number of the pipelined request they were sent in, or None
+    /// for an `ArbRequest`.
+    downstream: VecDeque<(Option<SequenceNumber>, Vec<SharedArg>)>,
+}
+
+impl SharedArgExports {
+    /// Releases the arguments acknowledged by the given received message.
+    fn received(&mut self, message: &IncomingMessage) {
+        match message {
+            IncomingMessage::Simulator(_) => self.simulator.clear(),
+            IncomingMessage::Downstream(GatestreamUp::CompletedUpTo(completed)) => {
+                while let Some((Some(sequence), _)) = self.downstream.front() {
+                    if !completed.acknowledges(*sequence) {
+                        break;
+                    }
+                    self.downstream.pop_front();
+                }
+            }
+            IncomingMessage::Downstream(GatestreamUp::ArbSuccess(_))
+            | IncomingMessage::Downstream(GatestreamUp::ArbFailure(_)) => {
+                // The downstream plugin handles its requests in order, so
+                // everything up to and including the `ArbRequest` has been
+                // received.
+                while let Some((sequence, _)) = self.downstream.pop_front() {
+                    if sequence.is_none() {
+                        break;
+                    }
+                }
+            }
+            _ => {}
+        }
+    }
+}
+
 /// Plugin to Simulator connection wrapper.
 ///
 /// This provides a [`Plugin`] with the ability to communicate with both a
@@ -87,19 +329,41 @@ pub struct Connection {
     /// Map to label incoming requests to their channel.
     incoming_map: HashMap<u64, Incoming>,
     /// Buffer for incoming requests.
-    incoming_buffer: VecDeque<IncomingMessage>,
+    incoming_buffer: IncomingBuffer,
+    /// Shared arguments sent by reference that have not been acknowledged
+    /// yet.
+    exports: SharedArgExports,
+
+    /// Upstream request receiver, if the upstream connection uses shared
+    /// memory or an in-process channel. Its doorbell is part of the incoming
+    /// set.
+    polled_upstream: Option<PolledReceiver<GatestreamDown>>,
+    /// Downstream response receiver, if the downstream connection uses
+    /// shared memory or an in-process channel. Its doorbell is part of the
+    /// incoming set.
+    polled_downstream: Option<PolledReceiver<GatestreamUp>>,
 
     /// Pending upstream connection.
-    pending_upstream: Option<IpcOneShotServer<UpstreamChannel>>,
+    pending_upstream: Option<IpcOneShotServer<UpstreamHandshake>>,
 
     /// Simulator response sender.
     response: IpcSender<PluginToSimulator>,
 
     /// Optional Upstream sender. Is None for Frontend plugins.
-    upstream: Option<IpcSender<GatestreamUp>>,
+    upstream: Option<GatestreamSender<GatestreamUp>>,
 
     /// Optional Downstream sender. Is None for Backend plugins.
-    downstream: Option<IpcSender<GatestreamDown>>,
+    downstream: Option<GatestreamSender<GatestreamDown>>,
+
+    /// How to wait for incoming messages.
+    receive_strategy: ReceiveStrategy,
+    /// The current polling time budget. See `spin_polled()`.
+    spin_budget: Duration,
+
+    /// Statistics for the current simulation. The gatestream byte counts are
+    /// kept by the shared-memory channels themselves, and are only filled in
+    /// by `stats()`.
+    stats: PluginStats,
 }
 
 impl Connection {
@@ -152,16 +416,50 @@ impl Connection {
         Ok(Connection {
             incoming,
             incoming_map,
-            incoming_buffer: VecDeque::new(),
+            incoming_buffer: IncomingBuffer::default(),
+            exports: SharedArgExports::default(),
+            polled_upstream: None,
+            polled_downstream: None,
             response: channel.0,
             downstream: None,
             pending_upstream: None,
             upstream: None,
+            receive_strategy: ReceiveStrategy::default(),
+            spin_budget: Duration::default(),
+            stats: PluginStats::default(),
         })
     }
 
-    /// Connects to a downstream plugin.
-    pub fn connect_downstream(&mut self, downstream: impl Into<String>) -> Result<()> {
+    /// Construct a Connection wrapper that is not connected to anything.
+    ///
+    /// This is used for the state of a backend that is fused into its
+    /// frontend, which never communicates with the simulator or other
+    /// plugins itself.
+    pub fn detached() -> Result<Connection> {
+        let (response, _) = ipc_channel::ipc::channel()?;
+        Ok(Connection {
+            incoming: IpcReceiverSet::new()?,
+            incoming_map: HashMap::new(),
+            incoming_buffer: IncomingBuffer::default(),
+            exports: SharedArgExports::default(),
+            polled_upstream: None,
+            polled_downstream: None,
+            response,
+            downstream: None,
+            pending_upstream: None,
+            upstream: None,
+            receive_strategy: ReceiveStrategy::default(),
+            spin_budget: Duration::default(),
+            stats: PluginStats::default(),
+        })
+    }
+
+    /// Connects to a downstream plugin, using the given kind of channel.
+    pub fn connect_downstream(
+        &mut self,
+        downstream: impl Into<String>,
+        transport: GatestreamTransport,
+    ) -> Result<()> {
         if self.downstream.is_some() {
             inv_op("already connected to a downstream plugin")?;
         }
@@ -169,18 +467,62 @@ impl Connection {
         // Attempt to connect to the downstream plugin.
         let downstream = IpcSender::connect(downstream.into())?;
 
-        // Create channel pair.
-        let (down_tx, down_rx) = ipc_channel::ipc::channel()?;
-        let (up_tx, up_rx) = ipc_channel::ipc::channel()?;
+        match transport {
+            GatestreamTransport::Ipc => {
+                // Create channel pair.
+                let (down_tx, down_rx) = ipc_channel::ipc::channel()?;
+                let (up_tx, up_rx) = ipc_channel::ipc::channel()?;
 
-        // Send upstream channel to downstream plugin.
-        downstream.send((up_tx, down_rx) as UpstreamChannel)?;
+                // Send upstream channel to downstream plugin.
+                downstream.send(UpstreamHandshake::Ipc((up_tx, down_rx)))?;
 
-        // Store downstream channel incoming and outgoing in connection
-        // wrapper.
-        self.incoming_map
-            .insert(self.incoming.add(up_rx)?, Incoming::Downstream);
-        self.downstream.replace(down_tx);
+                // Store downstream channel incoming and outgoing in
+                // connection wrapper.
+                self.incoming_map
+                    .insert(self.incoming.add(up_rx)?, Incoming::Downstream);
+                self.downstream.replace(GatestreamSender::Ipc(down_tx));
+            }
+            GatestreamTransport::SharedMemory(capacity) => {
+                // Create channel pair.
+                let (down_tx, down_rx) = shm_channel(capacity)?;
+                let (up_tx, mut up_rx) = shm_channel_rev(capacity)?;
+
+                // Send upstream channel to downstream plugin.
+                downstream.send(UpstreamHandshake::SharedMemory(up_tx, down_rx))?;
+
+                // Store downstream channel incoming and outgoing in
+                // connection wrapper. Only the doorbell goes into the
+                // receiver set.
+                self.incoming_map.insert(
+                    self.incoming.add(up_rx.take_doorbell().unwrap())?,
+                    Incoming::DownstreamDoorbell,
+                );
+                self.polled_downstream
+                    .replace(PolledReceiver::SharedMemory(up_rx));
+                self.downstream
+                    .replace(GatestreamSender::SharedMemory(down_tx));
+            }
+            GatestreamTransport::InProcess => {
+                // Create channel pair.
+                let (down_tx, down_rx) = local_channel()?;
+                let (up_tx, mut up_rx) = local_channel_rev()?;
+
+                // Send upstream channel to downstream plugin.
+                downstream.send(UpstreamHandshake::InProcess(up_tx, down_rx))?;
+
+                // Store downstream channel incoming and outgoing in
+                // connection wrapper. Only the doorbell goes into the
+                // receiver set.
+                self.incoming_map.insert(
+                    self.incoming.add(up_rx.take_doorbell().unwrap())?,
+                    Incoming::DownstreamDoorbell,
+                );
+                self.polled_downstream
+                    .replace(PolledReceiver::InProcess(up_rx));
+                self.downstream
+                    .replace(GatestreamSender::InProcess(down_tx));
+            }
+        }
 
         Ok(())
     }
@@ -208,21 +550,97 @@ impl Connection {
         }
 
         // Wait for upstream plugin to connect.
-        let (_, upstream): (_, UpstreamChannel) = self.pending_upstream.take().unwrap().accept()?;
+        let (_, upstream): (_, UpstreamHandshake) =
+            self.pending_upstream.take().unwrap().accept()?;
 
         // Store upstream channel incoming and outgoing in connection
         // wrapper.
-        self.incoming_map
-            .insert(self.incoming.add(upstream.1)?, Incoming::Upstream);
-        self.upstream.replace(upstream.0);
+        match upstream {
+            UpstreamHandshake::Ipc((up_tx, down_rx)) => {
+                self.incoming_map
+                    .insert(self.incoming.add(down_rx)?, Incoming::Upstream);
+                self.upstream.replace(GatestreamSender::Ipc(up_tx));
+            }
+            UpstreamHandshake::SharedMemory(up_tx, down_rx) => {
+                let up_tx = up_tx.open()?;
+                let mut down_rx = down_rx.open()?;
+                self.incoming_map.insert(
+                    self.incoming.add(down_rx.take_doorbell().unwrap())?,
+                    Incoming::UpstreamDoorbell,
+                );
+                self.polled_upstream
+                    .replace(PolledReceiver::SharedMemory(down_rx));
+                self.upstream.replace(GatestreamSender::SharedMemory(up_tx));
+            }
+            UpstreamHandshake::InProcess(up_tx, down_rx) => {
+                let up_tx = up_tx.open()?;
+                let mut down_rx = down_rx.open()?;
+                self.incoming_map.insert(
+                    self.incoming.add(down_rx.take_doorbell().unwrap())?,
+                    Incoming::UpstreamDoorbell,
+                );
+                self.polled_upstream
+                    .replace(PolledReceiver::InProcess(down_rx));
+                self.upstream.replace(GatestreamSender::InProcess(up_tx));
+            }
+        }
 
         Ok(())
     }
 
+    /// Disconnects from the upstream and downstream plugins, returning the
+    /// connection to the state it was in after construction.
+    ///
+    /// Only the connection with the simulator is kept. Any buffered
+    /// gatestream messages are discarded. The receivers of the old gatestream
+    /// channels stay in the receiver set until their senders are dropped, but
+    /// anything they still receive is ignored.
+    pub fn reset(&mut self) {
+        self.incoming_map
+            .retain(|_, incoming| matches!(incoming, Incoming::Simulator));
+        self.incoming_buffer.clear_gatestream();
+        self.exports.downstream.clear();
+        self.polled_upstream.take();
+        self.polled_downstream.take();
+        self.pending_upstream.take();
+        self.upstream.take();
+        self.downstream.take();
+        self.set_receive_strategy(ReceiveStrategy::default());
+        self.stats = PluginStats::default();
+    }
+
+    /// Configures how to wait for incoming messages.
+    pub fn set_receive_strategy(&mut self, strategy: ReceiveStrategy) {
+        self.receive_strategy = strategy;
+        self.spin_budget = strategy.spin_time();
+    }
+
+    /// Returns the statistics collected for the current simulation.
+    pub fn stats(&self) -> PluginStats {
+        let mut stats = self.stats.clone();
+        stats.bytes_sent = self.upstream.as_ref().map_or(0, GatestreamSender::bytes)
+            + self.downstream.as_ref().map_or(0, GatestreamSender::bytes);
+        stats.bytes_received = self
+            .polled_upstream
+            .as_ref()
+            .map_or(0, PolledReceiver::bytes)
+            + self
+                .polled_downstream
+                .as_ref()
+                .map_or(0, PolledReceiver::bytes);
+        stats
+    }
+
+    /// Returns mutable access to the statistics, such that the plugin can
+    /// record the things the connection does not know about.
+    pub fn stats_mut(&mut self) -> &mut PluginStats {
+        &mut self.stats
+    }
+
     /// Get downstream channel.
     ///
     /// Returns an error if the downstream sender side does not exist.
-    fn downstream_ref(&self) -> Result<&IpcSender<GatestreamDown>> {
+    fn downstream_ref(&self) -> Result<&GatestreamSender<GatestreamDown>> {
         Ok(self
             .downstream
             .as_ref()
@@ -232,7 +650,7 @@ impl Connection {
     /// Get sender of upstream channel.
     ///
     /// Returns an error if the upstream channel sender side does not exist.
-    fn upstream_ref(&self) -> Result<&IpcSender<GatestreamUp>> {
+    fn upstream_ref(&self) -> Result<&GatestreamSender<GatestreamUp>> {
         Ok(self
             .upstream
             .as_ref()
@@ -244,32 +662,145 @@ impl Connection {
     /// Send an OutgoingMessage using the corresponding sender. Returns an
     /// error when the channel is closed, does not exist or when sending
     /// failed.
-    pub fn send(&self, message: OutgoingMessage) -> Result<()> {
+    ///
+    /// Shared arguments in gatestream responses are sent by value, as the
+    /// upstream plugin does not acknowledge them. Those in other messages are
+    /// sent by reference, and are kept alive until the receiver acknowledges
+    /// the message.
+    pub fn send(&mut self, message: OutgoingMessage) -> Result<()> {
+        let start = Instant::now();
         match message {
-            OutgoingMessage::Simulator(response) => self.response.send(response)?,
-            OutgoingMessage::Downstream(request) => self.downstream_ref()?.send(request)?,
-            OutgoingMessage::Upstream(response) => self.upstream_ref()?.send(response)?,
+            OutgoingMessage::Simulator(response) => {
+                // Ship the log records produced while handling the request
+                // before the simulator gets to see the response.
+                log::flush();
+                let response_sender = &self.response;
+                let (result, exported) =
+                    with_exported_shared_args(|| response_sender.send(response));
+                result?;
+                self.exports.simulator.extend(exported);
+            }
+            OutgoingMessage::Downstream(request) => {
+                let sequence = match &request {
+                    GatestreamDown::Pipelined(sequence, _) => Some(*sequence),
+                    GatestreamDown::ArbRequest(_) => None,
+                };
+                let downstream = self.downstream_ref()?;
+                let (result, exported) = with_exported_shared_args(|| downstream.send(request));
+                result?;
+                if !exported.is_empty() {
+                    self.exports.downstream.push_back((sequence, exported));
+                }
+            }
+            OutgoingMessage::Upstream(response) => {
+                let upstream = self.upstream_ref()?;
+                with_inline_shared_args(|| upstream.send(response))?
+            }
         }
+        self.stats.messages_sent += 1;
+        self.stats.send.record(start.elapsed());
         Ok(())
     }
 
+    /// Moves all messages that are currently available in the polled
+    /// receivers into the buffer. Returns whether any message was received.
+    fn drain_polled(&mut self) -> Result<bool> {
+        let mut received_any = false;
+        if let Some(upstream) = self.polled_upstream.as_ref() {
+            while let Some(msg) = upstream.try_recv()? {
+                self.incoming_buffer.push(IncomingMessage::Upstream(msg));
+                received_any = true;
+            }
+        }
+        if let Some(downstream) = self.polled_downstream.as_ref() {
+            while let Some(msg) = with_inline_shared_args(|| downstream.try_recv())? {
+                let msg = IncomingMessage::Downstream(msg);
+                self.exports.received(&msg);
+                self.incoming_buffer.push(msg);
+                received_any = true;
+            }
+        }
+        Ok(received_any)
+    }
+
+    /// Polls the shared-memory and in-process receivers until a message
+    /// arrives or the polling time budget runs out, as configured by the
+    /// receive strategy. Returns whether any message was received.
+    ///
+    /// The budget adapts to the traffic: it is halved (down to a sixteenth of
+    /// the configured time) whenever polling times out, and restored when a
+    /// message arrives in time. This keeps an idle plugin from burning CPU
+    /// time on every wait, while a plugin in a tight request-response loop
+    /// with its neighbor keeps polling.
+    fn spin_polled(&mut self) -> Result<bool> {
+        if self.spin_budget == Duration::default()
+            || (self.polled_upstream.is_none() && self.polled_downstream.is_none())
+        {
+            return Ok(false);
+        }
+        let yield_thread = matches!(self.receive_strategy, ReceiveStrategy::Yield(_));
+        let start = Instant::now();
+        loop {
+            if yield_thread {
+                thread::yield_now();
+            } else {
+                std::hint::spin_loop();
+            }
+            if self.drain_polled()? {
+                self.stats.spin_hits += 1;
+                self.spin_budget = self.receive_strategy.spin_time();
+                return Ok(true);
+            }
+            if start.elapsed() >= self.spin_budget {
+                break;
+            }
+        }
+        self.stats.spin_misses += 1;
+        self.spin_budget = (self.spin_budget / 2).max(self.receive_strategy.spin_time() / 16);
+        Ok(false)
+    }
+
+    /// Parks the polled receivers before blocking on the incoming set.
+    /// Returns false if a message arrived in the meantime, in which case we
+    /// should not block.
+    fn park_polled(&self) -> bool {
+        self.polled_upstream
+            .as_ref()
+            .map_or(true, PolledReceiver::park)
+            && self
+                .polled_downstream
+                .as_ref()
+                .map_or(true, PolledReceiver::park)
+    }
+
     /// Buffer incoming messages.
     /// If there are connected channels make sure at least one additional
     /// message is pending in the buffer.
     fn buffer_incoming(&mut self) -> Result<()> {
-        let mut received_any = false;
+        let mut received_any = self.drain_polled()? || self.spin_polled()?;
         while !received_any && !self.incoming_map.is_empty() {
+            // Don't block if a polled message arrived while parking.
+            if !self.park_polled() {
+                received_any = self.drain_polled()?;
+                continue;
+            }
+
+            // Ship any buffered log records before blocking.
+            log::flush();
+            self.stats.blocked += 1;
+
             // Store incoming message in the buffer.
             for event in self.incoming.select()? {
                 match event {
                     IpcSelectionResult::MessageReceived(id, msg) => {
                         if let Some(incoming) = self.incoming_map.get(&id) {
-                            self.incoming_buffer.push_back(match incoming {
-                                Incoming::Simulator => IncomingMessage::Simulator(msg.to()?),
-                                Incoming::Upstream => IncomingMessage::Upstream(msg.to()?),
-                                Incoming::Downstream => IncomingMessage::Downstream(msg.to()?),
-                            });
-                            received_any = true;
+                            // Doorbells carry no data; the messages are
+                            // drained from the polled receivers below.
+                            if let Some(msg) = incoming.receive(msg)? {
+                                self.exports.received(&msg);
+                                self.incoming_buffer.push(msg);
+                                received_any = true;
+                            }
                         }
                     }
                     IpcSelectionResult::ChannelClosed(id) => {
@@ -280,6 +811,11 @@ impl Connection {
                     }
                 }
             }
+
+            // Pick up any messages the doorbells rang for. This is also done
+            // after a doorbell channel closes, as the producer may have
+            // written messages to the channel before it disconnected.
+            received_any |= self.drain_polled()?;
         }
         Ok(())
     }
@@ -291,11 +827,23 @@ impl Connection {
     /// already closed. Returns Ok(None) if both request channels are closed.
     /// This method blocks until a new request is available.
     pub fn next_request(&mut self) -> Result<Option<IncomingMessage>> {
+        let start = Instant::now();
         if self.incoming_buffer.is_empty() {
             // Make sure at least one additional message is availale.
             self.buffer_incoming()?;
         }
-        Ok(self.incoming_buffer.pop_front())
+        let message = self.incoming_buffer.pop_front();
+        self.record_received(&message, start);
+        Ok(message)
+    }
+
+    /// Records the reception of a message, if any, that was waited for since
+    /// the given point in time.
+    fn record_received(&mut self, message: &Option<IncomingMessage>, start: Instant) {
+        if message.is_some() {
+            self.stats.messages_received += 1;
+            self.stats.recv.record(start.elapsed());
+        }
     }
 
     /// Fetch next downstream request.
@@ -303,25 +851,44 @@ impl Connection {
     /// Fails if the downstream connection is closed. This method blocks until
     /// a new request is available.
     pub fn next_downstream_request(&mut self) -> Result<Option<IncomingMessage>> {
-        // Check if there are new downstream messages.
-        if let Some(idx) = self
-            .incoming_buffer
-            .iter()
-            .position(|msg| matches!(msg, IncomingMessage::Downstream(_)))
-        {
-            Ok(Some(self.incoming_buffer.remove(idx).unwrap()))
-        } else {
-            // Buffer incoming messages.
-            self.buffer_incoming()?;
+        let start = Instant::now();
+        let message = self.wait_downstream_request()?;
+        self.record_received(&message, start);
+        Ok(message)
+    }
+
+    /// Implementation of `next_downstream_request()`.
+    fn wait_downstream_request(&mut self) -> Result<Option<IncomingMessage>> {
+        loop {
+            // Check if there are new downstream messages.
+            if let Some(message) = self.incoming_buffer.pop_downstream() {
+                return Ok(Some(message));
+            }
+
             // If there are no connected channels return None.
             if self.incoming_map.is_empty() {
-                Ok(None)
-            } else {
-                // Check if the new messages contain a downstream message.
-                self.next_downstream_request()
+                return Ok(None);
             }
+
+            // Buffer all incoming messages that are ready, and check whether
+            // they contain a downstream message.
+            self.buffer_incoming()?;
         }
     }
+
+    /// Fetch the next downstream request that has already been received,
+    /// without blocking.
+    ///
+    /// Only messages that have already been buffered or that are available
+    /// in a shared-memory ring buffer or in-process channel are considered;
+    /// socket-based channels are only read when blocking.
+    pub fn try_next_downstream_request(&mut self) -> Result<Option<IncomingMessage>> {
+        let start = Instant::now();
+        self.drain_polled()?;
+        let message = self.incoming_buffer.pop_downstream();
+        self.record_received(&message, start);
+        Ok(message)
+    }
 }
 
 impl Drop for Connection {
@@ -332,10 +899,14 @@ impl Drop for Connection {
 
 #[cfg(test)]
 mod tests {
-    use super::{Connection, IncomingMessage, OutgoingMessage};
+    use super::{Connection, IncomingBuffer, IncomingMessage, OutgoingMessage};
     use crate::common::{
         channel::SimulatorChannel,
-        protocol::{PluginToSimulator, SimulatorToPlugin},
+        protocol::{
+            GatestreamDown, GatestreamUp, PipelinedGatestreamDown, PluginToSimulator,
+            SimulatorToPlugin,
+        },
+        types::SequenceNumber,
     };
     use ipc_channel::ipc::IpcOneShotServer;
 
@@ -412,6 +983,47 @@ mod tests {
         assert!(plugin.join().is_ok());
     }
 
+    #[test]
+    fn incoming_buffer() {
+        let upstream = |cycles| {
+            IncomingMessage::Upstream(GatestreamDown::Pipelined(
+                SequenceNumber::none(),
+                PipelinedGatestreamDown::Advance(cycles),
+            ))
+        };
+        let downstream = |cycles| IncomingMessage::Downstream(GatestreamUp::Advanced(cycles));
+
+        let mut buffer = IncomingBuffer::default();
+        assert!(buffer.is_empty());
+        assert_eq!(buffer.pop_front(), None);
+        buffer.push(upstream(1));
+        buffer.push(downstream(2));
+        buffer.push(IncomingMessage::Simulator(SimulatorToPlugin::Abort));
+        buffer.push(upstream(3));
+        buffer.push(downstream(4));
+        assert!(!buffer.is_empty());
+
+        // Downstream messages can be taken out of order.
+        assert_eq!(buffer.pop_downstream(), Some(downstream(2)));
+
+        // Everything else comes out in order of arrival.
+        assert_eq!(buffer.pop_front(), Some(upstream(1)));
+        assert_eq!(
+            buffer.pop_front(),
+            Some(IncomingMessage::Simulator(SimulatorToPlugin::Abort))
+        );
+        buffer.push(IncomingMessage::Simulator(SimulatorToPlugin::Abort));
+        buffer.push(upstream(5));
+        buffer.clear_gatestream();
+        assert_eq!(
+            buffer.pop_front(),
+            Some(IncomingMessage::Simulator(SimulatorToPlugin::Abort))
+        );
+        assert_eq!(buffer.pop_downstream(), None);
+        assert_eq!(buffer.pop_front(), None);
+        assert!(buffer.is_empty());
+    }
+
     #[test]
     fn bad_address() {
         // Attempt to connect to an non-existing server
@@ -3,7 +3,7 @@
 
 use crate::{
     common::{
-        error::{inv_op, Result},
+        error::{inv_arg, inv_op, Result},
         types::{
             ArbCmd, ArbData, Gate, PluginMetadata, PluginType, QubitMeasurementResult, QubitRef,
         },
@@ -53,6 +53,22 @@ pub struct PluginDefinition {
             + 'static,
     >,
 
+    /// Batched measurement modification callback for operators.
+    ///
+    /// When set, this is called with all the measurements received from
+    /// downstream in a single acknowledgement, instead of calling
+    /// `modify_measurement` for each of them.
+    pub modify_measurements: Option<
+        Box<
+            dyn Fn(
+                    &mut PluginState,
+                    Vec<QubitMeasurementResult>,
+                ) -> Result<Vec<QubitMeasurementResult>>
+                + Send
+                + 'static,
+        >,
+    >,
+
     /// Callback for advancing time for operators and backends.
     pub advance: Box<dyn Fn(&mut PluginState, u64) -> Result<()> + Send + 'static>,
 
@@ -62,6 +78,9 @@ pub struct PluginDefinition {
 
     /// Callback function for handling an arb from the host.
     pub host_arb: Box<dyn Fn(&mut PluginState, ArbCmd) -> Result<ArbData> + Send + 'static>,
+
+    /// Backend fused into this frontend using `fuse()`, if any.
+    fused: Option<Box<PluginDefinition>>,
 }
 
 impl fmt::Debug for PluginDefinition {
@@ -93,9 +112,11 @@ impl PluginDefinition {
                 free: Box::new(|_, _| inv_op("frontend.free() called")),
                 gate: Box::new(|_, _| inv_op("frontend.gate() called")),
                 modify_measurement: Box::new(|_, _| inv_op("frontend.modify_measurement() called")),
+                modify_measurements: None,
                 advance: Box::new(|_, _| inv_op("frontend.advance() called")),
                 upstream_arb: Box::new(|_, _| inv_op("frontend.upstream_arb() called")),
                 host_arb: Box::new(|_, _| Ok(ArbData::default())),
+                fused: None,
             },
             PluginType::Operator => PluginDefinition {
                 typ,
@@ -109,9 +130,11 @@ impl PluginDefinition {
                 free: Box::new(|state, qubits| state.free(qubits)),
                 gate: Box::new(|state, gate| state.gate(gate).map(|_| vec![])),
                 modify_measurement: Box::new(|_, measurement| Ok(vec![measurement])),
+                modify_measurements: None,
                 advance: Box::new(|state, cycles| state.advance(cycles).map(|_| ())),
                 upstream_arb: Box::new(|state, cmd| state.arb(cmd)),
                 host_arb: Box::new(|_, _| Ok(ArbData::default())),
+                fused: None,
             },
             PluginType::Backend => PluginDefinition {
                 typ,
@@ -123,9 +146,11 @@ impl PluginDefinition {
                 free: Box::new(|_, _| Ok(())),
                 gate: Box::new(|_, _| inv_op("gate() is not implemented")),
                 modify_measurement: Box::new(|_, _| inv_op("backend.modify_measurement() called")),
+                modify_measurements: None,
                 advance: Box::new(|_, _| Ok(())),
                 upstream_arb: Box::new(|_, _| Ok(ArbData::default())),
                 host_arb: Box::new(|_, _| Ok(ArbData::default())),
+                fused: None,
             },
         }
     }
@@ -144,6 +169,43 @@ impl PluginDefinition {
     pub fn get_metadata(&self) -> &PluginMetadata {
         &self.metadata
     }
+
+    /// Fuses the given backend into this frontend.
+    ///
+    /// The gatestream requests of a fused frontend are not sent downstream,
+    /// but are handled by calling the callbacks of the backend directly,
+    /// from within the frontend's thread. This removes all channel and
+    /// thread switching overhead, which is useful to get a baseline for the
+    /// performance of the plugins themselves.
+    ///
+    /// The simulator still needs a backend plugin downstream of the
+    /// frontend. This function returns a stand-in definition for it, with
+    /// the metadata of the fused backend, which must be used in its place.
+    /// The stand-in never receives any gatestream requests. ArbCmds sent to
+    /// it by the host are rejected, since they cannot be delivered to the
+    /// fused backend; the other backend callbacks are all called by the
+    /// frontend, the `initialize()` callback with no commands.
+    pub fn fuse(&mut self, backend: PluginDefinition) -> Result<PluginDefinition> {
+        if self.typ != PluginType::Frontend {
+            inv_op("only frontends can have a backend fused into them")?;
+        } else if self.fused.is_some() {
+            inv_op("this frontend already has a backend fused into it")?;
+        } else if backend.typ != PluginType::Backend {
+            inv_arg("only backends can be fused into a frontend")?;
+        }
+        let mut stand_in = PluginDefinition::new(PluginType::Backend, backend.metadata.clone());
+        stand_in.gate = Box::new(|_, _| inv_op("the backend is fused into its frontend"));
+        stand_in.host_arb = Box::new(|_, _| {
+            inv_op("cannot deliver ArbCmds to a backend that is fused into its frontend")
+        });
+        self.fused.replace(Box::new(backend));
+        Ok(stand_in)
+    }
+
+    /// Returns the backend fused into this frontend, if any.
+    pub fn get_fused_backend(&self) -> Option<&PluginDefinition> {
+        self.fused.as_deref()
+    }
 }
 
 #[cfg(test)]
@@ -172,4 +234,30 @@ mod tests {
             "PluginDefinition { typ: Backend, metadata: PluginMetadata { name: \"name\", author: \"author\", version: \"0.1.0\" } }"
         );
     }
+
+    #[test]
+    fn fuse() {
+        let metadata = PluginMetadata::new("name", "author", "0.1.0");
+        let backend = || PluginDefinition::new(PluginType::Backend, metadata.clone());
+        let mut frontend = PluginDefinition::new(PluginType::Frontend, metadata.clone());
+
+        assert!(
+            PluginDefinition::new(PluginType::Operator, metadata.clone())
+                .fuse(backend())
+                .is_err()
+        );
+        assert!(frontend
+            .fuse(PluginDefinition::new(
+                PluginType::Frontend,
+                metadata.clone()
+            ))
+            .is_err());
+        assert!(frontend.get_fused_backend().is_none());
+
+        let stand_in = frontend.fuse(backend()).unwrap();
+        assert_eq!(stand_in.get_type(), PluginType::Backend);
+        assert_eq!(stand_in.get_metadata(), &metadata);
+        assert!(frontend.get_fused_backend().is_some());
+        assert!(frontend.fuse(backend()).is_err());
+    }
 }
@@ -0,0 +1,324 @@
+//! Gate fusion operator.
+//!
+//! Compiled circuits often contain long runs of single-qubit rotations.
+//! Every gate costs the backend a pass over its state, even though a run of
+//! single-qubit gates on the same qubit is equivalent to a single gate with
+//! the product of their matrices. The operator defined here buffers unitary
+//! gates per qubit and multiplies consecutive ones into a single `Matrix`
+//! before forwarding them. Optionally, consecutive two-qubit gates acting on
+//! the same pair of qubits (along with the single-qubit gates on either of
+//! them) are fused into a single two-qubit gate as well.
+//!
+//! The pending gates of a qubit are forwarded as soon as a gate that cannot
+//! be fused touches the qubit (including measurements and prep gates), and
+//! when it is freed. All pending gates are forwarded before an `advance()`
+//! or an `ArbCmd` is forwarded, and when the plugin is dropped at the end of
+//! the simulation, such that the gates at the end of the stream reach the
+//! backend even if their qubits are never freed. Pending runs are forwarded
+//! in the order in which they were started, such that the gatestream remains
+//! deterministic. Note that `ArbCmd`s sent by the host directly to a
+//! downstream plugin bypass the operator, and may thus be executed before the
+//! pending gates.
+//!
+//! Gates that carry `ArbData` are never fused, since the data may not be
+//! meaningful for the fused gate. A run consisting of a single gate is
+//! forwarded as-is. A fused gate that is equal to the identity matrix up to
+//! its global phase is dropped entirely.
+
+use crate::{
+    common::{
+        error::Result,
+        types::{ArbData, Gate, GateType, Matrix, PluginMetadata, PluginType, QubitRef},
+    },
+    debug, info,
+    plugin::{definition::PluginDefinition, state::PluginState},
+};
+use std::{
+    collections::{BTreeMap, HashMap},
+    sync::{Arc, Mutex},
+};
+
+/// Maximum root-mean-square difference between a fused matrix and the
+/// identity matrix for the fused gate to be dropped.
+const IDENTITY_EPSILON: f64 = 1.0e-12;
+
+/// A run of fused gates acting on one or two qubits.
+#[derive(Debug)]
+struct Run {
+    /// The qubits the run acts on, in the order used by `matrix`.
+    qubits: Vec<QubitRef>,
+
+    /// The product of the matrices of all gates in the run.
+    matrix: Matrix,
+
+    /// The gate that this run was started with, as long as it is the only
+    /// gate in the run.
+    gate: Option<Gate>,
+}
+
+impl Run {
+    /// Starts an empty run on the given qubits for the given gate. The gate
+    /// itself still needs to be applied to the run.
+    fn new(qubits: Vec<QubitRef>, gate: Gate) -> Run {
+        Run {
+            matrix: Matrix::new_identity(1 << qubits.len()),
+            qubits,
+            gate: Some(gate),
+        }
+    }
+
+    /// Appends a gate acting on the given subset of the qubits of this run to
+    /// the run.
+    fn apply(&mut self, qubits: &[QubitRef], matrix: &Matrix) -> Result<()> {
+        let identity = Matrix::new_identity(2);
+        let matrix = match (self.qubits.len(), qubits.len()) {
+            (2, 1) if qubits[0] == self.qubits[0] => matrix.kron(&identity),
+            (2, 1) => identity.kron(matrix),
+            (2, 2) if qubits[0] != self.qubits[0] => swap_qubits(matrix),
+            _ => matrix.clone(),
+        };
+        self.matrix = matrix.multiply(&self.matrix)?;
+        self.gate = None;
+        Ok(())
+    }
+
+    /// Forwards the run downstream as a single gate.
+    fn forward(self, state: &mut PluginState) -> Result<bool> {
+        if let Some(gate) = self.gate {
+            state.gate(gate)?;
+            return Ok(true);
+        }
+        let identity = Matrix::new_identity(self.matrix.dimension());
+        if self.matrix.approx_eq(&identity, IDENTITY_EPSILON, true) {
+            return Ok(false);
+        }
+        let gate = Gate::new_unitary(self.qubits, vec![], self.matrix)?;
+        if gate.get_targets().len() > 1 {
+            state.gate(gate.with_gate_controls(IDENTITY_EPSILON, false))?;
+        } else {
+            state.gate(gate)?;
+        }
+        Ok(true)
+    }
+}
+
+/// Returns the given two-qubit matrix with its qubits swapped.
+fn swap_qubits(matrix: &Matrix) -> Matrix {
+    let swap = |index: usize| ((index & 1) << 1) | (index >> 1);
+    let mut output = matrix.clone();
+    for row in 0..4 {
+        for col in 0..4 {
+            output[(swap(row), swap(col))] = matrix[(row, col)];
+        }
+    }
+    output
+}
+
+/// State of the gate fusion operator.
+#[derive(Debug, Default)]
+struct Fusion {
+    /// Whether two-qubit gates are fused as well.
+    two_qubit: bool,
+
+    /// The runs that have not been forwarded yet, by identifier. Identifiers
+    /// are assigned in increasing order, so this is ordered by the time at
+    /// which the runs were started.
+    runs: BTreeMap<usize, Run>,
+
+    /// The identifier of the pending run of each qubit that has one.
+    owners: HashMap<QubitRef, usize>,
+
+    /// The identifier for the next run.
+    next_run: usize,
+
+    /// The number of gates received from upstream.
+    gates_in: usize,
+
+    /// The number of gates forwarded downstream.
+    gates_out: usize,
+}
+
+impl Fusion {
+    /// Removes the pending run of the given qubit, if any.
+    fn take(&mut self, qubit: QubitRef) -> Option<Run> {
+        let run = self.runs.remove(&self.owners.remove(&qubit)?).unwrap();
+        for qubit in run.qubits.iter() {
+            self.owners.remove(qubit);
+        }
+        Some(run)
+    }
+
+    /// Makes the given run the pending run of its qubits.
+    fn insert(&mut self, run: Run) {
+        for qubit in run.qubits.iter() {
+            self.owners.insert(*qubit, self.next_run);
+        }
+        self.runs.insert(self.next_run, run);
+        self.next_run += 1;
+    }
+
+    /// Forwards the given run.
+    fn forward(&mut self, state: &mut PluginState, run: Run) -> Result<()> {
+        if run.forward(state)? {
+            self.gates_out += 1;
+        }
+        Ok(())
+    }
+
+    /// Forwards the pending run of the given qubit, if any.
+    fn flush(&mut self, state: &mut PluginState, qubit: QubitRef) -> Result<()> {
+        if let Some(run) = self.take(qubit) {
+            self.forward(state, run)?;
+        }
+        Ok(())
+    }
+
+    /// Forwards all pending runs, in the order in which they were started.
+    fn flush_all(&mut self, state: &mut PluginState) -> Result<()> {
+        self.owners.clear();
+        for (_, run) in std::mem::take(&mut self.runs) {
+            self.forward(state, run)?;
+        }
+        Ok(())
+    }
+
+    /// Returns the qubits and matrix of the given gate if it can be fused.
+    fn fusable(&self, gate: &Gate) -> Option<(Vec<QubitRef>, Matrix)> {
+        if gate.get_type() != &GateType::Unitary
+            || !gate.get_measures().is_empty()
+            || gate.data != ArbData::default()
+        {
+            return None;
+        }
+        match gate.get_targets().len() + gate.get_controls().len() {
+            1 => Some((gate.get_targets().to_vec(), gate.get_matrix()?.clone())),
+            2 if self.two_qubit => {
+                let gate = gate.with_matrix_controls();
+                Some((gate.get_targets().to_vec(), gate.get_matrix()?.clone()))
+            }
+            _ => None,
+        }
+    }
+
+    /// Handles a gate from upstream.
+    fn gate(&mut self, state: &mut PluginState, gate: Gate) -> Result<()> {
+        self.gates_in += 1;
+        let (qubits, matrix) = match self.fusable(&gate) {
+            Some(x) => x,
+            None => {
+                let qubits: Vec<_> = gate
+                    .get_targets()
+                    .iter()
+                    .chain(gate.get_controls().iter())
+                    .chain(gate.get_measures().iter())
+                    .cloned()
+                    .collect();
+                for qubit in qubits {
+                    self.flush(state, qubit)?;
+                }
+                self.gates_out += 1;
+                return state.gate(gate);
+            }
+        };
+
+        // Extend the pending run if it covers all qubits of the gate.
+        let owner = self.owners.get(&qubits[0]).cloned();
+        if owner.is_some()
+            && qubits
+                .iter()
+                .all(|qubit| self.owners.get(qubit) == owner.as_ref())
+        {
+            let mut run = self.take(qubits[0]).unwrap();
+            run.apply(&qubits, &matrix)?;
+            self.insert(run);
+            return Ok(());
+        }
+
+        // Otherwise, start a new run. Pending single-qubit runs of the qubits
+        // are absorbed into it; pending two-qubit runs are forwarded.
+        let mut run = Run::new(qubits.clone(), gate);
+        let mut absorbed = false;
+        for qubit in qubits.iter() {
+            if let Some(pending) = self.take(*qubit) {
+                if pending.qubits.len() == 1 {
+                    run.apply(&pending.qubits, &pending.matrix)?;
+                    absorbed = true;
+                } else {
+                    self.forward(state, pending)?;
+                }
+            }
+        }
+        let gate = run.gate.take();
+        run.apply(&qubits, &matrix)?;
+        if !absorbed {
+            run.gate = gate;
+        }
+        self.insert(run);
+        Ok(())
+    }
+}
+
+/// Constructs the definition of an operator plugin that fuses consecutive
+/// unitary gates, as described in the [module documentation].
+///
+/// When `two_qubit` is set, consecutive two-qubit gates on the same pair of
+/// qubits are fused as well. This can also be enabled by passing a
+/// `fusion.two_qubit` `ArbCmd` to the plugin's `initialize()` callback.
+///
+/// [module documentation]: ./index.html
+pub fn fusion_operator(metadata: impl Into<PluginMetadata>, two_qubit: bool) -> PluginDefinition {
+    let mut definition = PluginDefinition::new(PluginType::Operator, metadata);
+    let fusion = Arc::new(Mutex::new(Fusion {
+        two_qubit,
+        ..Fusion::default()
+    }));
+
+    let f = Arc::clone(&fusion);
+    definition.initialize = Box::new(move |_, cmds| {
+        for cmd in cmds {
+            if cmd.interface_identifier() == "fusion" && cmd.operation_identifier() == "two_qubit" {
+                f.lock().unwrap().two_qubit = true;
+            } else {
+                debug!("Ignoring initialization command {}", cmd);
+            }
+        }
+        Ok(())
+    });
+
+    let f = Arc::clone(&fusion);
+    definition.drop = Box::new(move |state| {
+        let mut f = f.lock().unwrap();
+        f.flush_all(state)?;
+        info!("Fused {} gates into {}", f.gates_in, f.gates_out);
+        Ok(())
+    });
+
+    let f = Arc::clone(&fusion);
+    definition.gate = Box::new(move |state, gate| {
+        f.lock().unwrap().gate(state, gate)?;
+        Ok(vec![])
+    });
+
+    let f = Arc::clone(&fusion);
+    definition.free = Box::new(move |state, qubits| {
+        let mut f = f.lock().unwrap();
+        for qubit in qubits.iter() {
+            f.flush(state, *qubit)?;
+        }
+        state.free(qubits)
+    });
+
+    let f = Arc::clone(&fusion);
+    definition.advance = Box::new(move |state, cycles| {
+        f.lock().unwrap().flush_all(state)?;
+        state.advance(cycles).map(|_| ())
+    });
+
+    let f = fusion;
+    definition.upstream_arb = Box::new(move |state, cmd| {
+        f.lock().unwrap().flush_all(state)?;
+        state.arb(cmd)
+    });
+
+    definition
+}
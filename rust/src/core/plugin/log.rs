@@ -3,7 +3,7 @@
 use crate::{
     common::{
         error::Result,
-        log::{init, proxy::LogProxy, tee_file::TeeFile, Log, LogRecord},
+        log::{batch::BatchProxy, init, tee_file::TeeFile, Log, LogRecord},
     },
     host::configuration::PluginLogConfiguration,
 };
@@ -14,16 +14,17 @@ use ipc_channel::ipc::IpcSender;
 /// Given a [`PluginConfiguration`], start the configured loggers. Consumes
 /// the given log channel sender.
 ///
-/// Starts a thread-local ['LogProxy`], given a [`LoglevelFilter`] bigger
-/// than [`Off`] which forwards log records to the simulator [`LogThread`].
+/// Starts a thread-local ['BatchProxy`], given a [`LoglevelFilter`] bigger
+/// than [`Off`] which forwards log records to the simulator [`LogThread`] in
+/// batches.
 /// Starts [`TeeFile`] loggers, given a non-empty vector of [`TeeFile`], to
 /// forward log records to output files.
 pub fn setup_logging(
     configuration: &PluginLogConfiguration,
-    log_channel: IpcSender<LogRecord>,
+    log_channel: IpcSender<Vec<LogRecord>>,
 ) -> Result<()> {
     let mut loggers = Vec::with_capacity(1 + configuration.tee_files.len());
-    loggers.push(LogProxy::boxed(
+    loggers.push(BatchProxy::boxed(
         configuration.name.as_str(),
         configuration.verbosity,
         log_channel,
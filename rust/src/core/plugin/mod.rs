@@ -1,6 +1,12 @@
 //! Core modules used by the plugin side of DQCsim.
 
+pub mod capture;
 pub mod connection;
 pub mod definition;
+pub mod fusion;
 pub mod log;
+pub mod null;
+mod qubit_table;
+pub mod replay;
 pub mod state;
+pub mod tracer;
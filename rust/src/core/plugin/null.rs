@@ -0,0 +1,221 @@
+//! Null plugins.
+//!
+//! These plugins don't simulate anything. The operator forwards everything
+//! as-is, and the backend returns random measurement results. They are used
+//! for testing, as examples, and to measure the overhead of DQCsim itself.
+//!
+//! By default, the frontend just sends an empty `ArbData` to the host. When
+//! the JSON object passed to its `run()` callback describes a
+//! [`NullWorkload`], it additionally sends a stream of X gates and
+//! measurements through the pipeline, and returns a [`NullWorkloadResult`]
+//! with timing information as the JSON object of its return value. For
+//! instance, using the command line interface:
+//!
+//! ```text
+//! dqcsim --host-stdout -C 'start:{"qubits":16,"gates":100000,"gates_per_measurement":100}' -C wait null null null
+//! ```
+//!
+//! [`NullWorkload`]: struct.NullWorkload.html
+//! [`NullWorkloadResult`]: struct.NullWorkloadResult.html
+
+use crate::{
+    common::{
+        error::Result,
+        gates::UnboundUnitaryGate,
+        types::{
+            ArbData, Gate, Matrix, PluginMetadata, PluginType, QubitMeasurementResult,
+            QubitMeasurementValue, QubitRef,
+        },
+    },
+    debug, info,
+    plugin::{definition::PluginDefinition, state::PluginState},
+};
+use serde::{Deserialize, Serialize};
+use std::time::{Duration, Instant};
+
+/// Workload for the null frontend, taken from the JSON object passed to its
+/// `run()` callback. Missing fields default to zero.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Deserialize, Serialize)]
+#[serde(default)]
+pub struct NullWorkload {
+    /// The number of qubits to allocate. At least one qubit is allocated if
+    /// any gates are to be sent.
+    pub qubits: usize,
+
+    /// The number of X gates to send. The gates are distributed over the
+    /// allocated qubits in round-robin fashion.
+    pub gates: usize,
+
+    /// The number of gates after which the last targeted qubit is measured,
+    /// waiting for the result before sending more gates. Zero means that only
+    /// a single measurement is done after all gates have been sent.
+    pub gates_per_measurement: usize,
+}
+
+impl NullWorkload {
+    /// Returns whether this workload does anything.
+    pub fn is_empty(&self) -> bool {
+        self.qubits == 0 && self.gates == 0
+    }
+}
+
+/// Timing information returned by the null frontend after running a
+/// workload.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Deserialize, Serialize)]
+pub struct NullWorkloadResult {
+    /// The time it took to allocate the qubits, in seconds.
+    pub allocate_seconds: f64,
+
+    /// The time between sending the first gate and receiving the result of
+    /// the final measurement, in seconds.
+    pub gates_seconds: f64,
+
+    /// The number of gates sent per second.
+    pub gates_per_second: f64,
+
+    /// The number of intermediate measurements, excluding the final one.
+    pub measurements: usize,
+
+    /// The mean time between sending an intermediate measurement and
+    /// receiving its result, in seconds.
+    pub round_trip_mean_seconds: f64,
+
+    /// The maximum time between sending an intermediate measurement and
+    /// receiving its result, in seconds.
+    pub round_trip_max_seconds: f64,
+}
+
+/// Measures the given qubit and waits for the result, returning the round
+/// trip time.
+fn measure(state: &mut PluginState, qubit: QubitRef) -> Result<Duration> {
+    let start = Instant::now();
+    state.gate(Gate::new_measurement(vec![qubit], Matrix::new_identity(2))?)?;
+    state.get_measurement(qubit)?;
+    Ok(start.elapsed())
+}
+
+/// Runs the given workload.
+fn run_workload(state: &mut PluginState, workload: NullWorkload) -> Result<NullWorkloadResult> {
+    let mut result = NullWorkloadResult::default();
+
+    let start = Instant::now();
+    let qubits = state.allocate(std::cmp::max(workload.qubits, 1), vec![])?;
+    result.allocate_seconds = start.elapsed().as_secs_f64();
+
+    let x: Matrix = UnboundUnitaryGate::X.into();
+    let mut round_trip_total = Duration::default();
+    let mut round_trip_max = Duration::default();
+    let start = Instant::now();
+    for index in 0..workload.gates {
+        let qubit = qubits[index % qubits.len()];
+        state.gate(Gate::new_unitary(vec![qubit], vec![], x.clone())?)?;
+        if workload.gates_per_measurement > 0 && (index + 1) % workload.gates_per_measurement == 0 {
+            let round_trip = measure(state, qubit)?;
+            round_trip_total += round_trip;
+            round_trip_max = std::cmp::max(round_trip_max, round_trip);
+            result.measurements += 1;
+        }
+    }
+
+    // The final measurement makes sure that all gates have passed through
+    // the pipeline.
+    measure(state, qubits[0])?;
+    result.gates_seconds = start.elapsed().as_secs_f64();
+
+    if result.gates_seconds > 0.0 {
+        result.gates_per_second = workload.gates as f64 / result.gates_seconds;
+    }
+    if result.measurements > 0 {
+        result.round_trip_mean_seconds =
+            round_trip_total.as_secs_f64() / result.measurements as f64;
+        result.round_trip_max_seconds = round_trip_max.as_secs_f64();
+    }
+
+    state.free(qubits)?;
+    Ok(result)
+}
+
+/// Constructs the definition of the null frontend, as described in the
+/// [module documentation].
+///
+/// [module documentation]: ./index.html
+pub fn null_frontend(metadata: impl Into<PluginMetadata>) -> PluginDefinition {
+    let mut definition = PluginDefinition::new(PluginType::Frontend, metadata);
+
+    definition.initialize = Box::new(|_state, arb_cmds| {
+        info!("Running null frontend initialization callback");
+        for arb_cmd in arb_cmds {
+            debug!("{}", arb_cmd);
+        }
+        Ok(())
+    });
+
+    definition.run = Box::new(|state, args| {
+        info!("Running null frontend run callback");
+        state.send(ArbData::default())?;
+        let workload: NullWorkload = serde_json::from_str(&args.get_json()?)?;
+        if workload.is_empty() {
+            return Ok(ArbData::default());
+        }
+        let result = run_workload(state, workload)?;
+        ArbData::from_json(serde_json::to_string(&result)?, vec![])
+    });
+
+    definition
+}
+
+/// Constructs the definition of the null operator, which forwards
+/// everything as-is.
+pub fn null_operator(metadata: impl Into<PluginMetadata>) -> PluginDefinition {
+    let mut definition = PluginDefinition::new(PluginType::Operator, metadata);
+
+    definition.initialize = Box::new(|_state, arb_cmds| {
+        info!("Running null operator initialization callback");
+        for arb_cmd in arb_cmds {
+            debug!("{}", arb_cmd);
+        }
+        Ok(())
+    });
+
+    definition
+}
+
+/// Constructs the definition of the null backend. Measurements return random
+/// values with a 50/50 chance.
+pub fn null_backend(metadata: impl Into<PluginMetadata>) -> PluginDefinition {
+    let mut definition = PluginDefinition::new(PluginType::Backend, metadata);
+
+    definition.initialize = Box::new(|_state, arb_cmds| {
+        info!("Running null backend initialization callback");
+        for arb_cmd in arb_cmds {
+            debug!("{}", arb_cmd);
+        }
+        Ok(())
+    });
+
+    definition.gate = Box::new(|state, gate| {
+        let measured_qubits = gate.get_measures();
+        if measured_qubits.is_empty() {
+            debug!("Received a gate that doesn't measure anything");
+            Ok(vec![])
+        } else {
+            debug!(
+                "Received a gate that measures the following qubits: {:?}",
+                measured_qubits
+            );
+            Ok(measured_qubits
+                .iter()
+                .map(|q| {
+                    let value = if state.random_f64() < 0.5 {
+                        QubitMeasurementValue::Zero
+                    } else {
+                        QubitMeasurementValue::One
+                    };
+                    QubitMeasurementResult::new(*q, value, ArbData::default())
+                })
+                .collect())
+        }
+    });
+
+    definition
+}
@@ -0,0 +1,210 @@
+//! Dense table for the per-qubit bookkeeping of a plugin.
+//!
+//! Plugins look up the classical data of their downstream qubits several
+//! times for every gate, so this data is not stored in a map. Qubit
+//! references are allocated by counting upwards and are never reused (see
+//! `QubitRefGenerator`), so the data is instead stored in columns indexed by
+//! the qubit index: a liveness bitset, the sequence number of the last gate
+//! that affected the qubit, and the latest measurement. To keep the table
+//! from growing with the total number of qubits allocated over the course
+//! of a simulation, blocks of freed qubits at the start of the table are
+//! dropped, such that it only spans from (roughly) the oldest live qubit to
+//! the most recently allocated one.
+
+use crate::common::types::{QubitRef, SequenceNumber};
+use std::collections::VecDeque;
+
+/// The number of qubits per word of the liveness bitset.
+const WORD_BITS: usize = 64;
+
+/// Dense table of per-qubit data, generic over the measurement data type.
+#[derive(Debug)]
+pub struct QubitTable<M> {
+    /// The qubit index corresponding to the first slot of the table. This
+    /// is always a multiple of `WORD_BITS`.
+    base: u64,
+
+    /// Liveness bitset. Bit `i % WORD_BITS` of word `i / WORD_BITS` is set
+    /// when the qubit in slot `i` is allocated.
+    live: VecDeque<u64>,
+
+    /// The downstream sequence number of the gate that last affected the
+    /// qubit in each slot.
+    last_mutation: VecDeque<SequenceNumber>,
+
+    /// The latest measurement of the qubit in each slot.
+    measurement: VecDeque<Option<M>>,
+}
+
+impl<M> Default for QubitTable<M> {
+    fn default() -> Self {
+        QubitTable {
+            base: 0,
+            live: VecDeque::new(),
+            last_mutation: VecDeque::new(),
+            measurement: VecDeque::new(),
+        }
+    }
+}
+
+impl<M> QubitTable<M> {
+    /// Returns the slot of the given qubit if it is allocated.
+    fn slot(&self, qubit: QubitRef) -> Option<usize> {
+        let slot = qubit.to_foreign().ok()?.checked_sub(self.base)? as usize;
+        if slot < self.last_mutation.len()
+            && self.live[slot / WORD_BITS] & (1 << (slot % WORD_BITS)) != 0
+        {
+            Some(slot)
+        } else {
+            None
+        }
+    }
+
+    /// Returns whether the given qubit is allocated.
+    pub fn contains(&self, qubit: QubitRef) -> bool {
+        self.slot(qubit).is_some()
+    }
+
+    /// Adds a newly allocated qubit to the table, without measurement data.
+    ///
+    /// Panics if the qubit precedes the start of the table, which cannot
+    /// happen as long as qubit references are not reused.
+    pub fn insert(&mut self, qubit: QubitRef) {
+        let slot = qubit
+            .to_foreign()
+            .ok()
+            .and_then(|index| index.checked_sub(self.base))
+            .expect("qubit references must not be reused") as usize;
+        while self.last_mutation.len() <= slot {
+            if self.last_mutation.len() % WORD_BITS == 0 {
+                self.live.push_back(0);
+            }
+            self.last_mutation.push_back(SequenceNumber::none());
+            self.measurement.push_back(None);
+        }
+        self.live[slot / WORD_BITS] |= 1 << (slot % WORD_BITS);
+        self.last_mutation[slot] = SequenceNumber::none();
+        self.measurement[slot] = None;
+    }
+
+    /// Removes a freed qubit from the table. This is no-op if the qubit is
+    /// not allocated.
+    pub fn remove(&mut self, qubit: QubitRef) {
+        if let Some(slot) = self.slot(qubit) {
+            self.live[slot / WORD_BITS] &= !(1 << (slot % WORD_BITS));
+            self.measurement[slot] = None;
+
+            // Drop leading blocks of slots that have all been allocated and
+            // freed again.
+            while self.live.front() == Some(&0) && self.last_mutation.len() >= WORD_BITS {
+                self.live.pop_front();
+                self.last_mutation.drain(..WORD_BITS);
+                self.measurement.drain(..WORD_BITS);
+                self.base += WORD_BITS as u64;
+            }
+        }
+    }
+
+    /// Removes all qubits from the table.
+    pub fn clear(&mut self) {
+        *self = QubitTable::default();
+    }
+
+    /// Returns the sequence number of the gate that last affected the given
+    /// qubit, or None if the qubit is not allocated.
+    pub fn last_mutation(&self, qubit: QubitRef) -> Option<SequenceNumber> {
+        self.slot(qubit).map(|slot| self.last_mutation[slot])
+    }
+
+    /// Updates the sequence number of the gate that last affected the given
+    /// qubit. This is no-op if the qubit is not allocated.
+    pub fn set_last_mutation(&mut self, qubit: QubitRef, sequence: SequenceNumber) {
+        if let Some(slot) = self.slot(qubit) {
+            self.last_mutation[slot] = sequence;
+        }
+    }
+
+    /// Returns the latest measurement of the given qubit, or None if the
+    /// qubit is not allocated or has not been measured yet.
+    pub fn measurement(&self, qubit: QubitRef) -> Option<&M> {
+        self.slot(qubit)
+            .and_then(|slot| self.measurement[slot].as_ref())
+    }
+
+    /// Returns mutable access to the latest measurement of the given qubit,
+    /// or None if the qubit is not allocated.
+    pub fn measurement_mut(&mut self, qubit: QubitRef) -> Option<&mut Option<M>> {
+        let slot = self.slot(qubit)?;
+        Some(&mut self.measurement[slot])
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::common::types::{QubitRefGenerator, SequenceNumberGenerator};
+
+    #[test]
+    fn table() {
+        let mut generator = QubitRefGenerator::new();
+        let mut sequence = SequenceNumberGenerator::new();
+        let mut table: QubitTable<u32> = QubitTable::default();
+
+        let qubits = generator.allocate(3);
+        for qubit in qubits.iter().cloned() {
+            table.insert(qubit);
+        }
+        assert!(qubits.iter().all(|qubit| table.contains(*qubit)));
+        assert!(!table.contains(QubitRef::null()));
+        assert!(!table.contains(QubitRef::from_foreign(4).unwrap()));
+        assert_eq!(table.last_mutation(qubits[0]), Some(SequenceNumber::none()));
+        assert_eq!(table.measurement(qubits[0]), None);
+
+        let seq = sequence.get_next();
+        table.set_last_mutation(qubits[1], seq);
+        *table.measurement_mut(qubits[1]).unwrap() = Some(42);
+        assert_eq!(table.last_mutation(qubits[1]), Some(seq));
+        assert_eq!(table.measurement(qubits[1]), Some(&42));
+
+        table.remove(qubits[1]);
+        assert!(!table.contains(qubits[1]));
+        assert_eq!(table.last_mutation(qubits[1]), None);
+        assert!(table.measurement_mut(qubits[1]).is_none());
+        assert!(table.contains(qubits[2]));
+    }
+
+    #[test]
+    fn trim() {
+        let mut generator = QubitRefGenerator::new();
+        let mut table: QubitTable<u32> = QubitTable::default();
+
+        // Allocate and free many qubits while keeping one alive; the table
+        // should not grow beyond a few blocks.
+        let first = generator.allocate(1)[0];
+        table.insert(first);
+        for _ in 0..1000 {
+            let qubits = generator.allocate(10);
+            for qubit in qubits.iter().cloned() {
+                table.insert(qubit);
+            }
+            for qubit in qubits.iter().cloned() {
+                table.remove(qubit);
+            }
+        }
+        assert!(table.contains(first));
+        assert!(table.last_mutation.len() > 10000);
+
+        table.remove(first);
+        assert!(table.last_mutation.len() < 2 * WORD_BITS);
+        assert_eq!(table.live.len(), 1);
+        assert_eq!(table.base % WORD_BITS as u64, 0);
+
+        let qubit = generator.allocate(1)[0];
+        table.insert(qubit);
+        assert!(table.contains(qubit));
+        assert!(!table.contains(first));
+
+        table.clear();
+        assert!(!table.contains(qubit));
+    }
+}
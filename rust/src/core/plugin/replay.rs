@@ -0,0 +1,75 @@
+//! Gatestream replay frontend.
+//!
+//! Replays a gatestream capture file (see the `capture` module) into the
+//! downstream plugin. Since the frontend allocates qubits in the same order
+//! as the plugin that recorded the file did, the qubit references in the
+//! recorded gates match those of the replayed allocations, so the messages
+//! can be forwarded as they are. The requests are sent as fast as the
+//! downstream plugin accepts them; the frontend never waits for measurement
+//! results. Note that this also means that the replayed gatestream does not
+//! depend on measurement results: it is always the gatestream of the recorded
+//! run.
+//!
+//! `ArbCmd`s that failed during the recorded run will usually fail again
+//! during the replay. Such failures are logged as warnings and do not stop
+//! the replay.
+
+use crate::{
+    common::{
+        protocol::{GatestreamDown, PipelinedGatestreamDown},
+        types::{ArbData, PluginMetadata, PluginType},
+    },
+    info,
+    plugin::{capture::CaptureReader, definition::PluginDefinition},
+    warn,
+};
+use std::path::PathBuf;
+
+/// Constructs the definition of a frontend plugin that replays the given
+/// gatestream capture file, as described in the [module documentation].
+///
+/// [module documentation]: ./index.html
+pub fn replay_frontend(
+    metadata: impl Into<PluginMetadata>,
+    file: impl Into<PathBuf>,
+) -> PluginDefinition {
+    let mut definition = PluginDefinition::new(PluginType::Frontend, metadata);
+    let file = file.into();
+
+    definition.run = Box::new(move |state, _| {
+        let mut messages = 0;
+        for message in CaptureReader::open(&file)? {
+            match message? {
+                GatestreamDown::Pipelined(_, request) => match request {
+                    PipelinedGatestreamDown::Allocate(num_qubits, commands) => {
+                        state.allocate(num_qubits, commands)?;
+                    }
+                    PipelinedGatestreamDown::Free(qubits) => state.free(qubits)?,
+                    PipelinedGatestreamDown::Gate(gate) => state.gate(gate)?,
+                    PipelinedGatestreamDown::GateBatch(gates) => state.gate_batch(gates)?,
+                    PipelinedGatestreamDown::Advance(cycles) => {
+                        state.advance(cycles)?;
+                    }
+                    PipelinedGatestreamDown::TimedGate(cycles, gate) => {
+                        state.advance(cycles)?;
+                        state.gate(gate)?;
+                    }
+                    PipelinedGatestreamDown::TimedGateBatch(cycles, gates) => {
+                        state.advance(cycles)?;
+                        state.gate_batch(gates)?;
+                    }
+                },
+                GatestreamDown::ArbRequest(cmd) => {
+                    if let Err(e) = state.arb(cmd) {
+                        warn!("Replayed ArbCmd failed: {}", e);
+                    }
+                }
+            }
+            messages += 1;
+        }
+        info!("Replayed {} gatestream messages", messages);
+        Ok(ArbData::default())
+    });
+
+    definition
+}
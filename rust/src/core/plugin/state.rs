@@ -3,23 +3,27 @@
 use crate::{
     common::{
         error::{err, inv_arg, inv_op, oe_err, Result},
+        log::{deinit, flush},
         protocol::{
             FrontendRunRequest, FrontendRunResponse, GatestreamDown, GatestreamUp,
             PipelinedGatestreamDown, PluginInitializeRequest, PluginInitializeResponse,
             PluginToSimulator, SimulatorToPlugin,
         },
         types::{
-            ArbCmd, ArbData, Cycle, Cycles, Gate, PluginType, QubitMeasurementResult,
-            QubitMeasurementValue, QubitRef, QubitRefGenerator, SequenceNumber,
-            SequenceNumberGenerator,
+            ArbCmd, ArbData, Cycle, Cycles, Gate, OutcomeHistogram, PluginType,
+            QubitMeasurementResult, QubitMeasurementValue, QubitRef, QubitRefGenerator,
+            SequenceNumber, SequenceNumberGenerator,
         },
         util::friendly_enumerate,
     },
     debug, error, fatal,
     plugin::{
+        capture::CaptureWriter,
         connection::{Connection, IncomingMessage, OutgoingMessage},
         definition::PluginDefinition,
         log::setup_logging,
+        qubit_table::QubitTable,
+        tracer::Tracer,
     },
     trace, warn,
 };
@@ -28,7 +32,10 @@ use rand_chacha::{
     rand_core::{RngCore, SeedableRng},
     ChaChaRng,
 };
-use std::collections::{HashMap, HashSet, VecDeque};
+use std::{
+    collections::{HashMap, HashSet, VecDeque},
+    time::{Duration, Instant},
+};
 
 /// Deterministic random number generator used for plugins.
 ///
@@ -75,6 +82,26 @@ impl RandomNumberGenerator {
     pub fn random_f64(&mut self) -> f64 {
         self.rngs[self.selected].sample(Standard)
     }
+
+    /// Fills the given slice with random 64-bit numbers using the active
+    /// RNG. This yields the same numbers as calling `random_u64()` for each
+    /// element in turn.
+    pub fn fill_u64(&mut self, dest: &mut [u64]) {
+        let rng = &mut self.rngs[self.selected];
+        for x in dest.iter_mut() {
+            *x = rng.next_u64();
+        }
+    }
+
+    /// Fills the given slice with random floating point numbers in the range
+    /// `[0,1>` using the active RNG. This yields the same numbers as calling
+    /// `random_f64()` for each element in turn.
+    pub fn fill_f64(&mut self, dest: &mut [f64]) {
+        let rng = &mut self.rngs[self.selected];
+        for x in dest.iter_mut() {
+            *x = rng.sample(Standard);
+        }
+    }
 }
 
 /// Structure containing all the classical data associated with a qubit
@@ -95,16 +122,46 @@ struct QubitMeasurementData {
     timer: Option<Cycles>,
 }
 
-/// Structure containing the data we need to keep track of for each qubit.
-#[derive(Debug, Clone)]
-struct QubitData {
-    /// The latest measurement data for this qubit.
-    measurement: Option<QubitMeasurementData>,
-
-    /// The downstream sequence number of the gate that last affected this
-    /// qubit. Before using the enclosed measurement data, the simulation must
-    /// always be synchronized up to this point.
-    last_mutation: SequenceNumber,
+/// Identifies the result of a measurement that was sent downstream, which
+/// may not have been received yet.
+///
+/// Futures are numbered upwards from 1 in the order in which they are created
+/// by a plugin, and are only meaningful to that plugin.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct MeasurementFuture(u64);
+
+impl MeasurementFuture {
+    /// Converts the foreign representation of a measurement future to the
+    /// type-safe Rust representation.
+    pub fn from_foreign(future: u64) -> Option<MeasurementFuture> {
+        if future == 0 {
+            None
+        } else {
+            Some(MeasurementFuture(future))
+        }
+    }
+
+    /// Converts the type-safe Rust representation of a measurement future to
+    /// the foreign representation.
+    pub fn to_foreign(self) -> u64 {
+        self.0
+    }
+}
+
+/// Function called with the result of a measurement future once it has been
+/// received.
+pub type MeasurementContinuation =
+    Box<dyn FnOnce(&mut PluginState, QubitMeasurementResult) -> Result<()>>;
+
+/// State of a measurement future.
+#[derive(Debug)]
+enum MeasurementFutureState {
+    /// Waiting for the measurement of the given qubit by the gate with the
+    /// given downstream sequence number.
+    Pending(SequenceNumber, QubitRef),
+
+    /// The measurement has been received.
+    Ready(QubitMeasurementResult),
 }
 
 /// Structure representing the state of a plugin.
@@ -134,6 +191,10 @@ pub struct PluginState<'a> {
     /// Objects received from the host, to be consumed using `recv()`.
     host_to_frontend_data: VecDeque<ArbData>,
 
+    /// Outcomes recorded with `record_outcome()`, to be sent to the host in
+    /// the next RunResponse.
+    outcomes: OutcomeHistogram,
+
     /// Random number generator.
     rng: Option<RandomNumberGenerator>,
 
@@ -180,9 +241,17 @@ pub struct PluginState<'a> {
     /// acknowledged).
     downstream_sequence_rx: SequenceNumber,
 
+    /// The maximum number of requests that may be in flight downstream, or 0
+    /// for no limit. See `throttle_downstream()`.
+    downstream_window: usize,
+
     /// Downstream simulation time, TX-synchronized.
     downstream_cycle_tx: Cycle,
 
+    /// Number of cycles that `advance()` has been called for but that have
+    /// not been sent downstream yet. See `send_downstream()`.
+    downstream_pending_advance: Cycles,
+
     /// Downstream simulation time, RX-synchronized.
     downstream_cycle_rx: Cycle,
 
@@ -193,9 +262,12 @@ pub struct PluginState<'a> {
     /// in sync with upstream_qubit_ref_generator of the downstream plugin.
     downstream_qubit_ref_generator: QubitRefGenerator,
 
-    /// Current state of the qubit measurement bits. The keys in this map also
-    /// function as the set of all live downstream qubit references.
-    downstream_qubit_data: HashMap<QubitRef, QubitData>,
+    /// Current state of the qubit measurement bits, along with the sequence
+    /// number of the gate that last affected each qubit. Before using the
+    /// measurement data of a qubit, the simulation must always be
+    /// synchronized up to the latter. The table also functions as the set of
+    /// all live downstream qubit references.
+    downstream_qubit_data: QubitTable<QubitMeasurementData>,
 
     /// Measurement results from downstream, queued until we get the sequence
     /// number they belong to.
@@ -205,8 +277,40 @@ pub struct PluginState<'a> {
     /// we sent downstream.
     downstream_expected_measurements: VecDeque<(SequenceNumber, HashSet<QubitRef>)>,
 
+    /// The most recently created measurement future.
+    measurement_future_counter: u64,
+
+    /// Measurement futures that have not been consumed yet.
+    measurement_futures: HashMap<MeasurementFuture, MeasurementFutureState>,
+
+    /// Futures waiting for a measurement, indexed by the downstream sequence
+    /// number of the gate that does the measurement and the measured qubit.
+    /// This includes futures that have been consumed by registering a
+    /// continuation.
+    pending_measurements: HashMap<(SequenceNumber, QubitRef), Vec<MeasurementFuture>>,
+
+    /// Continuations waiting for the result of a future.
+    measurement_continuations: HashMap<MeasurementFuture, MeasurementContinuation>,
+
+    /// Continuations for which the result has been received, but which have
+    /// not been called yet. They are called from within the next API call
+    /// that deals with measurement futures.
+    ready_continuations: VecDeque<(MeasurementContinuation, QubitMeasurementResult)>,
+
     /// Aborted flag indicates if the plugin received the aborted signal.
     aborted: bool,
+
+    /// Records timeline events if tracing was enabled by the host.
+    tracer: Option<Tracer>,
+
+    /// Records the messages sent downstream if a capture file was configured
+    /// by the host.
+    downstream_capture: Option<CaptureWriter>,
+
+    /// State of the backend fused into this frontend, if any. When set, the
+    /// gatestream requests made by the frontend are handled by calling the
+    /// backend's callbacks directly instead of sending them downstream.
+    fused: Option<Box<PluginState<'a>>>,
 }
 
 impl<'a> PluginState<'a> {
@@ -224,6 +328,28 @@ impl<'a> PluginState<'a> {
         trace!("seeding with value {}", seed);
         self.rng.replace(RandomNumberGenerator::new(3, seed));
 
+        // Start recording timeline events if requested.
+        self.tracer = if req.trace { Some(Tracer::new()) } else { None };
+
+        // Limit the number of requests in flight downstream if requested.
+        self.downstream_window = req.downstream_window;
+
+        // Poll for incoming messages before blocking if requested.
+        self.connection.set_receive_strategy(req.receive_strategy);
+
+        // Set up the state of the fused backend, if any. It gets its own
+        // deterministic random number streams, and is always synchronous to
+        // the gatestream from its perspective.
+        let definition = self.definition;
+        if let Some(backend) = definition.get_fused_backend() {
+            trace!("setting up fused backend {}", backend.get_metadata());
+            let mut fused = PluginState::new(backend, Connection::detached()?);
+            let mut rng = RandomNumberGenerator::new(3, !seed);
+            rng.select(1);
+            fused.rng.replace(rng);
+            self.fused.replace(Box::new(fused));
+        }
+
         // Make sure that we're the type of plugin that the simulator is
         // expecting.
         if typ != req.plugin_type {
@@ -236,7 +362,17 @@ impl<'a> PluginState<'a> {
         // Connect to downstream plugin, unless we're a backend.
         if typ != PluginType::Backend {
             self.connection
-                .connect_downstream(req.downstream.unwrap())?;
+                .connect_downstream(req.downstream.unwrap(), req.downstream_transport)?;
+        }
+
+        // Start recording the gatestream to the downstream plugin if
+        // requested.
+        if typ != PluginType::Backend {
+            if let Some(file) = req.downstream_capture {
+                debug!("capturing downstream gatestream to {}", file.display());
+                self.downstream_capture
+                    .replace(CaptureWriter::create(file)?);
+            }
         }
 
         // If we're not a frontend, initialize an upstream server.
@@ -262,25 +398,87 @@ impl<'a> PluginState<'a> {
         result
     }
 
-    /// Handles a SimulatorToPlugin::Abort RPC.
-    fn handle_abort(&mut self) -> Result<()> {
-        trace!("started handle_abort()!");
-
+    /// Finishes the current simulation by synchronizing with the downstream
+    /// plugin and calling the user's `drop()` callback.
+    fn finalize(&mut self) -> Result<()> {
         // Make sure we receive gatestream acknowledgements for every request
         // we sent, ensuring that errors are propagated.
         self.synchronize_downstream()?;
 
-        // Call the user's finalize function.
+        // Call the user's finalize function, and that of the fused backend
+        // after it.
         (self.definition.drop)(self)?;
+        if let Some(backend) = self.fused.as_deref_mut() {
+            (backend.definition.drop)(backend)?;
+        }
 
         // Finalization should not send any more requests downstream, but just
         // in case:
         self.synchronize_downstream()?;
 
+        // Write out the rest of the gatestream capture file, if any.
+        if let Some(capture) = self.downstream_capture.as_mut() {
+            capture.flush()?;
+        }
+        Ok(())
+    }
+
+    /// Handles a SimulatorToPlugin::Abort RPC.
+    fn handle_abort(&mut self) -> Result<()> {
+        trace!("started handle_abort()!");
+        self.finalize()?;
         trace!("finished handle_abort()!");
         Ok(())
     }
 
+    /// Handles a SimulatorToPlugin::Reset RPC.
+    ///
+    /// The state is reset even if finalization fails, such that the plugin
+    /// is always left waiting for a new `Initialize` request. Since this
+    /// disconnects from the log thread, finalization errors are logged here
+    /// rather than by the caller. They take precedence over errors returned
+    /// by the disconnect itself.
+    fn handle_reset(&mut self) -> Result<()> {
+        trace!("started handle_reset()!");
+        let result = self.finalize();
+        if let Err(e) = &result {
+            error!("{}", e);
+        }
+        self.connection.reset();
+        self.inside_run = false;
+        self.synchronized_to_rpcs = true;
+        self.frontend_to_host_data.clear();
+        self.host_to_frontend_data.clear();
+        self.outcomes.clear();
+        self.rng = None;
+        self.downstream_qubit_ref_generator = QubitRefGenerator::new();
+        self.downstream_sequence_tx = SequenceNumberGenerator::new();
+        self.downstream_sequence_rx = SequenceNumber::none();
+        self.downstream_cycle_tx = Cycle::t_zero();
+        self.downstream_pending_advance = 0;
+        self.downstream_cycle_rx = Cycle::t_zero();
+        self.upstream_qubit_ref_generator = QubitRefGenerator::new();
+        self.upstream_issued_up_to = SequenceNumber::none();
+        self.upstream_postponed.clear();
+        self.upstream_completed_up_to = SequenceNumber::none();
+        self.downstream_qubit_data.clear();
+        self.downstream_measurement_queue.clear();
+        self.downstream_expected_measurements.clear();
+        self.measurement_future_counter = 0;
+        self.measurement_futures.clear();
+        self.pending_measurements.clear();
+        self.measurement_continuations.clear();
+        self.ready_continuations.clear();
+        self.tracer = None;
+        self.downstream_capture = None;
+        self.fused = None;
+        trace!("finished handle_reset()!");
+
+        // Disconnect from the log thread of the simulation we were part of;
+        // the next Initialize request provides a new one.
+        result.and(deinit())
+    }
+
     /// Handles a run request while we're NOT blocked inside the run()
     /// callback.
     fn handle_run(&mut self, req: FrontendRunRequest) -> Result<FrontendRunResponse> {
@@ -300,7 +498,7 @@ impl<'a> PluginState<'a> {
         // If start is set, call the run() callback.
         let return_value = if let Some(args) = req.start {
             self.inside_run = true;
-            let return_value = (self.definition.run)(self, args);
+            let return_value = self.traced("run", |state| (state.definition.run)(state, args));
             self.inside_run = false;
             Some(return_value?)
         } else {
@@ -313,20 +511,22 @@ impl<'a> PluginState<'a> {
         Ok(FrontendRunResponse {
             return_value,
             messages,
+            outcomes: self.outcomes.take(),
         })
     }
 
-    /// Processes a checked measurement.
-    ///
-    /// That is, saves it to our cache, and forwards it upstream if we're an
-    /// operator.
-    fn handle_measurement(&mut self, measurement: QubitMeasurementResult) -> Result<()> {
+    /// Saves a checked measurement to our cache. Returns whether the
+    /// measurement was cached, i.e. whether the qubit still exists.
+    fn cache_measurement(&mut self, measurement: &QubitMeasurementResult) -> bool {
         // Note that it's not an error if there is no data entry for the
         // received qubit (anymore). This just means that the qubit has been
         // freed soon after it was measured, the measurement result was never
         // read/waited upon, and the downstream plugin is sufficiently lagging
         // behind us.
-        if let Some(data) = self.downstream_qubit_data.get_mut(&measurement.qubit) {
+        if let Some(previous) = self
+            .downstream_qubit_data
+            .measurement_mut(measurement.qubit)
+        {
             trace!("Caching measurement for qubit {}...", measurement.qubit);
 
             // Current simulation time.
@@ -334,7 +534,7 @@ impl<'a> PluginState<'a> {
 
             // Cycles between the previous measurement and the current
             // simulation time.
-            let timer = if let Some(x) = &data.measurement {
+            let timer = if let Some(x) = previous.as_ref() {
                 let delta = timestamp - x.timestamp;
                 if delta < 0 {
                     panic!("simulation time is apparently not monotonous?");
@@ -345,29 +545,186 @@ impl<'a> PluginState<'a> {
             };
 
             // Update the measurement data.
-            data.measurement.replace(QubitMeasurementData {
+            previous.replace(QubitMeasurementData {
                 value: measurement.value,
                 data: measurement.data.clone(),
                 timestamp,
                 timer,
             });
-
-            // If we're an operator, propagate the measurement upstream using
-            // the `modify_measurement()` callback.
-            if self.definition.get_type() == PluginType::Operator {
-                let measurements = (self.definition.modify_measurement)(self, measurement)?;
-                for measurement in measurements {
-                    self.connection
-                        .send(OutgoingMessage::Upstream(GatestreamUp::Measured(
-                            measurement,
-                        )))?;
-                }
-            }
+            true
         } else {
             trace!(
                 "Not caching measurement for qubit {}; no data exists (anymore)",
                 measurement.qubit
             );
+            false
+        }
+    }
+
+    /// Propagates cached measurements upstream if we're an operator.
+    ///
+    /// The measurements are passed to the `modify_measurements()` callback
+    /// in one go if the user defined it, or to the `modify_measurement()`
+    /// callback one by one otherwise. The resulting measurements are sent
+    /// upstream in a single message.
+    fn forward_measurements(&mut self, measurements: Vec<QubitMeasurementResult>) -> Result<()> {
+        if self.definition.get_type() != PluginType::Operator || measurements.is_empty() {
+            return Ok(());
+        }
+        let modified = if let Some(modify_measurements) = &self.definition.modify_measurements {
+            let start = Instant::now();
+            let modified = modify_measurements(self, measurements);
+            let elapsed = start.elapsed();
+            self.connection
+                .stats_mut()
+                .modify_measurement_callback
+                .record(elapsed);
+            self.trace_span("modify_measurements", start, elapsed);
+            modified?
+        } else {
+            let mut modified = vec![];
+            for measurement in measurements {
+                let start = Instant::now();
+                let measurements = (self.definition.modify_measurement)(self, measurement);
+                let elapsed = start.elapsed();
+                self.connection
+                    .stats_mut()
+                    .modify_measurement_callback
+                    .record(elapsed);
+                self.trace_span("modify_measurement", start, elapsed);
+                modified.extend(measurements?);
+            }
+            modified
+        };
+        self.send_measurements_upstream(modified)
+    }
+
+    /// Sends the given measurements upstream. Multiple measurements are sent
+    /// using a single `MeasuredBatch` message.
+    fn send_measurements_upstream(
+        &mut self,
+        mut measurements: Vec<QubitMeasurementResult>,
+    ) -> Result<()> {
+        let message = match measurements.len() {
+            0 => return Ok(()),
+            1 => GatestreamUp::Measured(measurements.pop().unwrap()),
+            _ => GatestreamUp::MeasuredBatch(measurements),
+        };
+        self.connection.send(OutgoingMessage::Upstream(message))
+    }
+
+    /// Records a span of time in the trace, if tracing is enabled.
+    fn trace_span(&mut self, name: &'static str, start: Instant, duration: Duration) {
+        if let Some(tracer) = self.tracer.as_mut() {
+            tracer.span(name, start, duration);
+        }
+    }
+
+    /// Calls the given callback, recording the time spent in it in the trace
+    /// if tracing is enabled.
+    fn traced<T>(&mut self, name: &'static str, f: impl FnOnce(&mut Self) -> T) -> T {
+        if self.tracer.is_some() {
+            let start = Instant::now();
+            let result = f(self);
+            self.trace_span(name, start, start.elapsed());
+            result
+        } else {
+            f(self)
+        }
+    }
+
+    /// Blocks until there is room in the in-flight window for another
+    /// downstream request, if the window is limited.
+    ///
+    /// Without a limit, a plugin that produces requests faster than its
+    /// downstream plugin can handle them only blocks when it needs a result,
+    /// while the requests pile up in the channel in the meantime. When the
+    /// window is full, we wait until half of it has been acknowledged rather
+    /// than just a single request, such that a plugin that is continuously
+    /// throttled does not have to block for every request it sends.
+    fn throttle_downstream(&mut self) -> Result<()> {
+        let window = self.downstream_window as u64;
+        if window == 0 {
+            return Ok(());
+        }
+        let last_sent = self.downstream_sequence_tx.get_previous();
+        if self
+            .downstream_sequence_rx
+            .acknowledges(last_sent.preceding_by(window - 1))
+        {
+            return Ok(());
+        }
+        trace!("In-flight window of {} requests is full", window);
+        let start = Instant::now();
+        let result = self.synchronize_downstream_up_to(last_sent.preceding_by(window / 2));
+        self.connection
+            .stats_mut()
+            .throttled
+            .record(start.elapsed());
+        result
+    }
+
+    /// Sends a pipelined request downstream, returning the sequence number
+    /// assigned to it.
+    ///
+    /// Any pending advancement is sent first. If the request is a gate or
+    /// gate batch, the advancement is folded into it, such that the common
+    /// pattern of alternating gates and advancements only takes one message
+    /// per gate.
+    fn send_downstream(&mut self, request: PipelinedGatestreamDown) -> Result<SequenceNumber> {
+        let cycles = std::mem::replace(&mut self.downstream_pending_advance, 0);
+        let request = if cycles == 0 {
+            request
+        } else {
+            match request {
+                PipelinedGatestreamDown::Gate(gate) => {
+                    PipelinedGatestreamDown::TimedGate(cycles, gate)
+                }
+                PipelinedGatestreamDown::GateBatch(gates) => {
+                    PipelinedGatestreamDown::TimedGateBatch(cycles, gates)
+                }
+                request => {
+                    self.send_downstream(PipelinedGatestreamDown::Advance(cycles))?;
+                    request
+                }
+            }
+        };
+        self.throttle_downstream()?;
+        let sequence = self.downstream_sequence_tx.get_next();
+        self.send_downstream_message(GatestreamDown::Pipelined(sequence, request))?;
+        if let Some(tracer) = self.tracer.as_mut() {
+            tracer.request_sent(sequence);
+        }
+        Ok(sequence)
+    }
+
+    /// Sends the cycles accumulated by `advance()` downstream, if there are
+    /// any.
+    fn flush_downstream_advance(&mut self) -> Result<()> {
+        let cycles = std::mem::replace(&mut self.downstream_pending_advance, 0);
+        if cycles > 0 {
+            self.send_downstream(PipelinedGatestreamDown::Advance(cycles))?;
+        }
+        Ok(())
+    }
+
+    /// Sends a message downstream, recording it to the capture file first if
+    /// there is one.
+    fn send_downstream_message(&mut self, message: GatestreamDown) -> Result<()> {
+        if let Some(capture) = self.downstream_capture.as_mut() {
+            capture.record(&message)?;
+        }
+        self.connection.send(OutgoingMessage::Downstream(message))
+    }
+
+    /// Records a request that is handled by the fused backend to the capture
+    /// file, if there is one, as if it had been sent downstream. Such
+    /// requests have no sequence number, so they are recorded with
+    /// `SequenceNumber::none()`; replaying ignores it anyway. The message is
+    /// only constructed when capturing.
+    fn capture_fused(&mut self, message: impl FnOnce() -> GatestreamDown) -> Result<()> {
+        if let Some(capture) = self.downstream_capture.as_mut() {
+            capture.record(&message())?;
         }
         Ok(())
     }
@@ -382,10 +739,14 @@ impl<'a> PluginState<'a> {
         trace!("Downstream completed up to {}", sequence);
         // Update the sequence number.
         self.downstream_sequence_rx = sequence;
+        if let Some(tracer) = self.tracer.as_mut() {
+            tracer.requests_completed(sequence);
+        }
 
         // Check queued measurements against the ones expected from the gates
         // that we sent.
         let measurements: Vec<_> = self.downstream_measurement_queue.drain(..).collect();
+        let mut received = Vec::with_capacity(measurements.len());
         for measurement in measurements {
             // pop is set when we've received all the measurements for the
             // current gate (at the front of the downstream_expected_measurements
@@ -400,19 +761,27 @@ impl<'a> PluginState<'a> {
             // measurement has not been handled yet.
             let mut ok = false;
 
-            // Note that we're using the above two flags to keep Ferris happy;
-            // we can't use self within the if let due to the mutable borrow.
+            // The sequence number of the gate that the measurement belongs
+            // to, valid if ok is set.
+            let mut gate_sequence = SequenceNumber::none();
+
+            // Note that we're using the above flags to keep Ferris happy; we
+            // can't use self within the if let due to the mutable borrow.
             if let Some(expected) = self.downstream_expected_measurements.front_mut() {
                 if sequence.acknowledges(expected.0) && expected.1.remove(&measurement.qubit) {
                     ok = true;
                     pop = expected.1.is_empty();
+                    gate_sequence = expected.0;
                 }
             }
 
             // Do what we just determined we need to do.
             if ok {
                 // Handle the received measurement.
-                self.handle_measurement(measurement)?;
+                self.resolve_measurement_futures(gate_sequence, &measurement);
+                if self.cache_measurement(&measurement) {
+                    received.push(measurement);
+                }
 
                 // Clean up/move on to the next gate if we received everything
                 // we were expecting for the current gate.
@@ -458,25 +827,23 @@ impl<'a> PluginState<'a> {
             // Uh oh, the current gate was (still) expecting measurements.
             // So we just fabricate some measurements (with the value set to
             // "undefined" of course) to work around the downstream plugin's
-            // bugs. We also move on to the next gate (note the pop_front in
-            // the iterator).
-            for qubit in self
-                .downstream_expected_measurements
-                .pop_front()
-                .unwrap()
-                .1
-                .drain()
-            {
-                if self.downstream_qubit_data.contains_key(&qubit) {
+            // bugs. We also move on to the next gate.
+            let (gate_sequence, qubits) =
+                self.downstream_expected_measurements.pop_front().unwrap();
+            for qubit in qubits {
+                let measurement = QubitMeasurementResult::new(
+                    qubit,
+                    QubitMeasurementValue::Undefined,
+                    ArbData::default(),
+                );
+                self.resolve_measurement_futures(gate_sequence, &measurement);
+                if self.downstream_qubit_data.contains(qubit) {
                     warn!(
                         "missing measurement data for qubit {}, setting to undefined; bug in downstream plugin!",
                         qubit
                     );
-                    self.handle_measurement(QubitMeasurementResult::new(
-                        qubit,
-                        QubitMeasurementValue::Undefined,
-                        ArbData::default(),
-                    ))?;
+                    self.cache_measurement(&measurement);
+                    received.push(measurement);
                 } else {
                     trace!(
                         "missing measurement data for qubit {}, which has already been deallocated",
@@ -486,17 +853,81 @@ impl<'a> PluginState<'a> {
             }
         }
 
+        // Propagate everything we received in one go.
+        self.forward_measurements(received)?;
+
         self.check_completed_up_to()?;
 
         Ok(())
     }
 
+    /// Resolves the futures waiting for the given measurement, made by the
+    /// gate with the given downstream sequence number.
+    fn resolve_measurement_futures(
+        &mut self,
+        sequence: SequenceNumber,
+        measurement: &QubitMeasurementResult,
+    ) {
+        if let Some(futures) = self
+            .pending_measurements
+            .remove(&(sequence, measurement.qubit))
+        {
+            for future in futures {
+                if let Some(continuation) = self.measurement_continuations.remove(&future) {
+                    self.ready_continuations
+                        .push_back((continuation, measurement.clone()));
+                } else if let Some(state) = self.measurement_futures.get_mut(&future) {
+                    *state = MeasurementFutureState::Ready(measurement.clone());
+                }
+            }
+        }
+    }
+
+    /// Calls the continuations of all futures that have been resolved.
+    fn call_measurement_continuations(&mut self) -> Result<()> {
+        while let Some((continuation, measurement)) = self.ready_continuations.pop_front() {
+            continuation(self, measurement)?;
+        }
+        Ok(())
+    }
+
+    /// Handles the responses from downstream that have already been
+    /// received, without blocking.
+    fn receive_downstream(&mut self) -> Result<()> {
+        // See synchronize_downstream_up_to(). Unlike there, we may already be
+        // handling a downstream message when this is called, so restore the
+        // previous synchronization state rather than assuming we're
+        // synchronous.
+        let synchronized_to_rpcs = self.synchronized_to_rpcs;
+        let rng_index = self
+            .rng
+            .as_ref()
+            .map(RandomNumberGenerator::get_selected)
+            .unwrap_or(0);
+        let mut result = Ok(());
+        while let Some(message) = self.connection.try_next_downstream_request()? {
+            if let IncomingMessage::Downstream(message) = message {
+                result = self.handle_downstream_message(message);
+                if result.is_err() {
+                    break;
+                }
+            }
+        }
+        if let Some(ref mut rng) = self.rng {
+            rng.select(rng_index);
+        }
+        self.synchronized_to_rpcs = synchronized_to_rpcs;
+        result
+    }
+
     /// Check whether we can/need to send the next CompletedUpTo message.
     fn check_completed_up_to(&mut self) -> Result<()> {
         let mut completed_up_to = self.upstream_issued_up_to;
 
         // Update the upstream_postponed mapping to see if we can propagate the
-        // acknowledgement upstream.
+        // acknowledgement upstream. The measurements of all acknowledged
+        // requests are sent in a single message.
+        let mut measurements = vec![];
         while !self.upstream_postponed.is_empty() {
             let mut acknowledged = false;
             if let Some((downstream, _, _)) = self.upstream_postponed.front() {
@@ -504,16 +935,12 @@ impl<'a> PluginState<'a> {
             }
             if acknowledged {
                 let (_, _, postponed_measurements) = self.upstream_postponed.pop_front().unwrap();
-                for postponed_measurement in postponed_measurements {
-                    self.connection
-                        .send(OutgoingMessage::Upstream(GatestreamUp::Measured(
-                            postponed_measurement,
-                        )))?;
-                }
+                measurements.extend(postponed_measurements);
             } else {
                 break;
             }
         }
+        self.send_measurements_upstream(measurements)?;
 
         // Check the upstream_postponed map to see if any command with an
         // upstream sequence number lower than self.upstream_issued_up_to
@@ -566,6 +993,13 @@ impl<'a> PluginState<'a> {
                 );
                 self.downstream_measurement_queue.push_back(measurement);
             }
+            GatestreamUp::MeasuredBatch(measurements) => {
+                trace!(
+                    "Downstream sent measurements for {} qubits",
+                    measurements.len()
+                );
+                self.downstream_measurement_queue.extend(measurements);
+            }
             GatestreamUp::Advanced(cycles) => {
                 self.downstream_cycle_rx = self.downstream_cycle_rx.advance(cycles);
             }
@@ -578,6 +1012,96 @@ impl<'a> PluginState<'a> {
         Ok(())
     }
 
+    /// Handles an advancement received from upstream by acknowledging the
+    /// advancement upstream and calling the user's `advance()` callback.
+    fn handle_upstream_advance(&mut self, cycles: Cycles) -> Result<()> {
+        self.connection
+            .send(OutgoingMessage::Upstream(GatestreamUp::Advanced(cycles)))?;
+        let start = Instant::now();
+        let result = (self.definition.advance)(self, cycles);
+        let elapsed = start.elapsed();
+        self.connection.stats_mut().advance_callback.record(elapsed);
+        self.trace_span("advance", start, elapsed);
+        result
+    }
+
+    /// Handles a batch of gates received from upstream by calling the user's
+    /// `gate()` callback for each of them, stopping at the first error.
+    fn handle_upstream_gate_batch(
+        &mut self,
+        sequence: SequenceNumber,
+        gates: Vec<Gate>,
+        queued_measurements: &mut Vec<QubitMeasurementResult>,
+    ) -> Result<()> {
+        for gate in gates {
+            self.handle_upstream_gate(sequence, gate, queued_measurements)?;
+
+            // Operators postpone the measurements of each gate in the batch
+            // separately, such that they are forwarded upstream in the same
+            // order as they would be if the gates were sent individually.
+            if self.definition.get_type() == PluginType::Operator {
+                let back_sequence = self.downstream_sequence_tx.get_previous();
+                self.upstream_postponed.push_back((
+                    back_sequence,
+                    sequence,
+                    queued_measurements.drain(..).collect(),
+                ));
+            }
+        }
+        Ok(())
+    }
+
+    /// Handles a gate received from upstream by calling the user's `gate()`
+    /// callback.
+    ///
+    /// Measurement results returned immediately by the callback are appended
+    /// to `queued_measurements`; the caller is responsible for sending them
+    /// upstream at the appropriate time.
+    fn handle_upstream_gate(
+        &mut self,
+        sequence: SequenceNumber,
+        gate: Gate,
+        queued_measurements: &mut Vec<QubitMeasurementResult>,
+    ) -> Result<()> {
+        let mut measures: HashSet<_> = gate.get_measures().iter().cloned().collect();
+        let start = Instant::now();
+        let measurements = (self.definition.gate)(self, gate);
+        let elapsed = start.elapsed();
+        let stats = self.connection.stats_mut();
+        stats.gates_received += 1;
+        stats.gate_callback.record(elapsed);
+        self.trace_span("gate", start, elapsed);
+        let measurements = measurements?;
+        for measurement in measurements {
+            if measures.remove(&measurement.qubit) {
+                queued_measurements.push(measurement);
+            } else {
+                err(format!(
+                    "user-defined gate() function returned multiple measurements for qubit {}",
+                    measurement.qubit
+                ))?;
+            }
+        }
+        if !measures.is_empty() {
+            if self.definition.get_type() == PluginType::Operator {
+                // These measurement results are postponed until we receive
+                // (and maybe modify) them from downstream.
+                trace!(
+                    "Postponing measurement results for {} until downstream {}",
+                    sequence,
+                    self.downstream_sequence_tx.get_previous()
+                );
+            } else {
+                // Backends cannot postpone.
+                err(format!(
+                    "user-defined gate() function failed to return measurement for qubits {}",
+                    friendly_enumerate(measures.into_iter(), Some("or"))
+                ))?;
+            }
+        }
+        Ok(())
+    }
+
     /// Handles any incoming message.
     ///
     /// The returned boolean indicates whether the message was an abort,
@@ -612,7 +1136,10 @@ impl<'a> PluginState<'a> {
                             }
                         },
                         SimulatorToPlugin::UserInitialize(req) => {
-                            match (self.definition.initialize)(self, req.init_cmds) {
+                            match self
+                                .fused_initialize()
+                                .and_then(|_| (self.definition.initialize)(self, req.init_cmds))
+                            {
                                 Ok(_) => PluginToSimulator::Success,
                                 Err(e) => {
                                     let e = e.to_string();
@@ -632,6 +1159,12 @@ impl<'a> PluginState<'a> {
                                 }
                             }
                         }
+                        // handle_reset() logs its own errors, as it
+                        // disconnects from the log thread.
+                        SimulatorToPlugin::Reset => match self.handle_reset() {
+                            Ok(_) => PluginToSimulator::Success,
+                            Err(e) => PluginToSimulator::Failure(e.to_string()),
+                        },
                         SimulatorToPlugin::RunRequest(req) => match self.handle_run(req) {
                             Ok(x) => PluginToSimulator::RunResponse(x),
                             Err(e) => {
@@ -640,8 +1173,19 @@ impl<'a> PluginState<'a> {
                                 PluginToSimulator::Failure(e)
                             }
                         },
+                        SimulatorToPlugin::StatsRequest => {
+                            PluginToSimulator::Stats(self.connection.stats())
+                        }
+                        SimulatorToPlugin::TraceRequest => PluginToSimulator::Trace(
+                            self.tracer
+                                .as_mut()
+                                .map(Tracer::take_events)
+                                .unwrap_or_default(),
+                        ),
                         SimulatorToPlugin::ArbRequest(req) => {
-                            match (self.definition.host_arb)(self, req) {
+                            match self
+                                .traced("host_arb", |state| (state.definition.host_arb)(state, req))
+                            {
                                 Ok(x) => PluginToSimulator::ArbResponse(x),
                                 Err(e) => {
                                     let e = e.to_string();
@@ -675,48 +1219,36 @@ impl<'a> PluginState<'a> {
                     let response = match message {
                         PipelinedGatestreamDown::Allocate(num_qubits, commands) => {
                             let qubits = self.upstream_qubit_ref_generator.allocate(num_qubits);
-                            (self.definition.allocate)(self, qubits, commands)
+                            self.traced("allocate", |state| {
+                                (state.definition.allocate)(state, qubits, commands)
+                            })
                         }
                         PipelinedGatestreamDown::Free(qubits) => {
                             self.upstream_qubit_ref_generator.free(qubits.clone());
-                            (self.definition.free)(self, qubits)
+                            self.traced("free", |state| (state.definition.free)(state, qubits))
                         }
                         PipelinedGatestreamDown::Gate(gate) => {
-                            let mut measures: HashSet<_> =
-                                gate.get_measures().iter().cloned().collect();
-                            (self.definition.gate)(self, gate).and_then(|measurements| {
-                            for measurement in measurements {
-                                if measures.remove(&measurement.qubit) {
-                                    queued_measurements.push(measurement);
-                                } else {
-                                    err(format!(
-                                        "user-defined gate() function returned multiple measurements for qubit {}",
-                                        measurement.qubit
-                                    ))?;
-                                }
-                            }
-                            if !measures.is_empty() {
-                                if self.definition.get_type() == PluginType::Operator {
-                                    // These measurement results are postponed
-                                    // until we receive (and maybe modify) them
-                                    // from downstream.
-                                    trace!("Postponing measurement results for {} until downstream {}",
-                                        sequence, self.downstream_sequence_tx.get_previous());
-                                } else {
-                                    // Backends cannot postpone.
-                                    err(format!(
-                                        "user-defined gate() function failed to return measurement for qubits {}",
-                                        friendly_enumerate(measures.into_iter(), Some("or"))
-                                    ))?;
-                                }
-                            }
-                            Ok(())
-                        })
+                            self.handle_upstream_gate(sequence, gate, &mut queued_measurements)
+                        }
+                        PipelinedGatestreamDown::GateBatch(gates) => self
+                            .handle_upstream_gate_batch(sequence, gates, &mut queued_measurements),
+                        PipelinedGatestreamDown::Advance(cycles) => {
+                            self.handle_upstream_advance(cycles)
+                        }
+                        PipelinedGatestreamDown::TimedGate(cycles, gate) => {
+                            self.handle_upstream_advance(cycles).and_then(|_| {
+                                self.handle_upstream_gate(sequence, gate, &mut queued_measurements)
+                            })
+                        }
+                        PipelinedGatestreamDown::TimedGateBatch(cycles, gates) => {
+                            self.handle_upstream_advance(cycles).and_then(|_| {
+                                self.handle_upstream_gate_batch(
+                                    sequence,
+                                    gates,
+                                    &mut queued_measurements,
+                                )
+                            })
                         }
-                        PipelinedGatestreamDown::Advance(cycles) => self
-                            .connection
-                            .send(OutgoingMessage::Upstream(GatestreamUp::Advanced(cycles)))
-                            .and_then(|_| (self.definition.advance)(self, cycles)),
                     };
 
                     // Propagate errors.
@@ -736,8 +1268,12 @@ impl<'a> PluginState<'a> {
 
                     // Operators need to wait for any downstream requests made
                     // by user code to be acknowledged before forwarding the
-                    // acknowledgement upstream.
+                    // acknowledgement upstream. That includes advancements
+                    // that are still pending, so those are flushed here;
+                    // coalescing them with later gates would delay the
+                    // acknowledgement indefinitely.
                     if self.definition.get_type() == PluginType::Operator {
+                        self.flush_downstream_advance()?;
                         let back_sequence = self.downstream_sequence_tx.get_previous();
                         self.upstream_postponed.push_back((
                             back_sequence,
@@ -750,11 +1286,7 @@ impl<'a> PluginState<'a> {
                             sequence
                         );
                     } else {
-                        for measurement in queued_measurements {
-                            self.connection.send(OutgoingMessage::Upstream(
-                                GatestreamUp::Measured(measurement),
-                            ))?;
-                        }
+                        self.send_measurements_upstream(queued_measurements)?;
                     }
 
                     // Changing upstream_issued_up_to and/or upstream_postponed
@@ -768,7 +1300,9 @@ impl<'a> PluginState<'a> {
                     }
                     self.synchronized_to_rpcs = true;
 
-                    let response = match (self.definition.upstream_arb)(self, cmd) {
+                    let response = match self.traced("upstream_arb", |state| {
+                        (state.definition.upstream_arb)(state, cmd)
+                    }) {
                         Ok(r) => GatestreamUp::ArbSuccess(r),
                         Err(e) => GatestreamUp::ArbFailure(e.to_string()),
                     };
@@ -811,7 +1345,17 @@ impl<'a> PluginState<'a> {
             .map(RandomNumberGenerator::get_selected)
             .unwrap_or(0);
         trace!("Syncing up to {}", num);
+        let start = if num.after(self.downstream_sequence_rx) {
+            Some(Instant::now())
+        } else {
+            None
+        };
         let result = self._synchronize_downstream_up_to(num);
+        if let Some(start) = start {
+            let elapsed = start.elapsed();
+            self.connection.stats_mut().sync_blocked.record(elapsed);
+            self.trace_span("downstream sync", start, elapsed);
+        }
         trace!("Synced up to {}", num);
         if let Some(ref mut rng) = self.rng {
             rng.select(rng_index);
@@ -823,6 +1367,7 @@ impl<'a> PluginState<'a> {
     /// Blockingly receive messages from downstream until all requests have
     /// been acknowledged.
     fn synchronize_downstream(&mut self) -> Result<()> {
+        self.flush_downstream_advance()?;
         self.synchronize_downstream_up_to(self.downstream_sequence_tx.get_previous())
     }
 
@@ -833,50 +1378,111 @@ impl<'a> PluginState<'a> {
         qubits: impl IntoIterator<Item = &'c QubitRef>,
     ) -> Result<()> {
         for qubit in qubits {
-            if !self.downstream_qubit_data.contains_key(qubit) {
+            if !self.downstream_qubit_data.contains(*qubit) {
                 inv_arg(format!("qubit {} is not allocated", qubit))?;
             }
         }
         Ok(())
     }
 
+    /// Calls the `initialize()` callback of the fused backend, if any. The
+    /// initialization commands from the host go to the stand-in backend, so
+    /// the fused backend is initialized without any.
+    fn fused_initialize(&mut self) -> Result<()> {
+        if let Some(backend) = self.fused.as_deref_mut() {
+            (backend.definition.initialize)(backend, vec![])?;
+        }
+        Ok(())
+    }
+
+    /// Executes a gate by calling the `gate()` callback of the fused backend,
+    /// and processes the returned measurements as if they were received from
+    /// downstream. Must only be called when a backend is fused into us.
+    fn fused_gate(&mut self, gate: Gate) -> Result<()> {
+        let mut measures: HashSet<_> = gate.get_measures().iter().cloned().collect();
+        let backend = self.fused.as_deref_mut().unwrap();
+        let start = Instant::now();
+        let measurements = (backend.definition.gate)(backend, gate);
+        let elapsed = start.elapsed();
+        let stats = self.connection.stats_mut();
+        stats.gates_sent += 1;
+        stats.gate_callback.record(elapsed);
+        self.trace_span("gate", start, elapsed);
+        for measurement in measurements? {
+            if !measures.remove(&measurement.qubit) {
+                err(format!(
+                    "user-defined gate() function returned multiple measurements for qubit {}",
+                    measurement.qubit
+                ))?;
+            }
+            self.cache_measurement(&measurement);
+        }
+        if !measures.is_empty() {
+            err(format!(
+                "user-defined gate() function failed to return measurement for qubits {}",
+                friendly_enumerate(measures.into_iter(), Some("or"))
+            ))?;
+        }
+        Ok(())
+    }
+
     // Note that the functions above are intentionally NOT public. Only
     // PluginState and we ourselves need to access it, and they're in the
     // same module so this is allowed. Also tests of course, which are in a
     // child module, which also makes it legal. The functions below this point
     // are API calls for the user logic.
 
-    /// Executes a plugin described by `definition` within the context of the
-    /// specified simulator endpoint address.
-    pub fn run(definition: &'a PluginDefinition, simulator: impl Into<String>) -> Result<()> {
-        let mut state = PluginState {
+    /// Constructs the state for a plugin described by `definition` that
+    /// communicates through the given connection.
+    fn new(definition: &'a PluginDefinition, connection: Connection) -> PluginState<'a> {
+        PluginState {
             definition,
-            connection: Connection::new(simulator)?,
+            connection,
             inside_run: false,
             synchronized_to_rpcs: true,
             frontend_to_host_data: VecDeque::new(),
             host_to_frontend_data: VecDeque::new(),
+            outcomes: OutcomeHistogram::default(),
             rng: None,
             downstream_qubit_ref_generator: QubitRefGenerator::new(),
             downstream_sequence_tx: SequenceNumberGenerator::new(),
             downstream_sequence_rx: SequenceNumber::none(),
+            downstream_window: 0,
             downstream_cycle_tx: Cycle::t_zero(),
+            downstream_pending_advance: 0,
             downstream_cycle_rx: Cycle::t_zero(),
             upstream_qubit_ref_generator: QubitRefGenerator::new(),
             upstream_issued_up_to: SequenceNumber::none(),
             upstream_postponed: VecDeque::new(),
             upstream_completed_up_to: SequenceNumber::none(),
-            downstream_qubit_data: HashMap::new(),
+            downstream_qubit_data: QubitTable::default(),
             downstream_measurement_queue: VecDeque::new(),
             downstream_expected_measurements: VecDeque::new(),
+            measurement_future_counter: 0,
+            measurement_futures: HashMap::new(),
+            pending_measurements: HashMap::new(),
+            measurement_continuations: HashMap::new(),
+            ready_continuations: VecDeque::new(),
             aborted: false,
-        };
+            tracer: None,
+            downstream_capture: None,
+            fused: None,
+        }
+    }
+
+    /// Executes a plugin described by `definition` within the context of the
+    /// specified simulator endpoint address.
+    pub fn run(definition: &'a PluginDefinition, simulator: impl Into<String>) -> Result<()> {
+        let mut state = PluginState::new(definition, Connection::new(simulator)?);
 
         while let Some(request) = state.connection.next_request()? {
             if state.handle_incoming_message(request)? {
                 break;
             }
         }
+
+        // Ship whatever was logged after the final response.
+        flush();
         Ok(())
     }
 
@@ -892,6 +1498,49 @@ impl<'a> PluginState<'a> {
         Ok(())
     }
 
+    /// Records a measurement outcome in the histogram that the host can read
+    /// back after the run.
+    ///
+    /// The outcome is a bitstring of up to 64 bits, usually the result of
+    /// one shot. Recorded outcomes are sent to the host along with the next
+    /// response to a run request, so this is much cheaper than sending an
+    /// `ArbData` per shot. Only frontends can record outcomes.
+    pub fn record_outcome(&mut self, outcome: u64) -> Result<()> {
+        if self.definition.get_type() != PluginType::Frontend {
+            inv_op("record_outcome() is only available for frontends")?;
+        }
+        self.outcomes.record(outcome);
+        Ok(())
+    }
+
+    /// Records the latest measurement results of the given qubits as an
+    /// outcome, with bit i representing the i-th qubit, and returns the
+    /// recorded outcome.
+    ///
+    /// This waits for the measurement results like `get_measurement()`. At
+    /// most 64 qubits can be specified, and their latest measurement must
+    /// not be undefined.
+    pub fn record_measurements(&mut self, qubits: &[QubitRef]) -> Result<u64> {
+        if self.definition.get_type() != PluginType::Frontend {
+            inv_op("record_measurements() is only available for frontends")?;
+        }
+        if qubits.len() > 64 {
+            inv_arg("cannot record more than 64 qubits in a single outcome")?;
+        }
+        let mut outcome = 0;
+        for (index, qubit) in qubits.iter().enumerate() {
+            match self.get_measurement(*qubit)?.value {
+                QubitMeasurementValue::Zero => (),
+                QubitMeasurementValue::One => outcome |= 1 << index,
+                QubitMeasurementValue::Undefined => {
+                    inv_arg(format!("measurement of qubit {} is undefined", qubit))?
+                }
+            }
+        }
+        self.outcomes.record(outcome);
+        Ok(outcome)
+    }
+
     /// Waits for a message from the host.
     ///
     /// It is only legal to call this function from within the `run()`
@@ -914,6 +1563,7 @@ impl<'a> PluginState<'a> {
                     FrontendRunResponse {
                         return_value: None,
                         messages: self.frontend_to_host_data.drain(..).collect(),
+                        outcomes: self.outcomes.take(),
                     },
                 )))
                 .unwrap();
@@ -975,21 +1625,24 @@ impl<'a> PluginState<'a> {
 
         // Allocate classical storage for the new qubits.
         for qubit in qubits.iter().cloned() {
-            self.downstream_qubit_data.insert(
-                qubit,
-                QubitData {
-                    measurement: None,
-                    last_mutation: SequenceNumber::none(),
-                },
-            );
+            self.downstream_qubit_data.insert(qubit);
         }
 
-        // Send the allocate message.
-        self.connection
-            .send(OutgoingMessage::Downstream(GatestreamDown::Pipelined(
-                self.downstream_sequence_tx.get_next(),
-                PipelinedGatestreamDown::Allocate(num_qubits, commands),
-            )))?;
+        // Send the allocate message, or have the fused backend allocate the
+        // qubits directly.
+        if self.fused.is_some() {
+            self.capture_fused(|| {
+                GatestreamDown::Pipelined(
+                    SequenceNumber::none(),
+                    PipelinedGatestreamDown::Allocate(num_qubits, commands.clone()),
+                )
+            })?;
+            let backend = self.fused.as_deref_mut().unwrap();
+            let qubits = backend.upstream_qubit_ref_generator.allocate(num_qubits);
+            (backend.definition.allocate)(backend, qubits, commands)?;
+        } else {
+            self.send_downstream(PipelinedGatestreamDown::Allocate(num_qubits, commands))?;
+        }
 
         // Return the references to the qubits.
         Ok(qubits)
@@ -1007,16 +1660,25 @@ impl<'a> PluginState<'a> {
         }
         self.check_qubits_live(qubits.iter())?;
 
-        // Send the free message.
-        self.connection
-            .send(OutgoingMessage::Downstream(GatestreamDown::Pipelined(
-                self.downstream_sequence_tx.get_next(),
-                PipelinedGatestreamDown::Free(qubits.clone()),
-            )))?;
+        // Send the free message, or have the fused backend free the qubits
+        // directly.
+        if self.fused.is_some() {
+            self.capture_fused(|| {
+                GatestreamDown::Pipelined(
+                    SequenceNumber::none(),
+                    PipelinedGatestreamDown::Free(qubits.clone()),
+                )
+            })?;
+            let backend = self.fused.as_deref_mut().unwrap();
+            backend.upstream_qubit_ref_generator.free(qubits.clone());
+            (backend.definition.free)(backend, qubits.clone())?;
+        } else {
+            self.send_downstream(PipelinedGatestreamDown::Free(qubits.clone()))?;
+        }
 
         // Kill our classical storage for the qubits.
         for qubit in qubits.iter() {
-            self.downstream_qubit_data.remove(qubit);
+            self.downstream_qubit_data.remove(*qubit);
         }
 
         // Keep the qubit ref generator in sync.
@@ -1039,23 +1701,29 @@ impl<'a> PluginState<'a> {
         self.check_qubits_live(gate.get_controls())?;
         self.check_qubits_live(gate.get_measures())?;
 
+        // A fused backend executes the gate right away, so there is no
+        // sequence number or expected measurement bookkeeping to do.
+        if self.fused.is_some() {
+            self.capture_fused(|| {
+                GatestreamDown::Pipelined(
+                    SequenceNumber::none(),
+                    PipelinedGatestreamDown::Gate(gate.clone()),
+                )
+            })?;
+            return self.fused_gate(gate);
+        }
+
         // Store which qubits we're expecting to be measured.
         let measures: HashSet<_> = gate.get_measures().iter().cloned().collect();
 
         // Send the gate message.
-        self.connection
-            .send(OutgoingMessage::Downstream(GatestreamDown::Pipelined(
-                self.downstream_sequence_tx.get_next(),
-                PipelinedGatestreamDown::Gate(gate),
-            )))?;
-        let sequence = self.downstream_sequence_tx.get_previous();
+        let sequence = self.send_downstream(PipelinedGatestreamDown::Gate(gate))?;
+        self.connection.stats_mut().gates_sent += 1;
 
         // Update the last-mutation sequence number for the measured qubits.
         for measure in measures.iter() {
             self.downstream_qubit_data
-                .get_mut(measure)
-                .unwrap()
-                .last_mutation = sequence;
+                .set_last_mutation(*measure, sequence);
         }
 
         // Store which measurements we're expecting.
@@ -1067,6 +1735,72 @@ impl<'a> PluginState<'a> {
         Ok(())
     }
 
+    /// Tells the downstream plugin to execute a sequence of gates.
+    ///
+    /// This is equivalent to calling `gate()` for each gate in order, but all
+    /// gates are validated before anything is sent, and the batch is sent
+    /// downstream as a single message with a single sequence number. If any
+    /// of the gates is invalid, none of them are sent.
+    ///
+    /// Backend plugins are not allowed to call this. Doing so will result in
+    /// an `Err` return value.
+    pub fn gate_batch(&mut self, gates: Vec<Gate>) -> Result<()> {
+        if self.definition.get_type() == PluginType::Backend {
+            return inv_op("gate_batch() is not available for backends")?;
+        } else if !self.synchronized_to_rpcs {
+            return inv_op("gate_batch() cannot be called while handling a gatestream response")?;
+        }
+        if gates.is_empty() {
+            return Ok(());
+        }
+        for gate in gates.iter() {
+            self.check_qubits_live(gate.get_targets())?;
+            self.check_qubits_live(gate.get_controls())?;
+            self.check_qubits_live(gate.get_measures())?;
+        }
+
+        // A fused backend executes the gates one by one.
+        if self.fused.is_some() {
+            self.capture_fused(|| {
+                GatestreamDown::Pipelined(
+                    SequenceNumber::none(),
+                    PipelinedGatestreamDown::GateBatch(gates.clone()),
+                )
+            })?;
+            for gate in gates {
+                self.fused_gate(gate)?;
+            }
+            return Ok(());
+        }
+
+        // Store which qubits we're expecting to be measured, per gate.
+        let measures: Vec<HashSet<_>> = gates
+            .iter()
+            .filter(|gate| !gate.get_measures().is_empty())
+            .map(|gate| gate.get_measures().iter().cloned().collect())
+            .collect();
+
+        // Send the gates in a single message.
+        let num_gates = gates.len() as u64;
+        let sequence = self.send_downstream(PipelinedGatestreamDown::GateBatch(gates))?;
+        self.connection.stats_mut().gates_sent += num_gates;
+
+        // Update the last-mutation sequence numbers and store which
+        // measurements we're expecting. Each gate gets its own entry in the
+        // expected measurement queue, since the same qubit may be measured
+        // more than once within a batch.
+        for gate_measures in measures {
+            for measure in gate_measures.iter() {
+                self.downstream_qubit_data
+                    .set_last_mutation(*measure, sequence);
+            }
+            self.downstream_expected_measurements
+                .push_back((sequence, gate_measures));
+        }
+
+        Ok(())
+    }
+
     /// Returns the latest measurement of the given downstream qubit.
     ///
     /// Backend plugins are not allowed to call this. Doing so will result in
@@ -1082,20 +1816,19 @@ impl<'a> PluginState<'a> {
 
         // Check that we have data for the qubit, and synchronize up to its
         // last modification.
-        if let Some(last_mutation) = self
-            .downstream_qubit_data
-            .get(&qubit)
-            .map(|data| data.last_mutation)
-        {
+        if let Some(last_mutation) = self.downstream_qubit_data.last_mutation(qubit) {
             self.synchronize_downstream_up_to(last_mutation)?;
         } else {
             inv_arg(format!("qubit {} is not allocated", qubit))?;
         }
 
+        // Call the continuations of any measurement futures that were
+        // resolved while synchronizing.
+        self.call_measurement_continuations()?;
+
         // Get the data (possibly updated by `synchronize_downstream_up_to()`
         // and return it.
-        let data = &self.downstream_qubit_data[&qubit];
-        if let Some(measurement) = &data.measurement {
+        if let Some(measurement) = self.downstream_qubit_data.measurement(qubit) {
             Ok(QubitMeasurementResult::new(
                 qubit,
                 measurement.value,
@@ -1106,6 +1839,166 @@ impl<'a> PluginState<'a> {
         }
     }
 
+    /// Returns a future for the result of the latest measurement of the given
+    /// downstream qubit, without waiting for it to be received.
+    ///
+    /// The future refers to the most recent gate sent downstream that
+    /// measures the qubit. If the result of that gate has already been
+    /// received, the future is ready immediately. The future must be consumed
+    /// using `wait_measurement()`, `when_measurement_ready()`, or
+    /// `discard_measurement_future()`; until then, DQCsim keeps track of it.
+    ///
+    /// Backend plugins are not allowed to call this. Doing so will result in
+    /// an `Err` return value.
+    pub fn measurement_future(&mut self, qubit: QubitRef) -> Result<MeasurementFuture> {
+        if self.definition.get_type() == PluginType::Backend {
+            return inv_op("measurement futures are not available for backends");
+        }
+        if !self.downstream_qubit_data.contains(qubit) {
+            return inv_arg(format!("qubit {} is not allocated", qubit));
+        }
+
+        // Look for the latest gate that measures the qubit and for which we
+        // have not received the result yet.
+        let pending = self
+            .downstream_expected_measurements
+            .iter()
+            .rev()
+            .find(|(_, qubits)| qubits.contains(&qubit))
+            .map(|(sequence, _)| *sequence);
+        let state = if let Some(sequence) = pending {
+            MeasurementFutureState::Pending(sequence, qubit)
+        } else if let Some(measurement) = self.downstream_qubit_data.measurement(qubit) {
+            MeasurementFutureState::Ready(QubitMeasurementResult::new(
+                qubit,
+                measurement.value,
+                measurement.data.clone(),
+            ))
+        } else {
+            return inv_arg(format!("qubit {} has not been measured yet", qubit));
+        };
+
+        self.measurement_future_counter += 1;
+        let future = MeasurementFuture(self.measurement_future_counter);
+        if let MeasurementFutureState::Pending(sequence, qubit) = state {
+            self.pending_measurements
+                .entry((sequence, qubit))
+                .or_insert_with(Vec::new)
+                .push(future);
+        }
+        self.measurement_futures.insert(future, state);
+        Ok(future)
+    }
+
+    /// Returns whether the result of the given measurement future has been
+    /// received, without blocking.
+    ///
+    /// This only handles the responses that the downstream plugin has already
+    /// delivered to us. Whether a future is ready at a given point thus
+    /// depends on timing, so plugins that need to behave deterministically
+    /// should not base decisions on the return value. Continuations of
+    /// futures that have become ready are called before this returns.
+    pub fn measurement_ready(&mut self, future: MeasurementFuture) -> Result<bool> {
+        if !self.synchronized_to_rpcs {
+            return inv_op(
+                "measurement_ready() cannot be called while handling a gatestream response",
+            );
+        } else if !self.measurement_futures.contains_key(&future) {
+            return inv_arg(format!("measurement future {} does not exist", future.0));
+        }
+        self.receive_downstream()?;
+        self.call_measurement_continuations()?;
+        Ok(matches!(
+            self.measurement_futures.get(&future),
+            Some(MeasurementFutureState::Ready(_))
+        ))
+    }
+
+    /// Waits for the result of the given measurement future and returns it,
+    /// consuming the future.
+    ///
+    /// This only synchronizes with the downstream plugin up to the gate that
+    /// does the measurement. Continuations of futures that have become ready
+    /// are called before this returns.
+    pub fn wait_measurement(
+        &mut self,
+        future: MeasurementFuture,
+    ) -> Result<QubitMeasurementResult> {
+        if !self.synchronized_to_rpcs {
+            return inv_op(
+                "wait_measurement() cannot be called while handling a gatestream response",
+            );
+        }
+        let sequence = match self.measurement_futures.get(&future) {
+            Some(MeasurementFutureState::Pending(sequence, _)) => Some(*sequence),
+            Some(MeasurementFutureState::Ready(_)) => None,
+            None => return inv_arg(format!("measurement future {} does not exist", future.0)),
+        };
+        if let Some(sequence) = sequence {
+            self.synchronize_downstream_up_to(sequence)?;
+        }
+        let state = self.measurement_futures.remove(&future).unwrap();
+        self.call_measurement_continuations()?;
+        match state {
+            MeasurementFutureState::Ready(measurement) => Ok(measurement),
+            MeasurementFutureState::Pending(_, qubit) => err(format!(
+                "the measurement result for qubit {} was never received",
+                qubit
+            )),
+        }
+    }
+
+    /// Registers a function to be called with the result of the given
+    /// measurement future, consuming the future.
+    ///
+    /// If the result has already been received, the function is called
+    /// immediately. Otherwise, it is called from within the first call to
+    /// `measurement_ready()`, `wait_measurement()`, or `get_measurement()`
+    /// after the result is received. This allows independent gates to be
+    /// issued while the measurement is in flight. Continuations that are
+    /// still pending when the plugin is finalized are never called.
+    pub fn when_measurement_ready(
+        &mut self,
+        future: MeasurementFuture,
+        continuation: MeasurementContinuation,
+    ) -> Result<()> {
+        if !self.synchronized_to_rpcs {
+            return inv_op(
+                "when_measurement_ready() cannot be called while handling a gatestream response",
+            );
+        }
+        match self.measurement_futures.remove(&future) {
+            Some(MeasurementFutureState::Ready(measurement)) => continuation(self, measurement),
+            Some(MeasurementFutureState::Pending(..)) => {
+                self.measurement_continuations.insert(future, continuation);
+                Ok(())
+            }
+            None => inv_arg(format!("measurement future {} does not exist", future.0)),
+        }
+    }
+
+    /// Consumes the given measurement future without waiting for its result.
+    ///
+    /// This releases the bookkeeping associated with futures that turn out
+    /// not to be needed. The measurement itself is not affected; its result
+    /// is still available through `get_measurement()` once received.
+    pub fn discard_measurement_future(&mut self, future: MeasurementFuture) -> Result<()> {
+        match self.measurement_futures.remove(&future) {
+            Some(MeasurementFutureState::Pending(sequence, qubit)) => {
+                let key = (sequence, qubit);
+                if let Some(futures) = self.pending_measurements.get_mut(&key) {
+                    futures.retain(|f| *f != future);
+                    if futures.is_empty() {
+                        self.pending_measurements.remove(&key);
+                    }
+                }
+                Ok(())
+            }
+            Some(MeasurementFutureState::Ready(_)) => Ok(()),
+            None => inv_arg(format!("measurement future {} does not exist", future.0)),
+        }
+    }
+
     /// Returns the number of downstream cycles since the latest measurement
     /// of the given downstream qubit.
     ///
@@ -1122,11 +2015,7 @@ impl<'a> PluginState<'a> {
 
         // Check that we have data for the qubit, and synchronize up to its
         // last modification.
-        if let Some(last_mutation) = self
-            .downstream_qubit_data
-            .get(&qubit)
-            .map(|data| data.last_mutation)
-        {
+        if let Some(last_mutation) = self.downstream_qubit_data.last_mutation(qubit) {
             self.synchronize_downstream_up_to(last_mutation)?;
         } else {
             inv_arg(format!("qubit {} is not allocated", qubit))?;
@@ -1134,8 +2023,7 @@ impl<'a> PluginState<'a> {
 
         // Get the data (possibly updated by `synchronize_downstream_up_to()`
         // and return it.
-        let data = &self.downstream_qubit_data[&qubit];
-        if let Some(measurement) = &data.measurement {
+        if let Some(measurement) = self.downstream_qubit_data.measurement(qubit) {
             let delta = self.downstream_cycle_tx - measurement.timestamp;
             assert!(delta >= 0);
             Ok(delta as u64)
@@ -1158,11 +2046,7 @@ impl<'a> PluginState<'a> {
 
         // Check that we have data for the qubit, and synchronize up to its
         // last modification.
-        if let Some(last_mutation) = self
-            .downstream_qubit_data
-            .get(&qubit)
-            .map(|data| data.last_mutation)
-        {
+        if let Some(last_mutation) = self.downstream_qubit_data.last_mutation(qubit) {
             self.synchronize_downstream_up_to(last_mutation)?;
         } else {
             inv_arg(format!("qubit {} is not allocated", qubit))?;
@@ -1170,8 +2054,7 @@ impl<'a> PluginState<'a> {
 
         // Get the data (possibly updated by `synchronize_downstream_up_to()`
         // and return it.
-        let data = &self.downstream_qubit_data[&qubit];
-        if let Some(measurement) = &data.measurement {
+        if let Some(measurement) = self.downstream_qubit_data.measurement(qubit) {
             if let Some(timer) = measurement.timer {
                 Ok(timer)
             } else {
@@ -1184,6 +2067,12 @@ impl<'a> PluginState<'a> {
 
     /// Tells the downstream plugin to run for the specified number of cycles.
     ///
+    /// The advancement is not sent right away. Instead, consecutive
+    /// advancements are summed up and sent along with the next gate or other
+    /// request, or when the gatestream is synchronized. Downstream plugins
+    /// therefore see a single `advance()` callback for the total number of
+    /// cycles, followed by the gate.
+    ///
     /// Backend plugins are not allowed to call this. Doing so will result in
     /// an `Err` return value.
     pub fn advance(&mut self, cycles: Cycles) -> Result<Cycle> {
@@ -1196,12 +2085,22 @@ impl<'a> PluginState<'a> {
         // Advance our local counter.
         self.downstream_cycle_tx = self.downstream_cycle_tx.advance(cycles);
 
-        // Send the advance message.
-        self.connection
-            .send(OutgoingMessage::Downstream(GatestreamDown::Pipelined(
-                self.downstream_sequence_tx.get_next(),
-                PipelinedGatestreamDown::Advance(cycles),
-            )))?;
+        // Advance the fused backend directly, or postpone sending the
+        // advance message until something else needs to be sent, such that
+        // consecutive advancements are coalesced into a single message.
+        if self.fused.is_some() {
+            self.capture_fused(|| {
+                GatestreamDown::Pipelined(
+                    SequenceNumber::none(),
+                    PipelinedGatestreamDown::Advance(cycles),
+                )
+            })?;
+            self.downstream_cycle_rx = self.downstream_cycle_tx;
+            let backend = self.fused.as_deref_mut().unwrap();
+            (backend.definition.advance)(backend, cycles)?;
+        } else {
+            self.downstream_pending_advance += cycles;
+        }
 
         // Return the current simulation time.
         Ok(self.downstream_cycle_tx)
@@ -1236,9 +2135,15 @@ impl<'a> PluginState<'a> {
         // requests to complete.
         self.synchronize_downstream()?;
 
+        // A fused backend handles the command directly.
+        if self.fused.is_some() {
+            self.capture_fused(|| GatestreamDown::ArbRequest(cmd.clone()))?;
+            let backend = self.fused.as_deref_mut().unwrap();
+            return (backend.definition.upstream_arb)(backend, cmd);
+        }
+
         // Send the command.
-        self.connection
-            .send(OutgoingMessage::Downstream(GatestreamDown::ArbRequest(cmd)))?;
+        self.send_downstream_message(GatestreamDown::ArbRequest(cmd))?;
 
         // The next downstream response must either be ArbFailure for an error
         // or ArbSuccess for success. Any other message is a protocol error.
@@ -1280,4 +2185,28 @@ impl<'a> PluginState<'a> {
     pub fn random_f64(&mut self) -> f64 {
         self.rng.as_mut().expect("RNG not initialized").random_f64()
     }
+
+    /// Fills the given slice with random unsigned 64-bit numbers using the
+    /// simulator random seed.
+    ///
+    /// This is equivalent to calling `random_u64()` once for every element,
+    /// and uses the same pseudorandom number generator state.
+    pub fn random_fill_u64(&mut self, dest: &mut [u64]) {
+        self.rng
+            .as_mut()
+            .expect("RNG not initialized")
+            .fill_u64(dest)
+    }
+
+    /// Fills the given slice with random floating point numbers in the range
+    /// `[0,1>` using the simulator random seed.
+    ///
+    /// This is equivalent to calling `random_f64()` once for every element,
+    /// and uses the same pseudorandom number generator state.
+    pub fn random_fill_f64(&mut self, dest: &mut [f64]) {
+        self.rng
+            .as_mut()
+            .expect("RNG not initialized")
+            .fill_f64(dest)
+    }
 }
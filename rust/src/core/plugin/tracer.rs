@@ -0,0 +1,156 @@
+//! Timeline recording for plugins.
+//!
+//! When the host enables tracing, each plugin records the spans of time it
+//! spends in its callbacks and the round trips of its downstream gatestream
+//! requests into a `Tracer`. The host collects the recorded events through a
+//! `SimulatorToPlugin::TraceRequest` at the end of the simulation, and merges
+//! the events of all plugins into a single timeline.
+
+use crate::common::{
+    log::{_ref_thread_local::RefThreadLocal, PID, TID},
+    types::{SequenceNumber, TraceEvent, TraceEventKind},
+};
+use std::{
+    borrow::Cow,
+    collections::VecDeque,
+    time::{Duration, Instant, SystemTime, UNIX_EPOCH},
+};
+
+/// Converts a duration to nanoseconds.
+fn nanos(duration: Duration) -> u64 {
+    duration.as_secs() * 1_000_000_000 + u64::from(duration.subsec_nanos())
+}
+
+/// Records timeline events for a single plugin.
+#[derive(Debug)]
+pub struct Tracer {
+    /// Reference point for converting `Instant`s to wall-clock time. Spans
+    /// are measured with the monotonic clock, but stored relative to the UNIX
+    /// epoch, such that the events of different processes line up.
+    epoch: Instant,
+
+    /// Wall-clock time corresponding to `epoch`, in nanoseconds since the
+    /// UNIX epoch.
+    epoch_ns: u64,
+
+    /// Process ID to record in the events.
+    pid: u32,
+
+    /// Thread ID to record in the events.
+    tid: u64,
+
+    /// The events recorded so far.
+    events: Vec<TraceEvent>,
+
+    /// Downstream requests that have not been acknowledged yet, along with
+    /// the time at which they were sent.
+    pending: VecDeque<(SequenceNumber, Instant)>,
+}
+
+impl Tracer {
+    /// Constructs a new tracer for the calling thread.
+    pub fn new() -> Tracer {
+        let epoch = Instant::now();
+        let epoch_ns = SystemTime::now()
+            .duration_since(UNIX_EPOCH)
+            .map(nanos)
+            .unwrap_or(0);
+        Tracer {
+            epoch,
+            epoch_ns,
+            pid: *PID,
+            tid: *TID.borrow(),
+            events: vec![],
+            pending: VecDeque::new(),
+        }
+    }
+
+    /// Records an event that started at the given point in time and took the
+    /// given amount of time.
+    fn record(
+        &mut self,
+        name: &'static str,
+        kind: TraceEventKind,
+        start: Instant,
+        duration: Duration,
+    ) {
+        let start = self.epoch_ns + nanos(start.saturating_duration_since(self.epoch));
+        self.events.push(TraceEvent {
+            name: Cow::Borrowed(name),
+            kind,
+            start,
+            duration: nanos(duration),
+            pid: self.pid,
+            tid: self.tid,
+        });
+    }
+
+    /// Records a callback or blocking operation that started at the given
+    /// point in time and took the given amount of time.
+    pub fn span(&mut self, name: &'static str, start: Instant, duration: Duration) {
+        self.record(name, TraceEventKind::Span, start, duration);
+    }
+
+    /// Records that the downstream request with the given sequence number
+    /// was just sent.
+    pub fn request_sent(&mut self, sequence: SequenceNumber) {
+        self.pending.push_back((sequence, Instant::now()));
+    }
+
+    /// Records that the downstream plugin acknowledged all requests up to
+    /// and including the given sequence number.
+    pub fn requests_completed(&mut self, sequence: SequenceNumber) {
+        let now = Instant::now();
+        while let Some(&(pending, start)) = self.pending.front() {
+            if !sequence.acknowledges(pending) {
+                break;
+            }
+            self.pending.pop_front();
+            self.record(
+                "round trip",
+                TraceEventKind::RoundTrip(pending),
+                start,
+                now.saturating_duration_since(start),
+            );
+        }
+    }
+
+    /// Takes the events recorded so far out of the tracer.
+    pub fn take_events(&mut self) -> Vec<TraceEvent> {
+        std::mem::replace(&mut self.events, vec![])
+    }
+}
+
+impl Default for Tracer {
+    fn default() -> Tracer {
+        Tracer::new()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::common::types::SequenceNumberGenerator;
+
+    #[test]
+    fn round_trips() {
+        let mut tracer = Tracer::new();
+        let mut sequence = SequenceNumberGenerator::new();
+        let a = sequence.get_next();
+        tracer.request_sent(a);
+        let b = sequence.get_next();
+        tracer.request_sent(b);
+        tracer.span("gate", Instant::now(), Duration::from_micros(3));
+        tracer.requests_completed(a);
+        tracer.requests_completed(b);
+        let events = tracer.take_events();
+        assert_eq!(events.len(), 3);
+        assert_eq!(events[0].name, "gate");
+        assert_eq!(events[0].kind, TraceEventKind::Span);
+        assert_eq!(events[0].duration, 3000);
+        assert_eq!(events[1].kind, TraceEventKind::RoundTrip(a));
+        assert_eq!(events[2].kind, TraceEventKind::RoundTrip(b));
+        assert!(events[1].start <= events[2].start);
+        assert!(tracer.take_events().is_empty());
+    }
+}
@@ -10,13 +10,14 @@ use dqcsim::{
     host::{
         accelerator::Accelerator,
         configuration::{
-            PluginLogConfiguration, PluginThreadConfiguration, Seed, SimulatorConfiguration,
+            GatestreamTransport, PluginLogConfiguration, PluginThreadConfiguration,
+            ReceiveStrategy, Seed, SimulatorConfiguration,
         },
         plugin::Plugin,
         simulation::Simulation,
         simulator::Simulator,
     },
-    plugin::definition::PluginDefinition,
+    plugin::{definition::PluginDefinition, fusion::fusion_operator, replay::replay_frontend},
 };
 use num_complex::Complex64;
 use std::{
@@ -265,6 +266,56 @@ fn send_recv_accelerator() {
     assert!(res.is_ok());
 }
 
+#[test]
+// This tests driving the accelerator without blocking the host.
+fn async_yield() {
+    let (mut frontend, _, backend) = fe_op_be();
+
+    frontend.run = Box::new(|state, _| {
+        let msg = state.recv()?;
+        state.send(msg)?;
+        Ok(ArbData::default())
+    });
+
+    let ptc = |definition| {
+        PluginThreadConfiguration::new(
+            definition,
+            PluginLogConfiguration::new("", LoglevelFilter::Off),
+        )
+    };
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(ptc(frontend))
+        .with_plugin(ptc(backend));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    let simulation = &mut simulator.simulation;
+    assert!(simulation.poll_yield().unwrap());
+
+    simulation.start(ArbData::default()).unwrap();
+    simulation.send(ArbData::default()).unwrap();
+    assert!(!simulation.is_recv_ready());
+    assert!(!simulation.is_wait_ready());
+
+    simulation.yield_async().unwrap();
+    while !simulation.poll_yield().unwrap() {
+        std::thread::yield_now();
+    }
+    assert!(simulation.is_recv_ready());
+    assert!(simulation.is_wait_ready());
+    assert_eq!(simulation.recv().unwrap(), ArbData::default());
+    assert_eq!(simulation.wait().unwrap(), ArbData::default());
+
+    // Blocking calls complete a pending asynchronous yield first.
+    simulation.start(ArbData::default()).unwrap();
+    simulation.send(ArbData::default()).unwrap();
+    simulation.yield_async().unwrap();
+    assert_eq!(simulation.recv().unwrap(), ArbData::default());
+    assert_eq!(simulation.wait().unwrap(), ArbData::default());
+}
+
 #[test]
 // This tests basic plugin arb command propagation.
 fn plugin_user_init_fail() {
@@ -531,7 +582,7 @@ fn bad_simulation_pipeline_too_short() {
         .map(|plugin| plugin.instantiate())
         .collect();
 
-    let simulation = Simulation::new(pipeline, Seed::default(), None, &log_thread);
+    let simulation = Simulation::new(pipeline, Seed::default(), None, &log_thread, false);
     assert!(simulation.is_err());
     assert_eq!(
         simulation.unwrap_err().to_string(),
@@ -563,7 +614,7 @@ fn bad_simulation_pipeline_fe_op_only() {
         .map(|plugin| plugin.instantiate())
         .collect();
 
-    let simulation = Simulation::new(pipeline, Seed::default(), None, &log_thread);
+    let simulation = Simulation::new(pipeline, Seed::default(), None, &log_thread, false);
     assert!(simulation.is_err());
     assert_eq!(
         simulation.unwrap_err().to_string(),
@@ -595,7 +646,7 @@ fn bad_simulation_pipeline_be_op_only() {
         .map(|plugin| plugin.instantiate())
         .collect();
 
-    let simulation = Simulation::new(pipeline, Seed::default(), None, &log_thread);
+    let simulation = Simulation::new(pipeline, Seed::default(), None, &log_thread, false);
     assert!(simulation.is_err());
     assert_eq!(
         simulation.unwrap_err().to_string(),
@@ -1293,6 +1344,408 @@ fn host_arb_sync_with_gatestream() {
     assert_eq!(gates_executed, 10);
 }
 
+#[test]
+// This tests batched gate submission through an operator.
+fn gate_batch() {
+    let (mut frontend, operator, mut backend) = fe_op_be();
+
+    frontend.run = Box::new(|state, _| {
+        let qubits = state.allocate(2, vec![]).unwrap();
+        let x = Gate::new_unitary(
+            vec![qubits[0]],
+            vec![],
+            vec![
+                Complex64::new(0.0, 0.0),
+                Complex64::new(1.0, 0.0),
+                Complex64::new(1.0, 0.0),
+                Complex64::new(0.0, 0.0),
+            ],
+        )
+        .unwrap();
+        let measure = |q: QubitRef| Gate::new_measurement(vec![q], Matrix::new_identity(2));
+
+        // Empty batches are no-ops.
+        state.gate_batch(vec![]).unwrap();
+
+        // Batches referring to a dead qubit are rejected as a whole.
+        let res = state.gate_batch(vec![
+            x.clone(),
+            Gate::new_measurement(
+                vec![QubitRef::from_foreign(3).unwrap()],
+                Matrix::new_identity(2),
+            )
+            .unwrap(),
+        ]);
+        assert!(res.is_err());
+
+        state
+            .gate_batch(vec![
+                measure(qubits[0]).unwrap(),
+                x.clone(),
+                measure(qubits[0]).unwrap(),
+                measure(qubits[1]).unwrap(),
+            ])
+            .unwrap();
+
+        assert_eq!(
+            state.get_measurement(qubits[0]).unwrap().value,
+            QubitMeasurementValue::One
+        );
+        assert_eq!(
+            state.get_measurement(qubits[1]).unwrap().value,
+            QubitMeasurementValue::Zero
+        );
+
+        Ok(ArbData::default())
+    });
+
+    let gates_executed = Arc::new(Mutex::new(Box::new(0u8)));
+    let flipped = Arc::new(Mutex::new(Box::new(false)));
+
+    let ge_gate = Arc::clone(&gates_executed);
+    backend.gate = Box::new(move |_, gate| {
+        let ge: &mut u8 = &mut ge_gate.lock().unwrap();
+        *ge += 1;
+        let flipped: &mut bool = &mut flipped.lock().unwrap();
+        if gate.get_measures().is_empty() {
+            *flipped = !*flipped;
+            Ok(vec![])
+        } else {
+            Ok(gate
+                .get_measures()
+                .iter()
+                .map(|q| {
+                    QubitMeasurementResult::new(
+                        *q,
+                        if *flipped && *q == QubitRef::from_foreign(1).unwrap() {
+                            QubitMeasurementValue::One
+                        } else {
+                            QubitMeasurementValue::Zero
+                        },
+                        ArbData::default(),
+                    )
+                })
+                .collect())
+        }
+    });
+
+    let ge_arb = Arc::clone(&gates_executed);
+    backend.host_arb = Box::new(move |_, _| {
+        let ge: &u8 = &ge_arb.lock().unwrap();
+        Ok(ArbData::from_args(vec![vec![*ge]]))
+    });
+
+    let ptc = |definition| {
+        PluginThreadConfiguration::new(
+            definition,
+            PluginLogConfiguration::new("", LoglevelFilter::Off),
+        )
+    };
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(ptc(frontend))
+        .with_plugin(ptc(operator))
+        .with_plugin(ptc(backend));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator.simulation.start(ArbData::default()).unwrap();
+    simulator.simulation.wait().unwrap();
+
+    let gates_executed = simulator
+        .simulation
+        .arb_idx(2, ArbCmd::new("a", "b", ArbData::default()))
+        .unwrap()
+        .get_args()[0][0];
+    assert_eq!(gates_executed, 4);
+}
+
+#[test]
+// This tests the shared-memory gatestream transport, using a small ring
+// buffer such that it fills up and large gates overflow.
+fn shared_memory_gatestream() {
+    let (mut frontend, operator, mut backend) = fe_op_be();
+
+    frontend.run = Box::new(|state, _| {
+        let qubits = state.allocate(2, vec![]).unwrap();
+        for i in 0..100 {
+            let gate = Gate::new_custom(
+                "x".repeat(i * 10),
+                vec![qubits[0]],
+                vec![],
+                vec![qubits[1]],
+                None::<Vec<Complex64>>,
+                ArbData::default(),
+            )
+            .unwrap();
+            state.gate(gate).unwrap();
+            assert_eq!(
+                state.get_measurement(qubits[1]).unwrap().value,
+                QubitMeasurementValue::One
+            );
+        }
+        Ok(ArbData::default())
+    });
+
+    let gates_executed = Arc::new(Mutex::new(Box::new(0u8)));
+
+    let ge_gate = Arc::clone(&gates_executed);
+    backend.gate = Box::new(move |_, gate| {
+        let ge: &mut u8 = &mut ge_gate.lock().unwrap();
+        *ge += 1;
+        Ok(gate
+            .get_measures()
+            .iter()
+            .map(|q| QubitMeasurementResult::new(*q, QubitMeasurementValue::One, ArbData::default()))
+            .collect())
+    });
+
+    let ge_arb = Arc::clone(&gates_executed);
+    backend.host_arb = Box::new(move |_, _| {
+        let ge: &u8 = &ge_arb.lock().unwrap();
+        Ok(ArbData::from_args(vec![vec![*ge]]))
+    });
+
+    let ptc = |definition| {
+        PluginThreadConfiguration::new(
+            definition,
+            PluginLogConfiguration::new("", LoglevelFilter::Off),
+        )
+        .with_downstream_transport(GatestreamTransport::SharedMemory(1024))
+    };
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(ptc(frontend))
+        .with_plugin(ptc(operator))
+        .with_plugin(ptc(backend));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator.simulation.start(ArbData::default()).unwrap();
+    simulator.simulation.wait().unwrap();
+
+    let gates_executed = simulator
+        .simulation
+        .arb_idx(2, ArbCmd::new("a", "b", ArbData::default()))
+        .unwrap()
+        .get_args()[0][0];
+    assert_eq!(gates_executed, 100);
+}
+
+#[test]
+// This tests a backend fused into its frontend, which executes the gates
+// synchronously from within the frontend's thread.
+fn fused_backend() {
+    let (mut frontend, _, mut backend) = fe_op_be();
+
+    frontend.run = Box::new(|state, _| {
+        let qubits = state.allocate(2, vec![]).unwrap();
+        let thread = std::thread::current().id();
+        for _ in 0..10 {
+            let gate = Gate::new_custom(
+                "x",
+                vec![qubits[0]],
+                vec![],
+                vec![qubits[1]],
+                None::<Vec<Complex64>>,
+                ArbData::default(),
+            )
+            .unwrap();
+            state.gate(gate).unwrap();
+            assert_eq!(
+                state.get_measurement(qubits[1]).unwrap().value,
+                QubitMeasurementValue::One
+            );
+        }
+        state.advance(5).unwrap();
+        let response = state
+            .arb(ArbCmd::new("a", "b", ArbData::default()))
+            .unwrap();
+        assert_eq!(response.get_args()[0][0], 10);
+        assert_eq!(std::thread::current().id(), thread);
+        state.free(qubits).unwrap();
+        Ok(ArbData::default())
+    });
+
+    let gates_executed = Arc::new(Mutex::new(Box::new(0u8)));
+
+    let ge_gate = Arc::clone(&gates_executed);
+    backend.gate = Box::new(move |_, gate| {
+        let ge: &mut u8 = &mut ge_gate.lock().unwrap();
+        *ge += 1;
+        Ok(gate
+            .get_measures()
+            .iter()
+            .map(|q| {
+                QubitMeasurementResult::new(*q, QubitMeasurementValue::One, ArbData::default())
+            })
+            .collect())
+    });
+
+    let ge_arb = Arc::clone(&gates_executed);
+    backend.upstream_arb = Box::new(move |_, _| {
+        let ge: &u8 = &ge_arb.lock().unwrap();
+        Ok(ArbData::from_args(vec![vec![*ge]]))
+    });
+
+    let stand_in = frontend.fuse(backend).unwrap();
+
+    let ptc = |definition| {
+        PluginThreadConfiguration::new(
+            definition,
+            PluginLogConfiguration::new("", LoglevelFilter::Off),
+        )
+    };
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(ptc(frontend))
+        .with_plugin(ptc(stand_in));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator.simulation.start(ArbData::default()).unwrap();
+    simulator.simulation.wait().unwrap();
+    assert_eq!(**gates_executed.lock().unwrap(), 10);
+
+    // Host arbs can't reach the fused backend.
+    assert!(simulator
+        .simulation
+        .arb_idx(1, ArbCmd::new("a", "b", ArbData::default()))
+        .is_err());
+}
+
+/// Returns a backend that records the requests it receives as strings.
+fn recording_backend(ops: Arc<Mutex<Vec<String>>>) -> PluginDefinition {
+    let (_, _, mut backend) = fe_op_be();
+    let o = Arc::clone(&ops);
+    backend.allocate = Box::new(move |_, qubits, cmds| {
+        o.lock()
+            .unwrap()
+            .push(format!("allocate {:?} {:?}", qubits, cmds));
+        Ok(())
+    });
+    let o = Arc::clone(&ops);
+    backend.free = Box::new(move |_, qubits| {
+        o.lock().unwrap().push(format!("free {:?}", qubits));
+        Ok(())
+    });
+    let o = Arc::clone(&ops);
+    backend.gate = Box::new(move |_, gate| {
+        let measures = gate.get_measures().to_vec();
+        o.lock().unwrap().push(format!("gate {:?}", gate));
+        Ok(measures
+            .into_iter()
+            .map(|q| QubitMeasurementResult::new(q, QubitMeasurementValue::One, ArbData::default()))
+            .collect())
+    });
+    let o = Arc::clone(&ops);
+    backend.advance = Box::new(move |_, cycles| {
+        o.lock().unwrap().push(format!("advance {}", cycles));
+        Ok(())
+    });
+    let o = ops;
+    backend.upstream_arb = Box::new(move |_, cmd| {
+        o.lock().unwrap().push(format!("arb {:?}", cmd));
+        Ok(ArbData::default())
+    });
+    backend
+}
+
+/// Runs a simulation consisting of the given frontend and the recording
+/// backend, optionally fused into the frontend, and returns what the backend
+/// received.
+fn record_gatestream(
+    mut frontend: PluginDefinition,
+    fused: bool,
+    capture: Option<&std::path::Path>,
+) -> Vec<String> {
+    let ops = Arc::new(Mutex::new(vec![]));
+    let mut backend = recording_backend(Arc::clone(&ops));
+    if fused {
+        backend = frontend.fuse(backend).unwrap();
+    }
+
+    let ptc = |definition| {
+        PluginThreadConfiguration::new(
+            definition,
+            PluginLogConfiguration::new("", LoglevelFilter::Off),
+        )
+    };
+    let mut front = ptc(frontend);
+    if let Some(capture) = capture {
+        front = front.with_downstream_capture(capture);
+    }
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(front)
+        .with_plugin(ptc(backend));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator.simulation.start(ArbData::default()).unwrap();
+    simulator.simulation.wait().unwrap();
+    drop(simulator);
+
+    let ops = ops.lock().unwrap();
+    ops.clone()
+}
+
+#[test]
+// This tests recording the gatestream sent by a frontend to a capture file,
+// and replaying it into a backend, both with a regular and with a fused
+// backend.
+fn capture_replay() {
+    for fused in [false, true].iter().cloned() {
+        let (mut frontend, _, _) = fe_op_be();
+        frontend.run = Box::new(|state, _| {
+            let qubits = state.allocate(2, vec![]).unwrap();
+            let x = |q: QubitRef| {
+                Gate::new_custom(
+                    "x",
+                    vec![q],
+                    vec![],
+                    vec![],
+                    None::<Vec<Complex64>>,
+                    ArbData::default(),
+                )
+                .unwrap()
+            };
+            state.gate(x(qubits[0])).unwrap();
+            state.advance(3).unwrap();
+            state.gate_batch(vec![x(qubits[1]), x(qubits[0])]).unwrap();
+            state
+                .gate(Gate::new_measurement(vec![qubits[1]], Matrix::new_identity(2)).unwrap())
+                .unwrap();
+            assert_eq!(
+                state.get_measurement(qubits[1]).unwrap().value,
+                QubitMeasurementValue::One
+            );
+            state
+                .arb(ArbCmd::new("a", "b", ArbData::default()))
+                .unwrap();
+            state.free(qubits).unwrap();
+            Ok(ArbData::default())
+        });
+
+        let file = std::env::temp_dir().join(format!(
+            "dqcsim-capture-replay-{}-{}.bin",
+            std::process::id(),
+            fused
+        ));
+        let recorded = record_gatestream(frontend, fused, Some(&file));
+        assert_eq!(recorded.len(), 8);
+
+        let replay = replay_frontend(PluginMetadata::new("replay", "dqcsim", "0.1.0"), &file);
+        let replayed = record_gatestream(replay, false, None);
+        std::fs::remove_file(&file).unwrap();
+        assert_eq!(replayed, recorded);
+    }
+}
+
 #[test]
 fn plugin_thread_panic() {
     let (mut frontend, _, backend) = fe_op_be();
@@ -1324,3 +1777,493 @@ fn plugin_thread_panic() {
     let wait = simulator.simulation.wait();
     assert!(wait.is_err());
 }
+
+#[test]
+// This tests the gate fusion operator.
+fn gate_fusion() {
+    let (mut frontend, _, mut backend) = fe_op_be();
+    let operator = fusion_operator(PluginMetadata::new("fusion", "dqcsim", "0.1.0"), false);
+
+    let x = || {
+        Matrix::new(vec![
+            Complex64::new(0.0, 0.0),
+            Complex64::new(1.0, 0.0),
+            Complex64::new(1.0, 0.0),
+            Complex64::new(0.0, 0.0),
+        ])
+        .unwrap()
+    };
+    let measure = |q: QubitRef| Gate::new_measurement(vec![q], Matrix::new_identity(2)).unwrap();
+
+    frontend.run = Box::new(move |state, _| {
+        let qubits = state.allocate(2, vec![]).unwrap();
+
+        // Three X gates on the first qubit should be fused into one.
+        for _ in 0..3 {
+            state
+                .gate(Gate::new_unitary(vec![qubits[0]], vec![], x()).unwrap())
+                .unwrap();
+        }
+
+        // A single gate should be forwarded as-is. Measurements forward the
+        // pending gates of the measured qubit first.
+        state
+            .gate(Gate::new_unitary(vec![qubits[1]], vec![], x()).unwrap())
+            .unwrap();
+        state.gate(measure(qubits[0])).unwrap();
+        state.gate(measure(qubits[1])).unwrap();
+
+        // Two CNOTs on the same qubits cancel out.
+        for _ in 0..2 {
+            state
+                .gate(Gate::new_unitary(vec![qubits[1]], vec![qubits[0]], x()).unwrap())
+                .unwrap();
+        }
+        state.free(qubits).unwrap();
+        Ok(ArbData::default())
+    });
+
+    let gates = Arc::new(Mutex::new(vec![]));
+    let backend_gates = Arc::clone(&gates);
+    backend.gate = Box::new(move |_, gate| {
+        let measures = gate.get_measures().to_vec();
+        backend_gates.lock().unwrap().push(gate);
+        Ok(measures
+            .into_iter()
+            .map(|q| QubitMeasurementResult::new(q, QubitMeasurementValue::One, ArbData::default()))
+            .collect())
+    });
+
+    let ptc = |definition| {
+        PluginThreadConfiguration::new(
+            definition,
+            PluginLogConfiguration::new("", LoglevelFilter::Off),
+        )
+    };
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(ptc(frontend))
+        .with_plugin(ptc(operator).with_init_cmd(ArbCmd::new(
+            "fusion",
+            "two_qubit",
+            ArbData::default(),
+        )))
+        .with_plugin(ptc(backend));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator.simulation.start(ArbData::default()).unwrap();
+    simulator.simulation.wait().unwrap();
+    drop(simulator);
+
+    let gates = gates.lock().unwrap();
+    let q1 = QubitRef::from_foreign(1).unwrap();
+    let q2 = QubitRef::from_foreign(2).unwrap();
+    assert_eq!(gates.len(), 4);
+    assert_eq!(gates[0].get_targets(), &[q1]);
+    assert!(gates[0]
+        .get_matrix()
+        .unwrap()
+        .approx_eq(&x(), 1.0e-9, false));
+    assert_eq!(gates[1].get_measures(), &[q1]);
+    assert_eq!(gates[2].get_targets(), &[q2]);
+    assert_eq!(gates[3].get_measures(), &[q2]);
+}
+
+#[test]
+// This tests that the gate fusion operator forwards the gates that are still
+// pending when the gatestream ends, in the order in which their runs started.
+fn gate_fusion_end_of_stream() {
+    let (mut frontend, _, mut backend) = fe_op_be();
+    let operator = fusion_operator(PluginMetadata::new("fusion", "dqcsim", "0.1.0"), false);
+
+    let x = || {
+        Matrix::new(vec![
+            Complex64::new(0.0, 0.0),
+            Complex64::new(1.0, 0.0),
+            Complex64::new(1.0, 0.0),
+            Complex64::new(0.0, 0.0),
+        ])
+        .unwrap()
+    };
+
+    // End on partial runs, without freeing the qubits. The runs are started
+    // in reverse qubit order.
+    frontend.run = Box::new(move |state, _| {
+        let qubits = state.allocate(16, vec![]).unwrap();
+        for _ in 0..3 {
+            for qubit in qubits.iter().rev() {
+                state
+                    .gate(Gate::new_unitary(vec![*qubit], vec![], x()).unwrap())
+                    .unwrap();
+            }
+        }
+        Ok(ArbData::default())
+    });
+
+    let gates = Arc::new(Mutex::new(vec![]));
+    let backend_gates = Arc::clone(&gates);
+    backend.gate = Box::new(move |_, gate| {
+        backend_gates.lock().unwrap().push(gate);
+        Ok(vec![])
+    });
+
+    let ptc = |definition| {
+        PluginThreadConfiguration::new(
+            definition,
+            PluginLogConfiguration::new("", LoglevelFilter::Off),
+        )
+    };
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(ptc(frontend))
+        .with_plugin(ptc(operator))
+        .with_plugin(ptc(backend));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator.simulation.start(ArbData::default()).unwrap();
+    simulator.simulation.wait().unwrap();
+    drop(simulator);
+
+    let gates = gates.lock().unwrap();
+    assert_eq!(gates.len(), 16);
+    for (index, gate) in gates.iter().enumerate() {
+        let qubit = QubitRef::from_foreign(16 - index as u64).unwrap();
+        assert_eq!(gate.get_targets(), &[qubit]);
+        assert!(gate.get_matrix().unwrap().approx_eq(&x(), 1.0e-9, false));
+    }
+}
+
+#[test]
+fn batched_measurements() {
+    let (mut frontend, mut operator, mut backend) = fe_op_be();
+
+    frontend.run = Box::new(|state, _| {
+        let qubits = state.allocate(100, vec![]).unwrap();
+        for _ in 0..2 {
+            state
+                .gate(Gate::new_measurement(qubits.clone(), Matrix::new_identity(2)).unwrap())
+                .unwrap();
+        }
+        for qubit in qubits {
+            if state.get_measurement(qubit)?.value != QubitMeasurementValue::Zero {
+                err("measurement was not modified")?;
+            }
+        }
+        Ok(ArbData::default())
+    });
+
+    // The operator sets all measurements to zero, keeping track of how many
+    // it got per call.
+    let batches = Arc::new(Mutex::new(vec![]));
+    let operator_batches = Arc::clone(&batches);
+    operator.modify_measurements = Some(Box::new(move |_, measurements| {
+        operator_batches.lock().unwrap().push(measurements.len());
+        Ok(measurements
+            .into_iter()
+            .map(|mut m| {
+                m.value = QubitMeasurementValue::Zero;
+                m
+            })
+            .collect())
+    }));
+
+    backend.gate = Box::new(|_, gate| {
+        Ok(gate
+            .get_measures()
+            .iter()
+            .map(|q| {
+                QubitMeasurementResult::new(*q, QubitMeasurementValue::One, ArbData::default())
+            })
+            .collect())
+    });
+
+    let ptc = |definition| {
+        PluginThreadConfiguration::new(
+            definition,
+            PluginLogConfiguration::new("", LoglevelFilter::Off),
+        )
+    };
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(ptc(frontend))
+        .with_plugin(ptc(operator))
+        .with_plugin(ptc(backend));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator.simulation.start(ArbData::default()).unwrap();
+    simulator.simulation.wait().unwrap();
+    drop(simulator);
+
+    // Each measurement gate should have resulted in a single batch.
+    let batches = batches.lock().unwrap();
+    assert_eq!(batches.iter().sum::<usize>(), 200);
+    assert!(batches.len() <= 2);
+}
+
+#[test]
+fn downstream_window() {
+    let (mut frontend, _, mut backend) = fe_op_be();
+
+    frontend.run = Box::new(|state, _| {
+        let qubits = state.allocate(1, vec![]).unwrap();
+        for _ in 0..50 {
+            state
+                .gate(Gate::new_unitary(qubits.clone(), vec![], Matrix::new_identity(2)).unwrap())
+                .unwrap();
+        }
+        Ok(ArbData::default())
+    });
+
+    // A backend that is much slower than the frontend.
+    let gates = Arc::new(Mutex::new(0));
+    let backend_gates = Arc::clone(&gates);
+    backend.gate = Box::new(move |_, _| {
+        std::thread::sleep(std::time::Duration::from_millis(1));
+        *backend_gates.lock().unwrap() += 1;
+        Ok(vec![])
+    });
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(
+            PluginThreadConfiguration::new(
+                frontend,
+                PluginLogConfiguration::new("front", LoglevelFilter::Off),
+            )
+            .with_downstream_window(4),
+        )
+        .with_plugin(PluginThreadConfiguration::new(
+            backend,
+            PluginLogConfiguration::new("back", LoglevelFilter::Off),
+        ));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator.simulation.start(ArbData::default()).unwrap();
+    simulator.simulation.wait().unwrap();
+
+    let stats = simulator.simulation.get_stats().unwrap();
+    let (name, frontend_stats) = &stats[0];
+    assert_eq!(name, "front");
+    assert!(frontend_stats.throttled.count() > 0);
+    assert!(frontend_stats.sync_blocked.count() >= frontend_stats.throttled.count());
+    drop(simulator);
+    assert_eq!(*gates.lock().unwrap(), 50);
+}
+
+#[test]
+// This tests that consecutive advancements are coalesced and sent along with
+// the next gate.
+fn coalesced_advance() {
+    let (mut frontend, _, mut backend) = fe_op_be();
+
+    frontend.run = Box::new(|state, _| {
+        let qubits = state.allocate(1, vec![]).unwrap();
+        for _ in 0..5 {
+            state.advance(1).unwrap();
+            state.advance(2).unwrap();
+            state
+                .gate(Gate::new_unitary(qubits.clone(), vec![], Matrix::new_identity(2)).unwrap())
+                .unwrap();
+        }
+        assert_eq!(state.advance(4).unwrap(), state.get_cycle().unwrap());
+        assert_eq!(Into::<u64>::into(state.get_cycle().unwrap()), 19);
+        Ok(ArbData::default())
+    });
+
+    let events = Arc::new(Mutex::new(vec![]));
+    let gate_events = Arc::clone(&events);
+    backend.gate = Box::new(move |_, _| {
+        gate_events.lock().unwrap().push(0);
+        Ok(vec![])
+    });
+    let advance_events = Arc::clone(&events);
+    backend.advance = Box::new(move |_, cycles| {
+        advance_events.lock().unwrap().push(cycles);
+        Ok(())
+    });
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(PluginThreadConfiguration::new(
+            frontend,
+            PluginLogConfiguration::new("front", LoglevelFilter::Off),
+        ))
+        .with_plugin(PluginThreadConfiguration::new(
+            backend,
+            PluginLogConfiguration::new("back", LoglevelFilter::Off),
+        ));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator.simulation.start(ArbData::default()).unwrap();
+    simulator.simulation.wait().unwrap();
+    drop(simulator);
+
+    assert_eq!(*events.lock().unwrap(), vec![3, 0, 3, 0, 3, 0, 3, 0, 3, 0, 4]);
+}
+
+#[test]
+// This tests polling for incoming messages before blocking, using a
+// measurement round trip for every gate.
+fn receive_strategy() {
+    let (mut frontend, _, mut backend) = fe_op_be();
+
+    frontend.run = Box::new(|state, _| {
+        let qubits = state.allocate(1, vec![]).unwrap();
+        for _ in 0..20 {
+            state
+                .gate(Gate::new_measurement(qubits.clone(), Matrix::new_identity(2)).unwrap())
+                .unwrap();
+            assert_eq!(
+                state.get_measurement(qubits[0]).unwrap().value,
+                QubitMeasurementValue::Zero
+            );
+        }
+        Ok(ArbData::default())
+    });
+
+    backend.gate = Box::new(|_, gate| {
+        Ok(gate
+            .get_measures()
+            .iter()
+            .map(|q| QubitMeasurementResult::new(*q, QubitMeasurementValue::Zero, ArbData::default()))
+            .collect())
+    });
+
+    let spin_time = std::time::Duration::from_millis(10);
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(
+            PluginThreadConfiguration::new(
+                frontend,
+                PluginLogConfiguration::new("front", LoglevelFilter::Off),
+            )
+            .with_receive_strategy(ReceiveStrategy::Spin(spin_time)),
+        )
+        .with_plugin(
+            PluginThreadConfiguration::new(
+                backend,
+                PluginLogConfiguration::new("back", LoglevelFilter::Off),
+            )
+            .with_receive_strategy(ReceiveStrategy::Yield(spin_time)),
+        );
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator.simulation.start(ArbData::default()).unwrap();
+    simulator.simulation.wait().unwrap();
+
+    let stats = simulator.simulation.get_stats().unwrap();
+    for (_, plugin_stats) in stats.iter() {
+        assert!(plugin_stats.spin_hits + plugin_stats.spin_misses > 0);
+    }
+}
+
+#[test]
+// This tests collecting measurement outcomes over multiple shots in a
+// histogram on the host.
+fn outcome_histogram() {
+    let (mut frontend, _, mut backend) = fe_op_be();
+
+    frontend.run = Box::new(|state, _| {
+        let qubits = state.allocate(2, vec![]).unwrap();
+        assert!(state.record_measurements(&qubits).is_err());
+        state
+            .gate(Gate::new_measurement(qubits.clone(), Matrix::new_identity(2)).unwrap())
+            .unwrap();
+        assert_eq!(state.record_measurements(&qubits).unwrap(), 1);
+        state.record_outcome(7).unwrap();
+        state.free(qubits).unwrap();
+        Ok(ArbData::default())
+    });
+
+    // The backend returns one for the first qubit and zero for the others.
+    backend.gate = Box::new(|_, gate| {
+        Ok(gate
+            .get_measures()
+            .iter()
+            .map(|q| {
+                let value = if *q == QubitRef::from_foreign(1).unwrap() {
+                    QubitMeasurementValue::One
+                } else {
+                    QubitMeasurementValue::Zero
+                };
+                QubitMeasurementResult::new(*q, value, ArbData::default())
+            })
+            .collect())
+    });
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(PluginThreadConfiguration::new(
+            frontend,
+            PluginLogConfiguration::new("front", LoglevelFilter::Off),
+        ))
+        .with_plugin(PluginThreadConfiguration::new(
+            backend,
+            PluginLogConfiguration::new("back", LoglevelFilter::Off),
+        ));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator
+        .simulation
+        .run_shots(ArbData::default(), 5)
+        .unwrap();
+
+    let outcomes = simulator.simulation.get_outcomes().unwrap();
+    assert_eq!(outcomes.total(), 10);
+    assert_eq!(outcomes.entries(), vec![(1, 5), (7, 5)]);
+
+    simulator.simulation.take_outcomes().unwrap();
+    assert!(simulator.simulation.get_outcomes().unwrap().is_empty());
+}
+
+#[test]
+// This tests the benchmark workload of the null frontend.
+fn null_workload() {
+    use dqcsim::plugin::null::{null_backend, null_frontend, null_operator, NullWorkloadResult};
+
+    let metadata = PluginMetadata::new("null", "dqcsim", "0.1.0");
+    let ptc = |definition| {
+        PluginThreadConfiguration::new(
+            definition,
+            PluginLogConfiguration::new("", LoglevelFilter::Off),
+        )
+    };
+
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(ptc(null_frontend(metadata.clone())))
+        .with_plugin(ptc(null_operator(metadata.clone())))
+        .with_plugin(ptc(null_backend(metadata)));
+
+    let mut simulator = Simulator::new(configuration).unwrap();
+    simulator
+        .simulation
+        .start(
+            ArbData::from_json(
+                r#"{"qubits": 4, "gates": 100, "gates_per_measurement": 10}"#,
+                vec![],
+            )
+            .unwrap(),
+        )
+        .unwrap();
+    let ret = simulator.simulation.wait().unwrap();
+    let result: NullWorkloadResult = serde_json::from_str(&ret.get_json().unwrap()).unwrap();
+    assert_eq!(result.measurements, 10);
+    assert!(result.gates_per_second > 0.0);
+    assert!(result.round_trip_max_seconds >= result.round_trip_mean_seconds);
+
+    // Without a workload, the null frontend only sends an empty message.
+    simulator.simulation.start(ArbData::default()).unwrap();
+    assert_eq!(simulator.simulation.wait().unwrap(), ArbData::default());
+}
@@ -0,0 +1,137 @@
+//! Cross-process test for shared `ArbData` arguments.
+//!
+//! Shared arguments are sent by reference, which only works as long as the
+//! sending process keeps the argument alive until the receiver has mapped it.
+//! To test this, the backend must run in a separate process. This test binary
+//! doubles as that process: it runs the backend instead of the test when the
+//! simulator starts it with `PLUGIN_ENV` set. It therefore does not use the
+//! default test harness.
+
+use dqcsim::{
+    common::{
+        error::{err, Result},
+        log::LoglevelFilter,
+        types::{
+            ArbCmd, ArbData, Gate, PluginMetadata, PluginType, QubitMeasurementResult,
+            QubitMeasurementValue, SharedArg,
+        },
+    },
+    host::{
+        configuration::{
+            EnvMod, PluginLogConfiguration, PluginProcessConfiguration, PluginProcessSpecification,
+            PluginThreadConfiguration, SimulatorConfiguration,
+        },
+        simulator::Simulator,
+    },
+    plugin::{definition::PluginDefinition, state::PluginState},
+};
+use num_complex::Complex64;
+use std::env;
+
+/// Environment variable that tells this binary to run as the backend.
+const PLUGIN_ENV: &str = "DQCSIM_TEST_SHARED_ARG_BACKEND";
+
+/// Returns `ArbData` with a single shared argument containing the given
+/// bytes.
+fn shared(bytes: &[u8]) -> Result<ArbData> {
+    let mut data = ArbData::default();
+    data.get_shared_args_mut()
+        .push(SharedArg::from_bytes(bytes)?);
+    Ok(data)
+}
+
+/// Returns `ArbData` with a new shared argument, containing the inverted
+/// bytes of the single shared argument of the given data.
+fn invert(data: &ArbData) -> Result<ArbData> {
+    match data.get_shared_args() {
+        [arg] => shared(&arg.iter().map(|byte| !byte).collect::<Vec<_>>()),
+        _ => err("expected a single shared argument"),
+    }
+}
+
+/// The backend, which responds to `ArbCmd`s and measurements with inverted
+/// copies of the shared arguments it receives. These copies are dropped as
+/// soon as they have been sent.
+fn backend() -> PluginDefinition {
+    let mut definition = PluginDefinition::new(
+        PluginType::Backend,
+        PluginMetadata::new("backend", "dqcsim", "0.1.0"),
+    );
+    definition.host_arb = Box::new(|_, cmd| invert(cmd.data()));
+    definition.gate = Box::new(|_, gate| {
+        let data = invert(&gate.data)?;
+        Ok(gate
+            .get_measures()
+            .iter()
+            .map(|q| QubitMeasurementResult::new(*q, QubitMeasurementValue::Zero, data.clone()))
+            .collect())
+    });
+    definition
+}
+
+/// The frontend, which runs in a thread within the test process. It sends a
+/// measurement gate with a shared argument that it drops right after sending
+/// it, and returns the measurement data.
+fn frontend() -> PluginDefinition {
+    let mut definition = PluginDefinition::new(
+        PluginType::Frontend,
+        PluginMetadata::new("frontend", "dqcsim", "0.1.0"),
+    );
+    definition.run = Box::new(|state, _| {
+        let qubits = state.allocate(1, vec![])?;
+        state.gate(Gate::new_custom(
+            "measure",
+            vec![],
+            vec![],
+            qubits.clone(),
+            None::<Vec<Complex64>>,
+            shared(&[1, 2, 3])?,
+        )?)?;
+        let data = state.get_measurement(qubits[0])?.data;
+        state.free(qubits)?;
+        Ok(data)
+    });
+    definition
+}
+
+fn test() -> Result<()> {
+    let mut backend = PluginProcessConfiguration::new(
+        "backend",
+        PluginProcessSpecification::new(env::current_exe()?, None::<String>, PluginType::Backend),
+    );
+    backend.functional.env.push(EnvMod::set(PLUGIN_ENV, "1"));
+    backend.nonfunctional.verbosity = LoglevelFilter::Off;
+
+    // Reproduction is disabled, as the reproduction log would otherwise keep
+    // the arguments sent by the host alive.
+    let configuration = SimulatorConfiguration::default()
+        .without_reproduction()
+        .without_logging()
+        .with_plugin(PluginThreadConfiguration::new(
+            frontend(),
+            PluginLogConfiguration::new("frontend", LoglevelFilter::Off),
+        ))
+        .with_plugin(backend);
+    let mut simulator = Simulator::new(configuration)?;
+
+    // Gatestream requests and measurement data.
+    simulator.simulation.start(ArbData::default())?;
+    let data = simulator.simulation.wait()?;
+    assert_eq!(data.get_shared_args()[0].as_bytes(), &[!1u8, !2, !3]);
+
+    // Requests from the host to a plugin and their responses.
+    let data = simulator
+        .simulation
+        .arb("backend", ArbCmd::new("a", "b", shared(&[4, 5, 6])?))?;
+    assert_eq!(data.get_shared_args()[0].as_bytes(), &[!4u8, !5, !6]);
+    Ok(())
+}
+
+fn main() {
+    if env::var_os(PLUGIN_ENV).is_some() {
+        PluginState::run(&backend(), env::args().nth(1).unwrap()).unwrap();
+        return;
+    }
+    test().unwrap();
+    println!("test shared_arg ... ok");
+}
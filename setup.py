@@ -69,9 +69,9 @@ class build(_build):
                     'HOME', 'root') + '/.cargo/bin/cargo')
             finally:
                 if debug:
-                    cargo["build"]["--features"]["bindings cli null-plugins"] & FG
+                    cargo["build"]["--features"]["bindings cli null-plugins fusion-plugin replay-plugin"] & FG
                 else:
-                    cargo["build"]["--release"]["--features"]["bindings cli null-plugins"] & FG
+                    cargo["build"]["--release"]["--features"]["bindings cli null-plugins fusion-plugin replay-plugin"] & FG
 
         local['mkdir']("-p", py_target_dir)
         sys.path.append("python/tools")
@@ -195,6 +195,8 @@ setup(
             output_dir + '/dqcsim',
             output_dir + '/dqcsfenull',
             output_dir + '/dqcsopnull',
+            output_dir + '/dqcsopfuse',
+            output_dir + '/dqcsfereplay',
             output_dir + '/dqcsbenull',
             py_bin_dir + '/dqcsfepy',
             py_bin_dir + '/dqcsoppy',